@@ -66,6 +66,13 @@ namespace DyeWars.Network.Inbound
                         HandleServerShutdown(payload, offset);
                         break;
 
+                    // Streamed map chunks and tile edits - not decoded yet,
+                    // the scene's tilemap is still used as is
+                    case Opcode.Map.S_Map_Info:
+                    case Opcode.Map.S_Tile_Data:
+                    case Opcode.Map.S_Tile_Update:
+                        break;
+
                     default:
                         Debug.LogWarning($"PacketHandler: Unknown opcode 0x{opcode:X2}");
                         break;
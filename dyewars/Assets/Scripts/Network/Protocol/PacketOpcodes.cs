@@ -115,6 +115,38 @@ namespace DyeWars.Network.Protocol
             /// Payload: (none)
             /// </summary>
             public const byte S_Disconnect_Acknowledged = 0xFF;
+
+            /// <summary>
+            /// UDP spatial channel token (TCP, only when the server runs with --udp).
+            /// Payload: [token:8][udpPort:2]
+            /// </summary>
+            public const byte S_Udp_Token = 0xF6;
+
+            /// <summary>
+            /// Bind this UDP endpoint to the TCP session (UDP datagram, no framing header).
+            /// Retry until S_Udp_Bound arrives.
+            /// Payload: [token:8]
+            /// </summary>
+            public const byte C_Udp_Bind = 0xF7;
+
+            /// <summary>
+            /// UDP bind acknowledged (UDP datagram, no framing header).
+            /// Payload: (none)
+            /// </summary>
+            public const byte S_Udp_Bound = 0xFC;
+
+            /// <summary>
+            /// Sharded map: reconnect to this port on the same host and send
+            /// C_Shard_Resume with the token instead of C_Handshake_Request.
+            /// Payload: [port:2][token:8]
+            /// </summary>
+            public const byte S_Shard_Redirect = 0xFD;
+
+            /// <summary>
+            /// Handshake on the new shard after S_Shard_Redirect.
+            /// Payload: [version:2][clientMagic:4][token:8]
+            /// </summary>
+            public const byte C_Shard_Resume = 0xF5;
         }
 
         // ====================================================================
@@ -219,21 +251,36 @@ namespace DyeWars.Network.Protocol
         public static class Map
         {
             /// <summary>
-            /// Full tile data for visible region + buffer.
-            /// Payload: [mapId:2][originX:2][originY:2][width:1][height:1][tileData:width*height*2]
-            /// Each tile: [tileId:2]
+            /// One chunk of the map (chunkSize x chunkSize from S_Map_Info; edge
+            /// chunks may be narrower), palette + run-length compressed.
+            /// Payload: [mapId:2][chunkX:2][chunkY:2][version:4][width:1][height:1]
+            ///          [paletteSize:2][palette:paletteSize][runs:variable]
+            ///          [blockerMode:1][blockers:variable]
+            /// Tiles are row-major from the chunk's top-left. Runs, by palette size:
+            ///   1: no runs, every tile is palette[0]
+            ///   2-16: [index:4 bits][length-1:4 bits] per byte
+            ///   17+: [index:1][length-1:1]
+            /// Dynamic blockers (doors), blocked on top of the tile type, by mode:
+            ///   0: none
+            ///   1: [count:2][[x:1][y:1]...], chunk-local
+            ///   2: ceil(width*height/8) bytes, row-major, bit 0 first
+            /// Replaces any older version of the same chunk, blockers included.
             /// </summary>
             public const byte S_Tile_Data = 0x1A;
 
             /// <summary>
-            /// Partial tile update (for streaming/delta).
-            /// Payload: [count:1][[x:2][y:2][tileId:2]]...
+            /// Tile edits made since the server's last tick, in our view. Each
+            /// tile's final state, once. Patch the held chunk in place (its
+            /// version moves on server-side too, so it won't be re-sent).
+            /// Payload: [mapId:2][count:2][[x:2][y:2][type:1][flags:1]]...
+            /// Flags: bit 0 = blocked (static or dynamic).
             /// </summary>
             public const byte S_Tile_Update = 0x1B;
 
             /// <summary>
-            /// Map metadata (name, dimensions, flags).
-            /// Payload: [mapId:2][width:2][height:2][flags:1][nameLength:1][name:variable]
+            /// Map metadata (name, dimensions, flags). Sent on entering a map,
+            /// before its chunks - drop the chunks held for the previous one.
+            /// Payload: [mapId:2][width:2][height:2][chunkSize:1][flags:1][nameLength:1][name:variable]
             /// </summary>
             public const byte S_Map_Info = 0x1C;
 
@@ -352,6 +399,14 @@ namespace DyeWars.Network.Protocol
             /// </summary>
             public const byte S_Player_Spatial = 0x25;
 
+            /// <summary>
+            /// Same records as S_Player_Spatial over the UDP channel (no framing header).
+            /// Updates known players only - ignore unknown IDs, and drop the datagram
+            /// unless seq is newer than the last applied (serial number compare).
+            /// Payload: [seq:4][count:1][[playerId:8][x:2][y:2][facing:1]]...
+            /// </summary>
+            public const byte S_Player_Spatial_Unreliable = 0x27;
+
             /// <summary>
             /// Batch entity positions.
             /// Payload: [count:1][[entityId:4][x:2][y:2][facing:1]]...
@@ -635,10 +690,10 @@ namespace DyeWars.Network.Protocol
         public const int S_LocalPlayer_Warped = 7;                  // opcode + mapId(2) + x(2) + y(2)
 
         // Map (header sizes, tile data is variable)
-        public const int S_Map_Tile_Data_Header = 9;                // opcode + mapId(2) + originX(2) + originY(2) + width + height
-        public const int S_Map_Tile_Update_Header = 2;              // opcode + count
-        public const int S_Map_Tile_Update_PerTile = 6;             // x(2) + y(2) + tileId(2)
-        public const int S_Map_Map_Info_Header = 8;                 // opcode + mapId(2) + width(2) + height(2) + flags
+        public const int S_Map_Tile_Data_Header = 15;               // opcode + mapId(2) + chunkX(2) + chunkY(2) + version(4) + width + height + paletteSize(2)
+        public const int S_Map_Tile_Update_Header = 5;              // opcode + mapId(2) + count(2)
+        public const int S_Map_Tile_Update_PerTile = 6;             // x(2) + y(2) + type + flags
+        public const int S_Map_Map_Info_Header = 10;                // opcode + mapId(2) + width(2) + height(2) + chunkSize + flags + nameLength
         public const int S_Map_Object_Data_Header = 7;              // opcode + originX(2) + originY(2) + width + height
         public const int S_Map_Collision_Data_Header = 7;           // opcode + originX(2) + originY(2) + width + height
 
@@ -715,6 +770,11 @@ namespace DyeWars.Network.Protocol
             Opcode.Connection.S_Heartbeat_Response => "Connection.S_Heartbeat_Response",
             Opcode.Connection.C_Disconnect_Request => "Connection.C_Disconnect_Request",
             Opcode.Connection.S_Disconnect_Acknowledged => "Connection.S_Disconnect_Acknowledged",
+            Opcode.Connection.S_Udp_Token => "Connection.S_Udp_Token",
+            Opcode.Connection.C_Udp_Bind => "Connection.C_Udp_Bind",
+            Opcode.Connection.S_Udp_Bound => "Connection.S_Udp_Bound",
+            Opcode.Connection.S_Shard_Redirect => "Connection.S_Shard_Redirect",
+            Opcode.Connection.C_Shard_Resume => "Connection.C_Shard_Resume",
 
             // Movement
             Opcode.Movement.C_Move_Request => "Movement.C_Move_Request",
@@ -760,6 +820,7 @@ namespace DyeWars.Network.Protocol
 
             // Batch
             Opcode.Batch.S_Player_Spatial => "Batch.S_Player_Spatial",
+            Opcode.Batch.S_Player_Spatial_Unreliable => "Batch.S_Player_Spatial_Unreliable",
             Opcode.Batch.S_Entity_Update => "Batch.S_Entity_Update",
 
             // Combat
@@ -818,6 +879,7 @@ namespace DyeWars.Network.Protocol
             opcode == Opcode.Connection.C_Pong_Response ||
             opcode == Opcode.Connection.C_Heartbeat_Request ||
             opcode == Opcode.Connection.C_Disconnect_Request ||
+            opcode == Opcode.Connection.C_Udp_Bind ||
             opcode == Opcode.Debug.C_Request_State;
 
         public static bool IsServerToClient(byte opcode) => !IsClientToServer(opcode);
@@ -831,6 +893,7 @@ namespace DyeWars.Network.Protocol
             >= 0x20 and <= 0x24 => "RemotePlayer",
             0x25 => "Batch",
             0x26 => "RemotePlayer",
+            0x27 => "Batch",
             >= 0x28 and <= 0x2E => "Entity",
             0x2F => "Batch",
             >= 0x30 and <= 0x3F => "Combat",
@@ -54,9 +54,9 @@ function process_custom_message(data)
     return response
 end
 
-function on_player_moved(player_id, x, y, dir)
-    if x == 5 and y == 1 then
-        log("Player " .. player_id .. " stepped on a trap! Facing: " .. dir)
+function on_player_moved(player_id, map, x, y, dir)
+    if map == 0 and x == 5 and y == 1 then
+        log("Player " .. player_id .. " stepped on a trap on map " .. map .. "! Facing: " .. dir)
     end
 end
 
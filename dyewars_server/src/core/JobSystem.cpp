@@ -0,0 +1,196 @@
+/// =======================================
+/// DyeWarsServer - JobSystem
+/// =======================================
+#include "JobSystem.h"
+
+namespace {
+    // Which JobSystem (if any) the current thread is a worker of, and its index
+    thread_local JobSystem *t_worker_of = nullptr;
+    thread_local size_t t_worker_index = 0;
+}
+
+JobSystem::JobSystem(size_t workers) {
+    queues_.reserve(workers);
+    for (size_t i = 0; i < workers; i++) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; i++) {
+        workers_.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto &worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+size_t JobSystem::ResolveWorkerCount(int requested, size_t io_threads, size_t game_threads) {
+    if (requested >= 0) return static_cast<size_t>(requested);
+
+    const size_t cores = std::thread::hardware_concurrency();
+    const size_t reserved = io_threads + game_threads;
+    if (cores <= reserved) return 0;
+    return std::min(cores - reserved, MAX_AUTO_WORKERS);
+}
+
+JobSystem::Handle JobSystem::Schedule(std::function<void()> fn, std::initializer_list<Handle> after) {
+    auto job = std::make_shared<Job>();
+    job->fn_ = std::move(fn);
+    job->origin_ = JobOrigin::Current();
+
+    for (const auto &dependency : after) {
+        if (!dependency) continue;
+        std::lock_guard lock(dependency->mutex_);
+        if (dependency->finished_) continue;
+        dependency->dependents_.push_back(job);
+        job->pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Drop the "still wiring" reference; runnable now if nothing is pending
+    if (job->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Enqueue(job);
+    }
+    return job;
+}
+
+void JobSystem::Wait(const Handle &job) {
+    if (!job) return;
+    JoinScope joining;
+
+    while (!job->Done()) {
+        if (TryRunOne()) continue;
+
+        if (workers_.empty()) {
+            // Nothing runnable and nobody else to run it: the job's
+            // dependencies were never scheduled
+            std::this_thread::yield();
+            continue;
+        }
+        // A worker has it (or one of its dependencies). Park until a job
+        // finishes or more work is queued, then look again.
+        std::unique_lock lock(wake_mutex_);
+        done_cv_.wait(lock, [&]() {
+            return job->Done() || queued_.load(std::memory_order_relaxed) > 0;
+        });
+    }
+
+    if (job->error_) std::rethrow_exception(job->error_);
+}
+
+void JobSystem::Enqueue(Handle job) {
+    WorkQueue &queue = t_worker_of == this ? *queues_[t_worker_index] : injected_;
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    {
+        std::lock_guard lock(wake_mutex_);
+        queued_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_cv_.notify_one();
+    done_cv_.notify_all();  // A waiter can help with it too
+}
+
+JobSystem::Handle JobSystem::TakeJob() {
+    const bool is_worker = t_worker_of == this;
+
+    // 1. Own deque, newest first
+    if (is_worker) {
+        WorkQueue &own = *queues_[t_worker_index];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty()) {
+            Handle job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            return job;
+        }
+    }
+
+    // 2. Jobs from outside the pool, oldest first
+    {
+        std::lock_guard lock(injected_.mutex);
+        if (!injected_.jobs.empty()) {
+            Handle job = std::move(injected_.jobs.front());
+            injected_.jobs.pop_front();
+            return job;
+        }
+    }
+
+    // 3. Steal the oldest job from another worker, starting after our own slot
+    const size_t count = queues_.size();
+    const size_t start = is_worker ? t_worker_index + 1 : 0;
+    for (size_t i = 0; i < count; i++) {
+        const size_t victim = (start + i) % count;
+        if (is_worker && victim == t_worker_index) continue;
+
+        WorkQueue &queue = *queues_[victim];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            Handle job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool JobSystem::TryRunOne() {
+    Handle job = TakeJob();
+    if (!job) return false;
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    Run(job);
+    return true;
+}
+
+void JobSystem::Run(const Handle &job) {
+    try {
+        JobContextScope context(job->origin_);
+        job->fn_();
+    } catch (...) {
+        job->error_ = std::current_exception();
+    }
+    job->fn_ = nullptr;  // Release captures now, not when the last Handle dies
+
+    std::vector<Handle> dependents;
+    {
+        std::lock_guard lock(job->mutex_);
+        job->finished_ = true;
+        dependents.swap(job->dependents_);
+    }
+    job->done_.store(true, std::memory_order_release);
+
+    for (auto &dependent : dependents) {
+        if (dependent->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Enqueue(std::move(dependent));
+        }
+    }
+
+    // Waiters parked in Wait() re-check their job. Taking the mutex orders
+    // done_ before their predicate check, so the notify can't be missed.
+    {
+        std::lock_guard lock(wake_mutex_);
+    }
+    done_cv_.notify_all();
+}
+
+void JobSystem::WorkerLoop(size_t index) {
+    t_worker_of = this;
+    t_worker_index = index;
+
+    for (;;) {
+        if (TryRunOne()) continue;
+
+        std::unique_lock lock(wake_mutex_);
+        wake_cv_.wait(lock, [this]() {
+            return stopping_ || queued_.load(std::memory_order_relaxed) > 0;
+        });
+        if (stopping_) return;
+    }
+}
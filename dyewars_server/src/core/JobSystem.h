@@ -0,0 +1,185 @@
+/// =======================================
+/// DyeWarsServer - JobSystem
+///
+/// Small work-stealing job scheduler for fanning per-tick work out from the
+/// game thread: Schedule() with dependencies, Wait(), and ParallelFor().
+///
+/// WHY:
+/// Everything in ProcessTick ran on one core. Much of a busy tick is
+/// independent read-only work - "who can see dirty player P" for hundreds of
+/// P, then "encode this viewer's batch packet" for thousands of viewers.
+/// Those split cleanly across cores; the state changes between them
+/// (VisibilityTracker, movement, Lua hooks) stay serial on the game thread.
+///
+/// HOW IT WORKS:
+/// Each worker has its own deque. A worker pushes jobs it spawns to the back
+/// and pops from the back (newest first, cache-warm); idle workers steal
+/// from the front of someone else's deque (oldest first, usually the
+/// biggest piece left). Jobs from non-worker threads (the game thread) go
+/// to a shared injection queue. A thread that Wait()s runs queued jobs
+/// itself instead of sleeping, so the game thread is one more worker for
+/// the duration of a ParallelFor.
+///
+/// The deques are a mutex around a std::deque rather than a lock-free
+/// Chase-Lev deque. Jobs here are coarse (a ParallelFor chunk is dozens of
+/// players), so the lock is almost never contended and not worth the
+/// memory-ordering subtlety.
+///
+/// DEPENDENCIES:
+/// Schedule(fn, {a, b}) runs fn only after jobs a and b finished. The job
+/// that completes last pushes it onto its own deque.
+///
+/// THREAD OWNERSHIP (see ThreadSafety.h):
+/// Jobs run "for" the thread that scheduled them. Inside a job,
+/// ASSERT_GAME_THREAD_READ passes while that thread is blocked in Wait /
+/// ParallelFor, and ASSERT_GAME_THREAD (writes) always fails - even when the
+/// job runs on the game thread itself. Always Wait for what you schedule
+/// before touching game state again.
+///
+/// With 0 workers everything runs inline on the calling thread (same
+/// assertions), which is also what --job-threads 0 does.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/ThreadSafety.h"
+
+class JobSystem {
+public:
+    class Job;
+    using Handle = std::shared_ptr<Job>;
+
+    /// @param workers Helper threads. 0 runs every job inline on the waiter.
+    explicit JobSystem(size_t workers);
+
+    /// Joins the workers. Jobs still queued are dropped - Wait first.
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /// Queue fn to run once every job in `after` has finished. Any thread.
+    Handle Schedule(std::function<void()> fn, std::initializer_list<Handle> after = {});
+
+    /// Block until `job` finished, running queued jobs meanwhile.
+    /// Rethrows the exception if the job threw.
+    void Wait(const Handle &job);
+
+    /// Call body(begin, end) over [0, count) in chunks of at least `grain`
+    /// items, spread across the workers and the calling thread. Returns when
+    /// every chunk is done. Chunks must only read shared state and write to
+    /// their own slice of an output.
+    template<typename Fn>
+    void ParallelFor(size_t count, size_t grain, Fn &&body) {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+
+        // No more chunks than the threads can use, a few per thread for balance
+        const size_t max_chunks = (workers_.size() + 1) * CHUNKS_PER_THREAD;
+        size_t chunks = (count + grain - 1) / grain;
+        if (chunks > max_chunks) chunks = max_chunks;
+        const size_t chunk_size = (count + chunks - 1) / chunks;
+        chunks = (count + chunk_size - 1) / chunk_size;
+
+        JoinScope joining;
+        std::vector<Handle> pending;
+        pending.reserve(chunks - 1);
+        for (size_t c = 1; c < chunks; c++) {
+            const size_t begin = c * chunk_size;
+            const size_t end = std::min(count, begin + chunk_size);
+            pending.push_back(Schedule([&body, begin, end]() { body(begin, end); }));
+        }
+
+        // First chunk on this thread, under the same rules as the others
+        std::exception_ptr error;
+        try {
+            JobContextScope context(JobOrigin::Current());
+            body(size_t{0}, std::min(count, chunk_size));
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        for (const auto &job : pending) {
+            try {
+                Wait(job);
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    size_t WorkerCount() const { return workers_.size(); }
+
+    /// Jobs taken from another worker's deque since startup (any thread)
+    uint64_t StealCount() const { return steals_.load(std::memory_order_relaxed); }
+
+    /// Worker threads for `requested` (-1 = auto): cores left after the
+    /// `game_threads` (one per zone) and `io_threads`, capped at MAX_AUTO_WORKERS
+    static size_t ResolveWorkerCount(int requested, size_t io_threads, size_t game_threads = 1);
+
+    static constexpr size_t CHUNKS_PER_THREAD = 4;
+    static constexpr size_t MAX_AUTO_WORKERS = 8;
+
+private:
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::deque<Handle> jobs;
+    };
+
+    void Enqueue(Handle job);
+    bool TryRunOne();
+    Handle TakeJob();
+    void Run(const Handle &job);
+    void WorkerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;  // One per worker
+    WorkQueue injected_;                              // From non-worker threads
+    std::vector<std::thread> workers_;
+
+    // Idle workers sleep on wake_cv_ until something is queued; threads in
+    // Wait() sleep on done_cv_ until a job finishes or is queued
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    std::atomic<size_t> queued_{0};
+    bool stopping_ = false;  // Guarded by wake_mutex_
+
+    std::atomic<uint64_t> steals_{0};
+};
+
+/// A scheduled job. Opaque outside JobSystem except for Done().
+class JobSystem::Job {
+public:
+    bool Done() const { return done_.load(std::memory_order_acquire); }
+
+private:
+    friend class JobSystem;
+
+    std::function<void()> fn_;
+    JobOrigin origin_;
+
+    // Unfinished dependencies, +1 while Schedule is still wiring them up
+    std::atomic<uint32_t> pending_{1};
+
+    std::mutex mutex_;
+    std::vector<Handle> dependents_;  // Guarded by mutex_
+    bool finished_ = false;           // Guarded by mutex_
+    std::exception_ptr error_;        // Written before done_ is published
+
+    std::atomic<bool> done_{false};
+};
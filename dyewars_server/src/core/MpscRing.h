@@ -0,0 +1,120 @@
+/// =======================================
+/// DyeWarsServer - MpscRing
+///
+/// Bounded lock-free multi-producer / single-consumer ring of trivially
+/// copyable values. IO threads push, the game thread pops.
+///
+/// HOW IT WORKS (Vyukov bounded queue):
+/// Every cell carries a sequence number. A producer claims a slot by CAS on
+/// enqueue_pos_, writes the value, then publishes it by storing
+/// sequence = pos + 1. The consumer only reads a cell once its sequence says
+/// it was published, then frees it for the next lap with
+/// sequence = pos + capacity. No locks and no allocation after construction.
+///
+/// WHY TRIVIALLY COPYABLE:
+/// Values are copied in and out of preallocated cells. A std::function or
+/// shared_ptr would bring back the per-push heap allocation and refcount
+/// traffic this ring exists to remove.
+///
+/// FULL RING:
+/// TryPush returns false; the caller decides whether to drop or retry.
+///
+/// THREAD SAFETY:
+///   - TryPush: any thread
+///   - TryPop: one consumer thread only (ThreadOwner asserted)
+///   - ApproxSize: any thread, may be stale
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include "core/ThreadSafety.h"
+
+template<typename T>
+class MpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "MpscRing values are copied into preallocated cells");
+
+public:
+    /// @param capacity Rounded up to a power of two
+    explicit MpscRing(size_t capacity)
+        : capacity_(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)),
+          mask_(capacity_ - 1),
+          cells_(std::make_unique<Cell[]>(capacity_)) {
+        for (size_t i = 0; i < capacity_; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing &) = delete;
+    MpscRing &operator=(const MpscRing &) = delete;
+
+    /// Push a value. Returns false if the ring is full. Any thread.
+    bool TryPush(const T &value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells_[pos & mask_];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0) {
+                // Cell is free for this lap - try to claim it
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+                // Lost the race, pos was reloaded by compare_exchange
+            } else if (diff < 0) {
+                return false;  // Consumer hasn't freed this cell yet: full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);  // Another producer moved on
+            }
+        }
+    }
+
+    /// Pop the oldest value. Returns false if empty. Consumer thread only.
+    bool TryPop(T &out) {
+        ASSERT_SINGLE_THREADED(consumer_);
+        if (!consumer_.IsOwnerSet()) consumer_.SetOwner();
+
+        Cell &cell = cells_[dequeue_pos_ & mask_];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != dequeue_pos_ + 1) return false;  // Not published yet
+
+        out = cell.value;
+        cell.sequence.store(dequeue_pos_ + capacity_, std::memory_order_release);
+        dequeue_pos_++;
+        dequeue_mirror_.store(dequeue_pos_, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Number of queued values (approximate under concurrency)
+    size_t ApproxSize() const {
+        const size_t enqueued = enqueue_pos_.load(std::memory_order_relaxed);
+        const size_t dequeued = dequeue_mirror_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    size_t Capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Producers and consumer on separate cache lines
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) size_t dequeue_pos_ = 0;
+    std::atomic<size_t> dequeue_mirror_{0};  // For ApproxSize from other threads
+    ThreadOwner consumer_;
+};
@@ -0,0 +1,243 @@
+/// =======================================
+/// DyeWarsServer - ServerConfig
+///
+/// Startup settings parsed from the command line.
+///
+/// Usage:
+///   DyeWarsServer [--io-threads N] [--io-backend auto|epoll|io_uring] [--udp]
+///                 [--tps N] [--catch-up skip|burst] [--tick-spin-us N]
+///                 [--job-threads N] [--pipeline] [--zones N]
+///                 [--shard I/N] [--shard-dir DIR] [--gateway]
+///                 [--deterministic] [--seed N] [--record FILE]
+///                 [--map-dir DIR] [--map-idle SECONDS] [--open-warps]
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "core/TickScheduler.h"
+
+struct ServerConfig {
+    /// Which asio reactor runs the sockets (see network/IoBackend.h).
+    /// Auto keeps whatever this binary was built with, falling back from
+    /// io_uring to epoll when the kernel refuses io_uring.
+    enum class IoBackend { Auto, Epoll, IoUring };
+
+    /// Network IO threads (one io_context each, see IoContextPool).
+    /// 1 reproduces the original single IO thread.
+    size_t io_threads = 1;
+
+    IoBackend io_backend = IoBackend::Auto;
+
+    /// Send spatial updates for already-known players over the unreliable
+    /// UDP channel (see UdpSpatialChannel). Off: everything stays on TCP.
+    bool udp_spatial = false;
+
+    /// Game loop pacing (see TickScheduler): tick rate, catch-up policy
+    /// after an overrun, and how long to spin before each deadline.
+    TickScheduler::Config tick;
+
+    /// Helper threads for parallel per-tick work (see JobSystem).
+    /// -1 = one per core left after the game and IO threads (max 8),
+    /// 0 = every tick runs serially on the game thread.
+    int job_threads = -1;
+
+    /// Encode and queue tick N's packets on a separate encoder thread while
+    /// the game thread simulates tick N+1 (see TickDelta). Off: each tick
+    /// encodes its own packets before it ends.
+    bool pipeline = false;
+
+    /// Maps, each simulated by its own Zone on its own thread (see
+    /// ZoneManager). Map 0 is where players log in.
+    size_t zones = 1;
+
+    static constexpr size_t MAX_ZONES = 16;
+
+    /// Split map 0 into shard_count vertical strips, one server process
+    /// each; this process owns strip shard_index (see ShardLayout). The
+    /// processes talk over Unix datagram sockets in shard_dir (ShardLink).
+    /// 1 = one process owns the whole map.
+    size_t shard_index = 0;
+    size_t shard_count = 1;
+    std::string shard_dir = "/tmp/dyewars_shards";
+
+    static constexpr size_t MAX_SHARDS = 8;
+
+    /// Accept gateway processes (DyeWarsGateway) on 127.0.0.1:8084; their
+    /// clients join next to direct ones (see GatewayLink). Off: only direct
+    /// client connections.
+    bool gateway = false;
+
+    /// Make each zone's simulation a function of its input stream alone:
+    /// player ids and bot randomness come from `seed` (plus the map id)
+    /// instead of random_device, and moves ignore the client's measured
+    /// ping (see Player::AttemptMove). Cooldowns are already counted in
+    /// game ticks (GameTime), so they need nothing extra.
+    bool deterministic = false;
+    uint64_t seed = 1;
+
+    /// Write every command the zones execute, with its tick, to this file
+    /// (see InputLog) for DyeWarsReplay. Empty: no capture.
+    std::string record_path;
+
+    /// Map N is DIR/mapN.dwm when that file exists (see MapFile), mapped
+    /// when the first player arrives and released after map_idle_seconds
+    /// with nobody on it. Maps without a file are generated and stay in
+    /// memory. Empty: every map is generated.
+    std::string map_dir;
+    uint32_t map_idle_seconds = 60;
+
+    /// Honour every client C_Warp_Request, to any map and tile, for test
+    /// tools (DyeWarsShardCheck). Off: a client warps only from a warp
+    /// tile to its destination (see WarpPoints).
+    bool open_warps = false;
+
+    /// No sockets, no zone threads: the zones are built but only tick when
+    /// their owner calls Zone::RunTick(). Set by DyeWarsReplay, not a flag.
+    bool headless = false;
+
+    /// Shard I listens on every port + I * SHARD_PORT_STRIDE (game, debug
+    /// HTTP, UDP), so all shards fit on one host
+    static constexpr uint16_t SHARD_PORT_STRIDE = 10;
+
+    uint16_t PortOffset() const { return static_cast<uint16_t>(shard_index * SHARD_PORT_STRIDE); }
+
+    /// Parse argv. Throws std::invalid_argument on unknown or malformed flags.
+    static ServerConfig FromArgs(int argc, char *argv[]) {
+        ServerConfig config;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            auto next_value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument(arg + " needs a value");
+                return argv[++i];
+            };
+
+            if (arg == "--io-threads") {
+                config.io_threads = std::stoul(next_value());
+                if (config.io_threads == 0 || config.io_threads > 64) {
+                    throw std::invalid_argument("--io-threads must be 1-64");
+                }
+            } else if (arg == "--io-backend") {
+                const std::string value = next_value();
+                if (value == "auto") config.io_backend = IoBackend::Auto;
+                else if (value == "epoll") config.io_backend = IoBackend::Epoll;
+                else if (value == "io_uring") config.io_backend = IoBackend::IoUring;
+                else throw std::invalid_argument("--io-backend must be auto, epoll or io_uring");
+            } else if (arg == "--udp") {
+                config.udp_spatial = true;
+            } else if (arg == "--tps") {
+                config.tick.tps = static_cast<uint32_t>(std::stoul(next_value()));
+                if (config.tick.tps == 0 || config.tick.tps > 1000) {
+                    throw std::invalid_argument("--tps must be 1-1000");
+                }
+            } else if (arg == "--catch-up") {
+                const std::string value = next_value();
+                if (value == "skip") config.tick.catch_up = TickScheduler::CatchUp::Skip;
+                else if (value == "burst") config.tick.catch_up = TickScheduler::CatchUp::Burst;
+                else throw std::invalid_argument("--catch-up must be skip or burst");
+            } else if (arg == "--tick-spin-us") {
+                const unsigned long spin_us = std::stoul(next_value());
+                if (spin_us > 5000) throw std::invalid_argument("--tick-spin-us must be 0-5000");
+                config.tick.spin = std::chrono::microseconds(spin_us);
+            } else if (arg == "--job-threads") {
+                const unsigned long job_threads = std::stoul(next_value());
+                if (job_threads > 64) throw std::invalid_argument("--job-threads must be 0-64");
+                config.job_threads = static_cast<int>(job_threads);
+            } else if (arg == "--pipeline") {
+                config.pipeline = true;
+            } else if (arg == "--zones") {
+                config.zones = std::stoul(next_value());
+                if (config.zones < 1 || config.zones > MAX_ZONES) {
+                    throw std::invalid_argument("--zones must be 1-16");
+                }
+            } else if (arg == "--shard") {
+                // "I/N": this process is shard I of N
+                const std::string value = next_value();
+                const size_t slash = value.find('/');
+                if (slash == std::string::npos) throw std::invalid_argument("--shard must be I/N, e.g. 0/2");
+                config.shard_index = std::stoul(value.substr(0, slash));
+                config.shard_count = std::stoul(value.substr(slash + 1));
+                if (config.shard_count < 1 || config.shard_count > MAX_SHARDS ||
+                    config.shard_index >= config.shard_count) {
+                    throw std::invalid_argument("--shard must be I/N with N 1-8 and I < N");
+                }
+#ifdef _WIN32
+                if (config.shard_count > 1) throw std::invalid_argument("--shard needs Unix domain sockets (Linux)");
+#endif
+            } else if (arg == "--shard-dir") {
+                config.shard_dir = next_value();
+            } else if (arg == "--gateway") {
+                config.gateway = true;
+            } else if (arg == "--deterministic") {
+                config.deterministic = true;
+            } else if (arg == "--seed") {
+                config.seed = std::stoull(next_value());
+                config.deterministic = true;
+            } else if (arg == "--record") {
+                config.record_path = next_value();
+            } else if (arg == "--map-dir") {
+                config.map_dir = next_value();
+            } else if (arg == "--map-idle") {
+                const unsigned long idle_seconds = std::stoul(next_value());
+                if (idle_seconds > 86400) throw std::invalid_argument("--map-idle must be 0-86400");
+                config.map_idle_seconds = static_cast<uint32_t>(idle_seconds);
+            } else if (arg == "--open-warps") {
+                config.open_warps = true;
+            } else {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+        }
+
+        // Each shard process would run its own copy of the other maps, and
+        // players warping there from different shards would never meet
+        if (config.shard_count > 1 && config.zones > 1) {
+            throw std::invalid_argument("--shard only splits map 0, it can't be combined with --zones");
+        }
+
+        // Handoffs arrive from other processes, which one log can't replay
+        if (config.shard_count > 1 && !config.record_path.empty()) {
+            throw std::invalid_argument("--record can't capture a sharded map");
+        }
+        return config;
+    }
+
+    static const char *Usage() {
+        return "Usage: DyeWarsServer [--io-threads N] [--io-backend auto|epoll|io_uring] [--udp]\n"
+               "                     [--tps N] [--catch-up skip|burst] [--tick-spin-us N]\n"
+               "                     [--job-threads N] [--pipeline] [--zones N]\n"
+               "                     [--shard I/N] [--shard-dir DIR] [--gateway]\n"
+               "                     [--deterministic] [--seed N] [--record FILE]\n"
+               "                     [--map-dir DIR] [--map-idle SECONDS] [--open-warps]\n"
+               "  --io-threads N   Network IO threads (default 1)\n"
+               "  --io-backend B   Socket reactor (default auto). io_uring needs a\n"
+               "                   build with -DENABLE_IO_URING=ON on Linux 5.10+\n"
+               "  --udp            Spatial updates over the UDP side channel (port 8083)\n"
+               "  --tps N          Game ticks per second (default 20)\n"
+               "  --catch-up P     After an overrun: skip missed ticks (default) or\n"
+               "                   burst them back-to-back (up to 5 behind)\n"
+               "  --tick-spin-us N Busy-wait the last N us before each tick (default 0)\n"
+               "  --job-threads N  Parallel tick helpers, 0 = serial (default: spare cores)\n"
+               "  --pipeline       Encode tick N's packets on their own thread while\n"
+               "                   tick N+1 simulates (at most 2 ticks in flight)\n"
+               "  --zones N        Maps, one simulation thread each (default 1, max 16)\n"
+               "  --shard I/N      Run strip I of map 0 split across N processes (max 8).\n"
+               "                   Ports move up by 10 per shard (shard 1: 8091-8093)\n"
+               "  --shard-dir DIR  Where shards put their IPC sockets (default /tmp/dyewars_shards)\n"
+               "  --gateway        Accept DyeWarsGateway processes on 127.0.0.1:8084\n"
+               "  --deterministic  Seeded ids and bots, no ping allowance: the same\n"
+               "                   inputs replay the same game\n"
+               "  --seed N         Seed for --deterministic (default 1, implies it)\n"
+               "  --record FILE    Log every executed command with its tick for\n"
+               "                   DyeWarsReplay (use with --deterministic)\n"
+               "  --map-dir DIR    Load map N from DIR/mapN.dwm if it exists (see\n"
+               "                   DyeWarsMapConvert), otherwise generate it\n"
+               "  --map-idle S     Release a file map S seconds after its last player\n"
+               "                   leaves (default 60, 0 = as soon as it empties)\n"
+               "  --open-warps     Let any client warp anywhere (test tools only).\n"
+               "                   Off: clients warp only from warp tiles\n";
+    }
+};
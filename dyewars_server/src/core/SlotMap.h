@@ -0,0 +1,160 @@
+/// =======================================
+/// DyeWarsServer - SlotMap
+///
+/// Generational slot map: values live packed in one dense array, and
+/// callers hold 32-bit handles instead of pointers or 64-bit keys.
+///
+///   handle = [generation:12][index:20]
+///
+/// The index picks a slot (stable for the value's lifetime, so other
+/// structures can keep per-slot side arrays indexed by it). The generation
+/// is bumped every time the slot is freed, so a handle kept past Erase()
+/// simply stops resolving instead of finding the next occupant.
+///
+/// WHY NOT unordered_map<uint64_t, T>:
+/// Every hash lookup is a bucket walk to a separately allocated node - a
+/// cache miss or two each, and the broadcast phase does thousands per tick.
+/// A handle lookup is two array reads, and iteration walks contiguous
+/// memory.
+///
+/// DENSE STORAGE:
+/// Erase() moves the last value into the hole (swap-and-pop), so Values()
+/// stays packed. Pointers/references into the map are invalidated by any
+/// Insert/Erase; handles are not.
+///
+/// GENERATION WRAP:
+/// A slot whose generation would wrap is retired instead of reused, so a
+/// stale handle can never alias a live one. At 4095 reuses per slot and
+/// ~1M slots that is not a practical limit.
+///
+/// Not thread-safe. Owners add their own assertions (see PlayerRegistry).
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace SlotHandle {
+    using Type = uint32_t;
+
+    constexpr uint32_t INDEX_BITS = 20;
+    constexpr uint32_t GENERATION_BITS = 32 - INDEX_BITS;
+    constexpr uint32_t MAX_SLOTS = 1u << INDEX_BITS;                    // ~1M
+    constexpr uint32_t INDEX_MASK = MAX_SLOTS - 1;
+    constexpr uint32_t MAX_GENERATION = (1u << GENERATION_BITS) - 1;    // 4095
+
+    /// Never a valid handle (generations start at 1)
+    constexpr Type NONE = 0;
+
+    constexpr uint32_t Index(Type handle) { return handle & INDEX_MASK; }
+
+    constexpr uint32_t Generation(Type handle) { return handle >> INDEX_BITS; }
+
+    constexpr Type Make(uint32_t index, uint32_t generation) { return (generation << INDEX_BITS) | index; }
+}
+
+template<typename T>
+class SlotMap {
+public:
+    using Handle = SlotHandle::Type;
+
+    /// Store a value. Returns SlotHandle::NONE if every slot is taken.
+    Handle Insert(T value) {
+        uint32_t index;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        } else {
+            if (slots_.size() >= SlotHandle::MAX_SLOTS) return SlotHandle::NONE;
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.push_back(Slot{0, 1});
+        }
+
+        Slot &slot = slots_[index];
+        slot.dense = static_cast<uint32_t>(values_.size());
+        values_.push_back(std::move(value));
+        dense_to_slot_.push_back(index);
+        return SlotHandle::Make(index, slot.generation);
+    }
+
+    /// Remove the value. False for a stale or NONE handle.
+    bool Erase(Handle handle) {
+        if (!Contains(handle)) return false;
+        const uint32_t index = SlotHandle::Index(handle);
+        Slot &slot = slots_[index];
+
+        // Swap-and-pop: the last value fills the hole
+        const uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+        if (slot.dense != last) {
+            values_[slot.dense] = std::move(values_[last]);
+            dense_to_slot_[slot.dense] = dense_to_slot_[last];
+            slots_[dense_to_slot_[slot.dense]].dense = slot.dense;
+        }
+        values_.pop_back();
+        dense_to_slot_.pop_back();
+
+        slot.dense = INVALID_DENSE;
+        if (slot.generation < SlotHandle::MAX_GENERATION) {
+            slot.generation++;
+            free_.push_back(index);
+        }
+        return true;
+    }
+
+    bool Contains(Handle handle) const {
+        const uint32_t index = SlotHandle::Index(handle);
+        return index < slots_.size() && slots_[index].dense != INVALID_DENSE &&
+               slots_[index].generation == SlotHandle::Generation(handle);
+    }
+
+    /// The value, or nullptr for a stale handle. Valid until the next Insert/Erase.
+    T *Get(Handle handle) {
+        return Contains(handle) ? &values_[slots_[SlotHandle::Index(handle)].dense] : nullptr;
+    }
+
+    const T *Get(Handle handle) const {
+        return Contains(handle) ? &values_[slots_[SlotHandle::Index(handle)].dense] : nullptr;
+    }
+
+    size_t Size() const { return values_.size(); }
+
+    bool Empty() const { return values_.empty(); }
+
+    /// One past the highest slot index ever used - the size side arrays
+    /// indexed by SlotHandle::Index() need
+    size_t SlotCount() const { return slots_.size(); }
+
+    /// Every value, packed, in no particular order
+    std::span<T> Values() { return values_; }
+
+    std::span<const T> Values() const { return values_; }
+
+    /// Handle of Values()[dense_index]
+    Handle HandleAt(size_t dense_index) const {
+        const uint32_t index = dense_to_slot_[dense_index];
+        return SlotHandle::Make(index, slots_[index].generation);
+    }
+
+    /// Drop every value. Outstanding handles go stale.
+    void Clear() {
+        while (!values_.empty()) Erase(HandleAt(values_.size() - 1));
+    }
+
+private:
+    static constexpr uint32_t INVALID_DENSE = UINT32_MAX;
+
+    struct Slot {
+        uint32_t dense;       // Position in values_, INVALID_DENSE when free
+        uint32_t generation;  // 1..MAX_GENERATION
+    };
+
+    std::vector<T> values_;               // Packed values
+    std::vector<uint32_t> dense_to_slot_; // values_[i] lives in slot dense_to_slot_[i]
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_;          // Reusable slots, most recently freed last
+};
@@ -25,6 +25,100 @@
 #include <atomic>
 #include <cassert>
 
+/// ============================================================================
+/// PARALLEL JOBS AND OWNERSHIP
+///
+/// JobSystem lets the game thread fan read-only work (spatial queries, packet
+/// encoding) out to helper threads for part of a tick. That breaks the plain
+/// "only the owner thread may touch this" rule on purpose, so ownership has
+/// two levels:
+///
+///   - Exclusive (ASSERT_GAME_THREAD): the owner thread, and NOT from inside
+///     a job. Anything that mutates owner-confined state.
+///   - Shared (ASSERT_GAME_THREAD_READ): the owner thread, or a job the owner
+///     scheduled while the owner is blocked waiting for it (JobSystem::Wait /
+///     ParallelFor). Const readers like Player::GetX().
+///
+/// So a job that writes game state still trips the assertion, even when it
+/// happens to run on the game thread itself, and a job that reads game state
+/// after the game thread stopped waiting (and may be writing again) trips too.
+///
+/// JobOrigin / JobContextScope / JoinScope are how JobSystem tells ThreadOwner
+/// who a job is running on behalf of. Release builds compile them to nothing.
+/// ============================================================================
+#ifdef NDEBUG
+struct JobOrigin {
+    static JobOrigin Current() { return {}; }
+};
+
+class JobContextScope {
+public:
+    explicit JobContextScope([[maybe_unused]] const JobOrigin &origin) {}
+};
+
+class JoinScope {
+public:
+    JoinScope() {}
+};
+#else
+/// Thread a job was scheduled for, and that thread's "blocked in a join" count
+struct JobOrigin {
+    std::thread::id thread;
+    const std::atomic<int> *joining = nullptr;
+
+    /// Origin for a job scheduled right now. Jobs scheduled from inside a
+    /// job inherit the outer job's origin (they run for the same owner).
+    static JobOrigin Current();
+};
+
+namespace ThreadSafetyDetail {
+    /// Per-thread job state. `job_depth` > 0 while this thread runs a job.
+    struct JobState {
+        JobOrigin origin;
+        int job_depth = 0;
+    };
+
+    inline thread_local JobState t_job;
+
+    /// > 0 while this thread is blocked in JobSystem::Wait / ParallelFor
+    inline thread_local std::atomic<int> t_joining{0};
+}
+
+inline JobOrigin JobOrigin::Current() {
+    const auto &job = ThreadSafetyDetail::t_job;
+    if (job.job_depth > 0) return job.origin;
+    return {std::this_thread::get_id(), &ThreadSafetyDetail::t_joining};
+}
+
+/// Held by JobSystem around each job it runs
+class JobContextScope {
+public:
+    explicit JobContextScope(const JobOrigin &origin)
+        : saved_(ThreadSafetyDetail::t_job) {
+        ThreadSafetyDetail::t_job.origin = origin;
+        ThreadSafetyDetail::t_job.job_depth++;
+    }
+
+    ~JobContextScope() { ThreadSafetyDetail::t_job = saved_; }
+
+    JobContextScope(const JobContextScope &) = delete;
+    JobContextScope &operator=(const JobContextScope &) = delete;
+
+private:
+    ThreadSafetyDetail::JobState saved_;
+};
+
+/// Held by JobSystem while a thread waits for jobs it scheduled
+class JoinScope {
+public:
+    JoinScope() { ThreadSafetyDetail::t_joining.fetch_add(1, std::memory_order_release); }
+    ~JoinScope() { ThreadSafetyDetail::t_joining.fetch_sub(1, std::memory_order_release); }
+
+    JoinScope(const JoinScope &) = delete;
+    JoinScope &operator=(const JoinScope &) = delete;
+};
+#endif
+
 /// ============================================================================
 /// THREAD OWNER TRACKER
 ///
@@ -106,6 +200,9 @@ public:
     // ==========================================================================
     void SetOwner() {}
     void AssertOwner([[maybe_unused]] const char* context = nullptr) const {}
+    void AssertReadable([[maybe_unused]] const char* context = nullptr) const {}
+    bool CanReadHere() const { return true; }
+    bool CanWriteHere() const { return true; }
     void ClearOwner() {}
     bool IsOwnerSet() const { return true; }
 #else
@@ -134,8 +231,10 @@ public:
     /// 2. AssertOwner() just reads and compares, doesn't need ordering
     /// 3. If there's a race in setting owner, we have bigger problems
     ///
+    /// Inside a job, "current thread" means the thread the job runs for, so a
+    /// job that lazily claims an object claims it for the game thread.
     void SetOwner() {
-        owner_thread_id_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        owner_thread_id_.store(JobOrigin::Current().thread, std::memory_order_relaxed);
     }
 
     /// Assert that current thread is the owner.
@@ -172,6 +271,35 @@ public:
         // If not, this assertion will fire and crash the program.
         // The message tells you exactly what went wrong.
         assert(owner == current && "Thread safety violation: accessed from wrong thread");
+
+        // Right thread, but a job must not write: other jobs may be reading
+        assert(ThreadSafetyDetail::t_job.job_depth == 0 &&
+               "Thread safety violation: owner-confined state written from inside a parallel job");
+    }
+
+    /// Assert that current thread may READ owner-confined state: the owner
+    /// itself, or a job the owner scheduled and is blocked waiting on.
+    /// Use in const accessors that parallel jobs call (see JobSystem.h).
+    void AssertReadable([[maybe_unused]] const char* context = nullptr) const {
+        assert(CanReadHere() && "Thread safety violation: read from wrong thread outside a joined job");
+    }
+
+    /// The checks behind AssertReadable / AssertOwner, without asserting
+    bool CanReadHere() const {
+        auto owner = owner_thread_id_.load(std::memory_order_relaxed);
+        if (owner == std::thread::id{} || owner == std::this_thread::get_id()) {
+            return true;
+        }
+
+        const auto &job = ThreadSafetyDetail::t_job;
+        return job.job_depth > 0 && job.origin.thread == owner && job.origin.joining != nullptr &&
+               job.origin.joining->load(std::memory_order_acquire) > 0;
+    }
+
+    bool CanWriteHere() const {
+        auto owner = owner_thread_id_.load(std::memory_order_relaxed);
+        if (owner == std::thread::id{}) return true;
+        return owner == std::this_thread::get_id() && ThreadSafetyDetail::t_job.job_depth == 0;
     }
 
     /// Clear ownership (for transfer or shutdown).
@@ -235,11 +363,13 @@ private:
     #define ASSERT_GAME_THREAD(owner) ((void)0)
     #define ASSERT_IO_THREAD(owner) ((void)0)
     #define ASSERT_SINGLE_THREADED(owner) ((void)0)
+    #define ASSERT_GAME_THREAD_READ(owner) ((void)0)
 #else
     // Debug build: call AssertOwner with descriptive context
     #define ASSERT_GAME_THREAD(owner) (owner).AssertOwner("Expected game thread")
     #define ASSERT_IO_THREAD(owner) (owner).AssertOwner("Expected IO thread")
     #define ASSERT_SINGLE_THREADED(owner) (owner).AssertOwner("Expected single-threaded access")
+    #define ASSERT_GAME_THREAD_READ(owner) (owner).AssertReadable("Expected game thread or a job it is joining")
 #endif
 
 /// ============================================================================
@@ -283,6 +413,7 @@ private:
 /// - Game state: Confined to game thread (this file enforces it)
 /// - Statistics: Atomics (can be read from any thread)
 /// - Action queue: Message passing (IO thread → game thread)
+/// - Parallel tick work: Fork-join jobs that only read game state (JobSystem)
 /// - Client connections: Each connection has its own strand/socket
 ///
 /// ============================================================================
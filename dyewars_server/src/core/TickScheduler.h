@@ -0,0 +1,153 @@
+/// =======================================
+/// DyeWarsServer - TickScheduler
+///
+/// Fixed-timestep pacing for the game loop: decides when each tick starts
+/// and what to do after a tick overruns its budget.
+///
+/// WHY ABSOLUTE DEADLINES:
+/// The loop used to sleep_for(TICK_RATE - elapsed). sleep_for wakes late
+/// (scheduler granularity, 50-1000us depending on OS), and that lateness
+/// was never paid back, so 20 TPS ran at ~19.x TPS and the game clock
+/// slowly drifted from wall time. Here tick N is due at epoch + N * interval
+/// and the loop sleep_until()s that point, so a late wake delays one tick
+/// start without shifting every tick after it.
+///
+/// SPIN:
+/// With spin > 0 the scheduler sleeps until (deadline - spin) and
+/// busy-waits the rest, trading a sliver of one core for start jitter in
+/// the microseconds. Off by default (--tick-spin-us).
+///
+/// CATCH-UP (after a tick runs past the next deadline):
+///   - Skip:  drop the ticks that were missed, start the newest overdue
+///            tick immediately and stay on the grid. Game time loses the
+///            skipped ticks; nothing piles up.
+///   - Burst: run overdue ticks back-to-back without sleeping until the
+///            loop is caught up, at most max_burst_ticks behind. Older
+///            ticks than that are skipped. Game time keeps pace with wall
+///            time through short stalls.
+///
+/// THREAD SAFETY:
+/// Game thread only (ThreadOwner asserted). Counters are plain integers -
+/// GameServer copies them into ServerStats each tick.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "core/ThreadSafety.h"
+
+class TickScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class CatchUp { Skip, Burst };
+
+    struct Config {
+        uint32_t tps = 20;
+        std::chrono::microseconds spin{0};  // Busy-wait this long before each deadline
+        CatchUp catch_up = CatchUp::Skip;
+        uint32_t max_burst_ticks = 5;       // Burst only: deepest backlog replayed
+    };
+
+    explicit TickScheduler(const Config &config)
+        : config_(config),
+          interval_(std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / std::max<uint32_t>(config.tps, 1)) {}
+
+    /// Anchor tick 0 at `now`. Call once, right before the loop.
+    void Start(Clock::time_point now = Clock::now()) {
+        AssertGameThread();
+        epoch_ = now;
+        tick_ = 0;
+        started_ = false;
+    }
+
+    /// Block until the next tick is due and return how late it actually
+    /// started (sleep overshoot, or time spent behind after an overrun).
+    std::chrono::microseconds WaitForNextTick() {
+        const Clock::time_point deadline = NextDeadline(Clock::now());
+
+        if (deadline - config_.spin > Clock::now()) {
+            std::this_thread::sleep_until(deadline - config_.spin);
+        }
+        while (Clock::now() < deadline) {
+            // Spin out the last few hundred microseconds
+        }
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - deadline);
+    }
+
+    /// Pick the deadline of the next tick to run, given that the previous
+    /// tick finished at `now`. Applies the catch-up policy and updates the
+    /// counters. No sleeping - WaitForNextTick does that (split for tests).
+    Clock::time_point NextDeadline(Clock::time_point now) {
+        AssertGameThread();
+        if (!started_) {
+            started_ = true;
+            return epoch_;  // Tick 0
+        }
+
+        uint64_t next = tick_ + 1;
+        if (now > DeadlineOf(next)) {
+            // Still busy when the next tick was due
+            missed_deadlines_++;
+
+            // Newest deadline that has already passed
+            const uint64_t overdue = static_cast<uint64_t>((now - epoch_) / interval_);
+            uint64_t target = overdue;
+            if (config_.catch_up == CatchUp::Burst) {
+                const uint64_t backlog = overdue - next + 1;
+                target = backlog > config_.max_burst_ticks ? overdue - config_.max_burst_ticks + 1 : next;
+            }
+            skipped_ticks_ += target - next;
+            next = target;
+        }
+
+        tick_ = next;
+        return DeadlineOf(next);
+    }
+
+    /// Index of the tick most recently handed out (0 = first tick)
+    uint64_t CurrentTick() const { return tick_; }
+
+    /// Ticks that finished after the following tick was already due
+    uint64_t MissedDeadlines() const { return missed_deadlines_; }
+
+    /// Ticks dropped by the catch-up policy (never run)
+    uint64_t SkippedTicks() const { return skipped_ticks_; }
+
+    uint32_t Tps() const { return config_.tps; }
+
+    Clock::duration Interval() const { return interval_; }
+
+    /// Number of ticks covering `duration` (at least 1)
+    uint64_t TicksFor(std::chrono::milliseconds duration) const {
+        const auto ticks = static_cast<uint64_t>(duration / interval_);
+        return ticks > 0 ? ticks : 1;
+    }
+
+private:
+    Clock::time_point DeadlineOf(uint64_t tick) const {
+        return epoch_ + interval_ * static_cast<int64_t>(tick);
+    }
+
+    void AssertGameThread() const {
+        ASSERT_GAME_THREAD(thread_owner_);
+        if (!thread_owner_.IsOwnerSet()) thread_owner_.SetOwner();
+    }
+
+    const Config config_;
+    const Clock::duration interval_;
+
+    Clock::time_point epoch_ = Clock::now();
+    uint64_t tick_ = 0;
+    bool started_ = false;
+
+    uint64_t missed_deadlines_ = 0;
+    uint64_t skipped_ticks_ = 0;
+
+    mutable ThreadOwner thread_owner_;
+};
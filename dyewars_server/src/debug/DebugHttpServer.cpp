@@ -3,6 +3,7 @@
 /// =======================================
 #include "DebugHttpServer.h"
 #include "core/Log.h"
+#include "network/PacketTrace.h"
 #include <sstream>
 
 DebugHttpServer::DebugHttpServer(asio::io_context& io_context, uint16_t port)
@@ -77,9 +78,17 @@ std::string DebugHttpServer::BuildResponse(const std::string& path) {
     std::string body;
     std::string content_type = "text/html";
 
-    if (path == "/stats" || path == "/stats.json") {
+    // Split "/trace?client=5&off" into route and query
+    const size_t query_start = path.find('?');
+    const std::string route = path.substr(0, query_start);
+    const std::string query = query_start == std::string::npos ? "" : path.substr(query_start + 1);
+
+    if (route == "/stats" || route == "/stats.json") {
         body = GetStatsJson();
         content_type = "application/json";
+    } else if (route == "/trace") {
+        body = HandleTraceRequest(query);
+        content_type = "application/json";
     } else {
         body = GetDashboardHtml();
     }
@@ -103,6 +112,46 @@ std::string DebugHttpServer::GetStatsJson() {
     return R"({"error": "No stats provider configured"})";
 }
 
+std::string DebugHttpServer::HandleTraceRequest(const std::string& query) {
+    auto& trace = PacketTrace::Instance();
+
+    // Parse "a&b=1&c" into flags / key=value pairs
+    uint64_t client_id = 0;
+    bool on = false, off = false, dump = false;
+    std::istringstream params(query);
+    std::string param;
+    while (std::getline(params, param, '&')) {
+        const size_t eq = param.find('=');
+        const std::string key = param.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : param.substr(eq + 1);
+        try {
+            if (key == "on") on = true;
+            else if (key == "off") off = true;
+            else if (key == "dump") dump = true;
+            else if (key == "rate") trace.SetSampleRate(static_cast<uint32_t>(std::stoul(value)));
+            else if (key == "client") client_id = std::stoull(value);
+        } catch (...) {
+            return R"({"error": "invalid trace parameter"})";
+        }
+    }
+
+    if (client_id != 0) {
+        // client=ID watches one connection, client=ID&off stops watching it
+        if (off) trace.UnwatchClient(client_id);
+        else if (!trace.WatchClient(client_id)) return R"({"error": "too many watched clients"})";
+    } else if (on || off) {
+        trace.SetEnabled(on);
+    }
+
+    if (dump) {
+        // Runs on the IO thread - a few hundred KB of file I/O, acceptable for a debug action
+        const int64_t written = trace.DumpToFile("packet_trace.dwtr");
+        Log::Info("Packet trace dumped {} records to packet_trace.dwtr", written);
+    }
+
+    return trace.GetStatusJson();
+}
+
 std::string DebugHttpServer::GetDashboardHtml() {
     return R"html(<!DOCTYPE html>
 <html>
@@ -159,7 +208,49 @@ std::string DebugHttpServer::GetDashboardHtml() {
                 <span class="stat-label">TPS</span>
                 <span class="stat-value" id="tps">-</span>
             </div>
+            <div class="stat">
+                <span class="stat-label">Missed Deadlines / Skipped Ticks</span>
+                <span class="stat-value" id="tick-missed">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Tick Start Jitter (max)</span>
+                <span class="stat-value" id="tick-jitter-max">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Tick Throughput</span>
+                <span class="stat-value" id="tick-throughput">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Update Latency (avg / max)</span>
+                <span class="stat-value" id="update-latency">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Pipeline / Encoder Stalls</span>
+                <span class="stat-value" id="pipeline">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Zones (map: tick / players (broadcast)) / Transfers</span>
+                <span class="stat-value" id="zones">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Shard / Ghosts / Handoffs (out / in)</span>
+                <span class="stat-value" id="shard">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Map Chunks (sent / cache hit % / bytes saved)</span>
+                <span class="stat-value" id="map-chunks">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Map Files (loads / releases / last load)</span>
+                <span class="stat-value" id="map-files">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Tile Edits (edits / changes / update packets / bytes)</span>
+                <span class="stat-value" id="tile-edits">-</span>
+            </div>
             <div class="chart" id="tick-chart"></div>
+            <div class="stat-label" style="margin-top: 10px;">Tick starts by lateness in us (0, 1, 2-3 ... 16384+)</div>
+            <div class="chart" id="tick-jitter-chart"></div>
         </div>
 
         <div class="card">
@@ -227,7 +318,7 @@ std::string DebugHttpServer::GetDashboardHtml() {
         </div>
 
         <div class="card">
-            <h2>Broadcast Breakdown</h2>
+            <h2>Broadcast Breakdown (all zones)</h2>
             <div class="stat">
                 <span class="stat-label">Total Time</span>
                 <span class="stat-value" id="broadcast-time">-</span>
@@ -255,7 +346,7 @@ std::string DebugHttpServer::GetDashboardHtml() {
         </div>
 
         <div class="card">
-            <h2>Viewer Query Detail</h2>
+            <h2>Viewer Query Detail (all zones)</h2>
             <div class="stat">
                 <span class="stat-label">Spatial Hash</span>
                 <span class="stat-value" id="vq-spatial">-</span>
@@ -269,6 +360,38 @@ std::string DebugHttpServer::GetDashboardHtml() {
                 <span class="stat-value" id="vq-nearby">-</span>
             </div>
         </div>
+
+        <div class="card">
+            <h2>Send Queues (Backpressure)</h2>
+            <div class="stat">
+                <span class="stat-label">Deepest Queue</span>
+                <span class="stat-value" id="sq-max">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Conflated Packets</span>
+                <span class="stat-value" id="sq-conflated">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Dropped Packets</span>
+                <span class="stat-value" id="sq-dropped">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Slow Consumer Kicks</span>
+                <span class="stat-value" id="sq-kicks">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Dropped Input Commands</span>
+                <span class="stat-value" id="cmd-dropped">-</span>
+            </div>
+            <div class="stat">
+                <span class="stat-label">Input Overflows / Flood Kicks</span>
+                <span class="stat-value" id="input-flood">-</span>
+            </div>
+            <div class="stat-label" style="margin-top: 10px;">Connections by queued packets (0, 1, 2-3, 4-7 ... 1024+)</div>
+            <div class="chart" id="sq-packets-chart"></div>
+            <div class="stat-label" style="margin-top: 10px;">Connections by queued KB (0, 1, 2-3, 4-7 ... 1024+)</div>
+            <div class="chart" id="sq-kb-chart"></div>
+        </div>
     </div>
 
     <script>
@@ -293,6 +416,14 @@ std::string DebugHttpServer::GetDashboardHtml() {
             ).join('');
         }
 
+        function updateHistogram(id, buckets) {
+            const chart = document.getElementById(id);
+            const maxVal = Math.max(1, ...buckets);
+            chart.innerHTML = buckets.map((v, i) =>
+                `<div class="bar" title="${v}" style="height: ${(v / maxVal) * 100}%; background: ${i >= 9 ? '#ff4444' : i >= 7 ? '#ffaa00' : '#00d4ff'}"></div>`
+            ).join('');
+        }
+
         function setValueWithClass(id, value, thresholds) {
             const el = document.getElementById(id);
             el.textContent = value;
@@ -315,7 +446,31 @@ std::string DebugHttpServer::GetDashboardHtml() {
                 // Performance
                 setValueWithClass('tick-avg', formatMs(data.tick_avg_ms || 0), {warning: 40, danger: 50});
                 setValueWithClass('tick-max', formatMs(data.tick_max_ms || 0), {warning: 50, danger: 100});
-                document.getElementById('tps').textContent = (data.tps || 0).toFixed(1);
+                document.getElementById('tps').textContent = (data.tps || 0).toFixed(1) + ' / ' + (data.tps_target || 0);
+                setValueWithClass('tick-missed', (data.missed_deadlines || 0) + ' / ' + (data.skipped_ticks || 0));
+                setValueWithClass('tick-jitter-max', (data.tick_jitter_max_us || 0) + ' us', {warning: 1000, danger: 5000});
+                document.getElementById('tick-throughput').textContent = (data.tick_throughput || 0).toFixed(1) + ' ticks/s';
+                setValueWithClass('update-latency', formatMs(data.update_latency_avg_ms || 0) + ' / ' + formatMs(data.update_latency_max_ms || 0));
+                setValueWithClass('pipeline', (data.pipelined ? 'on' : 'off') + ' / ' + (data.encoder_stalls || 0));
+                document.getElementById('zones').textContent = (data.zones || [])
+                    .map(z => z.map + ': ' + formatMs(z.tick_ms) + ' / ' + z.players +
+                        ' (bcast ' + formatMs((z.broadcast_viewer_ms || 0) + (z.broadcast_lookup_ms || 0) +
+                        (z.broadcast_send_ms || 0)) + ')').join(', ') +
+                    ' / ' + (data.zone_transfers || 0);
+                document.getElementById('shard').textContent = (data.shard_index || 0) + '/' + (data.shard_count || 1) +
+                    ' / ' + (data.ghosts || 0) + ' / ' + (data.handoffs_out || 0) + ' / ' + (data.handoffs_in || 0);
+                const chunkLookups = (data.map_chunk_cache_hits || 0) + (data.map_chunk_cache_misses || 0);
+                const chunkSaved = (data.map_chunk_raw_bytes || 0) - (data.map_chunk_bytes || 0) + (data.map_chunk_held_bytes || 0);
+                document.getElementById('map-chunks').textContent = (data.map_chunks_sent || 0) + ' / ' +
+                    (chunkLookups ? (100 * (data.map_chunk_cache_hits || 0) / chunkLookups).toFixed(1) : '0.0') + '% / ' +
+                    formatBytes(chunkSaved);
+                document.getElementById('map-files').textContent = (data.map_loads || 0) + ' / ' +
+                    (data.map_releases || 0) + ' / ' + (data.map_load_last_ms || 0).toFixed(2) + 'ms';
+                document.getElementById('tile-edits').textContent = (data.tile_edits || 0) + ' / ' +
+                    (data.tile_changes || 0) + ' / ' + (data.tile_update_packets || 0) + ' / ' +
+                    formatBytes(data.tile_update_bytes || 0) +
+                    (data.tile_edits_dropped ? ' (' + data.tile_edits_dropped + ' dropped)' : '');
+                if (data.tick_jitter_hist) updateHistogram('tick-jitter-chart', data.tick_jitter_hist);
 
                 // Track history
                 if (data.tick_avg_ms !== undefined) {
@@ -357,6 +512,17 @@ std::string DebugHttpServer::GetDashboardHtml() {
                 setValueWithClass('vq-addknown', formatMs(data.vq_addknown_ms || 0), {warning: 10, danger: 20});
                 document.getElementById('vq-nearby').textContent = data.vq_nearby_count || 0;
 
+                // Send queue backpressure
+                setValueWithClass('sq-max', (data.send_queue_max_packets || 0) + ' pkts / ' + formatBytes(data.send_queue_max_bytes || 0),
+                                  {warning: 64, danger: 256});
+                document.getElementById('sq-conflated').textContent = data.send_queue_conflated || 0;
+                document.getElementById('sq-dropped').textContent = data.send_queue_dropped || 0;
+                setValueWithClass('sq-kicks', String(data.slow_consumer_kicks || 0), {warning: 1, danger: 10});
+                setValueWithClass('cmd-dropped', String(data.commands_dropped || 0), {warning: 1, danger: 1000});
+                setValueWithClass('input-flood', (data.input_overflows || 0) + ' / ' + (data.input_flood_kicks || 0));
+                if (data.send_queue_packets_hist) updateHistogram('sq-packets-chart', data.send_queue_packets_hist);
+                if (data.send_queue_kb_hist) updateHistogram('sq-kb-chart', data.send_queue_kb_hist);
+
             } catch (e) {
                 document.getElementById('status').className = 'status offline';
                 document.getElementById('refresh-indicator').textContent = 'Connection lost';
@@ -4,6 +4,7 @@
 /// Simple HTTP server for viewing server stats in a browser.
 /// Runs on a separate port (default 8081) and serves:
 /// - GET /stats - JSON stats
+/// - GET /trace - Packet trace status/control (see PacketTrace.h)
 /// - GET / - HTML dashboard
 ///
 /// Created by Anonymous on Dec 11, 2025
@@ -46,6 +47,9 @@ private:
     std::string GetDashboardHtml();
     std::string GetStatsJson();
 
+    /// Apply query flags (on, off, rate=N, client=ID, dump) and return trace status JSON
+    std::string HandleTraceRequest(const std::string& query);
+
     asio::io_context& io_context_;
     asio::ip::tcp::acceptor acceptor_;
     uint16_t port_;
@@ -0,0 +1,140 @@
+/// =======================================
+/// DyeWarsServer - PerfCounters
+///
+/// Hardware counters (cache misses, cache references, instructions) around
+/// a stretch of code on the calling thread, via Linux perf_event_open.
+///
+///   counters.Start();
+///   BroadcastDirtyPlayers(...);
+///   if (auto sample = counters.Stop(); sample.valid) Stats().Record...(sample);
+///
+/// WHY:
+/// Handle-keyed player storage (SlotMap) exists to cut cache misses in the
+/// broadcast phase. Milliseconds mix that with everything else the machine
+/// is doing; misses per tick measure it directly. The zone records them in
+/// ServerStats (broadcast_cache_misses etc. in /stats).
+///
+/// SCOPE:
+/// Counts the thread that calls Start/Stop only - parts of a ParallelFor
+/// that run on job workers are not included. Run with --job-threads 0 to
+/// count the whole phase.
+///
+/// Opened lazily by the first Start(), so it binds to the thread that
+/// measures (the zone thread), not the one that built the Zone. Needs
+/// kernel.perf_event_paranoid <= 2 (user-space counting only). Where perf
+/// is unavailable (other OSes, containers, no PMU) it is a no-op and every
+/// Sample comes back invalid.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+class PerfCounters {
+public:
+    struct Sample {
+        uint64_t cache_misses = 0;
+        uint64_t cache_references = 0;
+        uint64_t instructions = 0;
+        bool valid = false;
+    };
+
+    PerfCounters() = default;
+
+    PerfCounters(const PerfCounters &) = delete;
+
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    /// Zero the counters and start counting on this thread
+    void Start() {
+#ifdef __linux__
+        if (!opened_) Open();
+        if (fds_[0] < 0) return;
+        ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    /// Stop counting and read what happened since Start()
+    Sample Stop() {
+        Sample sample;
+#ifdef __linux__
+        if (fds_[0] < 0) return sample;
+        ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // PERF_FORMAT_GROUP: {nr, value[nr]}
+        struct {
+            uint64_t nr;
+            uint64_t values[COUNTERS];
+        } data{};
+        if (read(fds_[0], &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data.nr != COUNTERS) {
+            return sample;
+        }
+        sample.cache_misses = data.values[0];
+        sample.cache_references = data.values[1];
+        sample.instructions = data.values[2];
+        sample.valid = true;
+#endif
+        return sample;
+    }
+
+    /// False until the first Start(), and forever if perf refused
+    bool Available() const { return fds_[0] >= 0; }
+
+private:
+    static constexpr size_t COUNTERS = 3;
+
+#ifdef __linux__
+    void Open() {
+        opened_ = true;
+        static constexpr std::array<uint64_t, COUNTERS> EVENTS{
+                PERF_COUNT_HW_CACHE_MISSES,
+                PERF_COUNT_HW_CACHE_REFERENCES,
+                PERF_COUNT_HW_INSTRUCTIONS};
+
+        for (size_t i = 0; i < COUNTERS; i++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = EVENTS[i];
+            attr.disabled = i == 0 ? 1 : 0;  // The leader enables the group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            // pid 0, cpu -1: this thread, on whichever CPU it runs
+            const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, fds_[0], 0));
+            if (fd < 0) {
+                for (int &open_fd : fds_) {
+                    if (open_fd >= 0) close(open_fd);
+                    open_fd = -1;
+                }
+                return;
+            }
+            fds_[i] = fd;
+        }
+    }
+#endif
+
+    std::array<int, COUNTERS> fds_{-1, -1, -1};  // [0] is the group leader
+    bool opened_ = false;
+};
@@ -2,13 +2,16 @@
 /// DyeWarsServer - Server Stats
 ///
 /// Thread-safe stats collection for the debug dashboard.
-/// Updated by GameServer each tick, read by DebugHttpServer.
+/// Updated by the zones each tick, read by DebugHttpServer.
 ///
 /// Created by Anonymous on Dec 11, 2025
 /// =======================================
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
 #include <mutex>
 #include <string>
 #include <deque>
@@ -38,6 +41,56 @@ public:
         }
     }
 
+    // Tick start jitter: how late each tick began relative to its deadline,
+    // in power-of-two microsecond buckets (0, 1, 2-3 ... 16384+). Cumulative
+    // since startup; the max resets with ResetMaxValues.
+    static constexpr size_t TICK_JITTER_BUCKETS = 16;
+
+    /// Record one tick start (game thread, see TickScheduler)
+    void RecordTickStart(uint64_t jitter_us, uint64_t missed_deadlines, uint64_t skipped_ticks) {
+        size_t bucket = static_cast<size_t>(std::bit_width(jitter_us));
+        if (bucket >= TICK_JITTER_BUCKETS) bucket = TICK_JITTER_BUCKETS - 1;
+        tick_jitter_hist_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        if (jitter_us > tick_jitter_max_us_.load(std::memory_order_relaxed)) {
+            tick_jitter_max_us_.store(jitter_us, std::memory_order_relaxed);
+        }
+        missed_deadlines_.store(missed_deadlines, std::memory_order_relaxed);
+        skipped_ticks_.store(skipped_ticks, std::memory_order_relaxed);
+    }
+
+    void SetTargetTps(uint32_t tps) {
+        target_tps_.store(tps, std::memory_order_relaxed);
+    }
+
+    /// Ticks actually completed per wall-clock second (game thread, once a
+    /// second). Unlike "tps", which is 1000 / avg tick ms - what the game
+    /// thread could sustain - this is what it did.
+    void SetTickThroughput(double ticks_per_sec) {
+        tick_throughput_.store(ticks_per_sec, std::memory_order_relaxed);
+    }
+
+    void SetPipelined(bool pipelined) {
+        pipelined_.store(pipelined, std::memory_order_relaxed);
+    }
+
+    /// Tick start to the tick's last packet queued for sending. Written by
+    /// whichever thread encodes (one at a time), so plain load/store is enough.
+    void RecordUpdateLatency(double latency_ms) {
+        const double avg = update_latency_avg_ms_.load(std::memory_order_relaxed);
+        update_latency_avg_ms_.store(avg == 0.0 ? latency_ms : avg * 0.95 + latency_ms * 0.05,
+                                     std::memory_order_relaxed);
+        update_latency_last_ms_.store(latency_ms, std::memory_order_relaxed);
+        if (latency_ms > update_latency_max_ms_.load(std::memory_order_relaxed)) {
+            update_latency_max_ms_.store(latency_ms, std::memory_order_relaxed);
+        }
+    }
+
+    /// Game thread waited because the encoder was a full pipeline behind
+    void RecordEncoderStall() {
+        encoder_stalls_.fetch_add(1, std::memory_order_relaxed);
+    }
+
     void RecordBotMovement(double spatial_ms, double visibility_ms, double departure_ms) {
         // No mutex needed - these are independent atomic stores
         spatial_time_ms_.store(spatial_ms, std::memory_order_relaxed);
@@ -49,25 +102,133 @@ public:
         broadcast_time_ms_.store(broadcast_ms, std::memory_order_relaxed);
     }
 
-    void RecordBroadcastBreakdown(double viewer_ms, double lookup_ms, double send_ms,
+    /// Per zone, like RecordZoneTick - every zone thread broadcasts. The
+    /// top-level JSON fields are these summed over zones.
+    void RecordBroadcastBreakdown(uint16_t map_id, double viewer_ms, double lookup_ms, double send_ms,
                                   size_t viewer_count, size_t dirty_count) {
-        broadcast_viewer_ms_.store(viewer_ms, std::memory_order_relaxed);
-        broadcast_lookup_ms_.store(lookup_ms, std::memory_order_relaxed);
-        broadcast_send_ms_.store(send_ms, std::memory_order_relaxed);
-        broadcast_viewer_count_.store(viewer_count, std::memory_order_relaxed);
-        broadcast_dirty_count_.store(dirty_count, std::memory_order_relaxed);
+        if (map_id >= MAX_ZONES) return;
+        auto &zone = zones_[map_id];
+        zone.broadcast_viewer_ms.store(viewer_ms, std::memory_order_relaxed);
+        zone.broadcast_lookup_ms.store(lookup_ms, std::memory_order_relaxed);
+        zone.broadcast_send_ms.store(send_ms, std::memory_order_relaxed);
+        zone.broadcast_viewer_count.store(viewer_count, std::memory_order_relaxed);
+        zone.broadcast_dirty_count.store(dirty_count, std::memory_order_relaxed);
     }
 
-    void RecordViewerQueryBreakdown(double spatial_ms, double addknown_ms, size_t nearby_count) {
-        vq_spatial_ms_.store(spatial_ms, std::memory_order_relaxed);
-        vq_addknown_ms_.store(addknown_ms, std::memory_order_relaxed);
-        vq_nearby_count_.store(nearby_count, std::memory_order_relaxed);
+    void RecordViewerQueryBreakdown(uint16_t map_id, double spatial_ms, double addknown_ms, size_t nearby_count) {
+        if (map_id >= MAX_ZONES) return;
+        auto &zone = zones_[map_id];
+        zone.vq_spatial_ms.store(spatial_ms, std::memory_order_relaxed);
+        zone.vq_addknown_ms.store(addknown_ms, std::memory_order_relaxed);
+        zone.vq_nearby_count.store(nearby_count, std::memory_order_relaxed);
+    }
+
+    /// Hardware counters over the last broadcast phase (see PerfCounters).
+    /// Never called where perf is unavailable - the fields stay 0.
+    void RecordBroadcastCounters(uint64_t cache_misses, uint64_t cache_references, uint64_t instructions) {
+        broadcast_cache_misses_.store(cache_misses, std::memory_order_relaxed);
+        broadcast_cache_refs_.store(cache_references, std::memory_order_relaxed);
+        broadcast_instructions_.store(instructions, std::memory_order_relaxed);
     }
 
     void SetDirtyPlayerCount(size_t count) {
         dirty_players_last_.store(count, std::memory_order_relaxed);
     }
 
+    // =========================================================================
+    // ZONE STATS (each zone's thread, every tick - see Zone)
+    // =========================================================================
+
+    static constexpr size_t MAX_ZONES = 16;
+
+    void SetZoneCount(size_t zones) {
+        zone_count_.store(std::min(zones, MAX_ZONES), std::memory_order_relaxed);
+    }
+
+    void RecordZoneTick(uint16_t map_id, double tick_ms, size_t players, uint64_t missed_deadlines) {
+        if (map_id >= MAX_ZONES) return;
+        auto &zone = zones_[map_id];
+        zone.tick_ms.store(tick_ms, std::memory_order_relaxed);
+        zone.players.store(players, std::memory_order_relaxed);
+        zone.missed_deadlines.store(missed_deadlines, std::memory_order_relaxed);
+    }
+
+    /// A player arrived in another zone
+    void RecordZoneTransfer() {
+        zone_transfers_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // =========================================================================
+    // SHARD STATS (sharded zone's thread - see ShardLayout, --shard)
+    // =========================================================================
+
+    void SetShard(uint8_t index, uint8_t count) {
+        shard_index_.store(index, std::memory_order_relaxed);
+        shard_count_.store(count, std::memory_order_relaxed);
+    }
+
+    void SetGhostCount(size_t ghosts) {
+        ghost_count_.store(ghosts, std::memory_order_relaxed);
+    }
+
+    /// Ownership of a player sent to a neighbour shard
+    void RecordHandoffOut() {
+        handoffs_out_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// A handed-off client resumed here
+    void RecordHandoffIn() {
+        handoffs_in_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// A handoff whose client never showed up
+    void RecordHandoffExpired() {
+        handoffs_expired_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // =========================================================================
+    // MAP STREAMING STATS (each zone's thread - see MapStreamer)
+    // =========================================================================
+
+    /// One tick's chunk traffic: what was sent, what the per-client chunk
+    /// versions saved (chunks a client already held) and how often the
+    /// encoded-chunk cache served a send
+    void RecordMapChunks(uint64_t sent, uint64_t bytes, uint64_t raw_bytes, uint64_t held_skips,
+                         uint64_t held_bytes, uint64_t cache_hits, uint64_t cache_misses) {
+        map_chunks_sent_.fetch_add(sent, std::memory_order_relaxed);
+        map_chunk_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        map_chunk_raw_bytes_.fetch_add(raw_bytes, std::memory_order_relaxed);
+        map_chunk_held_skips_.fetch_add(held_skips, std::memory_order_relaxed);
+        map_chunk_held_bytes_.fetch_add(held_bytes, std::memory_order_relaxed);
+        map_chunk_cache_hits_.fetch_add(cache_hits, std::memory_order_relaxed);
+        map_chunk_cache_misses_.fetch_add(cache_misses, std::memory_order_relaxed);
+    }
+
+    /// A zone mapped its .dwm file (--map-dir), taking load_ms
+    void RecordMapLoad(double load_ms) {
+        map_loads_.fetch_add(1, std::memory_order_relaxed);
+        map_load_last_ms_.store(load_ms, std::memory_order_relaxed);
+    }
+
+    /// A zone released its idle file-backed map
+    void RecordMapRelease() {
+        map_releases_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// One tick's tile edits: edits applied, net tile changes after
+    /// deduplication, and the S_Tile_Update packets/bytes sent for them
+    void RecordTileUpdates(uint64_t edits, uint64_t changes, uint64_t packets, uint64_t bytes) {
+        tile_edits_.fetch_add(edits, std::memory_order_relaxed);
+        tile_changes_.fetch_add(changes, std::memory_order_relaxed);
+        tile_update_packets_.fetch_add(packets, std::memory_order_relaxed);
+        tile_update_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /// A zone's tile edit ring was full (Zone::QueueTileEdit)
+    void RecordTileEditDrop() {
+        tile_edits_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
     // =========================================================================
     // CONNECTION STATS
     // =========================================================================
@@ -94,6 +255,64 @@ public:
         packets_out_per_sec_.store(packets_out_per_sec, std::memory_order_relaxed);
     }
 
+    // =========================================================================
+    // SEND QUEUE / BACKPRESSURE STATS
+    //
+    // Histograms use power-of-two buckets: bucket 0 = 0, bucket 1 = 1,
+    // bucket 2 = 2-3, bucket 3 = 4-7, ... last bucket = everything above.
+    // Packets are counted directly, bytes in KB.
+    // =========================================================================
+
+    static constexpr size_t QUEUE_HISTOGRAM_BUCKETS = 12;
+    using QueueHistogram = std::array<uint32_t, QUEUE_HISTOGRAM_BUCKETS>;
+
+    /// Bucket index for a queue depth value
+    static size_t QueueHistogramBucket(size_t value) {
+        const size_t bucket = static_cast<size_t>(std::bit_width(value));
+        return bucket < QUEUE_HISTOGRAM_BUCKETS ? bucket : QUEUE_HISTOGRAM_BUCKETS - 1;
+    }
+
+    /// Publish a snapshot of every connection's send queue (game thread, once per second)
+    void SetSendQueueHistograms(const QueueHistogram &packets, const QueueHistogram &kilobytes,
+                                size_t max_packets, size_t max_bytes) {
+        for (size_t i = 0; i < QUEUE_HISTOGRAM_BUCKETS; i++) {
+            send_queue_packets_hist_[i].store(packets[i], std::memory_order_relaxed);
+            send_queue_kb_hist_[i].store(kilobytes[i], std::memory_order_relaxed);
+        }
+        send_queue_max_packets_.store(max_packets, std::memory_order_relaxed);
+        send_queue_max_bytes_.store(max_bytes, std::memory_order_relaxed);
+    }
+
+    /// Queued spatial packets merged away by conflation (any thread)
+    void RecordSendQueueConflation(size_t packets_removed) {
+        send_queue_conflated_.fetch_add(packets_removed, std::memory_order_relaxed);
+    }
+
+    /// Non-critical packet dropped because a queue was over the drop mark (any thread)
+    void RecordSendQueueDrop() {
+        send_queue_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Connection disconnected for exceeding the kick mark (any thread)
+    void RecordSlowConsumerKick() {
+        slow_consumer_kicks_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Input command dropped because the game command ring was full (any thread)
+    void RecordCommandDrop() {
+        commands_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Move/turn dropped because the client's input queue was full (game thread)
+    void RecordInputOverflow() {
+        input_overflows_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Client disconnected for flooding inputs (game thread)
+    void RecordInputFloodKick() {
+        input_flood_kicks_.fetch_add(1, std::memory_order_relaxed);
+    }
+
     // =========================================================================
     // JSON OUTPUT
     // =========================================================================
@@ -102,7 +321,7 @@ public:
         std::lock_guard<std::mutex> lock(mutex_);
 
         double avg_ms = tick_count_ > 0 ? tick_total_ms_ / tick_count_ : 0;
-        double tps = avg_ms > 0 ? 1000.0 / avg_ms : 20.0;
+        double tps = avg_ms > 0 ? 1000.0 / avg_ms : target_tps_.load(std::memory_order_relaxed);
 
         // Build JSON manually to avoid dependency
         std::string json = "{";
@@ -111,6 +330,17 @@ public:
         json += "\"tick_last_ms\":" + std::to_string(last_tick_ms_) + ",";
         json += "\"tps\":" + std::to_string(tps) + ",";
         json += "\"dirty_players\":" + std::to_string(dirty_players_last_.load(std::memory_order_relaxed)) + ",";
+        json += "\"tps_target\":" + std::to_string(target_tps_.load(std::memory_order_relaxed)) + ",";
+        json += "\"tick_jitter_hist\":" + HistogramToJson(tick_jitter_hist_) + ",";
+        json += "\"tick_jitter_max_us\":" + std::to_string(tick_jitter_max_us_.load(std::memory_order_relaxed)) + ",";
+        json += "\"missed_deadlines\":" + std::to_string(missed_deadlines_.load(std::memory_order_relaxed)) + ",";
+        json += "\"skipped_ticks\":" + std::to_string(skipped_ticks_.load(std::memory_order_relaxed)) + ",";
+        json += "\"tick_throughput\":" + std::to_string(tick_throughput_.load(std::memory_order_relaxed)) + ",";
+        json += std::string("\"pipelined\":") + (pipelined_.load(std::memory_order_relaxed) ? "true" : "false") + ",";
+        json += "\"update_latency_ms\":" + std::to_string(update_latency_last_ms_.load(std::memory_order_relaxed)) + ",";
+        json += "\"update_latency_avg_ms\":" + std::to_string(update_latency_avg_ms_.load(std::memory_order_relaxed)) + ",";
+        json += "\"update_latency_max_ms\":" + std::to_string(update_latency_max_ms_.load(std::memory_order_relaxed)) + ",";
+        json += "\"encoder_stalls\":" + std::to_string(encoder_stalls_.load(std::memory_order_relaxed)) + ",";
 
         json += "\"spatial_time_ms\":" + std::to_string(spatial_time_ms_.load(std::memory_order_relaxed)) + ",";
         json += "\"visibility_time_ms\":" + std::to_string(visibility_time_ms_.load(std::memory_order_relaxed)) + ",";
@@ -127,19 +357,93 @@ public:
         json += "\"bytes_out_total\":" + std::to_string(bytes_out_total_.load(std::memory_order_relaxed)) + ",";
         json += "\"packets_out_per_sec\":" + std::to_string(packets_out_per_sec_.load(std::memory_order_relaxed)) + ",";
 
-        // Broadcast breakdown
-        json += "\"broadcast_viewer_ms\":" + std::to_string(broadcast_viewer_ms_.load(std::memory_order_relaxed)) + ",";
-        json += "\"broadcast_lookup_ms\":" + std::to_string(broadcast_lookup_ms_.load(std::memory_order_relaxed)) + ",";
-        json += "\"broadcast_send_ms\":" + std::to_string(broadcast_send_ms_.load(std::memory_order_relaxed)) + ",";
-        json += "\"broadcast_viewer_count\":" + std::to_string(broadcast_viewer_count_.load(std::memory_order_relaxed))
-                + ",";
-        json += "\"broadcast_dirty_count\":" + std::to_string(broadcast_dirty_count_.load(std::memory_order_relaxed)) +
-                ",";
-
-        // Viewer query sub-breakdown
-        json += "\"vq_spatial_ms\":" + std::to_string(vq_spatial_ms_.load(std::memory_order_relaxed)) + ",";
-        json += "\"vq_addknown_ms\":" + std::to_string(vq_addknown_ms_.load(std::memory_order_relaxed)) + ",";
-        json += "\"vq_nearby_count\":" + std::to_string(vq_nearby_count_.load(std::memory_order_relaxed));
+        // Broadcast breakdown and viewer query sub-breakdown, summed over
+        // zones (each zone's own values are in "zones" below)
+        const size_t zone_count = zone_count_.load(std::memory_order_relaxed);
+        double viewer_ms = 0, lookup_ms = 0, send_ms = 0, vq_spatial_ms = 0, vq_addknown_ms = 0;
+        size_t viewer_count = 0, dirty_count = 0, vq_nearby_count = 0;
+        for (size_t i = 0; i < zone_count; i++) {
+            const auto &zone = zones_[i];
+            viewer_ms += zone.broadcast_viewer_ms.load(std::memory_order_relaxed);
+            lookup_ms += zone.broadcast_lookup_ms.load(std::memory_order_relaxed);
+            send_ms += zone.broadcast_send_ms.load(std::memory_order_relaxed);
+            viewer_count += zone.broadcast_viewer_count.load(std::memory_order_relaxed);
+            dirty_count += zone.broadcast_dirty_count.load(std::memory_order_relaxed);
+            vq_spatial_ms += zone.vq_spatial_ms.load(std::memory_order_relaxed);
+            vq_addknown_ms += zone.vq_addknown_ms.load(std::memory_order_relaxed);
+            vq_nearby_count += zone.vq_nearby_count.load(std::memory_order_relaxed);
+        }
+        json += "\"broadcast_viewer_ms\":" + std::to_string(viewer_ms) + ",";
+        json += "\"broadcast_lookup_ms\":" + std::to_string(lookup_ms) + ",";
+        json += "\"broadcast_send_ms\":" + std::to_string(send_ms) + ",";
+        json += "\"broadcast_viewer_count\":" + std::to_string(viewer_count) + ",";
+        json += "\"broadcast_dirty_count\":" + std::to_string(dirty_count) + ",";
+        json += "\"vq_spatial_ms\":" + std::to_string(vq_spatial_ms) + ",";
+        json += "\"vq_addknown_ms\":" + std::to_string(vq_addknown_ms) + ",";
+        json += "\"vq_nearby_count\":" + std::to_string(vq_nearby_count) + ",";
+
+        // Broadcast hardware counters (0 without perf)
+        json += "\"broadcast_cache_misses\":" + std::to_string(broadcast_cache_misses_.load(std::memory_order_relaxed)) + ",";
+        json += "\"broadcast_cache_refs\":" + std::to_string(broadcast_cache_refs_.load(std::memory_order_relaxed)) + ",";
+        json += "\"broadcast_instructions\":" + std::to_string(broadcast_instructions_.load(std::memory_order_relaxed)) + ",";
+
+        // Send queue backpressure
+        json += "\"send_queue_packets_hist\":" + HistogramToJson(send_queue_packets_hist_) + ",";
+        json += "\"send_queue_kb_hist\":" + HistogramToJson(send_queue_kb_hist_) + ",";
+        json += "\"send_queue_max_packets\":" + std::to_string(send_queue_max_packets_.load(std::memory_order_relaxed)) + ",";
+        json += "\"send_queue_max_bytes\":" + std::to_string(send_queue_max_bytes_.load(std::memory_order_relaxed)) + ",";
+        json += "\"send_queue_conflated\":" + std::to_string(send_queue_conflated_.load(std::memory_order_relaxed)) + ",";
+        json += "\"send_queue_dropped\":" + std::to_string(send_queue_dropped_.load(std::memory_order_relaxed)) + ",";
+        json += "\"slow_consumer_kicks\":" + std::to_string(slow_consumer_kicks_.load(std::memory_order_relaxed)) + ",";
+        json += "\"commands_dropped\":" + std::to_string(commands_dropped_.load(std::memory_order_relaxed)) + ",";
+        json += "\"input_overflows\":" + std::to_string(input_overflows_.load(std::memory_order_relaxed)) + ",";
+        json += "\"input_flood_kicks\":" + std::to_string(input_flood_kicks_.load(std::memory_order_relaxed)) + ",";
+
+        // Per zone: [{map, tick_ms, players, missed_deadlines, broadcast_*, vq_*}, ...]
+        json += "\"zones\":[";
+        for (size_t i = 0; i < zone_count; i++) {
+            const auto &zone = zones_[i];
+            if (i > 0) json += ",";
+            json += "{\"map\":" + std::to_string(i) +
+                    ",\"tick_ms\":" + std::to_string(zone.tick_ms.load(std::memory_order_relaxed)) +
+                    ",\"players\":" + std::to_string(zone.players.load(std::memory_order_relaxed)) +
+                    ",\"missed_deadlines\":" + std::to_string(zone.missed_deadlines.load(std::memory_order_relaxed)) +
+                    ",\"broadcast_viewer_ms\":" + std::to_string(zone.broadcast_viewer_ms.load(std::memory_order_relaxed)) +
+                    ",\"broadcast_lookup_ms\":" + std::to_string(zone.broadcast_lookup_ms.load(std::memory_order_relaxed)) +
+                    ",\"broadcast_send_ms\":" + std::to_string(zone.broadcast_send_ms.load(std::memory_order_relaxed)) +
+                    ",\"broadcast_viewer_count\":" + std::to_string(zone.broadcast_viewer_count.load(std::memory_order_relaxed)) +
+                    ",\"broadcast_dirty_count\":" + std::to_string(zone.broadcast_dirty_count.load(std::memory_order_relaxed)) +
+                    ",\"vq_spatial_ms\":" + std::to_string(zone.vq_spatial_ms.load(std::memory_order_relaxed)) +
+                    ",\"vq_addknown_ms\":" + std::to_string(zone.vq_addknown_ms.load(std::memory_order_relaxed)) +
+                    ",\"vq_nearby_count\":" + std::to_string(zone.vq_nearby_count.load(std::memory_order_relaxed)) + "}";
+        }
+        json += "],";
+        json += "\"zone_transfers\":" + std::to_string(zone_transfers_.load(std::memory_order_relaxed)) + ",";
+
+        // Shards
+        json += "\"shard_index\":" + std::to_string(shard_index_.load(std::memory_order_relaxed)) + ",";
+        json += "\"shard_count\":" + std::to_string(shard_count_.load(std::memory_order_relaxed)) + ",";
+        json += "\"ghosts\":" + std::to_string(ghost_count_.load(std::memory_order_relaxed)) + ",";
+        json += "\"handoffs_out\":" + std::to_string(handoffs_out_.load(std::memory_order_relaxed)) + ",";
+        json += "\"handoffs_in\":" + std::to_string(handoffs_in_.load(std::memory_order_relaxed)) + ",";
+        json += "\"handoffs_expired\":" + std::to_string(handoffs_expired_.load(std::memory_order_relaxed)) + ",";
+
+        // Map streaming
+        json += "\"map_chunks_sent\":" + std::to_string(map_chunks_sent_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_chunk_bytes\":" + std::to_string(map_chunk_bytes_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_chunk_raw_bytes\":" + std::to_string(map_chunk_raw_bytes_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_chunk_held_skips\":" + std::to_string(map_chunk_held_skips_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_chunk_held_bytes\":" + std::to_string(map_chunk_held_bytes_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_chunk_cache_hits\":" + std::to_string(map_chunk_cache_hits_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_chunk_cache_misses\":" + std::to_string(map_chunk_cache_misses_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_loads\":" + std::to_string(map_loads_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_releases\":" + std::to_string(map_releases_.load(std::memory_order_relaxed)) + ",";
+        json += "\"map_load_last_ms\":" + std::to_string(map_load_last_ms_.load(std::memory_order_relaxed)) + ",";
+        json += "\"tile_edits\":" + std::to_string(tile_edits_.load(std::memory_order_relaxed)) + ",";
+        json += "\"tile_changes\":" + std::to_string(tile_changes_.load(std::memory_order_relaxed)) + ",";
+        json += "\"tile_update_packets\":" + std::to_string(tile_update_packets_.load(std::memory_order_relaxed)) + ",";
+        json += "\"tile_update_bytes\":" + std::to_string(tile_update_bytes_.load(std::memory_order_relaxed)) + ",";
+        json += "\"tile_edits_dropped\":" + std::to_string(tile_edits_dropped_.load(std::memory_order_relaxed));
         json += "}";
 
         return json;
@@ -149,9 +453,21 @@ public:
     void ResetMaxValues() {
         std::lock_guard<std::mutex> lock(mutex_);
         tick_max_ms_ = 0;
+        tick_jitter_max_us_.store(0, std::memory_order_relaxed);
+        update_latency_max_ms_.store(0.0, std::memory_order_relaxed);
     }
 
 private:
+    template<typename T, size_t N>
+    static std::string HistogramToJson(const std::array<std::atomic<T>, N> &hist) {
+        std::string json = "[";
+        for (size_t i = 0; i < N; i++) {
+            if (i > 0) json += ",";
+            json += std::to_string(hist[i].load(std::memory_order_relaxed));
+        }
+        return json + "]";
+    }
+
     mutable std::mutex mutex_;
 
     // Tick timing
@@ -161,6 +477,21 @@ private:
     double last_tick_ms_ = 0;
     size_t tick_count_ = 0;
 
+    // Tick scheduling (written by game thread, read by IO thread)
+    std::array<std::atomic<uint64_t>, TICK_JITTER_BUCKETS> tick_jitter_hist_{};
+    std::atomic<uint64_t> tick_jitter_max_us_{0};
+    std::atomic<uint64_t> missed_deadlines_{0};
+    std::atomic<uint64_t> skipped_ticks_{0};
+    std::atomic<uint32_t> target_tps_{20};
+    std::atomic<double> tick_throughput_{0.0};
+
+    // Tick pipelining (latency written by the encoding thread)
+    std::atomic<bool> pipelined_{false};
+    std::atomic<double> update_latency_last_ms_{0.0};
+    std::atomic<double> update_latency_avg_ms_{0.0};
+    std::atomic<double> update_latency_max_ms_{0.0};
+    std::atomic<uint64_t> encoder_stalls_{0};
+
     // Dirty player count (atomic - set from ProcessTick, read from JSON)
     std::atomic<size_t> dirty_players_last_{0};
 
@@ -170,17 +501,10 @@ private:
     std::atomic<double> departure_time_ms_{0.0};
     std::atomic<double> broadcast_time_ms_{0.0};
 
-    // Broadcast breakdown
-    std::atomic<double> broadcast_viewer_ms_{0.0};
-    std::atomic<double> broadcast_lookup_ms_{0.0};
-    std::atomic<double> broadcast_send_ms_{0.0};
-    std::atomic<size_t> broadcast_viewer_count_{0};
-    std::atomic<size_t> broadcast_dirty_count_{0};
-
-    // Viewer query sub-breakdown (within broadcast_viewer_ms)
-    std::atomic<double> vq_spatial_ms_{0.0};
-    std::atomic<double> vq_addknown_ms_{0.0};
-    std::atomic<size_t> vq_nearby_count_{0};
+    // Broadcast hardware counters (PerfCounters, zone thread only)
+    std::atomic<uint64_t> broadcast_cache_misses_{0};
+    std::atomic<uint64_t> broadcast_cache_refs_{0};
+    std::atomic<uint64_t> broadcast_instructions_{0};
 
     // Connection counts (atomic for lock-free reads)
     std::atomic<size_t> real_clients_{0};
@@ -193,4 +517,67 @@ private:
     std::atomic<uint64_t> bytes_out_avg_{0};
     std::atomic<uint64_t> bytes_out_total_{0};
     std::atomic<uint64_t> packets_out_per_sec_{0};
+
+    // Send queue backpressure (histograms written by game thread, counters by any thread)
+    std::array<std::atomic<uint32_t>, QUEUE_HISTOGRAM_BUCKETS> send_queue_packets_hist_{};
+    std::array<std::atomic<uint32_t>, QUEUE_HISTOGRAM_BUCKETS> send_queue_kb_hist_{};
+    std::atomic<size_t> send_queue_max_packets_{0};
+    std::atomic<size_t> send_queue_max_bytes_{0};
+    std::atomic<uint64_t> send_queue_conflated_{0};
+    std::atomic<uint64_t> send_queue_dropped_{0};
+    std::atomic<uint64_t> slow_consumer_kicks_{0};
+
+    // Game command ring overflow (IO threads) and per-client input caps (game thread)
+    std::atomic<uint64_t> commands_dropped_{0};
+    std::atomic<uint64_t> input_overflows_{0};
+    std::atomic<uint64_t> input_flood_kicks_{0};
+
+    // Zones
+    struct ZoneStats {
+        std::atomic<double> tick_ms{0.0};
+        std::atomic<size_t> players{0};
+        std::atomic<uint64_t> missed_deadlines{0};
+
+        // Broadcast breakdown
+        std::atomic<double> broadcast_viewer_ms{0.0};
+        std::atomic<double> broadcast_lookup_ms{0.0};
+        std::atomic<double> broadcast_send_ms{0.0};
+        std::atomic<size_t> broadcast_viewer_count{0};
+        std::atomic<size_t> broadcast_dirty_count{0};
+
+        // Viewer query sub-breakdown (within broadcast_viewer_ms)
+        std::atomic<double> vq_spatial_ms{0.0};
+        std::atomic<double> vq_addknown_ms{0.0};
+        std::atomic<size_t> vq_nearby_count{0};
+    };
+    std::array<ZoneStats, MAX_ZONES> zones_{};
+    std::atomic<size_t> zone_count_{1};
+    std::atomic<uint64_t> zone_transfers_{0};
+
+    // Shards
+    std::atomic<uint8_t> shard_index_{0};
+    std::atomic<uint8_t> shard_count_{1};
+    std::atomic<size_t> ghost_count_{0};
+    std::atomic<uint64_t> handoffs_out_{0};
+    std::atomic<uint64_t> handoffs_in_{0};
+    std::atomic<uint64_t> handoffs_expired_{0};
+
+    // Map streaming
+    std::atomic<uint64_t> map_chunks_sent_{0};
+    std::atomic<uint64_t> map_chunk_bytes_{0};
+    std::atomic<uint64_t> map_chunk_raw_bytes_{0};
+    std::atomic<uint64_t> map_chunk_held_skips_{0};
+    std::atomic<uint64_t> map_chunk_held_bytes_{0};
+    std::atomic<uint64_t> map_chunk_cache_hits_{0};
+    std::atomic<uint64_t> map_chunk_cache_misses_{0};
+    std::atomic<uint64_t> map_loads_{0};
+    std::atomic<uint64_t> map_releases_{0};
+    std::atomic<double> map_load_last_ms_{0.0};
+
+    // Tile edits
+    std::atomic<uint64_t> tile_edits_{0};
+    std::atomic<uint64_t> tile_changes_{0};
+    std::atomic<uint64_t> tile_update_packets_{0};
+    std::atomic<uint64_t> tile_update_bytes_{0};
+    std::atomic<uint64_t> tile_edits_dropped_{0};
 };
@@ -0,0 +1,54 @@
+/// =======================================
+/// DyeWarsServer - GameTime
+///
+/// The simulation's clock: how many ticks the zone has simulated, and how
+/// long one tick is. Cooldowns and anything else the game decides "over
+/// time" count these ticks instead of reading steady_clock.
+///
+/// WHY TICKS:
+/// AttemptMove / AttemptTurn used to call steady_clock::now() per input,
+/// so whether a move passed its cooldown depended on where in the tick
+/// (and how late) it happened to run. Counted in ticks, the outcome
+/// depends only on which tick an input is applied in - the same input
+/// stream gives the same game, bit for bit (see --deterministic), and the
+/// hot path makes no clock calls.
+///
+/// EXECUTED TICKS:
+/// `tick` counts ticks the zone actually ran. Ticks dropped by the Skip
+/// catch-up policy (TickScheduler) don't advance it, so under overload
+/// cooldowns stretch in wall time instead of letting players skip ahead.
+///
+/// Durations become whole ticks rounded down, at least 1: at 20 TPS the
+/// 280ms move cooldown is 5 ticks (250ms). Rounding down keeps clients
+/// that pace themselves in milliseconds from being refused at tick
+/// boundaries.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+struct GameTime {
+    /// A "last happened at" tick for something that never happened
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+    uint64_t tick = 0;
+    std::chrono::microseconds tick_length{50000};  // 20 TPS
+
+    /// Whole ticks in duration, rounded down, at least 1
+    uint64_t TicksFor(std::chrono::milliseconds duration) const {
+        const auto ticks = static_cast<uint64_t>(duration / tick_length);
+        return ticks > 0 ? ticks : 1;
+    }
+
+    /// Ticks since `since`, or NEVER if it never happened
+    uint64_t TicksSince(uint64_t since) const {
+        return since == NEVER ? NEVER : tick - since;
+    }
+
+    std::chrono::milliseconds ToMilliseconds(uint64_t ticks) const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(tick_length * static_cast<int64_t>(ticks));
+    }
+};
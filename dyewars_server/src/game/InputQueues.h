@@ -0,0 +1,161 @@
+/// =======================================
+/// DyeWarsServer - InputQueues
+///
+/// Bounded per-client input queues (moves, turns) drained a fixed number
+/// of entries per client per tick.
+///
+/// WHY:
+/// Every C_Move_Request used to run AttemptMove the tick it arrived. A
+/// client spamming 500 moves a second cost 500 AttemptMoves, and since
+/// most of them fail the move cooldown, 500 PositionCorrection packets.
+/// Now the game thread does at most INPUTS_PER_TICK inputs per client per
+/// tick, and anything beyond CAPACITY queued is dropped.
+///
+/// COALESCING:
+/// A turn only sets facing, so a turn queued right behind another turn
+/// replaces it (last facing wins). A player spinning in place takes one
+/// queue slot, not eight.
+///
+/// FLOOD DETECTION:
+/// Each dropped input counts against the client. The count resets when the
+/// queue drains empty, so a legit client whose inputs arrive in one burst
+/// after a lag spike loses a few moves and is fine. A client that keeps the
+/// queue full hits FLOOD_KICK_OVERFLOWS and its zone disconnects it.
+///
+/// THREAD SAFETY:
+/// Game thread only (ThreadOwner asserted). Inputs arrive through the
+/// zone's command ring and are routed here by Zone::ExecuteCommand.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "core/ThreadSafety.h"
+#include "game/actions/GameCommand.h"
+
+/// One client's queue: fixed ring of inputs, no allocation
+class InputQueue {
+public:
+    static constexpr size_t CAPACITY = 8;
+
+    enum class PushResult {
+        Queued,
+        Coalesced,  // Merged into the previous turn
+        Overflow,   // Queue full, input dropped
+    };
+
+    PushResult Push(const GameCommand &input) {
+        if (input.type == GameCommand::Type::Turn && count_ > 0) {
+            GameCommand &last = entries_[(head_ + count_ - 1) % CAPACITY];
+            if (last.type == GameCommand::Type::Turn) {
+                last.turn = input.turn;
+                return PushResult::Coalesced;
+            }
+        }
+        if (count_ == CAPACITY) {
+            overflowed_++;
+            return PushResult::Overflow;
+        }
+        entries_[(head_ + count_) % CAPACITY] = input;
+        count_++;
+        return PushResult::Queued;
+    }
+
+    bool Pop(GameCommand &out) {
+        if (count_ == 0) return false;
+        out = entries_[head_];
+        head_ = (head_ + 1) % CAPACITY;
+        count_--;
+        return true;
+    }
+
+    size_t Size() const { return count_; }
+
+    bool Empty() const { return count_ == 0; }
+
+    /// Inputs dropped since the queue was last empty
+    uint32_t Overflowed() const { return overflowed_; }
+
+    void ResetOverflow() { overflowed_ = 0; }
+
+private:
+    std::array<GameCommand, CAPACITY> entries_{};
+    size_t head_ = 0;
+    size_t count_ = 0;
+    uint32_t overflowed_ = 0;
+};
+
+/// All clients' queues plus the list of clients with something queued
+class InputQueues {
+public:
+    /// Inputs applied per client per tick. Moves have a 280ms cooldown
+    /// (~6 ticks), so 2 covers a move + turn with room to spare.
+    static constexpr size_t INPUTS_PER_TICK = 2;
+
+    /// Dropped inputs (without the queue ever draining) before a kick
+    static constexpr uint32_t FLOOD_KICK_OVERFLOWS = 64;
+
+    /// Queue a Move, Turn or Warp command for its client
+    InputQueue::PushResult Push(const GameCommand &input) {
+        AssertGameThread();
+        InputQueue &queue = queues_[input.client_id];
+        const bool was_empty = queue.Empty();
+        const auto result = queue.Push(input);
+        if (was_empty && !queue.Empty()) active_.push_back(input.client_id);
+        return result;
+    }
+
+    /// Inputs this client has had dropped since its queue was last empty
+    uint32_t Overflowed(uint64_t client_id) const {
+        AssertGameThread();
+        auto it = queues_.find(client_id);
+        return it == queues_.end() ? 0 : it->second.Overflowed();
+    }
+
+    /// Forget a client (on disconnect). Its queued inputs are discarded.
+    void Remove(uint64_t client_id) {
+        AssertGameThread();
+        queues_.erase(client_id);  // Stale active_ entry is skipped in Drain
+    }
+
+    /// Apply up to INPUTS_PER_TICK inputs for every client with queued input.
+    /// Cost is proportional to clients with input, not all clients.
+    template<typename Fn>
+    void Drain(Fn &&apply) {
+        AssertGameThread();
+        draining_.swap(active_);
+        active_.clear();
+
+        GameCommand input{};
+        for (const uint64_t client_id : draining_) {
+            auto it = queues_.find(client_id);
+            if (it == queues_.end()) continue;  // Disconnected while queued
+
+            for (size_t i = 0; i < INPUTS_PER_TICK && it->second.Pop(input); i++) {
+                apply(input);
+            }
+
+            if (it->second.Empty()) it->second.ResetOverflow();
+            else active_.push_back(client_id);
+        }
+        draining_.clear();
+    }
+
+    /// Clients with queued input (for stats)
+    size_t ActiveClients() const { return active_.size(); }
+
+private:
+    void AssertGameThread() const {
+        ASSERT_GAME_THREAD(thread_owner_);
+        if (!thread_owner_.IsOwnerSet()) thread_owner_.SetOwner();
+    }
+
+    std::unordered_map<uint64_t, InputQueue> queues_;
+    std::vector<uint64_t> active_;    // Clients with non-empty queues
+    std::vector<uint64_t> draining_;  // Reused scratch for Drain
+    mutable ThreadOwner thread_owner_;
+};
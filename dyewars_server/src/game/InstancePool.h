@@ -0,0 +1,101 @@
+/// =======================================
+/// DyeWarsServer - InstancePool
+///
+/// Worlds for instanced copies of one map (dungeons, arenas), built ahead
+/// of time and reused. Every World's TileMap is TileMap::InstanceOf() the
+/// pool's base map, so a World costs its spatial grid and what its players
+/// edit, never a copy of the map.
+///
+/// WHY PRE-WARM:
+/// An instance's TileMap is cheap to make, but its World isn't free: the
+/// SpatialHash flat grid is allocated per World (a cell list per 11x11
+/// tiles). Acquire() hands out a World built earlier, and Recycle() takes
+/// it back with its edits dropped (TileMap::ResetToBase) and players
+/// cleared, so the next group gets a fresh copy of the map without
+/// allocating one.
+///
+/// Not thread-safe, and a World stays on the thread that uses it (its
+/// SpatialHash claims that thread) - one pool per zone thread.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "TileMap.h"
+#include "World.h"
+
+class InstancePool {
+public:
+    struct Stats {
+        size_t created = 0;    // Worlds built (pre-warmed or on demand)
+        size_t acquired = 0;
+        size_t recycled = 0;   // Returned and kept for reuse
+        size_t discarded = 0;  // Returned past max_idle, or not from this pool
+    };
+
+    /// Builds `prewarm` Worlds now and keeps at most `max_idle` returned
+    /// ones (at least `prewarm`). Throws std::invalid_argument if `base`
+    /// can't be shared (see TileMap::InstanceOf).
+    InstancePool(std::shared_ptr<const TileMap> base, size_t prewarm, size_t max_idle = 0)
+            : base_(std::move(base)),
+              max_idle_(std::max(prewarm, max_idle)) {
+        if (!base_ || !base_->IsResident() || base_->IsInstance()) {
+            throw std::invalid_argument("Instance base must be a loaded, non-instance map");
+        }
+        Prewarm(prewarm);
+    }
+
+    /// Build Worlds until `count` are idle
+    void Prewarm(size_t count) {
+        idle_.reserve(std::max(count, max_idle_));
+        while (idle_.size() < count) idle_.push_back(Create());
+    }
+
+    /// A World on an unedited copy of the base, with no players - an idle
+    /// one if there is one, otherwise built now
+    std::unique_ptr<World> Acquire() {
+        stats_.acquired++;
+        if (idle_.empty()) return Create();
+        auto world = std::move(idle_.back());
+        idle_.pop_back();
+        return world;
+    }
+
+    /// Take a World back: its players and edits are dropped, and it's kept
+    /// for the next Acquire() unless max_idle are already waiting. Worlds
+    /// that aren't instances of this pool's base are destroyed.
+    void Recycle(std::unique_ptr<World> world) {
+        if (!world) return;
+        if (world->GetMap().GetBase() != base_ || idle_.size() >= max_idle_) {
+            stats_.discarded++;
+            return;
+        }
+        world->ClearPlayers();
+        world->GetMap().ResetToBase();
+        idle_.push_back(std::move(world));
+        stats_.recycled++;
+    }
+
+    const TileMap &Base() const { return *base_; }
+
+    size_t Available() const { return idle_.size(); }
+
+    const Stats &GetStats() const { return stats_; }
+
+private:
+    std::unique_ptr<World> Create() {
+        stats_.created++;
+        return std::make_unique<World>(TileMap::InstanceOf(base_));
+    }
+
+    std::shared_ptr<const TileMap> base_;
+    size_t max_idle_;
+    std::vector<std::unique_ptr<World>> idle_;
+    Stats stats_;
+};
@@ -0,0 +1,231 @@
+/// =======================================
+/// DyeWarsServer - MapFile
+/// =======================================
+#include "MapFile.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include "CollisionGrid.h"
+#include "TileMap.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Sections are used in place, so the file's byte order has to be ours
+static_assert(std::endian::native == std::endian::little, "MapFile assumes a little-endian host");
+
+namespace {
+    uint64_t AlignUp(uint64_t offset) {
+        return (offset + MapFile::SECTION_ALIGNMENT - 1) / MapFile::SECTION_ALIGNMENT * MapFile::SECTION_ALIGNMENT;
+    }
+
+    uint32_t ChunkCount(uint16_t width, uint16_t height, uint16_t chunk_size) {
+        return static_cast<uint32_t>((width + chunk_size - 1) / chunk_size) *
+               static_cast<uint32_t>((height + chunk_size - 1) / chunk_size);
+    }
+
+    [[noreturn]] void Fail(const std::string &path, const std::string &why) {
+        throw std::runtime_error(std::format("Map file {}: {}", path, why));
+    }
+}
+
+/// ============================================================================
+/// READING
+/// ============================================================================
+
+std::shared_ptr<const MapFile> MapFile::Open(const std::string &path) {
+    std::shared_ptr<MapFile> file(new MapFile());
+    file->path_ = path;
+
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) Fail(path, "can't open");
+    file->buffer_.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char *>(file->buffer_.data()), static_cast<std::streamsize>(file->buffer_.size()))) {
+        Fail(path, "read failed");
+    }
+    file->data_ = file->buffer_.data();
+    file->size_ = file->buffer_.size();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) Fail(path, std::format("can't open: {}", std::strerror(errno)));
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        ::close(fd);
+        Fail(path, "too small to be a map");
+    }
+
+    // The mapping outlives the descriptor
+    void *data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) Fail(path, std::format("mmap failed: {}", std::strerror(errno)));
+    file->data_ = static_cast<const uint8_t *>(data);
+    file->size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    if (file->size_ < sizeof(Header)) Fail(path, "too small to be a map");
+    std::memcpy(&file->header_, file->data_, sizeof(Header));
+    Validate(file->header_, file->size_, path);  // ~MapFile unmaps if this throws
+    return file;
+}
+
+MapFile::Header MapFile::ReadHeader(const std::string &path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) Fail(path, "can't open");
+    const auto size = static_cast<uint64_t>(in.tellg());
+
+    Header header{};
+    in.seekg(0);
+    if (size < sizeof(Header) || !in.read(reinterpret_cast<char *>(&header), sizeof(Header))) {
+        Fail(path, "too small to be a map");
+    }
+    Validate(header, size, path);
+    return header;
+}
+
+MapFile::~MapFile() {
+#ifndef _WIN32
+    if (data_) ::munmap(const_cast<uint8_t *>(data_), size_);
+#endif
+}
+
+void MapFile::Validate(const Header &header, uint64_t size, const std::string &path) {
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) Fail(path, "not a map file (bad magic)");
+    if (header.version != VERSION) Fail(path, std::format("version {}, expected {}", header.version, VERSION));
+    if (header.header_size != sizeof(Header)) Fail(path, std::format("header size {}", header.header_size));
+    if (header.width == 0 || header.width > 32767 || header.height == 0 || header.height > 32767) {
+        Fail(path, std::format("bad dimensions {}x{}", header.width, header.height));
+    }
+    if (header.chunk_size == 0) Fail(path, "chunk size 0");
+    if (header.name_length > MAX_NAME_LENGTH) Fail(path, "name too long");
+    if (header.file_size != size) Fail(path, std::format("truncated ({} of {} bytes)", size, header.file_size));
+
+    const uint64_t tile_bytes = static_cast<uint64_t>(header.width) * header.height;
+    const uint64_t collision_bytes =
+            uint64_t{header.collision_stride} * (header.height + 2u) * sizeof(uint64_t);
+    if (header.collision_stride != CollisionGrid::StrideFor(static_cast<int16_t>(header.width))) {
+        Fail(path, std::format("collision stride {}", header.collision_stride));
+    }
+    if (header.chunk_count != ChunkCount(header.width, header.height, header.chunk_size)) {
+        Fail(path, std::format("chunk count {}", header.chunk_count));
+    }
+
+    // Sections aligned, in order, not overlapping, inside the file
+    for (const uint64_t offset : {header.tiles_offset, header.collision_offset, header.chunk_index_offset}) {
+        if (offset % SECTION_ALIGNMENT != 0) Fail(path, std::format("unaligned section at {}", offset));
+    }
+    if (header.tiles_offset < sizeof(Header) ||
+        header.collision_offset < header.tiles_offset + tile_bytes ||
+        header.chunk_index_offset < header.collision_offset + collision_bytes ||
+        header.chunk_index_offset + uint64_t{header.chunk_count} * sizeof(ChunkEntry) > size) {
+        Fail(path, "sections overlap or run past the end");
+    }
+}
+
+uint64_t MapFile::HashChunk(std::span<const uint8_t> tiles, size_t width, size_t x0, size_t y0,
+                            size_t chunk_width, size_t chunk_height) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t y = y0; y < y0 + chunk_height; y++) {
+        for (const uint8_t tile : tiles.subspan(y * width + x0, chunk_width)) {
+            hash = (hash ^ tile) * 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
+
+/// ============================================================================
+/// WRITING
+/// ============================================================================
+
+void MapFile::Write(const std::string &path, const TileMap &map) {
+    if (!map.IsResident()) Fail(path, "map to write isn't loaded");
+
+    // An instance's tiles aren't one array (see TileMap::InstanceOf)
+    std::vector<uint8_t> flattened;
+    std::span<const uint8_t> tiles = map.GetRawTileData();
+    if (tiles.empty()) {
+        map.CopyRegionTiles(0, 0, map.GetWidth(), map.GetHeight(), flattened);
+        tiles = flattened;
+    }
+    const std::vector<uint64_t> collision = map.Collision().StaticWords();
+    const auto width = static_cast<uint16_t>(map.GetWidth());
+    const auto height = static_cast<uint16_t>(map.GetHeight());
+    constexpr uint16_t chunk_size = TileMap::CHUNK_SIZE;
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.header_size = sizeof(Header);
+    header.width = width;
+    header.height = height;
+    header.chunk_size = chunk_size;
+    header.tiles_offset = AlignUp(sizeof(Header));
+    header.collision_offset = AlignUp(header.tiles_offset + tiles.size());
+    header.collision_stride = static_cast<uint32_t>(CollisionGrid::StrideFor(map.GetWidth()));
+    header.chunk_count = ChunkCount(width, height, chunk_size);
+    header.chunk_index_offset = AlignUp(header.collision_offset + collision.size() * sizeof(uint64_t));
+    header.file_size = header.chunk_index_offset + uint64_t{header.chunk_count} * sizeof(ChunkEntry);
+    header.name_length = static_cast<uint8_t>(std::min(map.GetMapName().size(), MAX_NAME_LENGTH));
+    std::memcpy(header.name, map.GetMapName().data(), header.name_length);
+    header.blocking_hash = TileTypes::BlockingTableHash();
+
+    std::vector<ChunkEntry> index;
+    index.reserve(header.chunk_count);
+    for (size_t y0 = 0; y0 < height; y0 += chunk_size) {
+        for (size_t x0 = 0; x0 < width; x0 += chunk_size) {
+            const size_t chunk_width = std::min<size_t>(chunk_size, width - x0);
+            const size_t chunk_height = std::min<size_t>(chunk_size, height - y0);
+            std::array<bool, 256> seen{};
+            ChunkEntry entry{};
+            entry.hash = HashChunk(tiles, width, x0, y0, chunk_width, chunk_height);
+            entry.first_tile = tiles[y0 * width + x0];
+            for (size_t y = y0; y < y0 + chunk_height; y++) {
+                for (const uint8_t tile : tiles.subspan(y * width + x0, chunk_width)) {
+                    if (!seen[tile]) entry.palette_size++;
+                    seen[tile] = true;
+                    if (TileTypes::IsBlocking(tile)) entry.blocking = 1;
+                }
+            }
+            index.push_back(entry);
+        }
+    }
+
+    // Written beside the target and renamed over it: a server may have the
+    // old file mapped, and rewriting it in place would change (or truncate)
+    // pages under it
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) Fail(temp_path, "can't create");
+
+        auto write_at = [&](uint64_t offset, const void *data, size_t bytes) {
+            static const std::array<char, SECTION_ALIGNMENT> zeros{};
+            while (static_cast<uint64_t>(out.tellp()) < offset) {
+                const auto gap = offset - static_cast<uint64_t>(out.tellp());
+                out.write(zeros.data(), static_cast<std::streamsize>(std::min<uint64_t>(gap, zeros.size())));
+            }
+            out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        };
+        write_at(0, &header, sizeof(header));
+        write_at(header.tiles_offset, tiles.data(), tiles.size());
+        write_at(header.collision_offset, collision.data(), collision.size() * sizeof(uint64_t));
+        write_at(header.chunk_index_offset, index.data(), index.size() * sizeof(ChunkEntry));
+        if (!out.flush()) Fail(temp_path, "write failed");
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) Fail(path, std::format("can't replace: {}", ec.message()));
+}
@@ -0,0 +1,134 @@
+/// =======================================
+/// DyeWarsServer - MapFile
+///
+/// A map on disk (.dwm), mapped read-only. TileMap reads its tiles straight
+/// from the mapping and copies only the collision bits into its grid.
+///
+/// WHY MMAP:
+/// Loading a 4096x4096 map by reading it into a vector means 16MB of
+/// copying plus a blocking check per tile before the first player can
+/// move. Mapped, "load" is validating a header and copying 2MB of
+/// pre-computed collision words; tile pages come in on first touch, and
+/// every process (shards, the replay tool) mapping the same file shares
+/// one copy in the page cache. Edits never reach the file: TileMap copies
+/// the tiles out before the first one (see TileMap::SetTile).
+///
+/// FILE LAYOUT (version 1, little-endian, sections 4096-byte aligned):
+///   Header      128 bytes, see Header
+///   Tiles       width * height tile types, row-major
+///   Collision   (height + 2) rows of collisionStride uint64 words: the
+///               static layer of a CollisionGrid, border included, so it
+///               loads with a straight copy. Trusted only if the header's
+///               blocking_hash matches the server's blocking table, and
+///               the border bits are set again whatever the file says.
+///   Chunk index one ChunkEntry per CHUNK_SIZE chunk, row-major
+///
+/// Written by DyeWarsMapConvert (tools/MapConvert.cpp) or Write().
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+class TileMap;
+
+class MapFile {
+public:
+    static constexpr char MAGIC[4] = {'D', 'W', 'M', 'P'};
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t SECTION_ALIGNMENT = 4096;
+    static constexpr size_t MAX_NAME_LENGTH = 63;
+
+    struct Header {
+        char magic[4];
+        uint16_t version;
+        uint16_t header_size;
+        uint16_t width;
+        uint16_t height;
+        uint16_t chunk_size;
+        uint16_t flags;                // None yet
+        uint64_t tiles_offset;
+        uint64_t collision_offset;
+        uint32_t collision_stride;     // uint64 words per collision row
+        uint32_t chunk_count;
+        uint64_t chunk_index_offset;
+        uint64_t file_size;
+        uint8_t name_length;
+        char name[MAX_NAME_LENGTH];
+        uint64_t blocking_hash;        // TileTypes::BlockingTableHash() the collision bits were built with
+    };
+
+    static_assert(sizeof(Header) == 128);
+
+    /// Per chunk, so tools can tell chunks apart without reading tiles
+    struct ChunkEntry {
+        uint64_t hash;          // FNV-1a of the chunk's tiles, row by row
+        uint16_t palette_size;  // Distinct tile types
+        uint8_t first_tile;     // The only tile if palette_size == 1
+        uint8_t blocking;       // 1 if any tile blocks
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(ChunkEntry) == 16);
+
+    /// Map `path` read-only and check its header against its size. Throws
+    /// std::runtime_error if it can't be opened or isn't a valid map.
+    static std::shared_ptr<const MapFile> Open(const std::string &path);
+
+    /// Just the header - dimensions for a map that isn't loaded yet. Same
+    /// checks and errors as Open().
+    static Header ReadHeader(const std::string &path);
+
+    /// Write `map` (its tiles and static blocking) to `path`. Throws
+    /// std::runtime_error on I/O errors.
+    static void Write(const std::string &path, const TileMap &map);
+
+    ~MapFile();
+
+    MapFile(const MapFile &) = delete;
+
+    MapFile &operator=(const MapFile &) = delete;
+
+    const Header &GetHeader() const { return header_; }
+
+    std::string GetName() const { return {header_.name, header_.name_length}; }
+
+    const std::string &GetPath() const { return path_; }
+
+    std::span<const uint8_t> Tiles() const {
+        return {data_ + header_.tiles_offset, static_cast<size_t>(header_.width) * header_.height};
+    }
+
+    std::span<const uint64_t> CollisionWords() const {
+        return {reinterpret_cast<const uint64_t *>(data_ + header_.collision_offset),
+                static_cast<size_t>(header_.collision_stride) * (header_.height + 2u)};
+    }
+
+    std::span<const ChunkEntry> ChunkIndex() const {
+        return {reinterpret_cast<const ChunkEntry *>(data_ + header_.chunk_index_offset), header_.chunk_count};
+    }
+
+    /// FNV-1a over a chunk's tiles, as stored in ChunkEntry::hash
+    static uint64_t HashChunk(std::span<const uint8_t> tiles, size_t width, size_t x0, size_t y0,
+                              size_t chunk_width, size_t chunk_height);
+
+private:
+    MapFile() = default;
+
+    /// Throws std::runtime_error unless `header` describes a file of `size` bytes
+    static void Validate(const Header &header, uint64_t size, const std::string &path);
+
+    std::string path_;
+    Header header_{};
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    std::vector<uint8_t> buffer_;  // No mmap: the file is read in
+#endif
+};
@@ -4,6 +4,12 @@
 /// Player entity with movement validation.
 /// Owns its own state, asks TileMap for collision.
 ///
+/// HOT/COLD SPLIT:
+/// While registered, a Player's per-tick fields (position, facing, client,
+/// flags, cooldowns) live in its registry's PlayerTable columns and this
+/// object is a view onto that row plus the cold fields (name). The API is
+/// the same either way; hot loops skip it and read the columns by handle.
+///
 /// THREAD SAFETY:
 /// --------------
 /// Player objects are owned by PlayerRegistry and should ONLY be
@@ -19,20 +25,29 @@
 /// HOW TO ACCESS PLAYER FROM IO THREAD:
 /// Don't. Use message passing instead:
 /// 1. IO thread receives packet
-/// 2. IO thread calls QueueAction() with a lambda
-/// 3. Game thread executes lambda, accesses player safely
+/// 2. IO thread calls QueueCommand() with a GameCommand
+/// 3. Game thread executes the command, accesses player safely
 ///
 /// Created by Anonymous on Dec 05, 2025
 /// =======================================
 #pragma once
 
+#include <cassert>
 #include <cstdint>
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <string>
+#include "game/GameTime.h"
 #include "game/TileMap.h"
+#include "game/PlayerTable.h"
+#include "core/SlotMap.h"
 #include "core/ThreadSafety.h"
 
+/// Slot in the owning zone's PlayerRegistry (see SlotMap.h). What World,
+/// SpatialHash and VisibilityTracker key on; GetID() is for the wire.
+using PlayerHandle = SlotHandle::Type;
+
 /// Result of a movement attempt - explains why movement failed
 enum class MoveResult : uint8_t {
     Success,           // Move succeeded
@@ -69,15 +84,19 @@ public:
             int start_x,
             int start_y,
             uint8_t facing = 0)
-            : id_(player_id),
-              x_(start_x),
-              y_(start_y),
-              facing_(facing),
-              client_id_(0),
-              last_move_time_(std::chrono::steady_clock::now() - std::chrono::seconds(1)) {
+            : id_(player_id) {
         // Owner will be set on first access from game thread
+        detached_.id = player_id;
+        detached_.x = static_cast<int16_t>(start_x);
+        detached_.y = static_cast<int16_t>(start_y);
+        detached_.facing = facing;
     }
 
+    /// The view points into the registry's table - never copy or move one
+    Player(const Player &) = delete;
+
+    Player &operator=(const Player &) = delete;
+
     /// ========================================================================
     /// IDENTITY
     /// ========================================================================
@@ -85,17 +104,49 @@ public:
     /// Get player's unique ID. IMMUTABLE - no thread safety needed.
     uint64_t GetID() const { return id_; }
 
+    /// Handle in the registry holding this player, SlotHandle::NONE when
+    /// in none. Set by PlayerRegistry only.
+    PlayerHandle GetHandle() const {
+        AssertGameThreadRead();
+        return handle_;
+    }
+
+    /// Move this player's hot fields into row SlotHandle::Index(handle)
+    /// of table. PlayerRegistry only, when it hands out the handle.
+    void Attach(PlayerTable &table, PlayerHandle handle) {
+        AssertGameThread();
+        assert(!table_ && "Player is already in a registry");
+        const uint32_t index = SlotHandle::Index(handle);
+        table.Grow(index + 1);
+        table.Store(index, detached_);
+        table_ = &table;
+        handle_ = handle;
+    }
+
+    /// Copy the row back out and clear it. PlayerRegistry only, on removal,
+    /// so the object stays usable by whoever still holds it. No thread
+    /// assertion: ~PlayerRegistry runs this on whichever thread tears the
+    /// zone down.
+    void Detach() {
+        if (!table_) return;
+        const uint32_t index = SlotHandle::Index(handle_);
+        detached_ = table_->Load(index);
+        table_->Store(index, PlayerTable::Row{});
+        table_ = nullptr;
+        handle_ = SlotHandle::NONE;
+    }
+
     /// Set which client connection owns this player.
     /// Called once during login setup.
     void SetClientID(uint64_t client_id) {
         AssertGameThread();
-        client_id_ = client_id;
+        Hot(&PlayerTable::client_id, &Row::client_id) = client_id;
     }
 
     /// Get which client connection owns this player.
     uint64_t GetClientID() const {
-        AssertGameThread();
-        return client_id_;
+        AssertGameThreadRead();
+        return Hot(&PlayerTable::client_id, &Row::client_id);
     }
 
     /// Set player's display name.
@@ -106,24 +157,38 @@ public:
 
     /// Get player's display name.
     const std::string &GetName() const {
-        AssertGameThread();
+        AssertGameThreadRead();
         return name_;
     }
 
+    /// Read-only copy of a player that another shard process owns (see
+    /// ShardLayout). Ghosts are seen and collided with like anyone else,
+    /// but they have no client here and are never simulated.
+    bool IsGhost() const {
+        AssertGameThreadRead();
+        return (Hot(&PlayerTable::flags, &Row::flags) & PlayerTable::GHOST) != 0;
+    }
+
+    void SetGhost(bool ghost) {
+        AssertGameThread();
+        uint8_t &flags = Hot(&PlayerTable::flags, &Row::flags);
+        flags = ghost ? (flags | PlayerTable::GHOST) : (flags & ~PlayerTable::GHOST);
+    }
+
     /// ========================================================================
     /// POSITION
     /// ========================================================================
 
     /// Get current X coordinate.
     int16_t GetX() const {
-        AssertGameThread();
-        return x_;
+        AssertGameThreadRead();
+        return Hot(&PlayerTable::x, &Row::x);
     }
 
     /// Get current Y coordinate.
     int16_t GetY() const {
-        AssertGameThread();
-        return y_;
+        AssertGameThreadRead();
+        return Hot(&PlayerTable::y, &Row::y);
     }
 
     /// Direct position set (for teleport, spawn, admin commands).
@@ -138,8 +203,8 @@ public:
     /// For normal movement, use AttemptMove() which validates everything.
     void SetPosition(int16_t x, int16_t y) {
         AssertGameThread();
-        x_ = x;
-        y_ = y;
+        Hot(&PlayerTable::x, &Row::x) = x;
+        Hot(&PlayerTable::y, &Row::y) = y;
     }
 
     /// ========================================================================
@@ -148,8 +213,8 @@ public:
 
     /// Get current facing direction (0=North, 1=East, 2=South, 3=West).
     uint8_t GetFacing() const {
-        AssertGameThread();
-        return facing_;
+        AssertGameThreadRead();
+        return Hot(&PlayerTable::facing, &Row::facing);
     }
 
     /// Set facing direction directly (0=North, 1=East, 2=South, 3=West).
@@ -157,7 +222,7 @@ public:
     void SetFacing(uint8_t facing) {
         AssertGameThread();
         if (facing <= 3) {
-            facing_ = facing;
+            Hot(&PlayerTable::facing, &Row::facing) = facing;
         }
     }
 
@@ -176,20 +241,21 @@ public:
     /// @param direction Which way to move (0=N, 1=E, 2=S, 3=W)
     /// @param sent_facing The facing direction the client thinks we have
     /// @param map The tilemap for collision checking
+    /// @param now The zone's clock - the cooldown counts its ticks
     /// @param client_ping_ms Client's ping for cooldown adjustment
     /// @param is_occupied Callback to check if target tile has a player
     /// @return MoveResult explaining success or why it failed
-    MoveResult AttemptMove(uint8_t direction, uint8_t sent_facing, const TileMap &map,
+    MoveResult AttemptMove(uint8_t direction, uint8_t sent_facing, const TileMap &map, const GameTime &now,
                            uint32_t client_ping_ms = 0, OccupancyCheck is_occupied = nullptr) {
         AssertGameThread();
-        const auto now = std::chrono::steady_clock::now();
         // ====================================================================
         // COOLDOWN CHECK
         // Prevent speed hacking by enforcing minimum time between moves
         // Adjust for client ping - higher ping = more grace
         // ====================================================================
-        auto adjusted_cooldown = GetAdjustedCooldown(client_ping_ms);
-        if (now - last_move_time_ < adjusted_cooldown) {
+        const uint64_t adjusted_cooldown = now.TicksFor(GetAdjustedCooldown(client_ping_ms));
+        auto &last_move = Hot(&PlayerTable::last_move, &Row::last_move);
+        if (now.TicksSince(last_move) < adjusted_cooldown) {
             return MoveResult::OnCooldown;
         }
         // ====================================================================
@@ -197,7 +263,8 @@ public:
         // Player must be facing the direction they want to move
         // This prevents "moonwalking" and ensures animation sync
         // ====================================================================
-        if (direction != facing_ || sent_facing != facing_) {
+        const uint8_t facing = Hot(&PlayerTable::facing, &Row::facing);
+        if (direction != facing || sent_facing != facing) {
             return MoveResult::WrongFacing;
         }
 
@@ -212,8 +279,10 @@ public:
         // ====================================================================
         // CALCULATE NEW POSITION
         // ====================================================================
-        int16_t new_x = x_;
-        int16_t new_y = y_;
+        int16_t &x = Hot(&PlayerTable::x, &Row::x);
+        int16_t &y = Hot(&PlayerTable::y, &Row::y);
+        int16_t new_x = x;
+        int16_t new_y = y;
 
         switch (direction) {
             case 0:
@@ -251,57 +320,74 @@ public:
         // ====================================================================
         // SUCCESS - Update state
         // ====================================================================
-        last_move_time_ = now;
-        x_ = new_x;
-        y_ = new_y;
+        last_move = now.tick;
+        x = new_x;
+        y = new_y;
 
         return MoveResult::Success;
     }
 
     /// Check if player can move (not on cooldown) - uses base cooldown.
     /// Useful for UI hints ("you can move now" indicator).
-    bool CheckMoveCooldown() const {
-        AssertGameThread();
-        auto now = std::chrono::steady_clock::now();
-        return (now - last_move_time_) >= std::chrono::milliseconds(BASE_MOVE_COOLDOWN_MS);
+    bool CheckMoveCooldown(const GameTime &now) const {
+        AssertGameThreadRead();
+        return now.TicksSince(Hot(&PlayerTable::last_move, &Row::last_move)) >=
+               now.TicksFor(std::chrono::milliseconds(BASE_MOVE_COOLDOWN_MS));
     }
 
-    /// Get time until next move is allowed (for client prediction).
-    /// Returns 0 if player can move immediately.
-    std::chrono::milliseconds TimeUntilCanMove() const {
-        AssertGameThread();
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_move_time_);
-        auto base_cooldown = std::chrono::milliseconds(BASE_MOVE_COOLDOWN_MS);
+    /// Get time until next move is allowed (for client prediction), in
+    /// whole ticks converted to milliseconds. Returns 0 if player can move
+    /// immediately.
+    std::chrono::milliseconds TimeUntilCanMove(const GameTime &now) const {
+        AssertGameThreadRead();
+        const uint64_t elapsed = now.TicksSince(Hot(&PlayerTable::last_move, &Row::last_move));
+        const uint64_t base_cooldown = now.TicksFor(std::chrono::milliseconds(BASE_MOVE_COOLDOWN_MS));
         if (elapsed >= base_cooldown) {
             return std::chrono::milliseconds(0);
         }
-        return base_cooldown - elapsed;
+        return now.ToMilliseconds(base_cooldown - elapsed);
     }
 
     /// Attempt to turn to face a new direction.
     /// Turning has its own cooldown (faster than movement).
     /// @param new_facing Direction to face (0=N, 1=E, 2=S, 3=W)
+    /// @param now The zone's clock - the cooldown counts its ticks
     /// @return true if turn succeeded, false if invalid direction or on cooldown
-    bool AttemptTurn(uint8_t new_facing) {
+    bool AttemptTurn(uint8_t new_facing, const GameTime &now) {
         AssertGameThread();
 
-        if (new_facing > 3 || new_facing == facing_) {
+        uint8_t &facing = Hot(&PlayerTable::facing, &Row::facing);
+        if (new_facing > 3 || new_facing == facing) {
             return false;
         }
 
-        const auto now = std::chrono::steady_clock::now();
-        if (now - last_turn_time_ < TURN_COOLDOWN) {
+        auto &last_turn = Hot(&PlayerTable::last_turn, &Row::last_turn);
+        if (now.TicksSince(last_turn) < now.TicksFor(TURN_COOLDOWN)) {
             return false;
         }
 
-        last_turn_time_ = now;
-        facing_ = new_facing;
+        last_turn = now.tick;
+        facing = new_facing;
         return true;
     }
 
 
 private:
+    using Row = PlayerTable::Row;
+
+    /// This player's value of one hot field: its table row while attached,
+    /// detached_ otherwise. References are good until the table grows
+    /// (next registration), so don't hold them past the calling method.
+    template<typename T>
+    T &Hot(std::vector<T> PlayerTable::*column, T Row::*field) {
+        return table_ ? (table_->*column)[SlotHandle::Index(handle_)] : detached_.*field;
+    }
+
+    template<typename T>
+    const T &Hot(std::vector<T> PlayerTable::*column, T Row::*field) const {
+        return const_cast<Player *>(this)->Hot(column, field);
+    }
+
     /// ========================================================================
     /// THREAD SAFETY HELPER
     ///
@@ -318,11 +404,21 @@ private:
             thread_owner_.SetOwner();
         }
     }
+
+    /// Const readers: also allowed from a JobSystem job the game thread is
+    /// waiting on (parallel broadcast queries), see ThreadSafety.h
+    void AssertGameThreadRead() const {
+        ASSERT_GAME_THREAD_READ(thread_owner_);
+        if (!thread_owner_.IsOwnerSet()) {
+            thread_owner_.SetOwner();
+        }
+    }
     /// ========================================================================
     /// CONFIGURATION
     /// ========================================================================
 
-    /// Movement cooldowns
+    /// Movement cooldowns, in milliseconds - GameTime::TicksFor turns them
+    /// into whole ticks (rounded down) at the zone's tick rate
     /// Client sends moves every 350ms
     /// Base cooldown is lower to account for network variance
     static constexpr int BASE_MOVE_COOLDOWN_MS = 280;
@@ -371,17 +467,14 @@ private:
     /// 3. It doesn't affect the logical const-ness of the Player
     mutable ThreadOwner thread_owner_;
 
-    // --- Identity (id_ is immutable, others are mutable) ---
-    const uint64_t id_;          // Immutable after construction
-    uint64_t client_id_ = 0;     // Set once during login
-    std::string name_;           // Can be changed by player
+    // --- Identity (id_ is immutable, also in the table for hot reads) ---
+    const uint64_t id_;
 
-    // --- Position (game thread only) ---
-    int16_t x_;
-    int16_t y_;
-    uint8_t facing_ = 2; // Default: facing down (0=up, 1=right, 2=down, 3=left)
+    // --- Hot fields: a PlayerTable row while registered (see Attach) ---
+    PlayerTable *table_ = nullptr;            // Set by PlayerRegistry
+    PlayerHandle handle_ = SlotHandle::NONE;  // Row is SlotHandle::Index(handle_)
+    Row detached_;                            // The values while in no table
 
-    // --- Cooldown Timers (game thread only) ---
-    std::chrono::steady_clock::time_point last_move_time_{};
-    std::chrono::steady_clock::time_point last_turn_time_{};
+    // --- Cold fields (game thread only) ---
+    std::string name_;           // Can be changed by player
 };
\ No newline at end of file
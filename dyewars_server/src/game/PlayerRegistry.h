@@ -4,27 +4,46 @@
 /// Manages player lifecycle, lookups, and dirty tracking.
 /// Does NOT own spatial data (World does).
 ///
+/// Each Zone has its own registry holding the players on its map. Player
+/// IDs are random 64-bit, so they stay unique across zones, and a player
+/// keeps its ID when it moves to another zone (AdoptPlayer).
+///
+/// HANDLES:
+/// Players live in a SlotMap and are known inside the zone by a 32-bit
+/// PlayerHandle (slot index + generation). World, SpatialHash and
+/// VisibilityTracker key on handles, so their lookups are array indexing
+/// instead of hash probes. The 64-bit ID is only for the wire and for
+/// shard messages. Handles are per-registry: a player moving zones gets
+/// a new one.
+///
+/// HOT DATA:
+/// Each registered player's per-tick fields live in this registry's
+/// PlayerTable, in the row of its handle's slot (Player::Attach). Hot
+/// loops read Table() columns by handle instead of going through Player.
+///
 /// Created by Anonymous on Dec 05, 2025
 /// =======================================
 #pragma once
 
 #include <memory>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 #include <random>
 #include <cassert>
 #include <functional>
 #include <atomic>
 #include "core/Log.h"
+#include "core/SlotMap.h"
 #include "core/ThreadSafety.h"
 #include "Player.h"
+#include "PlayerTable.h"
 /// ============================================================================
 /// PLAYER REGISTRY
 ///
 /// Responsibilities:
 /// - Player lifecycle (create, remove)
-/// - Client ID <-> Player ID mapping
-/// - Dirty tracking (who needs to be broadcast)
+/// - Handles, and Client ID / Player ID -> handle mapping
+/// - Dirty tracking (who needs to be broadcast): DIRTY flag + list
 ///
 /// THREAD SAFETY:
 /// All methods must be called from the game thread only.
@@ -43,6 +62,27 @@ enum class SpawnPoints : uint32_t {
 
 class PlayerRegistry {
 public:
+    PlayerRegistry() = default;
+
+    /// Players point into table_ - the registry stays where it was built
+    PlayerRegistry(const PlayerRegistry &) = delete;
+
+    PlayerRegistry &operator=(const PlayerRegistry &) = delete;
+
+    /// Hand every player its values back, so a shared_ptr that outlives
+    /// the zone never reads a freed table
+    ~PlayerRegistry() {
+        for (const auto &player: players_.Values()) player->Detach();
+    }
+
+    /// Draw player IDs from a fixed seed instead of random_device, so the
+    /// same logins get the same IDs (--deterministic). Call before any
+    /// player is created. No thread assertion: the owner builds its
+    /// registry on another thread and would claim it here.
+    void Seed(uint64_t seed) {
+        rng_.seed(seed);
+    }
+
     /// ========================================================================
     /// PLAYER LIFECYCLE
     /// ========================================================================
@@ -56,6 +96,17 @@ public:
         uint8_t facing = 2) {
         AssertGameThread();
 
+        // Check if this client already has a player.
+        // This shouldn't happen in normal operation, but could if:
+        // - A bug calls CreatePlayer twice for the same client
+        // Without this check, we'd overwrite the old player mapping,
+        // orphaning the old player in memory (leak) and breaking lookups.
+        if (client_to_handle_.contains(client_id)) {
+            Log::Error("CreatePlayer: client {} already has player {}",
+                       client_id, GetPlayerIDForClient(client_id));
+            return nullptr;
+        }
+
         uint64_t player_id = GenerateUniqueID();
         assert(player_id != 0 && "Failed to generate unique player ID");
         auto player = std::make_shared<Player>(
@@ -64,46 +115,87 @@ public:
             start_y,
             facing);
 
-        player->SetClientID(client_id);
+        if (!Insert(player)) return nullptr;
+        AttachClient(client_id, player);
 
-        // Check if this client already has a player.
-        // This shouldn't happen in normal operation, but could if:
-        // - A bug calls CreatePlayer twice for the same client
-        // Without this check, we'd overwrite the old player mapping,
-        // orphaning the old player in memory (leak) and breaking lookups.
-        if (client_to_player_.contains(client_id)) {
-            Log::Error("CreatePlayer: client {} already has player {}",
-                       client_id, client_to_player_[client_id]);
+        Log::Trace("Player {} created for client {}", player_id, client_id);
+        return player;
+    }
+
+    /// Take in a player arriving from another zone under its existing ID.
+    /// Returns nullptr if the client or the ID is already here.
+    std::shared_ptr<Player> AdoptPlayer(
+        uint64_t client_id,
+        uint64_t player_id,
+        int16_t x,
+        int16_t y,
+        uint8_t facing) {
+        return AdoptPlayer(client_id, std::make_shared<Player>(player_id, x, y, facing));
+    }
+
+    /// Register an existing Player object for client_id. A shard ghost
+    /// already registered here (its client just resumed) keeps its handle.
+    /// Same rules as above.
+    std::shared_ptr<Player> AdoptPlayer(uint64_t client_id, std::shared_ptr<Player> player) {
+        AssertGameThread();
+
+        const bool registered_here = Get(player->GetHandle()) == player;
+        if (client_to_handle_.contains(client_id) ||
+            (!registered_here && id_to_handle_.contains(player->GetID())) ||
+            (registered_here && player->GetClientID() != 0)) {
+            Log::Error("AdoptPlayer: client {} / player {} already in this registry", client_id, player->GetID());
             return nullptr;
         }
 
-        players_[player_id] = player;
-        client_to_player_[client_id] = player_id;
-        player_to_client_[player_id] = client_id; // Reverse mapping for O(1) lookup
-        player_count_.fetch_add(1, std::memory_order_relaxed);
-
-        Log::Trace("Player {} created for client {}", player_id, client_id);
+        if (!registered_here && !Insert(player)) return nullptr;
+        AttachClient(client_id, player);
         return player;
     }
 
-    void RemovePlayer(const uint64_t player_id) {
+    /// Register a shard ghost: a player with no client here. It gets a
+    /// handle like anyone else (World and VisibilityTracker need one), but
+    /// Count() and ForEachPlayer() skip it. Returns SlotHandle::NONE if the
+    /// ID is taken.
+    PlayerHandle AddGhost(const std::shared_ptr<Player> &ghost) {
         AssertGameThread();
+        if (id_to_handle_.contains(ghost->GetID())) return SlotHandle::NONE;
+        return Insert(ghost) ? ghost->GetHandle() : SlotHandle::NONE;
+    }
 
-        // O(1) reverse lookup to find client_id
-        auto client_it = player_to_client_.find(player_id);
-        if (client_it != player_to_client_.end()) {
-            client_to_player_.erase(client_it->second);
-            player_to_client_.erase(client_it);
+    /// Drop the client mapping but keep the player registered under the
+    /// same handle - it stays in the world as a ghost (shard handoff).
+    void DetachClient(const uint64_t client_id) {
+        AssertGameThread();
+        auto it = client_to_handle_.find(client_id);
+        if (it == client_to_handle_.end()) return;
+
+        if (auto *player = players_.Get(it->second)) {
+            ClearDirty(it->second);
+            (*player)->SetClientID(0);
         }
+        client_to_handle_.erase(it);
+        player_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
 
-        // Remove from dirty set if present
-        auto player_it = players_.find(player_id);
-        if (player_it != players_.end()) {
-            dirty_players_.erase(player_it->second);
-            players_.erase(player_it);
+    /// Remove a player (or ghost) by handle
+    void RemovePlayer(const PlayerHandle handle) {
+        AssertGameThread();
+        auto *entry = players_.Get(handle);
+        if (!entry) return;
+
+        const auto player = *entry;  // Erase moves another player into this slot
+        const uint64_t player_id = player->GetID();
+        const uint64_t client_id = player->GetClientID();
+        if (client_id != 0 && client_to_handle_.erase(client_id) > 0) {
             player_count_.fetch_sub(1, std::memory_order_relaxed);
         }
 
+        // Withdraw a pending mark; ConsumeDirtyPlayers skips the list entry
+        ClearDirty(handle);
+        id_to_handle_.erase(player_id);
+        players_.Erase(handle);
+        player->Detach();
+
         Log::Info("Player {} removed", player_id);
     }
 
@@ -111,22 +203,9 @@ public:
     void RemoveByClientID(const uint64_t client_id) {
         AssertGameThread();
 
-        auto it = client_to_player_.find(client_id);
-        if (it != client_to_player_.end()) {
-            uint64_t player_id = it->second;
-
-            // Remove from dirty set if present
-            auto player_it = players_.find(player_id);
-            if (player_it != players_.end()) {
-                dirty_players_.erase(player_it->second);
-                players_.erase(player_it);
-                player_count_.fetch_sub(1, std::memory_order_relaxed);
-            }
-
-            // Remove both mappings
-            player_to_client_.erase(player_id);
-            client_to_player_.erase(it);
-            Log::Info("Player {} removed (by client {})", player_id, client_id);
+        auto it = client_to_handle_.find(client_id);
+        if (it != client_to_handle_.end()) {
+            RemovePlayer(it->second);
         }
     }
 
@@ -140,99 +219,150 @@ public:
     /// PLAYER LOOKUP
     /// ========================================================================
 
-    /// Get player by player ID
+    /// Get player (or ghost) by handle. Two array reads - use in hot paths.
+    std::shared_ptr<Player> Get(const PlayerHandle handle) const {
+        AssertGameThreadRead();
+        const auto *player = players_.Get(handle);
+        return player ? *player : nullptr;
+    }
+
+    /// True while handle names a player (or ghost) here - check this before
+    /// reading Table() with a handle that may have gone stale
+    bool Contains(const PlayerHandle handle) const {
+        AssertGameThreadRead();
+        return players_.Contains(handle);
+    }
+
+    /// Get player (or ghost) by wire ID
     std::shared_ptr<Player> GetByID(const uint64_t player_id) {
         AssertGameThread();
-        auto it = players_.find(player_id);
-        return (it != players_.end()) ? it->second : nullptr;
+        auto it = id_to_handle_.find(player_id);
+        return (it != id_to_handle_.end()) ? Get(it->second) : nullptr;
     }
 
     /// Get player by client ID
     std::shared_ptr<Player> GetByClientID(const uint64_t client_id) {
         AssertGameThread();
-        auto it = client_to_player_.find(client_id);
-        if (it == client_to_player_.end()) return nullptr;
-
-        auto pit = players_.find(it->second);
-        return (pit != players_.end()) ? pit->second : nullptr;
+        auto it = client_to_handle_.find(client_id);
+        return (it != client_to_handle_.end()) ? Get(it->second) : nullptr;
     }
 
     /// Get player ID for a client connection
     /// Returns 0 if not found
     uint64_t GetPlayerIDForClient(const uint64_t client_id) {
         AssertGameThread();
-        auto it = client_to_player_.find(client_id);
-        return (it != client_to_player_.end()) ? it->second : 0;
+        auto player = GetByClientID(client_id);
+        return player ? player->GetID() : 0;
     }
 
     /// ========================================================================
     /// DIRTY TRACKING
     /// ========================================================================
 
-    /// Mark a player as dirty (needs broadcast)
+    /// Mark a player as dirty (needs broadcast). Players not registered
+    /// here are ignored - there is nobody to broadcast them to.
     void MarkDirty(const std::shared_ptr<Player> &player) {
+        MarkDirty(player->GetHandle());
+    }
+
+    /// Mark a player as dirty by handle: a flag test and, the first time
+    /// this tick, a push onto the dirty list. No hashing.
+    void MarkDirty(PlayerHandle handle) {
         AssertGameThread();
-        dirty_players_.insert(player);
+        auto *player = players_.Get(handle);
+        if (!player) return;
+        uint8_t &flags = table_.flags[SlotHandle::Index(handle)];
+        if (flags & PlayerTable::DIRTY) return;
+        flags |= PlayerTable::DIRTY;
+        dirty_list_.push_back(*player);
+        dirty_count_++;
     }
 
-    /// Mark a player as dirty by ID
-    void MarkDirty(uint64_t player_id) {
+    /// Swap this tick's dirty players into out, in the order they were
+    /// first marked, and start a new tick with out's old buffer (cleared,
+    /// capacity kept). Pass the same vector every tick and the two buffers
+    /// just trade places - nothing is copied or allocated.
+    ///
+    /// Entries whose mark was withdrawn (player removed or detached after
+    /// marking) are dropped here, in the same pass that clears the flags.
+    void ConsumeDirtyPlayers(std::vector<std::shared_ptr<Player> > &out) {
         AssertGameThread();
-        auto it = players_.find(player_id);
-        if (it != players_.end()) {
-            dirty_players_.insert(it->second);
-        }
+        out.clear();
+        out.swap(dirty_list_);
+        std::erase_if(out, [this](const std::shared_ptr<Player> &player) {
+            const PlayerHandle handle = player->GetHandle();
+            if (!players_.Contains(handle)) return true;
+            uint8_t &flags = table_.flags[SlotHandle::Index(handle)];
+            if (!(flags & PlayerTable::DIRTY)) return true;  // Withdrawn, or a re-mark already kept
+            flags &= ~PlayerTable::DIRTY;
+            return false;
+        });
+        dirty_count_ = 0;
     }
 
-    /// Consume and return all dirty players (clears the set)
+    /// Same, into a fresh vector (tests, tools)
     std::vector<std::shared_ptr<Player> > ConsumeDirtyPlayers() {
-        AssertGameThread();
-        std::vector<std::shared_ptr<Player> > result(dirty_players_.begin(), dirty_players_.end());
-        dirty_players_.clear();
+        std::vector<std::shared_ptr<Player> > result;
+        ConsumeDirtyPlayers(result);
         return result;
     }
 
     /// Check if there are dirty players
     bool HasDirtyPlayers() const {
-        AssertGameThread();
-        return !dirty_players_.empty();
+        AssertGameThreadRead();
+        return dirty_count_ > 0;
     }
 
     /// Get count of dirty players (for stats)
     size_t DirtyCount() const {
-        AssertGameThread();
-        return dirty_players_.size();
+        AssertGameThreadRead();
+        return dirty_count_;
     }
 
     /// ========================================================================
     /// QUERIES
     /// ========================================================================
 
-    /// Get all players (copy of shared_ptrs)
+    /// Get all players, ghosts excluded (copy of shared_ptrs)
     std::vector<std::shared_ptr<Player> > GetAllPlayers() {
         AssertGameThread();
         std::vector<std::shared_ptr<Player> > result;
-        result.reserve(players_.size());
-        for (const auto &[id, player]: players_) {
+        result.reserve(Count());
+        ForEachPlayer([&result](const std::shared_ptr<Player> &player) {
             result.push_back(player);
-        }
+        });
         return result;
     }
 
-    /// Get player count (thread-safe, can be called from any thread)
+    /// Get player count, ghosts excluded (thread-safe, can be called from any thread)
     size_t Count() const {
         return player_count_.load(std::memory_order_relaxed);
     }
 
+    /// Highest handle index + 1 - the size for arrays indexed by
+    /// SlotHandle::Index(handle)
+    size_t SlotCount() const {
+        AssertGameThreadRead();
+        return players_.SlotCount();
+    }
+
+    /// Hot fields of every registered player, by handle slot. Only valid
+    /// for live handles; read-only outside the registry.
+    const PlayerTable &Table() const {
+        AssertGameThreadRead();
+        return table_;
+    }
+
     /// ===========================3=============================================
     /// ITERATION (for broadcasting)
     /// ========================================================================
 
-    /// Iterate over all players
+    /// Iterate over all players, ghosts excluded. Walks the packed slot
+    /// map, not hash buckets.
     void ForEachPlayer(const std::function<void(const std::shared_ptr<Player> &)> &func) {
         AssertGameThread();
-        for (const auto &[id, player]: players_) {
-            func(player);
+        for (const auto &player: players_.Values()) {
+            if (!player->IsGhost()) func(player);
         }
     }
 
@@ -247,12 +377,39 @@ private:
     uint64_t GenerateUniqueID() {
         // No assertion here - called from CreatePlayer which already asserts
         uint64_t id = id_dist_(rng_);
-        while (players_.contains(id)) {
+        while (id_to_handle_.contains(id)) {
             id = id_dist_(rng_); // Astronomically unlikely to ever run
         }
         return id;
     }
 
+    /// Give player a handle. False (logged) if every slot is taken.
+    bool Insert(const std::shared_ptr<Player> &player) {
+        const PlayerHandle handle = players_.Insert(player);
+        if (handle == SlotHandle::NONE) {
+            Log::Error("PlayerRegistry full ({} slots), player {} refused", SlotHandle::MAX_SLOTS, player->GetID());
+            return false;
+        }
+        player->Attach(table_, handle);
+        id_to_handle_[player->GetID()] = handle;
+        return true;
+    }
+
+    /// Withdraw handle's pending dirty mark, if any
+    void ClearDirty(PlayerHandle handle) {
+        uint8_t &flags = table_.flags[SlotHandle::Index(handle)];
+        if (!(flags & PlayerTable::DIRTY)) return;
+        flags &= ~PlayerTable::DIRTY;
+        dirty_count_--;
+    }
+
+    /// Map client_id to an already registered player
+    void AttachClient(uint64_t client_id, const std::shared_ptr<Player> &player) {
+        player->SetClientID(client_id);
+        client_to_handle_[client_id] = player->GetHandle();
+        player_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
     /// Assert we're on the game thread
     void AssertGameThread() const {
         ASSERT_GAME_THREAD(thread_owner_);
@@ -261,14 +418,35 @@ private:
         }
     }
 
+    /// Same, for const readers (jobs allowed)
+    void AssertGameThreadRead() const {
+        ASSERT_GAME_THREAD_READ(thread_owner_);
+        if (!thread_owner_.IsOwnerSet()) {
+            thread_owner_.SetOwner();
+        }
+    }
+
     // ========================================================================
     /// DATA
     /// ========================================================================
 
-    std::unordered_map<uint64_t, std::shared_ptr<Player> > players_;
-    std::unordered_map<uint64_t, uint64_t> client_to_player_;
-    std::unordered_map<uint64_t, uint64_t> player_to_client_;
-    std::unordered_set<std::shared_ptr<Player> > dirty_players_;
+    /// Every player and ghost in this zone, packed. Everything inside the
+    /// zone refers to them by handle.
+    SlotMap<std::shared_ptr<Player> > players_;
+
+    /// Their hot fields, row = SlotHandle::Index(handle)
+    PlayerTable table_;
+
+    /// Edge lookups only: commands arrive by client ID, shard messages by
+    /// wire ID. Both resolve to a handle once and never again.
+    std::unordered_map<uint64_t, PlayerHandle> client_to_handle_;
+    std::unordered_map<uint64_t, PlayerHandle> id_to_handle_;
+
+    /// Players marked this tick, first mark first. Append-only until
+    /// ConsumeDirtyPlayers swaps it out; the DIRTY flag in table_ keeps
+    /// each player in it once.
+    std::vector<std::shared_ptr<Player> > dirty_list_;
+    size_t dirty_count_ = 0;  // Marks still standing (the list may hold withdrawn ones)
 
     /// Atomic player count for thread-safe reads from any thread (e.g., stats command)
     std::atomic<size_t> player_count_{0};
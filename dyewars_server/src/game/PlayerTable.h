@@ -0,0 +1,126 @@
+/// =======================================
+/// DyeWarsServer - PlayerTable
+///
+/// The per-tick ("hot") player fields, one array per field, indexed by
+/// PlayerHandle slot:
+///
+///   id[]  client_id[]  x[]  y[]  facing[]  flags[]  last_move[]  last_turn[]
+///
+/// last_move / last_turn are GameTime ticks (GameTime::NEVER until the
+/// first move / turn).
+///
+/// Everything else about a player (name, thread owner, anything added
+/// later that is not read every tick) stays on the Player object, which is
+/// now the cold side table plus a thin view over its row here.
+///
+/// WHY COLUMNS:
+/// The broadcast and visibility loops touch thousands of players per tick
+/// but read only x/y/facing/id/client. Through Player that is a
+/// shared_ptr hop to a ~100-byte object per player, mostly name and
+/// cooldown bytes the loop never wanted. Here a viewer check reads a few
+/// bytes from arrays that stay in cache across the whole tick.
+///
+/// OWNERSHIP:
+/// One table per PlayerRegistry, which Attach()es each player it registers
+/// and Detach()es it on removal (see Player). A detached Player keeps its
+/// values in its own Row, so players work the same before registration,
+/// between zones, and in tests.
+///
+/// Rows are indexed by slot, not dense position, so they never move while
+/// a player is registered. Freed slots keep a zeroed row until reused -
+/// SlotMap reuses the most recently freed slot first, so holes stay few.
+///
+/// Game thread only, like the registry. Jobs may read columns while the
+/// game thread waits on them (parallel broadcast queries).
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "core/SlotMap.h"
+#include "game/GameTime.h"
+
+class PlayerTable {
+public:
+    /// Bits in flags[]
+    enum Flag : uint8_t {
+        GHOST = 1 << 0,  // Owned by another shard (see Player::IsGhost)
+        DIRTY = 1 << 1,  // Queued for this tick's broadcast (PlayerRegistry)
+    };
+
+    /// One player's hot fields, for moving a row in or out of the table
+    struct Row {
+        uint64_t id = 0;
+        uint64_t client_id = 0;
+        int16_t x = 0;
+        int16_t y = 0;
+        uint8_t facing = 2;
+        uint8_t flags = 0;
+        uint64_t last_move = GameTime::NEVER;
+        uint64_t last_turn = GameTime::NEVER;
+    };
+
+    /// ========================================================================
+    /// COLUMNS - index with SlotHandle::Index(handle)
+    /// ========================================================================
+
+    std::vector<uint64_t> id;
+    std::vector<uint64_t> client_id;
+    std::vector<int16_t> x;
+    std::vector<int16_t> y;
+    std::vector<uint8_t> facing;
+    std::vector<uint8_t> flags;
+    std::vector<uint64_t> last_move;
+    std::vector<uint64_t> last_turn;
+
+    /// Make room for slots [0, slot_count). Invalidates references into
+    /// the columns, so only the registry calls it (on insert).
+    void Grow(size_t slot_count) {
+        if (slot_count <= Size()) return;
+        id.resize(slot_count);
+        client_id.resize(slot_count);
+        x.resize(slot_count);
+        y.resize(slot_count);
+        facing.resize(slot_count);
+        flags.resize(slot_count);
+        last_move.resize(slot_count);
+        last_turn.resize(slot_count);
+    }
+
+    void Store(uint32_t index, const Row &row) {
+        id[index] = row.id;
+        client_id[index] = row.client_id;
+        x[index] = row.x;
+        y[index] = row.y;
+        facing[index] = row.facing;
+        flags[index] = row.flags;
+        last_move[index] = row.last_move;
+        last_turn[index] = row.last_turn;
+    }
+
+    Row Load(uint32_t index) const {
+        return Row{id[index], client_id[index], x[index], y[index], facing[index], flags[index],
+                   last_move[index], last_turn[index]};
+    }
+
+    size_t Size() const { return id.size(); }
+
+    /// ========================================================================
+    /// HANDLE ACCESSORS - caller guarantees the handle is live
+    /// ========================================================================
+
+    uint64_t ID(SlotHandle::Type handle) const { return id[SlotHandle::Index(handle)]; }
+
+    uint64_t ClientID(SlotHandle::Type handle) const { return client_id[SlotHandle::Index(handle)]; }
+
+    int16_t X(SlotHandle::Type handle) const { return x[SlotHandle::Index(handle)]; }
+
+    int16_t Y(SlotHandle::Type handle) const { return y[SlotHandle::Index(handle)]; }
+
+    uint8_t Facing(SlotHandle::Type handle) const { return facing[SlotHandle::Index(handle)]; }
+
+    bool IsGhost(SlotHandle::Type handle) const { return (flags[SlotHandle::Index(handle)] & GHOST) != 0; }
+};
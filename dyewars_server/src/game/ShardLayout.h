@@ -0,0 +1,77 @@
+/// =======================================
+/// DyeWarsServer - ShardLayout
+///
+/// Which shard process owns which part of a sharded map (--shard I/N).
+///
+/// The map is cut into N vertical strips of equal width; shard I owns
+/// x in [Begin(I), End(I)). Every shard loads the whole map, but only
+/// simulates players standing in its own strip.
+///
+///   x:  0 ........ 127 | 128 ........ 255      (256 wide, 2 shards)
+///       shard 0        | shard 1
+///                 <--->|<--->
+///                 ghost margin (VIEW_RANGE each side)
+///
+/// GHOSTS:
+/// A player within GHOST_MARGIN of a border can be seen from the other
+/// side, so the owner sends its position to that neighbour, which keeps a
+/// read-only ghost. Crossing the border hands ownership over (see Zone).
+///
+/// Pure arithmetic - safe from any thread.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include "World.h"
+
+struct ShardLayout {
+    /// Far enough that nobody on the other side can see past the ghosts
+    static constexpr int16_t GHOST_MARGIN = World::VIEW_RANGE;
+
+    uint8_t index = 0;
+    uint8_t count = 1;
+    int16_t map_width = 0;
+
+    bool IsSharded() const { return count > 1; }
+
+    int16_t Begin(uint8_t shard) const {
+        return static_cast<int16_t>(static_cast<int32_t>(map_width) * shard / count);
+    }
+
+    int16_t End(uint8_t shard) const {
+        return static_cast<int16_t>(static_cast<int32_t>(map_width) * (shard + 1) / count);
+    }
+
+    /// Shard owning column x. Off-map columns belong to the edge shards.
+    uint8_t OwnerOf(int16_t x) const {
+        if (x < 0) return 0;
+        if (x >= map_width) return static_cast<uint8_t>(count - 1);
+        // Largest s with Begin(s) <= x, i.e. ceil((x + 1) * count / width) - 1.
+        // Plain x * count / width disagrees with Begin() when width % count != 0.
+        const int32_t scaled = (static_cast<int32_t>(x) + 1) * count;
+        return static_cast<uint8_t>((scaled + map_width - 1) / map_width - 1);
+    }
+
+    bool Owns(int16_t x) const { return OwnerOf(x) == index; }
+
+    /// Bitmask of the other shards that should hold a ghost of a player
+    /// this shard owns at column x (bit s = shard s)
+    uint8_t GhostTargets(int16_t x) const {
+        uint8_t targets = 0;
+        if (index > 0 && x < Begin(index) + GHOST_MARGIN) {
+            targets |= static_cast<uint8_t>(1u << (index - 1));
+        }
+        if (index + 1 < count && x >= End(index) - GHOST_MARGIN) {
+            targets |= static_cast<uint8_t>(1u << (index + 1));
+        }
+        return targets;
+    }
+
+    /// Nearest column of this shard's strip to x
+    int16_t ClampToStrip(int16_t x) const {
+        return std::clamp<int16_t>(x, Begin(index), static_cast<int16_t>(End(index) - 1));
+    }
+};
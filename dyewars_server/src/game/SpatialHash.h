@@ -11,7 +11,7 @@
 /// In debug builds, we verify this with ThreadOwner assertions.
 ///
 /// WHY GAME-THREAD ONLY:
-/// The spatial hash uses nested data structures (maps of sets).
+/// The spatial hash uses nested data structures (cells of occupants).
 /// Concurrent access would require complex locking and could cause:
 /// - Iterator invalidation during iteration
 /// - Torn reads of multi-step operations
@@ -20,12 +20,17 @@
 /// Since all spatial updates (player movement, spawn, despawn) happen
 /// during the game loop, single-thread access is natural and efficient.
 ///
+/// KEYED BY HANDLE:
+/// Entities are PlayerHandles (see PlayerRegistry), so per-entity state is
+/// a vector indexed by slot, and each cell stores {handle, x, y}. Range and
+/// collision checks run on those packed occupants; a Player is only
+/// dereferenced once it is known to be in range.
+///
 /// Created by Anonymous on Dec 07, 2025
 /// =======================================
 #pragma once
 
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 #include <memory>
 #include <cstdint>
@@ -70,146 +75,74 @@ public:
 
     /// Add an entity to the spatial hash.
     /// Call when entity spawns or enters the world.
-    void Add(uint64_t entity_id,
+    void Add(PlayerHandle handle,
              int16_t x,    // TODO: Could be uint16_t
              int16_t y,    // TODO: Could be uint16_t
-             std::shared_ptr<Player> entity = nullptr) {
+             std::shared_ptr<Player> entity) {
         AssertGameThread();
-        int64_t key = CellKey(x, y);
-        cells_[key].insert(entity_id);
-        entity_cells_[entity_id] = key;
-
-        if (entity) {
-            entity_ptrs_[entity_id] = entity;
-            cell_entities_[key].push_back(entity);
-
-            // Also add to flat grid if enabled
-            if (use_flat_grid_) {
-                int32_t cx = x / CELL_SIZE;
-                int32_t cy = y / CELL_SIZE;
-                if (cx >= 0 && cx < grid_width_ && cy >= 0 && cy < grid_height_) {
-                    flat_grid_[cy * grid_width_ + cx].push_back(entity);
-                }
-            }
+        if (handle == SlotHandle::NONE || !entity) return;
+
+        const uint32_t index = SlotHandle::Index(handle);
+        if (index >= entries_.size()) entries_.resize(index + 1);
+
+        Entry &entry = entries_[index];
+        if (entry.handle != SlotHandle::NONE) {
+            // Slot reused without a Remove - drop the stale occupant first
+            RemoveFromCell(entry.cell_key, entry.handle);
+            count_--;
         }
+
+        entry.handle = handle;
+        entry.cell_key = CellKey(x, y);
+        entry.player = std::move(entity);
+        AddToCell(entry.cell_key, Occupant{handle, x, y});
+        count_++;
     }
 
     /// Remove an entity from the spatial hash.
     /// Call when entity despawns or leaves the world.
-    void Remove(uint64_t entity_id) {
+    void Remove(PlayerHandle handle) {
         AssertGameThread();
-        auto it = entity_cells_.find(entity_id);
-        if (it == entity_cells_.end()) return;
-
-        int64_t key = it->second;
-        cells_[key].erase(entity_id);
-
-        // Remove from cell_entities_ vector
-        auto cell_it = cell_entities_.find(key);
-        if (cell_it != cell_entities_.end()) {
-            auto& vec = cell_it->second;
-            vec.erase(std::remove_if(vec.begin(), vec.end(),
-                [entity_id](const std::shared_ptr<Player>& p) {
-                    return p && p->GetID() == entity_id;
-                }), vec.end());
-            if (vec.empty()) {
-                cell_entities_.erase(cell_it);
-            }
-        }
-
-        // Remove from flat grid if enabled
-        if (use_flat_grid_) {
-            // Derive cell from key (NOT from player position - it may have changed!)
-            int32_t cx = static_cast<int32_t>(key >> 32);
-            int32_t cy = static_cast<int32_t>(key & 0xFFFFFFFF);
-            if (cx >= 0 && cx < grid_width_ && cy >= 0 && cy < grid_height_) {
-                auto& vec = flat_grid_[cy * grid_width_ + cx];
-                vec.erase(std::remove_if(vec.begin(), vec.end(),
-                    [entity_id](const std::shared_ptr<Player>& p) {
-                        return p && p->GetID() == entity_id;
-                    }), vec.end());
-            }
-        }
+        Entry *entry = Find(handle);
+        if (!entry) return;
 
-        // Clean up empty cells to prevent memory bloat
-        if (cells_[key].empty()) {
-            cells_.erase(key);
-        }
-
-        entity_cells_.erase(it);
-        entity_ptrs_.erase(entity_id);
+        // Cell comes from the entry (NOT from player position - it may have changed!)
+        RemoveFromCell(entry->cell_key, handle);
+        *entry = Entry{};
+        count_--;
     }
 
     /// Update an entity's position.
-    /// Call when entity moves. Only modifies data if entity changed cells.
+    /// Call when entity moves. Only changes cells if the entity crossed one.
     /// Returns true if entity changed cells (useful for enter/leave events).
-    bool Update(uint64_t entity_id,
+    bool Update(PlayerHandle handle,
                 int16_t new_x,   // TODO: Could be uint16_t
                 int16_t new_y) { // TODO: Could be uint16_t
         AssertGameThread();
-        auto it = entity_cells_.find(entity_id);
-        if (it == entity_cells_.end()) {
+        Entry *entry = Find(handle);
+        if (!entry) {
             return false;  // Entity not in spatial hash, can't update
         }
 
-        int64_t new_key = CellKey(new_x, new_y);
-
-        // Same cell? No update needed (common case!)
-        if (it->second == new_key) {
-            return false;
-        }
-
-        int64_t old_key = it->second;
-
-        // Remove from old cell (ID set)
-        cells_[old_key].erase(entity_id);
-        if (cells_[old_key].empty()) {
-            cells_.erase(old_key);
-        }
+        const int64_t new_key = CellKey(new_x, new_y);
 
-        // Move entity pointer from old cell to new cell
-        auto ptr_it = entity_ptrs_.find(entity_id);
-        if (ptr_it != entity_ptrs_.end() && ptr_it->second) {
-            // Remove from old cell_entities_
-            auto old_cell_it = cell_entities_.find(old_key);
-            if (old_cell_it != cell_entities_.end()) {
-                auto& old_vec = old_cell_it->second;
-                old_vec.erase(std::remove_if(old_vec.begin(), old_vec.end(),
-                    [entity_id](const std::shared_ptr<Player>& p) {
-                        return p && p->GetID() == entity_id;
-                    }), old_vec.end());
-                if (old_vec.empty()) {
-                    cell_entities_.erase(old_cell_it);
-                }
-            }
-            cell_entities_[new_key].push_back(ptr_it->second);
-
-            // Update flat grid if enabled
-            if (use_flat_grid_) {
-                // Derive old cell from old_key (NOT from player position - it's already updated!)
-                int32_t old_cx = static_cast<int32_t>(old_key >> 32);
-                int32_t old_cy = static_cast<int32_t>(old_key & 0xFFFFFFFF);
-                int32_t new_cx = new_x / CELL_SIZE;
-                int32_t new_cy = new_y / CELL_SIZE;
-
-                // Remove from old flat cell
-                if (old_cx >= 0 && old_cx < grid_width_ && old_cy >= 0 && old_cy < grid_height_) {
-                    auto& old_vec = flat_grid_[old_cy * grid_width_ + old_cx];
-                    old_vec.erase(std::remove_if(old_vec.begin(), old_vec.end(),
-                        [entity_id](const std::shared_ptr<Player>& p) {
-                            return p && p->GetID() == entity_id;
-                        }), old_vec.end());
-                }
-                // Add to new flat cell
-                if (new_cx >= 0 && new_cx < grid_width_ && new_cy >= 0 && new_cy < grid_height_) {
-                    flat_grid_[new_cy * grid_width_ + new_cx].push_back(ptr_it->second);
+        // Same cell? Just refresh the cached position (common case!)
+        if (entry->cell_key == new_key) {
+            if (auto *cell = FindCell(new_key)) {
+                for (Occupant &occupant : *cell) {
+                    if (occupant.handle == handle) {
+                        occupant.x = new_x;
+                        occupant.y = new_y;
+                        break;
+                    }
                 }
             }
+            return false;
         }
 
-        // Add to new cell (ID set)
-        cells_[new_key].insert(entity_id);
-        entity_cells_[entity_id] = new_key;
+        RemoveFromCell(entry->cell_key, handle);
+        AddToCell(new_key, Occupant{handle, new_x, new_y});
+        entry->cell_key = new_key;
 
         return true;  // Changed cells
     }
@@ -218,135 +151,80 @@ public:
     /// SPATIAL QUERIES
     /// ========================================================================
 
-    /// Get all entity IDs within range of a position.
-    /// Returns entities in cells that overlap with the range.
+    /// Get all entity handles in cells overlapping the range.
     /// Note: This is a COARSE filter. Caller should do exact distance check.
     ///
     /// For a 2D tile RPG with VIEW_RANGE = 5:
     /// Player at (5,5) sees tiles (0,0) to (10,10) — an 11×11 rectangle
-    std::vector<uint64_t> GetNearbyIDs(int16_t x,      // TODO: Could be uint16_t
-                                       int16_t y,      // TODO: Could be uint16_t
-                                       int16_t range)  // TODO: Could be uint16_t
+    std::vector<PlayerHandle> GetNearbyHandles(int16_t x,      // TODO: Could be uint16_t
+                                               int16_t y,      // TODO: Could be uint16_t
+                                               int16_t range)  // TODO: Could be uint16_t
     const {
-        AssertGameThread();
-        std::vector<uint64_t> result;
-
-        // Convert position to cell index
-        int32_t center_cx = x / CELL_SIZE;
-        int32_t center_cy = y / CELL_SIZE;
-
-        // How many cells do we need to check in each direction?
-        // +1 to handle entities at cell boundaries
-        int32_t cells_radius = (range / CELL_SIZE) + 1;
-
-        // Check all cells in the square region around the center cell
-        for (int32_t dcx = -cells_radius; dcx <= cells_radius; dcx++) {
-            for (int32_t dcy = -cells_radius; dcy <= cells_radius; dcy++) {
-                int32_t cx = center_cx + dcx;
-                int32_t cy = center_cy + dcy;
-
-                // Skip negative cells (map starts at 0,0)
-                if (cx < 0 || cy < 0) continue;
-
-                int64_t key = MakeCellKey(cx, cy);
-
-                auto it = cells_.find(key);
-                if (it != cells_.end()) {
-                    for (uint64_t id: it->second) {
-                        result.push_back(id);
-                    }
-                }
+        AssertGameThreadRead();
+        std::vector<PlayerHandle> result;
+        ForEachCell(x, y, range, [&](const std::vector<Occupant> &cell) {
+            for (const Occupant &occupant : cell) {
+                result.push_back(occupant.handle);
             }
-        }
+        });
         return result;
     }
 
-    /// Get all entity pointers within range.
-    /// More convenient when you need actual entity data.
-    /// Optimized: uses flat_grid_ for O(1) cell access when available.
+    /// Get all entity pointers in cells overlapping the range (coarse).
     std::vector<std::shared_ptr<Player>> GetNearbyEntities(int16_t x,     // TODO: Could be uint16_t
                                                            int16_t y,     // TODO: Could be uint16_t
                                                            int16_t range) // TODO: Could be uint16_t
     const {
-        AssertGameThread();
+        AssertGameThreadRead();
         std::vector<std::shared_ptr<Player>> result;
-
-        // Convert position to cell index
-        int32_t center_cx = x / CELL_SIZE;
-        int32_t center_cy = y / CELL_SIZE;
-        int32_t cells_radius = (range / CELL_SIZE) + 1;
-
-        // Check all cells in the square region around the center cell
-        for (int32_t dcx = -cells_radius; dcx <= cells_radius; dcx++) {
-            for (int32_t dcy = -cells_radius; dcy <= cells_radius; dcy++) {
-                int32_t cx = center_cx + dcx;
-                int32_t cy = center_cy + dcy;
-
-                if (cx < 0 || cy < 0) continue;
-
-                // Use flat grid if available for O(1) cell access
-                if (use_flat_grid_ && cx < grid_width_ && cy < grid_height_) {
-                    size_t idx = cy * grid_width_ + cx;
-                    for (const auto& entity : flat_grid_[idx]) {
-                        if (entity) {
-                            result.push_back(entity);
-                        }
-                    }
-                } else {
-                    int64_t key = MakeCellKey(cx, cy);
-                    auto cell_it = cell_entities_.find(key);
-                    if (cell_it != cell_entities_.end()) {
-                        for (const auto& entity : cell_it->second) {
-                            if (entity) {
-                                result.push_back(entity);
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        ForEachNearby(x, y, range, [&](const std::shared_ptr<Player> &entity) {
+            result.push_back(entity);
+        });
         return result;
     }
 
-    /// Zero-copy iteration over nearby entities.
-    /// Calls func for each entity in range. No vector allocation or shared_ptr copies.
-    /// Use this in hot paths instead of GetNearbyEntities().
+    /// Zero-copy iteration over entities in cells overlapping the range (coarse).
+    /// Calls func for each entity. No vector allocation or shared_ptr copies.
     template<typename Func>
     void ForEachNearby(int16_t x, int16_t y, int16_t range, Func&& func) const {
-        AssertGameThread();
-
-        int32_t center_cx = x / CELL_SIZE;
-        int32_t center_cy = y / CELL_SIZE;
-        int32_t cells_radius = (range / CELL_SIZE) + 1;
-
-        for (int32_t dcx = -cells_radius; dcx <= cells_radius; dcx++) {
-            for (int32_t dcy = -cells_radius; dcy <= cells_radius; dcy++) {
-                int32_t cx = center_cx + dcx;
-                int32_t cy = center_cy + dcy;
+        AssertGameThreadRead();
+        ForEachCell(x, y, range, [&](const std::vector<Occupant> &cell) {
+            for (const Occupant &occupant : cell) {
+                func(entries_[SlotHandle::Index(occupant.handle)].player);
+            }
+        });
+    }
 
-                if (cx < 0 || cy < 0) continue;
+    /// Zero-copy iteration over entities within `range` (exact, rectangular).
+    /// The distance check reads the positions cached in the cell, so
+    /// entities out of range are rejected without touching their Player.
+    /// Use this in hot paths.
+    template<typename Func>
+    void ForEachInRange(int16_t x, int16_t y, int16_t range, Func&& func) const {
+        AssertGameThreadRead();
+        ForEachCell(x, y, range, [&](const std::vector<Occupant> &cell) {
+            for (const Occupant &occupant : cell) {
+                const int dx = occupant.x - x;
+                const int dy = occupant.y - y;
+                if (dx > range || -dx > range || dy > range || -dy > range) continue;
+                func(entries_[SlotHandle::Index(occupant.handle)].player);
+            }
+        });
+    }
 
-                // Use flat grid if available, otherwise fall back to hash map
-                if (use_flat_grid_ && cx < grid_width_ && cy < grid_height_) {
-                    size_t idx = cy * grid_width_ + cx;
-                    for (const auto& entity : flat_grid_[idx]) {
-                        if (entity) {
-                            func(entity);
-                        }
-                    }
-                } else {
-                    int64_t key = MakeCellKey(cx, cy);
-                    auto cell_it = cell_entities_.find(key);
-                    if (cell_it != cell_entities_.end()) {
-                        for (const auto& entity : cell_it->second) {
-                            if (entity) {
-                                func(entity);
-                            }
-                        }
-                    }
-                }
+    /// Same, handing func only the handle - for callers that read
+    /// everything else from PlayerTable columns
+    template<typename Func>
+    void ForEachHandleInRange(int16_t x, int16_t y, int16_t range, Func&& func) const {
+        AssertGameThreadRead();
+        ForEachCell(x, y, range, [&](const std::vector<Occupant> &cell) {
+            for (const Occupant &occupant : cell) {
+                const int dx = occupant.x - x;
+                const int dy = occupant.y - y;
+                if (dx > range || -dx > range || dy > range || -dy > range) continue;
+                func(occupant.handle);
             }
-        }
+        });
     }
 
     /// Initialize flat grid for known world size (call once at startup)
@@ -362,34 +240,29 @@ public:
     /// ENTITY LOOKUP
     /// ========================================================================
 
-    /// Get entity pointer by ID.
-    std::shared_ptr<Player> GetEntity(uint64_t entity_id) const {
-        AssertGameThread();
-        auto it = entity_ptrs_.find(entity_id);
-        return (it != entity_ptrs_.end()) ? it->second : nullptr;
+    /// Get entity pointer by handle.
+    std::shared_ptr<Player> GetEntity(PlayerHandle handle) const {
+        AssertGameThreadRead();
+        const Entry *entry = Find(handle);
+        return entry ? entry->player : nullptr;
     }
 
     /// Check if entity exists in spatial hash.
-    bool Contains(uint64_t entity_id) const {
-        AssertGameThread();
-        return entity_cells_.find(entity_id) != entity_cells_.end();
+    bool Contains(PlayerHandle handle) const {
+        AssertGameThreadRead();
+        return Find(handle) != nullptr;
     }
 
     /// Check if a player is at exact position (excluding a specific player).
-    /// Returns true if any player other than exclude_id is at (x, y).
-    bool IsPlayerAt(int16_t x, int16_t y, uint64_t exclude_id = 0) const {
-        AssertGameThread();
-        int64_t key = CellKey(x, y);
-        auto cell_it = cells_.find(key);
-        if (cell_it == cells_.end()) return false;
-
-        for (uint64_t id : cell_it->second) {
-            if (id == exclude_id) continue;
-            auto ptr_it = entity_ptrs_.find(id);
-            if (ptr_it != entity_ptrs_.end() && ptr_it->second) {
-                if (ptr_it->second->GetX() == x && ptr_it->second->GetY() == y) {
-                    return true;
-                }
+    /// Returns true if any player other than `exclude` is at (x, y).
+    bool IsPlayerAt(int16_t x, int16_t y, PlayerHandle exclude = SlotHandle::NONE) const {
+        AssertGameThreadRead();
+        const auto *cell = FindCell(CellKey(x, y));
+        if (!cell) return false;
+
+        for (const Occupant &occupant : *cell) {
+            if (occupant.handle != exclude && occupant.x == x && occupant.y == y) {
+                return true;
             }
         }
         return false;
@@ -397,8 +270,8 @@ public:
 
     /// Get total entity count.
     size_t Count() const {
-        AssertGameThread();
-        return entity_cells_.size();
+        AssertGameThreadRead();
+        return count_;
     }
 
     /// ========================================================================
@@ -406,11 +279,11 @@ public:
     /// ========================================================================
 
     /// Iterate over all entities.
-    void ForEach(const std::function<void(uint64_t, const std::shared_ptr<Player> &)> &func) const {
-        AssertGameThread();
-        for (const auto &[id, entity]: entity_ptrs_) {
-            if (entity) {
-                func(id, entity);
+    void ForEach(const std::function<void(PlayerHandle, const std::shared_ptr<Player> &)> &func) const {
+        AssertGameThreadRead();
+        for (const Entry &entry : entries_) {
+            if (entry.handle != SlotHandle::NONE) {
+                func(entry.handle, entry.player);
             }
         }
     }
@@ -422,16 +295,17 @@ public:
     /// Clear all data.
     void Clear() {
         AssertGameThread();
-        cells_.clear();
-        cell_entities_.clear();
-        entity_cells_.clear();
-        entity_ptrs_.clear();
+        for (auto &cell : flat_grid_) cell.clear();
+        overflow_cells_.clear();
+        entries_.clear();
+        count_ = 0;
+        active_cells_ = 0;
     }
 
-    /// Get number of active cells (for debugging).
+    /// Get number of occupied cells (for debugging).
     size_t CellCount() const {
-        AssertGameThread();
-        return cells_.size();
+        AssertGameThreadRead();
+        return active_cells_;
     }
 
 private:
@@ -444,6 +318,14 @@ private:
             thread_owner_.SetOwner();
         }
     }
+
+    /// Read-only queries may also come from a joined job
+    void AssertGameThreadRead() const {
+        ASSERT_GAME_THREAD_READ(thread_owner_);
+        if (!thread_owner_.IsOwnerSet()) {
+            thread_owner_.SetOwner();
+        }
+    }
     /// ========================================================================
     /// INTERNAL - Cell Key Calculation
     /// ========================================================================
@@ -462,28 +344,124 @@ private:
     }
 
     /// ========================================================================
-    /// DATA
+    /// INTERNAL - Cells
     /// ========================================================================
 
-    /// cell_key -> set of entity IDs in that cell
-    std::unordered_map<int64_t, std::unordered_set<uint64_t>> cells_;
+    /// One entity in a cell. 8 bytes: a cell's occupants sit in a couple of
+    /// cache lines, and range/collision checks never leave them.
+    struct Occupant {
+        PlayerHandle handle;
+        int16_t x;
+        int16_t y;
+    };
+
+    /// Per-handle state, indexed by SlotHandle::Index(handle)
+    struct Entry {
+        PlayerHandle handle = SlotHandle::NONE;  // NONE = slot unused here
+        int64_t cell_key = 0;                    // Current cell (for removal and move detection)
+        std::shared_ptr<Player> player;
+    };
+
+    Entry *Find(PlayerHandle handle) {
+        const uint32_t index = SlotHandle::Index(handle);
+        if (handle == SlotHandle::NONE || index >= entries_.size() || entries_[index].handle != handle) return nullptr;
+        return &entries_[index];
+    }
+
+    const Entry *Find(PlayerHandle handle) const {
+        return const_cast<SpatialHash *>(this)->Find(handle);
+    }
+
+    /// Cell for a key: the flat grid inside the map, the hash map outside
+    /// it (or before InitFlatGrid). nullptr if it was never created.
+    std::vector<Occupant> *FindCell(int64_t key) {
+        const auto cx = static_cast<int32_t>(key >> 32);
+        const auto cy = static_cast<int32_t>(key & 0xFFFFFFFF);
+        if (use_flat_grid_ && cx >= 0 && cx < grid_width_ && cy >= 0 && cy < grid_height_) {
+            return &flat_grid_[cy * grid_width_ + cx];
+        }
+        auto it = overflow_cells_.find(key);
+        return it != overflow_cells_.end() ? &it->second : nullptr;
+    }
+
+    const std::vector<Occupant> *FindCell(int64_t key) const {
+        return const_cast<SpatialHash *>(this)->FindCell(key);
+    }
 
-    /// cell_key -> vector of entity pointers (for fast GetNearbyEntities)
-    /// Avoids ID→ptr lookup indirection in hot path
-    std::unordered_map<int64_t, std::vector<std::shared_ptr<Player>>> cell_entities_;
+    void AddToCell(int64_t key, Occupant occupant) {
+        auto *cell = FindCell(key);
+        if (!cell) cell = &overflow_cells_[key];
+        if (cell->empty()) active_cells_++;
+        cell->push_back(occupant);
+    }
+
+    void RemoveFromCell(int64_t key, PlayerHandle handle) {
+        auto *cell = FindCell(key);
+        if (!cell) return;
+        auto it = std::find_if(cell->begin(), cell->end(),
+                               [handle](const Occupant &o) { return o.handle == handle; });
+        if (it == cell->end()) return;
+
+        // Order within a cell doesn't matter - swap-and-pop
+        *it = cell->back();
+        cell->pop_back();
+        if (cell->empty()) {
+            active_cells_--;
+            overflow_cells_.erase(key);  // Clean up empty cells to prevent memory bloat
+        }
+    }
+
+    /// Call func(cell) for every non-empty cell overlapping the range
+    template<typename Func>
+    void ForEachCell(int16_t x, int16_t y, int16_t range, Func &&func) const {
+        // Convert position to cell index
+        int32_t center_cx = x / CELL_SIZE;
+        int32_t center_cy = y / CELL_SIZE;
 
-    /// entity_id -> current cell key (for O(1) removal and move detection)
-    std::unordered_map<uint64_t, int64_t> entity_cells_;
+        // How many cells do we need to check in each direction?
+        // +1 to handle entities at cell boundaries
+        int32_t cells_radius = (range / CELL_SIZE) + 1;
 
-    /// entity_id -> entity pointer (for GetEntity by ID)
-    std::unordered_map<uint64_t, std::shared_ptr<Player>> entity_ptrs_;
+        // Check all cells in the square region around the center cell
+        for (int32_t dcy = -cells_radius; dcy <= cells_radius; dcy++) {
+            for (int32_t dcx = -cells_radius; dcx <= cells_radius; dcx++) {
+                int32_t cx = center_cx + dcx;
+                int32_t cy = center_cy + dcy;
+
+                // Skip negative cells (map starts at 0,0)
+                if (cx < 0 || cy < 0) continue;
+
+                // Use flat grid if available for O(1) cell access
+                if (use_flat_grid_ && cx < grid_width_ && cy < grid_height_) {
+                    const auto &cell = flat_grid_[cy * grid_width_ + cx];
+                    if (!cell.empty()) func(cell);
+                } else {
+                    auto it = overflow_cells_.find(MakeCellKey(cx, cy));
+                    if (it != overflow_cells_.end()) func(it->second);
+                }
+            }
+        }
+    }
+
+    /// ========================================================================
+    /// DATA
+    /// ========================================================================
+
+    /// handle index -> entry. Array indexing instead of a hash probe per lookup.
+    std::vector<Entry> entries_;
 
     /// Flat grid for O(1) cell access (no hash lookups)
-    std::vector<std::vector<std::shared_ptr<Player>>> flat_grid_;
+    std::vector<std::vector<Occupant>> flat_grid_;
     int32_t grid_width_ = 0;
     int32_t grid_height_ = 0;
     bool use_flat_grid_ = false;
 
+    /// cell_key -> occupants, for cells off the flat grid
+    std::unordered_map<int64_t, std::vector<Occupant>> overflow_cells_;
+
+    size_t count_ = 0;
+    size_t active_cells_ = 0;
+
     /// Thread owner for debug assertions (mutable for const methods)
     mutable ThreadOwner thread_owner_;
-};
\ No newline at end of file
+};
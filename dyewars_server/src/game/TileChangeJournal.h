@@ -0,0 +1,167 @@
+/// =======================================
+/// DyeWarsServer - TileChangeJournal
+///
+/// The tile edits a zone made during one tick. Edits are applied to the
+/// TileMap through the journal, and at the end of the tick Seal() reduces
+/// them to one change per tile, holding the tile's final state. A door
+/// toggled three times in a tick is one change. One toggled back to where
+/// it started is none.
+///
+/// WHY NOT JUST THE CHUNK RESEND:
+/// MapStreamer re-sends an edited chunk to everyone holding it. That is the
+/// whole chunk (21 to 1000+ bytes) for a one-tile door. A journal change
+/// is 6 bytes on the wire with its blocked state. Chunks carry dynamic
+/// blockers too (see MapStreamer), for clients that arrive later. The zone sends each
+/// viewer one S_Tile_Update with every change in its view (see
+/// Zone::BroadcastTileChanges), and a chunk is still re-sent to whoever
+/// didn't see all of its changes.
+///
+/// Not thread-safe; owned by the zone's game thread. Other threads (Lua,
+/// the console) queue TileEdits with Zone::QueueTileEdit(), which the zone
+/// applies here at the start of its next tick.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "TileMap.h"
+
+/// One queued edit (6 bytes, so Zone's edit ring stays small)
+struct TileEdit {
+    enum class Kind : uint8_t {
+        Type,     // value = tile type
+        Blocked,  // value = 1 to block (dynamic layer), 0 to clear
+    };
+
+    int16_t x = 0;
+    int16_t y = 0;
+    Kind kind = Kind::Type;
+    uint8_t value = 0;
+};
+
+class TileChangeJournal {
+public:
+    /// A tile's net change over the tick
+    struct Change {
+        int16_t x;
+        int16_t y;
+        uint8_t type;      // Final tile type
+        bool blocked;      // Final blocked state, static or dynamic
+        uint32_t chunk;    // Its slot in TouchedChunks()
+    };
+
+    /// A chunk with at least one edit, and its version before the tick's
+    /// first edit - clients holding that version can be patched
+    struct TouchedChunk {
+        uint32_t index;    // Chunk index, row-major
+        uint32_t version_before;
+        uint32_t changes;  // Net changes in it
+    };
+
+    explicit TileChangeJournal(TileMap &map) : map_(map) {}
+
+    /// ========================================================================
+    /// EDITS - applied to the map at once
+    /// ========================================================================
+
+    /// False if off the map or the map is released
+    bool SetTile(int16_t x, int16_t y, uint8_t type) {
+        if (!Touch(x, y)) return false;
+        map_.SetTile(x, y, type);
+        return true;
+    }
+
+    /// Dynamic blocker (doors, placed obstacles). False if off the map or
+    /// the map is released.
+    bool SetBlocked(int16_t x, int16_t y, bool blocked) {
+        if (!Touch(x, y)) return false;
+        map_.SetTileBlocked(x, y, blocked);
+        return true;
+    }
+
+    bool Apply(const TileEdit &edit) {
+        return edit.kind == TileEdit::Kind::Type ? SetTile(edit.x, edit.y, edit.value)
+                                                 : SetBlocked(edit.x, edit.y, edit.value != 0);
+    }
+
+    /// ========================================================================
+    /// END OF TICK
+    /// ========================================================================
+
+    /// Reduce the tick's edits to Changes() and TouchedChunks(), in the
+    /// order the tiles were first edited. A chunk whose edits all cancel
+    /// out is still listed, with no changes.
+    void Seal() {
+        changes_.clear();
+        chunks_.clear();
+        chunk_slots_.clear();
+        for (const Touched &tile : touched_) {
+            // The chunk's first edited tile has its version before the tick
+            const uint32_t chunk = ChunkIndex(tile.x, tile.y);
+            auto [slot, added] = chunk_slots_.try_emplace(chunk, static_cast<uint32_t>(chunks_.size()));
+            if (added) chunks_.push_back({chunk, tile.chunk_version_before, 0});
+
+            const uint8_t type = map_.GetTile(tile.x, tile.y);
+            const bool blocked = map_.IsTileBlocked(tile.x, tile.y);
+            if (type == tile.type_before && blocked == tile.blocked_before) continue;
+            changes_.push_back({tile.x, tile.y, type, blocked, slot->second});
+            chunks_[slot->second].changes++;
+        }
+    }
+
+    const std::vector<Change> &Changes() const { return changes_; }
+
+    const std::vector<TouchedChunk> &TouchedChunks() const { return chunks_; }
+
+    /// Edits applied since Clear(), before deduplication
+    size_t EditCount() const { return edits_; }
+
+    /// Start the next tick (keeps capacity)
+    void Clear() {
+        touched_.clear();
+        touched_slots_.clear();
+        changes_.clear();
+        chunks_.clear();
+        edits_ = 0;
+    }
+
+private:
+    /// A tile's state before its first edit this tick
+    struct Touched {
+        int16_t x;
+        int16_t y;
+        uint8_t type_before;
+        bool blocked_before;
+        uint32_t chunk_version_before;
+    };
+
+    uint32_t ChunkIndex(int16_t x, int16_t y) const {
+        return static_cast<uint32_t>(y / TileMap::CHUNK_SIZE) * static_cast<uint32_t>(map_.ChunksX()) +
+               static_cast<uint32_t>(x / TileMap::CHUNK_SIZE);
+    }
+
+    /// Count an edit, remembering the tile's state the first time
+    bool Touch(int16_t x, int16_t y) {
+        if (!map_.InBounds(x, y) || !map_.IsResident()) return false;
+        edits_++;
+        const uint32_t tile = static_cast<uint32_t>(y) * static_cast<uint32_t>(map_.GetWidth()) +
+                              static_cast<uint32_t>(x);
+        if (touched_slots_.try_emplace(tile, static_cast<uint32_t>(touched_.size())).second) {
+            touched_.push_back({x, y, map_.GetTile(x, y), map_.IsTileBlocked(x, y),
+                                map_.ChunkVersion(static_cast<int16_t>(x / TileMap::CHUNK_SIZE),
+                                                  static_cast<int16_t>(y / TileMap::CHUNK_SIZE))});
+        }
+        return true;
+    }
+
+    TileMap &map_;
+    std::vector<Touched> touched_;                          // First-edit order
+    std::unordered_map<uint32_t, uint32_t> touched_slots_;  // Tile index -> touched_ slot
+    std::vector<Change> changes_;
+    std::vector<TouchedChunk> chunks_;
+    std::unordered_map<uint32_t, uint32_t> chunk_slots_;    // Chunk index -> chunks_ slot
+    size_t edits_ = 0;
+};
@@ -4,17 +4,36 @@
 ///
 /// This is a "dumb" data structure that holds:
 /// - Tile types (grass, water, stone, etc.)
-/// - Blocking data (walls, obstacles)
-/// - Serialization for client sync
+/// - Blocking data (walls, obstacles) - a packed CollisionGrid
+/// - Serialization for client sync, in 32x32 chunks with a version each
+///
+/// Tiles are either owned or read straight from a mapped .dwm file
+/// (MapFile). A file-backed map can be released while nobody is on it and
+/// loaded again on demand; the first edit copies the tiles out of the
+/// mapping, and an edited map stays loaded.
+///
+/// INSTANCES:
+/// Dungeons and other instanced maps are many copies of one map.
+/// InstanceOf() shares an immutable base map's tiles and blocking bits
+/// instead of copying them: an edit copies just its 32x32 chunk into an
+/// overlay (1 KB) and its collision row, so an instance costs a pointer
+/// per chunk and per row plus what it edited, and starts in microseconds
+/// (see InstancePool, which also recycles them).
 ///
 /// Created by Anonymous on Dec 05, 2025
 /// =======================================
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <span>
 #include <vector>
 #include <cstdint>
 #include <string>
 #include <stdexcept>
+#include <utility>
+#include "CollisionGrid.h"
+#include "MapFile.h"
 
 /// ============================================================================
 /// TILE TYPES
@@ -30,7 +49,7 @@ namespace TileTypes {
     constexpr uint8_t Wall = 0x02;
     constexpr uint8_t Grass = 0x03;
 
-    inline bool IsBlocking(uint8_t type) {
+    constexpr bool IsBlocking(uint8_t type) {
         switch (type) {
             case Void:
             case Wall:
@@ -40,6 +59,17 @@ namespace TileTypes {
         }
     }
 
+    /// FNV-1a over IsBlocking() of every type. A map file stores the one
+    /// its collision bits were built with (MapFile::Header::blocking_hash),
+    /// so a file from before a change to IsBlocking() is caught on load.
+    constexpr uint64_t BlockingTableHash() {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (unsigned type = 0; type < 256; type++) {
+            hash = (hash ^ (IsBlocking(static_cast<uint8_t>(type)) ? 1u : 0u)) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
 }
 /// ============================================================================
 /// TILEMAP
@@ -47,7 +77,7 @@ namespace TileTypes {
 /// Pure data container for a single map's tile information.
 /// World can own multiple TileMaps for different zones/instances.
 ///
-/// Storage: 1D vector for cache efficiency
+/// Storage: 1D array for cache efficiency - a vector, or a mapped .dwm file
 /// Index formula: y * width + x
 /// ============================================================================
 class TileMap {
@@ -63,12 +93,14 @@ public:
             uint8_t default_tile = TileTypes::Grass)
             : width_(width),
               height_(height),
-              map_id_(0) {
+              map_id_(0),
+              collision_(width, height),
+              chunk_versions_(static_cast<size_t>(ChunksX()) * ChunksY(), 1) {
         // Initialize all tiles to default type
-        tiles_.resize(width * height, default_tile);
+        owned_tiles_.resize(width * height, default_tile);
+        tiles_ = owned_tiles_.data();
 
         // Initialize blocking based on tile types
-        blocking_.resize(width * height, false);
         RecalculateBlocking();
     }
 
@@ -76,16 +108,46 @@ public:
     TileMap(int16_t width, int16_t height, const std::vector<uint8_t> &tile_data)
             : width_(width),
               height_(height),
-              map_id_(0) {
+              map_id_(0),
+              collision_(width, height),
+              chunk_versions_(static_cast<size_t>(ChunksX()) * ChunksY(), 1) {
         if (tile_data.size() != static_cast<size_t>(width * height)) {
             throw std::invalid_argument("Tile data size doesn't match dimensions.");
         }
-        tiles_ = tile_data;
-        blocking_.resize(width * height, false);
+        owned_tiles_ = tile_data;
+        tiles_ = owned_tiles_.data();
         RecalculateBlocking();
 
     }
 
+    /// A map stored in a .dwm file. Only the header is read: the map
+    /// starts released and Load() maps its tiles. Throws
+    /// std::runtime_error if the file isn't a valid map.
+    static std::unique_ptr<TileMap> FromFile(const std::string &path) {
+        const MapFile::Header header = MapFile::ReadHeader(path);
+        std::unique_ptr<TileMap> map(new TileMap(FileBacked{}, static_cast<int16_t>(header.width),
+                                                 static_cast<int16_t>(header.height), path));
+        map->map_name_.assign(header.name, header.name_length);
+        return map;
+    }
+
+    /// A copy of `base` that shares its tiles and blocking bits, copying a
+    /// chunk on its first edit. `base` stays alive with the instance and
+    /// must not change while shared - hold it only as const. Throws
+    /// std::invalid_argument if `base` is released or itself an instance.
+    static std::unique_ptr<TileMap> InstanceOf(std::shared_ptr<const TileMap> base) {
+        if (!base || !base->IsResident() || base->IsInstance()) {
+            throw std::invalid_argument("Instance base must be a loaded, non-instance map");
+        }
+        return std::unique_ptr<TileMap>(new TileMap(std::move(base)));
+    }
+
+    /// tiles_ points into owned_tiles_ or the mapping - a copy would point
+    /// into the original
+    TileMap(const TileMap &) = delete;
+
+    TileMap &operator=(const TileMap &) = delete;
+
     /// ========================================================================
     /// MAP IDENTITY
     /// ========================================================================
@@ -116,59 +178,88 @@ public:
     /// Get tile type at position
     /// Returns TileTypes::Void if out of bounds
     uint8_t GetTile(int16_t x, int16_t y) const {
-        if (!InBounds(x, y)) return TileTypes::Void;
+        if (!InBounds(x, y) || !tiles_) return TileTypes::Void;
+        if (overlay_count_ > 0) {
+            if (const uint8_t *chunk = overlays_[ChunkIndex(x, y)].get()) return chunk[ChunkOffset(x, y)];
+        }
         return tiles_[Index(x, y)];
     }
 
     /// Set tile type at position
-    /// Also updates blocking state based on tile type
+    /// Also updates blocking state based on tile type, and the chunk's
+    /// version if the type changed. Ignored while released.
     void SetTile(int16_t x, int16_t y, uint8_t type) {
-        if (!InBounds(x, y)) return;
-        size_t idx = Index(x, y);
-        tiles_[idx] = type;
-        blocking_[idx] = TileTypes::IsBlocking(type);
+        if (!InBounds(x, y) || !tiles_) return;
+        if (GetTile(x, y) != type) {
+            if (base_) {
+                Overlay(x, y)[ChunkOffset(x, y)] = type;
+            } else {
+                if (file_) DetachFromFile();
+                owned_tiles_[Index(x, y)] = type;
+            }
+            modified_ = true;
+            chunk_versions_[ChunkIndex(x, y)]++;
+            revision_++;
+        }
+        collision_.Set(x, y, CollisionGrid::Layer::Static, TileTypes::IsBlocking(type));
     }
 
     /// ========================================================================
     /// BLOCKING / COLLISION
     /// ========================================================================
 
-    /// Check if a tile is blocked (out of bounds = blocked)
+    /// Check if a tile is blocked (out of bounds = blocked, no branch -
+    /// see CollisionGrid)
     bool IsTileBlocked(int16_t x, int16_t y) const {
-        if (!InBounds(x, y)) return true;  // Out of bounds is blocked
-        return blocking_[Index(x, y)];
+        return collision_.IsBlocked(x, y);
     }
 
     /// Manually set blocking state (for dynamic obstacles, doors, etc.)
-    /// This overrides the natural blocking of the tile type
+    /// This is the dynamic layer: it can block a walkable tile, but it
+    /// can't open a wall - give a door a walkable tile type instead.
+    /// Streamed chunks carry this layer, so a change moves the chunk's
+    /// version on like a tile type change.
     void SetTileBlocked(int16_t x, int16_t y, bool blocked) {
-        if (!InBounds(x, y)) return;
-        blocking_[Index(x, y)] = blocked;
-    };
+        if (!tiles_) return;
+        if (!collision_.Set(x, y, CollisionGrid::Layer::Dynamic, blocked)) return;
+        modified_ = true;
+        chunk_versions_[ChunkIndex(x, y)]++;
+        revision_++;
+    }
+
+    /// The dynamic layer alone (SetTileBlocked), false off the map
+    bool IsTileDynamicBlocked(int16_t x, int16_t y) const {
+        return collision_.IsSet(x, y, CollisionGrid::Layer::Dynamic);
+    }
 
-    /// Recalculate all blocking from tile types
-    /// Call after bulk tile changes
+    /// Recalculate static blocking from tile types
+    /// Call after bulk tile changes. Dynamic blockers are kept.
     void RecalculateBlocking() {
-        for (size_t i = 0; i < tiles_.size(); ++i) {
-            blocking_[i] = TileTypes::IsBlocking(tiles_[i]);
+        if (!tiles_) return;
+        collision_.ClearLayer(CollisionGrid::Layer::Static);
+        for (int16_t y = 0; y < height_; y++) {
+            for (int16_t x = 0; x < width_; x++) {
+                if (TileTypes::IsBlocking(overlay_count_ > 0 ? GetTile(x, y) : tiles_[Index(x, y)])) {
+                    collision_.Set(x, y, CollisionGrid::Layer::Static, true);
+                }
+            }
         }
     }
 
+    /// Row and rectangle queries ("any blocked in rect", "first free
+    /// tile in row") for spawn placement and pathfinding
+    const CollisionGrid &Collision() const { return collision_; }
+
     /// ========================================================================
     /// SERIALIZATION - For Client Sync
     /// ========================================================================
 
-    /// Get raw tile data for entire map
-    /// Use for initial map load or full sync
-    // TODO the WORLD should contain a map of tilemaps. each tilemap is a 'map'
-    // maps are loaded from .map files on the server.
-    // Loaded if a player is on them, unloaded when not in use.
-    // Psuedo Code:
-    // World.current_map_ = TileMap map;
-    // World.maps_in_use_ = std::unordered_map<TileMap> or something similar
-    // This function will incorporate that.
-    const std::vector<uint8_t> &GetRawTileData() const {
-        return tiles_;
+    /// Get raw tile data for entire map, row-major (empty while released,
+    /// and for instances - their tiles aren't one array; use
+    /// CopyRegionTiles). Use for initial map load or full sync
+    std::span<const uint8_t> GetRawTileData() const {
+        if (!tiles_ || base_) return {};
+        return {tiles_, static_cast<size_t>(width_) * height_};
     }
 
     /// Get tile data for a rectangular region
@@ -180,14 +271,44 @@ public:
             int16_t region_width,
             int16_t region_height) const {
         std::vector<uint8_t> region;
-        region.reserve(region_width * region_height);
+        CopyRegionTiles(start_x, start_y, region_width, region_height, region);
+        return region;
+    }
 
-        for (int16_t y = start_y; y < start_y + region_height; y++) {
-            for (int16_t x = start_x; x < start_x + region_width; x++) {
-                region.push_back(GetTile(x, y));
+    /// Same, into a reused buffer. The region is clipped to the map once
+    /// and copied a row span at a time; tiles outside stay Void.
+    void CopyRegionTiles(int16_t start_x, int16_t start_y,
+                         int16_t region_width, int16_t region_height,
+                         std::vector<uint8_t> &out) const {
+        if (region_width <= 0 || region_height <= 0) {
+            out.clear();
+            return;
+        }
+        out.assign(static_cast<size_t>(region_width) * region_height, TileTypes::Void);
+        if (!tiles_) return;
+
+        const int x0 = std::max<int>(start_x, 0);
+        const int x1 = std::min<int>(start_x + region_width, width_);
+        const int y0 = std::max<int>(start_y, 0);
+        const int y1 = std::min<int>(start_y + region_height, height_);
+        for (int y = y0; y < y1 && x0 < x1; y++) {
+            const auto row = out.begin() + static_cast<std::ptrdiff_t>(y - start_y) * region_width;
+            if (overlay_count_ == 0) {
+                std::copy_n(tiles_ + Index(static_cast<int16_t>(x0), static_cast<int16_t>(y)), x1 - x0,
+                            row + (x0 - start_x));
+                continue;
+            }
+            // Instance with overlays: a span per chunk, from its overlay or the base
+            for (int x = x0; x < x1;) {
+                const int end = std::min(x1, (x / CHUNK_SIZE + 1) * CHUNK_SIZE);
+                const auto tx = static_cast<int16_t>(x);
+                const auto ty = static_cast<int16_t>(y);
+                const uint8_t *chunk = overlays_[ChunkIndex(tx, ty)].get();
+                std::copy_n(chunk ? chunk + ChunkOffset(tx, ty) : tiles_ + Index(tx, ty), end - x,
+                            row + (x - start_x));
+                x = end;
             }
         }
-        return region;
     }
 
 /// Get tiles in a view centered on a position
@@ -200,6 +321,130 @@ public:
         return GetRegionTiles(start_x, start_y, size, size);
     }
 
+    /// ========================================================================
+    /// CHUNKS - For streaming (see MapStreamer)
+    /// ========================================================================
+
+    /// Tiles per chunk side. Chunks on the right / bottom edge may be
+    /// narrower.
+    static constexpr int16_t CHUNK_SIZE = 32;
+
+    int16_t ChunksX() const { return static_cast<int16_t>((width_ + CHUNK_SIZE - 1) / CHUNK_SIZE); }
+
+    int16_t ChunksY() const { return static_cast<int16_t>((height_ + CHUNK_SIZE - 1) / CHUNK_SIZE); }
+
+    /// Starts at 1, bumped whenever a tile in the chunk changes type or
+    /// dynamic blocker
+    uint32_t ChunkVersion(int16_t chunk_x, int16_t chunk_y) const {
+        return chunk_versions_[static_cast<size_t>(chunk_y) * ChunksX() + chunk_x];
+    }
+
+    /// Bumped with every chunk version - one compare tells a streamer
+    /// whether anything changed
+    uint64_t Revision() const { return revision_; }
+
+    /// ========================================================================
+    /// BACKING FILE - Load on demand, release when idle (see MapFile)
+    /// ========================================================================
+
+    /// Map the backing file if the tiles aren't resident. Returns true if
+    /// it loaded now. Every chunk version moves on, so streamed copies are
+    /// re-sent. Throws std::runtime_error if the file is gone, invalid or
+    /// no longer the size it was at FromFile().
+    ///
+    /// The file's collision bits are copied as they are only if they were
+    /// built with today's TileTypes::IsBlocking(). Otherwise the static
+    /// layer is rebuilt from the tiles (StaleBlocking() says so) - slower,
+    /// it reads every tile, until the file is converted again.
+    bool Load() {
+        if (IsResident() || source_path_.empty()) return false;
+        auto file = MapFile::Open(source_path_);
+        const auto &header = file->GetHeader();
+        if (header.width != width_ || header.height != height_) {
+            throw std::runtime_error(source_path_ + " changed size since the map was created");
+        }
+        collision_ = CollisionGrid(width_, height_);
+        tiles_ = file->Tiles().data();
+        stale_blocking_ = header.blocking_hash != TileTypes::BlockingTableHash();
+        if (stale_blocking_) {
+            RecalculateBlocking();
+        } else if (!collision_.LoadStaticWords(file->CollisionWords())) {
+            tiles_ = nullptr;
+            collision_ = CollisionGrid(0, 0);
+            throw std::runtime_error(source_path_ + " collision section doesn't fit the map");
+        }
+        file_ = std::move(file);
+        for (auto &version : chunk_versions_) version++;
+        revision_++;
+        return true;
+    }
+
+    /// Drop the tiles, blocking bits and mapping of an unedited
+    /// file-backed map. Until Load() every tile reads Void and blocked.
+    /// Returns false (and keeps everything) for edited or in-memory maps.
+    bool Release() {
+        if (!file_ || modified_) return false;
+        file_.reset();
+        tiles_ = nullptr;
+        collision_ = CollisionGrid(0, 0);
+        return true;
+    }
+
+    bool IsResident() const { return tiles_ != nullptr; }
+
+    /// The last Load() rebuilt the static layer from the tiles: the file's
+    /// bits were built with a different blocking table (see Load())
+    bool StaleBlocking() const { return stale_blocking_; }
+
+    /// Tiles currently read from the mapped file (not yet edited)
+    bool IsMapped() const { return file_ != nullptr; }
+
+    /// Any tile or blocker changed since the map was created or loaded
+    /// (or, for an instance, reset)
+    bool IsModified() const { return modified_; }
+
+    /// The .dwm file behind FromFile(), empty for in-memory maps
+    const std::string &GetSourcePath() const { return source_path_; }
+
+    /// ========================================================================
+    /// INSTANCES - Shared base map, per-chunk copy-on-write (see InstanceOf)
+    /// ========================================================================
+
+    bool IsInstance() const { return base_ != nullptr; }
+
+    /// The map an instance shares, null for other maps
+    const std::shared_ptr<const TileMap> &GetBase() const { return base_; }
+
+    /// Chunks an instance has copied to edit
+    size_t OverlayCount() const { return overlay_count_; }
+
+    /// Bytes an instance holds beyond its base: chunk overlays, copied
+    /// collision rows, and the per-chunk / per-row tables
+    size_t InstanceBytes() const {
+        if (!base_) return 0;
+        return overlay_count_ * CHUNK_SIZE * CHUNK_SIZE + owned_tiles_.size() +
+               collision_.CopiedRows() * collision_.RowBytes() +
+               overlays_.size() * sizeof(overlays_[0]) + chunk_versions_.size() * sizeof(uint32_t) +
+               (static_cast<size_t>(height_) + 2) * 2 * sizeof(void *);
+    }
+
+    /// Drop an instance's edits - tiles and blockers read the base again.
+    /// Every chunk version moves on, so streamed copies are re-sent.
+    /// Returns false (and changes nothing) for other maps.
+    bool ResetToBase() {
+        if (!base_) return false;
+        for (auto &chunk : overlays_) chunk.reset();
+        overlay_count_ = 0;
+        owned_tiles_.clear();
+        owned_tiles_.shrink_to_fit();
+        tiles_ = base_->tiles_;
+        collision_.ResetToBase();
+        modified_ = false;
+        for (auto &version : chunk_versions_) version++;
+        revision_++;
+        return true;
+    }
+
     /// ========================================================================
     /// BULK OPERATIONS - For Lua / Editor
     /// ========================================================================
@@ -219,8 +464,16 @@ public:
         if (data.size() != static_cast<size_t>(width_ * height_)) {
             throw std::invalid_argument("Data size doesn't match map dimensions");
         }
-        tiles_ = data;
+        file_.reset();
+        for (auto &chunk : overlays_) chunk.reset();  // An instance keeps its base for ResetToBase()
+        overlay_count_ = 0;
+        owned_tiles_ = data;
+        tiles_ = owned_tiles_.data();
+        modified_ = true;
+        if (collision_.GetWidth() != width_) collision_ = CollisionGrid(width_, height_);  // Was released
         RecalculateBlocking();
+        for (auto &version : chunk_versions_) version++;
+        revision_++;
     }
 
     /// Create a wall border around the map
@@ -242,10 +495,72 @@ private:
     /// INTERNAL
     /// ========================================================================
 
+    struct FileBacked {};
+
+    /// Released map of FromFile(): dimensions only
+    TileMap(FileBacked, int16_t width, int16_t height, std::string source_path)
+            : width_(width),
+              height_(height),
+              map_id_(0),
+              source_path_(std::move(source_path)),
+              collision_(0, 0),
+              chunk_versions_(static_cast<size_t>(ChunksX()) * ChunksY(), 1) {
+    }
+
+    /// InstanceOf(): everything read from `base`, nothing copied yet
+    explicit TileMap(std::shared_ptr<const TileMap> base)
+            : width_(base->width_),
+              height_(base->height_),
+              map_id_(base->map_id_),
+              map_name_(base->map_name_),
+              tiles_(base->tiles_),
+              base_(std::move(base)),
+              overlays_(static_cast<size_t>(ChunksX()) * ChunksY()),
+              collision_(CollisionGrid::Shared(base_->collision_)),
+              chunk_versions_(overlays_.size(), 1) {
+    }
+
     /// Convert 2D coordinates to 1D index
     size_t Index(int16_t x, int16_t y) const {
         return static_cast<size_t>(y * width_ + x);
     }
+
+    /// Row-major chunk index, and a tile's offset in its chunk's overlay
+    size_t ChunkIndex(int16_t x, int16_t y) const {
+        return static_cast<size_t>(y / CHUNK_SIZE) * ChunksX() + x / CHUNK_SIZE;
+    }
+
+    static size_t ChunkOffset(int16_t x, int16_t y) {
+        return static_cast<size_t>(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE;
+    }
+
+    /// An instance's overlay for the chunk holding (x, y), copied from
+    /// the base tiles the first time. Edge chunks leave the bytes past the
+    /// map unused.
+    uint8_t *Overlay(int16_t x, int16_t y) {
+        auto &chunk = overlays_[ChunkIndex(x, y)];
+        if (!chunk) {
+            chunk = std::make_unique_for_overwrite<uint8_t[]>(static_cast<size_t>(CHUNK_SIZE) * CHUNK_SIZE);
+            const auto x0 = static_cast<int16_t>(x / CHUNK_SIZE * CHUNK_SIZE);
+            const auto y0 = static_cast<int16_t>(y / CHUNK_SIZE * CHUNK_SIZE);
+            const int chunk_width = std::min<int>(CHUNK_SIZE, width_ - x0);
+            const int chunk_height = std::min<int>(CHUNK_SIZE, height_ - y0);
+            for (int row = 0; row < chunk_height; row++) {
+                std::copy_n(tiles_ + Index(x0, static_cast<int16_t>(y0 + row)), chunk_width,
+                            chunk.get() + static_cast<size_t>(row) * CHUNK_SIZE);
+            }
+            overlay_count_++;
+        }
+        return chunk.get();
+    }
+
+    /// Copy the tiles out of the mapping before the first edit - the file
+    /// is shared and read-only
+    void DetachFromFile() {
+        owned_tiles_.assign(tiles_, tiles_ + static_cast<size_t>(width_) * height_);
+        tiles_ = owned_tiles_.data();
+        file_.reset();
+    }
     /// ========================================================================
     /// DATA
     /// ========================================================================
@@ -255,6 +570,17 @@ private:
     uint32_t map_id_;
     std::string map_name_;
 
-    std::vector<uint8_t> tiles_;    // Tile type at each position
-    std::vector<bool> blocking_;    // 1D vector is faster than 2D
+    std::string source_path_;       // .dwm file, empty for in-memory maps
+
+    const uint8_t *tiles_ = nullptr;        // Tile type at each position; null while released
+    std::vector<uint8_t> owned_tiles_;      // What tiles_ points to unless mapped
+    std::shared_ptr<const MapFile> file_;   // Mapping tiles_ points into, if any
+    std::shared_ptr<const TileMap> base_;   // Instance: the map tiles_ and collision_ share
+    std::vector<std::unique_ptr<uint8_t[]>> overlays_;  // Instance: per chunk, copied on edit
+    size_t overlay_count_ = 0;              // Non-null overlays_
+    bool modified_ = false;                 // Edited since created / loaded
+    bool stale_blocking_ = false;           // Last Load() rebuilt the static layer
+    CollisionGrid collision_;       // Static + dynamic blocking bits
+    std::vector<uint32_t> chunk_versions_;  // Per CHUNK_SIZE chunk, row-major
+    uint64_t revision_ = 0;
 };
\ No newline at end of file
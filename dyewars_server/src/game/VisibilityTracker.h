@@ -4,54 +4,61 @@
 /// Tracks which players each player "knows about" (has been told about).
 /// Used for efficient enter/leave view events.
 ///
-/// Game thread only. Uses bidirectional maps for O(K) disconnect cleanup.
+/// Game thread only. Uses bidirectional sets for O(K) disconnect cleanup.
+/// Keyed by PlayerHandle: each player's sets live in a vector indexed by
+/// handle slot, so finding them is array indexing, not a hash probe.
 ///
 /// Created by Anonymous on Dec 10, 2025
 /// =======================================
 #pragma once
 
-#include <unordered_map>
+#include <algorithm>
 #include <unordered_set>
 #include <vector>
 #include <cstdint>
 #include <memory>
 #include <functional>
+#include "core/SlotMap.h"
 #include "core/ThreadSafety.h"
-
-class Player;
+#include "Player.h"
 
 /// Tracks bidirectional visibility relationships between players.
-/// Uses two maps: known_players_ (who I see) and known_by_ (who sees me).
-/// The reverse map enables O(K) disconnect cleanup instead of O(N).
+/// Each player has two sets: known (who I see) and known_by (who sees me).
+/// The reverse set enables O(K) disconnect cleanup instead of O(N).
 class VisibilityTracker {
 public:
     struct Diff {
         std::vector<std::shared_ptr<Player>> entered;
-        std::vector<uint64_t> left;
+        std::vector<PlayerHandle> left;
     };
 
     /// Compare currently visible players against what player already knows.
     /// Returns who entered/left view and updates internal state.
     /// Uses scratch buffers to avoid per-call allocations.
-    Diff Update(uint64_t player_id, const std::vector<std::shared_ptr<Player>>& visible_now) {
+    Diff Update(PlayerHandle player, const std::vector<std::shared_ptr<Player>>& visible_now) {
         AssertGameThread();
         Diff diff;
-        auto& known = known_players_[player_id];
+
+        // Grow once up front - references below must survive the loop
+        PlayerHandle highest = player;
+        for (const auto& p : visible_now) highest = std::max(highest, p->GetHandle(), ByIndex);
+        Reserve(highest);
+        auto& known = Claim(player, true).known;
 
         // Reuse scratch buffer - clear keeps capacity
-        scratch_visible_ids_.clear();
+        scratch_visible_.clear();
 
-        // Build set of currently visible IDs and find newly entered players
+        // Build set of currently visible handles and find newly entered players
         for (const auto& p : visible_now) {
-            uint64_t pid = p->GetID();
-            if (pid == player_id) continue;
+            const PlayerHandle other = p->GetHandle();
+            if (other == player) continue;
 
-            scratch_visible_ids_.insert(pid);
+            scratch_visible_.insert(other);
 
-            if (!known.contains(pid)) {
+            if (!known.contains(other)) {
                 diff.entered.push_back(p);
-                known.insert(pid);
-                known_by_[pid].insert(player_id);
+                known.insert(other);
+                Claim(other, false).known_by.insert(player);
             }
         }
 
@@ -59,21 +66,17 @@ public:
         scratch_to_remove_.clear();
 
         // Find players who left view
-        for (uint64_t known_id : known) {
-            if (!scratch_visible_ids_.contains(known_id)) {
-                diff.left.push_back(known_id);
-                scratch_to_remove_.push_back(known_id);
+        for (PlayerHandle known_handle : known) {
+            if (!scratch_visible_.contains(known_handle)) {
+                diff.left.push_back(known_handle);
+                scratch_to_remove_.push_back(known_handle);
             }
         }
 
         // Remove players who left
-        for (uint64_t id : scratch_to_remove_) {
-            known.erase(id);
-            auto it = known_by_.find(id);
-            if (it != known_by_.end()) {
-                it->second.erase(player_id);
-                if (it->second.empty()) known_by_.erase(it);
-            }
+        for (PlayerHandle other : scratch_to_remove_) {
+            known.erase(other);
+            if (Links* links = Find(other)) links->known_by.erase(player);
         }
 
         return diff;
@@ -81,131 +84,170 @@ public:
 
     /// Initialize visibility on player login.
     /// Call AFTER sending initial BatchPlayerSpatial.
-    void Initialize(uint64_t player_id, const std::vector<uint64_t>& initial_visible) {
+    void Initialize(PlayerHandle player, const std::vector<PlayerHandle>& initial_visible) {
         AssertGameThread();
-        auto& known = known_players_[player_id];
+        PlayerHandle highest = player;
+        for (PlayerHandle other : initial_visible) highest = std::max(highest, other, ByIndex);
+        Reserve(highest);
+
+        auto& known = Claim(player, true).known;
         known.clear();
 
-        for (uint64_t id : initial_visible) {
-            if (id != player_id) {
-                known.insert(id);
-                known_by_[id].insert(player_id);
+        for (PlayerHandle other : initial_visible) {
+            if (other != player) {
+                known.insert(other);
+                Claim(other, false).known_by.insert(player);
             }
         }
     }
 
     /// Add a single player to someone's known set.
-    void AddKnown(uint64_t player_id, uint64_t known_id) {
+    /// Returns true if they didn't know about `known` before.
+    bool AddKnown(PlayerHandle player, PlayerHandle known) {
         AssertGameThread();
-        if (player_id != known_id) {
-            known_players_[player_id].insert(known_id);
-            known_by_[known_id].insert(player_id);
-        }
+        if (player == known) return false;
+        Reserve(std::max(player, known, ByIndex));
+        Claim(known, false).known_by.insert(player);
+        return Claim(player, true).known.insert(known).second;
     }
 
     /// Position getter function type
-    using GetPosFunc = std::function<std::pair<int16_t, int16_t>(uint64_t)>;
+    using GetPosFunc = std::function<std::pair<int16_t, int16_t>(PlayerHandle)>;
 
     /// Check observers who lost sight of mover after movement.
-    /// Returns IDs of players who need S_Left_Game packet.
-    std::vector<uint64_t> NotifyObserversOfDeparture(
-            uint64_t mover_id,
+    /// Returns handles of players who need S_Left_Game packet.
+    std::vector<PlayerHandle> NotifyObserversOfDeparture(
+            PlayerHandle mover,
             int16_t mover_x,
             int16_t mover_y,
             int16_t view_range,
             const GetPosFunc& get_player_pos) {
         AssertGameThread();
-        std::vector<uint64_t> observers_who_lost_sight;
-
-        auto known_by_it = known_by_.find(mover_id);
-        if (known_by_it == known_by_.end()) return observers_who_lost_sight;
+        std::vector<PlayerHandle> observers_who_lost_sight;
 
-        std::vector<uint64_t> to_remove;
+        Links* mover_links = Find(mover);
+        if (!mover_links) return observers_who_lost_sight;
 
-        for (uint64_t observer_id : known_by_it->second) {
-            auto [obs_x, obs_y] = get_player_pos(observer_id);
+        for (PlayerHandle observer : mover_links->known_by) {
+            auto [obs_x, obs_y] = get_player_pos(observer);
 
             int16_t dx = (mover_x > obs_x) ? (mover_x - obs_x) : (obs_x - mover_x);
             int16_t dy = (mover_y > obs_y) ? (mover_y - obs_y) : (obs_y - mover_y);
 
             if (dx > view_range || dy > view_range) {
-                observers_who_lost_sight.push_back(observer_id);
-                to_remove.push_back(observer_id);
-            }
-        }
-
-        for (uint64_t observer_id : to_remove) {
-            auto obs_known_it = known_players_.find(observer_id);
-            if (obs_known_it != known_players_.end()) {
-                obs_known_it->second.erase(mover_id);
+                observers_who_lost_sight.push_back(observer);
             }
-            known_by_it->second.erase(observer_id);
         }
 
-        if (known_by_it->second.empty()) {
-            known_by_.erase(known_by_it);
+        for (PlayerHandle observer : observers_who_lost_sight) {
+            if (Links* links = Find(observer)) links->known.erase(mover);
+            mover_links->known_by.erase(observer);
         }
 
         return observers_who_lost_sight;
     }
 
     /// Remove player on disconnect. O(K) where K = players who knew about them.
-    void RemovePlayer(uint64_t player_id) {
+    void RemovePlayer(PlayerHandle player) {
         AssertGameThread();
+        Links* links = Find(player);
+        if (!links) return;
 
         // Remove from everyone who knew about this player
-        auto known_by_it = known_by_.find(player_id);
-        if (known_by_it != known_by_.end()) {
-            for (uint64_t other_id : known_by_it->second) {
-                auto other_known_it = known_players_.find(other_id);
-                if (other_known_it != known_players_.end()) {
-                    other_known_it->second.erase(player_id);
-                }
-            }
-            known_by_.erase(known_by_it);
+        for (PlayerHandle other : links->known_by) {
+            if (Links* other_links = Find(other)) other_links->known.erase(player);
         }
 
         // Clean up this player's known set
-        auto known_it = known_players_.find(player_id);
-        if (known_it != known_players_.end()) {
-            for (uint64_t known_id : known_it->second) {
-                auto it = known_by_.find(known_id);
-                if (it != known_by_.end()) {
-                    it->second.erase(player_id);
-                    if (it->second.empty()) known_by_.erase(it);
-                }
-            }
-            known_players_.erase(known_it);
-        }
+        ForgetKnown(player);
+        *links = Links{};
     }
 
-    const std::unordered_set<uint64_t>* GetKnownPlayers(uint64_t player_id) const {
+    /// Stop tracking what player sees, but keep who sees it. For a
+    /// player that stays in the world without a client (became a ghost).
+    void ForgetKnown(PlayerHandle player) {
         AssertGameThread();
-        auto it = known_players_.find(player_id);
-        return (it != known_players_.end()) ? &it->second : nullptr;
+        Links* links = Find(player);
+        if (!links || !links->tracking) return;
+        for (PlayerHandle other : links->known) {
+            if (Links* other_links = Find(other)) other_links->known_by.erase(player);
+        }
+        links->known.clear();
+        links->tracking = false;
+        tracked_count_--;
     }
 
-    const std::unordered_set<uint64_t>* GetKnownBy(uint64_t player_id) const {
-        AssertGameThread();
-        auto it = known_by_.find(player_id);
-        return (it != known_by_.end()) ? &it->second : nullptr;
+    const std::unordered_set<PlayerHandle>* GetKnownPlayers(PlayerHandle player) const {
+        AssertGameThreadRead();
+        const Links* links = Find(player);
+        return (links && links->tracking) ? &links->known : nullptr;
+    }
+
+    const std::unordered_set<PlayerHandle>* GetKnownBy(PlayerHandle player) const {
+        AssertGameThreadRead();
+        const Links* links = Find(player);
+        return links ? &links->known_by : nullptr;
     }
 
-    size_t TrackedPlayerCount() const { AssertGameThread(); return known_players_.size(); }
-    void Clear() { AssertGameThread(); known_players_.clear(); known_by_.clear(); }
+    size_t TrackedPlayerCount() const { AssertGameThreadRead(); return tracked_count_; }
+    void Clear() { AssertGameThread(); links_.clear(); tracked_count_ = 0; }
 
 private:
+    /// One player's relationships, at links_[SlotHandle::Index(owner)]
+    struct Links {
+        PlayerHandle owner = SlotHandle::NONE;  // Stale handles don't match
+        bool tracking = false;                  // Has a known set (TrackedPlayerCount)
+        std::unordered_set<PlayerHandle> known;
+        std::unordered_set<PlayerHandle> known_by;
+    };
+
+    static bool ByIndex(PlayerHandle a, PlayerHandle b) { return SlotHandle::Index(a) < SlotHandle::Index(b); }
+
+    void Reserve(PlayerHandle highest) {
+        const size_t needed = SlotHandle::Index(highest) + 1;
+        if (needed > links_.size()) links_.resize(std::max(needed, links_.size() * 2));
+    }
+
+    /// Entry for handle, taking the slot over from a previous owner if it
+    /// was reused. Reserve() first.
+    Links& Claim(PlayerHandle handle, bool tracking) {
+        Links& links = links_[SlotHandle::Index(handle)];
+        if (links.owner != handle) {
+            if (links.tracking) tracked_count_--;
+            links = Links{};
+            links.owner = handle;
+        }
+        if (tracking && !links.tracking) {
+            links.tracking = true;
+            tracked_count_++;
+        }
+        return links;
+    }
+
+    Links* Find(PlayerHandle handle) {
+        const uint32_t index = SlotHandle::Index(handle);
+        if (handle == SlotHandle::NONE || index >= links_.size() || links_[index].owner != handle) return nullptr;
+        return &links_[index];
+    }
+
+    const Links* Find(PlayerHandle handle) const { return const_cast<VisibilityTracker*>(this)->Find(handle); }
+
     void AssertGameThread() const {
         ASSERT_GAME_THREAD(thread_owner_);
         if (!thread_owner_.IsOwnerSet()) thread_owner_.SetOwner();
     }
 
-    std::unordered_map<uint64_t, std::unordered_set<uint64_t>> known_players_;
-    std::unordered_map<uint64_t, std::unordered_set<uint64_t>> known_by_;
+    void AssertGameThreadRead() const {
+        ASSERT_GAME_THREAD_READ(thread_owner_);
+        if (!thread_owner_.IsOwnerSet()) thread_owner_.SetOwner();
+    }
+
+    std::vector<Links> links_;
+    size_t tracked_count_ = 0;
     mutable ThreadOwner thread_owner_;
 
     /// Scratch buffers - reused across Update() calls to avoid allocations.
     /// clear() preserves capacity, so after a few calls these stabilize.
-    std::unordered_set<uint64_t> scratch_visible_ids_;
-    std::vector<uint64_t> scratch_to_remove_;
+    std::unordered_set<PlayerHandle> scratch_visible_;
+    std::vector<PlayerHandle> scratch_to_remove_;
 };
@@ -0,0 +1,72 @@
+/// =======================================
+/// DyeWarsServer - WarpPoints
+///
+/// The server's list of warp tiles: a tile on one map that takes whoever
+/// stands on it to a fixed spot on a map. A client's C_Warp_Request is
+/// only honoured if its player is standing on a warp tile and asks for
+/// that tile's destination (see Actions::Movement::ApplyWarp). The client
+/// never chooses where it goes.
+///
+/// Warp tiles come from Lua (add_warp / remove_warp) and the console
+/// (warp). --open-warps lets any client warp anywhere, for test tools
+/// such as DyeWarsShardCheck.
+///
+/// THREAD SAFETY:
+/// Lua and the console add and remove tiles from their own threads, and
+/// zone threads look them up once per warp request. A shared_mutex around
+/// an unordered_map, like ZoneManager's route table: lookups never block
+/// each other, and edits are rare.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+class WarpPoints {
+public:
+    struct Destination {
+        uint16_t map_id;
+        int16_t x;
+        int16_t y;
+
+        bool operator==(const Destination &) const = default;
+    };
+
+    /// Make (x, y) on `map_id` a warp tile, replacing any destination it had
+    void Add(uint16_t map_id, int16_t x, int16_t y, Destination to) {
+        std::unique_lock lock(mutex_);
+        points_[Key(map_id, x, y)] = to;
+    }
+
+    /// False if (x, y) wasn't a warp tile
+    bool Remove(uint16_t map_id, int16_t x, int16_t y) {
+        std::unique_lock lock(mutex_);
+        return points_.erase(Key(map_id, x, y)) > 0;
+    }
+
+    /// Where the warp tile at (x, y) leads, nullopt if it isn't one
+    std::optional<Destination> At(uint16_t map_id, int16_t x, int16_t y) const {
+        std::shared_lock lock(mutex_);
+        const auto it = points_.find(Key(map_id, x, y));
+        if (it == points_.end()) return std::nullopt;
+        return it->second;
+    }
+
+    size_t Count() const {
+        std::shared_lock lock(mutex_);
+        return points_.size();
+    }
+
+private:
+    static uint64_t Key(uint16_t map_id, int16_t x, int16_t y) {
+        return uint64_t{map_id} << 32 | uint64_t{static_cast<uint16_t>(x)} << 16 | static_cast<uint16_t>(y);
+    }
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<uint64_t, Destination> points_;  // Key(map, x, y) -> destination
+};
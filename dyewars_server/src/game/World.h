@@ -6,7 +6,8 @@
 /// - SpatialHash: dynamic entity positions (players, NPCs)
 /// - VisibilityTracker: who can see whom
 ///
-/// Single point of access for all spatial queries.
+/// Single point of access for all spatial queries. Players are keyed by
+/// their PlayerRegistry handle, not the 64-bit wire ID.
 ///
 /// THREAD SAFETY:
 /// --------------
@@ -14,26 +15,26 @@
 /// Child components (SpatialHash, VisibilityTracker) have their own
 /// thread safety assertions that will catch violations.
 ///
-/// TileMap is READ-ONLY after construction, so it's inherently thread-safe.
-/// If you ever add tile modification (e.g., destructible terrain), you'll
-/// need to add synchronization.
+/// TileMap is game-thread only too. Tiles change only through the zone's
+/// TileChangeJournal; other threads (Lua, the console) queue edits with
+/// Zone::QueueTileEdit rather than touching the map.
 ///
 /// Created by Anonymous on Dec 07, 2025
 /// =======================================
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <cstdint>
 #include <cmath>
 #include <functional>
 #include "TileMap.h"
+#include "Player.h"
 #include "SpatialHash.h"
 #include "VisibilityTracker.h"
 #include "core/ThreadSafety.h"
 
-class Player;  // Forward declare
-
 /// ============================================================================
 /// WORLD
 ///
@@ -103,43 +104,85 @@ public:
     /// PLAYER MANAGEMENT - Dynamic Entity Tracking
     /// ========================================================================
 
-    /// Add a player to the world
+    /// Add a player to the world under its registry handle
     /// Call when player spawns or enters this world/zone
-    void AddPlayer(uint64_t player_id,
+    void AddPlayer(PlayerHandle handle,
                    int16_t x,  // TODO: Could be uint16_t
                    int16_t y,  // TODO: Could be uint16_t
-                   std::shared_ptr<Player> player = nullptr) {
-        spatial_hash_.Add(player_id, x, y, player);
+                   std::shared_ptr<Player> player) {
+        spatial_hash_.Add(handle, x, y, std::move(player));
     }
 
     /// Remove a player from the world
     /// Call when player despawns, disconnects, or changes zones
-    void RemovePlayer(uint64_t player_id) {
-        spatial_hash_.Remove(player_id);
+    void RemovePlayer(PlayerHandle handle) {
+        spatial_hash_.Remove(handle);
+    }
+
+    /// Remove every player and their visibility links (InstancePool,
+    /// recycling an instance). The spatial grid keeps its allocation.
+    void ClearPlayers() {
+        spatial_hash_.Clear();
+        visibility_.Clear();
     }
 
     /// Update a player's position
     /// Call when player moves. Returns true if player changed spatial cells.
-    bool UpdatePlayerPosition(uint64_t player_id,
+    bool UpdatePlayerPosition(PlayerHandle handle,
                               int16_t new_x,   // TODO: Could be uint16_t
                               int16_t new_y) { // TODO: Could be uint16_t
-        return spatial_hash_.Update(player_id, new_x, new_y);
+        return spatial_hash_.Update(handle, new_x, new_y);
     }
 
-    /// Get a player by ID
-    std::shared_ptr<Player> GetPlayer(uint64_t player_id) const {
-        return spatial_hash_.GetEntity(player_id);
+    /// Get a player by handle
+    std::shared_ptr<Player> GetPlayer(PlayerHandle handle) const {
+        return spatial_hash_.GetEntity(handle);
     }
 
     /// Check if player exists in this world
-    bool HasPlayer(uint64_t player_id) const {
-        return spatial_hash_.Contains(player_id);
+    bool HasPlayer(PlayerHandle handle) const {
+        return spatial_hash_.Contains(handle);
     }
 
     /// Check if a position is occupied by another player
     /// Used for collision detection during movement
-    bool IsPositionOccupied(int16_t x, int16_t y, uint64_t exclude_player_id = 0) const {
-        return spatial_hash_.IsPlayerAt(x, y, exclude_player_id);
+    bool IsPositionOccupied(int16_t x, int16_t y, PlayerHandle exclude = SlotHandle::NONE) const {
+        return spatial_hash_.IsPlayerAt(x, y, exclude);
+    }
+
+    /// Move (x, y) to the nearest walkable, unoccupied tile, searching
+    /// square rings outward up to `max_radius`. Used to place warping
+    /// players. Returns false (x, y unchanged) if every tile is taken.
+    bool FindOpenTile(int16_t &x, int16_t &y, PlayerHandle exclude = SlotHandle::NONE,
+                      int16_t max_radius = VIEW_RANGE) const {
+        const CollisionGrid &collision = tilemap_->Collision();
+        auto take = [&](int16_t cx, int16_t cy) {
+            if (IsPositionOccupied(cx, cy, exclude)) return false;
+            x = cx;
+            y = cy;
+            return true;
+        };
+
+        for (int16_t r = 0; r <= max_radius; r++) {
+            const auto left = static_cast<int16_t>(x - r);
+            const auto right = static_cast<int16_t>(x + r);
+            for (int16_t dy = -r; dy <= r; dy++) {
+                const auto cy = static_cast<int16_t>(y + dy);
+                if (dy == -r || dy == r) {
+                    // Top and bottom of the ring: walk its free tiles a
+                    // word at a time (blocked and out of bounds skipped)
+                    for (int16_t cx = collision.FirstFreeInRow(cy, left, right); cx != CollisionGrid::NONE;
+                         cx = collision.FirstFreeInRow(cy, static_cast<int16_t>(cx + 1), right)) {
+                        if (take(cx, cy)) return true;
+                    }
+                } else {
+                    // Ring only - the inside was searched at smaller radii
+                    if (!collision.IsBlocked(left, cy) && take(left, cy)) return true;
+                    if (!collision.IsBlocked(right, cy) && take(right, cy)) return true;
+                }
+            }
+        }
+        return false;
     }
 
     /// Get total player count in this world
@@ -165,18 +208,12 @@ public:
                                                            int16_t y,      // TODO: Could be uint16_t
                                                            int16_t range)  // TODO: Could be uint16_t
     const {
-        // Coarse filter: get candidates from spatial hash
-        auto candidates = spatial_hash_.GetNearbyEntities(x, y, range);
-
-        // Fine filter: exact distance check (rectangular)
+        // Exact distance check (rectangular) runs on the spatial hash's
+        // cached positions
         std::vector<std::shared_ptr<Player>> result;
-        result.reserve(candidates.size());
-
-        for (const auto &player: candidates) {
-            if (IsInRange(x, y, player->GetX(), player->GetY(), range)) {
-                result.push_back(player);
-            }
-        }
+        spatial_hash_.ForEachInRange(x, y, range, [&](const std::shared_ptr<Player> &player) {
+            result.push_back(player);
+        });
         return result;
     }
 
@@ -191,35 +228,31 @@ public:
     /// Zero-copy iteration with custom range.
     template<typename Func>
     void ForEachPlayerInRange(int16_t x, int16_t y, int16_t range, Func&& func) const {
-        spatial_hash_.ForEachNearby(x, y, range, [&](const std::shared_ptr<Player>& player) {
-            if (IsInRange(x, y, player->GetX(), player->GetY(), range)) {
-                func(player);
-            }
-        });
+        spatial_hash_.ForEachInRange(x, y, range, std::forward<Func>(func));
     }
 
-    /// Get all player IDs within VIEW_RANGE (when you just need IDs)
-    std::vector<uint64_t> GetPlayerIDsInRange(int16_t x, int16_t y) const {
-        return GetPlayerIDsInRange(x, y, VIEW_RANGE);
+    /// Zero-copy iteration over handles in VIEW_RANGE. Pair with
+    /// PlayerRegistry::Table() to read positions, client IDs and flags
+    /// without touching the Player objects.
+    template<typename Func>
+    void ForEachHandleInRange(int16_t x, int16_t y, Func&& func) const {
+        spatial_hash_.ForEachHandleInRange(x, y, VIEW_RANGE, std::forward<Func>(func));
     }
 
-    /// Get all player IDs within a custom range
-    std::vector<uint64_t> GetPlayerIDsInRange(int16_t x,      // TODO: Could be uint16_t
-                                              int16_t y,      // TODO: Could be uint16_t
-                                              int16_t range)  // TODO: Could be uint16_t
-    const {
-        auto candidates = spatial_hash_.GetNearbyIDs(x, y, range);
-
-        // Fine filter with distance check
-        std::vector<uint64_t> result;
-        result.reserve(candidates.size());
+    /// Get all player handles within VIEW_RANGE (when you just need handles)
+    std::vector<PlayerHandle> GetHandlesInRange(int16_t x, int16_t y) const {
+        return GetHandlesInRange(x, y, VIEW_RANGE);
+    }
 
-        for (uint64_t id: candidates) {
-            auto player = spatial_hash_.GetEntity(id);
-            if (player && IsInRange(x, y, player->GetX(), player->GetY(), range)) {
-                result.push_back(id);
-            }
-        }
+    /// Get all player handles within a custom range
+    std::vector<PlayerHandle> GetHandlesInRange(int16_t x,      // TODO: Could be uint16_t
+                                                int16_t y,      // TODO: Could be uint16_t
+                                                int16_t range)  // TODO: Could be uint16_t
+    const {
+        std::vector<PlayerHandle> result;
+        spatial_hash_.ForEachHandleInRange(x, y, range, [&](PlayerHandle handle) {
+            result.push_back(handle);
+        });
         return result;
     }
 
@@ -250,16 +283,16 @@ public:
     }
 
     /// Check if a player can see a position
-    bool CanPlayerSee(uint64_t player_id, int16_t x, int16_t y) const {
-        auto player = GetPlayer(player_id);
+    bool CanPlayerSee(PlayerHandle handle, int16_t x, int16_t y) const {
+        auto player = GetPlayer(handle);
         if (!player) return false;
         return IsInView(player->GetX(), player->GetY(), x, y);
     }
 
     /// Check if player A can see player B
-    bool CanSee(uint64_t viewer_id, uint64_t target_id) const {
-        auto viewer = GetPlayer(viewer_id);
-        auto target = GetPlayer(target_id);
+    bool CanSee(PlayerHandle viewer_handle, PlayerHandle target_handle) const {
+        auto viewer = GetPlayer(viewer_handle);
+        auto target = GetPlayer(target_handle);
         if (!viewer || !target) return false;
         return IsInView(viewer->GetX(), viewer->GetY(), target->GetX(), target->GetY());
     }
@@ -269,7 +302,7 @@ public:
     /// ========================================================================
 
     /// Iterate over all players in this world
-    void ForEachPlayer(const std::function<void(uint64_t, const std::shared_ptr<Player> &)> &func) const {
+    void ForEachPlayer(const std::function<void(PlayerHandle, const std::shared_ptr<Player> &)> &func) const {
         spatial_hash_.ForEach(func);
     }
 
@@ -277,7 +310,7 @@ public:
     std::vector<std::shared_ptr<Player>> GetAllPlayers() const {
         std::vector<std::shared_ptr<Player>> result;
         result.reserve(PlayerCount());
-        ForEachPlayer([&result](uint64_t, const std::shared_ptr<Player> &p) {
+        ForEachPlayer([&result](PlayerHandle, const std::shared_ptr<Player> &p) {
             result.push_back(p);
         });
         return result;
@@ -11,16 +11,33 @@
 
 class GameServer;
 
+class Zone;
+
 class Player;
 
 namespace Actions {
 
     namespace Movement {
+        /// Queue a MoveCmd / TurnCmd / WarpCmd (IO thread)
         void Move(GameServer *server, uint64_t client_id, uint8_t direction, uint8_t facing);
 
         void Turn(GameServer *server, uint64_t client_id, uint8_t facing);
 
         void Warp(GameServer *server, uint64_t client_id, uint16_t map_id, int16_t x, int16_t y);
+
+        /// Execute a queued command (zone thread, from Zone::ProcessInputQueues)
+        void ApplyMove(Zone *zone, uint64_t client_id, uint8_t direction, uint8_t facing);
+
+        void ApplyTurn(Zone *zone, uint64_t client_id, uint8_t facing);
+
+        /// Same map: teleport to the nearest open tile. Other map: hand the
+        /// player to that map's zone (Zone::TransferOut).
+        void ApplyWarp(Zone *zone, uint64_t client_id, uint16_t map_id, int16_t x, int16_t y);
+
+        /// After `player` changed position: queue what entered/left its own
+        /// view (if it has a client) and S_Left_Game for observers that lost
+        /// sight of it. Also used for ghosts moved by their owning shard.
+        void UpdateVisibilityAfterMove(Zone *zone, const std::shared_ptr<Player> &player, bool has_client);
     }
 
     namespace Combat {
@@ -2,16 +2,18 @@
 /// DyeWarsServer - Bot Stress Test
 /// =======================================
 #include "BotStressTest.h"
-#include "server/GameServer.h"
+#include "server/Zone.h"
+#include "server/ClientManager.h"
 #include "server/FakeClientConnection.h"
+#include "debug/ServerStats.h"
 #include "network/packets/outgoing/PacketSender.h"
 #include "core/Log.h"
 
 namespace Actions::BotStressTest {
 
-    void SpawnBots(GameServer* server, BotManager& manager, size_t count, bool clustered) {
-        auto& world = server->GetWorld();
-        auto& players = server->Players();
+    void SpawnBots(Zone* zone, BotManager& manager, size_t count, bool clustered) {
+        auto& world = zone->GetWorld();
+        auto& players = zone->Players();
 
         const int map_width = world.GetMap().GetWidth();
         const int map_height = world.GetMap().GetHeight();
@@ -23,9 +25,9 @@ namespace Actions::BotStressTest {
             int center_x = map_width / 2;
             int center_y = map_height / 2;
 
-            // Find first real player (client_id < 0x8000000000000000)
+            // Find first real player
             players.ForEachPlayer([&](const std::shared_ptr<Player>& p) {
-                if (p->GetClientID() < 0x8000000000000000ULL) {
+                if (!IsBotClient(p->GetClientID())) {
                     center_x = p->GetX();
                     center_y = p->GetY();
                 }
@@ -67,117 +69,115 @@ namespace Actions::BotStressTest {
 
             // Create bot player
             // Use a unique fake client_id (high bit set to avoid collision with real clients)
-            uint64_t fake_client_id = 0x8000000000000000ULL + manager.bot_ids.size();
+            uint64_t fake_client_id = manager.client_id_base + manager.bot_handles.size();
             uint8_t facing = static_cast<uint8_t>(facing_dist(manager.rng));
             auto bot = players.CreatePlayer(fake_client_id, x, y, facing);
             if (!bot) continue;
 
             // Create fake connection for this bot to simulate packet building overhead
             auto fake_conn = std::make_shared<FakeClientConnection>(fake_client_id);
-            server->Clients().AddFakeClient(fake_conn);
+            zone->Clients().AddFakeClient(fake_conn);
 
             // Add to world
-            world.AddPlayer(bot->GetID(), x, y, bot);
+            const PlayerHandle handle = bot->GetHandle();
+            world.AddPlayer(handle, x, y, bot);
 
             // Initialize visibility
             auto nearby = world.GetPlayersInRange(x, y);
-            std::vector<uint64_t> nearby_ids;
+            std::vector<PlayerHandle> nearby_handles;
             for (const auto& p : nearby) {
-                if (p->GetID() != bot->GetID()) {
-                    nearby_ids.push_back(p->GetID());
+                if (p->GetHandle() != handle) {
+                    nearby_handles.push_back(p->GetHandle());
                 }
             }
-            world.Visibility().Initialize(bot->GetID(), nearby_ids);
+            world.Visibility().Initialize(handle, nearby_handles);
 
             // Notify nearby real players about the new bot
             for (const auto& viewer : nearby) {
-                if (viewer->GetID() == bot->GetID()) continue;
-                auto conn = server->Clients().GetClient(viewer->GetClientID());
+                if (viewer->GetHandle() == handle) continue;
+                auto conn = zone->Clients().GetClient(viewer->GetClientID());
                 if (conn) {
                     Packets::PacketSender::PlayerSpatial(conn, bot->GetID(), x, y, facing);
-                    world.Visibility().AddKnown(viewer->GetID(), bot->GetID());
+                    world.Visibility().AddKnown(viewer->GetHandle(), handle);
                 }
             }
 
             // Track as bot
-            manager.bot_ids.push_back(bot->GetID());
+            manager.bot_handles.push_back(handle);
             spawned++;
         }
 
         size_t remaining = count - spawned;
         if (remaining > 0) {
             Log::Info("Spawning bots ({})... {} so far, {} remaining",
-                      clustered ? "clustered" : "spread", manager.bot_ids.size(), remaining);
+                      clustered ? "clustered" : "spread", manager.bot_handles.size(), remaining);
             // Queue another batch
-            server->QueueAction([server, &manager, remaining, clustered] {
-                SpawnBots(server, manager, remaining, clustered);
+            zone->QueueAction([zone, &manager, remaining, clustered] {
+                SpawnBots(zone, manager, remaining, clustered);
             });
         } else {
-            Log::Info("Spawned all bots ({} total, {})", manager.bot_ids.size(),
+            Log::Info("Spawned all bots ({} total, {})", manager.bot_handles.size(),
                       clustered ? "clustered" : "spread");
         }
     }
 
-    void RemoveBots(GameServer* server, BotManager& manager) {
-        auto& world = server->GetWorld();
-        auto& players = server->Players();
+    void RemoveBots(Zone* zone, BotManager& manager) {
+        auto& world = zone->GetWorld();
+        auto& players = zone->Players();
 
         // Remove in batches to avoid tick lag
         // Remove ~100 per tick max
         constexpr size_t BATCH_SIZE = 100;
-        size_t to_remove = std::min(BATCH_SIZE, manager.bot_ids.size());
+        size_t to_remove = std::min(BATCH_SIZE, manager.bot_handles.size());
 
         for (size_t i = 0; i < to_remove; i++) {
-            uint64_t bot_id = manager.bot_ids.back();
-            manager.bot_ids.pop_back();
+            const PlayerHandle bot_handle = manager.bot_handles.back();
+            manager.bot_handles.pop_back();
 
-            auto bot = players.GetByID(bot_id);
+            auto bot = players.Get(bot_handle);
             if (bot) {
                 // Notify everyone who KNOWS about this bot (not just nearby)
                 // This fixes ghost players when bots moved out of view before removal
-                const auto* known_by = world.Visibility().GetKnownBy(bot_id);
+                const auto* known_by = world.Visibility().GetKnownBy(bot_handle);
                 if (known_by) {
-                    for (uint64_t observer_id : *known_by) {
-                        auto observer = players.GetByID(observer_id);
+                    for (PlayerHandle observer_handle : *known_by) {
+                        auto observer = players.Get(observer_handle);
                         if (!observer) continue;
-                        auto conn = server->Clients().GetClient(observer->GetClientID());
-                        if (conn) {
-                            Packets::PacketSender::PlayerLeft(conn, bot_id);
-                        }
+                        zone->Delta().AddLeft(observer->GetClientID(), bot->GetID());
                     }
                 }
 
-                world.RemovePlayer(bot_id);
-                world.Visibility().RemovePlayer(bot_id);
-                players.RemovePlayer(bot_id);
+                world.RemovePlayer(bot_handle);
+                world.Visibility().RemovePlayer(bot_handle);
+                players.RemovePlayer(bot_handle);
 
                 // Remove fake connection
-                server->Clients().RemoveClient(bot->GetClientID());
+                zone->Clients().RemoveClient(bot->GetClientID());
             }
         }
 
-        if (manager.bot_ids.empty()) {
+        if (manager.bot_handles.empty()) {
             Log::Info("Removed all bots");
         } else {
-            Log::Info("Removing bots... {} remaining", manager.bot_ids.size());
+            Log::Info("Removing bots... {} remaining", manager.bot_handles.size());
             // Queue another batch removal
-            server->QueueAction([server, &manager] {
-                RemoveBots(server, manager);
+            zone->QueueAction([zone, &manager] {
+                RemoveBots(zone, manager);
             });
         }
     }
 
-    void ProcessBotMovement(GameServer* server, BotManager& manager) {
-        if (manager.bot_ids.empty()) return;
+    void ProcessBotMovement(Zone* zone, BotManager& manager) {
+        if (manager.bot_handles.empty()) return;
 
-        auto& world = server->GetWorld();
-        auto& players = server->Players();
+        auto& world = zone->GetWorld();
+        auto& players = zone->Players();
 
-        std::uniform_int_distribution<size_t> bot_picker(0, manager.bot_ids.size() - 1);
+        std::uniform_int_distribution<size_t> bot_picker(0, manager.bot_handles.size() - 1);
         std::uniform_int_distribution<int> dir_dist(0, 3);
 
         // Move ~30% of bots per tick (realistic player activity simulation)
-        size_t moves_this_tick = std::max(size_t{1}, manager.bot_ids.size() / 3);
+        size_t moves_this_tick = std::max(size_t{1}, manager.bot_handles.size() / 3);
 
         // Timing accumulators
         double spatial_time = 0, visibility_time = 0, departure_time = 0;
@@ -185,9 +185,9 @@ namespace Actions::BotStressTest {
 
         for (size_t i = 0; i < moves_this_tick; i++) {
             size_t bot_index = bot_picker(manager.rng);
-            uint64_t bot_id = manager.bot_ids[bot_index];
+            const PlayerHandle bot_handle = manager.bot_handles[bot_index];
 
-            auto bot = players.GetByID(bot_id);
+            auto bot = players.Get(bot_handle);
             if (!bot) continue;
 
             uint8_t new_facing = static_cast<uint8_t>(dir_dist(manager.rng));
@@ -208,13 +208,13 @@ namespace Actions::BotStressTest {
 
             // Check if move is valid
             if (world.GetMap().IsTileBlocked(new_x, new_y)) continue;
-            if (world.IsPositionOccupied(new_x, new_y, bot_id)) continue;
+            if (world.IsPositionOccupied(new_x, new_y, bot_handle)) continue;
 
             actual_moves++;
 
             // Move the bot
             bot->SetPosition(new_x, new_y);
-            world.UpdatePlayerPosition(bot_id, new_x, new_y);
+            world.UpdatePlayerPosition(bot_handle, new_x, new_y);
             players.MarkDirty(bot);
 
             // Update visibility for the bot
@@ -223,43 +223,38 @@ namespace Actions::BotStressTest {
             auto t1 = std::chrono::steady_clock::now();
             spatial_time += std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 
-            world.Visibility().Update(bot_id, visible);
+            world.Visibility().Update(bot_handle, visible);
             auto t2 = std::chrono::steady_clock::now();
             visibility_time += std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
 
             // Notify observers who lost sight of the bot
-            auto get_player_pos = [&world](uint64_t id) -> std::pair<int16_t, int16_t> {
-                auto p = world.GetPlayer(id);
-                return p ? std::make_pair(p->GetX(), p->GetY())
-                         : std::make_pair<int16_t, int16_t>(0, 0);
+            const PlayerTable &table = players.Table();
+            auto get_player_pos = [&](PlayerHandle observer) -> std::pair<int16_t, int16_t> {
+                return players.Contains(observer) ? std::make_pair(table.X(observer), table.Y(observer))
+                                                  : std::make_pair<int16_t, int16_t>(0, 0);
             };
 
             auto observers_lost = world.Visibility().NotifyObserversOfDeparture(
-                    bot_id, new_x, new_y, World::VIEW_RANGE, get_player_pos);
+                    bot_handle, new_x, new_y, World::VIEW_RANGE, get_player_pos);
             auto t3 = std::chrono::steady_clock::now();
             departure_time += std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count();
 
-            for (uint64_t observer_id : observers_lost) {
-                auto observer = world.GetPlayer(observer_id);
-                if (!observer) continue;
-                auto conn = server->Clients().GetClient(observer->GetClientID());
-                if (conn) {
-                    Packets::PacketSender::PlayerLeft(conn, bot_id);  // Tell observer that BOT left their view
-                }
+            for (PlayerHandle observer_handle : observers_lost) {
+                if (!players.Contains(observer_handle)) continue;
+                zone->Delta().AddLeft(table.ClientID(observer_handle), bot->GetID());  // Tell observer that BOT left their view
             }
         }
 
         // Record stats for debug dashboard
-        server->Stats().RecordBotMovement(
+        zone->Stats().RecordBotMovement(
             spatial_time / 1000.0,
             visibility_time / 1000.0,
             departure_time / 1000.0
         );
 
         // Log detailed timing every 100 ticks (5 sec at 20 TPS)
-        static int log_counter = 0;
-        if (++log_counter >= 100) {
-            log_counter = 0;
+        if (++manager.log_counter >= 100) {
+            manager.log_counter = 0;
             Log::Trace("BotMove breakdown - Moves: {}, Spatial: {:.2f}ms, Visibility: {:.2f}ms, Departure: {:.2f}ms",
                        actual_moves, spatial_time / 1000.0, visibility_time / 1000.0, departure_time / 1000.0);
         }
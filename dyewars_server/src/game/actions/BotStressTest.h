@@ -11,26 +11,34 @@
 #include <vector>
 #include <random>
 #include <cstdint>
+#include "core/SlotMap.h"
 
-class GameServer;
+class Zone;
 
 namespace Actions::BotStressTest {
 
-    /// Bot manager state (lives in GameServer, passed to actions)
+    /// Bots get fake client IDs with the high bit set, real clients count up from 1
+    constexpr uint64_t BOT_CLIENT_ID_BIT = 0x8000000000000000ULL;
+
+    inline bool IsBotClient(uint64_t client_id) { return (client_id & BOT_CLIENT_ID_BIT) != 0; }
+
+    /// Bot manager state (lives in a Zone, passed to actions)
     struct BotManager {
-        std::vector<uint64_t> bot_ids;
+        std::vector<SlotHandle::Type> bot_handles;  // PlayerHandles in the zone's registry
         std::mt19937 rng{std::random_device{}()};
+        uint64_t client_id_base = BOT_CLIENT_ID_BIT;  // Fake client IDs, distinct per zone
+        int log_counter = 0;
     };
 
     /// Spawn count bots at random non-occupied positions
     /// If clustered=true, spawns near first real player (stress test)
     /// If clustered=false, spawns across entire map (realistic)
-    void SpawnBots(GameServer* server, BotManager& manager, size_t count, bool clustered = true);
+    void SpawnBots(Zone* zone, BotManager& manager, size_t count, bool clustered = true);
 
     /// Remove all bots
-    void RemoveBots(GameServer* server, BotManager& manager);
+    void RemoveBots(Zone* zone, BotManager& manager);
 
     /// Move one random bot (call once per tick)
-    void ProcessBotMovement(GameServer* server, BotManager& manager);
+    void ProcessBotMovement(Zone* zone, BotManager& manager);
 
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+/// =======================================
+/// DyeWarsServer - GameCommand
+///
+/// Plain-data commands passed from IO threads to a zone's game thread
+/// through the zone's MpscRing (GameServer::QueueCommand picks the zone).
+/// One command per input packet / session event, dispatched on the zone
+/// thread with a switch (Zone::ExecuteCommand).
+///
+/// WHY NOT std::function:
+/// A lambda capturing GameServer* + client_id + arguments doesn't fit
+/// std::function's small buffer on every standard library, so each move
+/// packet used to cost a heap allocation plus a mutex round-trip. A command
+/// is 16 bytes copied into a preallocated ring cell.
+///
+/// ADDING A COMMAND:
+/// 1. Add a Type and (if it has arguments) a payload struct to the union
+/// 2. Add a factory below
+/// 3. Handle it in Zone::ExecuteCommand
+/// Rare admin actions (bot spawning, etc.) don't need a command - they use
+/// the Zone::QueueAction std::function escape hatch.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+/// C_Move_Request arguments
+struct MoveCmd {
+    uint8_t direction;
+    uint8_t facing;
+};
+
+/// C_Turn_Request arguments
+struct TurnCmd {
+    uint8_t facing;
+};
+
+/// C_Warp_Request arguments. Same map: teleport. Other map: zone handoff.
+struct WarpCmd {
+    uint16_t map_id;
+    int16_t x;
+    int16_t y;
+};
+
+/// Handshake completed. The connection is already in ClientManager.
+struct LoginCmd {};
+
+/// Connection closed. Player and client cleanup happens on the game thread.
+struct DisconnectCmd {};
+
+struct GameCommand {
+    enum class Type : uint8_t {
+        Move,
+        Turn,
+        Warp,
+        Login,
+        Disconnect,
+    };
+
+    uint64_t client_id;
+    Type type;
+
+    union {
+        MoveCmd move;
+        TurnCmd turn;
+        WarpCmd warp;
+        LoginCmd login;
+        DisconnectCmd disconnect;
+    };
+
+    static GameCommand Move(uint64_t client_id, uint8_t direction, uint8_t facing) {
+        GameCommand cmd{client_id, Type::Move};
+        cmd.move = MoveCmd{direction, facing};
+        return cmd;
+    }
+
+    static GameCommand Turn(uint64_t client_id, uint8_t facing) {
+        GameCommand cmd{client_id, Type::Turn};
+        cmd.turn = TurnCmd{facing};
+        return cmd;
+    }
+
+    static GameCommand Warp(uint64_t client_id, uint16_t map_id, int16_t x, int16_t y) {
+        GameCommand cmd{client_id, Type::Warp};
+        cmd.warp = WarpCmd{map_id, x, y};
+        return cmd;
+    }
+
+    static GameCommand Login(uint64_t client_id) {
+        GameCommand cmd{client_id, Type::Login};
+        cmd.login = LoginCmd{};
+        return cmd;
+    }
+
+    static GameCommand Disconnect(uint64_t client_id) {
+        GameCommand cmd{client_id, Type::Disconnect};
+        cmd.disconnect = DisconnectCmd{};
+        return cmd;
+    }
+
+    /// Session commands must never be dropped - a lost Disconnect leaks a
+    /// player. Input commands can be (the client gets corrected anyway).
+    bool IsCritical() const { return type == Type::Login || type == Type::Disconnect; }
+};
+
+static_assert(std::is_trivially_copyable_v<GameCommand>);
+static_assert(sizeof(GameCommand) <= 16);
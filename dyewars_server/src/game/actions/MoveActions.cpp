@@ -1,106 +1,170 @@
 #include "Actions.h"
 #include "server/GameServer.h"
+#include "server/Zone.h"
+#include "server/ZoneManager.h"
 #include "network/packets/outgoing/PacketSender.h"
 #include "core/Log.h"
 
 namespace Actions::Movement {
     void Move(GameServer *server, uint64_t client_id, uint8_t direction, uint8_t facing) {
-        server->QueueAction([=]() {
-            auto player = server->Players().GetByClientID(client_id);
-            if (!player) return;
+        server->QueueCommand(GameCommand::Move(client_id, direction, facing));
+    }
+
+    void Turn(GameServer *server, uint64_t client_id, uint8_t facing) {
+        server->QueueCommand(GameCommand::Turn(client_id, facing));
+    }
+
+    void Warp(GameServer *server, uint64_t client_id, uint16_t map_id, int16_t x, int16_t y) {
+        server->QueueCommand(GameCommand::Warp(client_id, map_id, x, y));
+    }
 
-            // Get client connection once - used for ping and potential correction
-            auto conn = server->Clients().GetClient(client_id);
-            uint32_t ping_ms = conn ? conn->GetPing() : 0;
+    // ================================================================
+    // VISIBILITY UPDATE after a position change (two parts)
+    // 1. Update mover's view: who entered/left MY view?
+    // 2. Update observers: who can no longer see ME?
+    // ================================================================
+    void UpdateVisibilityAfterMove(Zone *zone, const std::shared_ptr<Player> &player, bool has_client) {
+        const PlayerHandle handle = player->GetHandle();
+        const uint64_t client_id = player->GetClientID();
+
+        // Cache spatial query - used for both visibility update and observer notification
+        auto visible = zone->GetWorld().GetPlayersInRange(
+                player->GetX(), player->GetY());
+
+        // Part 1: Update mover's own visibility
+        if (has_client) {
+            auto diff = zone->GetWorld().Visibility().Update(handle, visible);
+            auto &delta = zone->Delta();
+
+            // S_Player_Spatial for players who entered mover's view
+            delta.AddSpatial(client_id, diff.entered);
+
+            // S_Left_Game for players who left mover's view (wire IDs)
+            for (PlayerHandle left : diff.left) {
+                if (auto p = zone->Players().Get(left)) delta.AddLeft(client_id, p->GetID());
+            }
+        }
+
+        // Part 2: Notify observers who lost sight of the mover
+        // (When B walks away from A, A needs to know B left their view)
+        const auto &players = zone->Players();
+        const PlayerTable &table = players.Table();
+        auto get_player_pos = [&](PlayerHandle observer) -> std::pair<int16_t, int16_t> {
+            return players.Contains(observer) ? std::make_pair(table.X(observer), table.Y(observer))
+                                              : std::make_pair<int16_t, int16_t>(0, 0);
+        };
+
+        auto observers_who_lost_sight = zone->GetWorld().Visibility()
+                .NotifyObserversOfDeparture(
+                        handle,
+                        player->GetX(),
+                        player->GetY(),
+                        World::VIEW_RANGE,
+                        get_player_pos);
 
-            // Occupancy check: is another player at (x, y)?
-            uint64_t player_id = player->GetID();
-            auto is_occupied = [server, player_id](int16_t x, int16_t y) {
-                return server->GetWorld().IsPositionOccupied(x, y, player_id);
-            };
+        // S_Left_Game to each observer who can no longer see the mover
+        for (PlayerHandle observer_handle : observers_who_lost_sight) {
+            if (!players.Contains(observer_handle)) continue;
 
-            auto result = player->AttemptMove(direction, facing, server->GetWorld().GetMap(), ping_ms, is_occupied);
+            zone->Delta().AddLeft(table.ClientID(observer_handle), player->GetID());
+        }
+    }
 
-            if (result == MoveResult::Success) {
-                server->GetWorld().UpdatePlayerPosition(
-                        player->GetID(),
+    void ApplyMove(Zone *zone, uint64_t client_id, uint8_t direction, uint8_t facing) {
+        auto player = zone->Players().GetByClientID(client_id);
+        if (!player) return;
+
+        // Get client connection once - used for ping and potential correction.
+        // Ping is measured on the wire, so --deterministic leaves it out.
+        auto conn = zone->Clients().GetClient(client_id);
+        uint32_t ping_ms = conn && !zone->Deterministic() ? conn->GetPing() : 0;
+
+        // Occupancy check: is another player at (x, y)?
+        const PlayerHandle handle = player->GetHandle();
+        auto is_occupied = [zone, handle](int16_t x, int16_t y) {
+            return zone->GetWorld().IsPositionOccupied(x, y, handle);
+        };
+
+        auto result = player->AttemptMove(direction, facing, zone->GetWorld().GetMap(), zone->Now(), ping_ms,
+                                          is_occupied);
+
+        if (result == MoveResult::Success) {
+            zone->GetWorld().UpdatePlayerPosition(
+                    handle,
+                    player->GetX(),
+                    player->GetY());
+            zone->Players().MarkDirty(player);
+
+            UpdateVisibilityAfterMove(zone, player, conn != nullptr);
+        } else {
+            // Move failed (collision, cooldown, etc.) - rubber band client back
+            Log::Trace("Player {} move attempt failed: dir={}, facing={}, result={}",
+                       player->GetID(), direction, facing, static_cast<int>(result));
+            if (conn) {
+                Packets::PacketSender::PositionCorrection(
+                        conn,
                         player->GetX(),
-                        player->GetY());
-                server->Players().MarkDirty(player);
+                        player->GetY(),
+                        player->GetFacing());
+            }
+        }
+    }
 
-                // ============================================================
-                // VISIBILITY UPDATE (two parts)
-                // 1. Update mover's view: who entered/left MY view?
-                // 2. Update observers: who can no longer see ME?
-                // ============================================================
+    void ApplyTurn(Zone *zone, uint64_t client_id, uint8_t facing) {
+        auto player = zone->Players().GetByClientID(client_id);
+        if (!player) return;
 
-                // Cache spatial query - used for both visibility update and observer notification
-                auto visible = server->GetWorld().GetPlayersInRange(
-                        player->GetX(), player->GetY());
+        player->SetFacing(facing);
+        zone->Players().MarkDirty(player);
+    }
 
-                // Part 1: Update mover's own visibility
-                if (conn) {
-                    auto diff = server->GetWorld().Visibility().Update(player_id, visible);
+    void ApplyWarp(Zone *zone, uint64_t client_id, uint16_t map_id, int16_t x, int16_t y) {
+        auto player = zone->Players().GetByClientID(client_id);
+        if (!player) return;
 
-                    // Send S_Player_Spatial for players who entered mover's view
-                    if (!diff.entered.empty()) {
-                        Packets::PacketSender::BatchPlayerSpatial(conn, diff.entered);
-                    }
+        auto conn = zone->Clients().GetClient(client_id);
 
-                    // Send S_Left_Game for players who left mover's view
-                    for (uint64_t left_id : diff.left) {
-                        Packets::PacketSender::PlayerLeft(conn, left_id);
-                    }
+        // The server decides where a client can warp: only from a warp
+        // tile, and only to that tile's destination
+        if (!zone->Zones().OpenWarps()) {
+            const auto warp = zone->Zones().Warps().At(zone->MapID(), player->GetX(), player->GetY());
+            if (!warp || *warp != WarpPoints::Destination{map_id, x, y}) {
+                Log::Warn("Player {} asked to warp to map {} ({}, {}) from ({}, {}), not a warp tile to there",
+                          player->GetID(), map_id, x, y, player->GetX(), player->GetY());
+                if (conn) {
+                    Packets::PacketSender::PositionCorrection(conn, player->GetX(), player->GetY(), player->GetFacing());
                 }
+                return;
+            }
+        }
 
-                // Part 2: Notify observers who lost sight of the mover
-                // (When B walks away from A, A needs to know B left their view)
-                auto get_player_pos = [server](uint64_t id) -> std::pair<int16_t, int16_t> {
-                    auto p = server->GetWorld().GetPlayer(id);
-                    return p ? std::make_pair(p->GetX(), p->GetY())
-                             : std::make_pair<int16_t, int16_t>(0, 0);
-                };
-
-                auto observers_who_lost_sight = server->GetWorld().Visibility()
-                        .NotifyObserversOfDeparture(
-                                player_id,
-                                player->GetX(),
-                                player->GetY(),
-                                World::VIEW_RANGE,
-                                get_player_pos);
-
-                // Send S_Left_Game to each observer who can no longer see the mover
-                for (uint64_t observer_id : observers_who_lost_sight) {
-                    auto observer = server->GetWorld().GetPlayer(observer_id);
-                    if (!observer) continue;
-
-                    auto observer_conn = server->Clients().GetClient(observer->GetClientID());
-                    if (!observer_conn) continue;
-
-                    Packets::PacketSender::PlayerLeft(observer_conn, player_id);
-                }
-            } else {
-                // Move failed (collision, cooldown, etc.) - rubber band client back
-                Log::Trace("Player {} move attempt failed: dir={}, facing={}, result={}",
-                           player->GetID(), direction, facing, static_cast<int>(result));
+        if (map_id != zone->MapID()) {
+            if (!zone->Zones().Get(map_id)) {
+                Log::Warn("Player {} tried to warp to unknown map {}", player->GetID(), map_id);
                 if (conn) {
-                    Packets::PacketSender::PositionCorrection(
-                            conn,
-                            player->GetX(),
-                            player->GetY(),
-                            player->GetFacing());
+                    Packets::PacketSender::PositionCorrection(conn, player->GetX(), player->GetY(), player->GetFacing());
                 }
+                return;
             }
-        });
-    }
+            // The target picks the exact tile - it owns that map's occupancy
+            zone->TransferOut(player, map_id, x, y);
+            return;
+        }
+
+        // Same map: teleport to the nearest open tile
+        if (!zone->GetWorld().FindOpenTile(x, y, player->GetHandle())) {
+            Log::Trace("Player {} warp to ({}, {}) failed: no open tile", player->GetID(), x, y);
+            if (conn) {
+                Packets::PacketSender::PositionCorrection(conn, player->GetX(), player->GetY(), player->GetFacing());
+            }
+            return;
+        }
 
-    void Turn(GameServer *server, uint64_t client_id, uint8_t facing) {
-        server->QueueAction([=]() {
-            auto player = server->Players().GetByClientID(client_id);
-            if (!player) return;
+        player->SetPosition(x, y);
+        zone->GetWorld().UpdatePlayerPosition(player->GetHandle(), x, y);
+        zone->Players().MarkDirty(player);
+        if (conn) Packets::PacketSender::Warped(conn, map_id, x, y);
 
-            player->SetFacing(facing);
-            server->Players().MarkDirty(player);
-        });
+        UpdateVisibilityAfterMove(zone, player, conn != nullptr);
     }
-}
\ No newline at end of file
+}
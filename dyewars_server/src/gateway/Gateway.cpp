@@ -0,0 +1,426 @@
+/// =======================================
+/// DyeWarsGateway - Gateway
+/// =======================================
+#include "Gateway.h"
+#include "GatewayClient.h"
+#include "core/Log.h"
+#include "network/IoContextPool.h"
+
+#include <cstring>
+#include <format>
+
+namespace {
+    /// Receive buffer growth step for the upstream stream
+    constexpr size_t READ_CHUNK = 64 * 1024;
+
+    /// Drop the upstream stream when this much is waiting to be written -
+    /// the game stopped reading
+    constexpr size_t MAX_UPSTREAM_QUEUED_BYTES = 64 * 1024 * 1024;
+}
+
+// ============================================================================
+// CONFIG
+// ============================================================================
+
+Gateway::Config Gateway::Config::FromArgs(int argc, char *argv[]) {
+    Config config;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        auto next_value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument(arg + " needs a value");
+            return argv[++i];
+        };
+
+        if (arg == "--listen-port") {
+            const unsigned long port = std::stoul(next_value());
+            if (port == 0 || port > 65535) throw std::invalid_argument("--listen-port must be 1-65535");
+            config.listen_port = static_cast<uint16_t>(port);
+        } else if (arg == "--game-host") {
+            config.game_host = next_value();
+        } else if (arg == "--game-port") {
+            const unsigned long port = std::stoul(next_value());
+            if (port == 0 || port > 65535) throw std::invalid_argument("--game-port must be 1-65535");
+            config.game_port = static_cast<uint16_t>(port);
+        } else if (arg == "--io-threads") {
+            config.io_threads = std::stoul(next_value());
+            if (config.io_threads == 0 || config.io_threads > 64) {
+                throw std::invalid_argument("--io-threads must be 1-64");
+            }
+        } else {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    return config;
+}
+
+const char *Gateway::Config::Usage() {
+    return "Usage: DyeWarsGateway [--listen-port N] [--game-host IP] [--game-port N] [--io-threads N]\n"
+           "  --listen-port N  Port clients connect to (default 8181)\n"
+           "  --game-host IP   Game server started with --gateway (default 127.0.0.1)\n"
+           "  --game-port N    Its gateway port (default 8084, +10 per shard)\n"
+           "  --io-threads N   Client IO threads (default 1)\n";
+}
+
+// ============================================================================
+// LIFECYCLE
+// ============================================================================
+
+Gateway::Gateway(IoContextPool &io_pool, const Config &config)
+        : io_pool_(io_pool),
+          config_(config),
+          acceptor_(io_pool.Primary(), asio::ip::tcp::endpoint(asio::ip::tcp::v4(), config.listen_port)),
+          upstream_(io_pool.Primary()),
+          reconnect_timer_(io_pool.Primary()) {
+}
+
+Gateway::~Gateway() {
+    Stop();
+}
+
+void Gateway::Start() {
+    Log::Info("Gateway listening on port {}, game at {}:{}", config_.listen_port, config_.game_host,
+              config_.game_port);
+    asio::post(io_pool_.Primary(), [this]() { ConnectUpstream(); });
+    StartAccept();
+}
+
+void Gateway::Stop() {
+    if (!running_.exchange(false)) return;
+
+    std::error_code ec;
+    acceptor_.close(ec);
+
+    // Upstream state belongs to the primary thread
+    asio::post(io_pool_.Primary(), [this]() {
+        std::error_code ec;
+        reconnect_timer_.cancel();
+        upstream_.close(ec);
+    });
+
+    std::unordered_map<uint64_t, std::shared_ptr<GatewayClient>> clients;
+    {
+        std::lock_guard lock(clients_mutex_);
+        clients = clients_;
+    }
+    for (auto &[id, client] : clients) client->Close("gateway shutting down", false);
+}
+
+// ============================================================================
+// CLIENTS
+// ============================================================================
+
+void Gateway::StartAccept() {
+    // Each client is pinned to one IO thread, like GameServer::StartAccept
+    const size_t io_index = io_pool_.NextIndex();
+    acceptor_.async_accept(io_pool_.Context(io_index), [this, io_index](std::error_code ec,
+                                                                       asio::ip::tcp::socket socket) {
+        if (!running_) return;
+        if (ec) {
+            Log::Error("Accept failed: {}", ec.message());
+            StartAccept();
+            return;
+        }
+
+        std::error_code endpoint_ec;
+        const auto endpoint = socket.remote_endpoint(endpoint_ec);
+        if (endpoint_ec) {
+            socket.close(endpoint_ec);
+            StartAccept();
+            return;
+        }
+        const std::string ip = endpoint.address().to_string();
+
+        // Same checks the server makes for a direct connection
+        if (!upstream_up_) {
+            Log::Trace("Game unreachable, refusing {}", ip);
+            socket.close(ec);
+        } else if (limiter_.IsBanned(ip)) {
+            Log::Trace("Rejected banned IP: {}", ip);
+            socket.close(ec);
+        } else if (!limiter_.CheckRateLimit(ip)) {
+            Log::Trace("Rate limited IP: {}", ip);
+            socket.close(ec);
+        } else if (!limiter_.CanConnect(ip)) {
+            Log::Trace("Connection limit reached for IP: {}", ip);
+            socket.close(ec);
+        } else {
+            limiter_.AddConnection(ip);
+            const uint64_t id = next_client_id_++;
+            auto client = std::make_shared<GatewayClient>(std::move(socket), *this, id, ip,
+                                                          io_pool_.Wheel(io_index));
+            {
+                std::lock_guard lock(clients_mutex_);
+                clients_[id] = client;
+            }
+            client->Start();
+        }
+        StartAccept();
+    });
+}
+
+void Gateway::OnClientReady(const std::shared_ptr<GatewayClient> &client, uint64_t resume_token) {
+    if (!upstream_up_) {
+        client->Close("game unreachable", false);
+        return;
+    }
+    StageUpstream([&](std::vector<uint8_t> &out) {
+        GatewayProtocol::AppendClientOpen(out, client->Id(), resume_token, client->Ip());
+    });
+}
+
+void Gateway::ForwardFrame(uint64_t client_id, std::span<const uint8_t> payload) {
+    frames_forwarded_.fetch_add(1, std::memory_order_relaxed);
+    StageUpstream([&](std::vector<uint8_t> &out) {
+        GatewayProtocol::AppendClientFrame(out, client_id, payload);
+    });
+}
+
+void Gateway::ForwardPing(uint64_t client_id, uint32_t ping_ms) {
+    StageUpstream([&](std::vector<uint8_t> &out) {
+        GatewayProtocol::AppendClientPing(out, client_id, ping_ms);
+    });
+}
+
+void Gateway::OnClientClosed(uint64_t client_id, const std::string &ip, bool notify_game) {
+    {
+        std::lock_guard lock(clients_mutex_);
+        clients_.erase(client_id);
+    }
+    limiter_.RemoveConnection(ip);
+    if (notify_game && upstream_up_) {
+        StageUpstream([&](std::vector<uint8_t> &out) {
+            GatewayProtocol::AppendClientClosed(out, client_id);
+        });
+    }
+}
+
+// ============================================================================
+// UPSTREAM CONNECTION (primary IO thread)
+// ============================================================================
+
+void Gateway::ConnectUpstream() {
+    if (!running_) return;
+
+    std::error_code ec;
+    const auto address = asio::ip::make_address(config_.game_host, ec);
+    if (ec) {
+        Log::Error("Bad --game-host {}: {}", config_.game_host, ec.message());
+        return;
+    }
+
+    upstream_.async_connect(asio::ip::tcp::endpoint(address, config_.game_port), [this](std::error_code ec) {
+        if (!running_) return;
+        if (ec) {
+            Log::Warn("Game at {}:{} unreachable: {}", config_.game_host, config_.game_port, ec.message());
+            std::error_code close_ec;
+            upstream_.close(close_ec);
+            ScheduleReconnect();
+            return;
+        }
+
+        std::error_code option_ec;
+        upstream_.set_option(asio::ip::tcp::no_delay(true), option_ec);
+        upstream_recv_size_ = 0;
+        upstream_up_ = true;
+        Log::Info("Connected to game at {}:{}", config_.game_host, config_.game_port);
+        StartUpstreamRead();
+    });
+}
+
+void Gateway::ScheduleReconnect() {
+    reconnect_timer_.expires_after(RECONNECT_INTERVAL);
+    reconnect_timer_.async_wait([this](std::error_code ec) {
+        if (!ec) ConnectUpstream();
+    });
+}
+
+void Gateway::OnUpstreamLost(const std::string &reason) {
+    if (!upstream_up_.exchange(false)) return;
+    Log::Warn("Lost the game stream: {}", reason);
+
+    std::error_code ec;
+    upstream_.close(ec);
+    upstream_writes_.clear();
+    upstream_writing_ = false;
+    {
+        std::lock_guard lock(upstream_mutex_);
+        upstream_staged_.clear();
+    }
+
+    // Their players went with the stream
+    std::unordered_map<uint64_t, std::shared_ptr<GatewayClient>> clients;
+    {
+        std::lock_guard lock(clients_mutex_);
+        clients = clients_;
+    }
+    for (auto &[id, client] : clients) client->Close("game connection lost", false);
+
+    if (running_) ScheduleReconnect();
+}
+
+// ============================================================================
+// UPSTREAM RECEIVE (primary IO thread)
+// ============================================================================
+
+void Gateway::StartUpstreamRead() {
+    if (upstream_recv_.size() - upstream_recv_size_ < READ_CHUNK) {
+        upstream_recv_.resize(upstream_recv_size_ + READ_CHUNK);
+    }
+    upstream_.async_read_some(
+            asio::buffer(upstream_recv_.data() + upstream_recv_size_, upstream_recv_.size() - upstream_recv_size_),
+            [this](std::error_code ec, size_t bytes_read) {
+                if (ec) {
+                    if (running_) OnUpstreamLost(ec == asio::error::eof ? "game closed the stream" : ec.message());
+                    return;
+                }
+                upstream_recv_size_ += bytes_read;
+                ProcessUpstream();
+                if (upstream_up_) StartUpstreamRead();
+            });
+}
+
+void Gateway::ProcessUpstream() {
+    using namespace GatewayProtocol;
+
+    size_t offset = 0;
+    while (upstream_up_) {
+        Message message{};
+        size_t consumed = 0;
+        const auto stream = std::span<const uint8_t>(upstream_recv_.data() + offset, upstream_recv_size_ - offset);
+        const auto status = Parse(stream, message, consumed);
+        if (status == ParseStatus::NeedMore) break;
+        if (status == ParseStatus::Corrupt) {
+            OnUpstreamLost("corrupt stream");
+            return;
+        }
+
+        switch (message.type) {
+            case Type::Deliver: OnDeliver(message.body); break;
+            case Type::Close:   OnClose(message.body); break;
+            default:
+                OnUpstreamLost(std::format("unexpected message type {}", static_cast<int>(message.type)));
+                return;
+        }
+        offset += consumed;
+    }
+
+    if (offset > 0) {
+        std::memmove(upstream_recv_.data(), upstream_recv_.data() + offset, upstream_recv_size_ - offset);
+        upstream_recv_size_ -= offset;
+    }
+}
+
+void Gateway::OnDeliver(std::span<const uint8_t> body) {
+    const auto deliver = GatewayProtocol::DecodeDeliver(body);
+    if (!deliver) {
+        OnUpstreamLost("bad Deliver");
+        return;
+    }
+    delivers_received_.fetch_add(1, std::memory_order_relaxed);
+
+    // One copy out of the receive buffer, shared by every recipient's queue
+    const auto frame = std::make_shared<std::vector<uint8_t>>(deliver->frame.begin(), deliver->frame.end());
+
+    std::vector<std::shared_ptr<GatewayClient>> recipients;
+    recipients.reserve(deliver->clients.size());
+    {
+        std::lock_guard lock(clients_mutex_);
+        for (const uint64_t id : deliver->clients) {
+            // Clients that closed since the game queued this are skipped
+            if (auto it = clients_.find(id); it != clients_.end()) recipients.push_back(it->second);
+        }
+    }
+    for (const auto &client : recipients) client->Send(frame);
+    packets_replicated_.fetch_add(recipients.size(), std::memory_order_relaxed);
+}
+
+void Gateway::OnClose(std::span<const uint8_t> body) {
+    const auto close = GatewayProtocol::DecodeClose(body);
+    if (!close) {
+        OnUpstreamLost("bad Close");
+        return;
+    }
+    std::shared_ptr<GatewayClient> client;
+    {
+        std::lock_guard lock(clients_mutex_);
+        if (auto it = clients_.find(close->client); it != clients_.end()) client = it->second;
+    }
+    // The game already dropped the player - don't report the close back
+    if (client) client->Close(close->reason, false);
+}
+
+// ============================================================================
+// UPSTREAM SEND (staged from any thread, written on the primary IO thread)
+// ============================================================================
+
+template<typename Append>
+void Gateway::StageUpstream(Append &&append) {
+    bool post = false;
+    {
+        std::lock_guard lock(upstream_mutex_);
+        append(upstream_staged_);
+        post = !upstream_flush_posted_;
+        upstream_flush_posted_ = true;
+    }
+    // One post per burst: a read completion forwarding many frames lands in one write
+    if (post) asio::post(io_pool_.Primary(), [this]() { FlushUpstream(); });
+}
+
+void Gateway::FlushUpstream() {
+    auto out = std::make_shared<std::vector<uint8_t>>();
+    {
+        std::lock_guard lock(upstream_mutex_);
+        upstream_flush_posted_ = false;
+        out->swap(upstream_staged_);
+    }
+    if (out->empty() || !upstream_up_) return;
+
+    size_t queued = out->size();
+    for (const auto &pending : upstream_writes_) queued += pending->size();
+    if (queued > MAX_UPSTREAM_QUEUED_BYTES) {
+        OnUpstreamLost(std::format("game stopped reading ({} bytes queued)", queued));
+        return;
+    }
+    upstream_writes_.push_back(std::move(out));
+    StartUpstreamWrite();
+}
+
+void Gateway::StartUpstreamWrite() {
+    if (upstream_writing_ || upstream_writes_.empty() || !upstream_up_) return;
+
+    auto data = std::move(upstream_writes_.front());
+    upstream_writes_.pop_front();
+    upstream_writing_ = true;
+    asio::async_write(upstream_, asio::buffer(*data), [this, data](const std::error_code &ec, size_t) {
+        upstream_writing_ = false;
+        if (ec) {
+            if (running_) OnUpstreamLost(ec.message());
+            return;
+        }
+        StartUpstreamWrite();
+    });
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+std::string Gateway::GetStatus() {
+    size_t clients = 0;
+    {
+        std::lock_guard lock(clients_mutex_);
+        clients = clients_.size();
+    }
+    const uint64_t delivers = delivers_received_.load(std::memory_order_relaxed);
+    const uint64_t replicated = packets_replicated_.load(std::memory_order_relaxed);
+    return std::format("Gateway on port {}: {} clients, game {}:{} {}\n"
+                       "  {} frames forwarded, {} delivers -> {} packets ({:.2f}x fan-out)\n"
+                       "  backpressure: {} conflated, {} dropped, {} slow consumers kicked",
+                       config_.listen_port, clients, config_.game_host, config_.game_port,
+                       upstream_up_ ? "connected" : "DOWN",
+                       frames_forwarded_.load(std::memory_order_relaxed), delivers, replicated,
+                       delivers ? static_cast<double>(replicated) / static_cast<double>(delivers) : 0.0,
+                       packets_conflated_.load(std::memory_order_relaxed),
+                       packets_dropped_.load(std::memory_order_relaxed),
+                       slow_consumer_kicks_.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,169 @@
+/// =======================================
+/// DyeWarsGateway - Gateway
+///
+/// Connection gateway: accepts game clients, checks them (ConnectionLimiter,
+/// handshake), and multiplexes all of them over one TCP stream to a game
+/// server started with --gateway (wire format in GatewayProtocol.h).
+///
+///   clients ──TCP──> [ Gateway ] ══ one stream ══> [ DyeWarsServer ]
+///                        │ replicates each Deliver to its recipients
+///
+/// WHY:
+/// The game server's IO threads spend most of their time on per-client
+/// socket work: one write per packet per client, framing, pings. The
+/// gateway takes all of that off the simulation host. The server sends each
+/// distinct packet once with a recipient list (Deliver), and the gateway
+/// copies the same buffer into every recipient's send queue. More players
+/// means more gateways, not more load on the game's IO threads.
+///
+/// BACKPRESSURE:
+/// The game can't see a gateway client's socket, so its send queue lives
+/// here and GatewayClient::Send applies the direct connection's tiers
+/// (conflate, drop, kick). The game only bounds the stream as a whole
+/// (GatewaySession::MAX_QUEUED_BYTES).
+///
+/// UPSTREAM LOSS:
+/// If the game stream drops, every client is closed (their players are
+/// gone with the stream) and the gateway reconnects every
+/// RECONNECT_INTERVAL. New clients are turned away until it's back.
+///
+/// THREAD SAFETY:
+///   - Clients: each on one pool context (round-robin), like the server
+///   - Upstream socket: primary context only. Client threads stage
+///     messages under upstream_mutex_ and post one flush per burst.
+///   - clients_: mutex (written on client threads, read by the upstream)
+///   - GetStatus: any thread
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "network/ConnectionLimiter.h"
+#include "network/GatewayProtocol.h"
+
+class GatewayClient;
+class IoContextPool;
+
+class Gateway {
+public:
+    struct Config {
+        uint16_t listen_port = 8181;      // Clients connect here
+        std::string game_host = "127.0.0.1";
+        uint16_t game_port = GatewayProtocol::PORT;
+        size_t io_threads = 1;
+
+        /// Parse argv. Throws std::invalid_argument on unknown or malformed flags.
+        static Config FromArgs(int argc, char *argv[]);
+
+        static const char *Usage();
+    };
+
+    static constexpr auto RECONNECT_INTERVAL = std::chrono::seconds(2);
+
+    Gateway(IoContextPool &io_pool, const Config &config);
+
+    ~Gateway();
+
+    Gateway(const Gateway &) = delete;
+    Gateway &operator=(const Gateway &) = delete;
+
+    /// Connect upstream and start accepting clients
+    void Start();
+
+    /// Stop accepting, close every client and the upstream stream
+    void Stop();
+
+    std::string GetStatus();
+
+    // =========================================================================
+    // CLIENT EVENTS (client IO threads)
+    // =========================================================================
+
+    ConnectionLimiter &Limiter() { return limiter_; }
+
+    /// Handshake passed: announce the client to the game
+    void OnClientReady(const std::shared_ptr<GatewayClient> &client, uint64_t resume_token);
+
+    /// One frame from a ready client, for the game
+    void ForwardFrame(uint64_t client_id, std::span<const uint8_t> payload);
+
+    /// RTT of a ready client's latest pong, for the game's latency grace
+    void ForwardPing(uint64_t client_id, uint32_t ping_ms);
+
+    // Backpressure counters (GatewayClient::Send), like ServerStats'
+    void RecordSendQueueConflation(size_t packets_removed) {
+        packets_conflated_.fetch_add(packets_removed, std::memory_order_relaxed);
+    }
+
+    void RecordSendQueueDrop() { packets_dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+    void RecordSlowConsumerKick() { slow_consumer_kicks_.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Socket closed. `notify_game` is false when the game asked for it.
+    void OnClientClosed(uint64_t client_id, const std::string &ip, bool notify_game);
+
+private:
+    // --- Clients ---
+    void StartAccept();
+
+    // --- Upstream (primary IO thread) ---
+    void ConnectUpstream();
+    void ScheduleReconnect();
+    void OnUpstreamLost(const std::string &reason);
+    void StartUpstreamRead();
+    void ProcessUpstream();
+    void OnDeliver(std::span<const uint8_t> body);
+    void OnClose(std::span<const uint8_t> body);
+
+    /// Stage bytes for the game and make sure a flush is posted (any thread)
+    template<typename Append>
+    void StageUpstream(Append &&append);
+
+    void FlushUpstream();
+    void StartUpstreamWrite();
+
+    IoContextPool &io_pool_;
+    const Config config_;
+    asio::ip::tcp::acceptor acceptor_;
+    ConnectionLimiter limiter_;
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> next_client_id_{1};
+
+    // --- Clients (mutex) ---
+    std::mutex clients_mutex_;
+    std::unordered_map<uint64_t, std::shared_ptr<GatewayClient>> clients_;
+
+    // --- Upstream (primary IO thread only) ---
+    asio::ip::tcp::socket upstream_;
+    asio::steady_timer reconnect_timer_;
+    std::vector<uint8_t> upstream_recv_;
+    size_t upstream_recv_size_ = 0;
+    std::deque<std::shared_ptr<std::vector<uint8_t>>> upstream_writes_;
+    bool upstream_writing_ = false;
+    std::atomic<bool> upstream_up_{false};
+
+    // --- Upstream staging (mutex, any thread) ---
+    std::mutex upstream_mutex_;
+    std::vector<uint8_t> upstream_staged_;
+    bool upstream_flush_posted_ = false;
+
+    // --- Stats ---
+    std::atomic<uint64_t> frames_forwarded_{0};
+    std::atomic<uint64_t> delivers_received_{0};
+    std::atomic<uint64_t> packets_replicated_{0};
+    std::atomic<uint64_t> packets_conflated_{0};
+    std::atomic<uint64_t> packets_dropped_{0};
+    std::atomic<uint64_t> slow_consumer_kicks_{0};
+};
@@ -0,0 +1,285 @@
+/// =======================================
+/// DyeWarsGateway - GatewayClient
+/// =======================================
+#include "GatewayClient.h"
+#include "Gateway.h"
+#include "core/Log.h"
+#include "network/HandshakeCheck.h"
+#include "network/SpatialConflation.h"
+#include "network/Packets/Protocol.h"
+#include "network/Packets/OpCodes.h"
+
+#include <algorithm>
+#include <format>
+
+GatewayClient::GatewayClient(asio::ip::tcp::socket socket, Gateway &gateway, uint64_t id, std::string ip,
+                             TimerWheel &timers)
+        : socket_(std::move(socket)),
+          gateway_(gateway),
+          id_(id),
+          ip_(std::move(ip)),
+          timers_(timers) {
+    std::error_code ec;
+    socket_.set_option(asio::ip::tcp::no_delay(true), ec);
+}
+
+GatewayClient::~GatewayClient() = default;
+
+void GatewayClient::Start() {
+    // Accepted on the primary context, but the wheel belongs to the socket's
+    asio::post(socket_.get_executor(), [self = shared_from_this()]() {
+        self->handshake_timer_ = self->timers_.Arm(
+                TimerWheel::TicksFor(std::chrono::seconds(Protocol::HANDSHAKE_TIMEOUT_SECONDS)),
+                self->weak_from_this(), TIMER_HANDSHAKE);
+        self->StartRead();
+    });
+}
+
+void GatewayClient::Close(const std::string &reason, bool notify_game) {
+    if (closing_.exchange(true)) return;
+    asio::dispatch(socket_.get_executor(), [self = shared_from_this(), reason, notify_game]() {
+        Log::Debug("Gateway client {} closing: {}", self->id_, reason);
+        self->CancelTimers();
+        std::error_code ec;
+        self->socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+        self->socket_.close(ec);
+        // Only a client that reached the game has a player to clean up
+        self->gateway_.OnClientClosed(self->id_, self->ip_, notify_game && self->handshake_complete_);
+    });
+}
+
+// ============================================================================
+// RECEIVE (IO thread)
+// ============================================================================
+
+void GatewayClient::StartRead() {
+    socket_.async_read_some(asio::buffer(recv_ring_.WritePtr(), recv_ring_.WritableBytes()),
+                            [self = shared_from_this()](std::error_code ec, size_t bytes_read) {
+                                if (ec) {
+                                    self->Close(self->handshake_complete_ ? "connection lost"
+                                                                          : "connection closed before handshake");
+                                    return;
+                                }
+                                self->recv_ring_.Commit(bytes_read);
+                                self->last_receive_tick_ = self->timers_.CurrentTick();
+                                self->ProcessFrames();
+                                if (!self->closing_) {
+                                    self->recv_ring_.Compact();
+                                    self->StartRead();
+                                }
+                            });
+}
+
+void GatewayClient::ProcessFrames() {
+    // Same rules as ClientConnection::ProcessReceivedFrames
+    while (!closing_) {
+        uint16_t size = 0;
+        const auto status = recv_ring_.PeekFrame(size);
+        if (status == ReceiveRing::FrameStatus::NeedMore) return;
+
+        if (status != ReceiveRing::FrameStatus::Ready) {
+            if (!handshake_complete_) {
+                gateway_.Limiter().RecordFailure(ip_);
+                Close("invalid header while waiting for handshake");
+                return;
+            }
+            recv_ring_.Consume(Protocol::HEADER_SIZE);
+            ProtocolViolation();
+            continue;
+        }
+
+        const auto payload = recv_ring_.Payload(size);
+        if (!handshake_complete_) {
+            OnHandshake(payload);
+        } else {
+            OnPayload(payload);
+        }
+        recv_ring_.Consume(Protocol::HEADER_SIZE + size);
+    }
+}
+
+void GatewayClient::OnHandshake(std::span<const uint8_t> payload) {
+    const auto result = HandshakeCheck::Validate(payload);
+    if (!result.ok) {
+        Log::Warn("IP: {} gateway handshake failed because: {}.", ip_, result.error);
+        gateway_.Limiter().RecordFailure(ip_);
+        Close(result.error);
+        return;
+    }
+
+    timers_.Cancel(handshake_timer_);
+    handshake_timer_ = TimerWheel::NO_TIMER;
+    handshake_complete_ = true;
+
+    // Keepalive, staggered by ID like ClientConnection::StartKeepalive
+    const uint64_t ping_ticks = TimerWheel::TicksFor(std::chrono::seconds(Protocol::PING_INTERVAL_SECONDS));
+    ping_timer_ = timers_.Arm(ping_ticks + id_ % ping_ticks, weak_from_this(), TIMER_PING);
+    last_receive_tick_ = timers_.CurrentTick();
+    idle_timer_ = timers_.Arm(TimerWheel::TicksFor(std::chrono::seconds(Protocol::IDLE_TIMEOUT_SECONDS)),
+                              weak_from_this(), TIMER_IDLE);
+
+    gateway_.OnClientReady(shared_from_this(), result.resume_token);
+}
+
+void GatewayClient::OnPayload(std::span<const uint8_t> payload) {
+    // Connection upkeep stays here - the game never sees it
+    switch (payload[0]) {
+        case Protocol::Opcode::Connection::Client::C_Pong_Response.op: {
+            auto rtt = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - ping_sent_).count();
+            const auto ping_ms = static_cast<uint32_t>(std::clamp<int64_t>(rtt, 0, 5000));
+            ping_ms_.store(ping_ms, std::memory_order_relaxed);
+            // The game's copy drives its latency grace (Player::GetAdjustedCooldown)
+            gateway_.ForwardPing(id_, ping_ms);
+            return;
+        }
+        case Protocol::Opcode::Connection::Client::C_Heartbeat_Request.op:
+            SendPayload({Protocol::Opcode::Connection::Server::S_Heartbeat_Response.op});
+            return;
+        default:
+            gateway_.ForwardFrame(id_, payload);
+            return;
+    }
+}
+
+void GatewayClient::ProtocolViolation() {
+    if (++protocol_violations_ >= Protocol::MAX_HEADER_VIOLATIONS) {
+        Close("too many protocol violations");
+    }
+}
+
+// ============================================================================
+// TIMERS (IO thread)
+// ============================================================================
+
+void GatewayClient::OnTimer(uint32_t tag) {
+    if (closing_) return;
+
+    switch (tag) {
+        case TIMER_HANDSHAKE:
+            handshake_timer_ = TimerWheel::NO_TIMER;
+            gateway_.Limiter().RecordFailure(ip_);
+            Close("failed to handshake within 5 seconds");
+            break;
+        case TIMER_PING:
+            SendPing();
+            ping_timer_ = timers_.Arm(TimerWheel::TicksFor(std::chrono::seconds(Protocol::PING_INTERVAL_SECONDS)),
+                                      weak_from_this(), TIMER_PING);
+            break;
+        case TIMER_IDLE: {
+            const uint64_t timeout = TimerWheel::TicksFor(std::chrono::seconds(Protocol::IDLE_TIMEOUT_SECONDS));
+            const uint64_t idle = timers_.CurrentTick() - last_receive_tick_;
+            if (idle >= timeout) {
+                idle_timer_ = TimerWheel::NO_TIMER;
+                Close(std::format("idle timeout (no data for {} seconds)", Protocol::IDLE_TIMEOUT_SECONDS));
+                return;
+            }
+            idle_timer_ = timers_.Arm(timeout - idle, weak_from_this(), TIMER_IDLE);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void GatewayClient::SendPing() {
+    ping_sent_ = std::chrono::steady_clock::now();
+    const auto timestamp = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(ping_sent_.time_since_epoch()).count() &
+            0xFFFFFFFF);
+
+    std::vector<uint8_t> payload;
+    Protocol::PacketWriter::WriteByte(payload, Protocol::Opcode::Connection::Server::S_Ping_Request.op);
+    Protocol::PacketWriter::WriteUInt(payload, timestamp);
+    SendPayload(std::move(payload));
+}
+
+void GatewayClient::CancelTimers() {
+    timers_.Cancel(handshake_timer_);
+    timers_.Cancel(ping_timer_);
+    timers_.Cancel(idle_timer_);
+    handshake_timer_ = ping_timer_ = idle_timer_ = TimerWheel::NO_TIMER;
+}
+
+// ============================================================================
+// SEND (any thread queues, IO thread writes)
+// ============================================================================
+
+void GatewayClient::SendPayload(std::vector<uint8_t> payload) {
+    Protocol::Packet pkt;
+    pkt.payload = std::move(payload);
+    pkt.size = static_cast<uint16_t>(pkt.payload.size());
+    Send(std::make_shared<std::vector<uint8_t>>(pkt.ToBytes()));
+}
+
+void GatewayClient::Send(std::shared_ptr<std::vector<uint8_t>> frame) {
+    if (closing_) return;
+
+    // Same tiers as ClientConnection::QueueRaw
+    namespace Op = Protocol::Opcode;
+    const uint8_t opcode = frame->size() > Protocol::HEADER_SIZE ? (*frame)[Protocol::HEADER_SIZE] : 0;
+    bool kick = false;
+    {
+        std::lock_guard lock(send_mutex_);
+        if (send_queue_overflowed_) return;
+
+        const size_t packets = send_queue_.size();
+        const bool over_conflate = packets >= SEND_QUEUE_CONFLATE_PACKETS ||
+                                   send_queue_bytes_ >= SEND_QUEUE_CONFLATE_BYTES;
+        const bool over_drop = packets >= SEND_QUEUE_DROP_PACKETS ||
+                               send_queue_bytes_ >= SEND_QUEUE_DROP_BYTES;
+
+        if (over_conflate && opcode == Op::Batch::Server::S_Player_Spatial.op) {
+            // Tier 1: fold this batch and every queued one into latest-per-player
+            gateway_.RecordSendQueueConflation(SpatialConflation::Conflate(send_queue_, frame));
+            send_queue_bytes_ = 0;
+            for (const auto &packet : send_queue_) send_queue_bytes_ += packet->size();
+        } else if (over_drop && (opcode == Op::Connection::Server::S_Ping_Request.op ||
+                                 opcode == Op::Connection::Server::S_Heartbeat_Response.op)) {
+            // Tier 2: nothing breaks if these never arrive
+            gateway_.RecordSendQueueDrop();
+            return;
+        } else {
+            send_queue_bytes_ += frame->size();
+            send_queue_.push_back(std::move(frame));
+        }
+
+        // Tier 3: conflation and dropping didn't keep up
+        if (send_queue_.size() >= SEND_QUEUE_KICK_PACKETS || send_queue_bytes_ >= SEND_QUEUE_KICK_BYTES) {
+            send_queue_overflowed_ = true;
+            send_queue_.clear();  // Free the memory now, the client is going away
+            send_queue_bytes_ = 0;
+            kick = true;
+        }
+    }
+    if (kick) {
+        gateway_.RecordSlowConsumerKick();
+        Close("slow consumer: send queue overflow");
+        return;
+    }
+    asio::dispatch(socket_.get_executor(), [self = shared_from_this()]() { self->StartNextSend(); });
+}
+
+void GatewayClient::StartNextSend() {
+    if (write_in_progress_ || closing_) return;
+
+    std::shared_ptr<std::vector<uint8_t>> frame;
+    {
+        std::lock_guard lock(send_mutex_);
+        if (send_queue_.empty()) return;
+        frame = std::move(send_queue_.front());
+        send_queue_.pop_front();
+        // The marks count what's waiting; conflation recounts the queue alone
+        send_queue_bytes_ -= frame->size();
+    }
+    write_in_progress_ = true;
+    asio::async_write(socket_, asio::buffer(*frame),
+                      [self = shared_from_this(), frame](const std::error_code &ec, size_t) {
+                          self->write_in_progress_ = false;
+                          if (ec) {
+                              self->Close("connection lost");
+                              return;
+                          }
+                          self->StartNextSend();
+                      });
+}
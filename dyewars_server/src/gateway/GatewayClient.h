@@ -0,0 +1,128 @@
+/// =======================================
+/// DyeWarsGateway - GatewayClient
+///
+/// One game client's socket, held by the gateway instead of the game
+/// server. Does the socket-level half of what ClientConnection does on a
+/// direct connection:
+///
+///   - frame parsing (ReceiveRing) and the strike system for bad headers
+///   - handshake check (HandshakeCheck, same rules as the server)
+///   - pings, heartbeat replies and the idle timeout (TimerWheel); each
+///     pong's RTT is forwarded to the game (GatewayProtocol ClientPing)
+///   - the send queue, with the same backpressure tiers as a direct
+///     connection (ClientConnection::QueueRaw): conflate spatial batches,
+///     drop pings and heartbeat acks, then kick
+///
+/// Everything else - every frame after the handshake except pongs and
+/// heartbeats - is forwarded to the game through the Gateway.
+///
+/// THREAD SAFETY:
+/// Same model as ClientConnection: bound to one io_context, everything
+/// but Send / Close runs on that thread. Send is called from the upstream
+/// thread (Deliver fan-out) and takes the send mutex.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include "network/ReceiveRing.h"
+#include "network/TimerWheel.h"
+
+class Gateway;
+
+class GatewayClient : public std::enable_shared_from_this<GatewayClient>,
+                      public TimerWheel::Target {
+public:
+    // Backpressure marks, same as ClientConnection's (packets OR bytes):
+    //   1. CONFLATE: queued S_Player_Spatial batches merge to latest-per-player
+    //   2. DROP:     pings and heartbeat acks are dropped
+    //   3. KICK:     still growing - close with "slow consumer"
+    static constexpr size_t SEND_QUEUE_CONFLATE_PACKETS = 64;
+    static constexpr size_t SEND_QUEUE_CONFLATE_BYTES = 64 * 1024;
+    static constexpr size_t SEND_QUEUE_DROP_PACKETS = 256;
+    static constexpr size_t SEND_QUEUE_DROP_BYTES = 256 * 1024;
+    static constexpr size_t SEND_QUEUE_KICK_PACKETS = 1024;
+    static constexpr size_t SEND_QUEUE_KICK_BYTES = 1024 * 1024;
+
+    GatewayClient(asio::ip::tcp::socket socket, Gateway &gateway, uint64_t id, std::string ip,
+                  TimerWheel &timers);
+
+    ~GatewayClient() override;
+
+    /// Start the handshake timer and the read chain (any thread)
+    void Start();
+
+    /// Queue a framed packet, subject to the backpressure marks above.
+    /// `frame` may be shared with other clients (one Deliver, many
+    /// recipients) - it is never modified, conflation builds new buffers.
+    /// Any thread.
+    void Send(std::shared_ptr<std::vector<uint8_t>> frame);
+
+    /// Close the socket. `notify_game`: tell the game the client is gone
+    /// (false when the game asked for it). Any thread.
+    void Close(const std::string &reason, bool notify_game = true);
+
+    uint64_t Id() const { return id_; }
+
+    const std::string &Ip() const { return ip_; }
+
+    uint32_t Ping() const { return ping_ms_.load(std::memory_order_relaxed); }
+
+    enum TimerTag : uint32_t {
+        TIMER_HANDSHAKE = 0,
+        TIMER_PING = 1,
+        TIMER_IDLE = 2,
+    };
+
+    void OnTimer(uint32_t tag) override;
+
+private:
+    // --- IO thread ---
+    void StartRead();
+    void ProcessFrames();
+    void OnHandshake(std::span<const uint8_t> payload);
+    void OnPayload(std::span<const uint8_t> payload);
+    void ProtocolViolation();
+    void SendPing();
+    void CancelTimers();
+    void StartNextSend();
+
+    /// Frame a payload and queue it (IO thread or any thread)
+    void SendPayload(std::vector<uint8_t> payload);
+
+    asio::ip::tcp::socket socket_;
+    Gateway &gateway_;
+    const uint64_t id_;
+    const std::string ip_;
+    TimerWheel &timers_;
+
+    // --- IO thread only ---
+    ReceiveRing recv_ring_;
+    bool handshake_complete_ = false;
+    uint8_t protocol_violations_ = 0;
+    uint64_t last_receive_tick_ = 0;
+    TimerWheel::Handle handshake_timer_ = TimerWheel::NO_TIMER;
+    TimerWheel::Handle ping_timer_ = TimerWheel::NO_TIMER;
+    TimerWheel::Handle idle_timer_ = TimerWheel::NO_TIMER;
+    std::chrono::steady_clock::time_point ping_sent_{};
+    bool write_in_progress_ = false;
+
+    std::atomic<uint32_t> ping_ms_{0};
+    std::atomic<bool> closing_{false};
+
+    // --- Send queue (mutex) ---
+    std::mutex send_mutex_;
+    std::deque<std::shared_ptr<std::vector<uint8_t>>> send_queue_;  // SpatialConflation::PacketQueue
+    size_t send_queue_bytes_ = 0;         // Waiting, not the frame being written
+    bool send_queue_overflowed_ = false;  // Being kicked, don't grow further
+};
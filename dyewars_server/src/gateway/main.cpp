@@ -0,0 +1,79 @@
+/// =======================================
+/// DyeWarsGateway
+///
+/// Holds client sockets for a DyeWarsServer started with --gateway and
+/// multiplexes them over one stream (see Gateway.h).
+///
+///   DyeWarsServer --gateway
+///   DyeWarsGateway --listen-port 8181 --io-threads 4
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#include <iostream>
+#include <memory>
+#include "core/Log.h"
+#include "gateway/Gateway.h"
+#include "network/IoContextPool.h"
+
+int main(int argc, char* argv[])
+{
+    Gateway::Config config;
+    try
+    {
+        config = Gateway::Config::FromArgs(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n" << Gateway::Config::Usage();
+        return 1;
+    }
+
+    std::unique_ptr<IoContextPool> io_pool;
+    std::unique_ptr<Gateway> gateway;
+    try
+    {
+        io_pool = std::make_unique<IoContextPool>(config.io_threads);
+        gateway = std::make_unique<Gateway>(*io_pool, config);
+        gateway->Start();
+        io_pool->Run();
+    }
+    catch (const std::exception& e)
+    {
+        Log::Error("Failed to start gateway: {}", e.what());
+        return 1;
+    }
+
+    //Console Loop
+    std::string cmd;
+    while (true)
+    {
+        std::cout << "> ";
+        if (!std::getline(std::cin, cmd)) break;
+
+        if (cmd == "status")
+        {
+            std::cout << gateway->GetStatus() << std::endl;
+        }
+        else if (cmd == "exit" || cmd == "quit")
+        {
+            break;
+        }
+        else if (cmd == "help")
+        {
+            std::cout << "Commands:\n"
+                << "  status - Clients, game stream and fan-out counters\n"
+                << "  exit   - Close every client and quit\n";
+        }
+        else if (!cmd.empty())
+        {
+            Log::Warn("Unknown command: {}", cmd);
+        }
+    }
+
+    gateway->Stop();
+    io_pool->Stop();
+    io_pool->Join();
+    gateway.reset();
+    io_pool.reset();
+    return 0;
+}
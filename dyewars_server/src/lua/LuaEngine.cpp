@@ -4,7 +4,7 @@
 
 namespace fs = std::filesystem;
 
-LuaGameEngine::LuaGameEngine() {
+LuaGameEngine::LuaGameEngine(WarpPoints *warps) : warps_(warps) {
     SetupLuaEnvironment();
     CreateDefaultScript();
     LoadScript(active_script_path_);
@@ -18,7 +18,7 @@ LuaGameEngine::~LuaGameEngine() {
     }
 }
 
-void LuaGameEngine::OnPlayerMoved(uint64_t player_id, int x, int y, uint8_t direction) {
+void LuaGameEngine::OnPlayerMoved(uint64_t player_id, uint16_t map_id, int x, int y, uint8_t direction) {
     // 1. Lock the Mutex (Thread Safety)
     std::lock_guard<std::mutex> lock(lua_mutex_);
 
@@ -30,7 +30,7 @@ void LuaGameEngine::OnPlayerMoved(uint64_t player_id, int x, int y, uint8_t dire
         if (on_move.valid()) {
             // Pass data to Lua
             // Note: player_id passed as string because Lua's double can't represent uint64_t accurately
-            auto result = on_move(std::to_string(player_id), x, y, direction);
+            auto result = on_move(std::to_string(player_id), map_id, x, y, direction);
 
             if (!result.valid()) {
                 sol::error err = result;
@@ -100,6 +100,11 @@ void LuaGameEngine::ReloadScripts() {
     }
 }
 
+void LuaGameEngine::SetTileEditSink(std::function<bool(uint16_t, const TileEdit &)> sink) {
+    std::lock_guard<std::mutex> lock(lua_mutex_);
+    tile_edit_sink_ = std::move(sink);
+}
+
 void LuaGameEngine::SetupLuaEnvironment() {
     lua_.open_libraries(sol::lib::base, sol::lib::package, sol::lib::table, sol::lib::string, sol::lib::math);
 
@@ -112,6 +117,39 @@ void LuaGameEngine::SetupLuaEnvironment() {
         }
         std::cout << std::endl;
     });
+
+    // Tile edits are queued, not applied - see SetTileEditSink. Called
+    // from a script, so lua_mutex_ is already held.
+    auto queue_edit = [this](int map_id, int x, int y, TileEdit::Kind kind, int value) {
+        if (!tile_edit_sink_ || map_id < 0 || map_id > UINT16_MAX || x < 0 || x > INT16_MAX ||
+            y < 0 || y > INT16_MAX || value < 0 || value > UINT8_MAX) {
+            return false;
+        }
+        return tile_edit_sink_(static_cast<uint16_t>(map_id),
+                               TileEdit{static_cast<int16_t>(x), static_cast<int16_t>(y), kind,
+                                        static_cast<uint8_t>(value)});
+    };
+    lua_.set_function("set_tile", [queue_edit](int map_id, int x, int y, int type) {
+        return queue_edit(map_id, x, y, TileEdit::Kind::Type, type);
+    });
+    lua_.set_function("set_tile_blocked", [queue_edit](int map_id, int x, int y, bool blocked) {
+        return queue_edit(map_id, x, y, TileEdit::Kind::Blocked, blocked ? 1 : 0);
+    });
+
+    // Warp tiles - see WarpPoints
+    auto valid_tile = [](int map_id, int x, int y) {
+        return map_id >= 0 && map_id <= UINT16_MAX && x >= 0 && x <= INT16_MAX && y >= 0 && y <= INT16_MAX;
+    };
+    lua_.set_function("add_warp", [this, valid_tile](int map_id, int x, int y, int to_map, int to_x, int to_y) {
+        if (!warps_ || !valid_tile(map_id, x, y) || !valid_tile(to_map, to_x, to_y)) return false;
+        warps_->Add(static_cast<uint16_t>(map_id), static_cast<int16_t>(x), static_cast<int16_t>(y),
+                    {static_cast<uint16_t>(to_map), static_cast<int16_t>(to_x), static_cast<int16_t>(to_y)});
+        return true;
+    });
+    lua_.set_function("remove_warp", [this, valid_tile](int map_id, int x, int y) {
+        if (!warps_ || !valid_tile(map_id, x, y)) return false;
+        return warps_->Remove(static_cast<uint16_t>(map_id), static_cast<int16_t>(x), static_cast<int16_t>(y));
+    });
 }
 
 void LuaGameEngine::CreateDefaultScript() {
@@ -11,6 +11,18 @@
 ///   - File watcher thread: monitors script changes for hot reload
 ///   - Console thread: ReloadScripts (from 'r' command)
 ///
+/// TILE EDITS:
+/// Scripts edit tiles with set_tile(map, x, y, type) and
+/// set_tile_blocked(map, x, y, blocked). Both only queue the edit through
+/// the sink (GameServer -> Zone::QueueTileEdit, lock-free) and return
+/// whether it was queued; the zone applies it on its next tick. A script
+/// running inside a zone's tick never touches another zone's map.
+///
+/// WARP TILES:
+/// add_warp(map, x, y, to_map, to_x, to_y) makes (x, y) a warp tile and
+/// remove_warp(map, x, y) removes it (see WarpPoints). Clients can only
+/// warp from these tiles. Scripts usually add them at load time.
+///
 /// SOLUTION: All Lua state access is protected by lua_mutex_.
 ///
 /// WHY MUTEX FOR LUA:
@@ -41,16 +53,22 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <functional>
+#include "game/TileChangeJournal.h"
+#include "game/WarpPoints.h"
 
 class LuaGameEngine {
 public:
-    LuaGameEngine();
+    /// `warps`: where add_warp / remove_warp go; null, they return false
+    explicit LuaGameEngine(WarpPoints *warps = nullptr);
 
     ~LuaGameEngine();
 
     /// Called when a player moves - triggers Lua on_player_moved event.
+    /// `map_id` is the map the player is on: (x, y) mean nothing without
+    /// it once there are several zones, and set_tile needs it.
     /// Thread-safe: acquires lua_mutex_.
-    void OnPlayerMoved(uint64_t player_id, int x, int y, uint8_t facing);
+    void OnPlayerMoved(uint64_t player_id, uint16_t map_id, int x, int y, uint8_t facing);
 
     /// Process a move command through Lua.
     /// Thread-safe: acquires lua_mutex_.
@@ -65,6 +83,11 @@ public:
     /// Can be called from console ('r' command) or file watcher.
     void ReloadScripts();
 
+    /// Where set_tile / set_tile_blocked send their edits: (map_id, edit),
+    /// false if not queued. Unset, they return false.
+    /// Thread-safe: acquires lua_mutex_.
+    void SetTileEditSink(std::function<bool(uint16_t, const TileEdit &)> sink);
+
 private:
     void SetupLuaEnvironment();
 
@@ -100,4 +123,10 @@ private:
     /// Set once during initialization, then effectively immutable.
     /// The file watcher reads this without locking (safe because immutable).
     std::string active_script_path_ = "../scripts/main.lua";
+
+    /// Tile edit destination (guarded by lua_mutex_, see SetTileEditSink)
+    std::function<bool(uint16_t, const TileEdit &)> tile_edit_sink_;
+
+    /// Warp tiles (thread-safe itself; set once at construction)
+    WarpPoints *const warps_;
 };
\ No newline at end of file
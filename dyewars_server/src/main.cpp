@@ -4,17 +4,48 @@
 /// =======================================
 #include <iostream>
 #include <memory>
-#include <thread>
+#include <sstream>
 #include "core/Log.h"
+#include "core/ServerConfig.h"
 #include "network/BandwidthMonitor.h"
+#include "network/IoBackend.h"
+#include "network/IoContextPool.h"
+#include "network/PacketTrace.h"
+#include "network/ShardLink.h"
+#include "network/UdpSpatialChannel.h"
 #include "server/GameServer.h"
+#include "server/GatewayLink.h"
+#include "server/Zone.h"
+#include "server/ZoneManager.h"
 
 #ifdef _WIN32
 #include <windows.h>
 #endif
 
-int main()
+int main(int argc, char* argv[])
 {
+    ServerConfig config;
+    try
+    {
+        config = ServerConfig::FromArgs(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n" << ServerConfig::Usage();
+        return 1;
+    }
+
+    // May re-exec as the epoll / io_uring sibling build (see IoBackend.h)
+    try
+    {
+        IoBackend::Select(config.io_backend, argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        Log::Error("Network backend: {}", e.what());
+        return 1;
+    }
+
     /// Only for displaying color in terminal
 #ifdef _WIN32
     const HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -25,9 +56,8 @@ int main()
     //    ENABLE_PROCESSED_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
 #endif
 
-    std::unique_ptr<asio::io_context> io_context;
+    std::unique_ptr<IoContextPool> io_pool;
     std::unique_ptr<GameServer> server;
-    std::thread io_thread;
 
     auto start_server = [&]()
     {
@@ -38,15 +68,16 @@ int main()
         }
         try
         {
-            io_context = std::make_unique<asio::io_context>();
-            server = std::make_unique<GameServer>(*io_context);
-            io_thread = std::thread([&]() {
+            io_pool = std::make_unique<IoContextPool>(config.io_threads);
+            server = std::make_unique<GameServer>(*io_pool, config);
+            io_pool->Run([](size_t index) {
 #ifdef _WIN32
-                // Pin IO thread to core 1 (game thread is on core 0)
-                SetThreadAffinityMask(GetCurrentThread(), 2);
-                Log::Info("IO thread pinned to core 1");
+                // Pin IO threads to cores 1..N (game thread is on core 0)
+                SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << (1 + index));
+                Log::Info("IO thread {} pinned to core {}", index, 1 + index);
+#else
+                (void)index;
 #endif
-                io_context->run();
             });
             Log::Info("Server started.");
         }
@@ -54,7 +85,7 @@ int main()
         {
             Log::Error("Failed to start server: {}", e.what());
             server.reset();
-            io_context.reset();
+            io_pool.reset();
         }
     };
     auto stop_server = [&]()
@@ -65,9 +96,9 @@ int main()
             return;
         }
         server->Shutdown();
-        if (io_thread.joinable()) io_thread.join();
+        io_pool->Join();
         server.reset();
-        io_context.reset();
+        io_pool.reset();
         Log::Info("Server stopped.");
     };
 
@@ -110,13 +141,54 @@ int main()
             if (server)
             {
                 std::cout << "Clients: " << server->Clients().Count()
-                    << " Players: " << server->Players().Count() << std::endl;
+                    << " Players: " << server->PlayerCount() << std::endl;
             }
         }
         else if (cmd == "status")
         {
             Log::Info("Server is {}", server ? "running" : "stopped");
         }
+        else if (cmd == "zones")
+        {
+            if (server)
+            {
+                auto& zones = server->Zones();
+                for (size_t map_id = 0; map_id < zones.Count(); map_id++)
+                {
+                    Zone* zone = zones.Get(static_cast<uint16_t>(map_id));
+                    std::cout << "  map " << map_id << ": " << zone->PlayerCount() << " players ("
+                        << zone->BotCount() << " bots)\n";
+                }
+            }
+            else
+            {
+                Log::Warn("Server not running.");
+            }
+        }
+        else if (cmd == "shard")
+        {
+            ShardLink* link = server ? server->Shards() : nullptr;
+            if (!link)
+            {
+                Log::Warn("Not sharded (start with --shard I/N)");
+                continue;
+            }
+            // The layout never changes after startup, safe to read here
+            const ShardLayout& layout = server->Zones().Primary().Layout();
+            std::cout << link->GetStatus() << "\n"
+                << "  owns columns " << layout.Begin(layout.index) << "-" << layout.End(layout.index) - 1
+                << std::endl;
+        }
+        else if (cmd == "gateway")
+        {
+            GatewayLink* link = server ? server->Gateways() : nullptr;
+            if (!link)
+            {
+                Log::Warn("Gateway link off (start with --gateway)");
+                continue;
+            }
+            std::cout << link->GetStatus() << std::endl;
+        }
         else if (cmd == "debug")
         {
             Log::Level = 0;
@@ -176,6 +248,170 @@ int main()
                 Log::Warn("Server not running.");
             }
         }
+        else if (cmd == "trace" || cmd.rfind("trace ", 0) == 0)
+        {
+            // "trace on|off"          -> trace every connection
+            // "trace rate 10"         -> keep 1 of every 10 packets
+            // "trace client 42 [off]" -> trace one connection
+            // "trace dump [file]"     -> write capture (decode with DyeWarsTraceDecode)
+            // "trace clear"           -> drop recorded packets
+            auto& trace = PacketTrace::Instance();
+            std::istringstream args(cmd.substr(5));
+            std::string action, arg1, arg2;
+            args >> action >> arg1 >> arg2;
+            try
+            {
+                if (action == "on" || action == "off")
+                {
+                    trace.SetEnabled(action == "on");
+                }
+                else if (action == "rate")
+                {
+                    trace.SetSampleRate(static_cast<uint32_t>(std::stoul(arg1)));
+                }
+                else if (action == "client")
+                {
+                    const uint64_t client_id = std::stoull(arg1);
+                    if (arg2 == "off") trace.UnwatchClient(client_id);
+                    else if (!trace.WatchClient(client_id))
+                        Log::Warn("Already watching {} clients", PacketTrace::MAX_WATCHED_CLIENTS);
+                }
+                else if (action == "dump")
+                {
+                    const std::string path = arg1.empty() ? "packet_trace.dwtr" : arg1;
+                    const int64_t written = trace.DumpToFile(path);
+                    if (written < 0) Log::Error("Could not open {}", path);
+                    else Log::Info("Dumped {} packets to {}", written, path);
+                }
+                else if (action == "clear")
+                {
+                    trace.Clear();
+                }
+                else if (!action.empty())
+                {
+                    throw std::invalid_argument(action);
+                }
+                std::cout << trace.GetStatus() << std::endl;
+            }
+            catch (...)
+            {
+                std::cout << "Usage: trace [on|off|rate <N>|client <id> [off]|dump [file]|clear]\n";
+            }
+        }
+        else if (cmd == "udp" || cmd.rfind("udp ", 0) == 0)
+        {
+            // "udp"          -> channel status
+            // "udp loss 0.2" -> drop 20% of datagrams (loss injection)
+            UdpSpatialChannel* udp = server ? server->UdpChannel() : nullptr;
+            if (!udp)
+            {
+                Log::Warn("UDP channel is off (start with --udp)");
+                continue;
+            }
+            std::istringstream args(cmd.substr(3));
+            std::string action, value;
+            args >> action >> value;
+            try
+            {
+                if (action == "loss")
+                {
+                    udp->SetLossRate(std::stod(value));
+                }
+                else if (!action.empty())
+                {
+                    throw std::invalid_argument(action);
+                }
+                std::cout << udp->GetStatus() << std::endl;
+            }
+            catch (...)
+            {
+                std::cout << "Usage: udp [loss <0.0-1.0>]\n";
+            }
+        }
+        else if (cmd.rfind("tile ", 0) == 0)
+        {
+            // "tile 0 40 12 2"       -> make (40,12) on map 0 a wall
+            // "tile 0 40 12 block"   -> dynamic blocker on (40,12)
+            // "tile 0 40 12 unblock" -> clear it
+            if (!server)
+            {
+                Log::Warn("Server not running.");
+                continue;
+            }
+            std::istringstream args(cmd.substr(5));
+            int map_id = -1, x = -1, y = -1;
+            std::string value;
+            args >> map_id >> x >> y >> value;
+            try
+            {
+                if (map_id < 0 || map_id > UINT16_MAX || x < 0 || x > INT16_MAX || y < 0 || y > INT16_MAX)
+                {
+                    throw std::invalid_argument("coordinates");
+                }
+                TileEdit edit{static_cast<int16_t>(x), static_cast<int16_t>(y)};
+                if (value == "block" || value == "unblock")
+                {
+                    edit.kind = TileEdit::Kind::Blocked;
+                    edit.value = value == "block" ? 1 : 0;
+                }
+                else
+                {
+                    const int type = std::stoi(value);
+                    if (type < 0 || type > UINT8_MAX) throw std::invalid_argument(value);
+                    edit.value = static_cast<uint8_t>(type);
+                }
+                if (!server->QueueTileEdit(static_cast<uint16_t>(map_id), edit))
+                {
+                    Log::Warn("No map {} (or its edit queue is full)", map_id);
+                }
+            }
+            catch (...)
+            {
+                std::cout << "Usage: tile <map> <x> <y> <type|block|unblock>\n";
+            }
+        }
+        else if (cmd.rfind("warp ", 0) == 0)
+        {
+            // "warp 0 10 10 1 50 50" -> (10,10) on map 0 warps to (50,50) on map 1
+            // "warp 0 10 10 off"     -> no longer a warp tile
+            if (!server)
+            {
+                Log::Warn("Server not running.");
+                continue;
+            }
+            std::istringstream args(cmd.substr(5));
+            int map_id = -1, x = -1, y = -1;
+            std::string to;
+            args >> map_id >> x >> y >> to;
+            auto valid_tile = [](int m, int tx, int ty) {
+                return m >= 0 && m <= UINT16_MAX && tx >= 0 && tx <= INT16_MAX && ty >= 0 && ty <= INT16_MAX;
+            };
+            try
+            {
+                if (!valid_tile(map_id, x, y)) throw std::invalid_argument("coordinates");
+                const auto map = static_cast<uint16_t>(map_id);
+                if (to == "off")
+                {
+                    if (!server->Warps().Remove(map, static_cast<int16_t>(x), static_cast<int16_t>(y)))
+                    {
+                        Log::Warn("({}, {}) on map {} isn't a warp tile", x, y, map_id);
+                    }
+                    continue;
+                }
+                const int to_map = std::stoi(to);
+                int to_x = -1, to_y = -1;
+                args >> to_x >> to_y;
+                if (!valid_tile(to_map, to_x, to_y)) throw std::invalid_argument("destination");
+                server->Warps().Add(map, static_cast<int16_t>(x), static_cast<int16_t>(y),
+                                    {static_cast<uint16_t>(to_map), static_cast<int16_t>(to_x),
+                                     static_cast<int16_t>(to_y)});
+                Log::Info("({}, {}) on map {} warps to ({}, {}) on map {}", x, y, map_id, to_x, to_y, to_map);
+            }
+            catch (...)
+            {
+                std::cout << "Usage: warp <map> <x> <y> <to_map> <to_x> <to_y> | warp <map> <x> <y> off\n";
+            }
+        }
         else if (cmd == "help")
         {
             std::cout << "Commands:\n"
@@ -185,11 +421,21 @@ int main()
                 << "  r/reload   - Reload Lua scripts\n"
                 << "  stats      - Show bandwidth and player stats\n"
                 << "  status     - Show server status\n"
+                << "  zones      - Show players per map\n"
+                << "  shard      - Shard link status (--shard)\n"
+                << "  gateway    - Connected gateways and fan-out (--gateway)\n"
                 << "  debug      - Enable trace logging\n"
                 << "  bots <N>         - Spawn N bots clustered (stress test)\n"
                 << "  bots <N> spread  - Spawn N bots across map (realistic)\n"
                 << "  bots             - Show current bot count\n"
                 << "  rmbots           - Remove all bots\n"
+                << "  trace on|off     - Record all packets to the trace ring\n"
+                << "  trace rate <N>   - Keep 1 of every N traced packets\n"
+                << "  trace client <id> [off] - Trace a single connection\n"
+                << "  trace dump [file]       - Write capture (default packet_trace.dwtr)\n"
+                << "  udp [loss <0.0-1.0>]    - UDP spatial channel status / loss injection\n"
+                << "  tile <map> <x> <y> <type|block|unblock> - Edit a tile (sent to players in view)\n"
+                << "  warp <map> <x> <y> <to_map> <to_x> <to_y> - Make a warp tile (or: ... off)\n"
                 << "  exit       - Stop server and exit\n";
         }
         else if (!cmd.empty())
@@ -0,0 +1,340 @@
+/// =======================================
+/// DyeWarsServer - GatewayProtocol
+///
+/// Wire format of the stream between a gateway process (DyeWarsGateway)
+/// and the game server (--gateway). One TCP connection per gateway carries
+/// every client behind it, so messages name the client they are about.
+///
+/// Every message: [type:1][length:4][body: length bytes]
+///
+///   gateway -> game
+///     ClientOpen    [client:8][resume_token:8][ipLen:1][ip]   handshake passed
+///     ClientFrame   [client:8][payload]                       one client frame, unframed
+///     ClientClosed  [client:8]                                socket gone
+///     ClientPing    [client:8][ms:2]                          RTT of its latest pong
+///   game -> gateway
+///     Deliver       [count:2][client:8 x count][frame]        one framed packet, many clients
+///     Close         [client:8][reasonLen:1][reason]           kick
+///
+/// Client IDs here are the gateway's own; the game maps them to its IDs.
+///
+/// WHY CLIENTPING:
+/// The gateway pings the clients, so only it can measure their RTT. The
+/// game needs it for latency grace on move cooldowns
+/// (Player::GetAdjustedCooldown), so every pong's RTT goes upstream and
+/// lands in the remote ClientConnection's PingTracker, the same rolling
+/// average a direct connection keeps.
+///
+/// WHY DELIVER HAS A RECIPIENT LIST (FAN-OUT):
+/// Clients standing together see the same players move, so they are often
+/// sent byte-identical packets (same S_Player_Spatial batch, same
+/// S_Left_Game). FanOutBatcher merges those: the game writes the packet
+/// once with the list of clients, and the gateway replicates it to each
+/// socket. The simulation host's per-client cost shrinks to 8 bytes.
+///
+/// ORDERING:
+/// A client's packets must arrive in the order they were queued. A merge
+/// that would move a client's packet ahead of one it was queued after
+/// starts a new Deliver instead (see FanOutBatcher::Add).
+///
+/// Header-only, no state shared between threads.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "network/Packets/Protocol.h"
+
+namespace GatewayProtocol {
+    constexpr uint16_t PORT = 8084;  // Game side, loopback only (8082 debug, 8083 UDP)
+
+    enum class Type : uint8_t {
+        ClientOpen = 1,
+        ClientFrame = 2,
+        ClientClosed = 3,
+        Deliver = 4,
+        Close = 5,
+        ClientPing = 6,
+    };
+
+    constexpr size_t HEADER_BYTES = 5;
+
+    /// Upper bound on one message body. Larger lengths mean a corrupt stream.
+    constexpr size_t MAX_BODY_BYTES = 1024 * 1024;
+
+    /// Recipients per Deliver (count is 2 bytes)
+    constexpr size_t MAX_RECIPIENTS = 0xFFFF;
+
+    // =========================================================================
+    // WRITING
+    // =========================================================================
+
+    namespace detail {
+        /// Reserve the header and return where the body starts
+        inline size_t BeginMessage(std::vector<uint8_t> &out, Type type) {
+            Protocol::PacketWriter::WriteByte(out, static_cast<uint8_t>(type));
+            Protocol::PacketWriter::WriteUInt(out, 0);
+            return out.size();
+        }
+
+        /// Patch the length now that the body is written
+        inline void EndMessage(std::vector<uint8_t> &out, size_t body_start) {
+            const auto length = static_cast<uint32_t>(out.size() - body_start);
+            uint8_t *field = out.data() + body_start - 4;
+            field[0] = static_cast<uint8_t>(length >> 24);
+            field[1] = static_cast<uint8_t>(length >> 16);
+            field[2] = static_cast<uint8_t>(length >> 8);
+            field[3] = static_cast<uint8_t>(length);
+        }
+    }
+
+    inline void AppendClientOpen(std::vector<uint8_t> &out, uint64_t client, uint64_t resume_token,
+                                 std::string_view ip) {
+        const size_t body = detail::BeginMessage(out, Type::ClientOpen);
+        Protocol::PacketWriter::WriteUInt64(out, client);
+        Protocol::PacketWriter::WriteUInt64(out, resume_token);
+        const size_t ip_length = std::min<size_t>(ip.size(), 255);
+        Protocol::PacketWriter::WriteByte(out, static_cast<uint8_t>(ip_length));
+        out.insert(out.end(), ip.begin(), ip.begin() + ip_length);
+        detail::EndMessage(out, body);
+    }
+
+    inline void AppendClientFrame(std::vector<uint8_t> &out, uint64_t client, std::span<const uint8_t> payload) {
+        const size_t body = detail::BeginMessage(out, Type::ClientFrame);
+        Protocol::PacketWriter::WriteUInt64(out, client);
+        out.insert(out.end(), payload.begin(), payload.end());
+        detail::EndMessage(out, body);
+    }
+
+    inline void AppendClientClosed(std::vector<uint8_t> &out, uint64_t client) {
+        const size_t body = detail::BeginMessage(out, Type::ClientClosed);
+        Protocol::PacketWriter::WriteUInt64(out, client);
+        detail::EndMessage(out, body);
+    }
+
+    /// `ping_ms` is clamped to 2 bytes
+    inline void AppendClientPing(std::vector<uint8_t> &out, uint64_t client, uint32_t ping_ms) {
+        const size_t body = detail::BeginMessage(out, Type::ClientPing);
+        Protocol::PacketWriter::WriteUInt64(out, client);
+        Protocol::PacketWriter::WriteShort(out, static_cast<uint16_t>(std::min<uint32_t>(ping_ms, 0xFFFF)));
+        detail::EndMessage(out, body);
+    }
+
+    /// `frame` is a complete client frame (header included), sent as is
+    inline void AppendDeliver(std::vector<uint8_t> &out, std::span<const uint64_t> clients,
+                              std::span<const uint8_t> frame) {
+        const size_t body = detail::BeginMessage(out, Type::Deliver);
+        Protocol::PacketWriter::WriteShort(out, static_cast<uint16_t>(clients.size()));
+        for (const uint64_t client : clients) Protocol::PacketWriter::WriteUInt64(out, client);
+        out.insert(out.end(), frame.begin(), frame.end());
+        detail::EndMessage(out, body);
+    }
+
+    inline void AppendClose(std::vector<uint8_t> &out, uint64_t client, std::string_view reason) {
+        const size_t body = detail::BeginMessage(out, Type::Close);
+        Protocol::PacketWriter::WriteUInt64(out, client);
+        const size_t reason_length = std::min<size_t>(reason.size(), 255);
+        Protocol::PacketWriter::WriteByte(out, static_cast<uint8_t>(reason_length));
+        out.insert(out.end(), reason.begin(), reason.begin() + reason_length);
+        detail::EndMessage(out, body);
+    }
+
+    // =========================================================================
+    // READING
+    // =========================================================================
+
+    /// One message, pointing into the receive buffer
+    struct Message {
+        Type type;
+        std::span<const uint8_t> body;
+    };
+
+    enum class ParseStatus : uint8_t {
+        NeedMore,  // Not a whole message yet
+        Ready,     // `message` and `consumed` are set
+        Corrupt,   // Unknown type or oversized length - drop the stream
+    };
+
+    /// Look at the start of `stream`. On Ready the message is
+    /// stream[0, consumed); its body stays valid until those bytes are dropped.
+    inline ParseStatus Parse(std::span<const uint8_t> stream, Message &message, size_t &consumed) {
+        if (stream.size() < HEADER_BYTES) return ParseStatus::NeedMore;
+
+        const uint8_t type = stream[0];
+        if (type < static_cast<uint8_t>(Type::ClientOpen) || type > static_cast<uint8_t>(Type::ClientPing)) {
+            return ParseStatus::Corrupt;
+        }
+        size_t offset = 1;
+        const uint32_t length = Protocol::PacketReader::ReadUInt(stream, offset);
+        if (length > MAX_BODY_BYTES) return ParseStatus::Corrupt;
+        if (stream.size() - HEADER_BYTES < length) return ParseStatus::NeedMore;
+
+        message.type = static_cast<Type>(type);
+        message.body = stream.subspan(HEADER_BYTES, length);
+        consumed = HEADER_BYTES + length;
+        return ParseStatus::Ready;
+    }
+
+    struct ClientOpen {
+        uint64_t client;
+        uint64_t resume_token;
+        std::string ip;
+    };
+
+    struct Deliver {
+        std::vector<uint64_t> clients;
+        std::span<const uint8_t> frame;  // Points into the message body
+    };
+
+    struct Close {
+        uint64_t client;
+        std::string reason;
+    };
+
+    struct ClientPing {
+        uint64_t client;
+        uint16_t ping_ms;
+    };
+
+    // Body decoders: nullopt for a truncated body
+
+    inline std::optional<ClientOpen> DecodeClientOpen(std::span<const uint8_t> body) {
+        try {
+            size_t offset = 0;
+            ClientOpen open;
+            open.client = Protocol::PacketReader::ReadUInt64(body, offset);
+            open.resume_token = Protocol::PacketReader::ReadUInt64(body, offset);
+            const uint8_t ip_length = Protocol::PacketReader::ReadByte(body, offset);
+            if (body.size() - offset != ip_length) return std::nullopt;
+            open.ip.assign(body.begin() + offset, body.end());
+            return open;
+        } catch (const std::out_of_range &) {
+            return std::nullopt;
+        }
+    }
+
+    /// Client ID of ClientFrame / ClientClosed; `rest` gets what follows it
+    inline std::optional<uint64_t> DecodeClient(std::span<const uint8_t> body, std::span<const uint8_t> &rest) {
+        if (body.size() < 8) return std::nullopt;
+        size_t offset = 0;
+        const uint64_t client = Protocol::PacketReader::ReadUInt64(body, offset);
+        rest = body.subspan(offset);
+        return client;
+    }
+
+    inline std::optional<Deliver> DecodeDeliver(std::span<const uint8_t> body) {
+        try {
+            size_t offset = 0;
+            Deliver deliver;
+            const uint16_t count = Protocol::PacketReader::ReadShort(body, offset);
+            deliver.clients.reserve(count);
+            for (uint16_t i = 0; i < count; i++) {
+                deliver.clients.push_back(Protocol::PacketReader::ReadUInt64(body, offset));
+            }
+            deliver.frame = body.subspan(offset);
+            if (deliver.frame.size() < Protocol::HEADER_SIZE) return std::nullopt;
+            return deliver;
+        } catch (const std::out_of_range &) {
+            return std::nullopt;
+        }
+    }
+
+    inline std::optional<Close> DecodeClose(std::span<const uint8_t> body) {
+        try {
+            size_t offset = 0;
+            Close close;
+            close.client = Protocol::PacketReader::ReadUInt64(body, offset);
+            const uint8_t reason_length = Protocol::PacketReader::ReadByte(body, offset);
+            if (body.size() - offset != reason_length) return std::nullopt;
+            close.reason.assign(body.begin() + offset, body.end());
+            return close;
+        } catch (const std::out_of_range &) {
+            return std::nullopt;
+        }
+    }
+
+    inline std::optional<ClientPing> DecodeClientPing(std::span<const uint8_t> body) {
+        if (body.size() != 10) return std::nullopt;
+        size_t offset = 0;
+        ClientPing ping;
+        ping.client = Protocol::PacketReader::ReadUInt64(body, offset);
+        ping.ping_ms = Protocol::PacketReader::ReadShort(body, offset);
+        return ping;
+    }
+
+    // =========================================================================
+    // FAN-OUT (game side)
+    // =========================================================================
+
+    /// Collects (client, packet) pairs queued since the last flush and
+    /// writes them as Deliver messages, one per distinct packet where the
+    /// per-client order allows it. Not thread-safe: the owner swaps it out
+    /// under its own lock and flushes on one thread.
+    class FanOutBatcher {
+    public:
+        /// Queue `frame` for `client` after everything queued for it before
+        void Add(uint64_t client, std::shared_ptr<std::vector<uint8_t>> frame) {
+            const std::string_view key(reinterpret_cast<const char *>(frame->data()), frame->size());
+
+            // Earliest group this client may join without overtaking its own packets
+            size_t min_group = 0;
+            if (auto last = last_group_.find(client); last != last_group_.end()) min_group = last->second;
+
+            size_t group_index;
+            auto same = by_content_.find(key);
+            if (same != by_content_.end() && same->second >= min_group &&
+                groups_[same->second].clients.size() < MAX_RECIPIENTS) {
+                group_index = same->second;
+            } else {
+                group_index = groups_.size();
+                groups_.push_back(Group{std::move(frame), {}});
+                // The key views the group's own bytes, which live as long as the group
+                const auto &bytes = *groups_.back().frame;
+                by_content_[std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size())] =
+                        group_index;
+            }
+            groups_[group_index].clients.push_back(client);
+            last_group_[client] = group_index;
+            packets_++;
+        }
+
+        bool Empty() const { return groups_.empty(); }
+
+        /// Packets added since the last Write (one per client per packet)
+        size_t Packets() const { return packets_; }
+
+        /// Deliver messages the next Write produces
+        size_t Messages() const { return groups_.size(); }
+
+        /// Append one Deliver per group to `out` and reset
+        void Write(std::vector<uint8_t> &out) {
+            for (const auto &group : groups_) {
+                AppendDeliver(out, group.clients, *group.frame);
+            }
+            by_content_.clear();
+            last_group_.clear();
+            groups_.clear();
+            packets_ = 0;
+        }
+
+    private:
+        struct Group {
+            std::shared_ptr<std::vector<uint8_t>> frame;
+            std::vector<uint64_t> clients;
+        };
+
+        std::vector<Group> groups_;
+        std::unordered_map<std::string_view, size_t> by_content_;  // Newest group per packet
+        std::unordered_map<uint64_t, size_t> last_group_;          // Newest group per client
+        size_t packets_ = 0;
+    };
+}
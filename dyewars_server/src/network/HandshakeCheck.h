@@ -0,0 +1,77 @@
+/// =======================================
+/// DyeWarsServer - HandshakeCheck
+///
+/// Validation of a client's first frame (C_Handshake_Request, or
+/// C_Shard_Resume after a shard redirect). Shared by ClientConnection and
+/// the gateway (src/gateway), which both terminate client sockets and must
+/// accept exactly the same handshakes.
+///
+/// Expected format:
+///   Byte 0:     Opcode (0x00, or 0xF5 for C_Shard_Resume)
+///   Bytes 1-2:  Protocol version (0x00 0x01)
+///   Bytes 3-6:  Client magic ("DYEW" = 0x44 0x59 0x45 0x57)
+///   Bytes 7-14: Shard token (C_Shard_Resume only)
+///
+/// Pure function - safe from any thread.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <format>
+#include <span>
+#include <string>
+#include "network/Packets/Protocol.h"
+#include "network/Packets/OpCodes.h"
+
+namespace HandshakeCheck {
+    struct Result {
+        bool ok = false;
+        uint64_t resume_token = 0;  // Nonzero for C_Shard_Resume
+        std::string error;          // Why it was rejected (for logs)
+    };
+
+    inline Result Validate(std::span<const uint8_t> data) {
+        const auto &op = Protocol::Opcode::Connection::Client::C_Handshake_Request;
+        const auto &resume_op = Protocol::Opcode::Connection::Client::C_Shard_Resume;
+
+        // A client redirected by another shard (S_Shard_Redirect) handshakes
+        // with the token appended
+        const bool resume = !data.empty() && data[0] == resume_op.op;
+        const uint8_t expected_size = resume ? resume_op.payloadSize : op.payloadSize;
+
+        Result result;
+        if (data.size() != expected_size) {
+            result.error = std::format("invalid packet size (got {}, expected {})", data.size(), expected_size);
+            return result;
+        }
+
+        size_t offset = 0;
+        const uint8_t opcode = Protocol::PacketReader::ReadByte(data, offset);
+        const uint16_t version = Protocol::PacketReader::ReadShort(data, offset);
+        const uint32_t magic = Protocol::PacketReader::ReadUInt(data, offset);
+
+        if (!resume && opcode != op.op) {
+            result.error = std::format("expected opcode 0x{:02X}, got 0x{:02X}", op.op, opcode);
+            return result;
+        }
+
+        if (version != Protocol::VERSION) {
+            result.error = std::format("version mismatch (client: 0x{:04X}, server: 0x{:04X})",
+                                       version, Protocol::VERSION);
+            return result;
+        }
+
+        if (magic != Protocol::CLIENT_MAGIC) {
+            result.error = "invalid client identifier";
+            return result;
+        }
+
+        if (resume) {
+            result.resume_token = Protocol::PacketReader::ReadUInt64(data, offset);
+        }
+        result.ok = true;
+        return result;
+    }
+}
@@ -0,0 +1,115 @@
+/// =======================================
+/// DyeWarsServer - IoBackend
+/// =======================================
+#include "IoBackend.h"
+#include "core/Log.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <filesystem>
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef __linux__
+    constexpr const char *EPOLL_BINARY = "DyeWarsServer";
+    constexpr const char *IO_URING_BINARY = "DyeWarsServerUring";
+
+    /// Replace this process with the sibling build, forcing its backend so
+    /// it can't bounce straight back.
+    [[noreturn]] void ExecSibling(const char *binary, const char *backend, int argc, char *argv[]) {
+        const auto path = std::filesystem::read_symlink("/proc/self/exe").parent_path() / binary;
+        if (!std::filesystem::exists(path)) {
+            throw std::runtime_error(path.string() + " not found (build with -DENABLE_IO_URING=ON)");
+        }
+
+        std::vector<std::string> args = {path.string()};
+        for (int i = 1; i < argc; i++) {
+            if (std::string(argv[i]) == "--io-backend") {
+                i++;  // Drop the old value, we append our own
+                continue;
+            }
+            args.emplace_back(argv[i]);
+        }
+        args.emplace_back("--io-backend");
+        args.emplace_back(backend);
+
+        std::vector<char *> exec_argv;
+        for (auto &arg: args) exec_argv.push_back(arg.data());
+        exec_argv.push_back(nullptr);
+
+        Log::Info("Switching to {} backend: {}", backend, path.string());
+        std::cout.flush();  // execv discards anything still buffered
+        execv(path.c_str(), exec_argv.data());
+        throw std::runtime_error("execv " + path.string() + " failed");
+    }
+#endif
+}
+
+namespace IoBackend {
+    bool CompiledWithIoUring() {
+#if defined(ASIO_HAS_IO_URING) && defined(ASIO_DISABLE_EPOLL)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const char *Compiled() {
+        if (CompiledWithIoUring()) return "io_uring";
+#ifdef __linux__
+        return "epoll";
+#else
+        return "native";
+#endif
+    }
+
+    bool KernelSupportsIoUring() {
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+        io_uring_params params{};
+        const long fd = syscall(__NR_io_uring_setup, 4, &params);
+        if (fd < 0) return false;
+        close(static_cast<int>(fd));
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void Select(ServerConfig::IoBackend requested, int argc, char *argv[]) {
+        using Choice = ServerConfig::IoBackend;
+
+#ifdef __linux__
+        if (CompiledWithIoUring()) {
+            if (requested == Choice::Epoll) {
+                ExecSibling(EPOLL_BINARY, "epoll", argc, argv);
+            }
+            if (!KernelSupportsIoUring()) {
+                if (requested == Choice::IoUring) {
+                    throw std::runtime_error("io_uring requested but the kernel refused io_uring_setup");
+                }
+                Log::Warn("io_uring unavailable on this kernel, falling back to epoll");
+                ExecSibling(EPOLL_BINARY, "epoll", argc, argv);
+            }
+        } else if (requested == Choice::IoUring) {
+            if (!KernelSupportsIoUring()) {
+                throw std::runtime_error("io_uring requested but the kernel refused io_uring_setup");
+            }
+            ExecSibling(IO_URING_BINARY, "io_uring", argc, argv);
+        }
+#else
+        (void)argc;
+        (void)argv;
+        if (requested == Choice::IoUring) {
+            throw std::runtime_error("io_uring is only available on Linux");
+        }
+#endif
+        Log::Info("Network backend: {}", Compiled());
+    }
+}
@@ -0,0 +1,42 @@
+/// =======================================
+/// DyeWarsServer - IoBackend
+///
+/// Chooses between the epoll and io_uring socket reactors at startup.
+///
+/// WHY A SECOND BINARY INSTEAD OF A RUNTIME SWITCH:
+/// asio picks its reactor at compile time (ASIO_HAS_IO_URING +
+/// ASIO_DISABLE_EPOLL), and the choice changes the layout of every socket
+/// and io_context type. Both reactors can't live in one process without
+/// breaking the one-definition rule. So -DENABLE_IO_URING=ON builds
+/// DyeWarsServerUring next to DyeWarsServer, from the same sources, and
+/// Select() re-executes the sibling binary when the requested backend is
+/// the other one. Console, config and behaviour are identical.
+///
+/// FALLBACK:
+/// io_uring can be missing even on new kernels (kernel.io_uring_disabled,
+/// seccomp in containers). The io_uring build probes with a throwaway
+/// ring before asio touches it and, under --io-backend auto, hands over
+/// to the epoll build instead of failing on the first io_context.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include "core/ServerConfig.h"
+
+namespace IoBackend {
+    /// Reactor this binary was compiled with: "io_uring", "epoll" (Linux),
+    /// or "native" (IOCP / kqueue elsewhere)
+    const char *Compiled();
+
+    bool CompiledWithIoUring();
+
+    /// Whether this kernel lets us create an io_uring (false off Linux)
+    bool KernelSupportsIoUring();
+
+    /// Make the requested backend the running one.
+    /// Returns normally when this process should carry on. May replace the
+    /// process with the sibling build (never returns in that case).
+    /// Throws std::runtime_error if the request can't be met.
+    void Select(ServerConfig::IoBackend requested, int argc, char *argv[]);
+}
@@ -0,0 +1,67 @@
+/// =======================================
+/// DyeWarsServer - IoContextPool
+/// =======================================
+#include "IoContextPool.h"
+#include "core/Log.h"
+
+IoContextPool::IoContextPool(size_t thread_count) {
+    if (thread_count == 0) thread_count = 1;
+
+    contexts_.reserve(thread_count);
+    work_guards_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; i++) {
+        // Concurrency hint 1: each context is run by exactly one thread.
+        // Posting to it from other threads (game thread sends) stays safe.
+        contexts_.push_back(std::make_unique<asio::io_context>(1));
+        work_guards_.push_back(asio::make_work_guard(*contexts_.back()));
+        wheels_.push_back(std::make_unique<TimerWheel>());
+        wheel_timers_.push_back(std::make_unique<asio::steady_timer>(*contexts_.back()));
+    }
+}
+
+IoContextPool::~IoContextPool() {
+    Stop();
+    Join();
+}
+
+void IoContextPool::Run(const std::function<void(size_t)> &on_thread_start) {
+    if (!threads_.empty()) return;
+
+    wheel_epoch_ = std::chrono::steady_clock::now();
+    threads_.reserve(contexts_.size());
+    for (size_t i = 0; i < contexts_.size(); i++) {
+        threads_.emplace_back([this, i, on_thread_start]() {
+            if (on_thread_start) on_thread_start(i);
+            ScheduleWheelTick(i);
+            contexts_[i]->run();
+        });
+    }
+    Log::Info("IO pool running with {} thread(s)", contexts_.size());
+}
+
+void IoContextPool::ScheduleWheelTick(size_t index) {
+    // Absolute deadlines from a shared epoch: a late tick doesn't push every
+    // later tick back, and AdvanceTo catches up on whatever was missed.
+    auto &timer = *wheel_timers_[index];
+    timer.expires_at(wheel_epoch_ + TimerWheel::TICK * (wheels_[index]->CurrentTick() + 1));
+    timer.async_wait([this, index](const std::error_code &ec) {
+        if (ec) return;
+        const auto elapsed = std::chrono::steady_clock::now() - wheel_epoch_;
+        wheels_[index]->AdvanceTo(static_cast<uint64_t>(elapsed / TimerWheel::TICK));
+        ScheduleWheelTick(index);
+    });
+}
+
+void IoContextPool::Stop() {
+    work_guards_.clear();
+    for (auto &context : contexts_) {
+        context->stop();
+    }
+}
+
+void IoContextPool::Join() {
+    for (auto &thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+    threads_.clear();
+}
@@ -0,0 +1,105 @@
+/// =======================================
+/// DyeWarsServer - IoContextPool
+///
+/// Pool of io_contexts, one per IO thread. New connections are assigned
+/// to a context round-robin and stay on it for their whole lifetime.
+///
+/// WHY ONE CONTEXT PER THREAD (NOT ONE SHARED CONTEXT + STRANDS):
+/// Every ClientConnection was written for "IO thread only" access to its
+/// receive ring, write_in_progress_ flag, handshake state and PingTracker.
+/// With one io_context run by one thread, all of a connection's handlers
+/// still execute on exactly one thread - the same guarantee as before, no
+/// strand wrapping needed on every async call. A shared context with N
+/// threads would run a connection's handlers on any thread and would need
+/// a strand per connection to restore that guarantee.
+///
+/// Tradeoff: no work stealing. A thread with a few very busy connections
+/// can't hand them off. With hundreds of connections per thread, the
+/// round-robin spread evens out.
+///
+/// CONTEXT 0 ("primary"):
+/// Also hosts the game acceptor and the debug HTTP server. It takes part in
+/// the round-robin like the others.
+///
+/// TIMER WHEELS:
+/// Each context has a TimerWheel for its connections' handshake, ping and
+/// idle deadlines, advanced by one steady_timer every TimerWheel::TICK.
+/// That's one kernel timer per IO thread no matter how many connections.
+///
+/// THREAD SAFETY:
+/// Next()/NextIndex() are safe from any thread (atomic counter). Wheel(i)
+/// may only be used on context i's thread. Run/Stop/Join are called from
+/// the main thread only.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "TimerWheel.h"
+
+class IoContextPool {
+public:
+    /// Create thread_count io_contexts (at least 1). Threads start in Run().
+    explicit IoContextPool(size_t thread_count);
+
+    ~IoContextPool();
+
+    IoContextPool(const IoContextPool &) = delete;
+    IoContextPool &operator=(const IoContextPool &) = delete;
+
+    /// Context for the acceptor and debug HTTP server
+    asio::io_context &Primary() { return *contexts_[0]; }
+
+    /// Index of the context for the next new connection (round-robin, any thread)
+    size_t NextIndex() {
+        return next_.fetch_add(1, std::memory_order_relaxed) % contexts_.size();
+    }
+
+    /// Context for the next new connection (round-robin, any thread)
+    asio::io_context &Next() { return *contexts_[NextIndex()]; }
+
+    asio::io_context &Context(size_t index) { return *contexts_[index]; }
+
+    /// Timer wheel of context `index`. Only touch it from that context's thread.
+    TimerWheel &Wheel(size_t index) { return *wheels_[index]; }
+
+    /// Number of IO threads / contexts
+    size_t Size() const { return contexts_.size(); }
+
+    /// Start one thread per context.
+    /// @param on_thread_start Called on each IO thread before it runs its
+    ///        context (index 0..Size()-1), e.g. for CPU pinning. Optional.
+    void Run(const std::function<void(size_t)> &on_thread_start = {});
+
+    /// Stop all contexts. Pending handlers are abandoned. Any thread.
+    void Stop();
+
+    /// Wait for all IO threads to exit (call after Stop, from main thread)
+    void Join();
+
+private:
+    using WorkGuard = asio::executor_work_guard<asio::io_context::executor_type>;
+
+    /// Advance wheel `index` once per TICK (runs on its IO thread)
+    void ScheduleWheelTick(size_t index);
+
+    std::vector<std::unique_ptr<asio::io_context>> contexts_;
+
+    /// One wheel + driving timer per context. Declared after contexts_ so
+    /// the timers are destroyed before the contexts they belong to.
+    std::vector<std::unique_ptr<TimerWheel>> wheels_;
+    std::vector<std::unique_ptr<asio::steady_timer>> wheel_timers_;
+    std::chrono::steady_clock::time_point wheel_epoch_;
+
+    /// Keeps each context's run() from returning while it has no connections yet
+    std::vector<WorkGuard> work_guards_;
+
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_{0};
+};
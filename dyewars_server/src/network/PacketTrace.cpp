@@ -0,0 +1,150 @@
+/// =======================================
+/// DyeWarsServer - PacketTrace
+/// =======================================
+#include "PacketTrace.h"
+#include "network/Packets/Protocol.h"
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <vector>
+
+void PacketTrace::Write(PacketTraceFormat::Direction direction, uint64_t client_id,
+                        std::span<const uint8_t> payload) {
+    const uint64_t ticket = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots_[ticket & (CAPACITY - 1)];
+
+    // Mark busy (odd). The release fence keeps the field stores below from
+    // becoming visible before the busy mark.
+    slot.sequence.store(ticket * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    const size_t captured = std::min<size_t>(payload.size(), PacketTraceFormat::CAPTURE_BYTES);
+
+    slot.timestamp_us.store(static_cast<uint64_t>(now_us), std::memory_order_relaxed);
+    slot.client_id.store(client_id, std::memory_order_relaxed);
+    slot.size_and_direction.store(
+            (static_cast<uint32_t>(direction) << 24) |
+            (static_cast<uint32_t>(captured) << 16) |
+            static_cast<uint32_t>(std::min<size_t>(payload.size(), 0xFFFF)),
+            std::memory_order_relaxed);
+
+    std::array<uint64_t, CAPTURE_WORDS> words{};
+    std::memcpy(words.data(), payload.data(), captured);
+    for (size_t i = 0; i < CAPTURE_WORDS; i++) {
+        slot.bytes[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    // Publish (even)
+    slot.sequence.store(ticket * 2 + 2, std::memory_order_release);
+}
+
+bool PacketTrace::WatchClient(uint64_t client_id) {
+    if (client_id == 0) return false;
+    if (IsWatched(client_id)) return true;
+
+    for (auto &watched : watched_) {
+        uint64_t expected = 0;
+        if (watched.compare_exchange_strong(expected, client_id, std::memory_order_relaxed)) {
+            watched_count_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void PacketTrace::UnwatchClient(uint64_t client_id) {
+    for (auto &watched : watched_) {
+        uint64_t expected = client_id;
+        if (watched.compare_exchange_strong(expected, 0, std::memory_order_relaxed)) {
+            watched_count_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void PacketTrace::Clear() {
+    // Not synchronized with writers - a record written during Clear() may
+    // survive. Fine for a debug tool.
+    for (auto &slot : slots_) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+int64_t PacketTrace::DumpToFile(const std::string &path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return -1;
+
+    using namespace Protocol::PacketWriter;
+
+    // Records are collected first so the header can carry the final count
+    std::vector<uint8_t> records;
+    uint32_t record_count = 0;
+
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t first = head > CAPACITY ? head - CAPACITY : 0;
+
+    for (uint64_t ticket = first; ticket < head; ticket++) {
+        const Slot &slot = slots_[ticket & (CAPACITY - 1)];
+
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != ticket * 2 + 2) continue;  // Empty, being written, or already lapped
+
+        const uint64_t timestamp_us = slot.timestamp_us.load(std::memory_order_relaxed);
+        const uint64_t client_id = slot.client_id.load(std::memory_order_relaxed);
+        const uint32_t packed = slot.size_and_direction.load(std::memory_order_relaxed);
+        std::array<uint64_t, CAPTURE_WORDS> words{};
+        for (size_t i = 0; i < CAPTURE_WORDS; i++) {
+            words[i] = slot.bytes[i].load(std::memory_order_relaxed);
+        }
+
+        // Re-check: if a writer claimed the slot while we copied, drop it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+
+        const auto direction = static_cast<uint8_t>(packed >> 24);
+        const auto captured = static_cast<uint16_t>((packed >> 16) & 0xFF);
+        const auto size = static_cast<uint16_t>(packed & 0xFFFF);
+
+        WriteUInt64(records, ticket);
+        WriteUInt64(records, timestamp_us);
+        WriteUInt64(records, client_id);
+        WriteByte(records, direction);
+        WriteShort(records, size);
+        WriteShort(records, captured);
+        const auto *bytes = reinterpret_cast<const uint8_t *>(words.data());
+        records.insert(records.end(), bytes, bytes + captured);
+        record_count++;
+    }
+
+    std::vector<uint8_t> header;
+    WriteUInt(header, PacketTraceFormat::FILE_MAGIC);
+    WriteShort(header, PacketTraceFormat::VERSION);
+    WriteShort(header, PacketTraceFormat::CAPTURE_BYTES);
+    WriteUInt(header, record_count);
+
+    file.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+    file.write(reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>(records.size()));
+    return record_count;
+}
+
+std::string PacketTrace::GetStatus() const {
+    return std::format("Packet trace: {} | watched clients: {} | sample 1/{} | recorded: {}",
+                       IsEnabled() ? "ON (all clients)" : "OFF",
+                       watched_count_.load(std::memory_order_relaxed),
+                       GetSampleRate(), GetRecordedCount());
+}
+
+std::string PacketTrace::GetStatusJson() const {
+    std::string watched;
+    for (const auto &slot : watched_) {
+        const uint64_t id = slot.load(std::memory_order_relaxed);
+        if (id == 0) continue;
+        if (!watched.empty()) watched += ",";
+        watched += std::to_string(id);
+    }
+    return std::format(R"({{"enabled":{},"sampleRate":{},"recorded":{},"capacity":{},"watched":[{}]}})",
+                       IsEnabled() ? "true" : "false", GetSampleRate(), GetRecordedCount(),
+                       CAPACITY, watched);
+}
@@ -0,0 +1,174 @@
+/// =======================================
+/// DyeWarsServer - PacketTrace
+///
+/// In-memory flight recorder for packets, replacing the old per-packet
+/// std::cout dump in ClientConnection.
+///
+/// WHY NOT JUST LOG:
+/// The old dump formatted every received packet with iostreams and flushed
+/// with std::endl on the IO thread. With one IO thread, a slow terminal
+/// throttled the whole network stack. Tracing now costs one relaxed atomic
+/// load when it's off, and a handful of relaxed stores when it's on.
+/// Nothing is formatted until someone dumps the ring to a file.
+///
+/// USAGE:
+///   Console:  trace on | off | rate <N> | client <id> [off] | dump [file] | clear
+///   HTTP:     GET /trace?on, /trace?off, /trace?rate=N, /trace?client=ID,
+///             /trace?client=ID&off, /trace?dump   (port 8082)
+///   Decode:   DyeWarsTraceDecode packet_trace.dwtr
+///
+/// THREAD SAFETY ANALYSIS:
+/// -----------------------
+/// Writers (multiple producers):
+///   - IO thread: Record() for every received frame
+///   - Game thread: Record() for every QueueRaw() (outgoing)
+/// Reader (single consumer):
+///   - Console thread or debug HTTP handler: DumpToFile()
+///
+/// SOLUTION: Lock-free ring with a per-slot sequence number (seqlock).
+///   1. Writer claims a ticket with head_.fetch_add(1) - no two writers
+///      get the same ticket, so no lock is needed.
+///   2. Writer marks the slot "busy" (odd sequence), writes the fields as
+///      relaxed atomics, then publishes it (even sequence, release).
+///   3. Reader checks the sequence before and after copying. If it changed
+///      or is odd, the slot was being overwritten and is skipped.
+/// The ring overwrites the oldest records - a dump always shows the most
+/// recent CAPACITY packets.
+///
+/// Fields are stored as atomics (relaxed) rather than plain memory so the
+/// concurrent read during a dump is not a data race (keeps TSAN quiet).
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+
+/// On-disk capture format, shared by the server (writer) and the
+/// DyeWarsTraceDecode tool (reader). All integers are big-endian, same as
+/// the wire protocol, so PacketWriter/PacketReader can be reused.
+///
+///   File:   [magic:4 "DWTR"][version:2][captureBytes:2][recordCount:4][records...]
+///   Record: [seq:8][timestampUs:8][clientId:8][direction:1][size:2][captured:2][bytes...]
+namespace PacketTraceFormat {
+    constexpr uint32_t FILE_MAGIC = 0x44575452;  // "DWTR"
+    constexpr uint16_t VERSION = 1;
+
+    /// Bytes of each payload kept (opcode + start of the body).
+    /// Enough for every fixed-size packet and the first few entries of a batch.
+    constexpr uint16_t CAPTURE_BYTES = 64;
+
+    enum class Direction : uint8_t {
+        ClientToServer = 0,
+        ServerToClient = 1
+    };
+}
+
+class PacketTrace {
+public:
+    /// Number of records kept (power of two for cheap masking)
+    static constexpr size_t CAPACITY = 8192;
+
+    /// Max clients that can be watched individually while global tracing is off
+    static constexpr size_t MAX_WATCHED_CLIENTS = 8;
+
+    static PacketTrace &Instance() {
+        static PacketTrace instance;
+        return instance;
+    }
+
+    // =========================================================================
+    // HOT PATH (IO thread + game thread)
+    // =========================================================================
+
+    /// Record a packet payload (opcode first, header excluded) if tracing
+    /// is enabled for this client and the sampler selects it.
+    void Record(PacketTraceFormat::Direction direction, uint64_t client_id,
+                std::span<const uint8_t> payload) {
+        // Fast exit - this is all it costs when tracing is off
+        const bool trace_all = enabled_.load(std::memory_order_relaxed);
+        if (!trace_all) {
+            if (watched_count_.load(std::memory_order_relaxed) == 0) return;
+            if (!IsWatched(client_id)) return;
+        }
+
+        const uint32_t rate = sample_rate_.load(std::memory_order_relaxed);
+        if (rate > 1 && sample_counter_.fetch_add(1, std::memory_order_relaxed) % rate != 0) return;
+
+        Write(direction, client_id, payload);
+    }
+
+    // =========================================================================
+    // CONTROL (console / debug HTTP, any thread)
+    // =========================================================================
+
+    /// Trace every connection
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /// Keep 1 of every N selected packets (1 = all)
+    void SetSampleRate(uint32_t rate) { sample_rate_.store(rate == 0 ? 1 : rate, std::memory_order_relaxed); }
+    uint32_t GetSampleRate() const { return sample_rate_.load(std::memory_order_relaxed); }
+
+    /// Trace a single connection even when global tracing is off.
+    /// Returns false if all MAX_WATCHED_CLIENTS slots are taken.
+    bool WatchClient(uint64_t client_id);
+
+    /// Stop tracing a single connection
+    void UnwatchClient(uint64_t client_id);
+
+    /// Drop all recorded packets
+    void Clear();
+
+    /// Write the current ring contents to a capture file.
+    /// Returns number of records written, or -1 if the file couldn't be opened.
+    int64_t DumpToFile(const std::string &path) const;
+
+    /// Total packets recorded since start (including overwritten ones)
+    uint64_t GetRecordedCount() const { return head_.load(std::memory_order_relaxed); }
+
+    /// One-line status for console / JSON for debug HTTP
+    std::string GetStatus() const;
+    std::string GetStatusJson() const;
+
+private:
+    PacketTrace() = default;
+
+    /// Captured payload stored as 64-bit words so every field is atomic
+    static constexpr size_t CAPTURE_WORDS = PacketTraceFormat::CAPTURE_BYTES / sizeof(uint64_t);
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // 0 = empty, odd = being written, even = 2*(ticket+1)
+        std::atomic<uint64_t> timestamp_us{0};
+        std::atomic<uint64_t> client_id{0};
+        std::atomic<uint32_t> size_and_direction{0};  // [direction:8][captured:8][size:16]
+        std::array<std::atomic<uint64_t>, CAPTURE_WORDS> bytes{};
+    };
+
+    void Write(PacketTraceFormat::Direction direction, uint64_t client_id,
+               std::span<const uint8_t> payload);
+
+    bool IsWatched(uint64_t client_id) const {
+        for (const auto &watched : watched_) {
+            if (watched.load(std::memory_order_relaxed) == client_id) return true;
+        }
+        return false;
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint32_t> sample_rate_{1};
+    std::atomic<uint64_t> sample_counter_{0};
+
+    /// Client IDs traced individually. 0 = empty slot (client IDs are never 0).
+    std::array<std::atomic<uint64_t>, MAX_WATCHED_CLIENTS> watched_{};
+    std::atomic<uint32_t> watched_count_{0};
+
+    /// Next ticket to hand out. Slot index = ticket % CAPACITY.
+    std::atomic<uint64_t> head_{0};
+    std::array<Slot, CAPACITY> slots_{};
+};
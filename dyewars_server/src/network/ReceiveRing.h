@@ -0,0 +1,129 @@
+/// =======================================
+/// DyeWarsServer - ReceiveRing
+///
+/// Fixed-size receive buffer owned by each ClientConnection.
+/// The IO thread fills it with async_read_some() and then parses every
+/// complete [MAGIC][size][payload] frame in place.
+///
+/// WHY NOT ONE async_read PER HEADER/PAYLOAD:
+/// The old receive path issued two async_read calls per packet (4-byte
+/// header, then payload) and heap-allocated a fresh vector for every
+/// payload. A burst of 10 moves cost 20 completions and 10 allocations.
+/// With the ring, one completion can deliver many frames and nothing
+/// is allocated after the connection is created.
+///
+/// WRAPAROUND:
+/// Frames are handed to PacketHandler as spans, so a frame must be
+/// contiguous in memory. Instead of letting a frame wrap around the end
+/// of the storage, the partial tail (always smaller than one frame) is
+/// moved back to the front whenever the free space at the end can no
+/// longer hold a maximum-size frame. Capacity is two maximum frames, so
+/// that copy is rare and never larger than a single frame.
+///
+/// THREAD SAFETY:
+/// IO thread only. The ring belongs to exactly one connection and is only
+/// touched from that connection's ASIO callbacks.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+#include "network/Packets/Protocol.h"
+
+class ReceiveRing {
+public:
+    /// Largest frame the protocol allows: header + (MAX_PAYLOAD_SIZE - 1)
+    static constexpr size_t MAX_FRAME_SIZE = Protocol::HEADER_SIZE + Protocol::MAX_PAYLOAD_SIZE;
+
+    /// Two maximum frames: one being parsed, one being received behind it
+    static constexpr size_t CAPACITY = MAX_FRAME_SIZE * 2;
+
+    /// Result of looking at the bytes at the read position
+    enum class FrameStatus : uint8_t {
+        NeedMore,   // Not enough bytes for a header or for the full payload yet
+        BadMagic,   // Header present but magic bytes are wrong
+        BadSize,    // Header present but size is 0 or >= MAX_PAYLOAD_SIZE
+        Ready       // A complete frame is available
+    };
+
+    // =========================================================================
+    // WRITE SIDE (async_read_some fills this region)
+    // =========================================================================
+
+    /// Start of the free region at the end of the buffer
+    uint8_t *WritePtr() { return storage_.data() + write_pos_; }
+
+    /// Bytes that can be written without overwriting unparsed data
+    size_t WritableBytes() const { return CAPACITY - write_pos_; }
+
+    /// Mark n bytes as received (call from the read completion handler)
+    void Commit(size_t n) { write_pos_ += n; }
+
+    // =========================================================================
+    // READ SIDE (frame parsing)
+    // =========================================================================
+
+    /// Bytes received but not yet consumed
+    size_t ReadableBytes() const { return write_pos_ - read_pos_; }
+
+    /// Inspect the frame at the read position without consuming it.
+    /// On Ready, payload_size holds the payload length (header excluded).
+    /// On BadSize, payload_size holds the offending size for logging.
+    FrameStatus PeekFrame(uint16_t &payload_size) const {
+        if (ReadableBytes() < Protocol::HEADER_SIZE) return FrameStatus::NeedMore;
+
+        const uint8_t *header = storage_.data() + read_pos_;
+        if (header[0] != Protocol::MAGIC_1 || header[1] != Protocol::MAGIC_2) {
+            return FrameStatus::BadMagic;
+        }
+
+        payload_size = static_cast<uint16_t>((header[2] << 8) | header[3]);
+        if (payload_size == 0 || payload_size >= Protocol::MAX_PAYLOAD_SIZE) {
+            return FrameStatus::BadSize;
+        }
+
+        if (ReadableBytes() < Protocol::HEADER_SIZE + payload_size) return FrameStatus::NeedMore;
+        return FrameStatus::Ready;
+    }
+
+    /// First two header bytes at the read position (for violation logging)
+    std::pair<uint8_t, uint8_t> PeekMagic() const {
+        return {storage_[read_pos_], storage_[read_pos_ + 1]};
+    }
+
+    /// Payload of the frame at the read position. Only valid after PeekFrame
+    /// returned Ready, and only until the next Consume()/Compact().
+    std::span<const uint8_t> Payload(uint16_t payload_size) const {
+        return {storage_.data() + read_pos_ + Protocol::HEADER_SIZE, payload_size};
+    }
+
+    /// Drop n bytes from the read position (a whole frame, or just a bad header)
+    void Consume(size_t n) {
+        read_pos_ += n;
+        if (read_pos_ == write_pos_) {
+            // Fully drained - rewind for free, no copy needed
+            read_pos_ = 0;
+            write_pos_ = 0;
+        }
+    }
+
+    /// Move the unparsed tail to the front if the free space can no longer
+    /// hold a maximum-size frame. Call once after parsing, before the next read.
+    void Compact() {
+        if (read_pos_ == 0 || WritableBytes() >= MAX_FRAME_SIZE) return;
+        const size_t remaining = ReadableBytes();
+        std::memmove(storage_.data(), storage_.data() + read_pos_, remaining);
+        read_pos_ = 0;
+        write_pos_ = remaining;
+    }
+
+private:
+    std::array<uint8_t, CAPACITY> storage_{};
+    size_t read_pos_ = 0;   // Start of the first unparsed byte
+    size_t write_pos_ = 0;  // One past the last received byte
+};
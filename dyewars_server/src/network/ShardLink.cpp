@@ -0,0 +1,257 @@
+/// =======================================
+/// DyeWarsServer - ShardLink
+/// =======================================
+#include "ShardLink.h"
+#include "core/Log.h"
+#include "network/Packets/Protocol.h"
+
+#include <filesystem>
+#include <format>
+
+namespace {
+    void WriteHeader(std::vector<uint8_t> &datagram, ShardLink::Type type, uint8_t from) {
+        Protocol::PacketWriter::WriteByte(datagram, static_cast<uint8_t>(type));
+        Protocol::PacketWriter::WriteByte(datagram, from);
+    }
+}
+
+ShardLink::ShardLink(asio::io_context &io_context, const std::string &dir, uint8_t index, uint8_t count)
+        : index_(index),
+          count_(count),
+          dir_(dir),
+          path_(SocketPath(dir, index))
+#ifndef _WIN32
+        , recv_socket_(io_context),
+          send_socket_(io_context)
+#endif
+{
+#ifdef _WIN32
+    (void)io_context;
+    throw std::runtime_error("shard links need Unix domain sockets");
+#else
+    std::filesystem::create_directories(dir_);
+
+    // A socket file left by a crashed run would make bind fail
+    std::error_code ignored;
+    std::filesystem::remove(path_, ignored);
+
+    recv_socket_.open();
+    recv_socket_.bind(asio::local::datagram_protocol::endpoint(path_));
+
+    // Sends never block the zone thread - a full peer buffer fails the send
+    send_socket_.open();
+    send_socket_.non_blocking(true);
+#endif
+}
+
+ShardLink::~ShardLink() {
+#ifndef _WIN32
+    std::error_code ec;
+    recv_socket_.close(ec);
+    send_socket_.close(ec);
+    std::filesystem::remove(path_, ec);
+#endif
+}
+
+void ShardLink::Start() {
+    Log::Info("Shard {}/{} link listening on {}", index_, count_, path_);
+    StartReceive();
+}
+
+std::string ShardLink::SocketPath(const std::string &dir, uint8_t shard) {
+    return (std::filesystem::path(dir) / std::format("shard{}.sock", shard)).string();
+}
+
+// ============================================================================
+// SEND (zone thread)
+// ============================================================================
+
+bool ShardLink::Send(uint8_t to, const Message &message) {
+#ifdef _WIN32
+    (void)to;
+    (void)message;
+    return false;
+#else
+    const asio::local::datagram_protocol::endpoint peer(SocketPath(dir_, to));
+    bool all_sent = true;
+    for (const auto &datagram : Encode(message, index_)) {
+        std::error_code ec;
+        send_socket_.send_to(asio::buffer(datagram), peer, 0, ec);
+        if (ec) {
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+            all_sent = false;
+            continue;
+        }
+        datagrams_sent_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return all_sent;
+#endif
+}
+
+// ============================================================================
+// RECEIVE (IO thread)
+// ============================================================================
+
+void ShardLink::StartReceive() {
+#ifndef _WIN32
+    recv_socket_.async_receive(asio::buffer(recv_buffer_), [this](std::error_code ec, size_t size) {
+        if (ec == asio::error::operation_aborted) return;
+        if (!ec) {
+            datagrams_received_.fetch_add(1, std::memory_order_relaxed);
+            if (auto message = Decode(std::span<const uint8_t>(recv_buffer_.data(), size))) {
+                std::lock_guard lock(inbox_mutex_);
+                inbox_.push_back(std::move(*message));
+            } else {
+                bad_datagrams_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (recv_socket_.is_open()) StartReceive();
+    });
+#endif
+}
+
+void ShardLink::Drain(std::vector<Message> &out) {
+    out.clear();
+    std::lock_guard lock(inbox_mutex_);
+    std::swap(out, inbox_);
+}
+
+// ============================================================================
+// WIRE FORMAT
+// ============================================================================
+
+std::vector<std::vector<uint8_t>> ShardLink::Encode(const Message &message, uint8_t from) {
+    using Protocol::PacketWriter::WriteByte;
+    using Protocol::PacketWriter::WriteShort;
+    using Protocol::PacketWriter::WriteUInt64;
+
+    std::vector<std::vector<uint8_t>> datagrams;
+    switch (message.type) {
+        case Type::GhostUpdate:
+            for (size_t start = 0; start < message.ghosts.size(); start += MAX_GHOSTS_PER_DATAGRAM) {
+                const size_t count = std::min(MAX_GHOSTS_PER_DATAGRAM, message.ghosts.size() - start);
+                auto &datagram = datagrams.emplace_back();
+                datagram.reserve(HEADER_BYTES + count * GHOST_RECORD_BYTES);
+                WriteHeader(datagram, message.type, from);
+                WriteShort(datagram, static_cast<uint16_t>(count));
+                for (size_t i = start; i < start + count; i++) {
+                    const auto &ghost = message.ghosts[i];
+                    WriteUInt64(datagram, ghost.player_id);
+                    WriteShort(datagram, static_cast<uint16_t>(ghost.x));
+                    WriteShort(datagram, static_cast<uint16_t>(ghost.y));
+                    WriteByte(datagram, ghost.facing);
+                }
+            }
+            break;
+
+        case Type::GhostRemove:
+            for (size_t start = 0; start < message.removed.size(); start += MAX_REMOVES_PER_DATAGRAM) {
+                const size_t count = std::min(MAX_REMOVES_PER_DATAGRAM, message.removed.size() - start);
+                auto &datagram = datagrams.emplace_back();
+                datagram.reserve(HEADER_BYTES + count * 8);
+                WriteHeader(datagram, message.type, from);
+                WriteShort(datagram, static_cast<uint16_t>(count));
+                for (size_t i = start; i < start + count; i++) {
+                    WriteUInt64(datagram, message.removed[i]);
+                }
+            }
+            break;
+
+        case Type::Handoff: {
+            const auto &handoff = message.handoff;
+            const size_t name_length = std::min<size_t>(handoff.name.size(), 255);
+            auto &datagram = datagrams.emplace_back();
+            WriteHeader(datagram, message.type, from);
+            WriteUInt64(datagram, handoff.token);
+            WriteUInt64(datagram, handoff.player_id);
+            WriteShort(datagram, static_cast<uint16_t>(handoff.x));
+            WriteShort(datagram, static_cast<uint16_t>(handoff.y));
+            WriteByte(datagram, handoff.facing);
+            WriteByte(datagram, static_cast<uint8_t>(name_length));
+            datagram.insert(datagram.end(), handoff.name.begin(), handoff.name.begin() + name_length);
+            break;
+        }
+    }
+    return datagrams;
+}
+
+std::optional<ShardLink::Message> ShardLink::Decode(std::span<const uint8_t> datagram) {
+    using Protocol::PacketReader::ReadByte;
+    using Protocol::PacketReader::ReadShort;
+    using Protocol::PacketReader::ReadUInt64;
+
+    try {
+        size_t offset = 0;
+        Message message;
+        const uint8_t type = ReadByte(datagram, offset);
+        message.from = ReadByte(datagram, offset);
+
+        switch (static_cast<Type>(type)) {
+            case Type::GhostUpdate: {
+                message.type = Type::GhostUpdate;
+                const uint16_t count = ReadShort(datagram, offset);
+                message.ghosts.reserve(count);
+                for (uint16_t i = 0; i < count; i++) {
+                    GhostRecord ghost{};
+                    ghost.player_id = ReadUInt64(datagram, offset);
+                    ghost.x = static_cast<int16_t>(ReadShort(datagram, offset));
+                    ghost.y = static_cast<int16_t>(ReadShort(datagram, offset));
+                    ghost.facing = ReadByte(datagram, offset);
+                    message.ghosts.push_back(ghost);
+                }
+                break;
+            }
+            case Type::GhostRemove: {
+                message.type = Type::GhostRemove;
+                const uint16_t count = ReadShort(datagram, offset);
+                message.removed.reserve(count);
+                for (uint16_t i = 0; i < count; i++) {
+                    message.removed.push_back(ReadUInt64(datagram, offset));
+                }
+                break;
+            }
+            case Type::Handoff: {
+                message.type = Type::Handoff;
+                auto &handoff = message.handoff;
+                handoff.token = ReadUInt64(datagram, offset);
+                handoff.player_id = ReadUInt64(datagram, offset);
+                handoff.x = static_cast<int16_t>(ReadShort(datagram, offset));
+                handoff.y = static_cast<int16_t>(ReadShort(datagram, offset));
+                handoff.facing = ReadByte(datagram, offset);
+                const uint8_t name_length = ReadByte(datagram, offset);
+                if (offset + name_length > datagram.size()) return std::nullopt;
+                handoff.name.assign(datagram.begin() + offset, datagram.begin() + offset + name_length);
+                offset += name_length;
+                break;
+            }
+            default:
+                return std::nullopt;
+        }
+
+        // Trailing bytes mean the sender and we disagree on the format
+        if (offset != datagram.size()) return std::nullopt;
+        return message;
+    } catch (const std::out_of_range &) {
+        return std::nullopt;
+    }
+}
+
+// ============================================================================
+// STATS
+// ============================================================================
+
+ShardLink::Stats ShardLink::GetStats() const {
+    return Stats{
+            datagrams_sent_.load(std::memory_order_relaxed),
+            datagrams_received_.load(std::memory_order_relaxed),
+            send_errors_.load(std::memory_order_relaxed),
+            bad_datagrams_.load(std::memory_order_relaxed),
+    };
+}
+
+std::string ShardLink::GetStatus() const {
+    const Stats stats = GetStats();
+    return std::format("Shard {}/{} link {}: {} sent, {} received, {} send errors, {} bad datagrams",
+                       index_, count_, path_, stats.datagrams_sent, stats.datagrams_received,
+                       stats.send_errors, stats.bad_datagrams);
+}
@@ -0,0 +1,169 @@
+/// =======================================
+/// DyeWarsServer - ShardLink
+///
+/// IPC between the server processes running one sharded map (--shard I/N).
+/// Each shard binds a Unix datagram socket at <shard_dir>/shard<I>.sock and
+/// sends to its peers' sockets. Datagrams never leave the host.
+///
+/// WHY UNIX DATAGRAM SOCKETS:
+/// Shards run on the same box, so a local socket skips the IP stack, and
+/// datagrams keep message boundaries - no framing, no connection to
+/// re-establish when a neighbour restarts. Unlike UDP, a local datagram
+/// is not silently lost: a full receive buffer or a missing peer fails the
+/// send, so the sender knows (handoffs rely on that).
+///
+/// MESSAGES: [type:1][from:1] then
+///   GhostUpdate  [count:2][[id:8][x:2][y:2][facing:1]]...  owner -> neighbour
+///   GhostRemove  [count:2][[id:8]]...                     owner -> neighbour
+///   Handoff      [token:8][id:8][x:2][y:2][facing:1][nameLen:1][name]
+/// Ghost lists are split to stay under MAX_DATAGRAM_BYTES.
+///
+/// THREAD SAFETY:
+///   - Send: the sharded zone's thread only (its own unbound send socket)
+///   - Receive: the owning io_context's thread; decoded messages wait in a
+///     mutex-protected inbox until Drain (zone thread, tick start)
+///   - GetStats / GetStatus: any thread
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <array>
+#include <asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+class ShardLink {
+public:
+    enum class Type : uint8_t {
+        GhostUpdate = 1,
+        GhostRemove = 2,
+        Handoff = 3,
+    };
+
+    /// One ghost's position as it goes on the wire (13 bytes)
+    struct GhostRecord {
+        uint64_t player_id;
+        int16_t x;
+        int16_t y;
+        uint8_t facing;
+    };
+
+    /// Ownership of a player moving to the receiving shard. The player's
+    /// client reconnects there presenting `token` (C_Shard_Resume).
+    struct Handoff {
+        uint64_t token = 0;
+        uint64_t player_id = 0;
+        int16_t x = 0;
+        int16_t y = 0;
+        uint8_t facing = 0;
+        std::string name;
+    };
+
+    struct Message {
+        Type type = Type::GhostUpdate;
+        uint8_t from = 0;
+        std::vector<GhostRecord> ghosts;  // GhostUpdate
+        std::vector<uint64_t> removed;    // GhostRemove
+        Handoff handoff;                  // Handoff
+    };
+
+    static constexpr size_t MAX_DATAGRAM_BYTES = 8192;
+    static constexpr size_t HEADER_BYTES = 4;  // type(1) + from(1) + count(2)
+    static constexpr size_t GHOST_RECORD_BYTES = 13;
+    static constexpr size_t MAX_GHOSTS_PER_DATAGRAM = (MAX_DATAGRAM_BYTES - HEADER_BYTES) / GHOST_RECORD_BYTES;
+    static constexpr size_t MAX_REMOVES_PER_DATAGRAM = (MAX_DATAGRAM_BYTES - HEADER_BYTES) / 8;
+
+    /// Bind <dir>/shard<index>.sock (creating dir, replacing a stale socket
+    /// file from a crashed run). Throws asio::system_error on failure.
+    ShardLink(asio::io_context &io_context, const std::string &dir, uint8_t index, uint8_t count);
+
+    /// Closes the sockets and removes the socket file
+    ~ShardLink();
+
+    ShardLink(const ShardLink &) = delete;
+    ShardLink &operator=(const ShardLink &) = delete;
+
+    /// Start receiving (call once)
+    void Start();
+
+    uint8_t Index() const { return index_; }
+
+    uint8_t Count() const { return count_; }
+
+    static std::string SocketPath(const std::string &dir, uint8_t shard);
+
+    // =========================================================================
+    // SENDING (zone thread)
+    // =========================================================================
+
+    /// Send a message to shard `to`, split into as many datagrams as needed.
+    /// Never blocks. @return false if any datagram couldn't be sent (peer
+    /// not running, its receive buffer full)
+    bool Send(uint8_t to, const Message &message);
+
+    // =========================================================================
+    // RECEIVING (zone thread)
+    // =========================================================================
+
+    /// Take every message received since the last call (oldest first)
+    void Drain(std::vector<Message> &out);
+
+    // =========================================================================
+    // WIRE FORMAT
+    // =========================================================================
+
+    /// Datagrams for one message sent by shard `from` (message.from is ignored)
+    static std::vector<std::vector<uint8_t>> Encode(const Message &message, uint8_t from);
+
+    /// nullopt for truncated or unknown datagrams
+    static std::optional<Message> Decode(std::span<const uint8_t> datagram);
+
+    // =========================================================================
+    // STATS (any thread)
+    // =========================================================================
+
+    struct Stats {
+        uint64_t datagrams_sent;
+        uint64_t datagrams_received;
+        uint64_t send_errors;
+        uint64_t bad_datagrams;
+    };
+
+    Stats GetStats() const;
+
+    std::string GetStatus() const;
+
+private:
+    /// Receive chain (IO thread)
+    void StartReceive();
+
+    const uint8_t index_;
+    const uint8_t count_;
+    const std::string dir_;
+    const std::string path_;
+
+#ifndef _WIN32
+    // --- Receive socket (IO thread only) ---
+    asio::local::datagram_protocol::socket recv_socket_;
+    std::array<uint8_t, MAX_DATAGRAM_BYTES> recv_buffer_{};
+
+    // --- Send socket (zone thread only), unbound ---
+    asio::local::datagram_protocol::socket send_socket_;
+#endif
+
+    // --- Inbox (mutex) ---
+    std::mutex inbox_mutex_;
+    std::vector<Message> inbox_;
+
+    // --- Stats ---
+    std::atomic<uint64_t> datagrams_sent_{0};
+    std::atomic<uint64_t> datagrams_received_{0};
+    std::atomic<uint64_t> send_errors_{0};
+    std::atomic<uint64_t> bad_datagrams_{0};
+};
@@ -0,0 +1,106 @@
+/// =======================================
+/// DyeWarsServer - SpatialConflation
+/// =======================================
+#include "SpatialConflation.h"
+#include "network/Packets/Protocol.h"
+#include "network/Packets/OpCodes.h"
+#include <array>
+#include <cstring>
+#include <unordered_map>
+
+namespace SpatialConflation {
+
+size_t Conflate(PacketQueue &queue, const std::shared_ptr<std::vector<uint8_t>> &incoming) {
+    // S_Player_Spatial payload: [opcode:1][count:1][[playerId:8][x:2][y:2][facing:1]]...
+    constexpr size_t RECORD_SIZE = 13;
+    constexpr size_t RECORDS_OFFSET = Protocol::HEADER_SIZE + 2;
+    constexpr size_t MAX_RECORDS_PER_PACKET = 255;
+    const uint8_t spatial_op = Protocol::Opcode::Batch::Server::S_Player_Spatial.op;
+    const uint8_t left_op = Protocol::Opcode::RemotePlayer::Server::S_Left_Game.op;
+
+    // Latest record per player, in first-seen order
+    std::vector<std::array<uint8_t, RECORD_SIZE>> records;
+    std::vector<bool> live;
+    std::unordered_map<uint64_t, size_t> index_by_player;
+
+    auto read_id = [](const uint8_t *p) {
+        uint64_t id = 0;
+        for (int i = 0; i < 8; i++) id = (id << 8) | p[i];
+        return id;
+    };
+
+    auto absorb = [&](const std::vector<uint8_t> &packet) {
+        const size_t count = packet[Protocol::HEADER_SIZE + 1];
+        for (size_t i = 0; i < count; i++) {
+            const size_t at = RECORDS_OFFSET + i * RECORD_SIZE;
+            if (at + RECORD_SIZE > packet.size()) break;  // Malformed, keep what we have
+            const uint64_t id = read_id(&packet[at]);
+            auto [it, inserted] = index_by_player.try_emplace(id, records.size());
+            if (inserted) {
+                records.emplace_back();
+                live.push_back(true);
+            }
+            std::memcpy(records[it->second].data(), &packet[at], RECORD_SIZE);
+        }
+    };
+
+    auto opcode_of = [](const std::vector<uint8_t> &packet) -> uint8_t {
+        return packet.size() > Protocol::HEADER_SIZE ? packet[Protocol::HEADER_SIZE] : 0;
+    };
+
+    // Keep every non-spatial packet in order. Spatial records are pulled out
+    // and re-queued at the end as merged batches.
+    //
+    // ORDERING: a queued S_Left_Game must not be followed by a stale spatial
+    // record for the same player (the client would recreate them). So a
+    // Left_Game forgets any earlier record for that player - only records
+    // queued after it survive, and they belong after it anyway.
+    PacketQueue kept;
+    const size_t before = queue.size() + 1;  // +1: incoming counts as queued
+    for (auto &packet : queue) {
+        const uint8_t op = opcode_of(*packet);
+        if (op == spatial_op && packet->size() >= RECORDS_OFFSET) {
+            absorb(*packet);
+            continue;
+        }
+        if (op == left_op && packet->size() >= Protocol::HEADER_SIZE + 9) {
+            const auto it = index_by_player.find(read_id(&(*packet)[Protocol::HEADER_SIZE + 1]));
+            if (it != index_by_player.end()) {
+                live[it->second] = false;
+                index_by_player.erase(it);
+            }
+        }
+        kept.push_back(std::move(packet));
+    }
+    if (opcode_of(*incoming) == spatial_op && incoming->size() >= RECORDS_OFFSET) {
+        absorb(*incoming);
+    } else {
+        kept.push_back(incoming);  // Not spatial - just queue it normally
+    }
+
+    // Rebuild: survivors first, then the merged batch(es) in new buffers
+    queue = std::move(kept);
+    size_t i = 0;
+    while (i < records.size()) {
+        Protocol::Packet batch;
+        batch.payload.reserve(2 + MAX_RECORDS_PER_PACKET * RECORD_SIZE);
+        Protocol::PacketWriter::WriteByte(batch.payload, spatial_op);
+        Protocol::PacketWriter::WriteByte(batch.payload, 0);  // Count placeholder
+
+        uint8_t count = 0;
+        for (; i < records.size() && count < MAX_RECORDS_PER_PACKET; i++) {
+            if (!live[i]) continue;
+            batch.payload.insert(batch.payload.end(), records[i].begin(), records[i].end());
+            count++;
+        }
+        if (count == 0) break;
+
+        batch.payload[1] = count;
+        batch.size = static_cast<uint16_t>(batch.payload.size());
+        queue.push_back(std::make_shared<std::vector<uint8_t>>(batch.ToBytes()));
+    }
+
+    return before > queue.size() ? before - queue.size() : 0;
+}
+
+}
@@ -0,0 +1,36 @@
+/// =======================================
+/// DyeWarsServer - SpatialConflation
+///
+/// Merges queued S_Player_Spatial batches so a slow client only receives
+/// the latest position per player instead of every stale intermediate step.
+/// Used by ClientConnection's backpressure policy (tier 1).
+///
+/// WHY THIS IS SAFE:
+/// S_Player_Spatial is absolute state ("player X is at (x,y) facing f"),
+/// not a delta. Skipping intermediate updates only skips animation frames
+/// the client would have rendered late anyway.
+///
+/// THREAD SAFETY:
+/// None - caller must hold the send queue's lock.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace SpatialConflation {
+    using PacketQueue = std::deque<std::shared_ptr<std::vector<uint8_t>>>;
+
+    /// Pull every framed S_Player_Spatial packet out of queue, merge them with
+    /// incoming (also framed), and append the result as the fewest batches of
+    /// at most 255 players. Other packets keep their relative order.
+    ///
+    /// Never mutates queued buffers - they may be shared with other connections.
+    ///
+    /// @return Number of packets the queue shrank by, counting incoming as queued
+    size_t Conflate(PacketQueue &queue, const std::shared_ptr<std::vector<uint8_t>> &incoming);
+}
@@ -0,0 +1,139 @@
+/// =======================================
+/// DyeWarsServer - TimerWheel
+/// =======================================
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel() {
+    slots_.fill(NIL);
+}
+
+TimerWheel::Handle TimerWheel::Arm(uint64_t delay_ticks, std::weak_ptr<Target> target, uint32_t tag) {
+    ASSERT_SINGLE_THREADED(owner_);
+    if (!owner_.IsOwnerSet()) owner_.SetOwner();
+
+    uint32_t index;
+    if (!free_.empty()) {
+        index = free_.back();
+        free_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(entries_.size());
+        entries_.emplace_back();
+    }
+
+    if (delay_ticks < 1) delay_ticks = 1;
+    if (delay_ticks > MAX_DELAY_TICKS) delay_ticks = MAX_DELAY_TICKS;
+
+    Entry &entry = entries_[index];
+    entry.expiry = current_tick_ + delay_ticks;
+    entry.tag = tag;
+    entry.target = std::move(target);
+    entry.armed = true;
+    Insert(index);
+    armed_count_++;
+
+    return MakeHandle(index, entry.generation);
+}
+
+void TimerWheel::Cancel(Handle handle) {
+    ASSERT_SINGLE_THREADED(owner_);
+    if (handle == NO_TIMER) return;
+
+    const uint32_t index = static_cast<uint32_t>(handle & 0xFFFFFFFF) - 1;
+    const uint32_t generation = static_cast<uint32_t>(handle >> 32);
+    if (index >= entries_.size()) return;
+
+    Entry &entry = entries_[index];
+    if (!entry.armed || entry.generation != generation) return;  // Already fired or reused
+
+    Unlink(index);
+    Release(index);
+}
+
+void TimerWheel::AdvanceTo(uint64_t tick) {
+    ASSERT_SINGLE_THREADED(owner_);
+    if (!owner_.IsOwnerSet()) owner_.SetOwner();
+
+    while (current_tick_ < tick) {
+        Step();
+    }
+}
+
+void TimerWheel::Insert(uint32_t index) {
+    Entry &entry = entries_[index];
+    const uint64_t delta = entry.expiry - current_tick_;
+
+    size_t list;
+    if (delta < LEVEL0_SLOTS) {
+        list = entry.expiry & (LEVEL0_SLOTS - 1);
+    } else if (delta < (uint64_t{1} << (LEVEL0_BITS + LEVELN_BITS))) {
+        list = LEVEL0_SLOTS + ((entry.expiry >> LEVEL0_BITS) & (LEVELN_SLOTS - 1));
+    } else {
+        list = LEVEL0_SLOTS + LEVELN_SLOTS +
+               ((entry.expiry >> (LEVEL0_BITS + LEVELN_BITS)) & (LEVELN_SLOTS - 1));
+    }
+
+    entry.list = static_cast<uint16_t>(list);
+    entry.prev = NIL;
+    entry.next = slots_[list];
+    if (entry.next != NIL) entries_[entry.next].prev = index;
+    slots_[list] = index;
+}
+
+void TimerWheel::Unlink(uint32_t index) {
+    Entry &entry = entries_[index];
+    if (entry.prev != NIL) entries_[entry.prev].next = entry.next;
+    else slots_[entry.list] = entry.next;
+    if (entry.next != NIL) entries_[entry.next].prev = entry.prev;
+    entry.prev = entry.next = NIL;
+}
+
+void TimerWheel::Release(uint32_t index) {
+    Entry &entry = entries_[index];
+    entry.armed = false;
+    entry.generation++;  // Invalidates outstanding handles
+    entry.target.reset();
+    free_.push_back(index);
+    armed_count_--;
+}
+
+void TimerWheel::Cascade(size_t level, size_t slot) {
+    const size_t list = LEVEL0_SLOTS + (level - 1) * LEVELN_SLOTS + slot;
+    uint32_t index = slots_[list];
+    slots_[list] = NIL;
+
+    while (index != NIL) {
+        const uint32_t next = entries_[index].next;
+        Insert(index);  // Closer to expiry now, lands in a finer level
+        index = next;
+    }
+}
+
+void TimerWheel::Step() {
+    current_tick_++;
+
+    // Level 0 wrapped: pull the next slot of each coarser level down.
+    // Level 2 first so its timers can continue into level 1 -> level 0.
+    if ((current_tick_ & (LEVEL0_SLOTS - 1)) == 0) {
+        const uint64_t level1_tick = current_tick_ >> LEVEL0_BITS;
+        if ((level1_tick & (LEVELN_SLOTS - 1)) == 0) {
+            Cascade(2, (current_tick_ >> (LEVEL0_BITS + LEVELN_BITS)) & (LEVELN_SLOTS - 1));
+        }
+        Cascade(1, level1_tick & (LEVELN_SLOTS - 1));
+    }
+
+    // Pop one timer at a time rather than walking the list: a callback may
+    // cancel other timers in this slot (Disconnect cancels the connection's
+    // other timers). New timers never land here - an expiry of current+256
+    // goes to level 1 - so the loop always ends.
+    const size_t list = current_tick_ & (LEVEL0_SLOTS - 1);
+    while (slots_[list] != NIL) {
+        const uint32_t index = slots_[list];
+        Unlink(index);
+
+        auto target = entries_[index].target.lock();
+        const uint32_t tag = entries_[index].tag;
+        Release(index);  // Before the callback, so it can re-arm freely
+
+        if (target) target->OnTimer(tag);
+    }
+}
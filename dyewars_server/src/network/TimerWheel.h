@@ -0,0 +1,138 @@
+/// =======================================
+/// DyeWarsServer - TimerWheel
+///
+/// Hierarchical timing wheel for per-connection deadlines (handshake
+/// timeout, ping schedule, idle disconnect). One wheel per IO thread,
+/// driven by a single steady_timer in IoContextPool.
+///
+/// WHY NOT ONE asio::steady_timer PER CONNECTION:
+/// Each asio timer is a node in the reactor's timer heap: O(log n) to arm
+/// and cancel, and it's rescheduled through the kernel timerfd. At 50k
+/// connections with 3 deadlines each that's 150k heap entries churning.
+/// A wheel arms and cancels in O(1), and firing costs only the timers
+/// that are actually due.
+///
+/// LAYOUT (TICK = 100ms):
+///   level 0: 256 slots x 1 tick      -> 25.6 seconds
+///   level 1:  64 slots x 256 ticks   -> 27 minutes
+///   level 2:  64 slots x 16384 ticks -> 29 hours (longer delays are clamped)
+/// A timer sits in the coarsest level its deadline needs. When level 0
+/// wraps, the next level-1 slot is cascaded down (same for level 2 -> 1).
+/// So every timer moves at most twice before it fires.
+///
+/// HANDLES, NOT POINTERS:
+/// Timers live in a slab owned by the wheel. Arm() returns a handle with a
+/// generation, so cancelling a timer that already fired (or was reused)
+/// is a harmless no-op. Each timer holds a weak_ptr to its Target. If the
+/// connection is destroyed without cancelling, the timer is dropped when
+/// it comes due instead of calling into freed memory.
+///
+/// THREAD SAFETY:
+/// Owning IO thread only (ThreadOwner asserted). A connection is pinned to
+/// one io_context, so it always talks to the same wheel.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "core/ThreadSafety.h"
+
+class TimerWheel {
+public:
+    /// Receives timer callbacks. Implemented by ClientConnection.
+    class Target {
+    public:
+        virtual ~Target() = default;
+
+        /// Called on the wheel's IO thread when a timer armed with tag fires
+        virtual void OnTimer(uint32_t tag) = 0;
+    };
+
+    /// Opaque timer id. 0 is never a valid handle.
+    using Handle = uint64_t;
+    static constexpr Handle NO_TIMER = 0;
+
+    static constexpr std::chrono::milliseconds TICK{100};
+
+    static constexpr size_t LEVEL0_BITS = 8;
+    static constexpr size_t LEVELN_BITS = 6;
+    static constexpr size_t LEVEL0_SLOTS = size_t{1} << LEVEL0_BITS;  // 256
+    static constexpr size_t LEVELN_SLOTS = size_t{1} << LEVELN_BITS;  // 64
+    static constexpr uint64_t MAX_DELAY_TICKS =
+            (uint64_t{1} << (LEVEL0_BITS + 2 * LEVELN_BITS)) - 1;     // ~29 hours
+
+    /// Whole ticks covering the duration (rounded up, at least 1)
+    static constexpr uint64_t TicksFor(std::chrono::milliseconds duration) {
+        const auto ticks = (duration.count() + TICK.count() - 1) / TICK.count();
+        return ticks < 1 ? 1 : static_cast<uint64_t>(ticks);
+    }
+
+    TimerWheel();
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    /// Fire tag on target after delay_ticks (>= 1). O(1).
+    Handle Arm(uint64_t delay_ticks, std::weak_ptr<Target> target, uint32_t tag);
+
+    /// Cancel an armed timer. No-op for NO_TIMER, fired or stale handles. O(1).
+    void Cancel(Handle handle);
+
+    /// Advance to `tick`, firing everything due on the way.
+    /// Driven by IoContextPool with the ticks elapsed since start.
+    void AdvanceTo(uint64_t tick);
+
+    /// Current tick (the last one processed)
+    uint64_t CurrentTick() const { return current_tick_; }
+
+    /// Number of armed timers
+    size_t ArmedCount() const { return armed_count_; }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Entry {
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t generation = 0;
+        uint32_t tag = 0;
+        uint64_t expiry = 0;
+        uint16_t list = 0;      // Index into slots_ (level * 256 + slot)
+        bool armed = false;
+        std::weak_ptr<Target> target;
+    };
+
+    /// Link an entry into the slot its expiry needs
+    void Insert(uint32_t index);
+
+    void Unlink(uint32_t index);
+
+    /// Return an entry to the free list
+    void Release(uint32_t index);
+
+    /// Move every timer in a level-N slot down to finer levels
+    void Cascade(size_t level, size_t slot);
+
+    /// One tick: cascade on level 0 wrap, then fire the current slot
+    void Step();
+
+    static Handle MakeHandle(uint32_t index, uint32_t generation) {
+        return (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(index) + 1);
+    }
+
+    ThreadOwner owner_;
+
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> free_;
+
+    /// Head of each slot's list: level 0 first, then level 1, then level 2
+    std::array<uint32_t, LEVEL0_SLOTS + 2 * LEVELN_SLOTS> slots_;
+
+    uint64_t current_tick_ = 0;
+    size_t armed_count_ = 0;
+};
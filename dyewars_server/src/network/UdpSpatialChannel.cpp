@@ -0,0 +1,264 @@
+/// =======================================
+/// DyeWarsServer - UdpSpatialChannel
+/// =======================================
+#include "UdpSpatialChannel.h"
+#include "BandwidthMonitor.h"
+#include "core/Log.h"
+#include "network/Packets/OpCodes.h"
+#include "network/Packets/Protocol.h"
+
+#include <format>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace Op = Protocol::Opcode;
+
+UdpSpatialChannel::UdpSpatialChannel(asio::io_context &io_context, uint16_t port)
+        : socket_(io_context, asio::ip::udp::endpoint(asio::ip::udp::v4(), port)) {
+    port_ = socket_.local_endpoint().port();
+    // Sends never block the IO thread - a full socket buffer drops the
+    // datagram, which is exactly what an unreliable channel should do.
+    socket_.non_blocking(true);
+}
+
+UdpSpatialChannel::~UdpSpatialChannel() {
+    std::error_code ec;
+    socket_.close(ec);
+}
+
+void UdpSpatialChannel::Start() {
+    Log::Info("UDP spatial channel listening on port {}", port_);
+    StartReceive();
+}
+
+// ============================================================================
+// BINDINGS
+// ============================================================================
+
+uint64_t UdpSpatialChannel::IssueToken(uint64_t client_id) {
+    std::lock_guard lock(mutex_);
+
+    auto &binding = bindings_[client_id];
+    if (binding.token != 0) tokens_.erase(binding.token);
+
+    uint64_t token = 0;
+    do {
+        token = token_rng_();
+    } while (token == 0 || tokens_.contains(token));
+
+    binding = Binding{};
+    binding.token = token;
+    tokens_[token] = client_id;
+    return token;
+}
+
+void UdpSpatialChannel::Remove(uint64_t client_id) {
+    std::lock_guard lock(mutex_);
+    auto it = bindings_.find(client_id);
+    if (it == bindings_.end()) return;
+    tokens_.erase(it->second.token);
+    bindings_.erase(it);
+}
+
+bool UdpSpatialChannel::IsBound(uint64_t client_id) const {
+    std::lock_guard lock(mutex_);
+    auto it = bindings_.find(client_id);
+    return it != bindings_.end() && it->second.bound;
+}
+
+// ============================================================================
+// RECEIVE (IO thread)
+// ============================================================================
+
+void UdpSpatialChannel::StartReceive() {
+    socket_.async_receive_from(asio::buffer(recv_buffer_), recv_endpoint_,
+                               [this](std::error_code ec, size_t size) {
+                                   if (ec == asio::error::operation_aborted) return;
+                                   if (!ec) HandleDatagram(size);
+                                   if (socket_.is_open()) StartReceive();
+                               });
+}
+
+void UdpSpatialChannel::HandleDatagram(size_t size) {
+    const auto &bind_op = Op::Connection::Client::C_Udp_Bind;
+    if (size != bind_op.payloadSize || recv_buffer_[0] != bind_op.op) {
+        bad_datagrams_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    bind_requests_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t offset = 1;
+    const uint64_t token = Protocol::PacketReader::ReadUInt64(std::span<const uint8_t>(recv_buffer_.data(), size),
+                                                              offset);
+    {
+        std::lock_guard lock(mutex_);
+        auto token_it = tokens_.find(token);
+        if (token_it == tokens_.end()) {
+            bad_datagrams_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto &binding = bindings_[token_it->second];
+        if (!binding.bound || binding.endpoint != recv_endpoint_) {
+            Log::Debug("Client {} bound UDP endpoint {}:{}", token_it->second,
+                       recv_endpoint_.address().to_string(), recv_endpoint_.port());
+        }
+        binding.bound = true;
+        binding.endpoint = recv_endpoint_;
+    }
+
+    // Ack on the same path so the client knows UDP works in both directions.
+    // Clients retry C_Udp_Bind until this arrives, so a lost ack is harmless.
+    const uint8_t ack = Op::Connection::Server::S_Udp_Bound.op;
+    std::error_code ec;
+    socket_.send_to(asio::buffer(&ack, 1), recv_endpoint_, 0, ec);
+}
+
+// ============================================================================
+// SEND
+// ============================================================================
+
+bool UdpSpatialChannel::QueueSpatial(uint64_t client_id, std::span<const SpatialRecord> records) {
+    asio::ip::udp::endpoint endpoint;
+    uint32_t sequence = 0;
+    const size_t datagram_count = (records.size() + MAX_RECORDS_PER_DATAGRAM - 1) / MAX_RECORDS_PER_DATAGRAM;
+    {
+        std::lock_guard lock(mutex_);
+        auto it = bindings_.find(client_id);
+        if (it == bindings_.end() || !it->second.bound) return false;
+        endpoint = it->second.endpoint;
+        sequence = it->second.next_sequence;
+        it->second.next_sequence += static_cast<uint32_t>(datagram_count);
+    }
+
+    std::lock_guard staging(staging_mutex_);
+    for (size_t start = 0; start < records.size(); start += MAX_RECORDS_PER_DATAGRAM) {
+        const auto chunk = records.subspan(start, std::min(MAX_RECORDS_PER_DATAGRAM, records.size() - start));
+
+        Datagram datagram{endpoint, {}};
+        auto &bytes = datagram.bytes;
+        bytes.reserve(DATAGRAM_HEADER_BYTES + chunk.size() * RECORD_BYTES);
+        Protocol::PacketWriter::WriteByte(bytes, Op::Batch::Server::S_Player_Spatial_Unreliable.op);
+        Protocol::PacketWriter::WriteUInt(bytes, sequence++);
+        Protocol::PacketWriter::WriteByte(bytes, static_cast<uint8_t>(chunk.size()));
+        for (const auto &record : chunk) {
+            Protocol::PacketWriter::WriteUInt64(bytes, record.player_id);
+            Protocol::PacketWriter::WriteShort(bytes, static_cast<uint16_t>(record.x));
+            Protocol::PacketWriter::WriteShort(bytes, static_cast<uint16_t>(record.y));
+            Protocol::PacketWriter::WriteByte(bytes, record.facing);
+        }
+        staged_.push_back(std::move(datagram));
+    }
+    return true;
+}
+
+void UdpSpatialChannel::Flush() {
+    std::lock_guard staging(staging_mutex_);
+    if (staged_.empty()) return;
+
+    // Loss injection happens here, under the staging lock, so the fixed-seed
+    // RNG gives the same drop pattern for the same traffic.
+    const double loss_rate = loss_rate_.load(std::memory_order_relaxed);
+    if (loss_rate > 0.0) {
+        std::bernoulli_distribution drop(loss_rate);
+        const auto kept_end = std::remove_if(staged_.begin(), staged_.end(),
+                                             [&](const Datagram &) { return drop(loss_rng_); });
+        datagrams_dropped_.fetch_add(std::distance(kept_end, staged_.end()), std::memory_order_relaxed);
+        staged_.erase(kept_end, staged_.end());
+    }
+
+    auto batch = std::make_shared<DatagramBatch>(std::move(staged_));
+    staged_.clear();
+    asio::post(socket_.get_executor(), [this, batch]() {
+        SendBatch(*batch);
+    });
+}
+
+void UdpSpatialChannel::SendBatch(const DatagramBatch &batch) {
+    if (!socket_.is_open()) return;
+
+    size_t sent_bytes = 0;
+    size_t sent = 0;
+
+#ifdef __linux__
+    // One syscall per SEND_BATCH datagrams instead of one per datagram
+    std::array<mmsghdr, SEND_BATCH> messages{};
+    std::array<iovec, SEND_BATCH> iovecs{};
+
+    for (size_t start = 0; start < batch.size(); start += SEND_BATCH) {
+        const size_t count = std::min(SEND_BATCH, batch.size() - start);
+        for (size_t i = 0; i < count; i++) {
+            const Datagram &datagram = batch[start + i];
+            iovecs[i].iov_base = const_cast<uint8_t *>(datagram.bytes.data());
+            iovecs[i].iov_len = datagram.bytes.size();
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_name = const_cast<sockaddr *>(datagram.endpoint.data());
+            messages[i].msg_hdr.msg_namelen = static_cast<socklen_t>(datagram.endpoint.size());
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        send_calls_.fetch_add(1, std::memory_order_relaxed);
+        const int result = sendmmsg(socket_.native_handle(), messages.data(), static_cast<unsigned>(count), 0);
+        const size_t accepted = result > 0 ? static_cast<size_t>(result) : 0;
+        for (size_t i = 0; i < accepted; i++) sent_bytes += batch[start + i].bytes.size();
+        sent += accepted;
+
+        // Socket buffer full: the rest of this tick is stale by next tick anyway
+        if (accepted < count) {
+            send_errors_.fetch_add(count - accepted, std::memory_order_relaxed);
+            if (result < 0) break;
+        }
+    }
+#else
+    for (const Datagram &datagram : batch) {
+        std::error_code ec;
+        send_calls_.fetch_add(1, std::memory_order_relaxed);
+        socket_.send_to(asio::buffer(datagram.bytes), datagram.endpoint, 0, ec);
+        if (ec) {
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        sent_bytes += datagram.bytes.size();
+        sent++;
+    }
+#endif
+
+    datagrams_sent_.fetch_add(sent, std::memory_order_relaxed);
+    BandwidthMonitor::Instance().RecordOutgoing(sent_bytes);
+}
+
+// ============================================================================
+// LOSS INJECTION / STATS
+// ============================================================================
+
+void UdpSpatialChannel::SetLossRate(double rate) {
+    loss_rate_.store(std::clamp(rate, 0.0, 1.0), std::memory_order_relaxed);
+}
+
+UdpSpatialChannel::Stats UdpSpatialChannel::GetStats() const {
+    Stats stats{};
+    {
+        std::lock_guard lock(mutex_);
+        for (const auto &[client_id, binding] : bindings_) {
+            if (binding.bound) stats.bound_clients++;
+        }
+    }
+    stats.datagrams_sent = datagrams_sent_.load(std::memory_order_relaxed);
+    stats.datagrams_dropped = datagrams_dropped_.load(std::memory_order_relaxed);
+    stats.send_errors = send_errors_.load(std::memory_order_relaxed);
+    stats.send_calls = send_calls_.load(std::memory_order_relaxed);
+    stats.bind_requests = bind_requests_.load(std::memory_order_relaxed);
+    stats.bad_datagrams = bad_datagrams_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string UdpSpatialChannel::GetStatus() const {
+    const Stats stats = GetStats();
+    return std::format("UDP spatial: port {}, {} bound, {} sent in {} calls, {} dropped (loss {:.0f}%), "
+                       "{} send errors, {} binds, {} bad datagrams",
+                       port_, stats.bound_clients, stats.datagrams_sent, stats.send_calls,
+                       stats.datagrams_dropped, GetLossRate() * 100.0, stats.send_errors,
+                       stats.bind_requests, stats.bad_datagrams);
+}
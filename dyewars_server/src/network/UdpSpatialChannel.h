@@ -0,0 +1,193 @@
+/// =======================================
+/// DyeWarsServer - UdpSpatialChannel
+///
+/// Optional unreliable side channel for S_Player_Spatial updates.
+///
+/// WHY:
+/// Spatial batches are superseded every tick, but on TCP one lost segment
+/// holds back every later batch until it's retransmitted (head-of-line
+/// blocking). Over UDP a lost batch is simply replaced by the next one.
+///
+/// HANDSHAKE:
+///   1. TCP  S_Udp_Token  [token:8][udpPort:2]     after S_Welcome
+///   2. UDP  C_Udp_Bind   [token:8]                client -> server, retried
+///   3. UDP  S_Udp_Bound  (none)                   server -> client
+/// Datagrams carry the payload only (opcode first) - no magic/size header.
+/// The token maps the datagram's source endpoint to the TCP client. A later
+/// bind with the same token moves the binding (NAT rebinding).
+///
+/// WHAT GOES OVER UDP:
+/// Only updates for players the viewer already knows about:
+///   UDP  S_Player_Spatial_Unreliable [seq:4][count:1][[id:8][x:2][y:2][facing:1]]...
+/// First sight of a player (creates it on the client), S_Left_Game and
+/// corrections stay on TCP. Clients must ignore unreliable records for
+/// players they don't know, and drop datagrams with seq not newer than the
+/// last one applied (IsNewerSequence). That way a late datagram can't
+/// resurrect a player who already left.
+///
+/// THREAD SAFETY:
+///   - IssueToken / Remove / IsBound: any thread (mutex)
+///   - QueueSpatial / Flush: any thread (staging mutex). Every zone's game
+///     or encoder thread sends through the one channel.
+///   - Socket receive and send: the owning io_context's thread only.
+///     Flush posts the tick's datagrams there, and the IO thread sends them
+///     with one sendmmsg per 64 datagrams on Linux.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class UdpSpatialChannel {
+public:
+    /// One player's position as it goes on the wire (13 bytes)
+    struct SpatialRecord {
+        uint64_t player_id;
+        int16_t x;
+        int16_t y;
+        uint8_t facing;
+    };
+
+    /// Keep datagrams under a typical path MTU to avoid IP fragmentation
+    static constexpr size_t MAX_DATAGRAM_BYTES = 1200;
+    static constexpr size_t DATAGRAM_HEADER_BYTES = 6;  // opcode(1) + seq(4) + count(1)
+    static constexpr size_t RECORD_BYTES = 13;
+    static constexpr size_t MAX_RECORDS_PER_DATAGRAM =
+            (MAX_DATAGRAM_BYTES - DATAGRAM_HEADER_BYTES) / RECORD_BYTES;  // 91
+
+    /// Datagrams per sendmmsg call
+    static constexpr size_t SEND_BATCH = 64;
+
+    /// Bind the UDP socket on port (0 = ephemeral, for tests).
+    /// Throws asio::system_error if the port is taken.
+    UdpSpatialChannel(asio::io_context &io_context, uint16_t port);
+
+    ~UdpSpatialChannel();
+
+    UdpSpatialChannel(const UdpSpatialChannel &) = delete;
+    UdpSpatialChannel &operator=(const UdpSpatialChannel &) = delete;
+
+    /// Start receiving C_Udp_Bind datagrams (call once)
+    void Start();
+
+    /// Port the socket is bound to (what goes in S_Udp_Token)
+    uint16_t Port() const { return port_; }
+
+    // =========================================================================
+    // BINDINGS (any thread)
+    // =========================================================================
+
+    /// Issue a fresh random token for a client that just logged in
+    uint64_t IssueToken(uint64_t client_id);
+
+    /// Forget a client's token and endpoint (on disconnect)
+    void Remove(uint64_t client_id);
+
+    /// True once the client's C_Udp_Bind arrived
+    bool IsBound(uint64_t client_id) const;
+
+    // =========================================================================
+    // SENDING (the threads that encode ticks)
+    // =========================================================================
+
+    /// Stage spatial records for a bound client, split into MTU-sized
+    /// datagrams with increasing sequence numbers.
+    /// @return false if the client isn't bound (caller sends over TCP instead)
+    bool QueueSpatial(uint64_t client_id, std::span<const SpatialRecord> records);
+
+    /// Hand this tick's staged datagrams to the IO thread for sending
+    void Flush();
+
+    // =========================================================================
+    // LOSS INJECTION (testing over loopback)
+    // =========================================================================
+
+    /// Drop this fraction of datagrams before sending (0.0 - 1.0). Any thread.
+    void SetLossRate(double rate);
+    double GetLossRate() const { return loss_rate_.load(std::memory_order_relaxed); }
+
+    /// Wrap-safe "a is newer than b" for 32-bit sequence numbers (RFC 1982).
+    /// Clients use this to drop stale or duplicated datagrams.
+    static constexpr bool IsNewerSequence(uint32_t a, uint32_t b) {
+        return a != b && static_cast<uint32_t>(a - b) < 0x80000000u;
+    }
+
+    // =========================================================================
+    // STATS (any thread)
+    // =========================================================================
+
+    struct Stats {
+        uint64_t bound_clients;
+        uint64_t datagrams_sent;
+        uint64_t datagrams_dropped;  // Loss injection
+        uint64_t send_errors;        // Socket buffer full etc.
+        uint64_t send_calls;         // sendmmsg / send_to calls
+        uint64_t bind_requests;
+        uint64_t bad_datagrams;      // Wrong size/opcode or unknown token
+    };
+
+    Stats GetStats() const;
+
+    std::string GetStatus() const;
+
+private:
+    struct Binding {
+        uint64_t token = 0;
+        bool bound = false;
+        asio::ip::udp::endpoint endpoint;
+        uint32_t next_sequence = 1;
+    };
+
+    struct Datagram {
+        asio::ip::udp::endpoint endpoint;
+        std::vector<uint8_t> bytes;
+    };
+
+    using DatagramBatch = std::vector<Datagram>;
+
+    /// Receive chain (IO thread)
+    void StartReceive();
+    void HandleDatagram(size_t size);
+
+    /// Send one tick's datagrams (IO thread)
+    void SendBatch(const DatagramBatch &batch);
+
+    // --- Socket (IO thread only) ---
+    asio::ip::udp::socket socket_;
+    uint16_t port_ = 0;
+    std::array<uint8_t, 64> recv_buffer_{};
+    asio::ip::udp::endpoint recv_endpoint_;
+
+    // --- Bindings (mutex) ---
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Binding> bindings_;  // client_id -> binding
+    std::unordered_map<uint64_t, uint64_t> tokens_;   // token -> client_id
+    std::mt19937_64 token_rng_{std::random_device{}()};
+
+    // --- Staging (staging_mutex_) ---
+    std::mutex staging_mutex_;
+    DatagramBatch staged_;
+    std::mt19937 loss_rng_{0x44594557};  // Fixed seed: loss pattern is repeatable
+
+    std::atomic<double> loss_rate_{0.0};
+
+    // --- Stats ---
+    std::atomic<uint64_t> datagrams_sent_{0};
+    std::atomic<uint64_t> datagrams_dropped_{0};
+    std::atomic<uint64_t> send_errors_{0};
+    std::atomic<uint64_t> send_calls_{0};
+    std::atomic<uint64_t> bind_requests_{0};
+    std::atomic<uint64_t> bad_datagrams_{0};
+};
@@ -87,6 +87,36 @@ namespace Protocol::Opcode {
                     "S_Heartbeat_Response",
                     1  // opcode only
             };
+
+            // UDP spatial channel token (TCP, sent after S_Welcome when --udp is on).
+            // Client sends the token back in C_Udp_Bind to the given port.
+            // Payload: [token:8][udpPort:2]
+            constexpr OpCodeInfo S_Udp_Token = {
+                    0xF6,
+                    "Server issues UDP channel token",
+                    "S_Udp_Token",
+                    11  // opcode(1) + token(8) + port(2)
+            };
+
+            // UDP bind acknowledged (UDP datagram, not framed).
+            // Payload: (none)
+            constexpr OpCodeInfo S_Udp_Bound = {
+                    0xFC,
+                    "Server acknowledges UDP bind",
+                    "S_Udp_Bound",
+                    1  // opcode only
+            };
+
+            // Sharded map (--shard): the player walked into another shard's
+            // strip. Reconnect to `port` on the same host and send
+            // C_Shard_Resume with the token instead of C_Handshake_Request.
+            // Payload: [port:2][token:8]
+            constexpr OpCodeInfo S_Shard_Redirect = {
+                    0xFD,
+                    "Server hands the session to another shard",
+                    "S_Shard_Redirect",
+                    11  // opcode(1) + port(2) + token(8)
+            };
         }
 
         namespace Client {
@@ -125,6 +155,26 @@ namespace Protocol::Opcode {
                     "C_Heartbeat_Request",
                     1  // opcode only
             };
+
+            // Bind this UDP endpoint to the TCP client (UDP datagram, not framed).
+            // Retried until S_Udp_Bound arrives.
+            // Payload: [token:8]
+            constexpr OpCodeInfo C_Udp_Bind = {
+                    0xF7,
+                    "Client binds UDP channel",
+                    "C_Udp_Bind",
+                    9  // opcode(1) + token(8)
+            };
+
+            // Handshake on a new shard after S_Shard_Redirect. Accepted like
+            // C_Handshake_Request, then resumes the handed-off player.
+            // Payload: [version:2][clientMagic:4][token:8]
+            constexpr OpCodeInfo C_Shard_Resume = {
+                    0xF5,
+                    "Client resumes its session on another shard",
+                    "C_Shard_Resume",
+                    15  // opcode(1) + version(2) + magic(4) + token(8)
+            };
         }
     }
 
@@ -172,7 +222,7 @@ namespace Protocol::Opcode {
     }
 
     // ========================================================================
-    // LOCAL PLAYER - 0x10-0x12
+    // LOCAL PLAYER - 0x10-0x12, 0x19
     // ========================================================================
     namespace LocalPlayer {
         namespace Server {
@@ -202,6 +252,66 @@ namespace Protocol::Opcode {
                     "S_Facing_Correction",
                     2  // opcode(1) + facing(1)
             };
+
+            // Local player was placed at (x, y) on mapId by a warp. Players
+            // left behind on the old map already got S_Left_Game.
+            // Payload: [mapId:2][x:2][y:2]
+            constexpr OpCodeInfo S_Warped = {
+                    0x19,
+                    "Server notifies warp",
+                    "S_Warped",
+                    7  // opcode(1) + mapId(2) + x(2) + y(2)
+            };
+        }
+    }
+
+    // ========================================================================
+    // MAP DATA - 0x1A-0x1C
+    // The map streams in CHUNK_SIZE x CHUNK_SIZE chunks (see MapStreamer).
+    // A client keeps the chunks of its current map until the next S_Map_Info.
+    // ========================================================================
+    namespace Map {
+        namespace Server {
+            // One chunk's tiles, palette + run-length compressed. Row-major
+            // from the chunk's top-left tile; edge chunks may be narrower.
+            // Palette entries are tile types. Runs, by palette size:
+            //   1      no runs, every tile is palette[0]
+            //   2-16   [index:4 bits][length-1:4 bits] per byte
+            //   17+    [index:1][length-1:1]
+            // Then the chunk's dynamic blockers (doors), by mode:
+            //   0      none
+            //   1      [count:2][[x:1][y:1]...], chunk-local
+            //   2      ceil(width*height/8) bytes, row-major, bit 0 first
+            // Payload: [mapId:2][chunkX:2][chunkY:2][version:4][width:1][height:1]
+            //          [paletteSize:2][palette:paletteSize][runs:variable]
+            //          [blockerMode:1][blockers:variable]
+            constexpr OpCodeInfo S_Tile_Data = {
+                    0x1A,
+                    "Server sends a map chunk",
+                    "S_Tile_Data",
+                    OpCodeInfo::VARIABLE_SIZE  // 16 + palette + runs + blockers
+            };
+
+            // Tile edits made since the last tick, in the client's view.
+            // Each tile's final state, once; a held chunk is patched in place
+            // rather than re-sent. Flags: bit 0 = blocked (static or dynamic).
+            // Payload: [mapId:2][count:2][[x:2][y:2][type:1][flags:1]]...
+            constexpr OpCodeInfo S_Tile_Update = {
+                    0x1B,
+                    "Server sends tile edits",
+                    "S_Tile_Update",
+                    OpCodeInfo::VARIABLE_SIZE  // 5 + 6 per tile
+            };
+
+            // Map metadata. Sent on entering a map, before its chunks; the
+            // client drops the chunks it held.
+            // Payload: [mapId:2][width:2][height:2][chunkSize:1][flags:1][nameLength:1][name:variable]
+            constexpr OpCodeInfo S_Map_Info = {
+                    0x1C,
+                    "Server sends map info",
+                    "S_Map_Info",
+                    OpCodeInfo::VARIABLE_SIZE  // 10 + name
+            };
         }
     }
 
@@ -222,7 +332,7 @@ namespace Protocol::Opcode {
     }
 
     // ========================================================================
-    // BATCH UPDATES - 0x25
+    // BATCH UPDATES - 0x25, 0x27
     // ========================================================================
     namespace Batch {
         namespace Server {
@@ -235,6 +345,17 @@ namespace Protocol::Opcode {
                     "S_Player_Spatial",
                     OpCodeInfo::VARIABLE_SIZE  // 2 + (13 * count)
             };
+
+            // Same records as S_Player_Spatial over the UDP channel (not framed).
+            // Updates only - never creates a player. Drop if seq isn't newer
+            // than the last one applied, or if the player is unknown.
+            // Payload: [seq:4][count:1][[playerId:8][x:2][y:2][facing:1]]...
+            constexpr OpCodeInfo S_Player_Spatial_Unreliable = {
+                    0x27,
+                    "Unreliable batch player position/facing update",
+                    "S_Player_Spatial_Unreliable",
+                    OpCodeInfo::VARIABLE_SIZE  // 6 + (13 * count)
+            };
         }
     }
 
@@ -254,6 +375,62 @@ namespace Protocol::Opcode {
         }
     }
 
+    // ========================================================================
+    // LOOKUP TABLES
+    // Every active opcode by direction, for code that only has the raw byte
+    // (packet trace decoder, debug output). Add new opcodes here too.
+    //
+    // WHY SPLIT BY DIRECTION:
+    // Opcode values are only unique per direction (e.g. 0x11 is
+    // S_Position_Correction server->client, but could be reused client->server).
+    // ========================================================================
+    inline constexpr OpCodeInfo ClientOpCodes[] = {
+            Connection::Client::C_Handshake_Request,
+            Connection::Client::C_Disconnect_Request,
+            Connection::Client::C_Pong_Response,
+            Connection::Client::C_Heartbeat_Request,
+            Connection::Client::C_Udp_Bind,
+            Connection::Client::C_Shard_Resume,
+            Movement::Client::C_Move_Request,
+            Movement::Client::C_Turn_Request,
+            Movement::Client::C_Warp_Request,
+            Movement::Client::C_Interact_Request,
+            Combat::Client::C_Attack_Request,
+    };
+
+    inline constexpr OpCodeInfo ServerOpCodes[] = {
+            Connection::Server::S_HandshakeAccepted,
+            Connection::Server::S_Handshake_Rejected,
+            Connection::Server::S_ServerShutdown,
+            Connection::Server::S_Disconnect_Acknowledged,
+            Connection::Server::S_Ping_Request,
+            Connection::Server::S_Heartbeat_Response,
+            Connection::Server::S_Udp_Token,
+            Connection::Server::S_Udp_Bound,
+            Connection::Server::S_Shard_Redirect,
+            LocalPlayer::Server::S_Welcome,
+            LocalPlayer::Server::S_Position_Correction,
+            LocalPlayer::Server::S_Facing_Correction,
+            LocalPlayer::Server::S_Warped,
+            Map::Server::S_Tile_Data,
+            Map::Server::S_Tile_Update,
+            Map::Server::S_Map_Info,
+            RemotePlayer::Server::S_Left_Game,
+            Batch::Server::S_Player_Spatial,
+            Batch::Server::S_Player_Spatial_Unreliable,
+    };
+
+    /// Find opcode metadata by raw value. Returns nullptr if unknown.
+    /// @param from_client true for client->server packets, false for server->client
+    constexpr const OpCodeInfo *Find(uint8_t op, bool from_client) {
+        if (from_client) {
+            for (const auto &info : ClientOpCodes) if (info.op == op) return &info;
+        } else {
+            for (const auto &info : ServerOpCodes) if (info.op == op) return &info;
+        }
+        return nullptr;
+    }
+
 } // namespace Protocol::Opcode
 
 // See UnusedOpCodes.h for planned but not yet implemented opcodes
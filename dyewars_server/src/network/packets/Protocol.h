@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -18,6 +19,7 @@
 
 namespace Protocol {
     constexpr uint32_t PORT = 8081;
+    constexpr uint16_t UDP_PORT = 8083;  // Optional spatial channel (--udp), 8082 is debug HTTP
     constexpr const char *ADDRESS = "0.0.0.0";
 
     // Packet framing
@@ -32,6 +34,8 @@ namespace Protocol {
 
     // Timing
     constexpr int HANDSHAKE_TIMEOUT_SECONDS = 5;
+    constexpr int PING_INTERVAL_SECONDS = 10;
+    constexpr int IDLE_TIMEOUT_SECONDS = 30;  // Three missed pings (any received frame resets it)
 
     // Leniency / Hacking
     constexpr uint8_t MAX_HEADER_VIOLATIONS = 3;
@@ -94,8 +98,10 @@ namespace Protocol {
         }
     }
 
+    // Readers take a span so they work both on owned vectors and on frames
+    // parsed in place from a connection's ReceiveRing (vectors convert implicitly).
     namespace PacketReader {
-        inline uint8_t ReadByte(const std::vector<uint8_t> &buffer, size_t &offset) {
+        inline uint8_t ReadByte(std::span<const uint8_t> buffer, size_t &offset) {
             // BOUNDS CHECK: Use subtraction instead of addition to prevent overflow.
             // If offset is SIZE_MAX, "offset + 1" wraps to 0, bypassing the check!
             // "buffer.size() - offset < 1" is safe because we check offset <= size first.
@@ -105,7 +111,7 @@ namespace Protocol {
             return buffer[offset++];
         }
 
-        inline uint16_t ReadShort(const std::vector<uint8_t> &buffer, size_t &offset) {
+        inline uint16_t ReadShort(std::span<const uint8_t> buffer, size_t &offset) {
             // Check if there's room for 2 bytes without overflow
             if (offset > buffer.size() || buffer.size() - offset < 2) {
                 throw std::out_of_range("Buffer too small for ReadShort");
@@ -123,7 +129,7 @@ namespace Protocol {
             return value;
         }
 
-        inline uint32_t ReadUInt(const std::vector<uint8_t> &buffer, size_t &offset) {
+        inline uint32_t ReadUInt(std::span<const uint8_t> buffer, size_t &offset) {
             // Check if there's room for 4 bytes without overflow
             if (offset > buffer.size() || buffer.size() - offset < 4) {
                 throw std::out_of_range("Buffer too small for ReadUInt");
@@ -154,11 +160,11 @@ namespace Protocol {
         // Also, the original had the same shift bug as ReadUInt.
         // Reinterpreting the bits via static_cast is correct for two's complement
         // (which is guaranteed as of C++20, and universal in practice).
-        inline int32_t ReadInt32(const std::vector<uint8_t> &buffer, size_t &offset) {
+        inline int32_t ReadInt32(std::span<const uint8_t> buffer, size_t &offset) {
             return static_cast<int32_t>(ReadUInt(buffer, offset));
         }
 
-        inline uint64_t ReadUInt64(const std::vector<uint8_t> &buffer, size_t &offset) {
+        inline uint64_t ReadUInt64(std::span<const uint8_t> buffer, size_t &offset) {
             // Check if there's room for 8 bytes without overflow
             if (offset > buffer.size() || buffer.size() - offset < 8) {
                 throw std::out_of_range("Buffer too small for ReadUInt64");
@@ -181,7 +187,7 @@ namespace Protocol {
             return value;
         }
 
-        inline int64_t ReadInt64(const std::vector<uint8_t> &buffer, size_t &offset) {
+        inline int64_t ReadInt64(std::span<const uint8_t> buffer, size_t &offset) {
             return static_cast<int64_t>(ReadUInt64(buffer, offset));
         }
     }
@@ -15,7 +15,7 @@
 namespace Protocol::Opcode::Unused {
 
     // ========================================================================
-    // LOCAL PLAYER (Server -> Client) - 0x13-0x19
+    // LOCAL PLAYER (Server -> Client) - 0x13-0x18
     // ========================================================================
     namespace LocalPlayer {
         // Stats update (HP, MP, etc).
@@ -71,48 +71,13 @@ namespace Protocol::Opcode::Unused {
             "S_Appearance_Changed",
             OpCodeInfo::VARIABLE_SIZE
         };
-
-        // Warped to new location.
-        // Payload: [mapId:2][x:2][y:2]
-        constexpr OpCodeInfo S_Warped = {
-            0x19,
-            "Server notifies warp",
-            "S_Warped",
-            7  // opcode(1) + mapId(2) + x(2) + y(2)
-        };
     }
 
     // ========================================================================
-    // MAP DATA (Server -> Client) - 0x1A-0x1E
+    // MAP DATA (Server -> Client) - 0x1D-0x1E
+    // S_Tile_Data, S_Tile_Update and S_Map_Info are active (see OpCodes.h)
     // ========================================================================
     namespace Map {
-        // Full tile data for visible region + buffer.
-        // Payload: [mapId:2][originX:2][originY:2][width:1][height:1][tileData:width*height*2]
-        constexpr OpCodeInfo S_Tile_Data = {
-            0x1A,
-            "Server sends tile data",
-            "S_Tile_Data",
-            OpCodeInfo::VARIABLE_SIZE
-        };
-
-        // Partial tile update (for streaming/delta).
-        // Payload: [count:1][[x:2][y:2][tileId:2]]...
-        constexpr OpCodeInfo S_Tile_Update = {
-            0x1B,
-            "Server sends tile update",
-            "S_Tile_Update",
-            OpCodeInfo::VARIABLE_SIZE
-        };
-
-        // Map metadata (name, dimensions, flags).
-        // Payload: [mapId:2][width:2][height:2][flags:1][nameLength:1][name:variable]
-        constexpr OpCodeInfo S_Map_Info = {
-            0x1C,
-            "Server sends map info",
-            "S_Map_Info",
-            OpCodeInfo::VARIABLE_SIZE
-        };
-
         // Object layer data (trees, rocks, etc).
         // Payload: [originX:2][originY:2][width:1][height:1][objectData:variable]
         constexpr OpCodeInfo S_Object_Data = {
@@ -7,13 +7,14 @@
 #include "server/GameServer.h"
 #include "network/Packets/Protocol.h"
 #include "network/packets/Opcodes.h"
+#include "network/packets/outgoing/PacketSender.h"
 #include "game/actions/Actions.h"
 #include "core/Log.h"
 
 namespace PacketHandler {
     void Handle(
             const std::shared_ptr<ClientConnection> &client,
-            const std::vector<uint8_t> &data,
+            std::span<const uint8_t> data,
             GameServer *server
     ) {
         if (data.empty()) return;
@@ -62,6 +63,22 @@ namespace PacketHandler {
                 break;
             }
 
+            case Protocol::Opcode::Movement::Client::C_Warp_Request.op: {
+                if (data.size() != Protocol::Opcode::Movement::Client::C_Warp_Request.payloadSize) {
+                    Log::Warn("Warp packet size mismatch from client {} (got {}, expected {})",
+                              client_id, data.size(), Protocol::Opcode::Movement::Client::C_Warp_Request.payloadSize);
+                    return;
+                }
+                offset = 1;
+                const uint16_t map_id = Protocol::PacketReader::ReadShort(data, offset);
+                const auto x = static_cast<int16_t>(Protocol::PacketReader::ReadShort(data, offset));
+                const auto y = static_cast<int16_t>(Protocol::PacketReader::ReadShort(data, offset));
+
+                // Routed to the zone the client is in; it decides whether this changes maps
+                Actions::Movement::Warp(server, client_id, map_id, x, y);
+                break;
+            }
+
             case Protocol::Opcode::Movement::Client::C_Interact_Request.op: {
                 // TODO: Queue interact action
                 Log::Debug("Interact request from player {}", client_id);
@@ -79,10 +96,9 @@ namespace PacketHandler {
                 //
                 // RTT = now - time_when_ping_was_sent
                 //
-                // We use the atomic getter because:
-                // - Game thread writes ping_sent_time_ (via SendPingToAllClients → SendPing)
-                // - We're reading it here (IO thread)
-                // - Without atomics, we could get a torn read (half-updated timestamp)
+                // ping_sent_time_ is written by the connection's ping timer
+                // (OnPingTimer → SendPing), which also runs on this IO thread.
+                // It stays atomic because SendPing() is public.
                 //
                 auto now = std::chrono::steady_clock::now();
                 auto ping_sent = client->GetPingSentTime();
@@ -101,6 +117,12 @@ namespace PacketHandler {
                 break;
             }
 
+            case Protocol::Opcode::Connection::Client::C_Heartbeat_Request.op: {
+                // Receiving any frame already reset the idle timer - just ack
+                Packets::PacketSender::HeartbeatResponse(client);
+                break;
+            }
+
             default:
                 Log::Warn("Unknown opcode 0x{:02X} from client {}", opcode, client_id);
                 break;
@@ -4,17 +4,21 @@
 //
 #pragma once
 
+#include <cstdint>
 #include <memory>
-#include <vector>
+#include <span>
 
 class ClientConnection;
 
 class GameServer;
 
 namespace PacketHandler {
+    /// Dispatch one packet payload by opcode.
+    /// data points into the connection's receive ring - it is only valid for
+    /// the duration of this call, so copy anything that has to outlive it.
     void Handle(
             const std::shared_ptr<ClientConnection> &client,
-            const std::vector<uint8_t> &data,
+            std::span<const uint8_t> data,
             GameServer *server
     );
 }
\ No newline at end of file
@@ -78,6 +78,16 @@ namespace Packets::PacketSender {
         client->QueuePacket(pkt);
     }
 
+    inline void Warped(const std::shared_ptr<ClientConnection>& client, uint16_t map_id, int16_t x, int16_t y) {
+        Protocol::Packet pkt;
+        Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::LocalPlayer::Server::S_Warped.op);
+        Protocol::PacketWriter::WriteShort(pkt.payload, map_id);
+        Protocol::PacketWriter::WriteShort(pkt.payload, static_cast<uint16_t>(x));
+        Protocol::PacketWriter::WriteShort(pkt.payload, static_cast<uint16_t>(y));
+        pkt.size = static_cast<uint16_t>(pkt.payload.size());
+        client->QueuePacket(pkt);
+    }
+
     inline void PlayerLeft(const std::shared_ptr<ClientConnection>& client, uint64_t player_id) {
         Protocol::Packet pkt;
         Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::RemotePlayer::Server::S_Left_Game.op);
@@ -94,6 +104,31 @@ namespace Packets::PacketSender {
         client->QueuePacket(pkt);
     }
 
+    inline void UdpToken(const std::shared_ptr<ClientConnection>& client, uint64_t token, uint16_t udp_port) {
+        Protocol::Packet pkt;
+        Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::Connection::Server::S_Udp_Token.op);
+        Protocol::PacketWriter::WriteUInt64(pkt.payload, token);
+        Protocol::PacketWriter::WriteShort(pkt.payload, udp_port);
+        pkt.size = static_cast<uint16_t>(pkt.payload.size());
+        client->QueuePacket(pkt);
+    }
+
+    inline void ShardRedirect(const std::shared_ptr<ClientConnection>& client, uint16_t port, uint64_t token) {
+        Protocol::Packet pkt;
+        Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::Connection::Server::S_Shard_Redirect.op);
+        Protocol::PacketWriter::WriteShort(pkt.payload, port);
+        Protocol::PacketWriter::WriteUInt64(pkt.payload, token);
+        pkt.size = static_cast<uint16_t>(pkt.payload.size());
+        client->QueuePacket(pkt);
+    }
+
+    inline void HeartbeatResponse(const std::shared_ptr<ClientConnection>& client) {
+        Protocol::Packet pkt;
+        Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::Connection::Server::S_Heartbeat_Response.op);
+        pkt.size = static_cast<uint16_t>(pkt.payload.size());
+        client->QueuePacket(pkt);
+    }
+
     inline void GivePlayerID(const std::shared_ptr<ClientConnection>& client) {
         Protocol::Packet pkt;
         Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::Connection::Server::S_HandshakeAccepted.op);
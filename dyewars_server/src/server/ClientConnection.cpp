@@ -1,11 +1,14 @@
 #include "ClientConnection.h"
 #include "GameServer.h" // Needed here to call Server methods
 #include "network/BandwidthMonitor.h"
+#include "network/HandshakeCheck.h"
+#include "network/PacketTrace.h"
+#include "network/SpatialConflation.h"
 #include "network/Packets/OpCodes.h"
 #include "network/packets/incoming/PacketHandler.h"
+#include "GatewayLink.h"
 #include <core/Log.h>
 #include <fstream>
-#include <iomanip>
 
 using namespace Protocol::Opcode;
 
@@ -35,14 +38,15 @@ static std::string ExtractClientIP(asio::ip::tcp::socket& socket) {
 
 ClientConnection::ClientConnection(asio::ip::tcp::socket socket,
                                    GameServer *server,
-                                   const uint64_t client_id)
+                                   const uint64_t client_id,
+                                   TimerWheel &timers)
     // MEMBER INITIALIZER LIST ORDER:
     // Members are initialized in the order they're DECLARED in the class,
     // NOT the order they appear in the initializer list. The compiler will
     // warn if these don't match. We list them in declaration order for clarity.
     : server_(server),                           // First: back-reference to server
       socket_(std::move(socket)),                // Second: take ownership of socket
-      handshake_timer_(socket_.get_executor()),  // Third: timer using socket's executor
+      timers_(timers),                           // Third: the IO thread's timer wheel
       client_id_(client_id),                     // Fourth: immutable client ID
       client_ip_(ExtractClientIP(socket_)),      // Fifth: immutable IP (must use helper for const)
       client_hostname_(client_ip_)               // Sixth: hostname = IP for now
@@ -54,6 +58,22 @@ ClientConnection::ClientConnection(asio::ip::tcp::socket socket,
     // so it would need to be done asynchronously on a worker thread.
 }
 
+ClientConnection::ClientConnection(Remote remote,
+                                   GameServer *server,
+                                   const uint64_t client_id,
+                                   TimerWheel &timers)
+    // The socket is never opened - it only pins us to the session's IO thread
+    : server_(server),
+      socket_(remote.gateway->Executor()),
+      timers_(timers),
+      client_id_(client_id),
+      client_ip_(std::move(remote.ip)),
+      client_hostname_(client_ip_),
+      gateway_(std::move(remote.gateway)),
+      gateway_client_id_(remote.gateway_client_id),
+      resume_token_(remote.resume_token) {
+}
+
 ClientConnection::~ClientConnection() {
     CloseSocket();
 }
@@ -61,11 +81,24 @@ ClientConnection::~ClientConnection() {
 void ClientConnection::Start() {
     Log::Info("IP: {} Hostname: {} starting client connection.", client_ip_, client_hostname_);
 
-    //5 seconds to respond
-    StartHandshakeTimeout();
+    if (gateway_) {
+        // The gateway already checked the handshake - straight to login
+        asio::post(socket_.get_executor(), [self = shared_from_this()]() {
+            self->handshake_complete_ = true;
+            self->server_->OnClientLogin(self);
+        });
+        return;
+    }
+
+    // The acceptor runs on the primary context, but the timer wheel belongs
+    // to this socket's context - hop over before touching it.
+    asio::post(socket_.get_executor(), [self = shared_from_this()]() {
+        //5 seconds to respond
+        self->StartHandshakeTimeout();
 
-    //Begin reading
-    ReadPacketHeader();
+        //Begin reading
+        self->StartRead();
+    });
 }
 
 void ClientConnection::Disconnect(const std::string &reason) {
@@ -98,9 +131,15 @@ void ClientConnection::Disconnect(const std::string &reason) {
 
     // Close any pending I/O immediately.
     // This stops the async read chain and prevents new packets from being processed.
-    handshake_timer_.cancel();
+    // Timers belong to the IO thread's wheel: dispatch runs inline when we're
+    // already there, otherwise it's posted (game thread kicks, shutdown).
+    asio::dispatch(socket_.get_executor(), [self]() { self->CancelTimers(); });
     CloseSocket();
 
+    // Remote: tell the gateway to drop the socket. When the gateway reported
+    // the close itself, it ignores this for the ID it already forgot.
+    if (gateway_) gateway_->CloseClient(gateway_client_id_, reason);
+
     // IMPORTANT: All state cleanup (player removal, client removal, limiter update)
     // is now handled by OnClientDisconnect, which queues the work on the game thread.
     //
@@ -111,7 +150,8 @@ void ClientConnection::Disconnect(const std::string &reason) {
     //
     // By queuing via OnClientDisconnect, all modifications happen on ONE thread
     // (the game thread), eliminating the race.
-    server_->OnClientDisconnect(id, ip);
+    // Remote clients never took a limiter slot here - the gateway holds it
+    server_->OnClientDisconnect(id, gateway_ ? std::string() : ip);
 
     Log::Info("Client {} IP: {} disconnected.", id, ip);
 }
@@ -134,12 +174,72 @@ void ClientConnection::QueuePacket(const Protocol::Packet &pkt) {
 }
 
 void ClientConnection::QueueRaw(std::shared_ptr<std::vector<uint8_t>> data) {
-    // Track bandwidth (safe to call from any thread)
-    BandwidthMonitor::Instance().RecordOutgoing(data->size());
+    if (gateway_) {
+        // Backpressure, bandwidth and the socket write happen at the gateway
+        if (data->size() > Protocol::HEADER_SIZE) {
+            PacketTrace::Instance().Record(PacketTraceFormat::Direction::ServerToClient, client_id_,
+                                           std::span<const uint8_t>(*data).subspan(Protocol::HEADER_SIZE));
+        }
+        gateway_->Deliver(gateway_client_id_, std::move(data));
+        return;
+    }
 
+    namespace Op = Protocol::Opcode;
+    const uint8_t opcode = data->size() > Protocol::HEADER_SIZE ? (*data)[Protocol::HEADER_SIZE] : 0;
+    auto &stats = server_->Stats();
+
+    bool kick = false;
     {
         std::lock_guard lock(send_mutex_);
-        send_queue_.push(std::move(data));
+        if (send_queue_overflowed_) return;  // Already being kicked, don't grow further
+
+        const size_t packets = send_queue_.size();
+        const bool over_conflate = packets >= SEND_QUEUE_CONFLATE_PACKETS ||
+                                   send_queue_bytes_ >= SEND_QUEUE_CONFLATE_BYTES;
+        const bool over_drop = packets >= SEND_QUEUE_DROP_PACKETS ||
+                               send_queue_bytes_ >= SEND_QUEUE_DROP_BYTES;
+
+        if (over_conflate && opcode == Op::Batch::Server::S_Player_Spatial.op) {
+            // Tier 1: fold this batch and every queued one into latest-per-player
+            stats.RecordSendQueueConflation(SpatialConflation::Conflate(send_queue_, data));
+            send_queue_bytes_ = 0;
+            for (const auto &packet : send_queue_) send_queue_bytes_ += packet->size();
+        } else if (over_drop && (opcode == Op::Connection::Server::S_Ping_Request.op ||
+                                 opcode == Op::Connection::Server::S_Heartbeat_Response.op)) {
+            // Tier 2: nothing breaks if these never arrive
+            stats.RecordSendQueueDrop();
+            return;
+        } else {
+            send_queue_bytes_ += data->size();
+            send_queue_.push_back(data);
+        }
+
+        // Tier 3: conflation and dropping didn't keep up
+        if (send_queue_.size() >= SEND_QUEUE_KICK_PACKETS || send_queue_bytes_ >= SEND_QUEUE_KICK_BYTES) {
+            send_queue_overflowed_ = true;
+            send_queue_.clear();  // Free the memory now, the client is going away
+            send_queue_bytes_ = 0;
+            kick = true;
+        }
+        UpdateQueueDepthLocked();
+    }
+
+    if (kick) {
+        stats.RecordSlowConsumerKick();
+        // Disconnect touches the socket, so it must run on the IO thread
+        asio::post(socket_.get_executor(), [self = shared_from_this()]() {
+            self->Disconnect("slow consumer: send queue overflow");
+        });
+        return;
+    }
+
+    // Track bandwidth (safe to call from any thread)
+    BandwidthMonitor::Instance().RecordOutgoing(data->size());
+
+    // Trace the payload without the framing header (lock-free, any thread)
+    if (data->size() > Protocol::HEADER_SIZE) {
+        PacketTrace::Instance().Record(PacketTraceFormat::Direction::ServerToClient, client_id_,
+                                       std::span<const uint8_t>(*data).subspan(Protocol::HEADER_SIZE));
     }
 
     // Dispatch to IO thread to process the queue
@@ -148,6 +248,11 @@ void ClientConnection::QueueRaw(std::shared_ptr<std::vector<uint8_t>> data) {
     });
 }
 
+void ClientConnection::UpdateQueueDepthLocked() {
+    queued_packets_.store(send_queue_.size(), std::memory_order_relaxed);
+    queued_bytes_.store(send_queue_bytes_, std::memory_order_relaxed);
+}
+
 void ClientConnection::StartNextSend() {
     // IO thread only - no lock needed for write_in_progress_
     if (write_in_progress_) return;
@@ -157,7 +262,9 @@ void ClientConnection::StartNextSend() {
         std::lock_guard lock(send_mutex_);
         if (send_queue_.empty()) return;
         data = std::move(send_queue_.front());
-        send_queue_.pop();
+        send_queue_.pop_front();
+        send_queue_bytes_ -= data->size();
+        UpdateQueueDepthLocked();
     }
 
     write_in_progress_ = true;
@@ -180,72 +287,92 @@ void ClientConnection::OnSendComplete(const std::error_code& ec) {
 }
 
 /// Receive
-void ClientConnection::ReadPacketHeader() {
-    auto self(shared_from_this());
-    asio::async_read(socket_, asio::buffer(header_buffer_, 4),
-                     [this, self](std::error_code ec, std::size_t) {
-                         if (ec) {
-                             Disconnect(handshake_complete_ ? "connection lost" : "connection closed before handshake");
-                             return;
-                         }
-
-                         // Validate header
-                         if (header_buffer_[0] != Protocol::MAGIC_1 ||
-                             header_buffer_[1] != Protocol::MAGIC_2) {
-
-                             if (!handshake_complete_) {
-                                 Log::Trace(
-                                         "Invalid magic bytes from client: {} when expecting handshake. Got 0x{:02X} 0x{:02X}",
-                                         client_id_, header_buffer_[0], header_buffer_[1]);
-                                 FailHandshake("invalid header while waiting for handshake");
-                             } else {
-                                 Log::Warn("Client {} sent invalid magic bytes", client_id_);
-                                 HandleProtocolViolation();
-                             }
-                             return;
-                         }
-
-                         // Validate size
-                         uint16_t size = static_cast<uint16_t>((header_buffer_[2] << 8) | header_buffer_[3]);
-                         if (size == 0 || size >= Protocol::MAX_PAYLOAD_SIZE) {
-                             Log::Warn("Client {} sent invalid size: {}", client_id_, size);
-                             if (!handshake_complete_) {
-                                 FailHandshake("invalid packet size");
-                             } else {
-                                 HandleProtocolViolation();
-                             }
-                             return;
-                         }
-                         ReadPacketPayload(size);
-                     });
-}
-
-void ClientConnection::ReadPacketPayload(uint16_t size) {
+void ClientConnection::StartRead() {
     auto self(shared_from_this());
-    auto buffer = std::make_shared<std::vector<uint8_t>>(size);
-    asio::async_read(socket_,
-                     asio::buffer(*buffer),
-                     [this, self, buffer, size](const std::error_code ec, std::size_t) {
-                         if (ec) {
-                             Disconnect("read error");
-                             return;
-                         }
-                         BandwidthMonitor::Instance().RecordIncoming(size + 4);  // payload + header
-                         LogPacketReceived(*buffer, size);
-                         // If handshake not complete, this must be the handshake packet
-                         if (!handshake_complete_) {
-                             CheckIfHandshakePacket(*buffer);
-                         } else {
-                             HandlePacket(*buffer);
-                         }
-                         // Only continue reading if socket is still open
-                         if (socket_.is_open()) {
-                             ReadPacketHeader();
-                         }
-                     });
-}
-
-void ClientConnection::HandlePacket(const std::vector<uint8_t> &data) {
+    // async_read_some completes with however many bytes arrived (at least 1).
+    // One completion can carry a fragment of a frame, or many whole frames.
+    socket_.async_read_some(asio::buffer(recv_ring_.WritePtr(), recv_ring_.WritableBytes()),
+                            [this, self](std::error_code ec, std::size_t bytes_read) {
+                                if (ec) {
+                                    Disconnect(handshake_complete_ ? "connection lost" : "connection closed before handshake");
+                                    return;
+                                }
+                                recv_ring_.Commit(bytes_read);
+                                last_receive_tick_ = timers_.CurrentTick();
+                                ProcessReceivedFrames();
+
+                                // Only continue reading if socket is still open
+                                if (socket_.is_open()) {
+                                    recv_ring_.Compact();
+                                    StartRead();
+                                }
+                            });
+}
+
+void ClientConnection::ProcessReceivedFrames() {
+    // Stop as soon as the socket closes (handshake failure, kick, etc.) -
+    // anything still in the ring belongs to a connection that's going away.
+    while (socket_.is_open()) {
+        uint16_t size = 0;
+        const auto status = recv_ring_.PeekFrame(size);
+
+        if (status == ReceiveRing::FrameStatus::NeedMore) {
+            return;  // Fragment - wait for the next read to complete it
+        }
+
+        if (status == ReceiveRing::FrameStatus::BadMagic) {
+            if (!handshake_complete_) {
+                const auto [magic_1, magic_2] = recv_ring_.PeekMagic();
+                Log::Trace(
+                        "Invalid magic bytes from client: {} when expecting handshake. Got 0x{:02X} 0x{:02X}",
+                        client_id_, magic_1, magic_2);
+                FailHandshake("invalid header while waiting for handshake");
+                return;
+            }
+            Log::Warn("Client {} sent invalid magic bytes", client_id_);
+            // Skip just the bad header and try to resync on what follows,
+            // same as the old header-by-header read chain did.
+            recv_ring_.Consume(Protocol::HEADER_SIZE);
+            HandleProtocolViolation();
+            continue;
+        }
+
+        if (status == ReceiveRing::FrameStatus::BadSize) {
+            Log::Warn("Client {} sent invalid size: {}", client_id_, size);
+            if (!handshake_complete_) {
+                FailHandshake("invalid packet size");
+                return;
+            }
+            recv_ring_.Consume(Protocol::HEADER_SIZE);
+            HandleProtocolViolation();
+            continue;
+        }
+
+        // FrameStatus::Ready - dispatch in place, no copy
+        const auto payload = recv_ring_.Payload(size);
+        BandwidthMonitor::Instance().RecordIncoming(size + Protocol::HEADER_SIZE);
+        PacketTrace::Instance().Record(PacketTraceFormat::Direction::ClientToServer, client_id_, payload);
+
+        // If handshake not complete, this must be the handshake packet
+        if (!handshake_complete_) {
+            CheckIfHandshakePacket(payload);
+        } else {
+            HandlePacket(payload);
+        }
+
+        // Handlers are done with the span, release the frame
+        recv_ring_.Consume(Protocol::HEADER_SIZE + size);
+    }
+}
+
+void ClientConnection::HandleRemotePacket(std::span<const uint8_t> payload) {
+    // The gateway checked framing, but a bad payload must not reach the assert in PacketHandler
+    if (disconnecting_ || payload.empty() || payload.size() >= Protocol::MAX_PAYLOAD_SIZE) return;
+    PacketTrace::Instance().Record(PacketTraceFormat::Direction::ClientToServer, client_id_, payload);
+    HandlePacket(payload);
+}
+
+void ClientConnection::HandlePacket(std::span<const uint8_t> data) {
     if (data.empty()) return;
     // Forward to PacketHandler - we don't process game logic here
     PacketHandler::Handle(shared_from_this(), data, server_);
@@ -256,20 +383,13 @@ void ClientConnection::HandlePacket(const std::vector<uint8_t> &data) {
 // ============================================================================
 
 void ClientConnection::StartHandshakeTimeout() {
-    auto self(shared_from_this());
-
-    handshake_timer_.expires_after(std::chrono::seconds(Protocol::HANDSHAKE_TIMEOUT_SECONDS));
-    handshake_timer_.async_wait(
-            [this, self](const std::error_code &ec) {
-                OnHandshakeTimeout(ec);
-            });
+    handshake_timer_ = timers_.Arm(
+            TimerWheel::TicksFor(std::chrono::seconds(Protocol::HANDSHAKE_TIMEOUT_SECONDS)),
+            weak_from_this(), TIMER_HANDSHAKE);
 }
 
-void ClientConnection::OnHandshakeTimeout(const std::error_code &ec) {
-    // If timer was cancelled (handshake succeeded), do nothing
-    if (ec == asio::error::operation_aborted) {
-        return;
-    }
+void ClientConnection::OnHandshakeTimeout() {
+    handshake_timer_ = TimerWheel::NO_TIMER;
 
     // Timer expired - no handshake received
     if (!handshake_complete_) {
@@ -277,45 +397,24 @@ void ClientConnection::OnHandshakeTimeout(const std::error_code &ec) {
     }
 }
 
-void ClientConnection::CheckIfHandshakePacket(const std::vector<uint8_t> &data) {
-    /// \note
-    /// Expected format:\n
-    /// Byte 0: Opcode (0x00)\n
-    /// Bytes 1-2: Protocol version (0x00 0x01)\n
-    /// Bytes 3-6: Client magic ("DYEW" = 0x44 0x59 0x45 0x57)\n
-    const auto &op = Protocol::Opcode::Connection::Client::C_Handshake_Request;
-
-    if (data.size() != op.payloadSize) {
-        return FailHandshake(std::format("invalid packet size (got {}, expected {})",
-                                         data.size(), op.payloadSize));
-    }
-
-    size_t offset = 0;
-    uint8_t opcode = Protocol::PacketReader::ReadByte(data, offset);
-    uint16_t version = Protocol::PacketReader::ReadShort(data, offset);
-    uint32_t magic = Protocol::PacketReader::ReadUInt(data, offset);
-
-    if (opcode != op.op) {
-        return FailHandshake(std::format("expected opcode 0x{:02X}, got 0x{:02X}", op.op, opcode));
-    }
-
-    if (version != Protocol::VERSION) {
-        return FailHandshake(std::format("version mismatch (client: 0x{:04X}, server: 0x{:04X})",
-                                         version, Protocol::VERSION));
-    }
-
-    if (magic != Protocol::CLIENT_MAGIC) {
-        FailHandshake("invalid client identifier");
+void ClientConnection::CheckIfHandshakePacket(std::span<const uint8_t> data) {
+    // Same rules as the gateway (see HandshakeCheck)
+    const auto result = HandshakeCheck::Validate(data);
+    if (!result.ok) {
+        FailHandshake(result.error);
         return;
     }
+    resume_token_ = result.resume_token;
 
     // Handshake successful!
     CompleteHandshake();
 }
 
 void ClientConnection::CompleteHandshake() {
-    handshake_timer_.cancel();
+    timers_.Cancel(handshake_timer_);
+    handshake_timer_ = TimerWheel::NO_TIMER;
     handshake_complete_ = true;
+    StartKeepalive();
 
 
     auto self(shared_from_this());
@@ -345,7 +444,7 @@ void ClientConnection::FailHandshake(const std::string &reason) {
     server_->Limiter().RemoveConnection(client_ip_);
 
     LogFailedConnection(reason);
-    handshake_timer_.cancel();
+    CancelTimers();  // Always on the IO thread: frame parsing or the handshake timer
     CloseSocket();
 
     // Note: We don't call OnClientDisconnect because:
@@ -356,8 +455,8 @@ void ClientConnection::FailHandshake(const std::string &reason) {
 
 /// =============================\n
 /// LOGGING\n
-/// Both functions do I/O (file, stdout)—expensive and blocking. \n
-/// Fine for debugging, but you'll want to remove or async these in production.\n
+/// File I/O—expensive and blocking, but only runs on failed handshakes.\n
+/// Per-packet logging lives in PacketTrace (lock-free, off by default).\n
 /// =============================\n
 void ClientConnection::LogFailedConnection(const std::string &reason) const {
     std::ofstream logfile("failed_connections.log", std::ios::app);
@@ -374,31 +473,11 @@ void ClientConnection::LogFailedConnection(const std::string &reason) const {
     }
 }
 
-void ClientConnection::LogPacketReceived(const std::vector<uint8_t> &payload, uint16_t size) {
-    std::cout << "Packet Received: 11 68 ";
-
-    // Print size as two hex bytes (big-endian)
-    std::cout << std::hex << std::uppercase << std::setfill('0');
-    std::cout << std::setw(2) << ((size >> 8) & 0xFF) << " ";
-    std::cout << std::setw(2) << (size & 0xFF) << " ";
-
-    // Print payload bytes
-    for (size_t i = 0; i < payload.size() && i < 20; i++) {
-        std::cout << std::setw(2) << static_cast<int>(payload[i]) << " ";
-    }
-
-    if (payload.size() > 20) {
-        std::cout << "...";
-    }
-
-    std::cout << std::dec << " (" << size << " bytes)" << std::endl;
-}
-
 void ClientConnection::HandleProtocolViolation() {
+    // No read restart here - ProcessReceivedFrames keeps parsing the ring
+    // and StartRead resumes once it's drained (if we're still connected).
     if (++protocol_violations_ >= Protocol::MAX_HEADER_VIOLATIONS) {
         Disconnect("too many protocol violations");
-    } else if (socket_.is_open()) {
-        ReadPacketHeader();
     }
 }
 
@@ -428,6 +507,60 @@ void ClientConnection::RecordPing(uint32_t ping_ms) {
     ping_.Record(ping_ms);
 }
 
+// ============================================================================
+// TIMERS (IO thread, fired by the wheel)
+// ============================================================================
+
+void ClientConnection::OnTimer(uint32_t tag) {
+    // Timers cancelled by Disconnect() from another thread may still fire
+    // before the cancel is posted over - nothing to do for a dying connection.
+    if (disconnecting_) return;
+
+    switch (tag) {
+        case TIMER_HANDSHAKE: OnHandshakeTimeout(); break;
+        case TIMER_PING:      OnPingTimer(); break;
+        case TIMER_IDLE:      OnIdleTimer(); break;
+        default: break;
+    }
+}
+
+void ClientConnection::StartKeepalive() {
+    // Stagger first pings by client id so clients that connected together
+    // (server restart, bot spawn) don't all ping in the same wheel tick.
+    const uint64_t ping_ticks = TimerWheel::TicksFor(std::chrono::seconds(Protocol::PING_INTERVAL_SECONDS));
+    ping_timer_ = timers_.Arm(ping_ticks + client_id_ % ping_ticks, weak_from_this(), TIMER_PING);
+
+    last_receive_tick_ = timers_.CurrentTick();
+    idle_timer_ = timers_.Arm(TimerWheel::TicksFor(std::chrono::seconds(Protocol::IDLE_TIMEOUT_SECONDS)),
+                              weak_from_this(), TIMER_IDLE);
+}
+
+void ClientConnection::OnPingTimer() {
+    SendPing();
+    ping_timer_ = timers_.Arm(TimerWheel::TicksFor(std::chrono::seconds(Protocol::PING_INTERVAL_SECONDS)),
+                              weak_from_this(), TIMER_PING);
+}
+
+void ClientConnection::OnIdleTimer() {
+    // Reads don't touch the wheel - they just stamp last_receive_tick_.
+    // When the timer fires, re-arm for whatever is left of the window.
+    const uint64_t timeout = TimerWheel::TicksFor(std::chrono::seconds(Protocol::IDLE_TIMEOUT_SECONDS));
+    const uint64_t idle = timers_.CurrentTick() - last_receive_tick_;
+    if (idle >= timeout) {
+        idle_timer_ = TimerWheel::NO_TIMER;
+        Disconnect(std::format("idle timeout (no data for {} seconds)", Protocol::IDLE_TIMEOUT_SECONDS));
+        return;
+    }
+    idle_timer_ = timers_.Arm(timeout - idle, weak_from_this(), TIMER_IDLE);
+}
+
+void ClientConnection::CancelTimers() {
+    timers_.Cancel(handshake_timer_);
+    timers_.Cancel(ping_timer_);
+    timers_.Cancel(idle_timer_);
+    handshake_timer_ = ping_timer_ = idle_timer_ = TimerWheel::NO_TIMER;
+}
+
 // --- SENDING FUNCTIONS ---
 /*
 
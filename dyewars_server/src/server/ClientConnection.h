@@ -5,15 +5,18 @@
 #include <memory>
 #include <vector>
 #include <deque>
-#include <queue>
 #include <mutex>
+#include <span>
 #include <unordered_set>
 #include "IClientConnection.h"
 #include "network/Packets/Protocol.h"
+#include "network/ReceiveRing.h"
+#include "network/TimerWheel.h"
 #include "core/ThreadSafety.h"
 
 // Forward declaration to avoid circular dependency
 class GameServer;
+class GatewaySession;
 
 /// Rolling average of last N ping samples.
 /// Record() from IO thread only, Get() from any thread.
@@ -49,6 +52,23 @@ private:
 /// - Validate handshake (magic bytes, protocol version)
 /// - Read/write packets asynchronously via ASIO
 /// - Track ping for latency compensation
+/// - Disconnect idle clients (no frames for IDLE_TIMEOUT_SECONDS)
+///
+/// REMOTE MODE (--gateway):
+/// A client behind a gateway process has no socket here. The gateway did
+/// the handshake and runs pings and idle checks; this object only carries
+/// the client's identity into the game. The gateway reports each pong's
+/// RTT (ClientPing) into RecordPing, so GetPing averages the same samples
+/// a direct connection would. QueueRaw hands packets to the
+/// GatewaySession with no send queue here: the client's queue is in the
+/// gateway (GatewayClient::Send), which applies the same backpressure
+/// tiers. The session feeds the client's frames in through
+/// HandleRemotePacket on its IO thread.
+///
+/// TIMERS:
+/// Handshake deadline, ping schedule and idle check are entries in the IO
+/// thread's TimerWheel (see IoContextPool), not per-connection asio timers.
+/// They fire through OnTimer() on this connection's IO thread.
 ///
 /// THREAD SAFETY:
 /// --------------
@@ -57,7 +77,7 @@ private:
 ///
 ///   - client_id_: Immutable after construction, safe to read anywhere
 ///   - client_ip_: Immutable after construction, safe to read anywhere
-///   - ping_sent_time_: Atomic, written by game thread, read by IO thread
+///   - ping_sent_time_: Atomic, written and read on the IO thread, read by stats
 ///   - ping_ (PingTracker): Thread-safe internally (atomic average)
 ///   - disconnecting_: Atomic, used for double-disconnect prevention
 ///
@@ -65,12 +85,27 @@ private:
 /// game thread still holds a reference. Operations may fail (socket closed),
 /// but they won't crash.
 /// ============================================================================
-class ClientConnection : public std::enable_shared_from_this<ClientConnection> {
+class ClientConnection : public std::enable_shared_from_this<ClientConnection>,
+                         public TimerWheel::Target {
 public:
+    /// @param timers Wheel of the io_context the socket belongs to
     explicit ClientConnection(
             asio::ip::tcp::socket socket,
             GameServer *server,
-            uint64_t client_id);
+            uint64_t client_id,
+            TimerWheel &timers);
+
+    /// Where a remote (gateway) client lives
+    struct Remote {
+        std::shared_ptr<GatewaySession> gateway;
+        uint64_t gateway_client_id;  // The gateway's ID for it
+        std::string ip;              // The client's address, as the gateway saw it
+        uint64_t resume_token;       // From C_Shard_Resume, 0 otherwise
+    };
+
+    /// A client behind a gateway. Handshake is already complete.
+    /// @param timers Wheel of the gateway session's io_context
+    ClientConnection(Remote remote, GameServer *server, uint64_t client_id, TimerWheel &timers);
 
     ~ClientConnection();
 
@@ -78,7 +113,7 @@ public:
     // LIFECYCLE
     // =========================================================================
 
-    /// Start reading packets from this connection
+    /// Start reading packets from this connection (any thread - posts to the IO thread)
     void Start();
 
     /// Gracefully disconnect with a reason (logs and cleans up)
@@ -97,15 +132,45 @@ public:
     /// Queue a framed packet for sending (thread-safe, called from game thread)
     void QueuePacket(const Protocol::Packet &pkt);
 
-    /// Queue raw bytes for sending (thread-safe, caller must include framing)
+    /// Queue raw bytes for sending (thread-safe, caller must include framing).
+    /// Applies the backpressure policy below - the packet may be conflated,
+    /// dropped, or the connection kicked if the client isn't keeping up.
     void QueueRaw(std::shared_ptr<std::vector<uint8_t>> data);
 
+    // =========================================================================
+    // BACKPRESSURE (slow consumer protection)
+    //
+    // A healthy client drains its queue every tick, so it rarely holds more
+    // than a few packets. A client on a bad link doesn't, and without a
+    // bound its stale spatial batches pile up until the server runs out of
+    // memory. Each mark is checked against packets OR bytes:
+    //
+    //   1. CONFLATE: queued S_Player_Spatial batches are merged so only the
+    //      latest position per player is kept (older ones are stale anyway).
+    //   2. DROP:     non-critical packets (pings, heartbeat acks) are dropped.
+    //   3. KICK:     still growing - disconnect with "slow consumer".
+    // =========================================================================
+
+    static constexpr size_t SEND_QUEUE_CONFLATE_PACKETS = 64;       // ~3 sec of spatial batches
+    static constexpr size_t SEND_QUEUE_CONFLATE_BYTES = 64 * 1024;
+    static constexpr size_t SEND_QUEUE_DROP_PACKETS = 256;
+    static constexpr size_t SEND_QUEUE_DROP_BYTES = 256 * 1024;
+    static constexpr size_t SEND_QUEUE_KICK_PACKETS = 1024;
+    static constexpr size_t SEND_QUEUE_KICK_BYTES = 1024 * 1024;
+
+    /// Packets waiting in the send queue (excludes the one being written). Any thread.
+    size_t GetQueuedPackets() const { return queued_packets_.load(std::memory_order_relaxed); }
+
+    /// Bytes waiting in the send queue (excludes the one being written). Any thread.
+    size_t GetQueuedBytes() const { return queued_bytes_.load(std::memory_order_relaxed); }
+
     // =========================================================================
     // PING
     // Server sends ping request, client echoes back, we measure RTT
     // =========================================================================
 
-    /// Send a ping request to this client (0xF8)
+    /// Send a ping request to this client (0xF8).
+    /// Scheduled every PING_INTERVAL_SECONDS by the connection's ping timer.
     void SendPing();
 
     /// Record a ping sample and update rolling average
@@ -119,8 +184,8 @@ public:
     ///
     /// WHY THIS IS NEEDED:
     /// When the client sends a pong back, PacketHandler (on IO thread) needs
-    /// to calculate RTT = now - ping_sent_time. The game thread sets this
-    /// value via SendPing(), so we need atomic access to prevent torn reads.
+    /// to calculate RTT = now - ping_sent_time. SendPing() runs on the IO
+    /// thread too now, but SendPing is public, so keep access atomic.
     ///
     /// ALTERNATIVE APPROACHES:
     /// 1. Include timestamp in ping packet, client echoes it back (no shared state)
@@ -154,19 +219,44 @@ public:
     /// Check if handshake completed successfully.
     bool IsHandshakeComplete() const { return handshake_complete_; }
 
+    /// True for a client behind a gateway (see REMOTE MODE)
+    bool IsRemote() const { return gateway_ != nullptr; }
+
+    /// A frame the gateway forwarded for this client (session's IO thread)
+    void HandleRemotePacket(std::span<const uint8_t> payload);
+
+    /// Token from C_Shard_Resume, or 0 for a normal handshake. Written
+    /// before the Login command is queued, so the zone thread reads it safely.
+    uint64_t ResumeToken() const { return resume_token_; }
+
+    // =========================================================================
+    // TIMERS (TimerWheel::Target)
+    // =========================================================================
+
+    enum TimerTag : uint32_t {
+        TIMER_HANDSHAKE = 0,  // No valid handshake within HANDSHAKE_TIMEOUT_SECONDS
+        TIMER_PING = 1,       // Periodic S_Ping_Request
+        TIMER_IDLE = 2,       // No frames received for IDLE_TIMEOUT_SECONDS
+    };
+
+    /// Called by the wheel on this connection's IO thread
+    void OnTimer(uint32_t tag) override;
+
 private:
     // =========================================================================
-    // PACKET READING (async chain: Header -> Payload -> Handle -> Header...)
+    // PACKET READING (async chain: ReadSome -> ProcessFrames -> ReadSome...)
     // =========================================================================
 
-    /// Read 4-byte header: [magic:2][size:2]
-    void ReadPacketHeader();
+    /// Fill the receive ring with whatever bytes the socket has available
+    void StartRead();
 
-    /// Read payload of given size, then handle it
-    void ReadPacketPayload(uint16_t size);
+    /// Parse and dispatch every complete frame currently in the receive ring.
+    /// Partial frames stay in the ring until the next read completes them.
+    void ProcessReceivedFrames();
 
-    /// Route packet to PacketHandler for processing
-    void HandlePacket(const std::vector<uint8_t> &data);
+    /// Route packet to PacketHandler for processing.
+    /// The span points into recv_ring_ and is only valid during this call.
+    void HandlePacket(std::span<const uint8_t> data);
 
     /// Handle invalid packets (strike system before disconnect)
     void HandleProtocolViolation();
@@ -177,11 +267,23 @@ private:
     // =========================================================================
 
     void StartHandshakeTimeout();
-    void OnHandshakeTimeout(const std::error_code &ec);
-    void CheckIfHandshakePacket(const std::vector<uint8_t> &data);
+    void OnHandshakeTimeout();
+    void CheckIfHandshakePacket(std::span<const uint8_t> data);
     void CompleteHandshake();
     void FailHandshake(const std::string &reason);
 
+    // =========================================================================
+    // KEEPALIVE (after handshake)
+    // =========================================================================
+
+    /// Arm the ping and idle timers
+    void StartKeepalive();
+    void OnPingTimer();
+    void OnIdleTimer();
+
+    /// Cancel every wheel entry (IO thread only)
+    void CancelTimers();
+
     // =========================================================================
     // SEND QUEUE (IO thread processing)
     // =========================================================================
@@ -192,6 +294,9 @@ private:
     /// Handle completion of async_write (IO thread only)
     void OnSendComplete(const std::error_code& ec);
 
+    /// Recompute the depth mirrors after the queue changed. Caller holds send_mutex_.
+    void UpdateQueueDepthLocked();
+
     // =========================================================================
     // LOGGING
     // =========================================================================
@@ -199,9 +304,6 @@ private:
     /// Log failed connection to file for analysis
     void LogFailedConnection(const std::string &reason) const;
 
-    /// Debug: print packet bytes to console
-    static void LogPacketReceived(const std::vector<uint8_t> &payload, uint16_t size);
-
     // =========================================================================
     // DATA
     //
@@ -217,8 +319,22 @@ private:
 
     // --- Network (IO_THREAD only) ---
     asio::ip::tcp::socket socket_;
-    asio::steady_timer handshake_timer_;
-    uint8_t header_buffer_[4]{};  // Reused buffer for reading packet headers
+
+    /// The IO thread's timer wheel (non-owning, the pool outlives connections)
+    TimerWheel &timers_;
+
+    /// Wheel entries (IO_THREAD only). NO_TIMER when not armed.
+    TimerWheel::Handle handshake_timer_ = TimerWheel::NO_TIMER;
+    TimerWheel::Handle ping_timer_ = TimerWheel::NO_TIMER;
+    TimerWheel::Handle idle_timer_ = TimerWheel::NO_TIMER;
+
+    /// Wheel tick of the last completed read (IO_THREAD only).
+    /// The idle timer checks this lazily instead of being re-armed per read.
+    uint64_t last_receive_tick_ = 0;
+
+    /// Fixed receive buffer, filled by async_read_some and parsed in place.
+    /// Replaces the old 4-byte header buffer + per-packet payload vector.
+    ReceiveRing recv_ring_;
 
     // --- Identity (IMMUTABLE after construction) ---
     /// Unique identifier for this connection/client.
@@ -245,12 +361,20 @@ private:
     /// TODO: DNS reverse lookup is slow, would need async worker thread
     const std::string client_hostname_;
 
+    /// Remote mode only (IMMUTABLE): the gateway stream and its ID for us
+    const std::shared_ptr<GatewaySession> gateway_;
+    const uint64_t gateway_client_id_ = 0;
+
     // --- State (IO_THREAD primarily, with atomic for cross-thread) ---
 
     /// True once handshake packet validated.
     /// Only written from IO thread, but adding atomic just to be explicit.
     bool handshake_complete_ = false;
 
+    /// Shard handoff token (C_Shard_Resume), 0 otherwise. Written once by
+    /// the IO thread before OnClientLogin.
+    uint64_t resume_token_ = 0;
+
     /// Prevents double-disconnect from concurrent calls.
     ///
     /// WHY ATOMIC BOOL WITH compare_exchange:
@@ -276,8 +400,9 @@ private:
 
     /// Timestamp when we last sent a ping request.
     /// ATOMIC because:
-    ///   - Written by Game thread (SendPingToAllClients → SendPing → SetPingSentTime)
-    ///   - Read by IO thread (PacketHandler when pong arrives → GetPingSentTime)
+    ///   - Written by the ping timer (OnPingTimer → SendPing → SetPingSentTime)
+    ///   - Read by PacketHandler when the pong arrives (GetPingSentTime)
+    /// Both on the IO thread today, but SendPing() is public.
     ///
     /// WHY std::atomic<time_point> WORKS:
     /// std::chrono::steady_clock::time_point is typically 8 bytes (int64 nanoseconds).
@@ -293,7 +418,19 @@ private:
 
     /// Queue of packets waiting to be sent.
     /// Protected by send_mutex_. Populated from any thread, drained by IO thread.
-    std::queue<std::shared_ptr<std::vector<uint8_t>>> send_queue_;
+    /// A deque (not std::queue) so conflation can walk and rebuild it.
+    std::deque<std::shared_ptr<std::vector<uint8_t>>> send_queue_;
+
+    /// Total bytes in send_queue_. Protected by send_mutex_.
+    size_t send_queue_bytes_ = 0;
+
+    /// Set once the kick mark is hit - further packets are discarded while
+    /// the disconnect is posted to the IO thread. Protected by send_mutex_.
+    bool send_queue_overflowed_ = false;
+
+    /// Lock-free mirrors of the queue depth for stats (written under send_mutex_)
+    std::atomic<size_t> queued_packets_{0};
+    std::atomic<size_t> queued_bytes_{0};
 
     /// Mutex protecting send_queue_ access.
     std::mutex send_mutex_;
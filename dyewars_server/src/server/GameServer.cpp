@@ -4,29 +4,78 @@
 /// =======================================
 #include "GameServer.h"
 #include "ClientConnection.h"
-#include "FakeClientConnection.h"
+#include "GatewayLink.h"
+#include "Zone.h"
 #include "core/Log.h"
 #include "lua/LuaEngine.h"
-#include "network/BandwidthMonitor.h"
-#include "network/packets/outgoing/PacketSender.h"
+#include "network/IoContextPool.h"
+#include "network/ShardLink.h"
+#include "network/UdpSpatialChannel.h"
 #include "debug/DebugHttpServer.h"
 
 
-GameServer::GameServer(asio::io_context &io_context)
-        : io_context_(io_context),
-          acceptor_(
-                  io_context,
-                  asio::ip::tcp::endpoint(
-                          asio::ip::address::from_string(Protocol::ADDRESS),
-                          Protocol::PORT)),
-          world_(256, 256),
-          lua_engine_(std::make_shared<LuaGameEngine>()) {
-    Log::Info("Server starting on port {}...", Protocol::PORT);
+GameServer::GameServer(IoContextPool &io_pool, const ServerConfig &config)
+        : io_pool_(io_pool),
+          acceptor_(io_pool.Primary()),
+          lua_engine_(std::make_shared<LuaGameEngine>(&warps_)),
+          jobs_(JobSystem::ResolveWorkerCount(config.job_threads, config.io_threads, config.zones)),
+          input_log_(config.record_path.empty()
+                             ? nullptr
+                             : std::make_unique<InputLog>(config.record_path, InputLogFormat::Header{
+                                     static_cast<uint16_t>(config.tick.tps), config.deterministic,
+                                     config.seed, static_cast<uint16_t>(config.zones), config.open_warps})),
+          zones_(*this, config) {
+    if (input_log_) {
+        Log::Info("Recording commands to {}", input_log_->Path());
+        if (!config.deterministic) Log::Warn("--record without --deterministic: a replay won't match ids or bots");
+    }
+
+    // Lua set_tile / set_tile_blocked queue onto the map's zone
+    lua_engine_->SetTileEditSink([this](uint16_t map_id, const TileEdit &edit) {
+        return QueueTileEdit(map_id, edit);
+    });
+
+    // DyeWarsReplay: zones only, ticked by the caller
+    if (config.headless) {
+        stats_.SetZoneCount(zones_.Count());
+        return;
+    }
+
+    Log::Info("Server starting on port {}...", Protocol::PORT + config.PortOffset());
+    const asio::ip::tcp::endpoint endpoint(asio::ip::address::from_string(Protocol::ADDRESS),
+                                           static_cast<uint16_t>(Protocol::PORT + config.PortOffset()));
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
     StartAccept();
-    game_loop_thread_ = std::thread(&GameServer::GameLogicThread, this);
 
-    // Start debug HTTP server on port 8082 (game uses 8081)
-    debug_server_ = std::make_unique<DebugHttpServer>(io_context, 8082);
+    // Before the zones start - they read udp_channel_ and shard_link_ every tick
+    if (config.udp_spatial) {
+        udp_channel_ = std::make_unique<UdpSpatialChannel>(
+                io_pool.Primary(), static_cast<uint16_t>(Protocol::UDP_PORT + config.PortOffset()));
+        udp_channel_->Start();
+    }
+    if (config.shard_count > 1) {
+        const auto index = static_cast<uint8_t>(config.shard_index);
+        const auto count = static_cast<uint8_t>(config.shard_count);
+        shard_link_ = std::make_unique<ShardLink>(io_pool.Primary(), config.shard_dir, index, count);
+        shard_link_->Start();
+        stats_.SetShard(index, count);
+    }
+    if (config.gateway) {
+        gateway_link_ = std::make_unique<GatewayLink>(
+                io_pool, this, static_cast<uint16_t>(GatewayProtocol::PORT + config.PortOffset()));
+        gateway_link_->Start();
+    }
+
+    stats_.SetZoneCount(zones_.Count());
+    zones_.Start();
+
+    // Start debug HTTP server on port 8082 (game uses 8081), shifted like
+    // the game port for shards
+    debug_server_ = std::make_unique<DebugHttpServer>(
+            io_pool.Primary(), static_cast<uint16_t>(8082 + config.PortOffset()));
     debug_server_->SetStatsProvider([this]() { return stats_.ToJson(); });
     debug_server_->Start();
 }
@@ -49,31 +98,53 @@ void GameServer::Shutdown() {
     std::error_code ec;
     acceptor_.close(ec);
 
-    // Close all client connections
+    // Close all client connections (gateway clients: close their streams)
+    if (gateway_link_) gateway_link_->Stop();
     clients_.CloseAll();
 
-    // Wait for game loop to finish
-    if (game_loop_thread_.joinable()) {
-        game_loop_thread_.join();
-    }
+    // Wait for every zone's game loop and encoder to finish
+    zones_.Stop();
 
-    io_context_.stop();
+    io_pool_.Stop();
 
     Log::Info("Server shutdown complete");
 }
 
 void GameServer::ReloadScripts() const {
+    std::lock_guard<std::mutex> lock(lua_mutex_);
     if (lua_engine_) {
         lua_engine_->ReloadScripts();
     }
 }
 
+bool GameServer::QueueTileEdit(uint16_t map_id, const TileEdit &edit) {
+    Zone *zone = zones_.Get(map_id);
+    return zone && zone->QueueTileEdit(edit);
+}
+
+void GameServer::OnPlayersMoved(uint16_t map_id, const std::vector<std::shared_ptr<Player>> &moved) {
+    std::lock_guard<std::mutex> lock(lua_mutex_);
+    if (!lua_engine_) return;
+    for (const auto &player : moved) {
+        lua_engine_->OnPlayerMoved(
+                player->GetID(),
+                map_id,
+                player->GetX(),
+                player->GetY(),
+                player->GetFacing());
+    }
+}
+
 /// ============================================================================
 /// NETWORKING
 /// ============================================================================
 
 void GameServer::StartAccept() {
-    acceptor_.async_accept([this](
+    // The socket is created on the pool's next context, so every handler for
+    // this connection runs on that context's single thread. That keeps the
+    // "IO thread only" connection state single-threaded with N IO threads.
+    const size_t io_index = io_pool_.NextIndex();
+    acceptor_.async_accept(io_pool_.Context(io_index), [this, io_index](
             const std::error_code ec,
             asio::ip::tcp::socket socket) {
         if (!ec && server_running_) {
@@ -100,12 +171,13 @@ void GameServer::StartAccept() {
             } else {
                 limiter_.AddConnection(ip);
 
-                uint64_t client_id = next_client_id_++;
+                uint64_t client_id = AllocateClientID();
 
                 const auto client = std::make_shared<ClientConnection>(
                         std::move(socket),
                         this,
-                        client_id);
+                        client_id,
+                        io_pool_.Wheel(io_index));
 
                 // Start the session's async read chain and handshake timer.
                 // The session keeps itself alive via shared_from_this() in its async callbacks.
@@ -124,397 +196,29 @@ void GameServer::StartAccept() {
 }
 
 /// ============================================================================
-/// ACTION QUEUE
+/// COMMAND ROUTING
 /// ============================================================================
 
-void GameServer::QueueAction(std::function<void()> action) {
-    {
-        std::lock_guard<std::mutex> lock(action_mutex_);
-        action_queue_.push(std::move(action));
-    }
+void GameServer::QueueCommand(const GameCommand &command) {
+    zones_.RouteFor(command.client_id).QueueCommand(command);
 }
 
-void GameServer::ProcessActionQueue() {
-    std::queue<std::function<void()> > to_process;
-    {
-        std::lock_guard<std::mutex> lock(action_mutex_);
-        std::swap(to_process, action_queue_);
-    }
-    while (!to_process.empty()) {
-        to_process.front()();
-        to_process.pop();
-    }
-}
-
-/// ============================================================================
-/// GAME LOOP
-/// ============================================================================
-
-void GameServer::GameLogicThread() {
-    constexpr int TICKS_PER_SECOND = 20;
-    constexpr std::chrono::milliseconds TICK_RATE(1000 / TICKS_PER_SECOND); // 50ms
-
-    // Pin game thread to CPU core 0 to reduce cache thrashing with IO thread
-#ifdef _WIN32
-    SetThreadAffinityMask(GetCurrentThread(), 1); // Core 0
-    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
-    Log::Info("Game thread pinned to core 0 with elevated priority");
-#endif
-
-    Log::Info("Game loop started ({} ticks/sec)", TICKS_PER_SECOND);
-
-    // Measuring Tick Lag
-    double total_ms = 0;
-    int tick_count = 0;
-
-    while (server_running_) {
-        auto start_time = std::chrono::steady_clock::now();
-
-        // 1. Process queued actions from network thread
-        ProcessActionQueue();
-
-        // 2. Process game tick (movement, broadcasting, etc.)
-        ProcessTick();
-
-        // 3. Send pings periodically
-        if (++ping_tick_counter_ >= PING_INTERVAL_TICKS) {
-            ping_tick_counter_ = 0;
-            SendPingToAllClients();
-        }
-
-        // 4. Update bandwidth monitor
-        BandwidthMonitor::Instance().Tick();
-
-        // 5. Track performance
-        auto elapsed = std::chrono::steady_clock::now() - start_time;
-        auto ms = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / 1000.0;
-
-        total_ms += ms;
-        tick_count++;
-
-        // Update stats for debug dashboard
-        stats_.RecordTick(ms);
-        stats_.SetConnectionCounts(clients_.RealCount(), clients_.FakeCount(), players_.Count());
-        stats_.SetVisibilityCount(world_.Visibility().TrackedPlayerCount());
-        stats_.SetBandwidth(
-            BandwidthMonitor::Instance().GetBytesPerSecond(),
-            BandwidthMonitor::Instance().GetAvgBytesPerSecond(),
-            BandwidthMonitor::Instance().GetTotalBytesOut(),
-            BandwidthMonitor::Instance().GetPacketsPerSecond()
-        );
-
-        if (tick_count >= 100) {
-            // every 5 sec at 20 TPS
-            Log::Trace("Avg tick: {:.3f}ms", total_ms / tick_count);
-            total_ms = 0;
-            tick_count = 0;
-            stats_.ResetMaxValues();  // Reset max tick time
-        }
-
-        if (ms > 40.0) {
-            Log::Warn("Slow tick: {:.3f}ms / {}", ms, TICK_RATE);
-        }
-
-        // 5. Sleep until next tick
-        if (elapsed < TICK_RATE) {
-            std::this_thread::sleep_for(TICK_RATE - elapsed);
-        }
-    }
-    Log::Info("Game Loop Ended.");
-}
-
-/// ============================================================================
-/// PROCESS TICK - View-Based Broadcasting
-/// ============================================================================
-
-void GameServer::ProcessTick() {
-    auto t0 = std::chrono::steady_clock::now();
-
-    // Process bot movement (1 bot moves per tick)
-    Actions::BotStressTest::ProcessBotMovement(this, bot_manager_);
-
-    auto t1 = std::chrono::steady_clock::now();
-
-    // Get players that changed this tick
-    auto dirty_players = players_.ConsumeDirtyPlayers();
-    if (dirty_players.empty()) {
-        // Still log bot movement time if significant
-        auto bot_ms = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
-        if (bot_ms > 10.0) {
-            Log::Trace("Bot movement: {:.2f}ms, visibility tracked: {}", bot_ms, world_.Visibility().TrackedPlayerCount());
-        }
-        return;
-    }
-
-    BroadcastDirtyPlayers(dirty_players);
-
-    auto t2 = std::chrono::steady_clock::now();
-    auto bot_ms = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
-    auto broadcast_ms = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.0;
-
-    // Record stats for debug dashboard
-    stats_.RecordBroadcast(broadcast_ms);
-    stats_.SetDirtyPlayerCount(dirty_players.size());
-
-    if (bot_ms + broadcast_ms > 20.0) {
-        Log::Trace("Tick breakdown - Bot: {:.2f}ms, Broadcast: {:.2f}ms, Dirty: {}, Visibility: {}",
-                   bot_ms, broadcast_ms, dirty_players.size(), world_.Visibility().TrackedPlayerCount());
-    }
-
-    // Call Lua hooks
-    if (lua_engine_) {
-        for (const auto &player: dirty_players) {
-            lua_engine_->OnPlayerMoved(
-                    player->GetID(),
-                    player->GetX(),
-                    player->GetY(),
-                    player->GetFacing());
-        }
-    }
-}
-
-/// ============================================================================
-/// VIEW-BASED BROADCASTING
-///
-/// For each dirty player, find viewers who can see them using spatial hash.
-/// Build one batched packet per viewer containing all visible updates.
-/// ============================================================================
-
-void GameServer::BroadcastDirtyPlayers(const std::vector<std::shared_ptr<Player> > &dirty_players) {
-    auto t0 = std::chrono::steady_clock::now();
-    int64_t spatial_us = 0;
-    int64_t visibility_us = 0;
-    size_t total_nearby = 0;
-
-    // Map: client_id -> (viewer_ptr, list of dirty players they can see)
-    struct ViewerData {
-        std::shared_ptr<Player> viewer;
-        std::vector<std::shared_ptr<Player>> updates;
-    };
-    std::unordered_map<uint64_t, ViewerData> viewer_updates;
-
-    // For each dirty player, find viewers using zero-copy iteration
-    for (const auto &dirty_player: dirty_players) {
-        int16_t px = dirty_player->GetX();
-        int16_t py = dirty_player->GetY();
-        uint64_t dirty_id = dirty_player->GetID();
-
-        auto ts0 = std::chrono::steady_clock::now();
-
-        // Zero-copy iteration - no vector allocation or shared_ptr copies
-        world_.ForEachPlayerInRange(px, py, [&](const std::shared_ptr<Player>& viewer) {
-            total_nearby++;
-
-            // Skip self - client already predicted their own move
-            if (viewer->GetID() == dirty_id) return;
-
-            uint64_t client_id = viewer->GetClientID();
-            auto &data = viewer_updates[client_id];
-            if (!data.viewer) {
-                data.viewer = viewer;  // Store viewer pointer once (only copy)
-            }
-            data.updates.push_back(dirty_player);
-
-            // Keep visibility tracking in sync with what we're sending
-            auto tv0 = std::chrono::steady_clock::now();
-            world_.Visibility().AddKnown(viewer->GetID(), dirty_id);
-            auto tv1 = std::chrono::steady_clock::now();
-            visibility_us += std::chrono::duration_cast<std::chrono::microseconds>(tv1 - tv0).count();
-        });
-
-        auto ts1 = std::chrono::steady_clock::now();
-        spatial_us += std::chrono::duration_cast<std::chrono::microseconds>(ts1 - ts0).count();
-    }
-
-    auto t1 = std::chrono::steady_clock::now();
-
-    // Record sub-breakdown for viewer query phase
-    // spatial_us includes everything in lambda, so subtract visibility to get pure spatial time
-    int64_t pure_spatial_us = spatial_us - visibility_us;
-    stats_.RecordViewerQueryBreakdown(pure_spatial_us / 1000.0, visibility_us / 1000.0, total_nearby);
-
-    // OPTIMIZATION: Batch all client lookups in one lock acquisition
-    // Get both real and fake connections
-    auto connections = clients_.GetAnyClientsForIDs(viewer_updates);
-
-    auto t2 = std::chrono::steady_clock::now();
-
-    // Send batched packets to each viewer (real or fake)
-    for (auto &[client_id, data]: viewer_updates) {
-        if (data.updates.empty()) continue;
-
-        // Get connection from pre-fetched map (no mutex lock here!)
-        auto conn_it = connections.find(client_id);
-        if (conn_it == connections.end()) continue;
-
-        // Build batch packet (same for both real and fake)
-        Protocol::Packet batch;
-        // Pre-reserve: opcode (1) + count (1) + players * 13 bytes each (ID:8 + X:2 + Y:2 + facing:1)
-        batch.payload.reserve(2 + data.updates.size() * 13);
-
-        Protocol::PacketWriter::WriteByte(batch.payload,
-                                          Protocol::Opcode::Batch::Server::S_Player_Spatial.op);
-        Protocol::PacketWriter::WriteByte(batch.payload, 0); // Placeholder for count
-
-        uint8_t count = 0;
-        for (const auto &player: data.updates) {
-            // Player update: ID (8) + X (2) + Y (2) + Facing (1) = 13 bytes
-            Protocol::PacketWriter::WriteUInt64(batch.payload, player->GetID());
-            Protocol::PacketWriter::WriteShort(batch.payload, static_cast<uint16_t>(player->GetX()));
-            Protocol::PacketWriter::WriteShort(batch.payload, static_cast<uint16_t>(player->GetY()));
-            Protocol::PacketWriter::WriteByte(batch.payload, player->GetFacing());
-            count++;
-
-            // Safety: max 255 per packet
-            if (count == 255) break;
-        }
-
-        // Patch in count
-        batch.payload[1] = count;
-        batch.size = static_cast<uint16_t>(batch.payload.size());
-
-        // Send to either real or fake connection
-        auto data_bytes = std::make_shared<std::vector<uint8_t>>(batch.ToBytes());
-
-        std::visit([&data_bytes](auto&& conn) {
-            if (conn) conn->QueueRaw(data_bytes);
-        }, conn_it->second);
-    }
-
-    auto t3 = std::chrono::steady_clock::now();
-
-    // Record breakdown for debug dashboard
-    auto viewer_ms = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
-    auto lookup_ms = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.0;
-    auto send_ms = std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() / 1000.0;
-    stats_.RecordBroadcastBreakdown(viewer_ms, lookup_ms, send_ms,
-                                     viewer_updates.size(), dirty_players.size());
+void GameServer::QueueAction(std::function<void()> action) {
+    zones_.Primary().QueueAction(std::move(action));
 }
 
 void GameServer::OnClientLogin(const std::shared_ptr<ClientConnection> &client) {
-    QueueAction([this, client] {
-        // Everything below now runs on game thread
-
-        // Register with client manager
-        clients_.AddClient(client);
-        const uint64_t client_id = client->GetClientID();
-
-        // Create player in registry
-        auto player = players_.CreatePlayer(client_id, 0, 0);
-        if (!player) {
-            // CreatePlayer returns nullptr if client already has a player.
-            // This indicates a bug - client logged in twice somehow.
-            // Disconnect to prevent further issues.
-            Log::Error("Failed to create player for client {} - duplicate login?", client_id);
-            client->Disconnect("duplicate login");
-            return;
-        }
-
-        // Add to world's spatial hash
-        world_.AddPlayer(
-                player->GetID(),
-                player->GetX(),
-                player->GetY(),
-                player);
-
-        Log::Info("Client {} logged in as player {}", client_id, player->GetID());
-
-        // Send welcome packet to this client
-        Packets::PacketSender::Welcome(client, player);
-
-        // Get nearby players for this client (includes self)
-        auto nearby_players = world_.GetPlayersInRange(
-                player->GetX(),
-                player->GetY()
-        );
-
-        // Send all nearby players (including self) to new client
-        // This syncs client with server's authoritative position
-        Packets::PacketSender::BatchPlayerSpatial(client, nearby_players);
-
-        // ================================================================
-        // VISIBILITY TRACKING - Initialize for new player
-        // We just sent nearby_players to this client, so their "known" set
-        // should match what we sent (excluding self)
-        // ================================================================
-        std::vector<uint64_t> nearby_ids;
-        for (const auto& p : nearby_players) {
-            if (p->GetID() != player->GetID()) {
-                nearby_ids.push_back(p->GetID());
-            }
-        }
-        world_.Visibility().Initialize(player->GetID(), nearby_ids);
-
-        // Broadcast new player to all nearby viewers (single player per viewer)
-        for (const auto &viewer : nearby_players) {
-            if (viewer->GetID() == player->GetID()) continue;
-
-            auto viewer_conn = clients_.GetClient(viewer->GetClientID());
-            if (!viewer_conn) continue;
-
-            Packets::PacketSender::PlayerSpatial(
-                    viewer_conn,
-                    player->GetID(),
-                    player->GetX(),
-                    player->GetY(),
-                    player->GetFacing()
-            );
-
-            // Add new player to viewer's known set
-            // We just told them about this player, so they now "know" about them
-            world_.Visibility().AddKnown(viewer->GetID(), player->GetID());
-        }
-    });
-}
-
-void GameServer::SendPingToAllClients() {
-    clients_.BroadcastToAll([](const std::shared_ptr<ClientConnection> &client) {
-        client->SendPing();
-    });
+    // Register with client manager here on the IO thread (ClientManager is
+    // mutex-protected) so the command itself only has to carry the id.
+    clients_.AddClient(client);
+    QueueCommand(GameCommand::Login(client->GetClientID()));
 }
 
 void GameServer::OnClientDisconnect(uint64_t client_id, const std::string &ip) {
-    QueueAction([this, client_id, ip] {
-        auto player = players_.GetByClientID(client_id);
-        if (player) {
-            uint64_t player_id = player->GetID();
-
-            // Notify everyone who KNOWS about this player (not just nearby)
-            // This fixes ghost players when they moved out of view before disconnecting
-            const auto* known_by = world_.Visibility().GetKnownBy(player_id);
-            if (known_by) {
-                for (uint64_t observer_id : *known_by) {
-                    auto observer = players_.GetByID(observer_id);
-                    if (!observer) continue;
-
-                    auto viewer_conn = clients_.GetClient(observer->GetClientID());
-                    if (!viewer_conn) continue;
-
-                    Packets::PacketSender::PlayerLeft(viewer_conn, player_id);
-                }
-            }
-
-            // Remove from World's spatial hash
-            world_.RemovePlayer(player_id);
-
-            // Remove from visibility tracking
-            // This cleans up their known set AND removes them from everyone else's known sets
-            world_.Visibility().RemovePlayer(player_id);
-
-            // Remove from registry
-            players_.RemoveByClientID(client_id);
-
-            Log::Info("Player {} disconnected", player_id);
-        }
-
-        // Remove from client manager
-        clients_.RemoveClient(client_id);
-
-        // Update rate limiter
-        limiter_.RemoveConnection(ip);
-
-        Log::Info("Client {} disconnected", client_id);
-    });
+    // The limiter is mutex-protected, so release the IP's slot right away
+    // instead of carrying the string through the command ring.
+    limiter_.RemoveConnection(ip);
+    QueueCommand(GameCommand::Disconnect(client_id));
 }
 
 /// ============================================================================
@@ -522,14 +226,13 @@ void GameServer::OnClientDisconnect(uint64_t client_id, const std::string &ip) {
 /// ============================================================================
 
 void GameServer::SpawnBots(size_t count, bool clustered) {
-    QueueAction([this, count, clustered] {
-        Actions::BotStressTest::SpawnBots(this, bot_manager_, count, clustered);
-    });
+    zones_.Primary().SpawnBots(count, clustered);
 }
 
 void GameServer::RemoveBots() {
-    QueueAction([this] {
-        Actions::BotStressTest::RemoveBots(this, bot_manager_);
-    });
+    zones_.Primary().RemoveBots();
 }
 
+size_t GameServer::BotCount() const {
+    return zones_.Primary().BotCount();
+}
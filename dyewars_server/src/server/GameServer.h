@@ -6,33 +6,49 @@
 #include <mutex>
 #include <functional>
 #include <memory>
-#include <queue>
+#include <vector>
 
 #include "ClientManager.h"
-#include "game/PlayerRegistry.h"
-#include "game/World.h"
-#include "game/actions/BotStressTest.h"
+#include "InputLog.h"
+#include "ZoneManager.h"
+#include "game/WarpPoints.h"
+#include "game/actions/GameCommand.h"
+#include "core/JobSystem.h"
+#include "core/ServerConfig.h"
 #include "network/ConnectionLimiter.h"
 #include "debug/ServerStats.h"
 
 // Forward Declares
+class IoContextPool;
+class UdpSpatialChannel;
+class ShardLink;
+class GatewayLink;
 class LuaGameEngine;
 class ClientConnection;
 class DebugHttpServer;
+class Player;
+struct TileEdit;
 
 /// ============================================================================
 /// GAME SERVER
 ///
 /// Responsibilities:
-/// - Accept client connections
-/// - Run game loop on separate thread
-/// - Process action queue (network -> game thread)
-/// - Broadcast updates to clients (view-based)
+/// - Accept client connections, directly or through gateways (--gateway)
+/// - Own what every zone shares: connections, limiter, UDP channel, Lua,
+///   the job pool and stats
+/// - Route commands from the network threads to the client's zone
 /// - Coordinate between subsystems
+///
+/// The simulation itself (World, players, game loop, broadcasting) lives in
+/// one Zone per map, see Zone.h and ZoneManager.h.
 /// ============================================================================
 class GameServer {
 public:
-    explicit GameServer(asio::io_context &io_context);
+    /// Acceptor, debug HTTP and the UDP channel run on the pool's primary
+    /// context. Each accepted connection is bound to the pool's next context.
+    /// With config.headless none of that is opened and the zones are not
+    /// started (DyeWarsReplay ticks them itself).
+    GameServer(IoContextPool &io_pool, const ServerConfig &config);
 
     ~GameServer();//Destructor
 
@@ -45,11 +61,17 @@ public:
     void ReloadScripts() const;
 
     /// ========================================================================
-    /// ACTION QUEUE (thread-safe)
-    /// Called from network thread, executed on game thread
+    /// COMMAND QUEUE (thread-safe)
+    /// Called from network thread, executed on the client's zone thread
     /// ========================================================================
 
-    // Queue an action from any thread (IO thread calls this)
+    /// Queue a command from any thread (IO threads, once per input packet)
+    /// on the zone that has the client's player - the primary zone before
+    /// login. See Zone::QueueCommand.
+    void QueueCommand(const GameCommand &command);
+
+    /// Escape hatch for rare admin actions, run on the primary zone's thread.
+    /// Allocates and takes a mutex - don't use it per packet.
     void QueueAction(std::function<void()> action);
 
     /// ========================================================================
@@ -68,57 +90,94 @@ public:
     /// ========================================================================
 
     // These just return references to our Game Server internal dependencies
+    // (all thread-safe)
     ClientManager &Clients() { return clients_; }
 
-    PlayerRegistry &Players() { return players_; }
-
     ConnectionLimiter &Limiter() { return limiter_; }
 
-    World &GetWorld() { return world_; }
+    ZoneManager &Zones() { return zones_; }
 
+    /// Warp tiles, checked by every zone (see WarpPoints)
+    WarpPoints &Warps() { return warps_; }
 
-private:/// ========================================================================
-    /// NETWORKING
-    /// ========================================================================
+    JobSystem &Jobs() { return jobs_; }
 
-    void StartAccept();
+    /// UDP spatial channel, or nullptr when started without --udp
+    UdpSpatialChannel *UdpChannel() { return udp_channel_.get(); }
 
-    /// ========================================================================
-    /// GAME LOOP
-    /// ========================================================================
+    /// Link to the other shard processes, or nullptr unless started with --shard
+    ShardLink *Shards() { return shard_link_.get(); }
+
+    /// Gateway streams, or nullptr unless started with --gateway
+    GatewayLink *Gateways() { return gateway_link_.get(); }
+
+    /// Command capture, or nullptr unless started with --record
+    InputLog *Inputs() { return input_log_.get(); }
+
+    /// Next client ID, for direct and gateway clients alike (any thread)
+    uint64_t AllocateClientID() { return next_client_id_.fetch_add(1, std::memory_order_relaxed); }
 
-    void GameLogicThread();
+    /// Players across all zones
+    size_t PlayerCount() const { return zones_.PlayerCount(); }
 
-    void ProcessTick();
+    /// Queue a tile edit on map `map_id` (any thread, lock-free). False if
+    /// there is no such map or its edit ring is full. See Zone::QueueTileEdit.
+    bool QueueTileEdit(uint16_t map_id, const TileEdit &edit);
 
-    void ProcessActionQueue();
+    /// Run the Lua OnPlayerMoved hooks for players that moved on map
+    /// `map_id`. Zone threads call this; the engine is shared, so calls
+    /// are serialized.
+    void OnPlayersMoved(uint16_t map_id, const std::vector<std::shared_ptr<Player>> &moved);
+
+
+private:/// ========================================================================
+    /// NETWORKING
+    /// ========================================================================
 
-    /// View-based broadcasting
-    void BroadcastDirtyPlayers(const std::vector<std::shared_ptr<Player>> &dirty_players);
+    void StartAccept();
 
     /// ========================================================================
     /// DATA
     /// ========================================================================
 
     // Network
-    asio::io_context &io_context_;
+    IoContextPool &io_pool_;
     asio::ip::tcp::acceptor acceptor_;
 
     // State
-    World world_;
-    PlayerRegistry players_;
     ClientManager clients_;
     ConnectionLimiter limiter_;
 
-    // Lua
+    // Before the Lua engine, whose scripts add warp tiles as they load
+    WarpPoints warps_;
+
+    // Unreliable spatial updates (optional, --udp)
+    std::unique_ptr<UdpSpatialChannel> udp_channel_;
+
+    // IPC with the neighbouring shards (optional, --shard)
+    std::unique_ptr<ShardLink> shard_link_;
+
+    // Client sockets held by gateway processes (optional, --gateway)
+    std::unique_ptr<GatewayLink> gateway_link_;
+
+    // Lua (one engine for every zone, see OnPlayersMoved)
     std::shared_ptr<LuaGameEngine> lua_engine_;
+    mutable std::mutex lua_mutex_;
 
-    //Main Action Queue (network thread -> game thread)
-    std::queue<std::function<void()>> action_queue_;
-    std::mutex action_mutex_;
+    // Helpers for parallel per-tick work (--job-threads), shared by the
+    // zones. Jobs only read a zone's state while its thread waits for them.
+    JobSystem jobs_;
+
+    // Stats before the zones - their threads write to it until Stop
+    ServerStats stats_;
+
+    // Command capture (optional, --record). Before the zones, which write
+    // to it until they stop.
+    std::unique_ptr<InputLog> input_log_;
+
+    // One per map, each with its own thread (--zones)
+    ZoneManager zones_;
 
-    // Game loop thread
-    std::thread game_loop_thread_;
     std::atomic<bool> server_running_{true};
     std::atomic<bool> shutdown_requested_{false};
 
@@ -130,17 +189,11 @@ private:/// ====================================================================
     /// </summary>
     std::atomic<uint64_t> next_client_id_{1};
 
-    // Ping tracking
-    static constexpr int PING_INTERVAL_TICKS = 200;  // Every 10 seconds at 20 TPS
-    int ping_tick_counter_{0};
-
-    void SendPingToAllClients();
-
     // =========================================================================
     // STRESS TEST BOTS
     // =========================================================================
 public:
-    /// Spawn stress test bots
+    /// Spawn stress test bots on the primary zone's map
     /// clustered=true: spawn near player (worst case stress test)
     /// clustered=false: spawn across map (realistic simulation)
     void SpawnBots(size_t count, bool clustered = true);
@@ -149,18 +202,14 @@ public:
     void RemoveBots();
 
     /// Get current bot count
-    size_t BotCount() const { return bot_manager_.bot_ids.size(); }
+    size_t BotCount() const;
 
     /// Get server stats (for debug dashboard)
     ServerStats& Stats() { return stats_; }
 
 private:
-    /// Bot manager state
-    Actions::BotStressTest::BotManager bot_manager_;
-
     // =========================================================================
     // DEBUG
     // =========================================================================
-    ServerStats stats_;
     std::unique_ptr<DebugHttpServer> debug_server_;
 };
\ No newline at end of file
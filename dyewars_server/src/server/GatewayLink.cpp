@@ -0,0 +1,333 @@
+/// =======================================
+/// DyeWarsServer - GatewayLink
+/// =======================================
+#include "GatewayLink.h"
+#include "ClientConnection.h"
+#include "GameServer.h"
+#include "core/Log.h"
+#include "network/BandwidthMonitor.h"
+#include "network/IoContextPool.h"
+
+#include <format>
+
+namespace {
+    /// Receive buffer growth step; one read never asks for less than this
+    constexpr size_t READ_CHUNK = 64 * 1024;
+}
+
+// ============================================================================
+// SESSION
+// ============================================================================
+
+GatewaySession::GatewaySession(asio::ip::tcp::socket socket, GameServer *server, uint32_t index,
+                               TimerWheel &timers)
+        : server_(server),
+          socket_(std::move(socket)),
+          index_(index),
+          timers_(timers) {
+    // Small packets (one tick of moves) shouldn't wait for Nagle
+    std::error_code ec;
+    socket_.set_option(asio::ip::tcp::no_delay(true), ec);
+}
+
+void GatewaySession::Start() {
+    asio::post(socket_.get_executor(), [self = shared_from_this()]() {
+        self->StartRead();
+    });
+}
+
+void GatewaySession::Close(const std::string &reason) {
+    if (closed_.exchange(true)) return;
+    asio::dispatch(socket_.get_executor(), [self = shared_from_this(), reason]() {
+        Log::Warn("Gateway {} closed: {}", self->index_, reason);
+        std::error_code ec;
+        self->socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+        self->socket_.close(ec);
+        self->DropClients(reason);
+    });
+}
+
+void GatewaySession::DropClients(const std::string &reason) {
+    // Swap first: Disconnect calls back into CloseClient, which must not
+    // find a half-cleared map
+    auto clients = std::move(clients_);
+    clients_.clear();
+    client_count_.store(0, std::memory_order_relaxed);
+    for (auto &[gateway_id, client] : clients) {
+        client->Disconnect("gateway lost: " + reason);
+    }
+}
+
+// ============================================================================
+// RECEIVE (IO thread)
+// ============================================================================
+
+void GatewaySession::StartRead() {
+    if (recv_buffer_.size() - recv_size_ < READ_CHUNK) {
+        recv_buffer_.resize(recv_size_ + READ_CHUNK);
+    }
+    socket_.async_read_some(
+            asio::buffer(recv_buffer_.data() + recv_size_, recv_buffer_.size() - recv_size_),
+            [self = shared_from_this()](std::error_code ec, size_t bytes_read) {
+                if (ec) {
+                    self->Close(ec == asio::error::eof ? "gateway disconnected" : ec.message());
+                    return;
+                }
+                self->recv_size_ += bytes_read;
+                BandwidthMonitor::Instance().RecordIncoming(bytes_read);
+                self->ProcessMessages();
+                if (!self->closed_) self->StartRead();
+            });
+}
+
+void GatewaySession::ProcessMessages() {
+    using namespace GatewayProtocol;
+
+    size_t offset = 0;
+    while (!closed_) {
+        Message message{};
+        size_t consumed = 0;
+        const auto stream = std::span<const uint8_t>(recv_buffer_.data() + offset, recv_size_ - offset);
+        const auto status = Parse(stream, message, consumed);
+        if (status == ParseStatus::NeedMore) break;
+        if (status == ParseStatus::Corrupt) {
+            Close("corrupt stream");
+            return;
+        }
+
+        switch (message.type) {
+            case Type::ClientOpen:   OnClientOpen(message.body); break;
+            case Type::ClientFrame:  OnClientFrame(message.body); break;
+            case Type::ClientClosed: OnClientClosed(message.body); break;
+            case Type::ClientPing:   OnClientPing(message.body); break;
+            default:
+                // Deliver / Close only flow game -> gateway
+                Close(std::format("unexpected message type {}", static_cast<int>(message.type)));
+                return;
+        }
+        offset += consumed;
+    }
+
+    // Keep the partial message at the front for the next read
+    if (offset > 0) {
+        std::memmove(recv_buffer_.data(), recv_buffer_.data() + offset, recv_size_ - offset);
+        recv_size_ -= offset;
+    }
+}
+
+void GatewaySession::OnClientOpen(std::span<const uint8_t> body) {
+    const auto open = GatewayProtocol::DecodeClientOpen(body);
+    if (!open || clients_.contains(open->client)) {
+        Close("bad ClientOpen");
+        return;
+    }
+
+    // A fresh game-wide ID: gateway IDs only mean something to their gateway
+    const uint64_t client_id = server_->AllocateClientID();
+    auto client = std::make_shared<ClientConnection>(
+            ClientConnection::Remote{shared_from_this(), open->client, open->ip, open->resume_token},
+            server_, client_id, timers_);
+    clients_[open->client] = client;
+    client_count_.store(clients_.size(), std::memory_order_relaxed);
+
+    Log::Debug("Gateway {} client {} is client {}", index_, open->client, client_id);
+    client->Start();
+}
+
+void GatewaySession::OnClientFrame(std::span<const uint8_t> body) {
+    std::span<const uint8_t> payload;
+    const auto gateway_id = GatewayProtocol::DecodeClient(body, payload);
+    if (!gateway_id) {
+        Close("bad ClientFrame");
+        return;
+    }
+    // Frames racing a kick we already sent are dropped
+    auto it = clients_.find(*gateway_id);
+    if (it == clients_.end()) return;
+    // Hold a reference: a kick from inside the handler erases the map entry
+    const auto client = it->second;
+    client->HandleRemotePacket(payload);
+}
+
+void GatewaySession::OnClientClosed(std::span<const uint8_t> body) {
+    std::span<const uint8_t> rest;
+    const auto gateway_id = GatewayProtocol::DecodeClient(body, rest);
+    if (!gateway_id) {
+        Close("bad ClientClosed");
+        return;
+    }
+    auto it = clients_.find(*gateway_id);
+    if (it == clients_.end()) return;
+    auto client = std::move(it->second);
+    clients_.erase(it);
+    client_count_.store(clients_.size(), std::memory_order_relaxed);
+    client->Disconnect("connection lost");
+}
+
+void GatewaySession::OnClientPing(std::span<const uint8_t> body) {
+    const auto ping = GatewayProtocol::DecodeClientPing(body);
+    if (!ping) {
+        Close("bad ClientPing");
+        return;
+    }
+    // Same rolling average a direct connection's pongs feed
+    if (auto it = clients_.find(ping->client); it != clients_.end()) it->second->RecordPing(ping->ping_ms);
+}
+
+// ============================================================================
+// SEND (staged from any thread, written on the IO thread)
+// ============================================================================
+
+void GatewaySession::Deliver(uint64_t gateway_client_id, std::shared_ptr<std::vector<uint8_t>> frame) {
+    if (closed_) return;
+    bool post = false;
+    {
+        std::lock_guard lock(staging_mutex_);
+        staged_.Add(gateway_client_id, std::move(frame));
+        post = !flush_posted_;
+        flush_posted_ = true;
+    }
+    packets_queued_.fetch_add(1, std::memory_order_relaxed);
+
+    // One post per burst: an encoder queueing a whole tick lands in one flush
+    if (post) {
+        asio::post(socket_.get_executor(), [self = shared_from_this()]() { self->Flush(); });
+    }
+}
+
+void GatewaySession::CloseClient(uint64_t gateway_client_id, const std::string &reason) {
+    if (closed_) return;
+    bool post = false;
+    {
+        std::lock_guard lock(staging_mutex_);
+        GatewayProtocol::AppendClose(staged_closes_, gateway_client_id, reason);
+        post = !flush_posted_;
+        flush_posted_ = true;
+    }
+    if (post) {
+        asio::post(socket_.get_executor(), [self = shared_from_this()]() { self->Flush(); });
+    }
+
+    // Stop routing its frames now. The map is IO-thread only, so hop there.
+    asio::dispatch(socket_.get_executor(), [self = shared_from_this(), gateway_client_id]() {
+        self->clients_.erase(gateway_client_id);
+        self->client_count_.store(self->clients_.size(), std::memory_order_relaxed);
+    });
+}
+
+void GatewaySession::Flush() {
+    auto out = std::make_shared<std::vector<uint8_t>>();
+    size_t messages = 0;
+    {
+        std::lock_guard lock(staging_mutex_);
+        flush_posted_ = false;
+        messages = staged_.Messages();
+        // Delivers first: a kick's last packets (if any) go out before the Close
+        staged_.Write(*out);
+        out->insert(out->end(), staged_closes_.begin(), staged_closes_.end());
+        staged_closes_.clear();
+    }
+    if (out->empty() || closed_) return;
+
+    delivers_sent_.fetch_add(messages, std::memory_order_relaxed);
+    bytes_sent_.fetch_add(out->size(), std::memory_order_relaxed);
+    BandwidthMonitor::Instance().RecordOutgoing(out->size());
+
+    const size_t queued = queued_bytes_.fetch_add(out->size(), std::memory_order_relaxed) + out->size();
+    if (queued > MAX_QUEUED_BYTES) {
+        Close(std::format("stopped reading ({} bytes queued)", queued));
+        return;
+    }
+    write_queue_.push_back(std::move(out));
+    StartNextWrite();
+}
+
+void GatewaySession::StartNextWrite() {
+    if (write_in_progress_ || write_queue_.empty() || closed_) return;
+
+    auto data = std::move(write_queue_.front());
+    write_queue_.pop_front();
+    write_in_progress_ = true;
+    asio::async_write(socket_, asio::buffer(*data),
+                      [self = shared_from_this(), data](const std::error_code &ec, size_t) {
+                          self->write_in_progress_ = false;
+                          self->queued_bytes_.fetch_sub(data->size(), std::memory_order_relaxed);
+                          if (ec) {
+                              self->Close(ec.message());
+                              return;
+                          }
+                          self->StartNextWrite();
+                      });
+}
+
+// ============================================================================
+// LINK (acceptor)
+// ============================================================================
+
+GatewayLink::GatewayLink(IoContextPool &io_pool, GameServer *server, uint16_t port)
+        : io_pool_(io_pool),
+          server_(server),
+          acceptor_(io_pool.Primary(), asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), port)) {
+    port_ = acceptor_.local_endpoint().port();
+}
+
+GatewayLink::~GatewayLink() {
+    Stop();
+}
+
+void GatewayLink::Start() {
+    Log::Info("Gateway link listening on 127.0.0.1:{}", port_);
+    StartAccept();
+}
+
+void GatewayLink::Stop() {
+    running_ = false;
+    std::error_code ec;
+    acceptor_.close(ec);
+
+    std::lock_guard lock(sessions_mutex_);
+    for (auto &weak : sessions_) {
+        if (auto session = weak.lock()) session->Close("server shutting down");
+    }
+    sessions_.clear();
+}
+
+void GatewayLink::StartAccept() {
+    // Like client connections: each gateway stream is pinned to one IO thread
+    const size_t io_index = io_pool_.NextIndex();
+    acceptor_.async_accept(io_pool_.Context(io_index), [this, io_index](std::error_code ec,
+                                                                       asio::ip::tcp::socket socket) {
+        if (!running_) return;
+        if (ec) {
+            Log::Error("Gateway accept failed: {}", ec.message());
+        } else {
+            auto session = std::make_shared<GatewaySession>(std::move(socket), server_, next_index_++,
+                                                            io_pool_.Wheel(io_index));
+            Log::Info("Gateway {} connected (IO thread {})", session->Index(), io_index);
+            {
+                std::lock_guard lock(sessions_mutex_);
+                std::erase_if(sessions_, [](const auto &weak) { return weak.expired(); });
+                sessions_.push_back(session);
+            }
+            session->Start();
+        }
+        StartAccept();
+    });
+}
+
+std::string GatewayLink::GetStatus() {
+    std::lock_guard lock(sessions_mutex_);
+    std::string status = std::format("Gateway link on 127.0.0.1:{}: {} gateways", port_, sessions_.size());
+    for (const auto &weak : sessions_) {
+        auto session = weak.lock();
+        if (!session) continue;
+        const uint64_t packets = session->PacketsQueued();
+        const uint64_t delivers = session->DeliversSent();
+        status += std::format("\n  gateway {}: {} clients, {} packets in {} delivers ({:.2f}x fan-out), "
+                              "{} bytes sent, {} queued",
+                              session->Index(), session->ClientCount(), packets, delivers,
+                              delivers ? static_cast<double>(packets) / static_cast<double>(delivers) : 0.0,
+                              session->BytesSent(), session->QueuedBytes());
+    }
+    return status;
+}
@@ -0,0 +1,174 @@
+/// =======================================
+/// DyeWarsServer - GatewayLink
+///
+/// Game side of the gateway stream (--gateway). Gateway processes
+/// (DyeWarsGateway) hold the client sockets and connect here, on loopback;
+/// each one is a GatewaySession carrying all of its clients over one TCP
+/// stream (wire format in GatewayProtocol.h).
+///
+/// WHY:
+/// Without a gateway the game process terminates every client socket:
+/// accept, handshake, framing, pings and one write per packet per client
+/// all run on its IO threads. Behind a gateway the game keeps a few
+/// streams, writes each distinct packet once per tick with a recipient list
+/// (GatewayProtocol::FanOutBatcher), and the gateway process does the
+/// rest on its own cores. Several gateways can share one game.
+///
+/// CLIENTS:
+/// A ClientOpen creates a ClientConnection in remote mode (no socket, see
+/// ClientConnection::Remote) with a fresh game client ID. From there the
+/// game can't tell it from a direct client: it logs in, gets commands
+/// routed, and its QueueRaw lands in this session's batcher instead of a
+/// socket. Direct clients keep working next to gateway clients.
+///
+/// THREAD SAFETY:
+///   - Acceptor: primary io_context. Each session is bound to one pool
+///     context, like a ClientConnection, and reads/writes only there.
+///   - Deliver / CloseClient: any thread (game, encoder, job workers).
+///     They stage under a mutex and post one flush per burst.
+///   - clients_ (gateway ID -> connection): the session's IO thread only.
+///   - GetStats: any thread (atomics).
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "network/GatewayProtocol.h"
+
+class GameServer;
+class ClientConnection;
+class IoContextPool;
+class TimerWheel;
+
+class GatewaySession : public std::enable_shared_from_this<GatewaySession> {
+public:
+    /// Drop the gateway (and every client behind it) when this much is
+    /// queued for it - it stopped reading
+    static constexpr size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+    /// @param timers Wheel of the socket's io_context (its remote clients use it)
+    GatewaySession(asio::ip::tcp::socket socket, GameServer *server, uint32_t index, TimerWheel &timers);
+
+    /// Start reading (any thread - posts to the session's IO thread)
+    void Start();
+
+    /// Close the stream; every client behind it disconnects. Any thread.
+    void Close(const std::string &reason);
+
+    uint32_t Index() const { return index_; }
+
+    /// The session's IO thread (remote connections post there)
+    asio::any_io_executor Executor() { return socket_.get_executor(); }
+
+    // =========================================================================
+    // GAME -> GATEWAY (any thread)
+    // =========================================================================
+
+    /// Queue a framed packet for one client behind this gateway
+    void Deliver(uint64_t gateway_client_id, std::shared_ptr<std::vector<uint8_t>> frame);
+
+    /// Ask the gateway to drop a client (kick). Ignored for unknown clients.
+    void CloseClient(uint64_t gateway_client_id, const std::string &reason);
+
+    // =========================================================================
+    // STATS (any thread)
+    // =========================================================================
+
+    size_t ClientCount() const { return client_count_.load(std::memory_order_relaxed); }
+
+    uint64_t PacketsQueued() const { return packets_queued_.load(std::memory_order_relaxed); }
+
+    uint64_t DeliversSent() const { return delivers_sent_.load(std::memory_order_relaxed); }
+
+    uint64_t BytesSent() const { return bytes_sent_.load(std::memory_order_relaxed); }
+
+    size_t QueuedBytes() const { return queued_bytes_.load(std::memory_order_relaxed); }
+
+private:
+    // --- Receive (IO thread) ---
+    void StartRead();
+    void ProcessMessages();
+    void OnClientOpen(std::span<const uint8_t> body);
+    void OnClientFrame(std::span<const uint8_t> body);
+    void OnClientClosed(std::span<const uint8_t> body);
+    void OnClientPing(std::span<const uint8_t> body);
+
+    // --- Send (IO thread) ---
+    /// Turn everything staged into Deliver/Close messages and write them
+    void Flush();
+    void StartNextWrite();
+
+    /// Disconnect every client behind this gateway (IO thread)
+    void DropClients(const std::string &reason);
+
+    GameServer *const server_;
+    asio::ip::tcp::socket socket_;
+    const uint32_t index_;
+    TimerWheel &timers_;
+
+    // --- IO thread only ---
+    std::vector<uint8_t> recv_buffer_;
+    size_t recv_size_ = 0;
+    std::unordered_map<uint64_t, std::shared_ptr<ClientConnection>> clients_;
+    std::deque<std::shared_ptr<std::vector<uint8_t>>> write_queue_;
+    bool write_in_progress_ = false;
+
+    // --- Staging (mutex) ---
+    std::mutex staging_mutex_;
+    GatewayProtocol::FanOutBatcher staged_;
+    std::vector<uint8_t> staged_closes_;  // Close messages, written after the delivers
+    bool flush_posted_ = false;
+
+    std::atomic<bool> closed_{false};
+
+    // --- Stats ---
+    std::atomic<size_t> client_count_{0};
+    std::atomic<uint64_t> packets_queued_{0};
+    std::atomic<uint64_t> delivers_sent_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<size_t> queued_bytes_{0};
+};
+
+class GatewayLink {
+public:
+    /// Listen on 127.0.0.1:port (0 = ephemeral, for tests). Throws
+    /// asio::system_error if it's taken.
+    GatewayLink(IoContextPool &io_pool, GameServer *server, uint16_t port);
+
+    ~GatewayLink();
+
+    GatewayLink(const GatewayLink &) = delete;
+    GatewayLink &operator=(const GatewayLink &) = delete;
+
+    void Start();
+
+    /// Stop accepting and close every gateway stream
+    void Stop();
+
+    uint16_t Port() const { return port_; }
+
+    /// One line per gateway: clients, packets in, Delivers out (any thread)
+    std::string GetStatus();
+
+private:
+    void StartAccept();
+
+    IoContextPool &io_pool_;
+    GameServer *const server_;
+    asio::ip::tcp::acceptor acceptor_;
+    uint16_t port_ = 0;
+    std::atomic<bool> running_{true};
+
+    std::mutex sessions_mutex_;
+    std::vector<std::weak_ptr<GatewaySession>> sessions_;
+    uint32_t next_index_ = 0;  // Primary IO thread only
+};
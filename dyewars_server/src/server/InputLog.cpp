@@ -0,0 +1,154 @@
+/// =======================================
+/// DyeWarsServer - InputLog
+/// =======================================
+#include "InputLog.h"
+#include "network/Packets/Protocol.h"
+#include <iterator>
+#include <stdexcept>
+
+using namespace Protocol::PacketWriter;
+using namespace Protocol::PacketReader;
+using InputLogFormat::Kind;
+
+/// ============================================================================
+/// WRITING
+/// ============================================================================
+
+void InputLog::TickBlock::Add(const GameCommand &command) {
+    WriteByte(bytes_, static_cast<uint8_t>(command.type));
+    WriteUInt64(bytes_, command.client_id);
+    switch (command.type) {
+        case GameCommand::Type::Move:
+            WriteByte(bytes_, command.move.direction);
+            WriteByte(bytes_, command.move.facing);
+            break;
+        case GameCommand::Type::Turn:
+            WriteByte(bytes_, command.turn.facing);
+            break;
+        case GameCommand::Type::Warp:
+            WriteShort(bytes_, command.warp.map_id);
+            WriteShort(bytes_, static_cast<uint16_t>(command.warp.x));
+            WriteShort(bytes_, static_cast<uint16_t>(command.warp.y));
+            break;
+        case GameCommand::Type::Login:
+        case GameCommand::Type::Disconnect:
+            break;
+    }
+    count_++;
+}
+
+void InputLog::TickBlock::AddSpawnBots(uint32_t count, bool clustered) {
+    WriteByte(bytes_, static_cast<uint8_t>(Kind::SpawnBots));
+    WriteUInt64(bytes_, 0);
+    WriteUInt(bytes_, count);
+    WriteByte(bytes_, clustered ? 1 : 0);
+    count_++;
+}
+
+void InputLog::TickBlock::AddRemoveBots() {
+    WriteByte(bytes_, static_cast<uint8_t>(Kind::RemoveBots));
+    WriteUInt64(bytes_, 0);
+    count_++;
+}
+
+InputLog::InputLog(const std::string &path, const InputLogFormat::Header &header)
+        : path_(path),
+          file_(path, std::ios::binary | std::ios::trunc) {
+    if (!file_.is_open()) throw std::runtime_error("can't open input log " + path);
+
+    std::vector<uint8_t> bytes;
+    WriteUInt(bytes, InputLogFormat::FILE_MAGIC);
+    WriteShort(bytes, InputLogFormat::VERSION);
+    WriteShort(bytes, header.tps);
+    WriteByte(bytes, static_cast<uint8_t>((header.deterministic ? InputLogFormat::FLAG_DETERMINISTIC : 0) |
+                                          (header.open_warps ? InputLogFormat::FLAG_OPEN_WARPS : 0)));
+    WriteUInt64(bytes, header.seed);
+    WriteShort(bytes, header.zones);
+    file_.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+InputLog::~InputLog() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.flush();
+}
+
+void InputLog::Write(uint16_t map_id, uint64_t tick, const TickBlock &block) {
+    if (block.Empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    header_scratch_.clear();
+    WriteShort(header_scratch_, map_id);
+    WriteUInt64(header_scratch_, tick);
+    WriteUInt(header_scratch_, block.count_);
+    file_.write(reinterpret_cast<const char *>(header_scratch_.data()),
+                static_cast<std::streamsize>(header_scratch_.size()));
+    file_.write(reinterpret_cast<const char *>(block.bytes_.data()),
+                static_cast<std::streamsize>(block.bytes_.size()));
+}
+
+/// ============================================================================
+/// READING
+/// ============================================================================
+
+InputLogFormat::Capture InputLogFormat::ReadFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("can't open " + path);
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Capture capture;
+    size_t offset = 0;
+    if (ReadUInt(data, offset) != FILE_MAGIC) throw std::runtime_error(path + " is not an input log");
+    if (ReadShort(data, offset) != VERSION) throw std::runtime_error(path + " has an unsupported version");
+    capture.header.tps = ReadShort(data, offset);
+    const uint8_t flags = ReadByte(data, offset);
+    capture.header.deterministic = (flags & FLAG_DETERMINISTIC) != 0;
+    capture.header.open_warps = (flags & FLAG_OPEN_WARPS) != 0;
+    capture.header.seed = ReadUInt64(data, offset);
+    capture.header.zones = ReadShort(data, offset);
+
+    while (offset < data.size()) {
+        const uint16_t map_id = ReadShort(data, offset);
+        const uint64_t tick = ReadUInt64(data, offset);
+        const uint32_t count = ReadUInt(data, offset);
+        for (uint32_t i = 0; i < count; i++) {
+            Entry entry;
+            entry.map_id = map_id;
+            entry.tick = tick;
+            entry.kind = static_cast<Kind>(ReadByte(data, offset));
+            const uint64_t client_id = ReadUInt64(data, offset);
+
+            switch (entry.kind) {
+                case Kind::Move: {
+                    const uint8_t direction = ReadByte(data, offset);
+                    entry.command = GameCommand::Move(client_id, direction, ReadByte(data, offset));
+                    break;
+                }
+                case Kind::Turn:
+                    entry.command = GameCommand::Turn(client_id, ReadByte(data, offset));
+                    break;
+                case Kind::Warp: {
+                    const uint16_t to_map = ReadShort(data, offset);
+                    const auto x = static_cast<int16_t>(ReadShort(data, offset));
+                    entry.command = GameCommand::Warp(client_id, to_map, x, static_cast<int16_t>(ReadShort(data, offset)));
+                    break;
+                }
+                case Kind::Login:
+                    entry.command = GameCommand::Login(client_id);
+                    break;
+                case Kind::Disconnect:
+                    entry.command = GameCommand::Disconnect(client_id);
+                    break;
+                case Kind::SpawnBots:
+                    entry.bot_count = ReadUInt(data, offset);
+                    entry.clustered = ReadByte(data, offset) != 0;
+                    break;
+                case Kind::RemoveBots:
+                    break;
+                default:
+                    throw std::runtime_error(path + " has an unknown entry kind");
+            }
+            capture.entries.push_back(entry);
+        }
+    }
+    return capture;
+}
@@ -0,0 +1,143 @@
+/// =======================================
+/// DyeWarsServer - InputLog
+///
+/// Capture of everything that enters a zone's simulation from outside,
+/// stamped with the game tick it ran in (--record FILE). DyeWarsReplay
+/// feeds a capture back through headless zones to reproduce the load.
+///
+/// WHAT IS RECORDED:
+/// Each command as the zone thread executes it (login, move, turn, warp,
+/// disconnect) and each stress-bot spawn / removal, in execution order.
+/// Recording at execution rather than in QueueCommand gives the tick for
+/// free and leaves out commands the ring dropped - the log holds exactly
+/// what the simulation saw. Everything else a tick does (bot movement,
+/// transfers between zones, broadcasting) follows from these inputs and
+/// is replayed, not recorded. Admin actions other than bots are not
+/// recorded either.
+///
+/// A Disconnect that a zone passes on to the zone holding the player is
+/// recorded by that zone only, so replay doesn't deliver it twice.
+///
+/// COST:
+/// A zone appends its entries to a reused per-tick block (a few bytes per
+/// command, see InputLogFormat) and writes the block under the log's
+/// mutex once per tick that had input. The file is buffered; it is
+/// flushed when the server shuts down.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "game/actions/GameCommand.h"
+
+/// On-disk format, shared by the server (writer) and DyeWarsReplay
+/// (reader). Integers are big-endian like the wire protocol, so
+/// PacketWriter/PacketReader are reused.
+///
+///   File:  [magic:4 "DWIL"][version:2][tps:2][flags:1][seed:8][zones:2][blocks...]
+///          flags: 1 = --deterministic, 2 = --open-warps
+///   Block: [map:2][tick:8][count:4][entries...]    one per zone tick that had input
+///   Entry: [kind:1][clientId:8, 0 for bot entries][args...]
+///          Move [direction:1][facing:1]  Turn [facing:1]  Warp [map:2][x:2][y:2]
+///          SpawnBots [count:4][clustered:1]  Login, Disconnect, RemoveBots: no args
+namespace InputLogFormat {
+    constexpr uint32_t FILE_MAGIC = 0x4457494C;  // "DWIL"
+    constexpr uint16_t VERSION = 1;
+
+    /// The first five are GameCommand::Type, value for value
+    enum class Kind : uint8_t {
+        Move,
+        Turn,
+        Warp,
+        Login,
+        Disconnect,
+        SpawnBots,
+        RemoveBots,
+    };
+
+    static_assert(static_cast<uint8_t>(Kind::Disconnect) == static_cast<uint8_t>(GameCommand::Type::Disconnect));
+
+    /// Server settings a replay needs to run the same simulation
+    struct Header {
+        uint16_t tps = 20;
+        bool deterministic = false;
+        uint64_t seed = 1;
+        uint16_t zones = 1;
+        bool open_warps = false;  // Warp requests weren't checked against warp tiles
+    };
+
+    constexpr uint8_t FLAG_DETERMINISTIC = 1;
+    constexpr uint8_t FLAG_OPEN_WARPS = 2;
+
+    /// One decoded entry
+    struct Entry {
+        uint16_t map_id = 0;
+        uint64_t tick = 0;               // GameTime tick it ran in (first tick = 1)
+        Kind kind = Kind::Login;
+        GameCommand command{};           // Move..Disconnect
+        uint32_t bot_count = 0;          // SpawnBots
+        bool clustered = false;          // SpawnBots
+    };
+
+    struct Capture {
+        Header header;
+        std::vector<Entry> entries;      // File order: by tick within each map
+    };
+
+    /// Read a whole capture. Throws std::runtime_error (bad magic or
+    /// version) or std::out_of_range (truncated).
+    Capture ReadFile(const std::string &path);
+}
+
+class InputLog {
+public:
+    /// One zone tick's entries, built on the zone thread and reused
+    class TickBlock {
+    public:
+        void Add(const GameCommand &command);
+
+        void AddSpawnBots(uint32_t count, bool clustered);
+
+        void AddRemoveBots();
+
+        bool Empty() const { return count_ == 0; }
+
+        void Clear() {
+            bytes_.clear();
+            count_ = 0;
+        }
+
+    private:
+        friend class InputLog;
+        std::vector<uint8_t> bytes_;
+        uint32_t count_ = 0;
+    };
+
+    /// Create (truncate) the capture file and write its header.
+    /// Throws std::runtime_error if the file can't be opened.
+    InputLog(const std::string &path, const InputLogFormat::Header &header);
+
+    /// Flushes the file
+    ~InputLog();
+
+    InputLog(const InputLog &) = delete;
+
+    InputLog &operator=(const InputLog &) = delete;
+
+    /// Append a zone's block for `tick` (any zone thread). Empty blocks
+    /// are skipped.
+    void Write(uint16_t map_id, uint64_t tick, const TickBlock &block);
+
+    const std::string &Path() const { return path_; }
+
+private:
+    const std::string path_;
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::vector<uint8_t> header_scratch_;  // Block header, under mutex_
+};
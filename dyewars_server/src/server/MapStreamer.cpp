@@ -0,0 +1,366 @@
+/// =======================================
+/// DyeWarsServer - MapStreamer
+/// =======================================
+#include "MapStreamer.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include "network/Packets/OpCodes.h"
+#include "network/Packets/Protocol.h"
+
+using namespace Protocol::PacketWriter;
+using namespace Protocol::PacketReader;
+
+/// ============================================================================
+/// CODEC
+/// ============================================================================
+
+namespace {
+    /// Palettes up to this size pack a run into one byte
+    constexpr size_t SMALL_PALETTE = 16;
+}
+
+std::vector<uint8_t> TileChunkCodec::Encode(const TileMap &map, int16_t chunk_x, int16_t chunk_y,
+                                            std::vector<uint8_t> &scratch) {
+    constexpr int16_t size = TileMap::CHUNK_SIZE;
+    const int16_t x0 = static_cast<int16_t>(chunk_x * size);
+    const int16_t y0 = static_cast<int16_t>(chunk_y * size);
+    const auto width = static_cast<int16_t>(std::min<int>(size, map.GetWidth() - x0));
+    const auto height = static_cast<int16_t>(std::min<int>(size, map.GetHeight() - y0));
+    map.CopyRegionTiles(x0, y0, width, height, scratch);
+
+    // Palette in order of first appearance
+    std::array<int16_t, 256> index_of;
+    index_of.fill(-1);
+    std::vector<uint8_t> palette;
+    for (const uint8_t tile : scratch) {
+        if (index_of[tile] >= 0) continue;
+        index_of[tile] = static_cast<int16_t>(palette.size());
+        palette.push_back(tile);
+    }
+
+    Protocol::Packet pkt;
+    pkt.payload.reserve(16 + palette.size() + scratch.size() / 4);
+    WriteByte(pkt.payload, Protocol::Opcode::Map::Server::S_Tile_Data.op);
+    WriteShort(pkt.payload, static_cast<uint16_t>(map.GetMapID()));
+    WriteShort(pkt.payload, static_cast<uint16_t>(chunk_x));
+    WriteShort(pkt.payload, static_cast<uint16_t>(chunk_y));
+    WriteUInt(pkt.payload, map.ChunkVersion(chunk_x, chunk_y));
+    WriteByte(pkt.payload, static_cast<uint8_t>(width));
+    WriteByte(pkt.payload, static_cast<uint8_t>(height));
+    WriteShort(pkt.payload, static_cast<uint16_t>(palette.size()));
+    pkt.payload.insert(pkt.payload.end(), palette.begin(), palette.end());
+
+    if (palette.size() > 1) {
+        const bool small = palette.size() <= SMALL_PALETTE;
+        const size_t max_run = small ? 16 : 256;
+        for (size_t i = 0; i < scratch.size();) {
+            const uint8_t tile = scratch[i];
+            size_t run = 1;
+            while (i + run < scratch.size() && scratch[i + run] == tile && run < max_run) run++;
+
+            const auto index = static_cast<uint8_t>(index_of[tile]);
+            if (small) {
+                WriteByte(pkt.payload, static_cast<uint8_t>(index << 4 | (run - 1)));
+            } else {
+                WriteByte(pkt.payload, index);
+                WriteByte(pkt.payload, static_cast<uint8_t>(run - 1));
+            }
+            i += run;
+        }
+    }
+
+    // Dynamic blockers: chunk-local coordinates, or a bitmap once that's smaller
+    std::vector<uint8_t> blockers;
+    for (int16_t y = 0; y < height; y++) {
+        for (int16_t x = 0; x < width; x++) {
+            if (!map.IsTileDynamicBlocked(static_cast<int16_t>(x0 + x), static_cast<int16_t>(y0 + y))) continue;
+            blockers.push_back(static_cast<uint8_t>(x));
+            blockers.push_back(static_cast<uint8_t>(y));
+        }
+    }
+    const size_t bitmap_bytes = (scratch.size() + 7) / 8;
+    if (blockers.empty()) {
+        WriteByte(pkt.payload, static_cast<uint8_t>(Blockers::None));
+    } else if (2 + blockers.size() <= bitmap_bytes) {
+        WriteByte(pkt.payload, static_cast<uint8_t>(Blockers::List));
+        WriteShort(pkt.payload, static_cast<uint16_t>(blockers.size() / 2));
+        pkt.payload.insert(pkt.payload.end(), blockers.begin(), blockers.end());
+    } else {
+        WriteByte(pkt.payload, static_cast<uint8_t>(Blockers::Bitmap));
+        const size_t bitmap = pkt.payload.size();
+        pkt.payload.resize(bitmap + bitmap_bytes, 0);
+        for (size_t i = 0; i < blockers.size(); i += 2) {
+            const size_t tile = static_cast<size_t>(blockers[i + 1]) * width + blockers[i];
+            pkt.payload[bitmap + tile / 8] |= static_cast<uint8_t>(1 << (tile % 8));
+        }
+    }
+
+    pkt.size = static_cast<uint16_t>(pkt.payload.size());
+    return pkt.ToBytes();
+}
+
+std::vector<uint8_t> TileChunkCodec::EncodeMapInfo(const TileMap &map) {
+    const std::string &name = map.GetMapName();
+    const size_t name_length = std::min<size_t>(name.size(), 255);
+
+    Protocol::Packet pkt;
+    WriteByte(pkt.payload, Protocol::Opcode::Map::Server::S_Map_Info.op);
+    WriteShort(pkt.payload, static_cast<uint16_t>(map.GetMapID()));
+    WriteShort(pkt.payload, static_cast<uint16_t>(map.GetWidth()));
+    WriteShort(pkt.payload, static_cast<uint16_t>(map.GetHeight()));
+    WriteByte(pkt.payload, static_cast<uint8_t>(TileMap::CHUNK_SIZE));
+    WriteByte(pkt.payload, 0);  // Flags, none yet
+    WriteByte(pkt.payload, static_cast<uint8_t>(name_length));
+    pkt.payload.insert(pkt.payload.end(), name.begin(), name.begin() + static_cast<std::ptrdiff_t>(name_length));
+    pkt.size = static_cast<uint16_t>(pkt.payload.size());
+    return pkt.ToBytes();
+}
+
+std::vector<uint8_t> TileChunkCodec::EncodeTileUpdate(uint16_t map_id,
+                                                      std::span<const TileChangeJournal::Change> changes) {
+    Protocol::Packet pkt;
+    pkt.payload.reserve(5 + changes.size() * 6);
+    WriteByte(pkt.payload, Protocol::Opcode::Map::Server::S_Tile_Update.op);
+    WriteShort(pkt.payload, map_id);
+    WriteShort(pkt.payload, static_cast<uint16_t>(changes.size()));
+    for (const auto &change : changes) {
+        WriteShort(pkt.payload, static_cast<uint16_t>(change.x));
+        WriteShort(pkt.payload, static_cast<uint16_t>(change.y));
+        WriteByte(pkt.payload, change.type);
+        WriteByte(pkt.payload, change.blocked ? 1 : 0);
+    }
+    pkt.size = static_cast<uint16_t>(pkt.payload.size());
+    return pkt.ToBytes();
+}
+
+TileChunkCodec::Chunk TileChunkCodec::Decode(std::span<const uint8_t> payload) {
+    size_t offset = 0;
+    if (ReadByte(payload, offset) != Protocol::Opcode::Map::Server::S_Tile_Data.op) {
+        throw std::runtime_error("not a S_Tile_Data packet");
+    }
+
+    Chunk chunk;
+    chunk.map_id = ReadShort(payload, offset);
+    chunk.chunk_x = ReadShort(payload, offset);
+    chunk.chunk_y = ReadShort(payload, offset);
+    chunk.version = ReadUInt(payload, offset);
+    chunk.width = ReadByte(payload, offset);
+    chunk.height = ReadByte(payload, offset);
+    chunk.palette_size = ReadShort(payload, offset);
+    if (chunk.palette_size == 0 || chunk.palette_size > 256) throw std::runtime_error("bad palette size");
+
+    std::vector<uint8_t> palette(chunk.palette_size);
+    for (auto &entry : palette) entry = ReadByte(payload, offset);
+
+    const size_t tile_count = static_cast<size_t>(chunk.width) * chunk.height;
+    const bool small = chunk.palette_size <= SMALL_PALETTE;
+    if (chunk.palette_size == 1) chunk.tiles.assign(tile_count, palette[0]);
+    chunk.tiles.reserve(tile_count);
+    while (chunk.tiles.size() < tile_count) {
+        size_t index;
+        size_t run;
+        if (small) {
+            const uint8_t packed = ReadByte(payload, offset);
+            index = packed >> 4;
+            run = (packed & 0x0F) + 1;
+        } else {
+            index = ReadByte(payload, offset);
+            run = static_cast<size_t>(ReadByte(payload, offset)) + 1;
+        }
+        if (index >= palette.size() || chunk.tiles.size() + run > tile_count) {
+            throw std::runtime_error("bad run in S_Tile_Data");
+        }
+        chunk.tiles.insert(chunk.tiles.end(), run, palette[index]);
+    }
+
+    chunk.blocked.assign(tile_count, 0);
+    switch (static_cast<Blockers>(ReadByte(payload, offset))) {
+        case Blockers::None:
+            break;
+        case Blockers::List: {
+            const uint16_t count = ReadShort(payload, offset);
+            for (uint16_t i = 0; i < count; i++) {
+                const uint8_t x = ReadByte(payload, offset);
+                const uint8_t y = ReadByte(payload, offset);
+                if (x >= chunk.width || y >= chunk.height) throw std::runtime_error("blocker outside the chunk");
+                chunk.blocked[static_cast<size_t>(y) * chunk.width + x] = 1;
+            }
+            break;
+        }
+        case Blockers::Bitmap:
+            for (size_t byte = 0; byte < (tile_count + 7) / 8; byte++) {
+                const uint8_t bits = ReadByte(payload, offset);
+                for (size_t bit = 0; bit < 8 && byte * 8 + bit < tile_count; bit++) {
+                    chunk.blocked[byte * 8 + bit] = (bits >> bit) & 1;
+                }
+            }
+            break;
+        default:
+            throw std::runtime_error("bad blockers in S_Tile_Data");
+    }
+    return chunk;
+}
+
+std::vector<TileChangeJournal::Change> TileChunkCodec::DecodeTileUpdate(std::span<const uint8_t> payload,
+                                                                        uint16_t &map_id) {
+    size_t offset = 0;
+    if (ReadByte(payload, offset) != Protocol::Opcode::Map::Server::S_Tile_Update.op) {
+        throw std::runtime_error("not a S_Tile_Update packet");
+    }
+    map_id = ReadShort(payload, offset);
+
+    std::vector<TileChangeJournal::Change> changes(ReadShort(payload, offset));
+    for (auto &change : changes) {
+        change.x = static_cast<int16_t>(ReadShort(payload, offset));
+        change.y = static_cast<int16_t>(ReadShort(payload, offset));
+        change.type = ReadByte(payload, offset);
+        change.blocked = (ReadByte(payload, offset) & 1) != 0;
+        change.chunk = 0;
+    }
+    return changes;
+}
+
+/// ============================================================================
+/// STREAMER
+/// ============================================================================
+
+MapStreamer::MapStreamer(const TileMap &map, int16_t view_radius)
+        : map_(map),
+          view_radius_(view_radius),
+          cache_(static_cast<size_t>(map.ChunksX()) * map.ChunksY()),
+          checked_revision_(map.Revision()) {
+}
+
+void MapStreamer::Enter(TickDelta &delta, uint64_t client_id, int16_t x, int16_t y, uint8_t facing) {
+    ClientView &view = clients_[client_id];
+    view = ClientView{};
+    view.held.assign(cache_.size(), 0);
+    view.x = x;
+    view.y = y;
+    view.facing = facing;
+
+    delta.AddRaw(client_id, std::make_shared<std::vector<uint8_t>>(TileChunkCodec::EncodeMapInfo(map_)));
+    Stream(delta, client_id, view, true);
+}
+
+void MapStreamer::Update(TickDelta &delta, uint64_t client_id, int16_t x, int16_t y, uint8_t facing) {
+    auto it = clients_.find(client_id);
+    if (it == clients_.end()) return;
+
+    ClientView &view = it->second;
+    view.x = x;
+    view.y = y;
+    view.facing = facing;
+    Stream(delta, client_id, view, false);
+}
+
+void MapStreamer::SendChanged(TickDelta &delta) {
+    if (map_.Revision() == checked_revision_) return;
+    checked_revision_ = map_.Revision();
+    for (auto &[client_id, view] : clients_) Stream(delta, client_id, view, false);
+}
+
+void MapStreamer::Patched(uint64_t client_id, uint32_t index, uint32_t version_before) {
+    auto it = clients_.find(client_id);
+    if (it == clients_.end() || index >= cache_.size()) return;
+
+    uint32_t &held = it->second.held[index];
+    if (held == version_before) held = CurrentVersion(index);
+}
+
+void MapStreamer::PatchedAll(uint32_t index, uint32_t version_before) {
+    if (index >= cache_.size()) return;
+    const uint32_t current = CurrentVersion(index);
+    for (auto &[client_id, view] : clients_) {
+        if (view.held[index] == version_before) view.held[index] = current;
+    }
+}
+
+MapStreamer::Stats MapStreamer::TakeStats() {
+    const Stats taken = stats_;
+    stats_ = Stats{};
+    return taken;
+}
+
+uint32_t MapStreamer::CurrentVersion(uint32_t index) const {
+    return map_.ChunkVersion(static_cast<int16_t>(index % static_cast<uint32_t>(map_.ChunksX())),
+                             static_cast<int16_t>(index / static_cast<uint32_t>(map_.ChunksX())));
+}
+
+MapStreamer::ChunkRect MapStreamer::ToChunks(int x0, int y0, int x1, int y1) const {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, map_.GetWidth() - 1);
+    y1 = std::min(y1, map_.GetHeight() - 1);
+    if (x0 > x1 || y0 > y1) return {};
+    return {static_cast<int16_t>(x0 / TileMap::CHUNK_SIZE), static_cast<int16_t>(y0 / TileMap::CHUNK_SIZE),
+            static_cast<int16_t>(x1 / TileMap::CHUNK_SIZE), static_cast<int16_t>(y1 / TileMap::CHUNK_SIZE)};
+}
+
+void MapStreamer::Stream(TickDelta &delta, uint64_t client_id, ClientView &view, bool force) {
+    int x0 = view.x - view_radius_;
+    int y0 = view.y - view_radius_;
+    int x1 = view.x + view_radius_;
+    int y1 = view.y + view_radius_;
+    const ChunkRect in_view = ToChunks(x0, y0, x1, y1);
+
+    // Direction convention: 0 = north (y + 1), 1 = east, 2 = south, 3 = west
+    switch (view.facing) {
+        case 0: y1 += PREFETCH_TILES; break;
+        case 1: x1 += PREFETCH_TILES; break;
+        case 2: y0 -= PREFETCH_TILES; break;
+        case 3: x0 -= PREFETCH_TILES; break;
+        default: break;
+    }
+    const ChunkRect window = ToChunks(x0, y0, x1, y1);
+
+    if (!force && window == view.window && view.revision == map_.Revision()) return;
+    view.window = window;
+    view.revision = map_.Revision();
+
+    SendRect(delta, client_id, view, in_view, ChunkRect{});
+    SendRect(delta, client_id, view, window, in_view);
+}
+
+void MapStreamer::SendRect(TickDelta &delta, uint64_t client_id, ClientView &view,
+                           const ChunkRect &rect, const ChunkRect &except) {
+    const int16_t chunks_x = map_.ChunksX();
+    for (int16_t cy = rect.y0; cy <= rect.y1; cy++) {
+        for (int16_t cx = rect.x0; cx <= rect.x1; cx++) {
+            if (except.Contains(cx, cy)) continue;
+
+            const size_t index = static_cast<size_t>(cy) * chunks_x + cx;
+            const uint32_t version = map_.ChunkVersion(cx, cy);
+            if (view.held[index] == version) {
+                stats_.held_skips++;
+                if (cache_[index].version == version) stats_.held_bytes_saved += cache_[index].bytes->size();
+                continue;
+            }
+
+            const auto &bytes = Encoded(cx, cy, index);
+            delta.AddRaw(client_id, bytes);
+            view.held[index] = version;
+            stats_.chunks_sent++;
+            stats_.bytes_sent += bytes->size();
+            const int width = std::min<int>(TileMap::CHUNK_SIZE, map_.GetWidth() - cx * TileMap::CHUNK_SIZE);
+            const int height = std::min<int>(TileMap::CHUNK_SIZE, map_.GetHeight() - cy * TileMap::CHUNK_SIZE);
+            stats_.raw_bytes += static_cast<uint64_t>(width) * height;
+        }
+    }
+}
+
+const std::shared_ptr<std::vector<uint8_t>> &MapStreamer::Encoded(int16_t chunk_x, int16_t chunk_y, size_t index) {
+    CachedChunk &cached = cache_[index];
+    const uint32_t version = map_.ChunkVersion(chunk_x, chunk_y);
+    if (cached.version == version) {
+        stats_.cache_hits++;
+        return cached.bytes;
+    }
+
+    // A new buffer, not an overwrite - deltas still queued may share the old one
+    stats_.cache_misses++;
+    cached.version = version;
+    cached.bytes = std::make_shared<std::vector<uint8_t>>(TileChunkCodec::Encode(map_, chunk_x, chunk_y, scratch_));
+    return cached.bytes;
+}
@@ -0,0 +1,211 @@
+/// =======================================
+/// DyeWarsServer - MapStreamer
+///
+/// Sends a zone's map to its clients in TileMap::CHUNK_SIZE chunks
+/// (S_Tile_Data), only the ones each client is missing, as players move.
+///
+/// WHY CHUNKS, NOT THE VIEW:
+/// A view-sized region (GetViewTiles) changes with every step, so it would
+/// be rebuilt and resent per move per player. A 32x32 chunk is the same
+/// bytes for everyone until a tile in it changes, so each chunk is encoded
+/// once per version into an immutable buffer, and every client that needs
+/// it gets the same shared_ptr. The clients' sends go through the tick's
+/// TickDelta like every other packet, so they stay in tick order.
+///
+/// WHAT A CLIENT GETS:
+/// S_Map_Info when it enters the zone (the client drops old chunks), then
+/// every chunk overlapping its view, then the chunks PREFETCH_TILES further
+/// in the direction it faces - so walking on, the next chunk is usually
+/// there before the view reaches it. Per client we keep the version of each
+/// chunk it holds: a chunk is sent when the client has no copy or an older
+/// version, never twice. A window that didn't move on a map that didn't
+/// change costs two compares.
+///
+/// COMPRESSION:
+/// Maps are mostly long runs of a few tile types: the chunk's palette (tile
+/// types in order of first use) plus run-length pairs, packed into one byte
+/// per run when the palette has at most 16 entries. A uniform chunk is
+/// 21 bytes framed instead of 1024. See TileChunkCodec and OpCodes.h.
+///
+/// DYNAMIC BLOCKERS:
+/// Doors and placed obstacles (TileMap::SetTileBlocked) aren't in the tile
+/// types, so each chunk also lists them - a few bytes per blocker, or a
+/// bitmap when there are many. Setting one moves the chunk's version on,
+/// so a player arriving or logging in later gets the door as it is now.
+///
+/// TILE EDITS:
+/// Edits reach the players who can see them as S_Tile_Update (see
+/// Zone::BroadcastTileChanges), which then marks the chunks those clients
+/// got every change of with Patched(). Only clients that held a chunk
+/// without seeing all of its edits get the whole chunk again.
+///
+/// Bots have no connection and never Enter, so they get nothing.
+///
+/// Not thread-safe; owned and called by the zone's game thread.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "game/TileChangeJournal.h"
+#include "game/TileMap.h"
+#include "network/Packets/Protocol.h"
+#include "server/TickDelta.h"
+
+/// S_Tile_Data / S_Map_Info encoding. Decode is the client's side - the
+/// server only uses it in tests.
+namespace TileChunkCodec {
+    /// One decoded S_Tile_Data
+    struct Chunk {
+        uint16_t map_id = 0;
+        uint16_t chunk_x = 0;
+        uint16_t chunk_y = 0;
+        uint32_t version = 0;
+        uint8_t width = 0;
+        uint8_t height = 0;
+        uint16_t palette_size = 0;
+        std::vector<uint8_t> tiles;    // Row-major, width * height
+        std::vector<uint8_t> blocked;  // Same layout, 1 = dynamic blocker
+    };
+
+    /// How S_Tile_Data carries the chunk's dynamic blockers (after the runs)
+    enum class Blockers : uint8_t {
+        None = 0,
+        List = 1,    // [count:2][[x:1][y:1]...], chunk-local
+        Bitmap = 2,  // ceil(width * height / 8) bytes, row-major, LSB first
+    };
+
+    /// Framed S_Tile_Data for chunk (chunk_x, chunk_y) at its current
+    /// version, dynamic blockers included. `scratch` is reused for the
+    /// chunk's tiles.
+    std::vector<uint8_t> Encode(const TileMap &map, int16_t chunk_x, int16_t chunk_y,
+                                std::vector<uint8_t> &scratch);
+
+    /// Framed S_Map_Info
+    std::vector<uint8_t> EncodeMapInfo(const TileMap &map);
+
+    /// Most tiles one S_Tile_Update can carry under the payload limit
+    /// (5-byte header, 6 bytes per tile)
+    constexpr size_t MAX_TILES_PER_UPDATE = (Protocol::MAX_PAYLOAD_SIZE - 1 - 5) / 6;
+
+    /// Framed S_Tile_Update, at most MAX_TILES_PER_UPDATE changes
+    std::vector<uint8_t> EncodeTileUpdate(uint16_t map_id, std::span<const TileChangeJournal::Change> changes);
+
+    /// S_Tile_Data payload (opcode first, no frame header). Throws
+    /// std::out_of_range (truncated) or std::runtime_error (bad opcode,
+    /// palette or run).
+    Chunk Decode(std::span<const uint8_t> payload);
+
+    /// S_Tile_Update payload (opcode first) -> its map id and changes
+    /// (chunk slots are 0). Throws like Decode.
+    std::vector<TileChangeJournal::Change> DecodeTileUpdate(std::span<const uint8_t> payload, uint16_t &map_id);
+}
+
+class MapStreamer {
+public:
+    /// Tiles past the view to fetch ahead in the facing direction
+    static constexpr int16_t PREFETCH_TILES = TileMap::CHUNK_SIZE / 2;
+
+    /// Accumulated since the last TakeStats()
+    struct Stats {
+        uint64_t chunks_sent = 0;
+        uint64_t bytes_sent = 0;         // Encoded S_Tile_Data bytes queued
+        uint64_t raw_bytes = 0;          // Same chunks at one byte per tile
+        uint64_t held_skips = 0;         // Chunks in a new window the client already held
+        uint64_t held_bytes_saved = 0;   // Their encoded size
+        uint64_t cache_hits = 0;         // Sends served from an encoded buffer
+        uint64_t cache_misses = 0;       // Sends that had to encode
+    };
+
+    /// `view_radius`: tiles visible each side of the player (World::VIEW_RANGE)
+    MapStreamer(const TileMap &map, int16_t view_radius);
+
+    /// Client entered the zone at (x, y): S_Map_Info, then its chunks.
+    /// Forgets whatever it held before.
+    void Enter(TickDelta &delta, uint64_t client_id, int16_t x, int16_t y, uint8_t facing);
+
+    /// Client's player moved or turned: send the chunks it is missing.
+    /// Clients that never entered are ignored.
+    void Update(TickDelta &delta, uint64_t client_id, int16_t x, int16_t y, uint8_t facing);
+
+    /// Re-check every client against the map if any tile changed since the
+    /// last call - players standing still get edited chunks too
+    void SendChanged(TickDelta &delta);
+
+    /// The client was sent every change a tile edit made to chunk `index`
+    /// (S_Tile_Update), so a copy it held at `version_before` is now
+    /// current - SendChanged won't re-send it. A copy it held at another
+    /// version still is.
+    void Patched(uint64_t client_id, uint32_t index, uint32_t version_before);
+
+    /// Patched() for every client: the chunk was edited but ended as it was
+    void PatchedAll(uint32_t index, uint32_t version_before);
+
+    void Leave(uint64_t client_id) { clients_.erase(client_id); }
+
+    bool HasClient(uint64_t client_id) const { return clients_.contains(client_id); }
+
+    size_t ClientCount() const { return clients_.size(); }
+
+    /// Free the encoded chunks, e.g. when the map is released. Rebuilt on
+    /// demand; chunk versions move on when the map loads again anyway.
+    void DropCache() { cache_.assign(cache_.size(), CachedChunk{}); }
+
+    Stats TakeStats();
+
+private:
+    /// Chunk coordinates, inclusive; empty if x0 > x1
+    struct ChunkRect {
+        int16_t x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+
+        bool operator==(const ChunkRect &) const = default;
+
+        bool Contains(int16_t x, int16_t y) const { return x >= x0 && x <= x1 && y >= y0 && y <= y1; }
+    };
+
+    struct ClientView {
+        std::vector<uint32_t> held;  // Per chunk, row-major; 0 = not held
+        ChunkRect window;            // Last view + prefetch window
+        uint64_t revision = 0;       // Map revision when it was checked
+        int16_t x = 0;
+        int16_t y = 0;
+        uint8_t facing = 0;
+    };
+
+    struct CachedChunk {
+        uint32_t version = 0;  // 0 = never encoded
+        std::shared_ptr<std::vector<uint8_t>> bytes;
+    };
+
+    /// Map's version of chunk `index` (row-major)
+    uint32_t CurrentVersion(uint32_t index) const;
+
+    /// Tile rect -> chunks it overlaps, clipped to the map
+    ChunkRect ToChunks(int x0, int y0, int x1, int y1) const;
+
+    /// Queue every chunk of `rect` outside `except` that the client
+    /// doesn't hold at its current version
+    void SendRect(TickDelta &delta, uint64_t client_id, ClientView &view,
+                  const ChunkRect &rect, const ChunkRect &except);
+
+    /// Send the chunks the client is missing around its position, view
+    /// first. Unless `force`, nothing happens while neither the window nor
+    /// the map changed.
+    void Stream(TickDelta &delta, uint64_t client_id, ClientView &view, bool force);
+
+    /// Encoded buffer for a chunk at its current version
+    const std::shared_ptr<std::vector<uint8_t>> &Encoded(int16_t chunk_x, int16_t chunk_y, size_t index);
+
+    const TileMap &map_;
+    const int16_t view_radius_;
+    std::vector<CachedChunk> cache_;  // Per chunk, row-major
+    std::unordered_map<uint64_t, ClientView> clients_;
+    uint64_t checked_revision_ = 0;   // Map revision at the last SendChanged
+    std::vector<uint8_t> scratch_;    // Chunk tiles while encoding
+    Stats stats_;
+};
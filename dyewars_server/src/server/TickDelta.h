@@ -0,0 +1,260 @@
+/// =======================================
+/// DyeWarsServer - TickDelta
+///
+/// Everything one tick decided to tell clients, as plain data: spatial
+/// records per viewer, "player left your view" notices and pre-encoded
+/// packets (map chunks), in the order the simulation produced them - plus
+/// the players it hands to other zones.
+/// The zone's game thread fills it during the tick; Zone::EncodeDelta turns
+/// it into packets - inline at the end of the tick, or on the zone's encoder
+/// thread with --pipeline.
+///
+/// WHY COPIES, NOT PLAYER POINTERS:
+/// With --pipeline the encoder works on tick N while the game thread is
+/// already moving players for tick N+1. Records copy (id, x, y, facing) when
+/// they are added, so a published delta never reads game state again.
+///
+/// WHY LEAVES GO THROUGH IT TOO:
+/// A S_Left_Game sent straight from tick N+1 could overtake tick N's
+/// spatial batch about the same player, and the client would re-create a
+/// player that already left. Every visibility packet goes through the delta
+/// so a client sees them in tick order.
+///
+/// WHY TRANSFERS RIDE ALONG:
+/// A player warping to another zone must not show up there (and get that
+/// zone's packets) before this zone's last packets to them are queued -
+/// those would re-create players the client just dropped. Transfers are
+/// delivered only after the delta they came from has been encoded.
+///
+/// THREAD SAFETY:
+/// Not synchronized. One writer (game thread) until Publish, then one
+/// reader (encoder). TickDeltaPipeline does the hand-off.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <span>
+#include <string>
+#include <vector>
+#include "game/Player.h"
+#include "game/PlayerTable.h"
+
+/// A player leaving one zone for another (see ZoneManager). Plain data: the
+/// Player object stays behind; the target zone builds its own from this.
+struct ZoneTransfer {
+    uint64_t client_id;
+    uint64_t player_id;
+    uint16_t from_map;
+    uint16_t to_map;
+    int16_t x;
+    int16_t y;
+    uint8_t facing;
+    std::string name;
+};
+
+struct TickDelta {
+    using Clock = std::chrono::steady_clock;
+
+    /// One player's position as of the tick that recorded it
+    struct Record {
+        uint64_t player_id;
+        int16_t x;
+        int16_t y;
+        uint8_t facing;
+    };
+
+    enum class Kind : uint8_t { Spatial, Left, Raw };
+
+    struct Event {
+        uint64_t client_id;  // Who receives it
+        Kind kind;
+        uint32_t first = 0;       // Spatial: records[first, first + count); Raw: raw[first]
+        uint32_t count = 0;
+        uint32_t reliable = 0;    // Spatial: leading records that must go over TCP
+        uint64_t player_id = 0;   // Left: who left the client's view
+    };
+
+    uint64_t tick = 0;
+    Clock::time_point tick_start{};
+
+    // Broadcast stats carried over to whoever encodes
+    double query_ms = 0;
+    size_t dirty_count = 0;
+
+    std::vector<Record> records;
+    std::vector<Event> events;
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> raw;  // Framed packets, never modified
+    std::vector<ZoneTransfer> transfers;  // Delivered after the events are queued
+
+    /// Start recording `tick_index`. Keeps the vectors' capacity.
+    void Begin(uint64_t tick_index, Clock::time_point start) {
+        tick = tick_index;
+        tick_start = start;
+        query_ms = 0;
+        dirty_count = 0;
+        records.clear();
+        events.clear();
+        raw.clear();
+        transfers.clear();
+    }
+
+    /// Spatial records for one client. `reliable` players always go over
+    /// TCP (first sightings - the record creates the player client-side);
+    /// `unreliable` ones may go over UDP when the client bound the channel.
+    void AddSpatial(uint64_t client_id,
+                    std::span<const std::shared_ptr<Player>> reliable,
+                    std::span<const std::shared_ptr<Player>> unreliable = {}) {
+        if (reliable.empty() && unreliable.empty()) return;
+
+        Event event{client_id, Kind::Spatial};
+        event.first = static_cast<uint32_t>(records.size());
+        event.count = static_cast<uint32_t>(reliable.size() + unreliable.size());
+        event.reliable = static_cast<uint32_t>(reliable.size());
+        for (const auto &player : reliable) Capture(*player);
+        for (const auto &player : unreliable) Capture(*player);
+        events.push_back(event);
+    }
+
+    /// Same, for players named by handle: records are copied straight from
+    /// the registry's columns without touching the Player objects
+    void AddSpatial(uint64_t client_id,
+                    const PlayerTable &table,
+                    std::span<const PlayerHandle> reliable,
+                    std::span<const PlayerHandle> unreliable) {
+        if (reliable.empty() && unreliable.empty()) return;
+
+        Event event{client_id, Kind::Spatial};
+        event.first = static_cast<uint32_t>(records.size());
+        event.count = static_cast<uint32_t>(reliable.size() + unreliable.size());
+        event.reliable = static_cast<uint32_t>(reliable.size());
+        for (PlayerHandle handle : reliable) Capture(table, handle);
+        for (PlayerHandle handle : unreliable) Capture(table, handle);
+        events.push_back(event);
+    }
+
+    /// Tell `client_id` that `player_id` left its view
+    void AddLeft(uint64_t client_id, uint64_t player_id) {
+        Event event{client_id, Kind::Left};
+        event.player_id = player_id;
+        events.push_back(event);
+    }
+
+    /// Send `bytes` (a whole framed packet) to `client_id` as is. The
+    /// buffer may be shared with other clients and other ticks, so it must
+    /// not change once added.
+    void AddRaw(uint64_t client_id, std::shared_ptr<std::vector<uint8_t>> bytes) {
+        Event event{client_id, Kind::Raw};
+        event.first = static_cast<uint32_t>(raw.size());
+        raw.push_back(std::move(bytes));
+        events.push_back(event);
+    }
+
+    std::span<const Record> RecordsOf(const Event &event) const {
+        return std::span<const Record>(records).subspan(event.first, event.count);
+    }
+
+    bool Empty() const { return events.empty() && transfers.empty(); }
+
+    /// Event indices grouped by client, each client's events still in the
+    /// order they were added. Lets the encoder fan out per client without
+    /// reordering any one client's packets.
+    void GroupByClient(std::vector<uint32_t> &order) const {
+        order.resize(events.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+            return events[a].client_id < events[b].client_id;
+        });
+    }
+
+private:
+    void Capture(const Player &player) {
+        records.push_back({player.GetID(), player.GetX(), player.GetY(), player.GetFacing()});
+    }
+
+    void Capture(const PlayerTable &table, PlayerHandle handle) {
+        const uint32_t index = SlotHandle::Index(handle);
+        records.push_back({table.id[index], table.x[index], table.y[index], table.facing[index]});
+    }
+};
+
+/// ============================================================================
+/// Hand-off from the game thread to the encoder thread (--pipeline).
+///
+/// At most MAX_IN_FLIGHT deltas wait to be encoded. If the encoder falls
+/// that far behind, Publish blocks the game thread rather than letting
+/// memory and latency grow without bound. Encoded deltas come back through
+/// Recycle so steady state allocates nothing.
+/// ============================================================================
+class TickDeltaPipeline {
+public:
+    static constexpr size_t MAX_IN_FLIGHT = 2;
+
+    /// Producer: an empty delta (recycled when one is available)
+    std::unique_ptr<TickDelta> Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) return std::make_unique<TickDelta>();
+        auto delta = std::move(free_.back());
+        free_.pop_back();
+        return delta;
+    }
+
+    /// Producer: queue a finished delta. Returns true if the encoder was
+    /// MAX_IN_FLIGHT behind and this call had to wait. Dropped after Stop.
+    bool Publish(std::unique_ptr<TickDelta> delta) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const bool stalled = pending_.size() >= MAX_IN_FLIGHT;
+        space_cv_.wait(lock, [this] { return pending_.size() < MAX_IN_FLIGHT || stopped_; });
+        if (stopped_) return stalled;
+        pending_.push_back(std::move(delta));
+        ready_cv_.notify_one();
+        return stalled;
+    }
+
+    /// Consumer: next delta in tick order. Blocks; nullptr once stopped and
+    /// everything published before Stop has been taken.
+    std::unique_ptr<TickDelta> Take() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_cv_.wait(lock, [this] { return !pending_.empty() || stopped_; });
+        if (pending_.empty()) return nullptr;
+        auto delta = std::move(pending_.front());
+        pending_.pop_front();
+        space_cv_.notify_one();
+        return delta;
+    }
+
+    /// Consumer: hand an encoded delta back for reuse
+    void Recycle(std::unique_ptr<TickDelta> delta) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(std::move(delta));
+    }
+
+    /// Wake both sides. The consumer still drains what was published.
+    void Stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        ready_cv_.notify_all();
+        space_cv_.notify_all();
+    }
+
+    size_t Pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_.size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable ready_cv_;  // Consumer waits for a delta
+    std::condition_variable space_cv_;  // Producer waits for a free slot
+    std::deque<std::unique_ptr<TickDelta>> pending_;
+    std::vector<std::unique_ptr<TickDelta>> free_;
+    bool stopped_ = false;
+};
@@ -0,0 +1,1401 @@
+/// =======================================
+/// DyeWarsServer - Zone
+/// =======================================
+#include "Zone.h"
+#include "GameServer.h"
+#include "ZoneManager.h"
+#include "ClientConnection.h"
+#include <algorithm>
+#include <filesystem>
+#include "FakeClientConnection.h"
+#include "core/Log.h"
+#include "game/actions/Actions.h"
+#include "network/BandwidthMonitor.h"
+#include "network/UdpSpatialChannel.h"
+#include "network/packets/outgoing/PacketSender.h"
+
+Zone::Zone(GameServer &server, ZoneManager &zones, uint16_t map_id, const ServerConfig &config)
+        : server_(server),
+          zones_(zones),
+          jobs_(server.Jobs()),
+          map_id_(map_id),
+          world_(CreateMap(map_id, config)),
+          tick_scheduler_(config.tick),
+          deterministic_(config.deterministic),
+          input_log_(server.Inputs()),
+          pipelined_(config.pipeline),
+          delta_(pipeline_.Acquire()) {
+    world_.GetMap().SetMapID(map_id);
+    if (world_.GetMap().GetMapName().empty()) world_.GetMap().SetMapName("map" + std::to_string(map_id));
+
+    // Bot client ids: high bit set, then the map, so zones never collide
+    bot_manager_.client_id_base = Actions::BotStressTest::BOT_CLIENT_ID_BIT + (static_cast<uint64_t>(map_id) << 32);
+
+    game_time_.tick_length = std::chrono::duration_cast<std::chrono::microseconds>(tick_scheduler_.Interval());
+    map_idle_ticks_ = game_time_.TicksFor(std::chrono::seconds(config.map_idle_seconds));
+
+    // --deterministic: everything random in the simulation comes from the
+    // seed, offset per map so zones don't mirror each other
+    if (config.deterministic) {
+        players_.Seed(config.seed + map_id);
+        bot_manager_.rng.seed(static_cast<std::mt19937::result_type>(config.seed + map_id));
+        token_rng_.seed(config.seed + map_id);
+    }
+
+    // --shard splits map 0 only (ServerConfig rejects it with more maps)
+    if (IsPrimary() && config.shard_count > 1) {
+        layout_ = ShardLayout{static_cast<uint8_t>(config.shard_index), static_cast<uint8_t>(config.shard_count),
+                              world_.GetMap().GetWidth()};
+    }
+}
+
+Zone::~Zone() {
+    Stop();
+}
+
+void Zone::Start() {
+    if (running_.exchange(true)) return;
+
+    // GameServer opens the link before starting the zones
+    if (layout_.IsSharded()) {
+        shard_link_ = server_.Shards();
+        assert(shard_link_ && "sharded zone started without a shard link");
+        Log::Info("Map {} is shard {}/{}: columns {}-{}", map_id_, layout_.index, layout_.count,
+                  layout_.Begin(layout_.index), layout_.End(layout_.index) - 1);
+    }
+
+    // Encoder first - the zone thread publishes to it from the first tick
+    if (pipelined_) {
+        encoder_thread_ = std::thread(&Zone::EncoderThread, this);
+    }
+    thread_ = std::thread(&Zone::GameLogicThread, this);
+}
+
+void Zone::Stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // Nothing publishes any more; the encoder finishes what it was given
+    pipeline_.Stop();
+    if (encoder_thread_.joinable()) {
+        encoder_thread_.join();
+    }
+}
+
+ClientManager &Zone::Clients() { return server_.Clients(); }
+
+ServerStats &Zone::Stats() { return server_.Stats(); }
+
+UdpSpatialChannel *Zone::UdpChannel() { return server_.UdpChannel(); }
+
+/// ============================================================================
+/// COMMAND QUEUE
+/// ============================================================================
+
+void Zone::QueueCommand(const GameCommand &command) {
+    if (commands_.TryPush(command)) return;
+
+    if (!command.IsCritical()) {
+        // Zone thread is over a second behind - shedding input is the least bad option
+        Stats().RecordCommandDrop();
+        return;
+    }
+
+    // Login/Disconnect must arrive or a player leaks. Wait for the zone
+    // thread to drain - unless it has stopped, then nobody will.
+    Log::Warn("Map {} command ring full, waiting to queue session command for client {}",
+              map_id_, command.client_id);
+    while (!commands_.TryPush(command)) {
+        if (!running_) return;
+        std::this_thread::yield();
+    }
+}
+
+bool Zone::QueueTileEdit(const TileEdit &edit) {
+    if (tile_edits_.TryPush(edit)) return true;
+    Stats().RecordTileEditDrop();
+    return false;
+}
+
+void Zone::QueueAction(std::function<void()> action) {
+    std::lock_guard<std::mutex> lock(action_mutex_);
+    action_queue_.push(std::move(action));
+}
+
+void Zone::PostTransfer(ZoneTransfer transfer) {
+    std::lock_guard<std::mutex> lock(inbox_mutex_);
+    inbox_.push_back(std::move(transfer));
+}
+
+void Zone::PostDisconnect(uint64_t client_id) {
+    std::lock_guard<std::mutex> lock(inbox_mutex_);
+    disconnect_inbox_.push_back(client_id);
+}
+
+void Zone::ProcessActionQueue() {
+    // Commands first. Stop after one ring's worth so producers that keep
+    // pushing can't hold the tick here forever.
+    GameCommand command{};
+    for (size_t i = 0; i < commands_.Capacity() && commands_.TryPop(command); i++) {
+        ExecuteCommand(command);
+    }
+
+    std::queue<std::function<void()> > to_process;
+    {
+        std::lock_guard<std::mutex> lock(action_mutex_);
+        std::swap(to_process, action_queue_);
+    }
+    while (!to_process.empty()) {
+        to_process.front()();
+        to_process.pop();
+    }
+}
+
+void Zone::ExecuteCommand(const GameCommand &command) {
+    switch (command.type) {
+        case GameCommand::Type::Move:
+        case GameCommand::Type::Turn:
+        case GameCommand::Type::Warp: {
+            if (input_log_) input_block_.Add(command);
+
+            // No player here: not logged in yet, warped away, or still on
+            // the way in. Nothing to apply it to.
+            if (!players_.GetByClientID(command.client_id)) break;
+
+            // Inputs wait in the client's bounded queue, applied in ProcessInputQueues
+            if (input_queues_.Push(command) != InputQueue::PushResult::Overflow) break;
+
+            Stats().RecordInputOverflow();
+            if (input_queues_.Overflowed(command.client_id) == InputQueues::FLOOD_KICK_OVERFLOWS) {
+                Stats().RecordInputFloodKick();
+                if (auto client = Clients().GetClient(command.client_id)) {
+                    client->Disconnect("input flood");
+                }
+            }
+            break;
+        }
+        case GameCommand::Type::Login:
+            if (input_log_) input_block_.Add(command);
+            HandleLogin(command.client_id);
+            break;
+        case GameCommand::Type::Disconnect:
+            // Passed on: the zone with the player records it when it runs
+            if (HandleDisconnect(command.client_id) && input_log_) input_block_.Add(command);
+            break;
+    }
+}
+
+void Zone::ProcessInputQueues() {
+    input_queues_.Drain([this](const GameCommand &input) {
+        switch (input.type) {
+            case GameCommand::Type::Move:
+                Actions::Movement::ApplyMove(this, input.client_id, input.move.direction, input.move.facing);
+                break;
+            case GameCommand::Type::Turn:
+                Actions::Movement::ApplyTurn(this, input.client_id, input.turn.facing);
+                break;
+            case GameCommand::Type::Warp:
+                Actions::Movement::ApplyWarp(this, input.client_id, input.warp.map_id, input.warp.x, input.warp.y);
+                break;
+            default:
+                break;
+        }
+    });
+
+    // Drain is iterating the queues while a warp runs, so players that
+    // left this tick lose their queue only now
+    for (const uint64_t client_id : departed_) {
+        input_queues_.Remove(client_id);
+    }
+    departed_.clear();
+}
+
+/// ============================================================================
+/// GAME LOOP
+/// ============================================================================
+
+namespace {
+    double ElapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count() / 1000.0;
+    }
+}
+
+void Zone::RunTick() {
+    using Clock = std::chrono::steady_clock;
+    phases_ = {};
+    const auto start_time = Clock::now();
+    delta_->Begin(tick_scheduler_.CurrentTick(), start_time);
+    game_time_.tick++;
+
+    // 1. Players arriving from other zones
+    ReceiveTransfers();
+
+    // 1a. Ghosts and handoffs from the neighbouring shards (--shard)
+    if (layout_.IsSharded()) ReceiveShardMessages();
+    const auto transfers_done = Clock::now();
+
+    // 1b. Process queued actions from network thread
+    ProcessActionQueue();
+    if (input_log_ && !input_block_.Empty()) {
+        input_log_->Write(map_id_, game_time_.tick, input_block_);
+        input_block_.Clear();
+    }
+
+    // Tile edits queued by Lua and the console
+    ApplyQueuedTileEdits();
+    const auto commands_done = Clock::now();
+
+    // 1c. Apply at most INPUTS_PER_TICK moves/turns/warps per client
+    ProcessInputQueues();
+    const auto inputs_done = Clock::now();
+
+    // 2. Process game tick (movement, broadcasting, etc.) - times its own phases
+    ProcessTick();
+    const auto simulate_done = Clock::now();
+
+    // 2b. Ship the tick's visibility updates and transfers - encoded
+    //     here, or by the encoder thread while the next tick runs (--pipeline)
+    PublishDelta();
+    const auto end_time = Clock::now();
+
+    phases_.transfers = ElapsedMs(start_time, transfers_done);
+    phases_.commands = ElapsedMs(transfers_done, commands_done);
+    phases_.inputs = ElapsedMs(commands_done, inputs_done);
+    phases_.publish = ElapsedMs(simulate_done, end_time);
+    phases_.total = ElapsedMs(start_time, end_time);
+
+    // 3. Nobody here for a while - give the map file's pages back
+    ReleaseIdleMap();
+}
+
+void Zone::GameLogicThread() {
+    const uint64_t ticks_per_second = tick_scheduler_.Tps();
+    const auto tick_budget = std::chrono::duration_cast<std::chrono::microseconds>(tick_scheduler_.Interval());
+    const double slow_tick_ms = tick_budget.count() * 0.8 / 1000.0;  // 40ms at 20 TPS
+    const uint64_t log_window_ticks = ticks_per_second * 5;
+    auto &stats = Stats();
+
+    // Pin the primary zone thread to CPU core 0 to reduce cache thrashing with IO thread
+#ifdef _WIN32
+    if (IsPrimary()) {
+        SetThreadAffinityMask(GetCurrentThread(), 1); // Core 0
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+        Log::Info("Primary zone thread pinned to core 0 with elevated priority");
+    }
+#endif
+
+    Log::Info("Map {} game loop started ({} ticks/sec, {} job threads, pipeline {})",
+              map_id_, ticks_per_second, jobs_.WorkerCount(), pipelined_ ? "on" : "off");
+    if (IsPrimary()) {
+        stats.SetTargetTps(tick_scheduler_.Tps());
+        stats.SetPipelined(pipelined_);
+    }
+
+    // Measuring Tick Lag
+    double total_ms = 0;
+    uint64_t tick_count = 0;
+
+    tick_scheduler_.Start();
+    auto throughput_window_start = std::chrono::steady_clock::now();
+    while (running_) {
+        // 0. Wait for this tick's deadline (absolute, so sleep overshoot doesn't drift)
+        const auto jitter = tick_scheduler_.WaitForNextTick();
+        if (!running_) break;
+
+        // 1-2. Simulate and publish the tick
+        RunTick();
+
+        // 3. Pings are scheduled per connection by the IO threads' timer wheels
+
+        const double ms = phases_.total;
+        stats.RecordZoneTick(map_id_, ms, players_.Count(), tick_scheduler_.MissedDeadlines());
+
+        if (IsPrimary()) {
+            // 4. Update bandwidth monitor
+            BandwidthMonitor::Instance().Tick();
+
+            // 4b. Snapshot per-connection send queue depth for the dashboard
+            if (++send_queue_sample_counter_ >= ticks_per_second) {
+                send_queue_sample_counter_ = 0;
+                SampleSendQueues();
+
+                // Exactly ticks_per_second ticks finished since the last sample
+                const auto now = std::chrono::steady_clock::now();
+                const std::chrono::duration<double> window = now - throughput_window_start;
+                stats.SetTickThroughput(ticks_per_second / window.count());
+                throughput_window_start = now;
+            }
+
+            // 5. Update stats for debug dashboard
+            stats.RecordTick(ms);
+            stats.RecordTickStart(static_cast<uint64_t>(jitter.count()),
+                                  tick_scheduler_.MissedDeadlines(), tick_scheduler_.SkippedTicks());
+            stats.SetConnectionCounts(Clients().RealCount(), Clients().FakeCount(), zones_.PlayerCount());
+            stats.SetVisibilityCount(world_.Visibility().TrackedPlayerCount());
+            stats.SetBandwidth(
+                BandwidthMonitor::Instance().GetBytesPerSecond(),
+                BandwidthMonitor::Instance().GetAvgBytesPerSecond(),
+                BandwidthMonitor::Instance().GetTotalBytesOut(),
+                BandwidthMonitor::Instance().GetPacketsPerSecond()
+            );
+        }
+
+        total_ms += ms;
+        tick_count++;
+
+        if (tick_count >= log_window_ticks) {
+            // every 5 sec
+            Log::Trace("Map {} avg tick: {:.3f}ms", map_id_, total_ms / tick_count);
+            total_ms = 0;
+            tick_count = 0;
+            if (IsPrimary()) stats.ResetMaxValues();  // Reset max tick time
+        }
+
+        if (ms > slow_tick_ms) {
+            Log::Warn("Slow tick on map {}: {:.3f}ms / {}", map_id_, ms, tick_budget);
+        }
+    }
+    Log::Info("Map {} game loop ended. Missed deadlines: {}, skipped ticks: {}",
+              map_id_, tick_scheduler_.MissedDeadlines(), tick_scheduler_.SkippedTicks());
+}
+
+/// ============================================================================
+/// PROCESS TICK - View-Based Broadcasting
+/// ============================================================================
+
+void Zone::ProcessTick() {
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Process bot movement (1 bot moves per tick)
+    Actions::BotStressTest::ProcessBotMovement(this, bot_manager_);
+
+    auto t1 = std::chrono::steady_clock::now();
+    phases_.bots = ElapsedMs(t0, t1);
+
+    // Get players that changed this tick (swaps buffers with the registry)
+    players_.ConsumeDirtyPlayers(tick_dirty_);
+    auto &dirty_players = tick_dirty_;
+    const size_t owned_dirty = dirty_players.size();
+
+    if (layout_.IsSharded()) {
+        // Hand off players that crossed a border, update the neighbours' ghosts
+        SyncShardBorders(dirty_players);
+
+        // Ghosts moved by their owners are broadcast like our own players
+        dirty_players.insert(dirty_players.end(), updated_ghosts_.begin(), updated_ghosts_.end());
+        updated_ghosts_.clear();
+    }
+
+    // This tick's tile edits to whoever can see them
+    BroadcastTileChanges();
+
+    // Map chunks our own players moved towards, and edited chunks for
+    // everyone (ghosts' clients are on another shard)
+    for (size_t i = 0; i < owned_dirty; i++) {
+        const Player &player = *dirty_players[i];
+        map_streamer_.Update(*delta_, player.GetClientID(), player.GetX(), player.GetY(), player.GetFacing());
+    }
+    map_streamer_.SendChanged(*delta_);
+    if (const auto stream = map_streamer_.TakeStats(); stream.chunks_sent > 0 || stream.held_skips > 0) {
+        Stats().RecordMapChunks(stream.chunks_sent, stream.bytes_sent, stream.raw_bytes, stream.held_skips,
+                                stream.held_bytes_saved, stream.cache_hits, stream.cache_misses);
+    }
+
+    if (dirty_players.empty()) {
+        // Still log bot movement time if significant
+        const double bot_ms = phases_.bots;
+        if (bot_ms > 10.0) {
+            Log::Trace("Bot movement: {:.2f}ms, visibility tracked: {}", bot_ms, world_.Visibility().TrackedPlayerCount());
+        }
+        return;
+    }
+
+    broadcast_counters_.Start();
+    BroadcastDirtyPlayers(dirty_players);
+    if (const auto sample = broadcast_counters_.Stop(); sample.valid) {
+        Stats().RecordBroadcastCounters(sample.cache_misses, sample.cache_references, sample.instructions);
+    }
+
+    auto t2 = std::chrono::steady_clock::now();
+    auto bot_ms = phases_.bots;
+    auto broadcast_ms = ElapsedMs(t1, t2);
+    phases_.broadcast = broadcast_ms;
+
+    // Record stats for debug dashboard
+    Stats().RecordBroadcast(broadcast_ms);
+    Stats().SetDirtyPlayerCount(dirty_players.size());
+
+    if (bot_ms + broadcast_ms > 20.0) {
+        Log::Trace("Tick breakdown - Bot: {:.2f}ms, Broadcast: {:.2f}ms, Dirty: {}, Visibility: {}",
+                   bot_ms, broadcast_ms, dirty_players.size(), world_.Visibility().TrackedPlayerCount());
+    }
+
+    // Call Lua hooks - for our own players only, ghosts run their hooks
+    // on the shard that owns them
+    dirty_players.resize(owned_dirty);
+    server_.OnPlayersMoved(map_id_, dirty_players);
+    phases_.hooks = ElapsedMs(t2, std::chrono::steady_clock::now());
+}
+
+/// ============================================================================
+/// VIEW-BASED BROADCASTING
+///
+/// For each dirty player, find viewers who can see them using spatial hash.
+/// Record one batch per viewer containing all visible updates into the
+/// tick's delta; EncodeDelta turns it into packets.
+/// ============================================================================
+
+void Zone::BroadcastDirtyPlayers(const std::vector<std::shared_ptr<Player> > &dirty_players) {
+    auto t0 = std::chrono::steady_clock::now();
+    size_t total_nearby = 0;
+    UdpSpatialChannel *udp_channel = UdpChannel();
+
+    // Everything below reads the registry's hot columns by handle - the
+    // Player objects are only touched here, once per dirty player
+    const PlayerTable &table = players_.Table();
+    dirty_handles_.clear();
+    for (const auto &dirty_player : dirty_players) dirty_handles_.push_back(dirty_player->GetHandle());
+
+    // 1. Viewer queries, fanned out: one read-only spatial query per dirty
+    //    player, each writing only its own dirty_viewers_ slot
+    dirty_viewers_.resize(dirty_handles_.size());
+    jobs_.ParallelFor(dirty_handles_.size(), VIEWER_QUERY_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const PlayerHandle dirty_handle = dirty_handles_[i];
+            auto &found = dirty_viewers_[i];
+            found.viewers.clear();
+            found.in_range = 0;
+
+            // Zero-copy iteration - no vector allocation or shared_ptr copies
+            world_.ForEachHandleInRange(table.X(dirty_handle), table.Y(dirty_handle), [&](PlayerHandle viewer) {
+                found.in_range++;
+                // Skip self - client already predicted their own move.
+                // Skip ghosts - their clients are on another shard.
+                if (viewer != dirty_handle && !table.IsGhost(viewer)) found.viewers.push_back(viewer);
+            });
+        }
+    });
+
+    auto ts = std::chrono::steady_clock::now();
+
+    // Map: client_id -> list of dirty players they can see
+    // With the UDP channel on, players the viewer already knew about go in
+    // `known` and may travel unreliably. First sightings always go in
+    // `updates` (TCP), because that record creates the player on the client.
+    struct ViewerData {
+        std::vector<PlayerHandle> updates;
+        std::vector<PlayerHandle> known;
+    };
+    std::unordered_map<uint64_t, ViewerData> viewer_updates;
+
+    // 2. Group by viewer and keep visibility tracking in sync with what we're
+    //    sending. Serial: AddKnown writes the VisibilityTracker.
+    for (size_t i = 0; i < dirty_handles_.size(); i++) {
+        const PlayerHandle dirty_handle = dirty_handles_[i];
+        total_nearby += dirty_viewers_[i].in_range;
+
+        for (PlayerHandle viewer : dirty_viewers_[i].viewers) {
+            auto &data = viewer_updates[table.ClientID(viewer)];
+            const bool first_sighting = world_.Visibility().AddKnown(viewer, dirty_handle);
+
+            if (udp_channel && !first_sighting) {
+                data.known.push_back(dirty_handle);
+            } else {
+                data.updates.push_back(dirty_handle);
+            }
+        }
+    }
+
+    // 3. Record one spatial event per viewer. Positions are copied now, so
+    //    the encoder never reads a player the next tick is moving.
+    for (const auto &[client_id, data] : viewer_updates) {
+        delta_->AddSpatial(client_id, table, data.updates, data.known);
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    // Record sub-breakdown for viewer query phase
+    const auto spatial_us = std::chrono::duration_cast<std::chrono::microseconds>(ts - t0).count();
+    const auto visibility_us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - ts).count();
+    Stats().RecordViewerQueryBreakdown(map_id_, spatial_us / 1000.0, visibility_us / 1000.0, total_nearby);
+
+    delta_->query_ms += std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
+    delta_->dirty_count += dirty_players.size();
+}
+
+/// ============================================================================
+/// TICK DELTA - publish and encode
+/// ============================================================================
+
+namespace {
+    /// S_Player_Spatial packets for `records`, split every 255 records
+    /// (the count field is one byte)
+    template<typename Emit>
+    void EncodeSpatialBatches(std::span<const TickDelta::Record> records, Emit &&emit) {
+        constexpr size_t MAX_RECORDS_PER_PACKET = 255;
+        for (size_t start = 0; start < records.size(); start += MAX_RECORDS_PER_PACKET) {
+            const auto chunk = records.subspan(start, std::min(MAX_RECORDS_PER_PACKET, records.size() - start));
+
+            Protocol::Packet batch;
+            // Pre-reserve: opcode (1) + count (1) + players * 13 bytes each (ID:8 + X:2 + Y:2 + facing:1)
+            batch.payload.reserve(2 + chunk.size() * 13);
+            Protocol::PacketWriter::WriteByte(batch.payload,
+                                              Protocol::Opcode::Batch::Server::S_Player_Spatial.op);
+            Protocol::PacketWriter::WriteByte(batch.payload, static_cast<uint8_t>(chunk.size()));
+            for (const auto &record : chunk) {
+                Protocol::PacketWriter::WriteUInt64(batch.payload, record.player_id);
+                Protocol::PacketWriter::WriteShort(batch.payload, static_cast<uint16_t>(record.x));
+                Protocol::PacketWriter::WriteShort(batch.payload, static_cast<uint16_t>(record.y));
+                Protocol::PacketWriter::WriteByte(batch.payload, record.facing);
+            }
+            batch.size = static_cast<uint16_t>(batch.payload.size());
+
+            emit(std::make_shared<std::vector<uint8_t>>(batch.ToBytes()));
+        }
+    }
+
+    std::shared_ptr<std::vector<uint8_t>> EncodeLeftGame(uint64_t player_id) {
+        Protocol::Packet pkt;
+        Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::RemotePlayer::Server::S_Left_Game.op);
+        Protocol::PacketWriter::WriteUInt64(pkt.payload, player_id);
+        pkt.size = static_cast<uint16_t>(pkt.payload.size());
+        return std::make_shared<std::vector<uint8_t>>(pkt.ToBytes());
+    }
+}
+
+void Zone::PublishDelta() {
+    if (!pipelined_) {
+        EncodeDelta(*delta_);
+        return;  // Begin() clears it for the next tick
+    }
+
+    if (pipeline_.Publish(std::move(delta_))) {
+        Stats().RecordEncoderStall();
+    }
+    delta_ = pipeline_.Acquire();
+}
+
+void Zone::EncoderThread() {
+    Log::Info("Map {} encoder thread started", map_id_);
+    while (auto delta = pipeline_.Take()) {
+        EncodeDelta(*delta);
+        pipeline_.Recycle(std::move(delta));
+    }
+    Log::Info("Map {} encoder thread stopped", map_id_);
+}
+
+void Zone::EncodeDelta(const TickDelta &delta) {
+    if (delta.Empty()) return;
+    auto t0 = std::chrono::steady_clock::now();
+    UdpSpatialChannel *udp_channel = UdpChannel();
+
+    // Group events by client (keeping each client's order) and collect the
+    // distinct clients as runs over encode_order_
+    delta.GroupByClient(encode_order_);
+    encode_runs_.clear();
+    for (uint32_t i = 0; i < encode_order_.size(); i++) {
+        const uint64_t client_id = delta.events[encode_order_[i]].client_id;
+        if (encode_runs_.empty() || encode_runs_.back().first != client_id) {
+            encode_runs_.push_back({client_id, ClientRun{i, i}});
+        }
+        encode_runs_.back().second.end = i + 1;
+    }
+
+    // OPTIMIZATION: Batch all client lookups in one lock acquisition
+    // Get both real and fake connections
+    auto connections = Clients().GetAnyClientsForIDs(encode_runs_);
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    // 1. Split off UDP records (serial, in event order). Records past an
+    //    event's reliable prefix go unreliably when the client has bound the
+    //    channel; otherwise all of them stay on TCP.
+    encode_tcp_records_.resize(delta.events.size());
+    std::vector<UdpSpatialChannel::SpatialRecord> udp_records;
+    for (uint32_t i = 0; i < delta.events.size(); i++) {
+        const auto &event = delta.events[i];
+        encode_tcp_records_[i] = event.count;
+        if (!udp_channel || event.kind != TickDelta::Kind::Spatial || event.reliable == event.count) continue;
+
+        udp_records.clear();
+        for (const auto &record : delta.RecordsOf(event).subspan(event.reliable)) {
+            udp_records.push_back({record.player_id, record.x, record.y, record.facing});
+        }
+        if (udp_channel->QueueSpatial(event.client_id, udp_records)) {
+            encode_tcp_records_[i] = event.reliable;
+        }
+    }
+
+    // One post to the IO thread for the whole tick's datagrams (sendmmsg)
+    if (udp_channel) udp_channel->Flush();
+
+    // 2. Encode and queue, fanned out by client: one client's events stay on
+    //    one job, in order. QueueRaw is safe from any thread (per-connection
+    //    send mutex).
+    jobs_.ParallelFor(encode_runs_.size(), ENCODE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; r++) {
+            const auto &[client_id, run] = encode_runs_[r];
+            auto conn_it = connections.find(client_id);
+            if (conn_it == connections.end()) continue;  // Disconnected since the tick
+
+            auto send = [&conn_it](std::shared_ptr<std::vector<uint8_t>> bytes) {
+                std::visit([&bytes](auto &&conn) {
+                    if (conn) conn->QueueRaw(bytes);
+                }, conn_it->second);
+            };
+
+            for (uint32_t k = run.begin; k < run.end; k++) {
+                const uint32_t index = encode_order_[k];
+                const auto &event = delta.events[index];
+                if (event.kind == TickDelta::Kind::Left) {
+                    send(EncodeLeftGame(event.player_id));
+                } else if (event.kind == TickDelta::Kind::Raw) {
+                    send(delta.raw[event.first]);
+                } else if (encode_tcp_records_[index] > 0) {
+                    EncodeSpatialBatches(delta.RecordsOf(event).first(encode_tcp_records_[index]), send);
+                }
+            }
+        }
+    });
+
+    // 3. Only now may the warped players show up in their new zone: every
+    //    packet this zone had for them is queued ahead of the target's
+    for (const auto &transfer : delta.transfers) {
+        zones_.Deliver(transfer);
+    }
+
+    auto t2 = std::chrono::steady_clock::now();
+
+    // Record breakdown for debug dashboard
+    auto lookup_ms = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
+    auto send_ms = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.0;
+    Stats().RecordBroadcastBreakdown(map_id_, delta.query_ms, lookup_ms, send_ms,
+                                     encode_runs_.size(), delta.dirty_count);
+
+    // End-to-end: from the start of the tick that produced these updates
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(t2 - delta.tick_start);
+    Stats().RecordUpdateLatency(latency.count() / 1000.0);
+}
+
+/// ============================================================================
+/// SESSIONS AND ZONE TRANSFERS
+/// ============================================================================
+
+void Zone::HandleLogin(uint64_t client_id) {
+    // Already closed and removed (e.g. shutdown) - nothing to log in.
+    // DyeWarsReplay logs its clients in on fake connections: they play
+    // like anyone else but get no direct packets (Welcome, surroundings).
+    auto client = Clients().GetClient(client_id);
+    if (!client && !Clients().GetAnyClient(client_id)) return;
+    EnsureMapLoaded();
+
+    // Redirected here by another shard (C_Shard_Resume)
+    if (client) {
+        if (const uint64_t token = client->ResumeToken()) {
+            ResumeHandoff(client, token);
+            return;
+        }
+    }
+
+    // Create player in registry, at the left edge of our strip (x 0 unsharded)
+    auto player = players_.CreatePlayer(client_id, static_cast<uint16_t>(layout_.Begin(layout_.index)), 0);
+    if (!player) {
+        // CreatePlayer returns nullptr if client already has a player.
+        // This indicates a bug - client logged in twice somehow.
+        // Disconnect to prevent further issues.
+        Log::Error("Failed to create player for client {} - duplicate login?", client_id);
+        if (client) client->Disconnect("duplicate login");
+        return;
+    }
+    zones_.SetRoute(client_id, map_id_);
+
+    Log::Info("Client {} logged in as player {} on map {}", client_id, player->GetID(), map_id_);
+
+    if (client) {
+        // Send welcome packet to this client
+        Packets::PacketSender::Welcome(client, player);
+
+        // Offer the UDP spatial channel. Clients that ignore the token just
+        // keep receiving everything over TCP.
+        if (auto *udp_channel = UdpChannel()) {
+            Packets::PacketSender::UdpToken(client, udp_channel->IssueToken(client_id), udp_channel->Port());
+        }
+    }
+
+    EnterWorld(client, player);
+}
+
+void Zone::ReceiveTransfers() {
+    {
+        std::lock_guard<std::mutex> lock(inbox_mutex_);
+        if (inbox_.empty() && disconnect_inbox_.empty()) return;
+        std::swap(arrivals_, inbox_);
+        std::swap(forwarded_disconnects_, disconnect_inbox_);
+    }
+    if (!arrivals_.empty()) EnsureMapLoaded();
+
+    for (const auto &transfer : arrivals_) {
+        const uint64_t client_id = transfer.client_id;
+
+        // Disconnected on the way - its Disconnect already came and waited
+        if (pending_disconnects_.erase(client_id)) {
+            Log::Info("Player {} disconnected while warping to map {}", transfer.player_id, map_id_);
+            ReleaseClient(client_id);
+            continue;
+        }
+
+        auto player = players_.AdoptPlayer(client_id, transfer.player_id, transfer.x, transfer.y, transfer.facing);
+        if (!player) {
+            // Route it here as settled so the Disconnect cleans up normally
+            zones_.SetRoute(client_id, map_id_);
+            if (auto client = Clients().GetClient(client_id)) client->Disconnect("zone transfer failed");
+            continue;
+        }
+        player->SetName(transfer.name);
+
+        // Nearest free tile to the requested spot (clamped onto this map)
+        const auto &map = world_.GetMap();
+        int16_t x = std::clamp<int16_t>(transfer.x, 0, static_cast<int16_t>(map.GetWidth() - 1));
+        int16_t y = std::clamp<int16_t>(transfer.y, 0, static_cast<int16_t>(map.GetHeight() - 1));
+        world_.FindOpenTile(x, y, player->GetHandle());
+        player->SetPosition(x, y);
+
+        zones_.SetRoute(client_id, map_id_);
+        Stats().RecordZoneTransfer();
+        Log::Info("Player {} arrived on map {} from map {} at ({}, {})",
+                  player->GetID(), map_id_, transfer.from_map, x, y);
+
+        auto client = Clients().GetClient(client_id);
+        if (client) Packets::PacketSender::Warped(client, map_id_, x, y);
+        EnterWorld(client, player);
+    }
+    arrivals_.clear();
+
+    // After the arrivals: a player that came in this batch is here now,
+    // one still on its way parks in pending_disconnects_
+    for (const uint64_t client_id : forwarded_disconnects_) {
+        if (HandleDisconnect(client_id) && input_log_) input_block_.Add(GameCommand::Disconnect(client_id));
+    }
+    forwarded_disconnects_.clear();
+}
+
+void Zone::EnterWorld(const std::shared_ptr<ClientConnection> &client, const std::shared_ptr<Player> &player) {
+    // Add to world's spatial hash
+    world_.AddPlayer(
+            player->GetHandle(),
+            player->GetX(),
+            player->GetY(),
+            player);
+
+    const auto nearby_players = SendSurroundings(client, player);
+
+    // Broadcast new player to all nearby viewers (single player per viewer)
+    for (const auto &viewer : nearby_players) {
+        if (viewer->GetHandle() == player->GetHandle()) continue;
+
+        auto viewer_conn = Clients().GetClient(viewer->GetClientID());
+        if (!viewer_conn) continue;
+
+        Packets::PacketSender::PlayerSpatial(
+                viewer_conn,
+                player->GetID(),
+                player->GetX(),
+                player->GetY(),
+                player->GetFacing()
+        );
+
+        // Add new player to viewer's known set
+        // We just told them about this player, so they now "know" about them
+        world_.Visibility().AddKnown(viewer->GetHandle(), player->GetHandle());
+    }
+}
+
+std::vector<std::shared_ptr<Player>> Zone::SendSurroundings(const std::shared_ptr<ClientConnection> &client,
+                                                            const std::shared_ptr<Player> &player) {
+    // Get nearby players for this client (includes self)
+    auto nearby_players = world_.GetPlayersInRange(
+            player->GetX(),
+            player->GetY()
+    );
+
+    // Send all nearby players (including self) to new client
+    // This syncs client with server's authoritative position
+    if (client) Packets::PacketSender::BatchPlayerSpatial(client, nearby_players);
+
+    // The map around them, chunk by chunk (through the delta, after this
+    // zone's earlier packets to them)
+    if (client) {
+        map_streamer_.Enter(*delta_, player->GetClientID(), player->GetX(), player->GetY(), player->GetFacing());
+    }
+
+    // ================================================================
+    // VISIBILITY TRACKING - Initialize for new player
+    // We just sent nearby_players to this client, so their "known" set
+    // should match what we sent (excluding self)
+    // ================================================================
+    std::vector<PlayerHandle> nearby_handles;
+    for (const auto& p : nearby_players) {
+        if (p->GetHandle() != player->GetHandle()) {
+            nearby_handles.push_back(p->GetHandle());
+        }
+    }
+    world_.Visibility().Initialize(player->GetHandle(), nearby_handles);
+    return nearby_players;
+}
+
+void Zone::LeaveWorld(const Player &player) {
+    const PlayerHandle handle = player.GetHandle();
+
+    // Notify everyone who KNOWS about this player (not just nearby)
+    // This fixes ghost players when they moved out of view before leaving
+    if (const auto *known_by = world_.Visibility().GetKnownBy(handle)) {
+        for (PlayerHandle observer_handle : *known_by) {
+            auto observer = players_.Get(observer_handle);
+            if (!observer) continue;
+
+            delta_->AddLeft(observer->GetClientID(), player.GetID());
+        }
+    }
+
+    // Remove from World's spatial hash
+    world_.RemovePlayer(handle);
+    if (!player.IsGhost()) map_streamer_.Leave(player.GetClientID());
+
+    // Remove from visibility tracking
+    // This cleans up their known set AND removes them from everyone else's known sets
+    world_.Visibility().RemovePlayer(handle);
+}
+
+void Zone::TransferOut(const std::shared_ptr<Player> &player, uint16_t to_map, int16_t x, int16_t y) {
+    const uint64_t player_id = player->GetID();
+    const uint64_t client_id = player->GetClientID();
+
+    // The player's client drops everyone it could see here
+    if (const auto *known = world_.Visibility().GetKnownPlayers(player->GetHandle())) {
+        for (PlayerHandle known_handle : *known) {
+            if (auto other = players_.Get(known_handle)) delta_->AddLeft(client_id, other->GetID());
+        }
+    }
+    LeaveWorld(*player);
+    ForgetGhostCopies(player_id);
+
+    delta_->transfers.push_back(ZoneTransfer{
+            client_id, player_id, map_id_, to_map, x, y, player->GetFacing(), player->GetName()});
+    players_.RemoveByClientID(client_id);
+    departed_.push_back(client_id);
+
+    // From here on the client's commands go to the target zone
+    zones_.BeginTransfer(client_id, to_map);
+    Log::Info("Player {} leaving map {} for map {}", player_id, map_id_, to_map);
+}
+
+bool Zone::HandleDisconnect(uint64_t client_id) {
+    input_queues_.Remove(client_id);
+
+    auto player = players_.GetByClientID(client_id);
+    if (!player) {
+        // The player may be in another zone, or on its way here
+        const auto route = zones_.RouteOf(client_id);
+        if (route && route->map_id != map_id_) {
+            // Never QueueCommand here: it waits for ring space, and two
+            // zones forwarding to each other with full rings would deadlock
+            zones_.Get(route->map_id)->PostDisconnect(client_id);
+            return false;
+        }
+        if (route && route->arriving) {
+            pending_disconnects_.insert(client_id);  // Finished in ReceiveTransfers
+            return true;
+        }
+    } else {
+        uint64_t player_id = player->GetID();
+        LeaveWorld(*player);
+        ForgetGhostCopies(player_id);
+
+        // Remove from registry
+        players_.RemoveByClientID(client_id);
+
+        Log::Info("Player {} disconnected", player_id);
+    }
+
+    ReleaseClient(client_id);
+    return true;
+}
+
+void Zone::ReleaseClient(uint64_t client_id) {
+    // Remove from client manager
+    Clients().RemoveClient(client_id);
+    if (auto *udp_channel = UdpChannel()) udp_channel->Remove(client_id);
+    zones_.RemoveRoute(client_id);
+
+    Log::Info("Client {} disconnected", client_id);
+}
+
+void Zone::SampleSendQueues() {
+    // Only real connections - fake clients drain themselves and have no socket
+    ServerStats::QueueHistogram packets{};
+    ServerStats::QueueHistogram kilobytes{};
+    size_t max_packets = 0;
+    size_t max_bytes = 0;
+
+    Clients().BroadcastToAll([&](const std::shared_ptr<ClientConnection> &client) {
+        const size_t queued_packets = client->GetQueuedPackets();
+        const size_t queued_bytes = client->GetQueuedBytes();
+        packets[ServerStats::QueueHistogramBucket(queued_packets)]++;
+        kilobytes[ServerStats::QueueHistogramBucket(queued_bytes / 1024)]++;
+        max_packets = std::max(max_packets, queued_packets);
+        max_bytes = std::max(max_bytes, queued_bytes);
+    });
+
+    Stats().SetSendQueueHistograms(packets, kilobytes, max_packets, max_bytes);
+}
+
+/// ============================================================================
+/// TILE EDITS - one S_Tile_Update per viewer per tick (see TileChangeJournal)
+/// ============================================================================
+
+void Zone::ApplyQueuedTileEdits() {
+    TileEdit edit{};
+    if (!tile_edits_.TryPop(edit)) return;
+
+    // An edited map stays loaded: the edit only lives in memory
+    EnsureMapLoaded();
+    size_t applied = 0;
+    do {
+        tile_journal_.Apply(edit);  // Off-map edits are ignored
+    } while (++applied < tile_edits_.Capacity() && tile_edits_.TryPop(edit));
+}
+
+void Zone::BroadcastTileChanges() {
+    if (tile_journal_.EditCount() == 0) return;
+
+    tile_journal_.Seal();
+    const auto &changes = tile_journal_.Changes();
+    const auto &chunks = tile_journal_.TouchedChunks();
+    const PlayerTable &table = players_.Table();
+
+    // 1. Who sees each change: our own players in view range that stream
+    //    the map (not ghosts, not bots)
+    tile_viewers_.clear();
+    for (uint32_t i = 0; i < changes.size(); i++) {
+        world_.ForEachHandleInRange(changes[i].x, changes[i].y, [&](PlayerHandle viewer) {
+            if (table.IsGhost(viewer)) return;
+            const uint64_t client_id = table.ClientID(viewer);
+            if (map_streamer_.HasClient(client_id)) tile_viewers_.emplace_back(client_id, i);
+        });
+    }
+    std::sort(tile_viewers_.begin(), tile_viewers_.end());
+
+    // 2. One packet per viewer (more only past the payload limit). Chunks
+    //    the viewer got every change of are patched on its side, so the
+    //    streamer won't re-send them; the rest still are.
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    tile_chunk_counts_.assign(chunks.size(), 0);
+    for (size_t begin = 0; begin < tile_viewers_.size();) {
+        const uint64_t client_id = tile_viewers_[begin].first;
+        tile_update_.clear();
+        for (; begin < tile_viewers_.size() && tile_viewers_[begin].first == client_id; begin++) {
+            const auto &change = changes[tile_viewers_[begin].second];
+            tile_update_.push_back(change);
+            tile_chunk_counts_[change.chunk]++;
+        }
+
+        const std::span<const TileChangeJournal::Change> all(tile_update_);
+        for (size_t offset = 0; offset < all.size(); offset += TileChunkCodec::MAX_TILES_PER_UPDATE) {
+            const size_t count = std::min(TileChunkCodec::MAX_TILES_PER_UPDATE, all.size() - offset);
+            auto packet = std::make_shared<std::vector<uint8_t>>(
+                    TileChunkCodec::EncodeTileUpdate(map_id_, all.subspan(offset, count)));
+            packets++;
+            bytes += packet->size();
+            delta_->AddRaw(client_id, std::move(packet));
+        }
+
+        for (const auto &change : tile_update_) {
+            uint32_t &got = tile_chunk_counts_[change.chunk];
+            if (got == 0) continue;  // Chunk already settled for this viewer
+            const auto &chunk = chunks[change.chunk];
+            if (got == chunk.changes) map_streamer_.Patched(client_id, chunk.index, chunk.version_before);
+            got = 0;
+        }
+    }
+
+    // 3. Chunks whose edits cancelled out: every copy at the old version
+    //    is still right
+    for (const auto &chunk : chunks) {
+        if (chunk.changes == 0) map_streamer_.PatchedAll(chunk.index, chunk.version_before);
+    }
+
+    Stats().RecordTileUpdates(tile_journal_.EditCount(), changes.size(), packets, bytes);
+    tile_journal_.Clear();
+}
+
+/// ============================================================================
+/// MAP FILES - mapped on arrival, released when idle (--map-dir, see MapFile)
+/// ============================================================================
+
+std::unique_ptr<TileMap> Zone::CreateMap(uint16_t map_id, const ServerConfig &config) {
+    if (!config.map_dir.empty()) {
+        const auto path = std::filesystem::path(config.map_dir) / ("map" + std::to_string(map_id) + ".dwm");
+        if (std::filesystem::exists(path)) {
+            try {
+                auto map = TileMap::FromFile(path.string());
+                Log::Info("Map {} is {} ({}x{}), loaded on demand", map_id, path.string(),
+                          map->GetWidth(), map->GetHeight());
+                return map;
+            } catch (const std::exception &e) {
+                Log::Error("Map {}: {} - generating it instead", map_id, e.what());
+            }
+        }
+    }
+    return std::make_unique<TileMap>(256, 256);
+}
+
+void Zone::EnsureMapLoaded() {
+    map_idle_since_ = 0;
+    TileMap &map = world_.GetMap();
+    if (map.IsResident()) return;
+
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        map.Load();
+    } catch (const std::exception &e) {
+        // Players are on their way - better an empty map than none
+        Log::Error("Map {}: {} - running it empty", map_id_, e.what());
+        map.LoadFromBytes(std::vector<uint8_t>(static_cast<size_t>(map.GetWidth()) * map.GetHeight(),
+                                               TileTypes::Grass));
+    }
+    const double load_ms = ElapsedMs(start, std::chrono::steady_clock::now());
+    Stats().RecordMapLoad(load_ms);
+    Log::Info("Map {} loaded from {} in {:.2f}ms", map_id_, map.GetSourcePath(), load_ms);
+    if (map.StaleBlocking()) {
+        Log::Warn("Map {}: {} was built with another blocking table - rebuilt from tiles, "
+                  "run DyeWarsMapConvert on it again", map_id_, map.GetSourcePath());
+    }
+}
+
+void Zone::ReleaseIdleMap() {
+    TileMap &map = world_.GetMap();
+    if (!map.IsMapped() || map.IsModified()) return;  // Generated, edited or already released
+
+    if (players_.Count() > 0 || !ghosts_.empty() || !pending_handoffs_.empty()) {
+        map_idle_since_ = 0;
+        return;
+    }
+    if (map_idle_since_ == 0) map_idle_since_ = game_time_.tick;
+    if (game_time_.tick - map_idle_since_ < map_idle_ticks_) return;
+
+    map.Release();
+    map_streamer_.DropCache();
+    map_idle_since_ = 0;
+    Stats().RecordMapRelease();
+    Log::Info("Map {} released after {} idle ticks", map_id_, map_idle_ticks_);
+}
+
+/// ============================================================================
+/// SHARDING - border ghosts and ownership handoff (see ShardLayout, ShardLink)
+/// ============================================================================
+
+namespace {
+    uint8_t ShardBit(uint8_t shard) { return static_cast<uint8_t>(1u << shard); }
+
+    ShardLink::Message GhostRemoveMessage(uint64_t player_id) {
+        ShardLink::Message message;
+        message.type = ShardLink::Type::GhostRemove;
+        message.removed.push_back(player_id);
+        return message;
+    }
+}
+
+void Zone::ReceiveShardMessages() {
+    shard_link_->Drain(shard_inbox_);
+    for (const auto &message : shard_inbox_) {
+        switch (message.type) {
+            case ShardLink::Type::GhostUpdate:
+                for (const auto &record : message.ghosts) {
+                    UpsertGhost(record, message.from);
+                }
+                break;
+
+            case ShardLink::Type::GhostRemove:
+                for (const uint64_t player_id : message.removed) {
+                    // Only the current owner may remove: a late remove from a
+                    // previous owner must not delete a ghost that moved on
+                    auto it = ghosts_.find(player_id);
+                    if (it != ghosts_.end() && it->second.owner == message.from) RemoveGhost(player_id);
+                }
+                break;
+
+            case ShardLink::Type::Handoff: {
+                // The player is ours once its client resumes with the token.
+                // Until then it waits here as a ghost at the handoff position.
+                const auto &handoff = message.handoff;
+                auto ghost = UpsertGhost({handoff.player_id, handoff.x, handoff.y, handoff.facing}, message.from);
+                if (!ghost) break;
+                ghost->SetName(handoff.name);
+                pending_handoffs_[handoff.token] = PendingHandoff{
+                        handoff.player_id, message.from,
+                        tick_scheduler_.CurrentTick() + HANDOFF_TIMEOUT_SECONDS * tick_scheduler_.Tps()};
+                Log::Info("Player {} handed off from shard {} at ({}, {}), waiting for its client",
+                          handoff.player_id, message.from, handoff.x, handoff.y);
+                break;
+            }
+        }
+    }
+
+    // Clients that never reconnected: the player is gone. Drop our ghost,
+    // and the source's (it is owned by us now).
+    const uint64_t now = tick_scheduler_.CurrentTick();
+    for (auto it = pending_handoffs_.begin(); it != pending_handoffs_.end();) {
+        if (it->second.deadline_tick > now) {
+            ++it;
+            continue;
+        }
+        const PendingHandoff handoff = it->second;
+        it = pending_handoffs_.erase(it);
+
+        RemoveGhost(handoff.player_id);
+        shard_link_->Send(handoff.from, GhostRemoveMessage(handoff.player_id));
+        Stats().RecordHandoffExpired();
+        Log::Warn("Handoff of player {} from shard {} expired, client never resumed", handoff.player_id, handoff.from);
+    }
+
+    Stats().SetGhostCount(ghosts_.size());
+}
+
+std::shared_ptr<Player> Zone::UpsertGhost(const ShardLink::GhostRecord &record, uint8_t owner) {
+    // We simulate this player ourselves - a stale update from its old owner
+    if (auto existing = players_.GetByID(record.player_id); existing && !existing->IsGhost()) return nullptr;
+
+    bool changed = true;
+    auto it = ghosts_.find(record.player_id);
+    if (it == ghosts_.end()) {
+        EnsureMapLoaded();
+        auto ghost = std::make_shared<Player>(record.player_id, record.x, record.y, record.facing);
+        ghost->SetGhost(true);
+        if (players_.AddGhost(ghost) == SlotHandle::NONE) return nullptr;
+        world_.AddPlayer(ghost->GetHandle(), record.x, record.y, ghost);
+        it = ghosts_.emplace(record.player_id, Ghost{std::move(ghost), owner}).first;
+    } else {
+        it->second.owner = owner;
+        const auto &ghost = it->second.player;
+        const bool moved = ghost->GetX() != record.x || ghost->GetY() != record.y;
+        changed = moved || ghost->GetFacing() != record.facing;
+        ghost->SetFacing(record.facing);
+        if (moved) {
+            ghost->SetPosition(record.x, record.y);
+            world_.UpdatePlayerPosition(ghost->GetHandle(), record.x, record.y);
+            Actions::Movement::UpdateVisibilityAfterMove(this, ghost, false);
+        }
+    }
+
+    // Broadcast at most once per tick, however many updates arrived
+    auto &entry = it->second;
+    const uint64_t tick = tick_scheduler_.CurrentTick();
+    if (changed && entry.queued_tick != tick) {
+        entry.queued_tick = tick;
+        updated_ghosts_.push_back(entry.player);
+    }
+    return entry.player;
+}
+
+void Zone::RemoveGhost(uint64_t player_id) {
+    auto it = ghosts_.find(player_id);
+    if (it == ghosts_.end()) return;
+    const auto ghost = std::move(it->second.player);
+    ghosts_.erase(it);
+    std::erase(updated_ghosts_, ghost);
+    LeaveWorld(*ghost);
+    players_.RemovePlayer(ghost->GetHandle());
+}
+
+void Zone::SyncShardBorders(const std::vector<std::shared_ptr<Player>> &dirty_players) {
+    ghost_updates_out_.resize(layout_.count);
+    ghost_removes_out_.resize(layout_.count);
+    for (uint8_t shard = 0; shard < layout_.count; shard++) {
+        ghost_updates_out_[shard].type = ShardLink::Type::GhostUpdate;
+        ghost_updates_out_[shard].ghosts.clear();
+        ghost_removes_out_[shard].type = ShardLink::Type::GhostRemove;
+        ghost_removes_out_[shard].removed.clear();
+    }
+
+    // Once a second every ghost we feed is re-sent, moved or not. Sends to a
+    // neighbour that is restarting fail; this is how it catches up.
+    const bool refresh = ++ghost_refresh_counter_ >= tick_scheduler_.Tps();
+    if (refresh) ghost_refresh_counter_ = 0;
+
+    auto record_of = [](const Player &player) {
+        return ShardLink::GhostRecord{player.GetID(), player.GetX(), player.GetY(), player.GetFacing()};
+    };
+
+    for (const auto &player : dirty_players) {
+        // Bots are load generators for this process - never mirrored or handed off
+        if (Actions::BotStressTest::IsBotClient(player->GetClientID())) continue;
+
+        const uint64_t player_id = player->GetID();
+        const int16_t x = player->GetX();
+        if (!layout_.Owns(x)) {
+            HandOff(player, layout_.OwnerOf(x));
+            continue;
+        }
+
+        const uint8_t targets = layout_.GhostTargets(x);
+        auto held_it = ghosted_on_.find(player_id);
+        const uint8_t held = held_it == ghosted_on_.end() ? 0 : held_it->second;
+        if (targets == 0 && held == 0) continue;  // Nowhere near a border
+
+        for (uint8_t shard = 0; shard < layout_.count; shard++) {
+            if (targets & ShardBit(shard)) {
+                if (!refresh) ghost_updates_out_[shard].ghosts.push_back(record_of(*player));
+            } else if (held & ShardBit(shard)) {
+                ghost_removes_out_[shard].removed.push_back(player_id);
+            }
+        }
+
+        if (targets == 0) {
+            ghosted_on_.erase(held_it);
+        } else {
+            ghosted_on_[player_id] = targets;
+        }
+    }
+
+    if (refresh) {
+        for (const auto &[player_id, held] : ghosted_on_) {
+            auto player = players_.GetByID(player_id);
+            if (!player) continue;
+            for (uint8_t shard = 0; shard < layout_.count; shard++) {
+                if (held & ShardBit(shard)) ghost_updates_out_[shard].ghosts.push_back(record_of(*player));
+            }
+        }
+    }
+
+    for (uint8_t shard = 0; shard < layout_.count; shard++) {
+        if (!ghost_removes_out_[shard].removed.empty()) shard_link_->Send(shard, ghost_removes_out_[shard]);
+        if (!ghost_updates_out_[shard].ghosts.empty()) shard_link_->Send(shard, ghost_updates_out_[shard]);
+    }
+}
+
+void Zone::HandOff(const std::shared_ptr<Player> &player, uint8_t to) {
+    const uint64_t player_id = player->GetID();
+    const uint64_t client_id = player->GetClientID();
+    auto client = Clients().GetClient(client_id);
+
+    ShardLink::Message message;
+    message.type = ShardLink::Type::Handoff;
+    message.handoff = ShardLink::Handoff{
+            token_rng_() | 1,  // Never 0 - that means a plain handshake
+            player_id, player->GetX(), player->GetY(), player->GetFacing(), player->GetName()};
+
+    if (!shard_link_->Send(to, message)) {
+        // Neighbour not running (or swamped): keep the player, on our side
+        int16_t x = layout_.ClampToStrip(player->GetX());
+        int16_t y = player->GetY();
+        world_.FindOpenTile(x, y, player->GetHandle());
+        player->SetPosition(x, y);
+        world_.UpdatePlayerPosition(player->GetHandle(), x, y);
+        players_.MarkDirty(player);
+        if (client) Packets::PacketSender::PositionCorrection(client, x, y, player->GetFacing());
+        Actions::Movement::UpdateVisibilityAfterMove(this, player, client != nullptr);
+        Log::Warn("Handoff of player {} to shard {} failed, kept on shard {}", player_id, to, layout_.index);
+        return;
+    }
+
+    // The target's ghost is the player now; other neighbours drop theirs
+    ForgetGhostCopies(player_id, ShardBit(to));
+
+    if (client) {
+        const auto port = static_cast<uint16_t>(Protocol::PORT + to * ServerConfig::SHARD_PORT_STRIDE);
+        Packets::PacketSender::ShardRedirect(client, port, message.handoff.token);
+    }
+
+    // Stays here as a ghost of the target's player, under the same handle,
+    // so everyone nearby keeps seeing it. The client closes this connection
+    // itself.
+    players_.DetachClient(client_id);
+    input_queues_.Remove(client_id);
+    map_streamer_.Leave(client_id);
+    world_.Visibility().ForgetKnown(player->GetHandle());
+    player->SetGhost(true);
+    ghosts_[player_id] = Ghost{player, to};
+
+    Stats().RecordHandoffOut();
+    Log::Info("Player {} handed off to shard {} at ({}, {})", player_id, to, player->GetX(), player->GetY());
+}
+
+void Zone::ResumeHandoff(const std::shared_ptr<ClientConnection> &client, uint64_t token) {
+    const uint64_t client_id = client->GetClientID();
+
+    auto pending = pending_handoffs_.find(token);
+    if (pending == pending_handoffs_.end()) {
+        Log::Warn("Client {} resumed with an unknown shard token", client_id);
+        client->Disconnect("invalid shard token");
+        return;
+    }
+    const PendingHandoff handoff = pending->second;
+    pending_handoffs_.erase(pending);
+
+    auto ghost_it = ghosts_.find(handoff.player_id);
+    if (ghost_it == ghosts_.end()) {
+        Log::Error("Handoff of player {} has no ghost", handoff.player_id);
+        client->Disconnect("shard handoff lost");
+        return;
+    }
+    auto player = std::move(ghost_it->second.player);
+    ghosts_.erase(ghost_it);
+    std::erase(updated_ghosts_, player);
+
+    player->SetGhost(false);
+    if (!players_.AdoptPlayer(client_id, player)) {
+        LeaveWorld(*player);
+        players_.RemovePlayer(player->GetHandle());
+        client->Disconnect("duplicate login");
+        return;
+    }
+    zones_.SetRoute(client_id, map_id_);
+    Stats().RecordHandoffIn();
+    Log::Info("Client {} resumed player {} on shard {} (from shard {})",
+              client_id, player->GetID(), layout_.index, handoff.from);
+
+    Packets::PacketSender::Welcome(client, player);
+    if (auto *udp_channel = UdpChannel()) {
+        Packets::PacketSender::UdpToken(client, udp_channel->IssueToken(client_id), udp_channel->Port());
+    }
+
+    // Already in the world, and already known to everyone nearby as the ghost
+    SendSurroundings(client, player);
+
+    // The source still shows its ghost; the next border sync moves or drops it
+    ghosted_on_[player->GetID()] |= ShardBit(handoff.from);
+    players_.MarkDirty(player);
+}
+
+void Zone::ForgetGhostCopies(uint64_t player_id, uint8_t keep_mask) {
+    auto it = ghosted_on_.find(player_id);
+    if (it == ghosted_on_.end()) return;
+    const uint8_t held = it->second & ~keep_mask;
+    ghosted_on_.erase(it);
+
+    for (uint8_t shard = 0; shard < layout_.count; shard++) {
+        if (held & ShardBit(shard)) shard_link_->Send(shard, GhostRemoveMessage(player_id));
+    }
+}
+
+/// ============================================================================
+/// STRESS TEST BOTS
+/// ============================================================================
+
+void Zone::SpawnBots(size_t count, bool clustered) {
+    QueueAction([this, count, clustered] {
+        if (input_log_) input_block_.AddSpawnBots(static_cast<uint32_t>(count), clustered);
+        EnsureMapLoaded();
+        Actions::BotStressTest::SpawnBots(this, bot_manager_, count, clustered);
+    });
+}
+
+void Zone::RemoveBots() {
+    QueueAction([this] {
+        if (input_log_) input_block_.AddRemoveBots();
+        Actions::BotStressTest::RemoveBots(this, bot_manager_);
+    });
+}
@@ -0,0 +1,443 @@
+/// =======================================
+/// DyeWarsServer - Zone
+///
+/// One map's simulation: its World, players, input queues and command ring,
+/// ticked by its own thread. GameServer keeps what all maps share (sockets,
+/// connections, Lua, the job pool); ZoneManager routes clients to zones and
+/// carries players between them.
+///
+/// WHY ONE THREAD PER MAP:
+/// Players on different maps never see or collide with each other, but with
+/// one game thread they all shared one tick budget - a crowded map made every
+/// map lag. Each zone paces its own ticks, so a busy map only slows itself,
+/// and maps spread across cores.
+///
+/// THREAD OWNERSHIP:
+/// What the single game thread used to own is now owned per zone: a zone's
+/// World, PlayerRegistry, InputQueues and Player objects are touched only by
+/// that zone's thread (same ThreadOwner asserts, per object). Zones never
+/// call into each other's state. All that crosses between them is commands
+/// (routed by the IO threads), ZoneTransfer messages (PostTransfer) and
+/// disconnects a zone passes on to the zone that has the player
+/// (PostDisconnect). A zone thread never waits on another zone's ring.
+/// A Player object never changes zones - the target builds a new one with
+/// the same player ID.
+///
+/// SHARDING (--shard I/N, primary zone only):
+/// Map 0 can be split across N server processes (ShardLayout). This zone
+/// then simulates only the players in its strip. Players near a border are
+/// mirrored to the neighbour as ghosts - read-only Player objects in the
+/// World and visibility tracking, but not in the registry, so they are seen
+/// and collided with but never ticked. Walking over the border hands the
+/// player to the neighbour (ShardLink Handoff); its client is redirected
+/// there and resumes with a token. Everything crosses processes through
+/// ShardLink, drained once per tick like the transfer inbox.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "InputLog.h"
+#include "MapStreamer.h"
+#include "TickDelta.h"
+#include "game/GameTime.h"
+#include "game/PlayerRegistry.h"
+#include "game/ShardLayout.h"
+#include "game/TileChangeJournal.h"
+#include "game/World.h"
+#include "game/InputQueues.h"
+#include "game/actions/BotStressTest.h"
+#include "game/actions/GameCommand.h"
+#include "core/MpscRing.h"
+#include "core/TickScheduler.h"
+#include "debug/PerfCounters.h"
+#include "network/ShardLink.h"
+
+class GameServer;
+class ZoneManager;
+class ClientManager;
+class ClientConnection;
+class JobSystem;
+class ServerStats;
+class UdpSpatialChannel;
+struct ServerConfig;
+
+class Zone {
+public:
+    Zone(GameServer &server, ZoneManager &zones, uint16_t map_id, const ServerConfig &config);
+
+    /// Stops the zone's threads if still running
+    ~Zone();
+
+    Zone(const Zone &) = delete;
+    Zone &operator=(const Zone &) = delete;
+
+    void Start();
+
+    /// Join the zone thread, then let the encoder finish what it was given
+    void Stop();
+
+    // =========================================================================
+    // ANY THREAD
+    // =========================================================================
+
+    /// Lock-free and allocation-free. If the ring is full, input commands
+    /// are dropped and counted; Login/Disconnect wait for space.
+    void QueueCommand(const GameCommand &command);
+
+    /// Escape hatch for rare admin actions (bot spawning, console commands).
+    /// Allocates and takes a mutex - don't use it per packet.
+    void QueueAction(std::function<void()> action);
+
+    /// A player handed over by another zone. Built at the next tick start.
+    void PostTransfer(ZoneTransfer transfer);
+
+    /// A Disconnect passed on by another zone whose client's player lives
+    /// here. Handled at the next tick start, with the transfers. Never
+    /// blocks - unlike QueueCommand, which waits for ring space, so one
+    /// zone falling behind can't stall the zones forwarding to it.
+    void PostDisconnect(uint64_t client_id);
+
+    /// Edit a tile (Lua, the console, editor tools). Applied after the
+    /// next tick's commands and sent to the players who can see it at the
+    /// end of that tick. Lock-free; false if the edit ring is full (the
+    /// edit is dropped and counted).
+    bool QueueTileEdit(const TileEdit &edit);
+
+    uint16_t MapID() const { return map_id_; }
+
+    /// The primary zone (map 0) takes logins and runs the server-wide
+    /// per-tick work (bandwidth, send queue sampling, global tick stats)
+    bool IsPrimary() const { return map_id_ == 0; }
+
+    size_t PlayerCount() const { return players_.Count(); }
+
+    size_t BotCount() const { return bot_manager_.bot_handles.size(); }
+
+    /// Which strip of the map this process owns (unsharded: count 1)
+    const ShardLayout &Layout() const { return layout_; }
+
+    // =========================================================================
+    // ZONE THREAD (and the actions it runs)
+    // =========================================================================
+
+    World &GetWorld() { return world_; }
+
+    /// This tick's tile edits. Zone-thread code edits tiles through it
+    /// rather than TileMap, so the change reaches clients.
+    TileChangeJournal &TileEdits() { return tile_journal_; }
+
+    PlayerRegistry &Players() { return players_; }
+
+    /// Game time of the tick being simulated: ticks executed so far and the
+    /// tick length. Cooldowns count these ticks (see GameTime).
+    const GameTime &Now() const { return game_time_; }
+
+    /// --deterministic: the simulation must depend only on its inputs
+    bool Deterministic() const { return deterministic_; }
+
+    /// This tick's outgoing visibility updates and transfers. Spatial
+    /// batches and S_Left_Game go here instead of straight to connections,
+    /// so they reach each client in tick order even with --pipeline.
+    TickDelta &Delta() { return *delta_; }
+
+    ZoneManager &Zones() { return zones_; }
+
+    ClientManager &Clients();
+
+    ServerStats &Stats();
+
+    /// UDP spatial channel, or nullptr when started without --udp
+    UdpSpatialChannel *UdpChannel();
+
+    /// Hand the player to zone `to_map`, arriving near (x, y). Everyone who
+    /// could see them here is told they left, and so is the player about
+    /// everyone it could see. The target builds the player once this tick's
+    /// packets are queued (see TickDelta).
+    void TransferOut(const std::shared_ptr<Player> &player, uint16_t to_map, int16_t x, int16_t y);
+
+    /// Spawn / remove stress test bots on this map (see BotStressTest)
+    void SpawnBots(size_t count, bool clustered);
+
+    void RemoveBots();
+
+    /// Where one tick's time went, in milliseconds
+    struct TickPhases {
+        double transfers = 0;   // Arrivals from other zones and shards
+        double commands = 0;    // Command ring and admin actions
+        double inputs = 0;      // Queued moves/turns/warps
+        double bots = 0;        // Stress bot movement
+        double broadcast = 0;   // BroadcastDirtyPlayers
+        double hooks = 0;       // Lua OnPlayerMoved
+        double publish = 0;     // Encode and queue (hand-off only with --pipeline)
+        double total = 0;
+    };
+
+    /// Simulate one tick: arrivals, commands, inputs, bots, broadcast,
+    /// publish. The zone thread calls it once per scheduled tick; a
+    /// headless server's owner (DyeWarsReplay) calls it directly on a zone
+    /// that was never started.
+    void RunTick();
+
+    /// Phase timings of the last RunTick()
+    const TickPhases &LastTickPhases() const { return phases_; }
+
+private:
+    // =========================================================================
+    // GAME LOOP
+    // =========================================================================
+
+    void GameLogicThread();
+
+    void ProcessTick();
+
+    /// Drain the command ring, then the admin action queue
+    void ProcessActionQueue();
+
+    /// Dispatch one command (zone thread). Moves/turns/warps go to input_queues_.
+    void ExecuteCommand(const GameCommand &command);
+
+    /// Apply a bounded number of queued inputs per client (zone thread)
+    void ProcessInputQueues();
+
+    /// Build players handed over by other zones, then run the disconnects
+    /// they passed on (start of tick)
+    void ReceiveTransfers();
+
+    /// Session command handlers (zone thread)
+    void HandleLogin(uint64_t client_id);
+
+    /// False if the player is in another zone and the command was passed on
+    bool HandleDisconnect(uint64_t client_id);
+
+    /// Last step of a disconnect, once no zone has the client's player
+    void ReleaseClient(uint64_t client_id);
+
+    /// Place a new arrival (login or transfer) in the world, send it its
+    /// surroundings and announce it to nearby players
+    void EnterWorld(const std::shared_ptr<ClientConnection> &client, const std::shared_ptr<Player> &player);
+
+    /// Send a player already in the world everyone around it (itself
+    /// included) and start its visibility tracking from that.
+    /// @return the players sent
+    std::vector<std::shared_ptr<Player>> SendSurroundings(const std::shared_ptr<ClientConnection> &client,
+                                                          const std::shared_ptr<Player> &player);
+
+    /// Take a player out of the world, telling everyone who knew about it.
+    /// Call while it is still in the registry (its handle must resolve).
+    void LeaveWorld(const Player &player);
+
+    /// View-based broadcasting: record one spatial batch per viewer into
+    /// the tick's delta. Viewer queries fan out over the job pool;
+    /// visibility updates stay serial.
+    void BroadcastDirtyPlayers(const std::vector<std::shared_ptr<Player>> &dirty_players);
+
+    /// End of tick: encode the delta now, or hand it to the encoder thread
+    /// (--pipeline) and start the next one
+    void PublishDelta();
+
+    /// Turn a delta into packets and queue them, then deliver its transfers
+    /// (zone thread, or encoder thread with --pipeline). Per-client encoding
+    /// fans out over the job pool.
+    void EncodeDelta(const TickDelta &delta);
+
+    void EncoderThread();
+
+    void SampleSendQueues();
+
+    // =========================================================================
+    // TILE EDITS (see TileChangeJournal)
+    // =========================================================================
+
+    /// Apply the edits queued by other threads (after the command phase)
+    void ApplyQueuedTileEdits();
+
+    /// Send each viewer one S_Tile_Update with the tick's tile changes in
+    /// its view, and mark the chunks it got every change of as patched so
+    /// MapStreamer doesn't re-send them. Before the map streaming step.
+    void BroadcastTileChanges();
+
+    std::vector<std::pair<uint64_t, uint32_t>> tile_viewers_;  // (client_id, change) pairs, reused
+    std::vector<TileChangeJournal::Change> tile_update_;       // One viewer's changes
+    std::vector<uint32_t> tile_chunk_counts_;                  // Per touched chunk: changes that viewer got
+
+    // =========================================================================
+    // MAP FILES (--map-dir)
+    // =========================================================================
+
+    /// DIR/mapN.dwm, left released until someone arrives, if --map-dir has
+    /// one; otherwise a generated 256x256 map
+    static std::unique_ptr<TileMap> CreateMap(uint16_t map_id, const ServerConfig &config);
+
+    /// Map the zone's file if it was released. Called wherever a player or
+    /// ghost is about to be placed. A file that went bad since startup
+    /// leaves an empty map of the same size (logged).
+    void EnsureMapLoaded();
+
+    /// End of tick: release a file-backed, unedited map that has had no
+    /// players, ghosts or pending handoffs for map_idle_ticks_
+    void ReleaseIdleMap();
+
+    // =========================================================================
+    // SHARDING (zone thread, only when layout_.IsSharded())
+    // =========================================================================
+
+    /// Apply ghost updates/removes and handoffs from the other shards, and
+    /// drop handoffs whose client never came (start of tick)
+    void ReceiveShardMessages();
+
+    /// Create or move the ghost of a player owned by shard `owner`
+    std::shared_ptr<Player> UpsertGhost(const ShardLink::GhostRecord &record, uint8_t owner);
+
+    void RemoveGhost(uint64_t player_id);
+
+    /// For this tick's dirty owned players: hand off those standing in
+    /// another strip, and keep the neighbours' ghosts of the rest current
+    void SyncShardBorders(const std::vector<std::shared_ptr<Player>> &dirty_players);
+
+    /// Give the player to shard `to` and redirect its client there. If that
+    /// shard can't be reached, the player is put back inside our strip.
+    void HandOff(const std::shared_ptr<Player> &player, uint8_t to);
+
+    /// A handed-off client connected here: turn its ghost back into a player
+    void ResumeHandoff(const std::shared_ptr<ClientConnection> &client, uint64_t token);
+
+    /// Tell the shards holding a ghost of this player to drop it, except
+    /// those in keep_mask
+    void ForgetGhostCopies(uint64_t player_id, uint8_t keep_mask = 0);
+
+    /// How long a handed-off client has to reconnect here
+    static constexpr uint64_t HANDOFF_TIMEOUT_SECONDS = 10;
+
+    /// Dirty players per viewer-query chunk, clients per encode chunk.
+    /// Below one grain the work runs inline - not worth waking a worker.
+    static constexpr size_t VIEWER_QUERY_GRAIN = 32;
+    static constexpr size_t ENCODE_GRAIN = 64;
+
+    /// Viewers found for one dirty player (reused across ticks)
+    struct DirtyViewers {
+        std::vector<PlayerHandle> viewers;  // In range, excluding the player itself
+        size_t in_range = 0;                // Including itself, for stats
+    };
+    std::vector<DirtyViewers> dirty_viewers_;
+    std::vector<std::shared_ptr<Player>> tick_dirty_;  // This tick's dirty players (PlayerRegistry's other buffer)
+    std::vector<PlayerHandle> dirty_handles_;          // Their handles, same order
+
+    /// Cache misses etc. over BroadcastDirtyPlayers (zone thread, see PerfCounters.h)
+    PerfCounters broadcast_counters_;
+
+    /// Encode scratch (used by one encoding thread at a time)
+    struct ClientRun {
+        uint32_t begin;  // Range in encode_order_
+        uint32_t end;
+    };
+    std::vector<uint32_t> encode_order_;                       // Event indices grouped by client
+    std::vector<std::pair<uint64_t, ClientRun>> encode_runs_;  // client_id -> its events
+    std::vector<uint32_t> encode_tcp_records_;                 // Per event: records still for TCP
+
+    // =========================================================================
+    // DATA
+    // =========================================================================
+
+    GameServer &server_;
+    ZoneManager &zones_;
+    JobSystem &jobs_;
+    const uint16_t map_id_;
+
+    // State (zone thread)
+    World world_;
+    PlayerRegistry players_;
+    InputQueues input_queues_;
+    MapStreamer map_streamer_{world_.GetMap(), World::VIEW_RANGE};
+    TileChangeJournal tile_journal_{world_.GetMap()};
+    std::vector<uint64_t> departed_;  // Transferred out this tick; input queues dropped after Drain
+
+    // Command ring (IO threads -> zone thread).
+    // 64k commands = over a second of 50 move packets/sec from 1000 clients.
+    static constexpr size_t COMMAND_RING_CAPACITY = 65536;
+    MpscRing<GameCommand> commands_{COMMAND_RING_CAPACITY};
+
+    // Tile edit ring (Lua, console -> zone thread). An edit is 6 bytes;
+    // 4k is far more than a tick of scripted doors and traps.
+    static constexpr size_t TILE_EDIT_RING_CAPACITY = 4096;
+    MpscRing<TileEdit> tile_edits_{TILE_EDIT_RING_CAPACITY};
+
+    // Admin action queue (std::function escape hatch, rare)
+    std::queue<std::function<void()>> action_queue_;
+    std::mutex action_mutex_;
+
+    // Arrivals and forwarded disconnects from other zones. A Disconnect
+    // that overtakes its player's transfer parks the client in
+    // pending_disconnects_ (zone thread) until the transfer shows up.
+    std::mutex inbox_mutex_;
+    std::vector<ZoneTransfer> inbox_;
+    std::vector<ZoneTransfer> arrivals_;
+    std::vector<uint64_t> disconnect_inbox_;
+    std::vector<uint64_t> forwarded_disconnects_;
+    std::unordered_set<uint64_t> pending_disconnects_;
+
+    // Zone thread, paced by its own tick scheduler (--tps, --catch-up)
+    TickScheduler tick_scheduler_;
+    GameTime game_time_;  // tick advanced once per executed tick (zone thread)
+    const bool deterministic_;
+    TickPhases phases_;
+
+    uint64_t map_idle_ticks_ = 0;   // --map-idle in ticks
+    uint64_t map_idle_since_ = 0;   // Tick the map went empty, 0 = in use
+
+    // --record: this tick's executed commands, written to the GameServer's
+    // log once the command phase is over (zone thread)
+    InputLog *const input_log_;
+    InputLog::TickBlock input_block_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    // Tick output. delta_ is the one being recorded (zone thread). With
+    // --pipeline, finished deltas go through pipeline_ to encoder_thread_.
+    const bool pipelined_;
+    TickDeltaPipeline pipeline_;
+    std::unique_ptr<TickDelta> delta_;
+    std::thread encoder_thread_;
+
+    // Send queue sampling (primary zone, once per second of ticks)
+    uint64_t send_queue_sample_counter_{0};
+
+    // Sharding (zone thread). shard_link_ is the GameServer's, set in Start.
+    ShardLayout layout_;
+    ShardLink *shard_link_ = nullptr;
+
+    struct Ghost {
+        std::shared_ptr<Player> player;
+        uint8_t owner;                          // Shard simulating the player
+        uint64_t queued_tick = UINT64_MAX;      // Last tick it went into updated_ghosts_
+    };
+    std::unordered_map<uint64_t, Ghost> ghosts_;            // player_id -> ghost
+    std::vector<std::shared_ptr<Player>> updated_ghosts_;   // Moved this tick, broadcast with the dirty players
+    std::unordered_map<uint64_t, uint8_t> ghosted_on_;      // Owned player_id -> shards holding its ghost (bits)
+
+    struct PendingHandoff {
+        uint64_t player_id;
+        uint8_t from;
+        uint64_t deadline_tick;
+    };
+    std::unordered_map<uint64_t, PendingHandoff> pending_handoffs_;  // token -> handoff
+
+    std::vector<ShardLink::Message> shard_inbox_;
+    std::vector<ShardLink::Message> ghost_updates_out_;  // Per shard, reused
+    std::vector<ShardLink::Message> ghost_removes_out_;
+    uint64_t ghost_refresh_counter_{0};
+    std::mt19937_64 token_rng_{std::random_device{}()};
+
+    Actions::BotStressTest::BotManager bot_manager_;
+};
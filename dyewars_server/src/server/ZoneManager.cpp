@@ -0,0 +1,74 @@
+/// =======================================
+/// DyeWarsServer - ZoneManager
+/// =======================================
+#include "ZoneManager.h"
+#include "GameServer.h"
+#include "Zone.h"
+#include "core/Log.h"
+#include "core/ServerConfig.h"
+
+ZoneManager::ZoneManager(GameServer &server, const ServerConfig &config)
+        : warps_(server.Warps()),
+          open_warps_(config.open_warps) {
+    zones_.reserve(config.zones);
+    for (size_t map_id = 0; map_id < config.zones; map_id++) {
+        zones_.push_back(std::make_unique<Zone>(server, *this, static_cast<uint16_t>(map_id), config));
+    }
+}
+
+ZoneManager::~ZoneManager() {
+    Stop();
+}
+
+void ZoneManager::Start() {
+    for (auto &zone : zones_) zone->Start();
+    Log::Info("{} zone(s) running", zones_.size());
+}
+
+void ZoneManager::Stop() {
+    for (auto &zone : zones_) zone->Stop();
+}
+
+Zone &ZoneManager::RouteFor(uint64_t client_id) const {
+    std::shared_lock lock(routes_mutex_);
+    auto it = routes_.find(client_id);
+    return it == routes_.end() ? Primary() : *zones_[it->second.map_id];
+}
+
+std::optional<ZoneManager::Route> ZoneManager::RouteOf(uint64_t client_id) const {
+    std::shared_lock lock(routes_mutex_);
+    auto it = routes_.find(client_id);
+    if (it == routes_.end()) return std::nullopt;
+    return it->second;
+}
+
+void ZoneManager::SetRoute(uint64_t client_id, uint16_t map_id) {
+    std::unique_lock lock(routes_mutex_);
+    routes_[client_id] = Route{map_id, false};
+}
+
+void ZoneManager::BeginTransfer(uint64_t client_id, uint16_t to_map) {
+    std::unique_lock lock(routes_mutex_);
+    routes_[client_id] = Route{to_map, true};
+}
+
+void ZoneManager::RemoveRoute(uint64_t client_id) {
+    std::unique_lock lock(routes_mutex_);
+    routes_.erase(client_id);
+}
+
+void ZoneManager::Deliver(ZoneTransfer transfer) {
+    Zone *target = Get(transfer.to_map);
+    if (!target) {
+        // Warp validates the map before anything is sent, so this is a bug
+        Log::Error("Transfer of player {} to unknown map {}", transfer.player_id, transfer.to_map);
+        return;
+    }
+    target->PostTransfer(std::move(transfer));
+}
+
+size_t ZoneManager::PlayerCount() const {
+    size_t total = 0;
+    for (const auto &zone : zones_) total += zone->PlayerCount();
+    return total;
+}
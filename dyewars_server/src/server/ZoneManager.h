@@ -0,0 +1,127 @@
+/// =======================================
+/// DyeWarsServer - ZoneManager
+///
+/// Owns the zones (one per map, see Zone), the client -> zone routing table,
+/// and the hand-off of players between zones.
+///
+/// ROUTING:
+/// IO threads call RouteFor() for every input packet to pick the zone whose
+/// command ring gets it. Clients not in the table yet (not logged in) go to
+/// the primary zone, which handles logins. The table is a shared_mutex
+/// around an unordered_map: the per-packet readers never block each other,
+/// and the writers (login, warp, disconnect) are rare.
+///
+/// HANDOFF (warp to another map):
+///   1. Source zone thread: removes the player, puts S_Left_Game for everyone
+///      involved and a ZoneTransfer into its tick delta, and calls
+///      BeginTransfer() - the client's commands now go to the target zone,
+///      marked "arriving".
+///   2. Once that delta has been encoded, Deliver() posts the transfer to the
+///      target zone's inbox.
+///   3. Target zone thread, at its next tick start: builds the player from
+///      the transfer, sends S_Warped plus its surroundings, SetRoute().
+/// Inputs that reach the target before the player are dropped. A Disconnect
+/// that gets there first is held until the transfer arrives, so the player
+/// never leaks. The zones only ever exchange plain data.
+///
+/// WARP TILES:
+/// Warps() is the server's list of warp tiles, shared by every zone. A
+/// client's warp request is checked against it (see WarpPoints), unless
+/// --open-warps.
+///
+/// THREAD SAFETY:
+/// The zone list is fixed at construction - Get() / Primary() from any
+/// thread. Routing, Deliver() and Warps() are thread-safe.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "TickDelta.h"
+#include "game/WarpPoints.h"
+
+class GameServer;
+class Zone;
+struct ServerConfig;
+
+class ZoneManager {
+public:
+    struct Route {
+        uint16_t map_id;
+        bool arriving;  // Transfer posted, player not built in the target yet
+    };
+
+    /// One zone per map id 0 .. config.zones - 1. Map 0 is the primary zone:
+    /// logins spawn there and it runs the server-wide per-tick work.
+    ZoneManager(GameServer &server, const ServerConfig &config);
+
+    ~ZoneManager();
+
+    ZoneManager(const ZoneManager &) = delete;
+    ZoneManager &operator=(const ZoneManager &) = delete;
+
+    /// Start every zone's threads
+    void Start();
+
+    /// Stop and join every zone (encoders drain what they were given)
+    void Stop();
+
+    /// Zone for a map, or nullptr if there is no such map. Any thread.
+    Zone *Get(uint16_t map_id) const {
+        return map_id < zones_.size() ? zones_[map_id].get() : nullptr;
+    }
+
+    Zone &Primary() const { return *zones_.front(); }
+
+    size_t Count() const { return zones_.size(); }
+
+    // =========================================================================
+    // ROUTING (any thread)
+    // =========================================================================
+
+    /// Zone that should get this client's commands
+    Zone &RouteFor(uint64_t client_id) const;
+
+    std::optional<Route> RouteOf(uint64_t client_id) const;
+
+    /// Client's player now lives in `map_id` (login, or transfer arrived)
+    void SetRoute(uint64_t client_id, uint16_t map_id);
+
+    /// Client's player left its zone for `to_map` and is on the way
+    void BeginTransfer(uint64_t client_id, uint16_t to_map);
+
+    /// Client disconnected and its player is gone
+    void RemoveRoute(uint64_t client_id);
+
+    /// Post a transfer to its target zone. Call only after the source zone's
+    /// packets from the same tick are queued (see TickDelta).
+    void Deliver(ZoneTransfer transfer);
+
+    /// Players across all zones
+    size_t PlayerCount() const;
+
+    // =========================================================================
+    // WARPS (any thread)
+    // =========================================================================
+
+    /// The GameServer's warp tiles (Lua and the console add them there)
+    WarpPoints &Warps() { return warps_; }
+
+    /// --open-warps: clients may warp anywhere, warp tile or not
+    bool OpenWarps() const { return open_warps_; }
+
+private:
+    std::vector<std::unique_ptr<Zone>> zones_;
+
+    mutable std::shared_mutex routes_mutex_;
+    std::unordered_map<uint64_t, Route> routes_;  // client_id -> where its player is
+
+    WarpPoints &warps_;
+    const bool open_warps_;
+};
@@ -13,13 +13,50 @@
 #include <vector>
 #include <atomic>
 #include <future>
-
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#include "core/JobSystem.h"
+#include "core/MpscRing.h"
+#include "core/SlotMap.h"
+#include "core/ServerConfig.h"
+#include "core/TickScheduler.h"
+#include "game/CollisionGrid.h"
 #include "database/DatabaseManager.h"
+#include "game/GameTime.h"
+#include "game/InputQueues.h"
+#include "game/InstancePool.h"
+#include "game/MapFile.h"
+#include "game/PlayerRegistry.h"
+#include "game/ShardLayout.h"
+#include "game/TileChangeJournal.h"
+#include "game/WarpPoints.h"
+#include "game/World.h"
+#include "game/actions/GameCommand.h"
 #include "lua/LuaEngine.h"
 #include "network/BandwidthMonitor.h"
 #include "network/ConnectionLimiter.h"
+#include "network/GatewayProtocol.h"
+#include "network/HandshakeCheck.h"
+#include "network/IoBackend.h"
+#include "network/IoContextPool.h"
+#include "network/PacketTrace.h"
+#include "network/ShardLink.h"
+#include "network/SpatialConflation.h"
+#include "network/TimerWheel.h"
+#include "network/UdpSpatialChannel.h"
+#include "network/Packets/OpCodes.h"
+#include "network/ReceiveRing.h"
 #include "server/ClientManager.h"
 #include "server/ClientConnection.h"
+#include "server/FakeClientConnection.h"
+#include "server/GameServer.h"
+#include "server/InputLog.h"
+#include "server/MapStreamer.h"
+#include "server/TickDelta.h"
+#include "server/Zone.h"
+#include "server/ZoneManager.h"
 
 namespace fs = std::filesystem;
 
@@ -532,6 +569,2733 @@ TEST(ping_tracker_get_is_thread_safe) {
     ASSERT_TRUE(reads > 0);
 }
 
+// =============================================================================
+// ReceiveRing Tests - In-Place Frame Parsing
+// =============================================================================
+
+/// Copy bytes into the ring as if async_read_some delivered them
+static void FeedRing(ReceiveRing& ring, const std::vector<uint8_t>& bytes) {
+    std::memcpy(ring.WritePtr(), bytes.data(), bytes.size());
+    ring.Commit(bytes.size());
+}
+
+/// Build a framed packet: [0x11][0x68][size:2][payload]
+static std::vector<uint8_t> MakeFrame(const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> frame = {Protocol::MAGIC_1, Protocol::MAGIC_2,
+                                  static_cast<uint8_t>(payload.size() >> 8),
+                                  static_cast<uint8_t>(payload.size() & 0xFF)};
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    return frame;
+}
+
+TEST(receive_ring_parses_many_frames_from_one_read) {
+    ReceiveRing ring;
+    std::vector<uint8_t> burst;
+    for (uint8_t i = 0; i < 10; i++) {
+        auto frame = MakeFrame({0x01, i, i});
+        burst.insert(burst.end(), frame.begin(), frame.end());
+    }
+    FeedRing(ring, burst);
+
+    int parsed = 0;
+    uint16_t size = 0;
+    while (ring.PeekFrame(size) == ReceiveRing::FrameStatus::Ready) {
+        auto payload = ring.Payload(size);
+        ASSERT_EQ(size, 3);
+        ASSERT_EQ(payload[1], parsed);
+        ring.Consume(Protocol::HEADER_SIZE + size);
+        parsed++;
+    }
+    ASSERT_EQ(parsed, 10);
+    ASSERT_EQ(ring.ReadableBytes(), 0);
+}
+
+TEST(receive_ring_waits_for_fragmented_frame) {
+    ReceiveRing ring;
+    auto frame = MakeFrame({0x02, 0x03});
+    uint16_t size = 0;
+
+    // Header split across reads
+    FeedRing(ring, {frame[0], frame[1]});
+    ASSERT_TRUE(ring.PeekFrame(size) == ReceiveRing::FrameStatus::NeedMore);
+
+    // Header complete, payload missing
+    FeedRing(ring, {frame[2], frame[3], frame[4]});
+    ASSERT_TRUE(ring.PeekFrame(size) == ReceiveRing::FrameStatus::NeedMore);
+
+    FeedRing(ring, {frame[5]});
+    ASSERT_TRUE(ring.PeekFrame(size) == ReceiveRing::FrameStatus::Ready);
+    ASSERT_EQ(ring.Payload(size)[1], 0x03);
+}
+
+TEST(receive_ring_flags_bad_magic_and_size) {
+    ReceiveRing ring;
+    uint16_t size = 0;
+
+    FeedRing(ring, {0xDE, 0xAD, 0x00, 0x01});
+    ASSERT_TRUE(ring.PeekFrame(size) == ReceiveRing::FrameStatus::BadMagic);
+
+    // Skipping the bad header resyncs on the next frame
+    ring.Consume(Protocol::HEADER_SIZE);
+    FeedRing(ring, {Protocol::MAGIC_1, Protocol::MAGIC_2, 0xFF, 0xFF});
+    ASSERT_TRUE(ring.PeekFrame(size) == ReceiveRing::FrameStatus::BadSize);
+    ASSERT_EQ(size, 0xFFFF);
+}
+
+TEST(receive_ring_compacts_partial_tail) {
+    ReceiveRing ring;
+    uint16_t size = 0;
+
+    // Fill most of the ring with max-size frames so the tail needs compacting
+    std::vector<uint8_t> big(Protocol::MAX_PAYLOAD_SIZE - 1, 0xAB);
+    FeedRing(ring, MakeFrame(big));
+    auto tail = MakeFrame({0x01, 0x02, 0x03});
+    FeedRing(ring, {tail[0], tail[1], tail[2]});  // Partial header of the next frame
+
+    ASSERT_TRUE(ring.PeekFrame(size) == ReceiveRing::FrameStatus::Ready);
+    ring.Consume(Protocol::HEADER_SIZE + size);
+    ASSERT_TRUE(ring.WritableBytes() < ReceiveRing::MAX_FRAME_SIZE);
+
+    ring.Compact();
+    ASSERT_EQ(ring.ReadableBytes(), 3);
+    ASSERT_GE(ring.WritableBytes(), ReceiveRing::MAX_FRAME_SIZE);
+
+    FeedRing(ring, {tail.begin() + 3, tail.end()});
+    ASSERT_TRUE(ring.PeekFrame(size) == ReceiveRing::FrameStatus::Ready);
+    ASSERT_EQ(ring.Payload(size)[2], 0x03);
+}
+
+// =============================================================================
+// PacketTrace Tests - Lock-Free Trace Ring
+// =============================================================================
+
+/// Reset the singleton between tests
+static void ResetTrace(PacketTrace& trace) {
+    trace.SetEnabled(false);
+    trace.SetSampleRate(1);
+    trace.UnwatchClient(42);
+    trace.Clear();
+}
+
+TEST(packet_trace_off_records_nothing) {
+    auto& trace = PacketTrace::Instance();
+    ResetTrace(trace);
+    const uint64_t before = trace.GetRecordedCount();
+
+    std::vector<uint8_t> move = {0x01, 0x02, 0x02};
+    trace.Record(PacketTraceFormat::Direction::ClientToServer, 1, move);
+    ASSERT_EQ(trace.GetRecordedCount(), before);
+
+    // Watching one client only records that client
+    ASSERT_TRUE(trace.WatchClient(42));
+    trace.Record(PacketTraceFormat::Direction::ClientToServer, 1, move);
+    trace.Record(PacketTraceFormat::Direction::ClientToServer, 42, move);
+    ASSERT_EQ(trace.GetRecordedCount(), before + 1);
+    ResetTrace(trace);
+}
+
+TEST(packet_trace_sampling_keeps_one_in_n) {
+    auto& trace = PacketTrace::Instance();
+    ResetTrace(trace);
+    trace.SetEnabled(true);
+    trace.SetSampleRate(10);
+    const uint64_t before = trace.GetRecordedCount();
+
+    std::vector<uint8_t> turn = {0x02, 0x01};
+    for (int i = 0; i < 1000; i++) {
+        trace.Record(PacketTraceFormat::Direction::ClientToServer, 1, turn);
+    }
+    ASSERT_EQ(trace.GetRecordedCount() - before, 100);
+    ResetTrace(trace);
+}
+
+TEST(packet_trace_concurrent_record_and_dump) {
+    auto& trace = PacketTrace::Instance();
+    ResetTrace(trace);
+    trace.SetEnabled(true);
+    const std::string path = "test_packet_trace.dwtr";
+
+    // IO thread + game thread writing while the console dumps
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; t++) {
+        writers.emplace_back([&trace, t]() {
+            std::vector<uint8_t> payload = {0x25, 0x01, static_cast<uint8_t>(t)};
+            for (int i = 0; i < 20000; i++) {
+                trace.Record(PacketTraceFormat::Direction::ServerToClient, t + 1, payload);
+            }
+        });
+    }
+    int64_t during = trace.DumpToFile(path);
+    for (auto& w : writers) w.join();
+    int64_t after = trace.DumpToFile(path);
+
+    ASSERT_GE(during, 0);
+    ASSERT_EQ(after, static_cast<int64_t>(PacketTrace::CAPACITY));
+
+    // Header: "DWTR", version, capture bytes, record count
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> header(12);
+    file.read(reinterpret_cast<char*>(header.data()), 12);
+    size_t offset = 0;
+    ASSERT_EQ(Protocol::PacketReader::ReadUInt(header, offset), PacketTraceFormat::FILE_MAGIC);
+    offset = 8;
+    ASSERT_EQ(Protocol::PacketReader::ReadUInt(header, offset), PacketTrace::CAPACITY);
+
+    file.close();
+    fs::remove(path);
+    ResetTrace(trace);
+}
+
+// =============================================================================
+// SpatialConflation Tests - Slow Consumer Backpressure
+// =============================================================================
+
+/// Framed S_Player_Spatial with one record per (id, x) pair
+static std::shared_ptr<std::vector<uint8_t>> MakeSpatial(
+        const std::vector<std::pair<uint64_t, uint16_t>>& players) {
+    Protocol::Packet pkt;
+    Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::Batch::Server::S_Player_Spatial.op);
+    Protocol::PacketWriter::WriteByte(pkt.payload, static_cast<uint8_t>(players.size()));
+    for (const auto& [id, x] : players) {
+        Protocol::PacketWriter::WriteUInt64(pkt.payload, id);
+        Protocol::PacketWriter::WriteShort(pkt.payload, x);
+        Protocol::PacketWriter::WriteShort(pkt.payload, 0);
+        Protocol::PacketWriter::WriteByte(pkt.payload, 0);
+    }
+    pkt.size = static_cast<uint16_t>(pkt.payload.size());
+    return std::make_shared<std::vector<uint8_t>>(pkt.ToBytes());
+}
+
+static std::shared_ptr<std::vector<uint8_t>> MakeLeftGame(uint64_t id) {
+    Protocol::Packet pkt;
+    Protocol::PacketWriter::WriteByte(pkt.payload, Protocol::Opcode::RemotePlayer::Server::S_Left_Game.op);
+    Protocol::PacketWriter::WriteUInt64(pkt.payload, id);
+    pkt.size = static_cast<uint16_t>(pkt.payload.size());
+    return std::make_shared<std::vector<uint8_t>>(pkt.ToBytes());
+}
+
+/// Read the x of every record in a framed spatial packet, keyed by player id
+static std::vector<std::pair<uint64_t, uint16_t>> ReadSpatial(const std::vector<uint8_t>& packet) {
+    std::vector<std::pair<uint64_t, uint16_t>> result;
+    size_t offset = Protocol::HEADER_SIZE + 1;
+    const uint8_t count = Protocol::PacketReader::ReadByte(packet, offset);
+    for (uint8_t i = 0; i < count; i++) {
+        const uint64_t id = Protocol::PacketReader::ReadUInt64(packet, offset);
+        const uint16_t x = Protocol::PacketReader::ReadShort(packet, offset);
+        offset += 3;
+        result.emplace_back(id, x);
+    }
+    return result;
+}
+
+TEST(spatial_conflation_keeps_latest_per_player) {
+    SpatialConflation::PacketQueue queue;
+    for (uint16_t tick = 0; tick < 50; tick++) {
+        queue.push_back(MakeSpatial({{1, tick}, {2, static_cast<uint16_t>(tick + 100)}}));
+    }
+
+    const size_t removed = SpatialConflation::Conflate(queue, MakeSpatial({{1, 999}, {3, 7}}));
+
+    ASSERT_EQ(queue.size(), 1);
+    ASSERT_EQ(removed, 50);
+    const auto records = ReadSpatial(*queue.front());
+    ASSERT_EQ(records.size(), 3);
+    ASSERT_TRUE(records[0] == std::make_pair(uint64_t{1}, uint16_t{999}));
+    ASSERT_TRUE(records[1] == std::make_pair(uint64_t{2}, uint16_t{149}));
+    ASSERT_TRUE(records[2] == std::make_pair(uint64_t{3}, uint16_t{7}));
+}
+
+TEST(spatial_conflation_respects_left_game_order) {
+    SpatialConflation::PacketQueue queue;
+    queue.push_back(MakeSpatial({{1, 10}, {2, 20}}));
+    queue.push_back(MakeLeftGame(1));  // Player 1 leaves - the stale record must not follow this
+
+    SpatialConflation::Conflate(queue, MakeSpatial({{2, 21}}));
+
+    ASSERT_EQ(queue.size(), 2);
+    ASSERT_EQ((*queue[0])[Protocol::HEADER_SIZE], Protocol::Opcode::RemotePlayer::Server::S_Left_Game.op);
+    const auto records = ReadSpatial(*queue[1]);
+    ASSERT_EQ(records.size(), 1);
+    ASSERT_TRUE(records[0] == std::make_pair(uint64_t{2}, uint16_t{21}));
+}
+
+TEST(spatial_conflation_never_mutates_shared_buffers) {
+    // The same buffer can be queued to many connections
+    auto shared = MakeSpatial({{1, 5}});
+    const auto original = *shared;
+    SpatialConflation::PacketQueue queue = {shared, MakeLeftGame(9), shared};
+
+    SpatialConflation::Conflate(queue, MakeSpatial({{1, 6}}));
+
+    ASSERT_TRUE(*shared == original);
+    ASSERT_EQ(queue.size(), 2);
+    ASSERT_TRUE(queue.back() != shared);
+}
+
+// =============================================================================
+// IoContextPool Tests - Multi-threaded Network I/O
+// =============================================================================
+
+TEST(io_context_pool_assigns_round_robin) {
+    IoContextPool pool(3);
+
+    ASSERT_EQ(pool.Size(), 3);
+    asio::io_context* first = &pool.Next();
+    asio::io_context* second = &pool.Next();
+    asio::io_context* third = &pool.Next();
+
+    ASSERT_TRUE(first == &pool.Primary());
+    ASSERT_TRUE(first != second && second != third && first != third);
+    ASSERT_TRUE(&pool.Next() == first);  // Wraps around
+}
+
+TEST(io_context_pool_keeps_context_on_one_thread) {
+    // A connection's handlers must all run on one thread ("IO thread only" state)
+    IoContextPool pool(4);
+    pool.Run();
+
+    std::vector<std::thread::id> seen(4);
+    std::vector<std::promise<void>> done(4);
+    std::vector<std::atomic<int>> mismatches(4);
+    for (size_t c = 0; c < 4; c++) {
+        asio::io_context& context = pool.Next();
+        for (int i = 0; i < 100; i++) {
+            asio::post(context, [&, c, i]() {
+                if (i == 0) seen[c] = std::this_thread::get_id();
+                else if (seen[c] != std::this_thread::get_id()) mismatches[c]++;
+                if (i == 99) done[c].set_value();
+            });
+        }
+    }
+    for (auto& promise : done) promise.get_future().wait();
+
+    for (size_t c = 0; c < 4; c++) ASSERT_EQ(mismatches[c].load(), 0);
+    ASSERT_TRUE(seen[0] != seen[1] && seen[1] != seen[2] && seen[2] != seen[3]);
+}
+
+TEST(io_context_pool_stop_joins_idle_threads) {
+    // Idle contexts are held open by work guards - Stop() must release them
+    auto pool = std::make_unique<IoContextPool>(2);
+    pool->Run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto stopped = std::async(std::launch::async, [&]() {
+        pool->Stop();
+        pool->Join();
+    });
+    ASSERT_TRUE(stopped.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+
+    // Destroying a pool that was never run is also safe
+    IoContextPool never_run(2);
+}
+
+// =============================================================================
+// MpscRing Tests - Lock-Free Game Command Ring
+// =============================================================================
+
+TEST(mpsc_ring_is_fifo_and_bounded) {
+    MpscRing<int> ring(5);
+    ASSERT_EQ(ring.Capacity(), 8);  // Rounded up to a power of two
+
+    for (int i = 0; i < 8; i++) ASSERT_TRUE(ring.TryPush(i));
+    ASSERT_FALSE(ring.TryPush(99));  // Full
+    ASSERT_EQ(ring.ApproxSize(), 8);
+
+    // Wrap around several laps
+    int value = -1;
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(ring.TryPop(value));
+        ASSERT_EQ(value, i);
+        ASSERT_TRUE(ring.TryPush(i + 8));
+    }
+    ASSERT_EQ(ring.ApproxSize(), 8);
+}
+
+TEST(mpsc_ring_concurrent_producers_lose_nothing) {
+    // 4 IO threads pushing while the game thread drains.
+    // Every value arrives exactly once and each producer's order is kept.
+    struct Item { uint32_t producer; uint32_t seq; };
+    constexpr uint32_t PRODUCERS = 4;
+    constexpr uint32_t PER_PRODUCER = 100000;
+    MpscRing<Item> ring(1024);
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&ring, p]() {
+            for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+                while (!ring.TryPush(Item{p, i})) std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    int out_of_order = 0;
+    uint64_t received = 0;
+    Item item{};
+    while (received < PRODUCERS * PER_PRODUCER) {
+        if (!ring.TryPop(item)) continue;
+        if (item.seq != next[item.producer]) out_of_order++;
+        next[item.producer] = item.seq + 1;
+        received++;
+    }
+    for (auto& t : producers) t.join();
+
+    ASSERT_EQ(out_of_order, 0);
+    ASSERT_FALSE(ring.TryPop(item));
+}
+
+TEST(game_command_is_compact_pod) {
+    const GameCommand move = GameCommand::Move(42, 3, 1);
+    ASSERT_TRUE(move.type == GameCommand::Type::Move);
+    ASSERT_EQ(move.client_id, 42);
+    ASSERT_EQ(move.move.direction, 3);
+    ASSERT_EQ(move.move.facing, 1);
+    ASSERT_FALSE(move.IsCritical());
+    ASSERT_FALSE(GameCommand::Turn(42, 2).IsCritical());
+    ASSERT_TRUE(GameCommand::Login(42).IsCritical());
+    ASSERT_TRUE(GameCommand::Disconnect(42).IsCritical());
+
+    // Round-trips through the ring by plain copy
+    MpscRing<GameCommand> ring(4);
+    ASSERT_TRUE(ring.TryPush(GameCommand::Turn(7, 2)));
+    GameCommand out{};
+    ASSERT_TRUE(ring.TryPop(out));
+    ASSERT_TRUE(out.type == GameCommand::Type::Turn);
+    ASSERT_EQ(out.turn.facing, 2);
+    ASSERT_EQ(sizeof(GameCommand), 16);
+}
+
+// =============================================================================
+// InputQueues Tests - Per-Client Input Caps
+// =============================================================================
+
+TEST(input_queue_coalesces_consecutive_turns) {
+    InputQueue queue;
+    ASSERT_TRUE(queue.Push(GameCommand::Turn(1, 0)) == InputQueue::PushResult::Queued);
+    ASSERT_TRUE(queue.Push(GameCommand::Turn(1, 1)) == InputQueue::PushResult::Coalesced);
+    ASSERT_TRUE(queue.Push(GameCommand::Turn(1, 3)) == InputQueue::PushResult::Coalesced);
+    ASSERT_TRUE(queue.Push(GameCommand::Move(1, 2, 2)) == InputQueue::PushResult::Queued);
+    ASSERT_TRUE(queue.Push(GameCommand::Turn(1, 0)) == InputQueue::PushResult::Queued);  // Not merged across a move
+    ASSERT_EQ(queue.Size(), 3);
+
+    GameCommand out{};
+    ASSERT_TRUE(queue.Pop(out));
+    ASSERT_TRUE(out.type == GameCommand::Type::Turn);
+    ASSERT_EQ(out.turn.facing, 3);  // Last facing wins
+    ASSERT_TRUE(queue.Pop(out));
+    ASSERT_TRUE(out.type == GameCommand::Type::Move);
+}
+
+TEST(input_queues_bound_work_per_client_per_tick) {
+    InputQueues queues;
+    // Hostile client 1 floods 100 moves, client 2 sends one
+    for (int i = 0; i < 100; i++) queues.Push(GameCommand::Move(1, 0, 0));
+    queues.Push(GameCommand::Move(2, 0, 0));
+    ASSERT_EQ(queues.Overflowed(1), 100 - InputQueue::CAPACITY);
+    ASSERT_EQ(queues.Overflowed(2), 0);
+
+    std::unordered_map<uint64_t, size_t> applied;
+    queues.Drain([&](const GameCommand& input) { applied[input.client_id]++; });
+    ASSERT_EQ(applied[1], InputQueues::INPUTS_PER_TICK);
+    ASSERT_EQ(applied[2], 1);
+    ASSERT_EQ(queues.ActiveClients(), 1);  // Only client 1 still has input
+
+    // Client 1's queue drains over the next ticks, then its overflow count resets
+    size_t ticks = 1;
+    while (queues.ActiveClients() > 0) {
+        queues.Drain([&](const GameCommand& input) { applied[input.client_id]++; });
+        ticks++;
+    }
+    ASSERT_EQ(applied[1], InputQueue::CAPACITY);
+    ASSERT_EQ(ticks, InputQueue::CAPACITY / InputQueues::INPUTS_PER_TICK);
+    ASSERT_EQ(queues.Overflowed(1), 0);
+}
+
+TEST(input_queues_drop_removed_clients) {
+    InputQueues queues;
+    queues.Push(GameCommand::Move(5, 1, 1));
+    queues.Push(GameCommand::Turn(6, 2));
+    queues.Remove(5);  // Disconnected with input still queued
+
+    std::vector<uint64_t> applied;
+    queues.Drain([&](const GameCommand& input) { applied.push_back(input.client_id); });
+    ASSERT_EQ(applied.size(), 1);
+    ASSERT_EQ(applied[0], 6);
+    ASSERT_EQ(queues.ActiveClients(), 0);
+}
+
+// =============================================================================
+// TimerWheel Tests - Connection Deadlines
+// =============================================================================
+
+/// Records (tick, tag) for every timer that fires
+struct RecordingTarget : TimerWheel::Target {
+    explicit RecordingTarget(TimerWheel& wheel) : wheel(wheel) {}
+
+    void OnTimer(uint32_t tag) override { fired.emplace_back(wheel.CurrentTick(), tag); }
+
+    TimerWheel& wheel;
+    std::vector<std::pair<uint64_t, uint32_t>> fired;
+};
+
+TEST(timer_wheel_fires_on_exact_tick_across_levels) {
+    TimerWheel wheel;
+    auto target = std::make_shared<RecordingTarget>(wheel);
+
+    // Level 0, both level boundaries, deep in level 1, and level 2
+    const std::vector<uint64_t> delays = {1, 255, 256, 5000, 16384, 100000};
+    wheel.AdvanceTo(37);  // Start off a slot boundary
+    for (uint32_t i = 0; i < delays.size(); i++) wheel.Arm(delays[i], target, i);
+    ASSERT_EQ(wheel.ArmedCount(), delays.size());
+
+    wheel.AdvanceTo(37 + 100000);
+    ASSERT_EQ(target->fired.size(), delays.size());
+    for (uint32_t i = 0; i < delays.size(); i++) {
+        ASSERT_EQ(target->fired[i].first, 37 + delays[i]);
+        ASSERT_EQ(target->fired[i].second, i);
+    }
+    ASSERT_EQ(wheel.ArmedCount(), 0);
+}
+
+TEST(timer_wheel_cancel_ignores_stale_handles) {
+    TimerWheel wheel;
+    auto target = std::make_shared<RecordingTarget>(wheel);
+
+    const auto cancelled = wheel.Arm(10, target, 1);
+    const auto kept = wheel.Arm(10, target, 2);
+    wheel.Cancel(cancelled);
+    wheel.Cancel(cancelled);              // Twice is harmless
+    wheel.Cancel(TimerWheel::NO_TIMER);
+
+    // The freed slot is reused - the old handle must not cancel the new timer
+    const auto reused = wheel.Arm(20, target, 3);
+    wheel.Cancel(cancelled);
+    wheel.AdvanceTo(20);
+
+    ASSERT_EQ(target->fired.size(), 2);
+    ASSERT_EQ(target->fired[0].second, 2);
+    ASSERT_EQ(target->fired[1].second, 3);
+    wheel.Cancel(kept);                   // Already fired
+    wheel.Cancel(reused);
+    ASSERT_EQ(wheel.ArmedCount(), 0);
+
+    // A callback may cancel a timer due in the same tick (Disconnect
+    // cancelling the connection's other timers) - whichever fires first wins
+    struct CancellingTarget : TimerWheel::Target {
+        explicit CancellingTarget(TimerWheel& wheel) : wheel(wheel) {}
+        void OnTimer(uint32_t tag) override {
+            fired++;
+            wheel.Cancel(handles[1 - tag]);
+        }
+        TimerWheel& wheel;
+        TimerWheel::Handle handles[2] = {};
+        int fired = 0;
+    };
+    auto pair = std::make_shared<CancellingTarget>(wheel);
+    pair->handles[0] = wheel.Arm(5, pair, 0);
+    pair->handles[1] = wheel.Arm(5, pair, 1);
+    wheel.AdvanceTo(25);
+    ASSERT_EQ(pair->fired, 1);
+    ASSERT_EQ(wheel.ArmedCount(), 0);
+}
+
+TEST(timer_wheel_skips_destroyed_targets) {
+    // A connection freed without cancelling must not be called back
+    TimerWheel wheel;
+    auto alive = std::make_shared<RecordingTarget>(wheel);
+    auto doomed = std::make_shared<RecordingTarget>(wheel);
+    wheel.Arm(5, alive, 1);
+    wheel.Arm(5, doomed, 2);
+    doomed.reset();
+
+    wheel.AdvanceTo(5);
+    ASSERT_EQ(alive->fired.size(), 1);
+    ASSERT_EQ(wheel.ArmedCount(), 0);
+}
+
+/// Re-arms itself like a connection's ping timer, and cancels its partner
+/// timer on the last round like Disconnect() does
+struct RearmingTarget : TimerWheel::Target, std::enable_shared_from_this<RearmingTarget> {
+    RearmingTarget(TimerWheel& wheel, uint64_t interval) : wheel(wheel), interval(interval) {}
+
+    void OnTimer(uint32_t tag) override {
+        if (tag == 1) { idle_fired = true; return; }
+        if (++rounds < 3) wheel.Arm(interval, weak_from_this(), 0);
+        else wheel.Cancel(idle);
+    }
+
+    TimerWheel& wheel;
+    uint64_t interval;
+    TimerWheel::Handle idle = TimerWheel::NO_TIMER;
+    int rounds = 0;
+    bool idle_fired = false;
+};
+
+TEST(timer_wheel_handles_50k_connections) {
+    TimerWheel wheel;
+    constexpr size_t CONNECTIONS = 50000;
+    std::vector<std::shared_ptr<RearmingTarget>> connections;
+    connections.reserve(CONNECTIONS);
+    for (size_t i = 0; i < CONNECTIONS; i++) {
+        // Ping every 100 ticks staggered by id, idle deadline on the last ping's tick
+        const uint64_t interval = 100;
+        auto connection = std::make_shared<RearmingTarget>(wheel, interval);
+        wheel.Arm(interval + i % interval, connection, 0);
+        connection->idle = wheel.Arm(3 * interval + i % interval + 1, connection, 1);
+        connections.push_back(connection);
+    }
+    ASSERT_EQ(wheel.ArmedCount(), CONNECTIONS * 2);
+
+    const auto start = std::chrono::steady_clock::now();
+    wheel.AdvanceTo(1000);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (const auto& connection : connections) {
+        ASSERT_EQ(connection->rounds, 3);
+        ASSERT_FALSE(connection->idle_fired);
+    }
+    ASSERT_EQ(wheel.ArmedCount(), 0);
+    // 250k arm/fire/cancel operations - generous bound for debug/sanitizer builds
+    ASSERT_TRUE(elapsed < std::chrono::seconds(2));
+}
+
+// =============================================================================
+// TickScheduler Tests - Fixed-Timestep Game Loop Pacing
+// =============================================================================
+
+TEST(tick_scheduler_deadlines_do_not_drift) {
+    TickScheduler scheduler({.tps = 20});
+    const auto interval = std::chrono::milliseconds(50);
+    const auto t0 = TickScheduler::Clock::now();
+    scheduler.Start(t0);
+
+    ASSERT_TRUE(scheduler.NextDeadline(t0) == t0);
+    // Every tick "wakes" 3ms late and works 10ms - deadlines stay on the grid
+    for (int n = 1; n <= 1000; n++) {
+        const auto finished = t0 + interval * (n - 1) + std::chrono::milliseconds(13);
+        ASSERT_TRUE(scheduler.NextDeadline(finished) == t0 + interval * n);
+    }
+    ASSERT_EQ(scheduler.CurrentTick(), 1000);
+    ASSERT_EQ(scheduler.MissedDeadlines(), 0);
+    ASSERT_EQ(scheduler.SkippedTicks(), 0);
+}
+
+TEST(tick_scheduler_skip_realigns_after_overrun) {
+    TickScheduler scheduler({.tps = 20, .catch_up = TickScheduler::CatchUp::Skip});
+    const auto interval = std::chrono::milliseconds(50);
+    const auto t0 = TickScheduler::Clock::now();
+    scheduler.Start(t0);
+    scheduler.NextDeadline(t0);
+    scheduler.NextDeadline(t0 + std::chrono::milliseconds(10));  // Tick 1
+
+    // Tick 1 ran until 210ms: ticks 2 and 3 are dropped, tick 4 starts now
+    const auto late = t0 + interval * 4 + std::chrono::milliseconds(10);
+    ASSERT_TRUE(scheduler.NextDeadline(late) == t0 + interval * 4);
+    ASSERT_EQ(scheduler.MissedDeadlines(), 1);
+    ASSERT_EQ(scheduler.SkippedTicks(), 2);
+
+    // Back on the grid
+    ASSERT_TRUE(scheduler.NextDeadline(late + std::chrono::milliseconds(5)) == t0 + interval * 5);
+    ASSERT_EQ(scheduler.MissedDeadlines(), 1);
+}
+
+TEST(tick_scheduler_burst_replays_bounded_backlog) {
+    TickScheduler scheduler({.tps = 20, .catch_up = TickScheduler::CatchUp::Burst, .max_burst_ticks = 5});
+    const auto interval = std::chrono::milliseconds(50);
+    const auto t0 = TickScheduler::Clock::now();
+    scheduler.Start(t0);
+    scheduler.NextDeadline(t0);
+
+    // Tick 0 ran until 151ms: ticks 1-3 run back-to-back, none skipped
+    const auto late = t0 + interval * 3 + std::chrono::milliseconds(1);
+    for (int n = 1; n <= 3; n++) {
+        ASSERT_TRUE(scheduler.NextDeadline(late) == t0 + interval * n);
+    }
+    ASSERT_TRUE(scheduler.NextDeadline(late) == t0 + interval * 4);  // Caught up, waits
+    ASSERT_EQ(scheduler.MissedDeadlines(), 3);
+    ASSERT_EQ(scheduler.SkippedTicks(), 0);
+
+    // A 5s stall replays only the newest 5 ticks
+    const auto stalled = t0 + interval * 100 + std::chrono::milliseconds(1);
+    ASSERT_TRUE(scheduler.NextDeadline(stalled) == t0 + interval * 96);
+    ASSERT_EQ(scheduler.SkippedTicks(), 91);
+}
+
+TEST(tick_scheduler_real_sleep_keeps_rate) {
+    TickScheduler scheduler({.tps = 200, .spin = std::chrono::microseconds(500)});
+    const auto t0 = TickScheduler::Clock::now();
+    scheduler.Start(t0);
+
+    for (int i = 0; i <= 20; i++) {
+        const auto jitter = scheduler.WaitForNextTick();
+        ASSERT_TRUE(jitter.count() >= 0);
+    }
+    // 20 intervals of 5ms, measured from the anchor rather than summed sleeps
+    const auto elapsed = TickScheduler::Clock::now() - t0;
+    ASSERT_TRUE(elapsed >= std::chrono::milliseconds(100));
+    ASSERT_TRUE(elapsed < std::chrono::milliseconds(150));
+}
+
+// =============================================================================
+// JobSystem Tests - Work-Stealing Parallel Tick Work
+// =============================================================================
+
+TEST(job_system_parallel_for_covers_each_index_once) {
+    for (size_t workers : {size_t{0}, size_t{3}}) {
+        JobSystem jobs(workers);
+        std::vector<std::atomic<int>> hits(10000);
+        jobs.ParallelFor(hits.size(), 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) hits[i].fetch_add(1, std::memory_order_relaxed);
+        });
+        for (const auto& hit : hits) ASSERT_EQ(hit.load(), 1);
+
+        jobs.ParallelFor(0, 16, [&](size_t, size_t) { ASSERT_TRUE(false); });
+    }
+}
+
+TEST(job_system_runs_dependencies_first) {
+    JobSystem jobs(3);
+    std::atomic<int> step{0};
+    std::atomic<int> b_saw{-1}, c_saw{-1}, d_saw{-1};
+
+    // Diamond: a -> (b, c) -> d
+    auto a = jobs.Schedule([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        step.fetch_add(1);
+    });
+    auto b = jobs.Schedule([&]() { b_saw = step.fetch_add(1); }, {a});
+    auto c = jobs.Schedule([&]() { c_saw = step.fetch_add(1); }, {a});
+    auto d = jobs.Schedule([&]() { d_saw = step.load(); }, {b, c});
+    jobs.Wait(d);
+
+    ASSERT_TRUE(b_saw >= 1 && c_saw >= 1);
+    ASSERT_EQ(d_saw.load(), 3);
+
+    // A throwing job surfaces at Wait, and its dependents still run
+    auto bad = jobs.Schedule([]() { throw std::runtime_error("job failed"); });
+    auto after = jobs.Schedule([]() {}, {bad});
+    ASSERT_THROWS(jobs.Wait(bad), std::runtime_error);
+    jobs.Wait(after);
+    ASSERT_TRUE(after->Done());
+}
+
+TEST(job_system_idle_workers_steal_spawned_jobs) {
+    JobSystem jobs(4);
+    std::atomic<int> done{0};
+
+    // One job fans out onto its worker's own deque; the others must steal
+    auto root = jobs.Schedule([&]() {
+        std::vector<JobSystem::Handle> children;
+        for (int i = 0; i < 64; i++) {
+            children.push_back(jobs.Schedule([&]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+                done.fetch_add(1);
+            }));
+        }
+        for (const auto& child : children) jobs.Wait(child);
+    });
+    // Don't help: a root run here would spawn onto the shared queue instead
+    while (!root->Done()) std::this_thread::yield();
+    jobs.Wait(root);
+
+    ASSERT_EQ(done.load(), 64);
+    ASSERT_TRUE(jobs.StealCount() > 0);
+}
+
+TEST(thread_owner_allows_reads_only_from_joined_jobs) {
+#ifdef NDEBUG
+    std::cout << "(skipped: release build) ";
+#else
+    ThreadOwner owner;
+    owner.SetOwner();
+    JobSystem jobs(2);
+
+    // Inside ParallelFor: reads allowed on every thread, writes on none
+    std::atomic<int> readable{0}, writable{0};
+    jobs.ParallelFor(64, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (owner.CanReadHere()) readable.fetch_add(1);
+            if (owner.CanWriteHere()) writable.fetch_add(1);
+        }
+    });
+    ASSERT_EQ(readable.load(), 64);
+    ASSERT_EQ(writable.load(), 0);
+    ASSERT_TRUE(owner.CanWriteHere());  // Back on the owner, outside any job
+
+    // A job the owner is NOT waiting on may not read
+    std::atomic<bool> release{false};
+    std::atomic<int> unjoined_read{-1};
+    auto job = jobs.Schedule([&]() {
+        unjoined_read = owner.CanReadHere() ? 1 : 0;
+        while (!release.load()) std::this_thread::yield();
+    });
+    while (unjoined_read.load() < 0) std::this_thread::yield();
+    release = true;
+    jobs.Wait(job);
+    ASSERT_EQ(unjoined_read.load(), 0);
+
+    // Nor may a plain thread
+    bool plain_read = true;
+    std::thread([&]() { plain_read = owner.CanReadHere(); }).join();
+    ASSERT_FALSE(plain_read);
+#endif
+}
+
+// =============================================================================
+// TickDelta Tests - Pipelined Tick Output
+// =============================================================================
+
+TEST(tick_delta_copies_records_at_add_time) {
+    auto a = std::make_shared<Player>(1, 10, 20, 2);
+    auto b = std::make_shared<Player>(2, 30, 40, 4);
+    std::vector<std::shared_ptr<Player>> first_seen{a};
+    std::vector<std::shared_ptr<Player>> known{b};
+
+    TickDelta delta;
+    delta.Begin(7, TickDelta::Clock::now());
+    delta.AddSpatial(100, first_seen, known);
+    delta.AddSpatial(101, {}, {});  // Nothing to say - no event
+    delta.AddLeft(100, 3);
+
+    // The next tick moves on; the published delta must not see it
+    a->SetFacing(6);
+
+    ASSERT_EQ(delta.tick, 7);
+    ASSERT_EQ(delta.events.size(), 2);
+    const auto &spatial = delta.events[0];
+    ASSERT_TRUE(spatial.kind == TickDelta::Kind::Spatial);
+    ASSERT_EQ(spatial.count, 2);
+    ASSERT_EQ(spatial.reliable, 1);  // First sightings lead, always TCP
+    const auto records = delta.RecordsOf(spatial);
+    ASSERT_EQ(records[0].player_id, 1);
+    ASSERT_EQ(records[0].facing, 2);
+    ASSERT_EQ(records[1].x, 30);
+    ASSERT_TRUE(delta.events[1].kind == TickDelta::Kind::Left);
+    ASSERT_EQ(delta.events[1].player_id, 3);
+
+    delta.Begin(8, TickDelta::Clock::now());
+    ASSERT_TRUE(delta.Empty());
+    ASSERT_TRUE(delta.records.empty());
+}
+
+TEST(tick_delta_groups_by_client_in_tick_order) {
+    auto p = std::make_shared<Player>(5, 1, 1);
+    std::vector<std::shared_ptr<Player>> players{p};
+
+    // Client 2 learns player 5 left, then sees it again - the order matters
+    TickDelta delta;
+    delta.AddLeft(2, 5);
+    delta.AddSpatial(1, players);
+    delta.AddSpatial(2, players);
+    delta.AddLeft(1, 9);
+    delta.AddLeft(2, 6);
+
+    std::vector<uint32_t> order;
+    delta.GroupByClient(order);
+    ASSERT_EQ(order.size(), 5);
+    ASSERT_EQ(order[0], 1);  // Client 1: spatial, then left
+    ASSERT_EQ(order[1], 3);
+    ASSERT_EQ(order[2], 0);  // Client 2: left, spatial, left
+    ASSERT_EQ(order[3], 2);
+    ASSERT_EQ(order[4], 4);
+}
+
+TEST(tick_delta_pipeline_bounds_in_flight_and_recycles) {
+    TickDeltaPipeline pipeline;
+    for (size_t i = 0; i < TickDeltaPipeline::MAX_IN_FLIGHT; i++) {
+        auto delta = pipeline.Acquire();
+        delta->tick = i;
+        ASSERT_FALSE(pipeline.Publish(std::move(delta)));  // Room left, no stall
+    }
+
+    // The next publish must wait until the encoder takes one
+    std::atomic<bool> published{false};
+    std::thread producer([&]() {
+        auto delta = pipeline.Acquire();
+        delta->tick = 99;
+        const bool stalled = pipeline.Publish(std::move(delta));
+        published = stalled;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_FALSE(published.load());
+
+    auto first = pipeline.Take();
+    ASSERT_EQ(first->tick, 0);
+    producer.join();
+    ASSERT_TRUE(published.load());
+
+    // Recycled deltas come back from Acquire
+    TickDelta *recycled = first.get();
+    pipeline.Recycle(std::move(first));
+    ASSERT_TRUE(pipeline.Acquire().get() == recycled);
+
+    // Stop still hands out everything published before it, in order
+    pipeline.Stop();
+    ASSERT_EQ(pipeline.Take()->tick, 1);
+    ASSERT_EQ(pipeline.Take()->tick, 99);
+    ASSERT_TRUE(pipeline.Take() == nullptr);
+}
+
+// =============================================================================
+// Zone Tests - Per-Map Handoff
+// =============================================================================
+
+TEST(warp_command_fits_ring_slot) {
+    const GameCommand warp = GameCommand::Warp(42, 3, -5, 300);
+    ASSERT_TRUE(warp.type == GameCommand::Type::Warp);
+    ASSERT_EQ(warp.client_id, 42);
+    ASSERT_EQ(warp.warp.map_id, 3);
+    ASSERT_EQ(warp.warp.x, -5);
+    ASSERT_EQ(warp.warp.y, 300);
+    ASSERT_FALSE(warp.IsCritical());  // An input like any other - may be dropped
+    ASSERT_EQ(sizeof(GameCommand), 16);
+}
+
+TEST(player_registry_adopts_player_under_same_id) {
+    PlayerRegistry source;
+    auto original = source.CreatePlayer(100, 10, 10);
+    ASSERT_TRUE(original != nullptr);
+
+    // The target zone builds its own Player with the same ID
+    PlayerRegistry target;
+    auto adopted = target.AdoptPlayer(100, original->GetID(), 20, 30, 4);
+    ASSERT_TRUE(adopted != nullptr);
+    ASSERT_TRUE(adopted != original);
+    ASSERT_EQ(adopted->GetID(), original->GetID());
+    ASSERT_EQ(adopted->GetClientID(), 100);
+    ASSERT_EQ(adopted->GetX(), 20);
+    ASSERT_EQ(adopted->GetFacing(), 4);
+    ASSERT_TRUE(target.GetByClientID(100) == adopted);
+    ASSERT_EQ(target.Count(), 1);
+
+    // A second arrival for the same client or ID is refused
+    ASSERT_TRUE(target.AdoptPlayer(100, 999, 1, 1, 2) == nullptr);
+    ASSERT_TRUE(target.AdoptPlayer(101, original->GetID(), 1, 1, 2) == nullptr);
+    ASSERT_EQ(target.Count(), 1);
+}
+
+TEST(world_find_open_tile_skips_taken_tiles) {
+    World world(32, 32);
+    PlayerRegistry players;
+    world.GetMap().SetTileBlocked(10, 10, true);
+    auto player = players.CreatePlayer(1, 11, 10);
+    world.AddPlayer(player->GetHandle(), 11, 10, player);
+
+    // Free tile: unchanged
+    int16_t x = 5, y = 5;
+    ASSERT_TRUE(world.FindOpenTile(x, y));
+    ASSERT_EQ(x, 5);
+    ASSERT_EQ(y, 5);
+
+    // Blocked centre: moves to the first ring, never onto the player
+    x = 10; y = 10;
+    ASSERT_TRUE(world.FindOpenTile(x, y));
+    ASSERT_TRUE(std::max(std::abs(x - 10), std::abs(y - 10)) == 1);
+    ASSERT_FALSE(x == 11 && y == 10);
+
+    // The warping player's own tile counts as open
+    x = 11; y = 10;
+    ASSERT_TRUE(world.FindOpenTile(x, y, player->GetHandle()));
+    ASSERT_EQ(x, 11);
+
+    // Nothing open within range: fails, leaves the position alone
+    x = 10; y = 10;
+    ASSERT_FALSE(world.FindOpenTile(x, y, SlotHandle::NONE, 0));
+    ASSERT_EQ(x, 10);
+}
+
+TEST(tick_delta_holds_transfers_until_next_tick) {
+    TickDelta delta;
+    delta.Begin(1, TickDelta::Clock::now());
+    delta.transfers.push_back(ZoneTransfer{100, 7, 0, 2, 5, 5, 2, "warper"});
+    ASSERT_FALSE(delta.Empty());  // Must still be published and encoded
+
+    delta.Begin(2, TickDelta::Clock::now());
+    ASSERT_TRUE(delta.Empty());
+}
+
+TEST(zones_forward_disconnects_without_waiting_on_full_rings) {
+    // Headless like DyeWarsReplay: no zone threads, this thread ticks both
+    ServerConfig config;
+    config.headless = true;
+    config.zones = 2;
+    IoContextPool io_pool(1);
+    GameServer server(io_pool, config);
+    ZoneManager &zones = server.Zones();
+    Zone &zone_a = *zones.Get(0);
+    Zone &zone_b = *zones.Get(1);
+
+    const uint64_t client_a = 100;
+    const uint64_t client_b = 200;
+    server.Clients().AddFakeClient(std::make_shared<FakeClientConnection>(client_a));
+    server.Clients().AddFakeClient(std::make_shared<FakeClientConnection>(client_b));
+    zone_a.QueueCommand(GameCommand::Login(client_a));
+    zone_b.QueueCommand(GameCommand::Login(client_b));
+    zone_a.RunTick();
+    zone_b.RunTick();
+    ASSERT_EQ(zone_a.PlayerCount(), 1);
+    ASSERT_EQ(zone_b.PlayerCount(), 1);
+
+    // Each zone is told about the other zone's client, then both rings
+    // fill up (more than the 64k ring holds; the rest are dropped)
+    zone_a.QueueCommand(GameCommand::Disconnect(client_b));
+    zone_b.QueueCommand(GameCommand::Disconnect(client_a));
+    for (int i = 0; i < 70000; i++) {
+        zone_a.QueueCommand(GameCommand::Turn(999, 2));
+        zone_b.QueueCommand(GameCommand::Turn(999, 2));
+    }
+
+    // Both forward into a full ring; neither tick may wait for the other
+    zone_a.RunTick();
+    zone_b.RunTick();
+
+    // The forwarded disconnects run at the next tick start
+    zone_a.RunTick();
+    zone_b.RunTick();
+    ASSERT_EQ(zone_a.PlayerCount(), 0);
+    ASSERT_EQ(zone_b.PlayerCount(), 0);
+    ASSERT_FALSE(zones.RouteOf(client_a).has_value());
+    ASSERT_FALSE(zones.RouteOf(client_b).has_value());
+
+    server.Shutdown();
+}
+
+// =============================================================================
+// SlotMap Tests - Generational Player Handles
+// =============================================================================
+
+TEST(slot_map_stale_handles_stop_resolving) {
+    SlotMap<int> map;
+    const auto first = map.Insert(10);
+    ASSERT_TRUE(first != SlotHandle::NONE);
+    ASSERT_EQ(*map.Get(first), 10);
+    ASSERT_FALSE(map.Contains(SlotHandle::NONE));
+
+    // The freed slot is reused under a new generation
+    ASSERT_TRUE(map.Erase(first));
+    ASSERT_FALSE(map.Erase(first));
+    const auto second = map.Insert(20);
+    ASSERT_EQ(SlotHandle::Index(second), SlotHandle::Index(first));
+    ASSERT_TRUE(second != first);
+    ASSERT_TRUE(map.Get(first) == nullptr);
+    ASSERT_EQ(*map.Get(second), 20);
+    ASSERT_EQ(map.SlotCount(), 1);
+}
+
+TEST(slot_map_stays_dense_after_erase) {
+    SlotMap<int> map;
+    std::vector<SlotHandle::Type> handles;
+    for (int i = 0; i < 5; i++) handles.push_back(map.Insert(i * 100));
+
+    // Erasing from the middle moves the last value into the hole
+    ASSERT_TRUE(map.Erase(handles[1]));
+    ASSERT_EQ(map.Size(), 4);
+    ASSERT_EQ(map.Values().size(), 4);
+    for (size_t i = 0; i < map.Size(); i++) {
+        ASSERT_EQ(*map.Get(map.HandleAt(i)), map.Values()[i]);
+    }
+    ASSERT_EQ(*map.Get(handles[4]), 400);
+
+    map.Clear();
+    ASSERT_TRUE(map.Empty());
+    ASSERT_TRUE(map.Get(handles[0]) == nullptr);
+}
+
+TEST(player_registry_keeps_handle_through_ghosting) {
+    PlayerRegistry players;
+    auto player = players.CreatePlayer(100, 5, 5);
+    const PlayerHandle handle = player->GetHandle();
+    ASSERT_TRUE(handle != SlotHandle::NONE);
+    ASSERT_TRUE(players.Get(handle) == player);
+
+    // Handed off: no client, still registered under the same handle
+    players.DetachClient(100);
+    player->SetGhost(true);
+    ASSERT_EQ(players.Count(), 0);
+    ASSERT_TRUE(players.GetByClientID(100) == nullptr);
+    ASSERT_TRUE(players.GetByID(player->GetID()) == player);
+
+    // Resumed here: same object, same handle
+    player->SetGhost(false);
+    ASSERT_TRUE(players.AdoptPlayer(200, player) == player);
+    ASSERT_EQ(player->GetHandle(), handle);
+    ASSERT_EQ(players.Count(), 1);
+
+    // Shard ghosts get handles but are not counted as players
+    auto ghost = std::make_shared<Player>(12345, 1, 1);
+    ghost->SetGhost(true);
+    ASSERT_TRUE(players.AddGhost(ghost) != SlotHandle::NONE);
+    ASSERT_TRUE(players.AddGhost(ghost) == SlotHandle::NONE);  // ID taken
+    ASSERT_EQ(players.Count(), 1);
+
+    players.RemovePlayer(handle);
+    ASSERT_TRUE(players.Get(handle) == nullptr);
+    ASSERT_EQ(player->GetHandle(), SlotHandle::NONE);
+}
+
+TEST(world_and_visibility_drop_stale_handles) {
+    World world(64, 64);
+    PlayerRegistry players;
+    auto a = players.CreatePlayer(1, 10, 10);
+    auto b = players.CreatePlayer(2, 12, 10);
+    world.AddPlayer(a->GetHandle(), 10, 10, a);
+    world.AddPlayer(b->GetHandle(), 12, 10, b);
+
+    ASSERT_TRUE(world.IsPositionOccupied(12, 10));
+    ASSERT_FALSE(world.IsPositionOccupied(12, 10, b->GetHandle()));
+    ASSERT_EQ(world.GetPlayersInRange(10, 10).size(), 2);
+    ASSERT_TRUE(world.Visibility().AddKnown(a->GetHandle(), b->GetHandle()));
+
+    // The cached position follows moves, in and across cells
+    b->SetPosition(30, 10);
+    world.UpdatePlayerPosition(b->GetHandle(), 30, 10);
+    ASSERT_FALSE(world.IsPositionOccupied(12, 10));
+    ASSERT_EQ(world.GetPlayersInRange(10, 10).size(), 1);
+
+    // b leaves; a new player takes its slot but none of its relationships
+    const PlayerHandle old_b = b->GetHandle();
+    world.RemovePlayer(old_b);
+    world.Visibility().RemovePlayer(old_b);
+    players.RemovePlayer(old_b);
+    auto c = players.CreatePlayer(3, 30, 10);
+    ASSERT_EQ(SlotHandle::Index(c->GetHandle()), SlotHandle::Index(old_b));
+    world.AddPlayer(c->GetHandle(), 30, 10, c);
+
+    ASSERT_TRUE(world.GetPlayer(old_b) == nullptr);
+    ASSERT_TRUE(world.GetPlayer(c->GetHandle()) == c);
+    ASSERT_TRUE(world.Visibility().GetKnownBy(c->GetHandle()) == nullptr);
+    ASSERT_EQ(world.Visibility().GetKnownPlayers(a->GetHandle())->size(), 0);
+    ASSERT_EQ(world.PlayerCount(), 2);
+}
+
+// =============================================================================
+// PlayerTable Tests - Hot/Cold Player Split
+// =============================================================================
+
+TEST(player_table_view_follows_registration) {
+    // Detached: the Player holds its own values
+    auto player = std::make_shared<Player>(77, 5, 6, 1);
+    player->SetName("Cold");
+    ASSERT_EQ(player->GetX(), 5);
+    ASSERT_EQ(player->GetFacing(), 1);
+
+    PlayerRegistry players;
+    ASSERT_TRUE(players.AdoptPlayer(9, player) == player);
+    const PlayerHandle handle = player->GetHandle();
+    const PlayerTable &table = players.Table();
+
+    // Attached: the same values now live in the registry's columns
+    ASSERT_EQ(table.ID(handle), 77);
+    ASSERT_EQ(table.ClientID(handle), 9);
+    ASSERT_EQ(table.X(handle), 5);
+    ASSERT_EQ(table.Y(handle), 6);
+
+    // Writes through the view land in the columns
+    player->SetPosition(20, 21);
+    ASSERT_TRUE(player->AttemptTurn(2, GameTime{}));
+    player->SetGhost(true);
+    ASSERT_EQ(table.X(handle), 20);
+    ASSERT_EQ(table.Y(handle), 21);
+    ASSERT_EQ(table.Facing(handle), 2);
+    ASSERT_TRUE(table.IsGhost(handle));
+
+    // Removal hands the values back and clears the row
+    players.RemovePlayer(handle);
+    ASSERT_EQ(player->GetHandle(), SlotHandle::NONE);
+    ASSERT_EQ(player->GetX(), 20);
+    ASSERT_EQ(player->GetFacing(), 2);
+    ASSERT_TRUE(player->IsGhost());
+    ASSERT_EQ(player->GetName(), "Cold");
+    ASSERT_EQ(table.X(handle), 0);
+}
+
+TEST(player_table_survives_registry_teardown) {
+    std::shared_ptr<Player> survivor;
+    {
+        PlayerRegistry players;
+        for (int i = 0; i < 40; i++) players.CreatePlayer(100 + i, i, i);  // Grows the columns
+        survivor = players.GetByClientID(117);
+        survivor->SetPosition(300, 301);
+    }
+    // The registry (and its table) is gone; the player still reads its own
+    ASSERT_EQ(survivor->GetX(), 300);
+    ASSERT_EQ(survivor->GetY(), 301);
+    ASSERT_EQ(survivor->GetClientID(), 117);
+}
+
+TEST(player_registry_dirty_flag_dedupes_marks) {
+    PlayerRegistry players;
+    auto a = players.CreatePlayer(1, 1, 1);
+    auto b = players.CreatePlayer(2, 2, 2);
+    auto stray = std::make_shared<Player>(5, 0, 0);
+
+    players.MarkDirty(a);
+    players.MarkDirty(a->GetHandle());
+    players.MarkDirty(b);
+    players.MarkDirty(stray);  // Not registered here - ignored
+    ASSERT_EQ(players.DirtyCount(), 2);
+    ASSERT_EQ(players.ConsumeDirtyPlayers().size(), 2);
+
+    // Consuming clears the flags, so the next tick can mark again
+    ASSERT_FALSE(players.HasDirtyPlayers());
+    players.MarkDirty(a);
+    ASSERT_EQ(players.DirtyCount(), 1);
+
+    // Detaching the client drops a pending mark too
+    players.DetachClient(1);
+    ASSERT_EQ(players.DirtyCount(), 0);
+    players.MarkDirty(a);
+    ASSERT_EQ(players.DirtyCount(), 1);
+}
+
+TEST(tick_delta_captures_from_table) {
+    PlayerRegistry players;
+    auto a = players.CreatePlayer(1, 3, 4, 1);
+    auto b = players.CreatePlayer(2, 5, 6, 3);
+
+    TickDelta by_player;
+    by_player.Begin(1, TickDelta::Clock::now());
+    std::vector<std::shared_ptr<Player>> first{a}, known{b};
+    by_player.AddSpatial(100, first, known);
+
+    TickDelta by_handle;
+    by_handle.Begin(1, TickDelta::Clock::now());
+    std::vector<PlayerHandle> first_handles{a->GetHandle()}, known_handles{b->GetHandle()};
+    by_handle.AddSpatial(100, players.Table(), first_handles, known_handles);
+
+    ASSERT_EQ(by_handle.events.size(), 1);
+    ASSERT_EQ(by_handle.events[0].reliable, 1);
+    ASSERT_EQ(by_handle.records.size(), by_player.records.size());
+    for (size_t i = 0; i < by_handle.records.size(); i++) {
+        ASSERT_EQ(by_handle.records[i].player_id, by_player.records[i].player_id);
+        ASSERT_EQ(by_handle.records[i].x, by_player.records[i].x);
+        ASSERT_EQ(by_handle.records[i].y, by_player.records[i].y);
+        ASSERT_EQ(by_handle.records[i].facing, by_player.records[i].facing);
+    }
+}
+
+// =============================================================================
+// Dirty List Tests - Double-Buffered Dirty Tracking
+// =============================================================================
+
+TEST(dirty_list_keeps_first_mark_order) {
+    PlayerRegistry players;
+    auto a = players.CreatePlayer(1, 1, 1);
+    auto b = players.CreatePlayer(2, 2, 2);
+    auto c = players.CreatePlayer(3, 3, 3);
+
+    players.MarkDirty(c);
+    players.MarkDirty(a);
+    players.MarkDirty(c);
+    players.MarkDirty(b);
+    players.MarkDirty(a);
+
+    const auto dirty = players.ConsumeDirtyPlayers();
+    ASSERT_EQ(dirty.size(), 3);
+    ASSERT_TRUE(dirty[0] == c);
+    ASSERT_TRUE(dirty[1] == a);
+    ASSERT_TRUE(dirty[2] == b);
+}
+
+TEST(dirty_list_swaps_buffers_between_ticks) {
+    PlayerRegistry players;
+    auto a = players.CreatePlayer(1, 1, 1);
+    std::vector<std::shared_ptr<Player>> tick;
+
+    players.MarkDirty(a);
+    players.ConsumeDirtyPlayers(tick);
+    ASSERT_EQ(tick.size(), 1);
+    const auto *first_buffer = tick.data();
+
+    // The registry got tick's old buffer; the next swap hands back the first
+    players.MarkDirty(a);
+    players.ConsumeDirtyPlayers(tick);
+    players.MarkDirty(a);
+    players.ConsumeDirtyPlayers(tick);
+    ASSERT_EQ(tick.size(), 1);
+    ASSERT_TRUE(tick.data() == first_buffer);
+
+    // Nothing marked: an empty tick
+    players.ConsumeDirtyPlayers(tick);
+    ASSERT_TRUE(tick.empty());
+}
+
+TEST(dirty_list_skips_withdrawn_marks) {
+    PlayerRegistry players;
+    auto a = players.CreatePlayer(1, 1, 1);
+    auto b = players.CreatePlayer(2, 2, 2);
+    auto c = players.CreatePlayer(3, 3, 3);
+
+    players.MarkDirty(a);
+    players.MarkDirty(b);
+    players.MarkDirty(c);
+    const PlayerHandle old_b = b->GetHandle();
+    players.RemovePlayer(old_b);             // Gone
+    players.DetachClient(3);                 // Withdrawn, then marked again
+    players.MarkDirty(c);
+    auto d = players.CreatePlayer(4, 4, 4);  // Reuses b's slot, not its mark
+    ASSERT_EQ(SlotHandle::Index(d->GetHandle()), SlotHandle::Index(old_b));
+    ASSERT_EQ(players.DirtyCount(), 2);
+
+    const auto dirty = players.ConsumeDirtyPlayers();
+    ASSERT_EQ(dirty.size(), 2);
+    ASSERT_TRUE(dirty[0] == a);
+    ASSERT_TRUE(dirty[1] == c);
+    ASSERT_FALSE(players.HasDirtyPlayers());
+}
+
+// =============================================================================
+// GameTime Tests - Tick-Domain Cooldowns
+// =============================================================================
+
+TEST(game_time_rounds_durations_down_to_ticks) {
+    GameTime now;  // 20 TPS
+    ASSERT_EQ(now.TicksFor(std::chrono::milliseconds(280)), 5);
+    ASSERT_EQ(now.TicksFor(std::chrono::milliseconds(150)), 3);
+    ASSERT_EQ(now.TicksFor(std::chrono::milliseconds(10)), 1);  // Never 0 - a cooldown always holds a tick
+    ASSERT_EQ(now.ToMilliseconds(5).count(), 250);
+
+    now.tick = 40;
+    ASSERT_EQ(now.TicksSince(35), 5);
+    ASSERT_EQ(now.TicksSince(GameTime::NEVER), GameTime::NEVER);
+
+    now.tick_length = std::chrono::microseconds(1000000 / 60);
+    ASSERT_EQ(now.TicksFor(std::chrono::milliseconds(280)), 16);
+}
+
+TEST(game_time_move_cooldown_counts_ticks) {
+    const TileMap map(32, 32);
+    Player player(1, 10, 10, 0);
+    GameTime now{.tick = 100};
+
+    // First move ever: no cooldown to wait for
+    ASSERT_TRUE(player.CheckMoveCooldown(now));
+    ASSERT_TRUE(player.AttemptMove(0, 0, map, now) == MoveResult::Success);
+    ASSERT_FALSE(player.CheckMoveCooldown(now));
+
+    // 280ms = 5 ticks, however much wall time passed
+    now.tick = 104;
+    ASSERT_TRUE(player.AttemptMove(0, 0, map, now) == MoveResult::OnCooldown);
+    ASSERT_EQ(player.TimeUntilCanMove(now).count(), 50);
+    now.tick = 105;
+    ASSERT_EQ(player.TimeUntilCanMove(now).count(), 0);
+    ASSERT_TRUE(player.AttemptMove(0, 0, map, now) == MoveResult::Success);
+    ASSERT_EQ(player.GetY(), 12);
+
+    // Ping shortens it to the 200ms floor (4 ticks) and no further
+    now.tick = 109;
+    ASSERT_TRUE(player.AttemptMove(0, 0, map, now, 1000) == MoveResult::Success);
+    now.tick = 112;
+    ASSERT_TRUE(player.AttemptMove(0, 0, map, now, 1000) == MoveResult::OnCooldown);
+}
+
+TEST(game_time_turn_cooldown_counts_ticks) {
+    Player player(1, 10, 10, 0);
+    GameTime now{.tick = 7};
+
+    ASSERT_TRUE(player.AttemptTurn(1, now));
+    ASSERT_FALSE(player.AttemptTurn(2, now));  // Same tick
+    now.tick = 9;
+    ASSERT_FALSE(player.AttemptTurn(2, now));  // 150ms = 3 ticks
+    now.tick = 10;
+    ASSERT_TRUE(player.AttemptTurn(2, now));
+    ASSERT_EQ(player.GetFacing(), 2);
+}
+
+TEST(seeded_registries_repeat_player_ids) {
+    PlayerRegistry first, second;
+    first.Seed(42);
+    second.Seed(42);
+    for (uint64_t client = 1; client <= 3; client++) {
+        auto a = first.CreatePlayer(client, 1, 1);
+        auto b = second.CreatePlayer(client, 1, 1);
+        ASSERT_EQ(a->GetID(), b->GetID());
+    }
+}
+
+// =============================================================================
+// InputLog Tests - Command Capture
+// =============================================================================
+
+TEST(input_log_round_trips_every_kind) {
+    const std::string path = "test_input_log.dwil";
+    {
+        InputLog log(path, {.tps = 30, .deterministic = true, .seed = 77, .zones = 2, .open_warps = true});
+        InputLog::TickBlock block;
+        block.Add(GameCommand::Login(5));
+        block.Add(GameCommand::Move(5, 2, 3));
+        block.Add(GameCommand::Turn(5, 1));
+        block.AddSpawnBots(250, true);
+        log.Write(0, 1, block);
+        block.Clear();
+
+        block.Add(GameCommand::Warp(5, 1, 12, -3));
+        block.AddRemoveBots();
+        block.Add(GameCommand::Disconnect(5));
+        log.Write(1, 4, block);
+    }
+
+    const auto capture = InputLogFormat::ReadFile(path);
+    fs::remove(path);
+    ASSERT_EQ(capture.header.tps, 30);
+    ASSERT_TRUE(capture.header.deterministic);
+    ASSERT_EQ(capture.header.seed, 77);
+    ASSERT_EQ(capture.header.zones, 2);
+    ASSERT_TRUE(capture.header.open_warps);
+    ASSERT_EQ(capture.entries.size(), 7);
+
+    const auto& e = capture.entries;
+    ASSERT_TRUE(e[0].kind == InputLogFormat::Kind::Login);
+    ASSERT_EQ(e[0].command.client_id, 5);
+    ASSERT_EQ(e[0].tick, 1);
+    ASSERT_TRUE(e[1].kind == InputLogFormat::Kind::Move);
+    ASSERT_EQ(e[1].command.move.direction, 2);
+    ASSERT_EQ(e[1].command.move.facing, 3);
+    ASSERT_EQ(e[2].command.turn.facing, 1);
+    ASSERT_TRUE(e[3].kind == InputLogFormat::Kind::SpawnBots);
+    ASSERT_EQ(e[3].bot_count, 250);
+    ASSERT_TRUE(e[3].clustered);
+
+    ASSERT_EQ(e[4].map_id, 1);
+    ASSERT_EQ(e[4].tick, 4);
+    ASSERT_EQ(e[4].command.warp.map_id, 1);
+    ASSERT_EQ(e[4].command.warp.x, 12);
+    ASSERT_EQ(e[4].command.warp.y, -3);
+    ASSERT_TRUE(e[5].kind == InputLogFormat::Kind::RemoveBots);
+    ASSERT_TRUE(e[6].command.type == GameCommand::Type::Disconnect);
+}
+
+TEST(input_log_skips_empty_blocks) {
+    const std::string path = "test_input_log_empty.dwil";
+    {
+        InputLog log(path, {});
+        InputLog::TickBlock block;
+        for (uint64_t tick = 1; tick <= 100; tick++) log.Write(0, tick, block);
+    }
+
+    // Just the 19-byte file header: idle ticks cost nothing on disk
+    ASSERT_EQ(fs::file_size(path), 19);
+    ASSERT_TRUE(InputLogFormat::ReadFile(path).entries.empty());
+    fs::remove(path);
+}
+
+TEST(input_log_rejects_bad_files) {
+    const std::string path = "test_input_log_bad.dwil";
+    ASSERT_THROWS(InputLogFormat::ReadFile("/nonexistent/capture.dwil"), std::runtime_error);
+
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "DWTR not an input log";
+    }
+    ASSERT_THROWS(InputLogFormat::ReadFile(path), std::runtime_error);
+
+    // Cut off inside the only entry
+    {
+        InputLog log(path, {});
+        InputLog::TickBlock block;
+        block.Add(GameCommand::Move(9, 1, 1));
+        log.Write(0, 1, block);
+    }
+    fs::resize_file(path, fs::file_size(path) - 1);
+    ASSERT_THROWS(InputLogFormat::ReadFile(path), std::out_of_range);
+    fs::remove(path);
+}
+
+// =============================================================================
+// CollisionGrid Tests - Packed Blocking Bits
+// =============================================================================
+
+TEST(collision_grid_blocks_outside_the_map) {
+    CollisionGrid grid(70, 3);  // Rows span two words
+    ASSERT_FALSE(grid.IsBlocked(0, 0));
+    ASSERT_FALSE(grid.IsBlocked(69, 2));
+    ASSERT_TRUE(grid.IsBlocked(-1, 0));
+    ASSERT_TRUE(grid.IsBlocked(70, 1));
+    ASSERT_TRUE(grid.IsBlocked(5, -1));
+    ASSERT_TRUE(grid.IsBlocked(5, 3));
+    ASSERT_TRUE(grid.IsBlocked(-500, 9000));
+
+    // The border can't be opened
+    grid.Set(-1, 0, CollisionGrid::Layer::Static, false);
+    grid.Set(70, 0, CollisionGrid::Layer::Dynamic, false);
+    ASSERT_TRUE(grid.IsBlocked(-1, 0));
+    ASSERT_TRUE(grid.IsBlocked(70, 0));
+    ASSERT_TRUE(grid.AnyBlockedInRect(60, 0, 11, 1));
+    ASSERT_FALSE(grid.AnyBlockedInRect(0, 0, 70, 3));
+}
+
+TEST(collision_grid_layers_or_on_read) {
+    TileMap map(16, 16);
+    map.SetTile(3, 3, TileTypes::Wall);
+    map.SetTileBlocked(5, 5, true);
+    ASSERT_TRUE(map.IsTileBlocked(3, 3));
+    ASSERT_TRUE(map.IsTileBlocked(5, 5));
+
+    // A dynamic clear doesn't open a wall
+    map.SetTileBlocked(3, 3, false);
+    ASSERT_TRUE(map.IsTileBlocked(3, 3));
+
+    // Rebuilding from tile types keeps dynamic blockers
+    map.SetTile(3, 3, TileTypes::Grass);
+    map.RecalculateBlocking();
+    ASSERT_FALSE(map.IsTileBlocked(3, 3));
+    ASSERT_TRUE(map.IsTileBlocked(5, 5));
+    map.SetTileBlocked(5, 5, false);
+    ASSERT_FALSE(map.IsTileBlocked(5, 5));
+}
+
+TEST(collision_grid_queries_match_per_tile_checks) {
+    const int16_t width = 200, height = 40;
+    CollisionGrid grid(width, height);
+    std::mt19937 rng(7);
+    for (int16_t y = 0; y < height; y++) {
+        for (int16_t x = 0; x < width; x++) {
+            if (rng() % 100 < 3) grid.Set(x, y, CollisionGrid::Layer::Static, true);
+            if (rng() % 100 < 3) grid.Set(x, y, CollisionGrid::Layer::Dynamic, true);
+        }
+    }
+    // Long blocked runs, so row scans skip whole words
+    for (int16_t x = 10; x < 190; x++) grid.Set(x, 20, CollisionGrid::Layer::Static, true);
+
+    for (int i = 0; i < 5000; i++) {
+        // Overhanging the map on every side
+        const auto x = static_cast<int16_t>(static_cast<int>(rng() % (width + 20)) - 10);
+        const auto y = static_cast<int16_t>(static_cast<int>(rng() % (height + 20)) - 10);
+        const auto w = static_cast<int16_t>(rng() % 150);
+        const auto h = static_cast<int16_t>(rng() % 4);
+
+        bool any = false;
+        for (int16_t cy = y; cy < y + h; cy++) {
+            for (int16_t cx = x; cx < x + w; cx++) any |= grid.IsBlocked(cx, cy);
+        }
+        ASSERT_EQ(grid.AnyBlockedInRect(x, y, w, h), any);
+
+        int16_t first = CollisionGrid::NONE;
+        for (int16_t cx = x; cx < x + w; cx++) {
+            if (!grid.IsBlocked(cx, y)) {
+                first = cx;
+                break;
+            }
+        }
+        ASSERT_EQ(grid.FirstFreeInRow(y, x, static_cast<int16_t>(x + w - 1)), first);
+    }
+    ASSERT_EQ(grid.FirstFreeInRow(20, 10, 189), CollisionGrid::NONE);
+}
+
+// =============================================================================
+// MapStreamer Tests - Chunked Map Streaming
+// =============================================================================
+
+/// S_Tile_Data chunks a delta sends `client_id`, decoded, in order
+static std::vector<TileChunkCodec::Chunk> ChunksSent(const TickDelta &delta, uint64_t client_id) {
+    std::vector<TileChunkCodec::Chunk> chunks;
+    for (const auto &event : delta.events) {
+        if (event.kind != TickDelta::Kind::Raw || event.client_id != client_id) continue;
+        const auto payload = std::span<const uint8_t>(*delta.raw[event.first]).subspan(4);  // Frame header
+        if (payload[0] == Protocol::Opcode::Map::Server::S_Tile_Data.op) chunks.push_back(TileChunkCodec::Decode(payload));
+    }
+    return chunks;
+}
+
+TEST(tile_chunk_codec_round_trips) {
+    TileMap map(70, 40);  // Edge chunks are 6 wide, 8 tall
+    map.SetMapID(3);
+    for (int16_t x = 32; x < 64; x++) map.SetTile(x, 5, TileTypes::Wall);
+    map.SetTile(40, 10, TileTypes::Default);
+    for (int i = 0; i < 40; i++) {  // 40 tile types in one chunk
+        map.SetTile(static_cast<int16_t>(i % 32), static_cast<int16_t>(32 + i / 32), static_cast<uint8_t>(0x10 + i));
+    }
+
+    std::vector<uint8_t> scratch, expected;
+    for (int16_t cy = 0; cy < map.ChunksY(); cy++) {
+        for (int16_t cx = 0; cx < map.ChunksX(); cx++) {
+            const auto bytes = TileChunkCodec::Encode(map, cx, cy, scratch);
+            const auto chunk = TileChunkCodec::Decode(std::span<const uint8_t>(bytes).subspan(4));
+            const auto width = static_cast<int16_t>(std::min(32, 70 - cx * 32));
+            const auto height = static_cast<int16_t>(std::min(32, 40 - cy * 32));
+            map.CopyRegionTiles(static_cast<int16_t>(cx * 32), static_cast<int16_t>(cy * 32), width, height, expected);
+            ASSERT_EQ(chunk.map_id, 3);
+            ASSERT_EQ(chunk.chunk_x, cx);
+            ASSERT_EQ(chunk.chunk_y, cy);
+            ASSERT_EQ(chunk.width, width);
+            ASSERT_EQ(chunk.height, height);
+            ASSERT_TRUE(chunk.tiles == expected);
+        }
+    }
+
+    // Uniform: palette only. Mixed: one byte per run. Many types: two.
+    ASSERT_EQ(TileChunkCodec::Encode(map, 2, 1, scratch).size(), 21u);
+    ASSERT_EQ(TileChunkCodec::Decode(std::span<const uint8_t>(TileChunkCodec::Encode(map, 1, 0, scratch)).subspan(4)).palette_size, 3);
+    ASSERT_EQ(TileChunkCodec::Decode(std::span<const uint8_t>(TileChunkCodec::Encode(map, 0, 1, scratch)).subspan(4)).palette_size, 41);
+
+    // Truncated or out-of-palette runs are rejected
+    auto bytes = TileChunkCodec::Encode(map, 1, 0, scratch);
+    ASSERT_THROWS(TileChunkCodec::Decode(std::span<const uint8_t>(bytes).subspan(4, bytes.size() - 5)), std::out_of_range);
+    bytes[4 + 15 + 3] = 0xF0;  // First run: palette index 15 of 3
+    ASSERT_THROWS(TileChunkCodec::Decode(std::span<const uint8_t>(bytes).subspan(4)), std::runtime_error);
+
+    // Regions overhanging the map are padded with Void
+    const auto region = map.GetRegionTiles(-1, -1, 3, 3);
+    ASSERT_EQ(region[0], TileTypes::Void);
+    ASSERT_EQ(region[4], map.GetTile(0, 0));
+    ASSERT_EQ(region[8], map.GetTile(1, 1));
+}
+
+TEST(map_streamer_sends_only_missing_chunks) {
+    TileMap map(128, 128);
+    MapStreamer streamer(map, 5);
+    TickDelta delta;
+    auto chunks_of = [&](uint64_t client_id) {
+        std::vector<std::pair<int, int>> coords;
+        for (const auto &chunk : ChunksSent(delta, client_id)) coords.emplace_back(chunk.chunk_x, chunk.chunk_y);
+        return coords;
+    };
+    using Coords = std::vector<std::pair<int, int>>;
+
+    // Map info first, then the one chunk around (10, 10)
+    delta.Begin(1, {});
+    streamer.Enter(delta, 7, 10, 10, 0);
+    ASSERT_EQ((*delta.raw[0])[4], Protocol::Opcode::Map::Server::S_Map_Info.op);
+    ASSERT_TRUE(chunks_of(7) == (Coords{{0, 0}}));
+
+    // Walking north, the next row is prefetched before the view gets there
+    delta.Begin(2, {});
+    streamer.Update(delta, 7, 10, 20, 0);
+    ASSERT_TRUE(chunks_of(7) == (Coords{{0, 1}}));
+    ASSERT_EQ(streamer.TakeStats().held_skips, 1u);  // (0, 0)
+
+    // Same window, then turning back: nothing new
+    delta.Begin(3, {});
+    streamer.Update(delta, 7, 10, 21, 0);
+    streamer.Update(delta, 7, 10, 10, 2);
+    ASSERT_TRUE(delta.events.empty());
+    ASSERT_EQ(streamer.TakeStats().held_skips, 1u);
+
+    // Chunks in view go before the prefetched ones (facing east)
+    delta.Begin(4, {});
+    streamer.Update(delta, 7, 50, 60, 1);
+    ASSERT_TRUE(chunks_of(7) == (Coords{{1, 1}, {1, 2}, {2, 1}, {2, 2}}));
+
+    // Clients that never entered, or left, get nothing
+    delta.Begin(5, {});
+    streamer.Update(delta, 99, 10, 10, 0);
+    streamer.Leave(7);
+    streamer.Update(delta, 7, 100, 100, 0);
+    ASSERT_TRUE(delta.events.empty());
+    ASSERT_EQ(streamer.ClientCount(), 0u);
+}
+
+TEST(map_streamer_shares_and_refreshes_encoded_chunks) {
+    TileMap map(64, 64);
+    MapStreamer streamer(map, 5);
+    TickDelta delta;
+
+    // Two clients in the same chunk share one encoded buffer
+    delta.Begin(1, {});
+    streamer.Enter(delta, 1, 10, 10, 0);
+    streamer.Enter(delta, 2, 12, 10, 0);
+    ASSERT_EQ(delta.raw.size(), 4u);
+    ASSERT_TRUE(delta.raw[1] == delta.raw[3]);
+    auto stats = streamer.TakeStats();
+    ASSERT_EQ(stats.chunks_sent, 2u);
+    ASSERT_EQ(stats.cache_misses, 1u);
+    ASSERT_EQ(stats.cache_hits, 1u);
+    ASSERT_EQ(stats.bytes_sent, 42u);  // Two uniform chunks, 21 bytes each
+    ASSERT_EQ(stats.raw_bytes, 2048u);
+
+    // Re-setting a tile to its type changes nothing
+    const uint64_t revision = map.Revision();
+    map.SetTile(5, 5, map.GetTile(5, 5));
+    ASSERT_EQ(map.Revision(), revision);
+
+    // An edit reaches clients standing still, as a new version in a new
+    // buffer (the old one may still be queued)
+    const auto old_buffer = delta.raw[1];
+    map.SetTile(5, 5, TileTypes::Wall);
+    delta.Begin(2, {});
+    streamer.SendChanged(delta);
+    const auto chunks = ChunksSent(delta, 1);
+    ASSERT_EQ(chunks.size(), 1u);
+    ASSERT_EQ(chunks[0].version, 2u);
+    ASSERT_EQ(chunks[0].tiles[5 * 32 + 5], TileTypes::Wall);
+    ASSERT_EQ(ChunksSent(delta, 2).size(), 1u);
+    ASSERT_TRUE(delta.raw[0] != old_buffer);
+    ASSERT_EQ(ChunksSent(delta, 1)[0].tiles.size(), 1024u);
+    stats = streamer.TakeStats();
+    ASSERT_EQ(stats.cache_misses, 1u);
+    ASSERT_EQ(stats.cache_hits, 1u);
+
+    delta.Begin(3, {});
+    streamer.SendChanged(delta);
+    ASSERT_TRUE(delta.events.empty());
+}
+
+// =============================================================================
+// MapFile Tests - Memory-Mapped Maps
+// =============================================================================
+
+/// A 70x40 map (partial edge chunks) with a walled room, written to a temp .dwm
+static std::string WriteTestMap(const std::string &file_name) {
+    TileMap map(70, 40);
+    map.SetMapName("town");
+    map.FillRegion(40, 0, 30, 40, TileTypes::Default);
+    for (int16_t x = 5; x < 15; x++) map.SetTile(x, 5, TileTypes::Wall);
+    const std::string path = (std::filesystem::temp_directory_path() / file_name).string();
+    MapFile::Write(path, map);
+    return path;
+}
+
+TEST(map_file_round_trips) {
+    const std::string path = WriteTestMap("dyewars_map_round_trip.dwm");
+
+    const auto header = MapFile::ReadHeader(path);
+    ASSERT_EQ(header.width, 70);
+    ASSERT_EQ(header.height, 40);
+    ASSERT_EQ(header.chunk_count, 6u);  // 3 x 2 chunks of 32
+    ASSERT_EQ(header.tiles_offset % MapFile::SECTION_ALIGNMENT, 0u);
+
+    // Chunk index: (0,0) has the walls, (2,0) is all Default
+    const auto file = MapFile::Open(path);
+    ASSERT_TRUE(file->GetName() == "town");
+    const auto index = file->ChunkIndex();
+    ASSERT_EQ(index[0].palette_size, 2);
+    ASSERT_EQ(index[0].blocking, 1);
+    ASSERT_EQ(index[2].palette_size, 1);
+    ASSERT_EQ(index[2].first_tile, TileTypes::Default);
+    ASSERT_EQ(index[2].blocking, 0);
+
+    // Loaded from the file it reads like the map that was written
+    auto loaded = TileMap::FromFile(path);
+    ASSERT_TRUE(loaded->Load());
+    ASSERT_TRUE(loaded->GetMapName() == "town");
+    ASSERT_EQ(loaded->GetTile(5, 5), TileTypes::Wall);
+    ASSERT_EQ(loaded->GetTile(50, 20), TileTypes::Default);
+    ASSERT_EQ(loaded->GetTile(20, 20), TileTypes::Grass);
+    for (int16_t y = -1; y <= 40; y++) {
+        for (int16_t x = -1; x <= 70; x++) {
+            ASSERT_EQ(loaded->IsTileBlocked(x, y), (y == 5 && x >= 5 && x < 15) || !loaded->InBounds(x, y));
+        }
+    }
+    ASSERT_TRUE(std::equal(loaded->GetRawTileData().begin(), loaded->GetRawTileData().end(),
+                           file->Tiles().begin()));
+    std::filesystem::remove(path);
+}
+
+TEST(map_file_rejects_bad_files) {
+    const std::string path = WriteTestMap("dyewars_map_bad.dwm");
+    std::vector<char> good(std::filesystem::file_size(path));
+    std::ifstream(path, std::ios::binary).read(good.data(), static_cast<std::streamsize>(good.size()));
+
+    auto write_variant = [&](size_t size, size_t patch_offset, char patch) {
+        std::vector<char> bytes(good.begin(), good.begin() + static_cast<std::ptrdiff_t>(size));
+        if (patch_offset < size) bytes[patch_offset] = patch;
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    };
+
+    write_variant(good.size(), 0, 'X');  // Magic
+    ASSERT_THROWS(MapFile::Open(path), std::runtime_error);
+    write_variant(good.size(), 4, 9);    // Version
+    ASSERT_THROWS(MapFile::Open(path), std::runtime_error);
+    write_variant(good.size() - 16, SIZE_MAX, 0);  // Truncated chunk index
+    ASSERT_THROWS(MapFile::Open(path), std::runtime_error);
+    ASSERT_THROWS(MapFile::ReadHeader(path), std::runtime_error);
+    write_variant(64, SIZE_MAX, 0);      // Shorter than a header
+    ASSERT_THROWS(MapFile::ReadHeader(path), std::runtime_error);
+
+    std::filesystem::remove(path);
+    ASSERT_THROWS(MapFile::Open(path), std::runtime_error);
+    ASSERT_THROWS(TileMap::FromFile(path), std::runtime_error);
+}
+
+TEST(tile_map_load_distrusts_file_collision_bits) {
+    const std::string path = WriteTestMap("dyewars_map_collision.dwm");
+    std::vector<char> bytes(std::filesystem::file_size(path));
+    std::ifstream(path, std::ios::binary).read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    const auto header = MapFile::ReadHeader(path);
+    auto save = [&] {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    };
+
+    // Every collision bit clear, border and padding included: off the map
+    // is still blocked
+    const size_t collision_bytes = size_t{header.collision_stride} * (header.height + 2u) * sizeof(uint64_t);
+    std::fill_n(bytes.begin() + static_cast<std::ptrdiff_t>(header.collision_offset), collision_bytes, 0);
+    save();
+    auto map = TileMap::FromFile(path);
+    ASSERT_TRUE(map->Load());
+    ASSERT_FALSE(map->StaleBlocking());
+    ASSERT_TRUE(map->IsTileBlocked(-1, 20));
+    ASSERT_TRUE(map->IsTileBlocked(70, 20));
+    ASSERT_TRUE(map->IsTileBlocked(20, -1));
+    ASSERT_TRUE(map->IsTileBlocked(20, 40));
+    ASSERT_FALSE(map->IsTileBlocked(20, 20));
+
+    // Built with another blocking table: rebuilt from the tiles
+    const uint64_t other_table = TileTypes::BlockingTableHash() ^ 1;
+    std::memcpy(bytes.data() + offsetof(MapFile::Header, blocking_hash), &other_table, sizeof(other_table));
+    save();
+    map = TileMap::FromFile(path);
+    ASSERT_TRUE(map->Load());
+    ASSERT_TRUE(map->StaleBlocking());
+    ASSERT_TRUE(map->IsTileBlocked(5, 5));
+    ASSERT_FALSE(map->IsTileBlocked(20, 20));
+    ASSERT_TRUE(map->IsTileBlocked(-1, 20));
+    ASSERT_FALSE(map->IsModified());
+    std::filesystem::remove(path);
+}
+
+TEST(tile_map_loads_lazily_and_releases) {
+    const std::string path = WriteTestMap("dyewars_map_lazy.dwm");
+
+    // Released until Load(): void and blocked, edits ignored
+    auto map = TileMap::FromFile(path);
+    ASSERT_FALSE(map->IsResident());
+    ASSERT_EQ(map->GetWidth(), 70);
+    ASSERT_EQ(map->GetTile(20, 20), TileTypes::Void);
+    ASSERT_TRUE(map->IsTileBlocked(20, 20));
+    ASSERT_TRUE(map->GetRawTileData().empty());
+    map->SetTile(20, 20, TileTypes::Wall);
+    ASSERT_FALSE(map->IsModified());
+
+    // Loading moves every chunk version on, so streamed copies are re-sent
+    ASSERT_TRUE(map->Load());
+    ASSERT_FALSE(map->Load());
+    ASSERT_TRUE(map->IsMapped());
+    ASSERT_EQ(map->ChunkVersion(0, 0), 2u);
+    ASSERT_FALSE(map->IsTileBlocked(20, 20));
+
+    ASSERT_TRUE(map->Release());
+    ASSERT_EQ(map->GetTile(5, 5), TileTypes::Void);
+    ASSERT_TRUE(map->Load());
+    ASSERT_EQ(map->GetTile(5, 5), TileTypes::Wall);
+
+    // The first edit copies the tiles out: the map stays, the file is untouched
+    map->SetTile(20, 20, TileTypes::Wall);
+    ASSERT_FALSE(map->IsMapped());
+    ASSERT_TRUE(map->IsModified());
+    ASSERT_FALSE(map->Release());
+    ASSERT_EQ(map->GetTile(20, 20), TileTypes::Wall);
+    ASSERT_TRUE(map->IsTileBlocked(20, 20));
+    ASSERT_EQ(MapFile::Open(path)->Tiles()[20 * 70 + 20], TileTypes::Grass);
+
+    // Maps without a file never release
+    TileMap generated(32, 32);
+    ASSERT_FALSE(generated.Release());
+    ASSERT_TRUE(generated.IsResident());
+    std::filesystem::remove(path);
+}
+
+// =============================================================================
+// TileChangeJournal Tests - Batched Tile Edits
+// =============================================================================
+
+TEST(tile_change_journal_keeps_one_change_per_tile) {
+    TileMap map(64, 64);
+    TileChangeJournal journal(map);
+    const uint32_t chunk_version = map.ChunkVersion(0, 0);
+
+    // Three edits to one tile are one change, holding its final state
+    ASSERT_TRUE(journal.SetTile(5, 5, TileTypes::Wall));
+    ASSERT_TRUE(journal.SetTile(5, 5, TileTypes::Default));
+    ASSERT_TRUE(journal.SetBlocked(5, 5, true));
+    // A door opened and closed again in the same tick is no change
+    ASSERT_TRUE(journal.SetBlocked(40, 6, true));
+    ASSERT_TRUE(journal.SetBlocked(40, 6, false));
+    // Off the map: refused, not counted
+    ASSERT_FALSE(journal.SetTile(64, 0, TileTypes::Wall));
+    ASSERT_FALSE(journal.Apply(TileEdit{-1, 3, TileEdit::Kind::Blocked, 1}));
+    ASSERT_EQ(journal.EditCount(), 5u);
+
+    journal.Seal();
+    ASSERT_EQ(journal.Changes().size(), 1u);
+    const auto &change = journal.Changes()[0];
+    ASSERT_EQ(change.x, 5);
+    ASSERT_EQ(change.y, 5);
+    ASSERT_EQ(change.type, TileTypes::Default);
+    ASSERT_TRUE(change.blocked);
+    ASSERT_TRUE(map.IsTileBlocked(5, 5));
+
+    // Both chunks are listed with their version before the tick; the one
+    // whose edits cancelled out has no changes
+    const auto &chunks = journal.TouchedChunks();
+    ASSERT_EQ(chunks.size(), 2u);
+    ASSERT_EQ(chunks[change.chunk].index, 0u);
+    ASSERT_EQ(chunks[change.chunk].version_before, chunk_version);
+    ASSERT_EQ(chunks[change.chunk].changes, 1u);
+    ASSERT_EQ(chunks[1].index, 1u);
+    ASSERT_EQ(chunks[1].changes, 0u);
+
+    // A tile set back to its type counts as unchanged, even though the
+    // chunk's version moved on twice
+    journal.Clear();
+    ASSERT_TRUE(journal.SetTile(6, 6, TileTypes::Wall));
+    ASSERT_TRUE(journal.SetTile(6, 6, TileTypes::Grass));
+    journal.Seal();
+    ASSERT_TRUE(journal.Changes().empty());
+    ASSERT_EQ(journal.TouchedChunks().size(), 1u);
+    ASSERT_EQ(journal.TouchedChunks()[0].version_before + 2, map.ChunkVersion(0, 0));
+
+    // Nothing is edited on a released map
+    const std::string path = (std::filesystem::temp_directory_path() / "dyewars_test_journal.dwm").string();
+    MapFile::Write(path, map);
+    auto mapped = TileMap::FromFile(path);
+    TileChangeJournal released(*mapped);
+    ASSERT_FALSE(released.SetTile(1, 1, TileTypes::Wall));
+    ASSERT_EQ(released.EditCount(), 0u);
+    mapped.reset();
+    std::filesystem::remove(path);
+}
+
+TEST(tile_update_codec_round_trips) {
+    const std::vector<TileChangeJournal::Change> changes = {
+            {3, 4, TileTypes::Wall, true, 0},
+            {300, 2, TileTypes::Grass, false, 1},
+            {32767, 0, 0xAB, true, 2},
+    };
+    const auto bytes = TileChunkCodec::EncodeTileUpdate(9, changes);
+    ASSERT_EQ(bytes.size(), 4u + 5u + 6u * changes.size());
+
+    uint16_t map_id = 0;
+    const auto decoded = TileChunkCodec::DecodeTileUpdate(std::span<const uint8_t>(bytes).subspan(4), map_id);
+    ASSERT_EQ(map_id, 9);
+    ASSERT_EQ(decoded.size(), changes.size());
+    for (size_t i = 0; i < changes.size(); i++) {
+        ASSERT_EQ(decoded[i].x, changes[i].x);
+        ASSERT_EQ(decoded[i].y, changes[i].y);
+        ASSERT_EQ(decoded[i].type, changes[i].type);
+        ASSERT_EQ(decoded[i].blocked, changes[i].blocked);
+    }
+
+    // A full packet stays under the payload limit; truncated ones are rejected
+    const std::vector<TileChangeJournal::Change> full(TileChunkCodec::MAX_TILES_PER_UPDATE);
+    ASSERT_TRUE(TileChunkCodec::EncodeTileUpdate(0, full).size() - 4 < Protocol::MAX_PAYLOAD_SIZE);
+    ASSERT_THROWS(TileChunkCodec::DecodeTileUpdate(std::span<const uint8_t>(bytes).subspan(4, bytes.size() - 5), map_id),
+                  std::out_of_range);
+}
+
+TEST(map_streamer_skips_patched_chunks) {
+    TileMap map(64, 64);
+    MapStreamer streamer(map, 5);
+    TileChangeJournal journal(map);
+    TickDelta delta;
+
+    delta.Begin(1, {});
+    streamer.Enter(delta, 1, 10, 10, 0);
+    streamer.Enter(delta, 2, 12, 10, 0);
+    ASSERT_TRUE(streamer.HasClient(1));
+    ASSERT_FALSE(streamer.HasClient(3));
+
+    // Client 1 got every change to chunk (0, 0) as a tile update; client 2
+    // didn't, so only client 2 gets the chunk again
+    journal.SetTile(5, 5, TileTypes::Wall);
+    journal.SetTile(6, 5, TileTypes::Wall);
+    journal.Seal();
+    const auto &chunk = journal.TouchedChunks()[0];
+    streamer.Patched(1, chunk.index, chunk.version_before);
+    streamer.Patched(99, chunk.index, chunk.version_before);  // Unknown client: ignored
+    delta.Begin(2, {});
+    streamer.SendChanged(delta);
+    ASSERT_EQ(ChunksSent(delta, 1).size(), 0u);
+    ASSERT_EQ(ChunksSent(delta, 2).size(), 1u);
+    ASSERT_EQ(ChunksSent(delta, 2)[0].tiles[5 * 32 + 6], TileTypes::Wall);
+
+    // A copy at some other version isn't patched: it's still stale
+    journal.Clear();
+    journal.SetTile(7, 5, TileTypes::Wall);
+    journal.Seal();
+    streamer.Patched(1, journal.TouchedChunks()[0].index, journal.TouchedChunks()[0].version_before - 1);
+    delta.Begin(3, {});
+    streamer.SendChanged(delta);
+    ASSERT_EQ(ChunksSent(delta, 1).size(), 1u);
+    ASSERT_EQ(ChunksSent(delta, 2).size(), 1u);
+
+    // Edits that cancelled out: every holder is current, nothing is sent
+    journal.Clear();
+    journal.SetTile(8, 5, TileTypes::Wall);
+    journal.SetTile(8, 5, TileTypes::Grass);
+    journal.Seal();
+    streamer.PatchedAll(journal.TouchedChunks()[0].index, journal.TouchedChunks()[0].version_before);
+    delta.Begin(4, {});
+    streamer.SendChanged(delta);
+    ASSERT_TRUE(delta.events.empty());
+}
+
+TEST(map_streamer_sends_dynamic_blockers) {
+    TileMap map(64, 40);  // Chunk (1, 1) is 32x8
+    MapStreamer streamer(map, 5);
+    TileChangeJournal journal(map);
+    TickDelta delta;
+
+    delta.Begin(1, {});
+    streamer.Enter(delta, 1, 10, 10, 0);
+
+    // A door moves the chunk's version on; setting it again doesn't
+    const uint32_t version = map.ChunkVersion(0, 0);
+    journal.SetBlocked(20, 10, true);
+    journal.SetBlocked(20, 10, true);
+    ASSERT_EQ(map.ChunkVersion(0, 0), version + 1);
+    ASSERT_TRUE(map.IsTileDynamicBlocked(20, 10));
+    ASSERT_FALSE(map.IsTileDynamicBlocked(21, 10));
+    journal.Seal();
+
+    // Client 1 held the chunk without seeing the door: it gets the chunk again, door included
+    delta.Begin(2, {});
+    streamer.SendChanged(delta);
+    auto sent = ChunksSent(delta, 1);
+    ASSERT_EQ(sent.size(), 1u);
+    ASSERT_EQ(sent[0].version, version + 1);
+    ASSERT_EQ(sent[0].blocked[10 * 32 + 20], 1);
+    ASSERT_EQ(std::count(sent[0].blocked.begin(), sent[0].blocked.end(), 1), 1);
+
+    // A player arriving later gets it with the chunk
+    delta.Begin(3, {});
+    streamer.Enter(delta, 2, 12, 12, 0);
+    ASSERT_EQ(ChunksSent(delta, 2)[0].blocked[10 * 32 + 20], 1);
+
+    // Few blockers go as a list, many as a bitmap; both decode the same
+    std::vector<uint8_t> scratch;
+    const size_t listed = TileChunkCodec::Encode(map, 0, 0, scratch).size();
+    for (int16_t x = 0; x < 32; x++) {
+        for (int16_t y = 0; y < 4; y++) map.SetTileBlocked(x, static_cast<int16_t>(32 + y), true);
+    }
+    map.SetTileBlocked(5, 33, false);
+    const auto bitmap = TileChunkCodec::Encode(map, 0, 1, scratch);
+    const auto chunk = TileChunkCodec::Decode(std::span<const uint8_t>(bitmap).subspan(4));
+    ASSERT_EQ(chunk.blocked.size(), 32u * 8u);
+    ASSERT_EQ(std::count(chunk.blocked.begin(), chunk.blocked.end(), 1), 127);
+    ASSERT_EQ(chunk.blocked[1 * 32 + 5], 0);
+    ASSERT_EQ(chunk.blocked[3 * 32 + 31], 1);
+    ASSERT_EQ(bitmap.size(), 21u + 32u);  // 1 palette entry + blocker mode + 256 bits
+    ASSERT_EQ(listed, 21u + 2u + 2u);      // 1 palette entry + blocker mode + count + one x/y
+
+    // Unblocking moves the version on and empties the list
+    const uint32_t before = map.ChunkVersion(0, 0);
+    map.SetTileBlocked(20, 10, false);
+    ASSERT_EQ(map.ChunkVersion(0, 0), before + 1);
+    ASSERT_EQ(TileChunkCodec::Encode(map, 0, 0, scratch).size(), 21u);
+
+    // A blocker outside the chunk is rejected
+    map.SetTileBlocked(3, 3, true);
+    auto bytes = TileChunkCodec::Encode(map, 0, 0, scratch);
+    bytes[bytes.size() - 2] = 40;  // x
+    ASSERT_THROWS(TileChunkCodec::Decode(std::span<const uint8_t>(bytes).subspan(4)), std::runtime_error);
+}
+
+// =============================================================================
+// Instance Tests - Shared Base Maps
+// =============================================================================
+
+/// 100x70: 4x3 chunks, the right and bottom ones partial
+static std::shared_ptr<const TileMap> MakeInstanceBase() {
+    auto base = std::make_shared<TileMap>(100, 70);
+    base->CreateBorder();
+    base->SetTile(40, 40, TileTypes::Wall);
+    return base;
+}
+
+TEST(collision_grid_shares_rows_until_written) {
+    CollisionGrid base(70, 3);
+    base.Set(5, 1, CollisionGrid::Layer::Static, true);
+    CollisionGrid shared = CollisionGrid::Shared(base);
+    ASSERT_TRUE(shared.IsShared());
+    ASSERT_TRUE(shared.IsBlocked(5, 1));
+    ASSERT_TRUE(shared.IsBlocked(-1, 0));
+
+    // Writing what's there copies nothing
+    shared.Set(5, 1, CollisionGrid::Layer::Static, true);
+    shared.Set(6, 1, CollisionGrid::Layer::Dynamic, false);
+    ASSERT_EQ(shared.CopiedRows(), 0u);
+
+    shared.Set(69, 2, CollisionGrid::Layer::Dynamic, true);
+    shared.Set(5, 1, CollisionGrid::Layer::Static, false);
+    ASSERT_EQ(shared.CopiedRows(), 2u);
+    ASSERT_TRUE(shared.IsBlocked(69, 2));
+    ASSERT_FALSE(shared.IsBlocked(5, 1));
+    ASSERT_TRUE(shared.AnyBlockedInRect(60, 2, 10, 1));
+    ASSERT_EQ(shared.FirstFreeInRow(2, 69, 69), CollisionGrid::NONE);
+    ASSERT_FALSE(base.IsBlocked(69, 2));  // The base never changes
+    ASSERT_TRUE(base.IsBlocked(5, 1));
+
+    ASSERT_TRUE(shared.ResetToBase());
+    ASSERT_EQ(shared.CopiedRows(), 0u);
+    ASSERT_FALSE(shared.IsBlocked(69, 2));
+    ASSERT_TRUE(shared.IsBlocked(5, 1));
+    ASSERT_FALSE(base.ResetToBase());
+}
+
+TEST(tile_map_instance_copies_only_edited_chunks) {
+    const auto base = MakeInstanceBase();
+    auto instance = TileMap::InstanceOf(base);
+    ASSERT_TRUE(instance->IsInstance());
+    ASSERT_EQ(instance->OverlayCount(), 0u);
+    ASSERT_EQ(instance->Collision().CopiedRows(), 0u);
+    ASSERT_TRUE(instance->GetRawTileData().empty());  // Not one array
+
+    // Same tile: nothing copied
+    instance->SetTile(5, 5, TileTypes::Grass);
+    ASSERT_EQ(instance->OverlayCount(), 0u);
+    ASSERT_FALSE(instance->IsModified());
+
+    // Two chunks, one of them a partial edge chunk
+    instance->SetTile(40, 40, TileTypes::Grass);
+    instance->SetTile(99, 69, TileTypes::Grass);
+    instance->SetTileBlocked(41, 40, true);
+    ASSERT_EQ(instance->OverlayCount(), 2u);
+    ASSERT_EQ(instance->Collision().CopiedRows(), 2u);
+    ASSERT_EQ(instance->ChunkVersion(1, 1), 3u);  // The type and the blocker
+    ASSERT_EQ(instance->GetTile(99, 69), TileTypes::Grass);
+    ASSERT_FALSE(instance->IsTileBlocked(40, 40));
+    ASSERT_TRUE(instance->IsTileBlocked(41, 40));
+
+    // The base and its other instances don't see it
+    auto other = TileMap::InstanceOf(base);
+    for (const TileMap *map : {base.get(), static_cast<const TileMap *>(other.get())}) {
+        ASSERT_EQ(map->GetTile(40, 40), TileTypes::Wall);
+        ASSERT_TRUE(map->IsTileBlocked(40, 40));
+        ASSERT_FALSE(map->IsTileBlocked(41, 40));
+        ASSERT_EQ(map->GetTile(99, 69), TileTypes::Wall);
+    }
+
+    // Region reads splice overlays and base across chunk edges
+    std::vector<uint8_t> region;
+    instance->CopyRegionTiles(20, 30, 90, 45, region);
+    for (int16_t y = 0; y < 45; y++) {
+        for (int16_t x = 0; x < 90; x++) {
+            ASSERT_EQ(region[y * 90 + x], instance->GetTile(20 + x, 30 + y));
+        }
+    }
+
+    // Memory is the edits, not the map
+    ASSERT_LE(instance->InstanceBytes(), 2 * 1024 + 4096u);
+    ASSERT_LE(other->InstanceBytes(), 4096u);
+}
+
+TEST(tile_map_instance_resets_to_base) {
+    const auto base = MakeInstanceBase();
+    auto instance = TileMap::InstanceOf(base);
+    instance->FillRegion(0, 0, 100, 70, TileTypes::Default);
+    ASSERT_EQ(instance->OverlayCount(), 12u);
+    ASSERT_TRUE(instance->IsModified());
+
+    const uint64_t revision = instance->Revision();
+    ASSERT_TRUE(instance->ResetToBase());
+    ASSERT_EQ(instance->OverlayCount(), 0u);
+    ASSERT_EQ(instance->Collision().CopiedRows(), 0u);
+    ASSERT_FALSE(instance->IsModified());
+    ASSERT_TRUE(instance->Revision() > revision);
+    for (int16_t y = 0; y < 70; y++) {
+        for (int16_t x = 0; x < 100; x++) {
+            ASSERT_EQ(instance->GetTile(x, y), base->GetTile(x, y));
+            ASSERT_EQ(instance->IsTileBlocked(x, y), base->IsTileBlocked(x, y));
+        }
+    }
+
+    // Bases must be loaded, standalone maps
+    ASSERT_THROWS(TileMap::InstanceOf(std::shared_ptr<const TileMap>(std::move(instance))),
+                  std::invalid_argument);
+    TileMap standalone(8, 8);
+    ASSERT_FALSE(standalone.ResetToBase());
+}
+
+TEST(instance_pool_prewarms_and_recycles) {
+    InstancePool pool(MakeInstanceBase(), 2, 3);
+    ASSERT_EQ(pool.Available(), 2u);
+    ASSERT_EQ(pool.GetStats().created, 2u);
+
+    auto world = pool.Acquire();
+    ASSERT_EQ(pool.Available(), 1u);
+    world->GetMap().SetTile(10, 10, TileTypes::Wall);
+    PlayerRegistry players;
+    auto player = players.CreatePlayer(1, 10, 11);
+    world->AddPlayer(player->GetHandle(), 10, 11, player);
+    pool.Recycle(std::move(world));
+    ASSERT_EQ(pool.Available(), 2u);
+
+    // Back clean: no players, no edits
+    std::vector<std::unique_ptr<World>> worlds;
+    for (int i = 0; i < 4; i++) worlds.push_back(pool.Acquire());
+    ASSERT_EQ(pool.GetStats().created, 4u);  // Two idle, two built on demand
+    for (const auto &w : worlds) {
+        ASSERT_EQ(w->PlayerCount(), 0u);
+        ASSERT_EQ(w->GetMap().GetTile(10, 10), TileTypes::Grass);
+        ASSERT_EQ(w->GetMap().OverlayCount(), 0u);
+    }
+
+    // At most max_idle are kept; foreign worlds aren't taken
+    for (auto &w : worlds) pool.Recycle(std::move(w));
+    pool.Recycle(std::make_unique<World>(16, 16));
+    ASSERT_EQ(pool.Available(), 3u);
+    ASSERT_EQ(pool.GetStats().recycled, 4u);
+    ASSERT_EQ(pool.GetStats().discarded, 2u);
+}
+
+// =============================================================================
+// WarpPoints Tests - Server-Defined Warp Tiles
+// =============================================================================
+
+TEST(warp_points_add_replace_remove) {
+    WarpPoints warps;
+    ASSERT_FALSE(warps.At(0, 10, 10).has_value());
+
+    warps.Add(0, 10, 10, {1, 50, 50});
+    ASSERT_TRUE((warps.At(0, 10, 10) == WarpPoints::Destination{1, 50, 50}));
+    // Same coordinates on another map, and swapped x/y, are different tiles
+    ASSERT_FALSE(warps.At(1, 10, 10).has_value());
+    warps.Add(0, 10, 11, {2, 0, 0});
+    ASSERT_FALSE(warps.At(0, 11, 10).has_value());
+    ASSERT_EQ(warps.Count(), 2u);
+
+    // Adding again replaces the destination
+    warps.Add(0, 10, 10, {1, 60, 60});
+    ASSERT_TRUE((warps.At(0, 10, 10) == WarpPoints::Destination{1, 60, 60}));
+    ASSERT_EQ(warps.Count(), 2u);
+
+    ASSERT_TRUE(warps.Remove(0, 10, 10));
+    ASSERT_FALSE(warps.Remove(0, 10, 10));
+    ASSERT_FALSE(warps.At(0, 10, 10).has_value());
+    ASSERT_EQ(warps.Count(), 1u);
+}
+
+TEST(warp_points_keys_full_coordinate_range) {
+    WarpPoints warps;
+    warps.Add(UINT16_MAX, INT16_MAX, INT16_MAX, {7, 1, 2});
+    warps.Add(0, 0, 0, {8, 3, 4});
+    warps.Add(0, -1, 0, {9, 5, 6});
+    ASSERT_TRUE((warps.At(UINT16_MAX, INT16_MAX, INT16_MAX) == WarpPoints::Destination{7, 1, 2}));
+    ASSERT_TRUE((warps.At(0, 0, 0) == WarpPoints::Destination{8, 3, 4}));
+    ASSERT_TRUE((warps.At(0, -1, 0) == WarpPoints::Destination{9, 5, 6}));
+    ASSERT_FALSE(warps.At(0, 0, -1).has_value());
+}
+
+// =============================================================================
+// ServerConfig / IoBackend Tests - Startup Options
+// =============================================================================
+
+/// FromArgs() takes a mutable argv like main() does
+static ServerConfig ParseArgs(std::vector<std::string> args) {
+    std::vector<char*> argv;
+    for (auto& arg : args) argv.push_back(arg.data());
+    return ServerConfig::FromArgs(static_cast<int>(argv.size()), argv.data());
+}
+
+TEST(server_config_parses_io_options) {
+    const ServerConfig defaults = ParseArgs({"DyeWarsServer"});
+    ASSERT_EQ(defaults.io_threads, 1);
+    ASSERT_TRUE(defaults.io_backend == ServerConfig::IoBackend::Auto);
+
+    const ServerConfig config = ParseArgs({"DyeWarsServer", "--io-threads", "4", "--io-backend", "epoll"});
+    ASSERT_EQ(config.io_threads, 4);
+    ASSERT_TRUE(config.io_backend == ServerConfig::IoBackend::Epoll);
+    ASSERT_TRUE(ParseArgs({"x", "--io-backend", "io_uring"}).io_backend == ServerConfig::IoBackend::IoUring);
+    ASSERT_FALSE(defaults.udp_spatial);
+    ASSERT_TRUE(ParseArgs({"x", "--udp"}).udp_spatial);
+    ASSERT_EQ(defaults.job_threads, -1);
+    ASSERT_EQ(ParseArgs({"x", "--job-threads", "0"}).job_threads, 0);
+    ASSERT_FALSE(defaults.pipeline);
+    ASSERT_TRUE(ParseArgs({"x", "--pipeline"}).pipeline);
+    ASSERT_EQ(defaults.zones, 1);
+    ASSERT_EQ(ParseArgs({"x", "--zones", "4"}).zones, 4);
+    ASSERT_EQ(defaults.shard_count, 1);
+    ASSERT_EQ(defaults.PortOffset(), 0);
+    ASSERT_FALSE(defaults.gateway);
+    ASSERT_TRUE(ParseArgs({"x", "--gateway"}).gateway);
+
+    const ServerConfig shard = ParseArgs({"x", "--shard", "1/2", "--shard-dir", "/tmp/shards"});
+    ASSERT_EQ(shard.shard_index, 1);
+    ASSERT_EQ(shard.shard_count, 2);
+    ASSERT_TRUE(shard.shard_dir == "/tmp/shards");
+    ASSERT_EQ(shard.PortOffset(), 10);
+}
+
+TEST(server_config_rejects_bad_options) {
+    ASSERT_THROWS(ParseArgs({"x", "--io-threads", "0"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--io-threads", "65"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--io-backend", "kqueue"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--io-backend"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--job-threads", "65"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--zones", "0"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--zones", "17"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--shard", "2"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--shard", "2/2"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--shard", "0/9"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--shard", "0/2", "--zones", "2"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--bogus"}), std::invalid_argument);
+}
+
+TEST(server_config_parses_tick_options) {
+    const ServerConfig defaults = ParseArgs({"DyeWarsServer"});
+    ASSERT_EQ(defaults.tick.tps, 20);
+    ASSERT_TRUE(defaults.tick.catch_up == TickScheduler::CatchUp::Skip);
+    ASSERT_EQ(defaults.tick.spin.count(), 0);
+
+    const ServerConfig config = ParseArgs({"x", "--tps", "60", "--catch-up", "burst", "--tick-spin-us", "250"});
+    ASSERT_EQ(config.tick.tps, 60);
+    ASSERT_TRUE(config.tick.catch_up == TickScheduler::CatchUp::Burst);
+    ASSERT_EQ(config.tick.spin.count(), 250);
+
+    ASSERT_THROWS(ParseArgs({"x", "--tps", "0"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--catch-up", "later"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--tick-spin-us", "9000"}), std::invalid_argument);
+}
+
+TEST(server_config_parses_deterministic_options) {
+    const ServerConfig defaults = ParseArgs({"DyeWarsServer"});
+    ASSERT_FALSE(defaults.deterministic);
+
+    const ServerConfig plain = ParseArgs({"x", "--deterministic"});
+    ASSERT_TRUE(plain.deterministic);
+    ASSERT_EQ(plain.seed, 1);
+
+    // A seed on its own asks for determinism
+    const ServerConfig seeded = ParseArgs({"x", "--seed", "1234"});
+    ASSERT_TRUE(seeded.deterministic);
+    ASSERT_EQ(seeded.seed, 1234);
+
+    ASSERT_THROWS(ParseArgs({"x", "--seed"}), std::invalid_argument);
+}
+
+TEST(server_config_parses_record_option) {
+    ASSERT_TRUE(ParseArgs({"DyeWarsServer"}).record_path.empty());
+    ASSERT_FALSE(ParseArgs({"DyeWarsServer"}).headless);
+    ASSERT_TRUE(ParseArgs({"x", "--record", "run.dwil"}).record_path == "run.dwil");
+
+    // One shard's log would be missing the rest of the map
+    ASSERT_THROWS(ParseArgs({"x", "--shard", "0/2", "--record", "run.dwil"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--record"}), std::invalid_argument);
+}
+
+TEST(server_config_parses_map_options) {
+    const ServerConfig defaults = ParseArgs({"DyeWarsServer"});
+    ASSERT_TRUE(defaults.map_dir.empty());
+    ASSERT_EQ(defaults.map_idle_seconds, 60u);
+
+    const ServerConfig config = ParseArgs({"x", "--map-dir", "maps", "--map-idle", "0"});
+    ASSERT_TRUE(config.map_dir == "maps");
+    ASSERT_EQ(config.map_idle_seconds, 0u);
+
+    ASSERT_THROWS(ParseArgs({"x", "--map-idle", "86401"}), std::invalid_argument);
+    ASSERT_THROWS(ParseArgs({"x", "--map-dir"}), std::invalid_argument);
+
+    ASSERT_FALSE(defaults.open_warps);
+    ASSERT_TRUE(ParseArgs({"x", "--open-warps"}).open_warps);
+}
+
+TEST(io_backend_keeps_compiled_backend) {
+    // The test binary is never built on io_uring, so these must not re-exec
+    ASSERT_FALSE(IoBackend::CompiledWithIoUring());
+    char name[] = "DyeWarsTests";
+    char* argv[] = {name, nullptr};
+    IoBackend::Select(ServerConfig::IoBackend::Auto, 1, argv);
+    IoBackend::Select(ServerConfig::IoBackend::Epoll, 1, argv);
+    ASSERT_TRUE(std::string(IoBackend::Compiled()) != "io_uring");
+}
+
+// =============================================================================
+// UdpSpatialChannel Tests - Unreliable Spatial Updates over Loopback
+// =============================================================================
+
+/// Channel on an ephemeral port with its own IO thread, plus a client socket
+struct UdpFixture {
+    asio::io_context io_context;
+    UdpSpatialChannel channel{io_context, 0};
+    asio::ip::udp::socket client{io_context, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0)};
+    asio::ip::udp::endpoint server{asio::ip::make_address("127.0.0.1"), channel.Port()};
+    std::thread io_thread;
+
+    UdpFixture() {
+        client.non_blocking(true);
+        channel.Start();
+        io_thread = std::thread([this]() { io_context.run(); });
+    }
+
+    ~UdpFixture() {
+        io_context.stop();
+        io_thread.join();
+    }
+
+    void SendBind(uint64_t token) {
+        std::vector<uint8_t> bind;
+        Protocol::PacketWriter::WriteByte(bind, Protocol::Opcode::Connection::Client::C_Udp_Bind.op);
+        Protocol::PacketWriter::WriteUInt64(bind, token);
+        client.send_to(asio::buffer(bind), server);
+    }
+
+    /// Collect datagrams until `expected` arrived or nothing came for 200ms
+    std::vector<std::vector<uint8_t>> Receive(size_t expected) {
+        std::vector<std::vector<uint8_t>> datagrams;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+        while (datagrams.size() < expected && std::chrono::steady_clock::now() < deadline) {
+            std::array<uint8_t, 2048> buffer{};
+            asio::ip::udp::endpoint from;
+            std::error_code ec;
+            const size_t size = client.receive_from(asio::buffer(buffer), from, 0, ec);
+            if (ec) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            datagrams.emplace_back(buffer.begin(), buffer.begin() + size);
+            deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+        }
+        return datagrams;
+    }
+};
+
+static std::vector<UdpSpatialChannel::SpatialRecord> MakeRecords(size_t count) {
+    std::vector<UdpSpatialChannel::SpatialRecord> records;
+    for (size_t i = 0; i < count; i++) {
+        records.push_back({i + 1, static_cast<int16_t>(i), 7, 2});
+    }
+    return records;
+}
+
+TEST(udp_channel_bind_requires_issued_token) {
+    UdpFixture udp;
+    const uint64_t token = udp.channel.IssueToken(42);
+
+    udp.SendBind(token + 1);  // Wrong token - ignored, no ack
+    ASSERT_TRUE(udp.Receive(1).empty());
+    ASSERT_FALSE(udp.channel.IsBound(42));
+    ASSERT_FALSE(udp.channel.QueueSpatial(42, MakeRecords(1)));
+
+    udp.SendBind(token);
+    const auto ack = udp.Receive(1);
+    ASSERT_EQ(ack.size(), 1);
+    ASSERT_EQ(ack[0][0], Protocol::Opcode::Connection::Server::S_Udp_Bound.op);
+    ASSERT_TRUE(udp.channel.IsBound(42));
+    ASSERT_EQ(udp.channel.GetStats().bad_datagrams, 1);
+
+    udp.channel.Remove(42);
+    ASSERT_FALSE(udp.channel.IsBound(42));
+}
+
+TEST(udp_channel_splits_and_sequences_batches) {
+    UdpFixture udp;
+    udp.SendBind(udp.channel.IssueToken(7));
+    ASSERT_EQ(udp.Receive(1).size(), 1);
+
+    // 200 records don't fit one MTU-sized datagram: 91 + 91 + 18
+    ASSERT_TRUE(udp.channel.QueueSpatial(7, MakeRecords(200)));
+    ASSERT_TRUE(udp.channel.QueueSpatial(7, MakeRecords(1)));
+    udp.channel.Flush();
+
+    const auto datagrams = udp.Receive(4);
+    ASSERT_EQ(datagrams.size(), 4);
+    const uint8_t expected_counts[] = {91, 91, 18, 1};
+    for (size_t i = 0; i < datagrams.size(); i++) {
+        size_t offset = 0;
+        ASSERT_EQ(Protocol::PacketReader::ReadByte(datagrams[i], offset),
+                  Protocol::Opcode::Batch::Server::S_Player_Spatial_Unreliable.op);
+        ASSERT_EQ(Protocol::PacketReader::ReadUInt(datagrams[i], offset), i + 1);
+        ASSERT_EQ(Protocol::PacketReader::ReadByte(datagrams[i], offset), expected_counts[i]);
+        ASSERT_LE(datagrams[i].size(), UdpSpatialChannel::MAX_DATAGRAM_BYTES);
+    }
+}
+
+TEST(udp_channel_loss_injection_drops_fraction) {
+    UdpFixture udp;
+    udp.SendBind(udp.channel.IssueToken(3));
+    ASSERT_EQ(udp.Receive(1).size(), 1);
+    udp.channel.SetLossRate(0.5);
+
+    for (int tick = 0; tick < 200; tick++) {
+        udp.channel.QueueSpatial(3, MakeRecords(1));
+        udp.channel.Flush();
+    }
+
+    const auto datagrams = udp.Receive(200);
+    const auto stats = udp.channel.GetStats();
+    ASSERT_EQ(stats.datagrams_dropped + stats.datagrams_sent, 200);
+    ASSERT_EQ(datagrams.size(), stats.datagrams_sent);
+    ASSERT_GE(datagrams.size(), 60);
+    ASSERT_LE(datagrams.size(), 140);
+
+    // What a client does: apply only datagrams newer than the last one applied
+    uint32_t last_applied = 0;
+    for (const auto& datagram : datagrams) {
+        size_t offset = 1;
+        const uint32_t seq = Protocol::PacketReader::ReadUInt(datagram, offset);
+        ASSERT_TRUE(UdpSpatialChannel::IsNewerSequence(seq, last_applied));
+        last_applied = seq;
+    }
+}
+
+TEST(udp_sequence_comparison_wraps) {
+    ASSERT_TRUE(UdpSpatialChannel::IsNewerSequence(2, 1));
+    ASSERT_FALSE(UdpSpatialChannel::IsNewerSequence(1, 2));
+    ASSERT_FALSE(UdpSpatialChannel::IsNewerSequence(5, 5));        // Duplicate
+    ASSERT_TRUE(UdpSpatialChannel::IsNewerSequence(1, 0xFFFFFFFFu)); // Wrapped
+    ASSERT_FALSE(UdpSpatialChannel::IsNewerSequence(0xFFFFFFFFu, 1));
+}
+
+// =============================================================================
+// Shard Tests - Border Ghosts and Handoff
+// =============================================================================
+
+TEST(shard_layout_splits_map_into_strips) {
+    const ShardLayout layout{1, 3, 256};
+    ASSERT_TRUE(layout.IsSharded());
+    ASSERT_FALSE(ShardLayout{}.IsSharded());
+
+    // 256 / 3: [0, 85) [85, 170) [170, 256) - every column owned exactly once
+    ASSERT_EQ(layout.Begin(1), 85);
+    ASSERT_EQ(layout.End(1), 170);
+    ASSERT_EQ(layout.End(2), 256);
+    for (int16_t x = 0; x < 256; x++) {
+        const uint8_t owner = layout.OwnerOf(x);
+        ASSERT_TRUE(x >= layout.Begin(owner) && x < layout.End(owner));
+    }
+
+    // Off-map columns belong to the edge shards
+    ASSERT_EQ(layout.OwnerOf(-1), 0);
+    ASSERT_EQ(layout.OwnerOf(300), 2);
+    ASSERT_TRUE(layout.Owns(100));
+    ASSERT_FALSE(layout.Owns(170));
+    ASSERT_EQ(layout.ClampToStrip(170), 169);
+    ASSERT_EQ(layout.ClampToStrip(3), 85);
+}
+
+TEST(shard_layout_ghost_targets_near_borders) {
+    const ShardLayout middle{1, 3, 256};
+    const int16_t margin = ShardLayout::GHOST_MARGIN;
+
+    ASSERT_EQ(middle.GhostTargets(127), 0);                    // Centre of the strip
+    ASSERT_EQ(middle.GhostTargets(85 + margin - 1), 0b001);    // Seen from shard 0
+    ASSERT_EQ(middle.GhostTargets(85 + margin), 0);
+    ASSERT_EQ(middle.GhostTargets(170 - margin), 0b100);       // Seen from shard 2
+    ASSERT_EQ(middle.GhostTargets(170 - margin - 1), 0);
+
+    // Edge strips have one neighbour; a strip narrower than two margins both
+    const ShardLayout first{0, 3, 256};
+    ASSERT_EQ(first.GhostTargets(0), 0);
+    ASSERT_EQ(first.GhostTargets(84), 0b010);
+    const ShardLayout narrow{1, 3, 3 * margin};
+    ASSERT_EQ(narrow.GhostTargets(narrow.Begin(1)), 0b101);
+}
+
+TEST(shard_link_encode_decode_round_trip) {
+    // A ghost list longer than one datagram is split
+    ShardLink::Message update;
+    update.type = ShardLink::Type::GhostUpdate;
+    for (uint64_t id = 1; id <= ShardLink::MAX_GHOSTS_PER_DATAGRAM + 5; id++) {
+        update.ghosts.push_back({id, static_cast<int16_t>(id % 256), -3, 2});
+    }
+    const auto datagrams = ShardLink::Encode(update, 4);
+    ASSERT_EQ(datagrams.size(), 2);
+    size_t decoded_ghosts = 0;
+    for (const auto& datagram : datagrams) {
+        ASSERT_LE(datagram.size(), ShardLink::MAX_DATAGRAM_BYTES);
+        const auto message = ShardLink::Decode(datagram);
+        ASSERT_TRUE(message.has_value());
+        ASSERT_EQ(message->from, 4);
+        ASSERT_EQ(message->ghosts[0].y, -3);
+        decoded_ghosts += message->ghosts.size();
+    }
+    ASSERT_EQ(decoded_ghosts, update.ghosts.size());
+
+    ShardLink::Message handoff;
+    handoff.type = ShardLink::Type::Handoff;
+    handoff.handoff = {0xDEADBEEFCAFEF00DULL, 77, 128, 40, 1, "Wanderer"};
+    const auto encoded = ShardLink::Encode(handoff, 0);
+    ASSERT_EQ(encoded.size(), 1);
+    const auto decoded = ShardLink::Decode(encoded[0]);
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_TRUE(decoded->type == ShardLink::Type::Handoff);
+    ASSERT_EQ(decoded->handoff.token, 0xDEADBEEFCAFEF00DULL);
+    ASSERT_EQ(decoded->handoff.player_id, 77);
+    ASSERT_EQ(decoded->handoff.x, 128);
+    ASSERT_TRUE(decoded->handoff.name == "Wanderer");
+
+    // Truncated, padded and unknown datagrams are rejected
+    auto truncated = encoded[0];
+    truncated.pop_back();
+    ASSERT_FALSE(ShardLink::Decode(truncated).has_value());
+    auto padded = encoded[0];
+    padded.push_back(0);
+    ASSERT_FALSE(ShardLink::Decode(padded).has_value());
+    const std::vector<uint8_t> unknown = {9, 0, 0, 0};
+    ASSERT_FALSE(ShardLink::Decode(unknown).has_value());
+}
+
+TEST(shard_link_delivers_between_shards) {
+    const auto dir = std::filesystem::temp_directory_path() / "dyewars_shard_test";
+    std::filesystem::remove_all(dir);
+
+    asio::io_context io_context;
+    ShardLink shard0(io_context, dir.string(), 0, 3);
+    ShardLink shard1(io_context, dir.string(), 1, 3);
+    shard0.Start();
+    shard1.Start();
+    std::thread io_thread([&io_context]() {
+        auto guard = asio::make_work_guard(io_context);
+        io_context.run();
+    });
+
+    ShardLink::Message remove;
+    remove.type = ShardLink::Type::GhostRemove;
+    remove.removed = {11, 12};
+    ASSERT_TRUE(shard0.Send(1, remove));
+
+    // Shard 2 isn't running: the send fails instead of vanishing
+    ASSERT_FALSE(shard0.Send(2, remove));
+    ASSERT_EQ(shard0.GetStats().send_errors, 1);
+
+    std::vector<ShardLink::Message> received;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (received.empty() && std::chrono::steady_clock::now() < deadline) {
+        shard1.Drain(received);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(received.size(), 1);
+    ASSERT_EQ(received[0].from, 0);
+    ASSERT_EQ(received[0].removed.size(), 2);
+    ASSERT_EQ(received[0].removed[1], 12);
+
+    io_context.stop();
+    io_thread.join();
+}
+
+// =============================================================================
+// Gateway Tests - Multiplexed Stream and Fan-out
+// =============================================================================
+
+TEST(handshake_check_accepts_and_rejects) {
+    std::vector<uint8_t> hello = {0x00, 0x00, 0x01, 0x44, 0x59, 0x45, 0x57};
+    const auto ok = HandshakeCheck::Validate(hello);
+    ASSERT_TRUE(ok.ok);
+    ASSERT_EQ(ok.resume_token, 0);
+
+    // Shard resume carries its token
+    std::vector<uint8_t> resume = hello;
+    resume[0] = Protocol::Opcode::Connection::Client::C_Shard_Resume.op;
+    Protocol::PacketWriter::WriteUInt64(resume, 0xABCDEF);
+    const auto resumed = HandshakeCheck::Validate(resume);
+    ASSERT_TRUE(resumed.ok);
+    ASSERT_EQ(resumed.resume_token, 0xABCDEF);
+
+    std::vector<uint8_t> bad_magic = hello;
+    bad_magic[6] = 0x00;
+    ASSERT_FALSE(HandshakeCheck::Validate(bad_magic).ok);
+    std::vector<uint8_t> bad_version = hello;
+    bad_version[2] = 0x02;
+    ASSERT_FALSE(HandshakeCheck::Validate(bad_version).ok);
+    hello.pop_back();
+    const auto short_packet = HandshakeCheck::Validate(hello);
+    ASSERT_FALSE(short_packet.ok);
+    ASSERT_FALSE(short_packet.error.empty());
+}
+
+TEST(gateway_protocol_round_trip_and_partial_parse) {
+    using namespace GatewayProtocol;
+
+    const std::vector<uint8_t> payload = {0x01, 0x02};
+    const std::vector<uint8_t> frame = {Protocol::MAGIC_1, Protocol::MAGIC_2, 0x00, 0x01, 0x42};
+    const std::vector<uint64_t> recipients = {7, 9};
+
+    std::vector<uint8_t> stream;
+    AppendClientOpen(stream, 7, 55, "10.0.0.1");
+    AppendClientFrame(stream, 7, payload);
+    AppendClientClosed(stream, 7);
+    AppendDeliver(stream, recipients, frame);
+    AppendClose(stream, 9, "kicked");
+    AppendClientPing(stream, 7, 123);
+    AppendClientPing(stream, 9, 70000);
+
+    // Byte by byte: NeedMore until each message is whole
+    std::vector<Message> messages;
+    size_t offset = 0;
+    for (size_t end = 1; end <= stream.size(); end++) {
+        Message message{};
+        size_t consumed = 0;
+        const auto status = Parse(std::span<const uint8_t>(stream).subspan(offset, end - offset), message, consumed);
+        ASSERT_TRUE(status != ParseStatus::Corrupt);
+        if (status == ParseStatus::Ready) {
+            messages.push_back(message);
+            offset += consumed;
+        }
+    }
+    ASSERT_EQ(offset, stream.size());
+    ASSERT_EQ(messages.size(), 7);
+
+    const auto open = DecodeClientOpen(messages[0].body);
+    ASSERT_TRUE(open.has_value());
+    ASSERT_EQ(open->client, 7);
+    ASSERT_EQ(open->resume_token, 55);
+    ASSERT_TRUE(open->ip == "10.0.0.1");
+
+    std::span<const uint8_t> rest;
+    ASSERT_EQ(*DecodeClient(messages[1].body, rest), 7);
+    ASSERT_EQ(rest.size(), 2);
+    ASSERT_EQ(rest[1], 0x02);
+
+    const auto deliver = DecodeDeliver(messages[3].body);
+    ASSERT_TRUE(deliver.has_value());
+    ASSERT_EQ(deliver->clients.size(), 2);
+    ASSERT_EQ(deliver->clients[1], 9);
+    ASSERT_TRUE(std::equal(deliver->frame.begin(), deliver->frame.end(), frame.begin(), frame.end()));
+
+    const auto close = DecodeClose(messages[4].body);
+    ASSERT_TRUE(close.has_value());
+    ASSERT_TRUE(close->reason == "kicked");
+
+    const auto ping = DecodeClientPing(messages[5].body);
+    ASSERT_TRUE(ping.has_value());
+    ASSERT_EQ(ping->client, 7);
+    ASSERT_EQ(ping->ping_ms, 123);
+    ASSERT_EQ(DecodeClientPing(messages[6].body)->ping_ms, 0xFFFF);  // Clamped, not wrapped
+
+    // Truncated bodies decode to nothing; unknown types corrupt the stream
+    ASSERT_FALSE(DecodeClientOpen(messages[0].body.first(10)).has_value());
+    ASSERT_FALSE(DecodeDeliver(messages[3].body.first(18)).has_value());
+    ASSERT_FALSE(DecodeClientPing(messages[5].body.first(9)).has_value());
+    std::vector<uint8_t> junk = {0x09, 0, 0, 0, 0};
+    Message message{};
+    size_t consumed = 0;
+    ASSERT_TRUE(Parse(junk, message, consumed) == ParseStatus::Corrupt);
+}
+
+TEST(fan_out_merges_identical_packets_in_order) {
+    using namespace GatewayProtocol;
+
+    auto packet = [](uint8_t value) {
+        return std::make_shared<std::vector<uint8_t>>(
+                std::vector<uint8_t>{Protocol::MAGIC_1, Protocol::MAGIC_2, 0x00, 0x01, value});
+    };
+
+    // Same bytes, separate buffers (each client's own encode) still merge
+    FanOutBatcher batcher;
+    batcher.Add(1, packet(0xA));
+    batcher.Add(2, packet(0xA));
+    batcher.Add(3, packet(0xA));
+    batcher.Add(1, packet(0xB));
+    ASSERT_EQ(batcher.Packets(), 4);
+    ASSERT_EQ(batcher.Messages(), 2);
+
+    // Client 4 got B before A: joining the A group would reorder it
+    batcher.Add(4, packet(0xB));
+    batcher.Add(4, packet(0xA));
+    ASSERT_EQ(batcher.Messages(), 3);
+
+    std::vector<uint8_t> out;
+    batcher.Write(out);
+    ASSERT_TRUE(batcher.Empty());
+
+    // Replay what a gateway would see, per client
+    std::unordered_map<uint64_t, std::vector<uint8_t>> received;
+    size_t offset = 0;
+    while (offset < out.size()) {
+        Message message{};
+        size_t consumed = 0;
+        ASSERT_TRUE(Parse(std::span<const uint8_t>(out).subspan(offset), message, consumed) == ParseStatus::Ready);
+        const auto deliver = DecodeDeliver(message.body);
+        ASSERT_TRUE(deliver.has_value());
+        for (const uint64_t client : deliver->clients) received[client].push_back(deliver->frame.back());
+        offset += consumed;
+    }
+    ASSERT_TRUE((received[1] == std::vector<uint8_t>{0xA, 0xB}));
+    ASSERT_TRUE((received[3] == std::vector<uint8_t>{0xA}));
+    ASSERT_TRUE((received[4] == std::vector<uint8_t>{0xB, 0xA}));
+}
+
 // =============================================================================
 // Main
 // =============================================================================
@@ -578,6 +3342,153 @@ int main() {
     RUN_TEST(ping_tracker_rolling_average);
     RUN_TEST(ping_tracker_get_is_thread_safe);
 
+    std::cout << "\nReceiveRing Tests:\n";
+    RUN_TEST(receive_ring_parses_many_frames_from_one_read);
+    RUN_TEST(receive_ring_waits_for_fragmented_frame);
+    RUN_TEST(receive_ring_flags_bad_magic_and_size);
+    RUN_TEST(receive_ring_compacts_partial_tail);
+
+    std::cout << "\nPacketTrace Tests:\n";
+    RUN_TEST(packet_trace_off_records_nothing);
+    RUN_TEST(packet_trace_sampling_keeps_one_in_n);
+    RUN_TEST(packet_trace_concurrent_record_and_dump);
+
+    std::cout << "\nSpatialConflation Tests:\n";
+    RUN_TEST(spatial_conflation_keeps_latest_per_player);
+    RUN_TEST(spatial_conflation_respects_left_game_order);
+    RUN_TEST(spatial_conflation_never_mutates_shared_buffers);
+
+    std::cout << "\nIoContextPool Tests:\n";
+    RUN_TEST(io_context_pool_assigns_round_robin);
+    RUN_TEST(io_context_pool_keeps_context_on_one_thread);
+    RUN_TEST(io_context_pool_stop_joins_idle_threads);
+
+    std::cout << "\nMpscRing Tests:\n";
+    RUN_TEST(mpsc_ring_is_fifo_and_bounded);
+    RUN_TEST(mpsc_ring_concurrent_producers_lose_nothing);
+    RUN_TEST(game_command_is_compact_pod);
+
+    std::cout << "\nInputQueues Tests:\n";
+    RUN_TEST(input_queue_coalesces_consecutive_turns);
+    RUN_TEST(input_queues_bound_work_per_client_per_tick);
+    RUN_TEST(input_queues_drop_removed_clients);
+
+    std::cout << "\nTimerWheel Tests:\n";
+    RUN_TEST(timer_wheel_fires_on_exact_tick_across_levels);
+    RUN_TEST(timer_wheel_cancel_ignores_stale_handles);
+    RUN_TEST(timer_wheel_skips_destroyed_targets);
+    RUN_TEST(timer_wheel_handles_50k_connections);
+
+    std::cout << "\nTickScheduler Tests:\n";
+    RUN_TEST(tick_scheduler_deadlines_do_not_drift);
+    RUN_TEST(tick_scheduler_skip_realigns_after_overrun);
+    RUN_TEST(tick_scheduler_burst_replays_bounded_backlog);
+    RUN_TEST(tick_scheduler_real_sleep_keeps_rate);
+
+    std::cout << "\nJobSystem Tests:\n";
+    RUN_TEST(job_system_parallel_for_covers_each_index_once);
+    RUN_TEST(job_system_runs_dependencies_first);
+    RUN_TEST(job_system_idle_workers_steal_spawned_jobs);
+    RUN_TEST(thread_owner_allows_reads_only_from_joined_jobs);
+
+    std::cout << "\nTickDelta Tests:\n";
+    RUN_TEST(tick_delta_copies_records_at_add_time);
+    RUN_TEST(tick_delta_groups_by_client_in_tick_order);
+    RUN_TEST(tick_delta_pipeline_bounds_in_flight_and_recycles);
+
+    std::cout << "\nZone Tests:\n";
+    RUN_TEST(warp_command_fits_ring_slot);
+    RUN_TEST(player_registry_adopts_player_under_same_id);
+    RUN_TEST(world_find_open_tile_skips_taken_tiles);
+    RUN_TEST(tick_delta_holds_transfers_until_next_tick);
+    RUN_TEST(zones_forward_disconnects_without_waiting_on_full_rings);
+
+    std::cout << "\nSlotMap Tests:\n";
+    RUN_TEST(slot_map_stale_handles_stop_resolving);
+    RUN_TEST(slot_map_stays_dense_after_erase);
+    RUN_TEST(player_registry_keeps_handle_through_ghosting);
+    RUN_TEST(world_and_visibility_drop_stale_handles);
+
+    std::cout << "\nPlayerTable Tests:\n";
+    RUN_TEST(player_table_view_follows_registration);
+    RUN_TEST(player_table_survives_registry_teardown);
+    RUN_TEST(player_registry_dirty_flag_dedupes_marks);
+    RUN_TEST(tick_delta_captures_from_table);
+
+    std::cout << "\nDirty List Tests:\n";
+    RUN_TEST(dirty_list_keeps_first_mark_order);
+    RUN_TEST(dirty_list_swaps_buffers_between_ticks);
+    RUN_TEST(dirty_list_skips_withdrawn_marks);
+
+    std::cout << "\nGameTime Tests:\n";
+    RUN_TEST(game_time_rounds_durations_down_to_ticks);
+    RUN_TEST(game_time_move_cooldown_counts_ticks);
+    RUN_TEST(game_time_turn_cooldown_counts_ticks);
+    RUN_TEST(seeded_registries_repeat_player_ids);
+
+    std::cout << "\nInputLog Tests:\n";
+    RUN_TEST(input_log_round_trips_every_kind);
+    RUN_TEST(input_log_skips_empty_blocks);
+    RUN_TEST(input_log_rejects_bad_files);
+
+    std::cout << "\nCollisionGrid Tests:\n";
+    RUN_TEST(collision_grid_blocks_outside_the_map);
+    RUN_TEST(collision_grid_layers_or_on_read);
+    RUN_TEST(collision_grid_queries_match_per_tile_checks);
+
+    std::cout << "\nMapStreamer Tests:\n";
+    RUN_TEST(tile_chunk_codec_round_trips);
+    RUN_TEST(map_streamer_sends_only_missing_chunks);
+    RUN_TEST(map_streamer_shares_and_refreshes_encoded_chunks);
+
+    std::cout << "\nMapFile Tests:\n";
+    RUN_TEST(map_file_round_trips);
+    RUN_TEST(map_file_rejects_bad_files);
+    RUN_TEST(tile_map_load_distrusts_file_collision_bits);
+    RUN_TEST(tile_map_loads_lazily_and_releases);
+
+    std::cout << "\nTileChangeJournal Tests:\n";
+    RUN_TEST(tile_change_journal_keeps_one_change_per_tile);
+    RUN_TEST(tile_update_codec_round_trips);
+    RUN_TEST(map_streamer_skips_patched_chunks);
+    RUN_TEST(map_streamer_sends_dynamic_blockers);
+
+    std::cout << "\nInstance Tests:\n";
+    RUN_TEST(collision_grid_shares_rows_until_written);
+    RUN_TEST(tile_map_instance_copies_only_edited_chunks);
+    RUN_TEST(tile_map_instance_resets_to_base);
+    RUN_TEST(instance_pool_prewarms_and_recycles);
+
+    std::cout << "\nWarpPoints Tests:\n";
+    RUN_TEST(warp_points_add_replace_remove);
+    RUN_TEST(warp_points_keys_full_coordinate_range);
+
+    std::cout << "\nServerConfig / IoBackend Tests:\n";
+    RUN_TEST(server_config_parses_io_options);
+    RUN_TEST(server_config_rejects_bad_options);
+    RUN_TEST(server_config_parses_tick_options);
+    RUN_TEST(server_config_parses_deterministic_options);
+    RUN_TEST(server_config_parses_record_option);
+    RUN_TEST(server_config_parses_map_options);
+    RUN_TEST(io_backend_keeps_compiled_backend);
+
+    std::cout << "\nUdpSpatialChannel Tests:\n";
+    RUN_TEST(udp_channel_bind_requires_issued_token);
+    RUN_TEST(udp_channel_splits_and_sequences_batches);
+    RUN_TEST(udp_channel_loss_injection_drops_fraction);
+    RUN_TEST(udp_sequence_comparison_wraps);
+
+    std::cout << "\nShard Tests:\n";
+    RUN_TEST(shard_layout_splits_map_into_strips);
+    RUN_TEST(shard_layout_ghost_targets_near_borders);
+    RUN_TEST(shard_link_encode_decode_round_trip);
+    RUN_TEST(shard_link_delivers_between_shards);
+
+    std::cout << "\nGateway Tests:\n";
+    RUN_TEST(handshake_check_accepts_and_rejects);
+    RUN_TEST(gateway_protocol_round_trip_and_partial_parse);
+    RUN_TEST(fan_out_merges_identical_packets_in_order);
+
     std::cout << "\n=== Results ===\n";
     std::cout << "Passed: " << tests_passed << "\n";
     std::cout << "Failed: " << tests_failed << "\n";
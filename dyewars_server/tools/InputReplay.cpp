@@ -0,0 +1,236 @@
+/// =======================================
+/// DyeWarsReplay
+///
+/// Replays a command capture (DyeWarsServer --record FILE) through a
+/// headless GameServer as fast as the machine allows, and prints where
+/// each tick's time went. Run two builds on the same capture to compare
+/// them on identical traffic.
+///
+/// The server is built without sockets or zone threads (config.headless).
+/// Recorded clients log in on FakeClientConnections, so their packets are
+/// built, encoded and queued like a real client's but go nowhere. Each
+/// recorded tick, every zone gets that tick's commands and runs one
+/// Zone::RunTick(), map 0 first; ticks with no input run too.
+///
+/// For the same ids and bot moves as the live run, record with
+/// --deterministic (the capture carries the seed). Zone transfers land
+/// when the target zone next ticks, which live may have been a tick
+/// later. The final state checksum tells whether two replays (or two
+/// builds) simulated the same game.
+///
+/// Usage:
+///   DyeWarsReplay <capture.dwil> [--job-threads N] [--csv FILE] [--verbose]
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/Log.h"
+#include "core/ServerConfig.h"
+#include "network/IoContextPool.h"
+#include "server/FakeClientConnection.h"
+#include "server/GameServer.h"
+#include "server/InputLog.h"
+#include "server/Zone.h"
+#include "server/ZoneManager.h"
+
+using Clock = std::chrono::steady_clock;
+using InputLogFormat::Kind;
+
+namespace {
+
+struct Options {
+    std::string capture_path;
+    int job_threads = -1;
+    std::string csv_path;
+    bool verbose = false;
+};
+
+bool ParseOptions(int argc, char *argv[], Options &options) {
+    if (argc < 2) return false;
+    options.capture_path = argv[1];
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--job-threads" && i + 1 < argc) {
+            options.job_threads = std::stoi(argv[++i]);
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csv_path = argv[++i];
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// One phase's samples over every zone tick
+struct PhaseColumn {
+    const char *name;
+    double Zone::TickPhases::*field;
+    std::vector<double> samples;
+};
+
+void PrintPhase(PhaseColumn &column) {
+    auto &samples = column.samples;
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (const double ms : samples) sum += ms;
+    auto percentile = [&](double p) {
+        return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))];
+    };
+    std::printf("%-10s %10.3f %10.3f %10.3f %10.3f %12.1f\n", column.name, sum / static_cast<double>(samples.size()),
+                percentile(0.5), percentile(0.99), samples.back(), sum);
+}
+
+/// Positions and facings of every player in every zone, FNV-1a
+uint64_t StateChecksum(ZoneManager &zones, size_t &player_count) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    player_count = 0;
+    for (uint16_t map_id = 0; map_id < zones.Count(); map_id++) {
+        zones.Get(map_id)->Players().ForEachPlayer([&](const std::shared_ptr<Player> &player) {
+            const auto x = static_cast<uint16_t>(player->GetX());
+            const auto y = static_cast<uint16_t>(player->GetY());
+            mix(player->GetID());
+            mix(x | static_cast<uint64_t>(y) << 16 | static_cast<uint64_t>(player->GetFacing()) << 32);
+            player_count++;
+        });
+    }
+    return hash;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: %s <capture.dwil> [--job-threads N] [--csv FILE] [--verbose]\n", argv[0]);
+        return 1;
+    }
+    Log::Level = options.verbose ? 2 : 3;  // Per-login info lines would be timed too
+
+    InputLogFormat::Capture capture;
+    try {
+        capture = InputLogFormat::ReadFile(options.capture_path);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Could not read %s: %s\n", options.capture_path.c_str(), e.what());
+        return 1;
+    }
+    const auto &header = capture.header;
+    if (header.zones == 0 || header.zones > ServerConfig::MAX_ZONES) {
+        std::fprintf(stderr, "Capture has %u zones\n", header.zones);
+        return 1;
+    }
+
+    // Per map, in tick order (the file interleaves maps)
+    std::vector<std::vector<InputLogFormat::Entry>> by_map(header.zones);
+    uint64_t last_tick = 0;
+    for (const auto &entry : capture.entries) {
+        if (entry.map_id >= header.zones) continue;
+        by_map[entry.map_id].push_back(entry);
+        last_tick = std::max(last_tick, entry.tick);
+    }
+
+    // The recorded server's simulation settings; no pipeline - nothing
+    // would run its encoder thread
+    ServerConfig config;
+    config.headless = true;
+    config.tick.tps = header.tps;
+    config.deterministic = header.deterministic;
+    config.seed = header.seed;
+    config.zones = header.zones;
+    config.open_warps = header.open_warps;
+    config.job_threads = options.job_threads;
+
+    const std::string mode = header.deterministic ? std::format("seed {}", header.seed) : "not deterministic";
+    std::printf("%s: %zu commands over %llu ticks, %u zone(s), %u TPS, %s\n", options.capture_path.c_str(),
+                capture.entries.size(), static_cast<unsigned long long>(last_tick), header.zones, header.tps,
+                mode.c_str());
+
+    IoContextPool io_pool(1);
+    GameServer server(io_pool, config);
+    ZoneManager &zones = server.Zones();
+
+    std::vector<PhaseColumn> columns = {
+            {"transfers", &Zone::TickPhases::transfers, {}},
+            {"commands", &Zone::TickPhases::commands, {}},
+            {"inputs", &Zone::TickPhases::inputs, {}},
+            {"bots", &Zone::TickPhases::bots, {}},
+            {"broadcast", &Zone::TickPhases::broadcast, {}},
+            {"hooks", &Zone::TickPhases::hooks, {}},
+            {"publish", &Zone::TickPhases::publish, {}},
+            {"total", &Zone::TickPhases::total, {}},
+    };
+    std::ofstream csv;
+    if (!options.csv_path.empty()) {
+        csv.open(options.csv_path, std::ios::trunc);
+        csv << "map,tick,transfers,commands,inputs,bots,broadcast,hooks,publish,total\n";
+    }
+
+    std::vector<size_t> cursor(header.zones, 0);
+    const auto start = Clock::now();
+    for (uint64_t tick = 1; tick <= last_tick; tick++) {
+        for (uint16_t map_id = 0; map_id < header.zones; map_id++) {
+            Zone &zone = *zones.Get(map_id);
+            auto &entries = by_map[map_id];
+            for (size_t &i = cursor[map_id]; i < entries.size() && entries[i].tick == tick; i++) {
+                const auto &entry = entries[i];
+                switch (entry.kind) {
+                    case Kind::SpawnBots:
+                        zone.SpawnBots(entry.bot_count, entry.clustered);
+                        break;
+                    case Kind::RemoveBots:
+                        zone.RemoveBots();
+                        break;
+                    case Kind::Login:
+                        if (!server.Clients().GetAnyClient(entry.command.client_id)) {
+                            server.Clients().AddFakeClient(
+                                    std::make_shared<FakeClientConnection>(entry.command.client_id));
+                        }
+                        zone.QueueCommand(entry.command);
+                        break;
+                    default:
+                        zone.QueueCommand(entry.command);
+                        break;
+                }
+            }
+
+            zone.RunTick();
+            const auto &phases = zone.LastTickPhases();
+            for (auto &column : columns) column.samples.push_back(phases.*column.field);
+            if (csv.is_open()) {
+                csv << std::format("{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f}\n", map_id, tick,
+                                   phases.transfers, phases.commands, phases.inputs, phases.bots, phases.broadcast,
+                                   phases.hooks, phases.publish, phases.total);
+            }
+        }
+    }
+    const double wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("Replayed %llu ticks in %.2fs (%.0f ticks/s, %.1fx real time)\n\n",
+                static_cast<unsigned long long>(last_tick), wall_s, static_cast<double>(last_tick) / wall_s,
+                static_cast<double>(last_tick) / header.tps / wall_s);
+    std::printf("%-10s %10s %10s %10s %10s %12s\n", "phase (ms)", "mean", "p50", "p99", "max", "sum");
+    for (auto &column : columns) PrintPhase(column);
+
+    size_t player_count = 0;
+    const uint64_t checksum = StateChecksum(zones, player_count);
+    std::printf("\nFinal state: %zu players, checksum %016llx\n", player_count,
+                static_cast<unsigned long long>(checksum));
+
+    server.Shutdown();
+    return 0;
+}
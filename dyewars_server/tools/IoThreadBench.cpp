@@ -0,0 +1,254 @@
+/// =======================================
+/// DyeWarsIoBench
+///
+/// Loopback throughput benchmark for the IO thread pool.
+/// Runs the server-side receive path (IoContextPool + ReceiveRing frame
+/// parsing + one async_write per read batch) against a fixed client load,
+/// once per IO thread count, and prints frames/sec and p99 burst latency.
+///
+/// The game thread is deliberately left out: this measures how far the
+/// network layer scales on its own, which is what --io-threads changes.
+///
+/// Usage:
+///   DyeWarsIoBench [--threads 1,2,4,8] [--connections 256] [--seconds 5]
+///                  [--burst 10] [--port 18081]
+///
+/// Each client sends a burst of C_Move_Request-sized frames in one write,
+/// waits for one echo frame per request, then repeats.
+///
+/// Built twice with -DENABLE_IO_URING=ON (DyeWarsIoBenchUring); see
+/// tools/bench_io_backend.sh to compare syscalls/sec between backends.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#include <algorithm>
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "network/IoBackend.h"
+#include "network/IoContextPool.h"
+#include "network/ReceiveRing.h"
+#include "network/Packets/Protocol.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// Move request frame: [0x11][0x68][0x00][0x03][0x01][dir][facing]
+constexpr uint8_t MOVE_FRAME[] = {Protocol::MAGIC_1, Protocol::MAGIC_2, 0x00, 0x03, 0x01, 0x02, 0x02};
+constexpr size_t FRAME_SIZE = sizeof(MOVE_FRAME);
+
+std::atomic<uint64_t> g_frames_handled{0};
+
+/// Server side: parse frames in place, echo one frame per request
+class BenchSession : public std::enable_shared_from_this<BenchSession> {
+public:
+    explicit BenchSession(asio::ip::tcp::socket socket) : socket_(std::move(socket)) {}
+
+    void Start() { Read(); }
+
+private:
+    void Read() {
+        auto self = shared_from_this();
+        socket_.async_read_some(asio::buffer(ring_.WritePtr(), ring_.WritableBytes()),
+                                [this, self](std::error_code ec, size_t n) {
+                                    if (ec) return;
+                                    ring_.Commit(n);
+
+                                    uint16_t size = 0;
+                                    uint64_t frames = 0;
+                                    while (ring_.PeekFrame(size) == ReceiveRing::FrameStatus::Ready) {
+                                        pending_.insert(pending_.end(), MOVE_FRAME, MOVE_FRAME + FRAME_SIZE);
+                                        ring_.Consume(Protocol::HEADER_SIZE + size);
+                                        frames++;
+                                    }
+                                    g_frames_handled.fetch_add(frames, std::memory_order_relaxed);
+                                    ring_.Compact();
+                                    Write();
+                                    Read();
+                                });
+    }
+
+    void Write() {
+        if (writing_ || pending_.empty()) return;
+        writing_ = true;
+        in_flight_.swap(pending_);
+        pending_.clear();
+        auto self = shared_from_this();
+        asio::async_write(socket_, asio::buffer(in_flight_), [this, self](std::error_code ec, size_t) {
+            writing_ = false;
+            if (!ec) Write();
+        });
+    }
+
+    asio::ip::tcp::socket socket_;
+    ReceiveRing ring_;
+    std::vector<uint8_t> pending_;
+    std::vector<uint8_t> in_flight_;
+    bool writing_ = false;
+};
+
+/// Client side: burst -> wait for all echoes -> record latency -> repeat
+class BenchClient : public std::enable_shared_from_this<BenchClient> {
+public:
+    BenchClient(asio::io_context &context, size_t burst, std::atomic<bool> &running)
+        : socket_(context), running_(running),
+          request_(burst * FRAME_SIZE), response_(burst * FRAME_SIZE) {
+        for (size_t i = 0; i < burst; i++) {
+            std::copy(MOVE_FRAME, MOVE_FRAME + FRAME_SIZE, request_.begin() + i * FRAME_SIZE);
+        }
+    }
+
+    void Connect(const asio::ip::tcp::endpoint &endpoint) {
+        socket_.connect(endpoint);
+        socket_.set_option(asio::ip::tcp::no_delay(true));
+    }
+
+    void Start() { SendBurst(); }
+
+    void Close() {
+        std::error_code ec;
+        socket_.close(ec);
+    }
+
+    std::vector<double> TakeLatencies() {
+        std::lock_guard lock(mutex_);
+        return std::move(latencies_us_);
+    }
+
+private:
+    void SendBurst() {
+        if (!running_) return;
+        sent_at_ = Clock::now();
+        auto self = shared_from_this();
+        asio::async_write(socket_, asio::buffer(request_), [this, self](std::error_code ec, size_t) {
+            if (ec) return;
+            asio::async_read(socket_, asio::buffer(response_), [this, self](std::error_code ec, size_t) {
+                if (ec) return;
+                const double us = std::chrono::duration<double, std::micro>(Clock::now() - sent_at_).count();
+                {
+                    std::lock_guard lock(mutex_);
+                    latencies_us_.push_back(us);
+                }
+                SendBurst();
+            });
+        });
+    }
+
+    asio::ip::tcp::socket socket_;
+    std::atomic<bool> &running_;
+    std::vector<uint8_t> request_;
+    std::vector<uint8_t> response_;
+    Clock::time_point sent_at_;
+    std::mutex mutex_;
+    std::vector<double> latencies_us_;
+};
+
+void Accept(asio::ip::tcp::acceptor &acceptor, IoContextPool &pool) {
+    acceptor.async_accept(pool.Next(), [&acceptor, &pool](std::error_code ec, asio::ip::tcp::socket socket) {
+        if (ec) return;
+        socket.set_option(asio::ip::tcp::no_delay(true));
+        std::make_shared<BenchSession>(std::move(socket))->Start();
+        Accept(acceptor, pool);
+    });
+}
+
+struct Options {
+    std::vector<size_t> thread_counts = {1, 2, 4, 8};
+    size_t connections = 256;
+    size_t seconds = 5;
+    size_t burst = 10;
+    uint16_t port = 18081;
+};
+
+Options ParseOptions(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const std::string value = argv[i + 1];
+        if (arg == "--threads") {
+            options.thread_counts.clear();
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) options.thread_counts.push_back(std::stoul(item));
+        } else if (arg == "--connections") {
+            options.connections = std::stoul(value);
+        } else if (arg == "--seconds") {
+            options.seconds = std::stoul(value);
+        } else if (arg == "--burst") {
+            options.burst = std::stoul(value);
+        } else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::stoul(value));
+        }
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const Options options = ParseOptions(argc, argv);
+    const asio::ip::tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"), options.port);
+
+    // Client load runs on its own fixed pool so it's identical for every row
+    const size_t client_threads = std::max<size_t>(2, std::thread::hardware_concurrency() / 2);
+
+    std::printf("%s backend, %zu connections, burst %zu, %zus per run, %zu client threads\n\n",
+                IoBackend::Compiled(), options.connections, options.burst, options.seconds, client_threads);
+    std::printf("%-10s %14s %12s %12s %12s\n", "io_threads", "frames/sec", "MB/s in", "p50 us", "p99 us");
+
+    for (const size_t io_threads : options.thread_counts) {
+        IoContextPool server_pool(io_threads);
+        asio::ip::tcp::acceptor acceptor(server_pool.Primary(), endpoint);
+        acceptor.set_option(asio::socket_base::reuse_address(true));
+        Accept(acceptor, server_pool);
+        server_pool.Run();
+
+        IoContextPool client_pool(client_threads);
+        std::atomic<bool> running{true};
+        std::vector<std::shared_ptr<BenchClient>> clients;
+        for (size_t i = 0; i < options.connections; i++) {
+            auto client = std::make_shared<BenchClient>(client_pool.Next(), options.burst, running);
+            client->Connect(endpoint);
+            clients.push_back(client);
+        }
+        client_pool.Run();
+
+        g_frames_handled = 0;
+        const auto start = Clock::now();
+        for (auto &client : clients) asio::post(client_pool.Next(), [client] { client->Start(); });
+        std::this_thread::sleep_for(std::chrono::seconds(options.seconds));
+        const uint64_t frames = g_frames_handled.load();
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        running = false;
+
+        std::vector<double> latencies;
+        for (auto &client : clients) {
+            auto samples = client->TakeLatencies();
+            latencies.insert(latencies.end(), samples.begin(), samples.end());
+        }
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) {
+            return latencies.empty() ? 0.0 : latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+        };
+
+        std::printf("%-10zu %14.0f %12.2f %12.0f %12.0f\n", io_threads, frames / elapsed,
+                    frames * FRAME_SIZE / elapsed / (1024.0 * 1024.0), percentile(0.50), percentile(0.99));
+
+        for (auto &client : clients) asio::post(client_pool.Next(), [client] { client->Close(); });
+        client_pool.Stop();
+        client_pool.Join();
+        std::error_code ec;
+        acceptor.close(ec);
+        server_pool.Stop();
+        server_pool.Join();
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+/// =======================================
+/// DyeWarsMapConvert
+///
+/// Builds .dwm map files (see MapFile) for --map-dir, and inspects them.
+///
+///   raw      - a file of width * height tile bytes, row-major (what
+///              TileMap::GetRawTileData() / LoadFromBytes() use)
+///   generate - a synthetic map (SyntheticMap.h), for load tests
+///   info     - print a file's header and chunk index summary
+///
+/// The static blocking bits and the chunk index are computed here, once,
+/// so the server's load is a header check and a copy.
+///
+/// Usage:
+///   DyeWarsMapConvert <tiles.bin> <out.dwm> --width W --height H [--name NAME]
+///   DyeWarsMapConvert --generate W H <out.dwm> [--seed N] [--name NAME]
+///   DyeWarsMapConvert --info <file.dwm>
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "SyntheticMap.h"
+#include "game/MapFile.h"
+#include "game/TileMap.h"
+
+namespace {
+
+int Usage() {
+    std::fprintf(stderr,
+                 "Usage: DyeWarsMapConvert <tiles.bin> <out.dwm> --width W --height H [--name NAME]\n"
+                 "       DyeWarsMapConvert --generate W H <out.dwm> [--seed N] [--name NAME]\n"
+                 "       DyeWarsMapConvert --info <file.dwm>\n");
+    return 2;
+}
+
+int16_t ParseDimension(const std::string &value) {
+    const unsigned long size = std::stoul(value);
+    if (size == 0 || size > 32767) throw std::invalid_argument("width and height must be 1-32767");
+    return static_cast<int16_t>(size);
+}
+
+int Info(const std::string &path) {
+    const auto file = MapFile::Open(path);
+    const auto &header = file->GetHeader();
+    std::printf("%s: \"%s\" %ux%u, version %u, %llu bytes\n", path.c_str(), file->GetName().c_str(),
+                header.width, header.height, header.version, static_cast<unsigned long long>(header.file_size));
+    std::printf("  tiles at %llu, collision at %llu (%u words/row), chunk index at %llu\n",
+                static_cast<unsigned long long>(header.tiles_offset),
+                static_cast<unsigned long long>(header.collision_offset), header.collision_stride,
+                static_cast<unsigned long long>(header.chunk_index_offset));
+    if (header.blocking_hash != TileTypes::BlockingTableHash()) {
+        std::printf("  collision bits built with another blocking table - the server rebuilds them, convert again\n");
+    }
+
+    size_t uniform = 0;
+    size_t blocking = 0;
+    size_t palette_total = 0;
+    for (const auto &entry : file->ChunkIndex()) {
+        if (entry.palette_size == 1) uniform++;
+        if (entry.blocking) blocking++;
+        palette_total += entry.palette_size;
+    }
+    std::printf("  %u chunks of %u: %zu uniform, %zu with blockers, %.2f tile types on average\n",
+                header.chunk_count, header.chunk_size, uniform, blocking,
+                header.chunk_count ? static_cast<double>(palette_total) / header.chunk_count : 0.0);
+    return 0;
+}
+
+void Write(const std::string &path, TileMap &map, const std::string &name) {
+    map.SetMapName(name);
+    MapFile::Write(path, map);
+    std::printf("Wrote %s (%dx%d)\n", path.c_str(), map.GetWidth(), map.GetHeight());
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    try {
+        if (args.size() == 2 && args[0] == "--info") return Info(args[1]);
+
+        std::string name;
+        uint64_t seed = 1;
+        int16_t width = 0;
+        int16_t height = 0;
+        std::vector<std::string> positional;
+        for (size_t i = 0; i < args.size(); i++) {
+            const bool has_value = i + 1 < args.size();
+            if (args[i] == "--name" && has_value) name = args[++i];
+            else if (args[i] == "--seed" && has_value) seed = std::stoull(args[++i]);
+            else if (args[i] == "--width" && has_value) width = ParseDimension(args[++i]);
+            else if (args[i] == "--height" && has_value) height = ParseDimension(args[++i]);
+            else positional.push_back(args[i]);
+        }
+
+        if (positional.size() == 4 && positional[0] == "--generate") {
+            const int16_t generate_width = ParseDimension(positional[1]);
+            const int16_t generate_height = ParseDimension(positional[2]);
+            TileMap map(generate_width, generate_height,
+                        SyntheticMap::Generate(generate_width, generate_height, seed));
+            Write(positional[3], map, name.empty() ? "generated" : name);
+            return 0;
+        }
+
+        if (positional.size() != 2 || width == 0 || height == 0) return Usage();
+        std::ifstream in(positional[0], std::ios::binary);
+        if (!in) throw std::runtime_error("can't open " + positional[0]);
+        const std::vector<uint8_t> tiles{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        if (tiles.size() != static_cast<size_t>(width) * height) {
+            throw std::runtime_error(std::to_string(tiles.size()) + " bytes, expected width * height = " +
+                                     std::to_string(static_cast<size_t>(width) * height));
+        }
+        TileMap map(width, height, tiles);
+        Write(positional[1], map, name);
+        return 0;
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "DyeWarsMapConvert: %s\n", e.what());
+        return 1;
+    }
+}
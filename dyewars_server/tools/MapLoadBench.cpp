@@ -0,0 +1,236 @@
+/// =======================================
+/// DyeWarsMapBench
+///
+/// Map load benchmark: how long until a zone can place its first player on
+/// a large map, loading it two ways.
+///
+///   read   - the file's raw tile bytes read into a vector, then
+///            TileMap(width, height, tiles): a copy plus a blocking check
+///            per tile (the only way to load a map before .dwm files)
+///   mapped - TileMap::FromFile() + Load(): header check, mmap, and a copy
+///            of the pre-computed collision words
+///
+/// Each is timed to "ready", then for a full scan of every tile (which
+/// faults in all of the mapped pages) and for 1000 random view reads
+/// (what players actually touch first). "cold" runs first drop the file
+/// from the page cache (posix_fadvise), "warm" runs right after.
+///
+/// Then instance spin-up on the same map, to a World ready for players:
+///
+///   copy   - a World on its own copy of the tiles (TileMap(w, h, tiles))
+///   shared - a World on TileMap::InstanceOf() the loaded map
+///   pooled - InstancePool::Acquire() of a pre-warmed World, recycled
+///
+/// with the memory each instance holds beyond the shared map, unedited
+/// and after 100 scattered tile edits.
+///
+/// Usage:
+///   DyeWarsMapBench [--size 4096] [--runs 5] [--dir /tmp]
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "SyntheticMap.h"
+#include "game/InstancePool.h"
+#include "game/MapFile.h"
+#include "game/TileMap.h"
+#include "game/World.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    int16_t size = 4096;
+    size_t runs = 5;
+    std::string dir = "/tmp";
+};
+
+Options ParseOptions(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const std::string value = argv[i + 1];
+        if (arg == "--size") options.size = static_cast<int16_t>(std::clamp(std::stoi(value), 64, 32767));
+        else if (arg == "--runs") options.runs = std::max<size_t>(1, std::stoul(value));
+        else if (arg == "--dir") options.dir = value;
+    }
+    return options;
+}
+
+double Ms(Clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - from).count();
+}
+
+/// Evict the file from the page cache so the next read goes to disk
+void DropFromCache(const std::string &path) {
+#ifndef _WIN32
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#endif
+}
+
+struct Timing {
+    double ready_ms = 0;
+    double scan_ms = 0;
+    double views_ms = 0;
+};
+
+/// Load with `load`, then time a full scan and random view reads
+Timing Measure(const std::function<std::unique_ptr<TileMap>()> &load, uint64_t &checksum) {
+    Timing timing;
+    auto start = Clock::now();
+    const auto map = load();
+    timing.ready_ms = Ms(start);
+
+    std::mt19937 rng(7);
+    std::vector<uint8_t> view;
+    start = Clock::now();
+    for (int i = 0; i < 1000; i++) {
+        const auto x = static_cast<int16_t>(rng() % map->GetWidth());
+        const auto y = static_cast<int16_t>(rng() % map->GetHeight());
+        map->CopyRegionTiles(x, y, 11, 11, view);
+        checksum += view[60];
+    }
+    timing.views_ms = Ms(start);
+
+    start = Clock::now();
+    for (const uint8_t tile : map->GetRawTileData()) checksum += tile;
+    timing.scan_ms = Ms(start);
+    return timing;
+}
+
+double Median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+/// 100 tile edits spread over the map
+void EditScattered(TileMap &map) {
+    std::mt19937 rng(11);
+    for (int i = 0; i < 100; i++) {
+        map.SetTile(static_cast<int16_t>(rng() % map.GetWidth()), static_cast<int16_t>(rng() % map.GetHeight()),
+                    TileTypes::Wall);
+    }
+}
+
+/// Instance spin-up: time to a World, and bytes held beyond the base map
+void MeasureInstances(const Options &options, const std::string &map_path, uint64_t &checksum) {
+    std::shared_ptr<const TileMap> base = [&] {
+        auto map = TileMap::FromFile(map_path);
+        map->Load();
+        return std::shared_ptr<const TileMap>(std::move(map));
+    }();
+    std::vector<uint8_t> tiles;
+    base->CopyRegionTiles(0, 0, base->GetWidth(), base->GetHeight(), tiles);
+    const size_t copy_bytes = tiles.size() + base->Collision().StaticWords().size() * 2 * sizeof(uint64_t);
+    InstancePool pool(base, 1);
+
+    std::vector<double> copy_us;
+    std::vector<double> shared_us;
+    std::vector<double> pooled_us;
+    size_t shared_bytes = 0;
+    size_t edited_bytes = 0;
+    for (size_t run = 0; run < options.runs; run++) {
+        auto start = Clock::now();
+        auto copy = std::make_unique<World>(std::make_unique<TileMap>(options.size, options.size, tiles));
+        copy_us.push_back(Ms(start) * 1000);
+
+        start = Clock::now();
+        auto shared = std::make_unique<World>(TileMap::InstanceOf(base));
+        shared_us.push_back(Ms(start) * 1000);
+        shared_bytes = shared->GetMap().InstanceBytes();
+
+        start = Clock::now();
+        auto pooled = pool.Acquire();
+        pooled_us.push_back(Ms(start) * 1000);
+        EditScattered(pooled->GetMap());
+        edited_bytes = pooled->GetMap().InstanceBytes();
+        checksum += copy->GetMap().GetTile(1, 1) + shared->GetMap().GetTile(1, 1) + pooled->GetMap().GetTile(1, 1);
+        pool.Recycle(std::move(pooled));
+    }
+
+    std::printf("\n%-14s %12s %14s %14s\n", "instance", "ready, us", "KB", "KB, 100 edits");
+    std::printf("%-14s %12.2f %14.1f %14s\n", "copy", Median(copy_us), copy_bytes / 1024.0, "same");
+    std::printf("%-14s %12.2f %14.1f %14s\n", "shared", Median(shared_us), shared_bytes / 1024.0, "");
+    std::printf("%-14s %12.2f %14s %14.1f\n", "pooled", Median(pooled_us), "", edited_bytes / 1024.0);
+}
+
+void Report(const char *name, const std::vector<Timing> &runs) {
+    auto median = [&](double Timing::*field) {
+        std::vector<double> values;
+        for (const auto &run : runs) values.push_back(run.*field);
+        return Median(std::move(values));
+    };
+    std::printf("%-14s %12.2f %12.2f %12.2f\n", name, median(&Timing::ready_ms), median(&Timing::views_ms),
+                median(&Timing::scan_ms));
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    const Options options = ParseOptions(argc, argv);
+    const std::string raw_path = options.dir + "/dyewars_bench.bin";
+    const std::string map_path = options.dir + "/dyewars_bench.dwm";
+
+    {
+        TileMap map(options.size, options.size, SyntheticMap::Generate(options.size, options.size, 1));
+        const auto tiles = map.GetRawTileData();
+        std::ofstream(raw_path, std::ios::binary).write(reinterpret_cast<const char *>(tiles.data()),
+                                                        static_cast<std::streamsize>(tiles.size()));
+        MapFile::Write(map_path, map);
+    }
+
+    auto read_map = [&] {
+        std::ifstream in(raw_path, std::ios::binary);
+        std::vector<uint8_t> tiles(static_cast<size_t>(options.size) * options.size);
+        in.read(reinterpret_cast<char *>(tiles.data()), static_cast<std::streamsize>(tiles.size()));
+        return std::make_unique<TileMap>(options.size, options.size, tiles);
+    };
+    auto mapped_map = [&] {
+        auto map = TileMap::FromFile(map_path);
+        map->Load();
+        return map;
+    };
+
+    const size_t tiles = static_cast<size_t>(options.size) * options.size;
+    std::printf("%dx%d map (%.1f MB of tiles), median of %zu runs, ms\n\n", options.size, options.size,
+                tiles / 1048576.0, options.runs);
+    std::printf("%-14s %12s %12s %12s\n", "load", "ready", "1000 views", "full scan");
+
+    uint64_t checksum = 0;
+    for (const bool cold : {true, false}) {
+        std::vector<Timing> read_runs;
+        std::vector<Timing> mapped_runs;
+        for (size_t run = 0; run < options.runs; run++) {
+            if (cold) DropFromCache(raw_path);
+            read_runs.push_back(Measure(read_map, checksum));
+            if (cold) DropFromCache(map_path);
+            mapped_runs.push_back(Measure(mapped_map, checksum));
+        }
+        Report(cold ? "read, cold" : "read, warm", read_runs);
+        Report(cold ? "mapped, cold" : "mapped, warm", mapped_runs);
+    }
+    MeasureInstances(options, map_path, checksum);
+
+    std::printf("\n(checksum %llu)\n", static_cast<unsigned long long>(checksum));
+    std::remove(raw_path.c_str());
+    std::remove(map_path.c_str());
+    return 0;
+}
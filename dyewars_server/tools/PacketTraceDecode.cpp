@@ -0,0 +1,101 @@
+/// =======================================
+/// DyeWarsTraceDecode
+///
+/// Prints a packet capture written by "trace dump" (console) or
+/// GET /trace?dump (debug HTTP) in human-readable form, naming each packet
+/// from the OpCodes.h tables.
+///
+/// Usage: DyeWarsTraceDecode <capture.dwtr> [--client <id>]
+///
+/// Output:
+///   #1042 12:30:01.123456 C->S client 7  0x01 C_Move_Request (3 bytes): 01 02 02
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "network/PacketTrace.h"
+#include "network/Packets/Protocol.h"
+#include "network/Packets/OpCodes.h"
+
+using namespace Protocol::PacketReader;
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <capture.dwtr> [--client <id>]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t client_filter = 0;
+    if (argc >= 4 && std::string(argv[2]) == "--client") {
+        client_filter = std::stoull(argv[3]);
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file.is_open()) {
+        std::fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    try {
+        size_t offset = 0;
+        if (ReadUInt(data, offset) != PacketTraceFormat::FILE_MAGIC) {
+            std::fprintf(stderr, "%s is not a packet trace capture\n", argv[1]);
+            return 1;
+        }
+        const uint16_t version = ReadShort(data, offset);
+        if (version != PacketTraceFormat::VERSION) {
+            std::fprintf(stderr, "Unsupported capture version %u (expected %u)\n",
+                         version, PacketTraceFormat::VERSION);
+            return 1;
+        }
+        const uint16_t capture_bytes = ReadShort(data, offset);
+        const uint32_t record_count = ReadUInt(data, offset);
+        std::printf("%u packets (first %u bytes of each payload)\n\n", record_count, capture_bytes);
+
+        for (uint32_t i = 0; i < record_count; i++) {
+            const uint64_t seq = ReadUInt64(data, offset);
+            const uint64_t timestamp_us = ReadUInt64(data, offset);
+            const uint64_t client_id = ReadUInt64(data, offset);
+            const auto direction = static_cast<PacketTraceFormat::Direction>(ReadByte(data, offset));
+            const uint16_t size = ReadShort(data, offset);
+            const uint16_t captured = ReadShort(data, offset);
+            if (data.size() - offset < captured) throw std::out_of_range("truncated record");
+            const size_t bytes_start = offset;
+            offset += captured;
+
+            if (client_filter != 0 && client_id != client_filter) continue;
+
+            const bool from_client = direction == PacketTraceFormat::Direction::ClientToServer;
+            const uint8_t opcode = captured > 0 ? data[bytes_start] : 0;
+            const OpCodeInfo *info = captured > 0 ? Protocol::Opcode::Find(opcode, from_client) : nullptr;
+
+            // Wall-clock time of day, microsecond precision
+            const uint64_t us_of_day = timestamp_us % (24ull * 3600 * 1000000);
+            std::printf("#%llu %02llu:%02llu:%02llu.%06llu %s client %llu  0x%02X %s (%u bytes):",
+                        static_cast<unsigned long long>(seq),
+                        static_cast<unsigned long long>(us_of_day / 3600000000ull),
+                        static_cast<unsigned long long>(us_of_day / 60000000ull % 60),
+                        static_cast<unsigned long long>(us_of_day / 1000000ull % 60),
+                        static_cast<unsigned long long>(us_of_day % 1000000ull),
+                        from_client ? "C->S" : "S->C",
+                        static_cast<unsigned long long>(client_id),
+                        opcode, info ? info->name : "Unknown", size);
+
+            for (size_t b = 0; b < captured; b++) {
+                std::printf(" %02X", data[bytes_start + b]);
+            }
+            if (captured < size) std::printf(" ...");
+            std::printf("\n");
+        }
+    } catch (const std::out_of_range &) {
+        std::fprintf(stderr, "Capture is truncated or corrupt\n");
+        return 1;
+    }
+    return 0;
+}
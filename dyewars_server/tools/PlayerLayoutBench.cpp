@@ -0,0 +1,263 @@
+/// =======================================
+/// DyeWarsPlayerBench
+///
+/// Broadcast-phase benchmark for the player hot/cold split (PlayerTable).
+/// Replays the bot stress scenarios headless - bots spawned like
+/// BotStressTest::SpawnBots ("clustered" within 50 tiles of one spot,
+/// "spread" over the whole map), ~30% of them moving each tick like
+/// ProcessBotMovement - and times the broadcast reads two ways:
+///
+///   object  - fields read through one heap object per player, laid out
+///             like Player was before the split (ThreadOwner, ids, name,
+///             position, facing, two cooldown time points)
+///   columns - fields read from the registry's PlayerTable by handle
+///
+/// Both run the same loops as Zone::BroadcastDirtyPlayers: for each dirty
+/// player a spatial query with the self/ghost viewer filter, then one
+/// (id, x, y, facing) record per viewer pair. Visibility bookkeeping and
+/// packet encoding cost the same either way and are left out.
+///
+/// The object side allocates its players back to back in spawn order,
+/// which is kinder to it than a long-running server's heap.
+///
+/// Usage:
+///   DyeWarsPlayerBench [--bots 1000,4000,8000] [--ticks 200] [--map 1000]
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "core/ThreadSafety.h"
+#include "game/PlayerRegistry.h"
+#include "game/PlayerTable.h"
+#include "game/World.h"
+#include "game/actions/BotStressTest.h"
+#include "server/TickDelta.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+/// The pre-split Player layout, field for field
+struct ObjectPlayer {
+    mutable ThreadOwner thread_owner;
+    uint64_t id = 0;
+    PlayerHandle handle = SlotHandle::NONE;
+    uint64_t client_id = 0;
+    std::string name;
+    bool ghost = false;
+    int16_t x = 0;
+    int16_t y = 0;
+    uint8_t facing = 2;
+    Clock::time_point last_move{};
+    Clock::time_point last_turn{};
+};
+
+struct Options {
+    std::vector<size_t> bot_counts = {1000, 4000, 8000};
+    size_t ticks = 200;
+    int16_t map_size = 1000;
+};
+
+Options ParseOptions(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const std::string value = argv[i + 1];
+        if (arg == "--bots") {
+            options.bot_counts.clear();
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) options.bot_counts.push_back(std::stoul(item));
+        } else if (arg == "--ticks") {
+            options.ticks = std::stoul(value);
+        } else if (arg == "--map") {
+            options.map_size = static_cast<int16_t>(std::stoi(value));
+        }
+    }
+    return options;
+}
+
+/// Reused per-run buffers, the same for both layouts
+struct Scratch {
+    std::vector<std::vector<PlayerHandle>> viewers;  // Per dirty player
+    TickDelta delta;
+};
+
+struct Result {
+    double ms = 0;       // Timed broadcast reads, summed over ticks
+    size_t pairs = 0;    // Viewer pairs recorded, summed over ticks
+};
+
+/// Zone::BroadcastDirtyPlayers' reads over one object per player
+void BroadcastObjects(const World &world, const std::vector<std::shared_ptr<ObjectPlayer>> &objects,
+                      const std::vector<PlayerHandle> &dirty, Scratch &scratch, Result &result) {
+    const auto start = Clock::now();
+    scratch.viewers.resize(dirty.size());
+    for (size_t i = 0; i < dirty.size(); i++) {
+        const ObjectPlayer &mover = *objects[SlotHandle::Index(dirty[i])];
+        auto &found = scratch.viewers[i];
+        found.clear();
+        world.ForEachHandleInRange(mover.x, mover.y, [&](PlayerHandle handle) {
+            const ObjectPlayer &viewer = *objects[SlotHandle::Index(handle)];
+            if (viewer.handle != mover.handle && !viewer.ghost) found.push_back(handle);
+        });
+    }
+    for (size_t i = 0; i < dirty.size(); i++) {
+        const ObjectPlayer &mover = *objects[SlotHandle::Index(dirty[i])];
+        for (PlayerHandle handle : scratch.viewers[i]) {
+            const ObjectPlayer &viewer = *objects[SlotHandle::Index(handle)];
+            scratch.delta.events.push_back({viewer.client_id, TickDelta::Kind::Spatial});
+            scratch.delta.records.push_back({mover.id, mover.x, mover.y, mover.facing});
+        }
+    }
+    result.ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    result.pairs += scratch.delta.records.size();
+}
+
+/// The same, reading PlayerTable columns
+void BroadcastColumns(const World &world, const PlayerTable &table,
+                      const std::vector<PlayerHandle> &dirty, Scratch &scratch, Result &result) {
+    const auto start = Clock::now();
+    scratch.viewers.resize(dirty.size());
+    for (size_t i = 0; i < dirty.size(); i++) {
+        const PlayerHandle mover = dirty[i];
+        auto &found = scratch.viewers[i];
+        found.clear();
+        world.ForEachHandleInRange(table.X(mover), table.Y(mover), [&](PlayerHandle handle) {
+            if (handle != mover && !table.IsGhost(handle)) found.push_back(handle);
+        });
+    }
+    for (size_t i = 0; i < dirty.size(); i++) {
+        const uint32_t mover = SlotHandle::Index(dirty[i]);
+        for (PlayerHandle handle : scratch.viewers[i]) {
+            scratch.delta.events.push_back({table.ClientID(handle), TickDelta::Kind::Spatial});
+            scratch.delta.records.push_back({table.id[mover], table.x[mover], table.y[mover], table.facing[mover]});
+        }
+    }
+    result.ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    result.pairs += scratch.delta.records.size();
+}
+
+void RunScenario(const Options &options, size_t bots, bool clustered) {
+    World world(options.map_size, options.map_size);
+    PlayerRegistry players;
+    std::vector<std::shared_ptr<ObjectPlayer>> objects;  // By handle slot
+    std::vector<PlayerHandle> handles;
+    std::mt19937 rng(42);
+
+    // SpawnBots: clustered within 50 tiles of the map center, else anywhere
+    const int center = options.map_size / 2;
+    const int min = clustered ? std::max(1, center - 50) : 1;
+    const int max = clustered ? std::min(options.map_size - 2, center + 50) : options.map_size - 2;
+    std::uniform_int_distribution<int> coord(min, max);
+    std::uniform_int_distribution<int> facing_dist(0, 3);
+    for (size_t attempts = 0; handles.size() < bots && attempts < bots * 10; attempts++) {
+        const auto x = static_cast<int16_t>(coord(rng));
+        const auto y = static_cast<int16_t>(coord(rng));
+        if (world.IsPositionOccupied(x, y)) continue;
+
+        const uint64_t client_id = Actions::BotStressTest::BOT_CLIENT_ID_BIT + handles.size();
+        auto player = players.CreatePlayer(client_id, x, y, static_cast<uint8_t>(facing_dist(rng)));
+        if (!player) break;
+        player->SetName(std::format("StressBot_{:08}", handles.size()));
+        world.AddPlayer(player->GetHandle(), x, y, player);
+        handles.push_back(player->GetHandle());
+
+        const uint32_t index = SlotHandle::Index(player->GetHandle());
+        if (objects.size() <= index) objects.resize(index + 1);
+        auto object = std::make_shared<ObjectPlayer>();
+        object->id = player->GetID();
+        object->handle = player->GetHandle();
+        object->client_id = client_id;
+        object->name = player->GetName();
+        object->x = x;
+        object->y = y;
+        object->facing = player->GetFacing();
+        objects[index] = std::move(object);
+    }
+
+    Scratch scratch;
+    Result object_result, column_result;
+    std::uniform_int_distribution<size_t> bot_picker(0, handles.size() - 1);
+    std::uniform_int_distribution<int> dir_dist(0, 3);
+    std::vector<std::shared_ptr<Player>> tick_dirty;
+    std::vector<PlayerHandle> dirty;
+
+    for (size_t tick = 0; tick < options.ticks; tick++) {
+        // ProcessBotMovement: ~30% of bots try one step
+        for (size_t i = 0; i < std::max<size_t>(1, handles.size() / 3); i++) {
+            const PlayerHandle handle = handles[bot_picker(rng)];
+            auto bot = players.Get(handle);
+            const auto facing = static_cast<uint8_t>(dir_dist(rng));
+            bot->SetFacing(facing);
+            int16_t x = bot->GetX();
+            int16_t y = bot->GetY();
+            switch (facing) {
+                case 0: y++; break;
+                case 1: x++; break;
+                case 2: y--; break;
+                case 3: x--; break;
+            }
+            if (world.GetMap().IsTileBlocked(x, y) || world.IsPositionOccupied(x, y, handle)) continue;
+            bot->SetPosition(x, y);
+            world.UpdatePlayerPosition(handle, x, y);
+            players.MarkDirty(handle);
+
+            ObjectPlayer &object = *objects[SlotHandle::Index(handle)];
+            object.x = x;
+            object.y = y;
+            object.facing = facing;
+        }
+
+        players.ConsumeDirtyPlayers(tick_dirty);
+        dirty.clear();
+        for (const auto &player : tick_dirty) dirty.push_back(player->GetHandle());
+
+        // Alternate which layout goes first so neither always gets the warm cache
+        auto run_objects = [&] {
+            scratch.delta.Begin(tick, Clock::now());
+            BroadcastObjects(world, objects, dirty, scratch, object_result);
+        };
+        auto run_columns = [&] {
+            scratch.delta.Begin(tick, Clock::now());
+            BroadcastColumns(world, players.Table(), dirty, scratch, column_result);
+        };
+        if (tick % 2 == 0) {
+            run_objects();
+            run_columns();
+        } else {
+            run_columns();
+            run_objects();
+        }
+    }
+
+    const double ticks = static_cast<double>(options.ticks);
+    std::printf("%-10s %8zu %14.0f %12.3f %12.3f %9.2fx%s\n", clustered ? "clustered" : "spread", handles.size(),
+                column_result.pairs / ticks, object_result.ms / ticks, column_result.ms / ticks,
+                column_result.ms > 0 ? object_result.ms / column_result.ms : 0.0,
+                object_result.pairs == column_result.pairs ? "" : "  (pair counts differ!)");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const Options options = ParseOptions(argc, argv);
+
+    std::printf("%zu ticks per run, %dx%d map, sizeof(ObjectPlayer) = %zu\n\n", options.ticks,
+                options.map_size, options.map_size, sizeof(ObjectPlayer));
+    std::printf("%-10s %8s %14s %12s %12s %10s\n", "scenario", "bots", "pairs/tick", "object ms", "columns ms",
+                "speedup");
+
+    for (const bool clustered : {true, false}) {
+        for (const size_t bots : options.bot_counts) RunScenario(options, bots, clustered);
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+/// =======================================
+/// DyeWarsShardCheck
+///
+/// End-to-end check of a sharded map: plays one client across the border
+/// between shard 0 and shard 1, which must already be running on this host
+/// (see tools/run_shards.sh).
+///
+///   1. Handshake with shard 0, note the player ID from S_Welcome
+///   2. Warp next to the border, face east and walk until S_Shard_Redirect
+///   3. Connect to the port it names, send C_Shard_Resume with the token
+///   4. Expect S_Welcome with the same player ID, on the far side
+///
+/// Step 2 is a client warp, so the shards must run with --open-warps
+/// (run_shards.sh passes it).
+///
+/// Usage: DyeWarsShardCheck [--host 127.0.0.1] [--border-x 128]
+///   --border-x is shard 1's first column (map width * 1 / shard count)
+///
+/// Exit code 0 on success.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#include <asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "network/Packets/Protocol.h"
+#include "network/Packets/OpCodes.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using namespace Protocol::Opcode;
+
+    constexpr uint8_t EAST = 1;
+    constexpr auto STEP_INTERVAL = std::chrono::milliseconds(300);  // Over the move cooldown
+    constexpr auto TIMEOUT = std::chrono::seconds(10);
+
+    struct Welcome {
+        uint64_t player_id;
+        int16_t x;
+        int16_t y;
+    };
+
+    class Session {
+    public:
+        Session(asio::io_context &context, const std::string &host, uint16_t port) : socket_(context) {
+            socket_.connect(asio::ip::tcp::endpoint(asio::ip::make_address(host), port));
+            socket_.set_option(asio::ip::tcp::no_delay(true));
+        }
+
+        void Send(const std::vector<uint8_t> &payload) {
+            Protocol::Packet pkt;
+            pkt.payload = payload;
+            pkt.size = static_cast<uint16_t>(payload.size());
+            asio::write(socket_, asio::buffer(pkt.ToBytes()));
+        }
+
+        /// Next frame's payload, or nullopt if none arrived within `wait`
+        std::optional<std::vector<uint8_t>> Receive(std::chrono::milliseconds wait) {
+            const auto deadline = Clock::now() + wait;
+            while (true) {
+                if (auto frame = TakeFrame()) return frame;
+                if (Clock::now() >= deadline) return std::nullopt;
+
+                socket_.non_blocking(true);
+                uint8_t chunk[4096];
+                std::error_code ec;
+                const size_t got = socket_.read_some(asio::buffer(chunk), ec);
+                if (ec == asio::error::would_block) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    continue;
+                }
+                if (ec) throw std::system_error(ec);
+                buffer_.insert(buffer_.end(), chunk, chunk + got);
+            }
+        }
+
+    private:
+        std::optional<std::vector<uint8_t>> TakeFrame() {
+            if (buffer_.size() < Protocol::HEADER_SIZE) return std::nullopt;
+            const size_t size = (static_cast<size_t>(buffer_[2]) << 8) | buffer_[3];
+            if (buffer_.size() < Protocol::HEADER_SIZE + size) return std::nullopt;
+            std::vector<uint8_t> payload(buffer_.begin() + Protocol::HEADER_SIZE,
+                                         buffer_.begin() + Protocol::HEADER_SIZE + size);
+            buffer_.erase(buffer_.begin(), buffer_.begin() + Protocol::HEADER_SIZE + size);
+            return payload;
+        }
+
+        asio::ip::tcp::socket socket_;
+        std::vector<uint8_t> buffer_;
+    };
+
+    std::vector<uint8_t> Handshake(std::optional<uint64_t> resume_token) {
+        using namespace Protocol::PacketWriter;
+        std::vector<uint8_t> payload;
+        WriteByte(payload, resume_token ? Connection::Client::C_Shard_Resume.op
+                                        : Connection::Client::C_Handshake_Request.op);
+        WriteShort(payload, Protocol::VERSION);
+        WriteUInt(payload, Protocol::CLIENT_MAGIC);
+        if (resume_token) WriteUInt64(payload, *resume_token);
+        return payload;
+    }
+
+    /// Read until S_Welcome (other packets - handshake accept, spatial
+    /// batches, UDP token - are skipped)
+    std::optional<Welcome> AwaitWelcome(Session &session) {
+        const auto deadline = Clock::now() + TIMEOUT;
+        while (Clock::now() < deadline) {
+            auto frame = session.Receive(std::chrono::milliseconds(100));
+            if (!frame || frame->empty() || (*frame)[0] != LocalPlayer::Server::S_Welcome.op) continue;
+
+            size_t offset = 1;
+            Welcome welcome{};
+            welcome.player_id = Protocol::PacketReader::ReadUInt64(*frame, offset);
+            welcome.x = static_cast<int16_t>(Protocol::PacketReader::ReadShort(*frame, offset));
+            welcome.y = static_cast<int16_t>(Protocol::PacketReader::ReadShort(*frame, offset));
+            return welcome;
+        }
+        return std::nullopt;
+    }
+
+    int Fail(const char *message) {
+        std::fprintf(stderr, "FAIL: %s\n", message);
+        return 1;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string host = "127.0.0.1";
+    int16_t border_x = 128;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--host") host = argv[i + 1];
+        else if (arg == "--border-x") border_x = static_cast<int16_t>(std::stoi(argv[i + 1]));
+    }
+
+    try {
+        asio::io_context context;
+        using namespace Protocol::PacketWriter;
+
+        // 1. Log in on shard 0
+        Session first(context, host, static_cast<uint16_t>(Protocol::PORT));
+        first.Send(Handshake(std::nullopt));
+        const auto welcome = AwaitWelcome(first);
+        if (!welcome) return Fail("no S_Welcome from shard 0");
+        std::printf("Shard 0: player %llu at (%d, %d)\n",
+                    static_cast<unsigned long long>(welcome->player_id), welcome->x, welcome->y);
+
+        // 2. Warp next to the border, face east, walk until redirected
+        std::vector<uint8_t> warp;
+        WriteByte(warp, Movement::Client::C_Warp_Request.op);
+        WriteShort(warp, 0);
+        WriteShort(warp, static_cast<uint16_t>(border_x - 1));
+        WriteShort(warp, static_cast<uint16_t>(welcome->y));
+        first.Send(warp);
+        first.Send({Movement::Client::C_Turn_Request.op, EAST});
+
+        std::optional<std::pair<uint16_t, uint64_t>> redirect;
+        const auto deadline = Clock::now() + TIMEOUT;
+        auto next_step = Clock::now() + STEP_INTERVAL;
+        while (!redirect && Clock::now() < deadline) {
+            if (Clock::now() >= next_step) {
+                first.Send({Movement::Client::C_Move_Request.op, EAST, EAST});
+                next_step += STEP_INTERVAL;
+            }
+            auto frame = first.Receive(std::chrono::milliseconds(20));
+            if (!frame || frame->empty() || (*frame)[0] != Connection::Server::S_Shard_Redirect.op) continue;
+
+            size_t offset = 1;
+            const uint16_t port = Protocol::PacketReader::ReadShort(*frame, offset);
+            const uint64_t token = Protocol::PacketReader::ReadUInt64(*frame, offset);
+            redirect.emplace(port, token);
+        }
+        if (!redirect) return Fail("never redirected - is shard 1 running?");
+        std::printf("Redirected to port %u\n", redirect->first);
+
+        // 3. Resume on the new shard. Dropping the old connection is up to us.
+        Session second(context, host, redirect->first);
+        second.Send(Handshake(redirect->second));
+        const auto resumed = AwaitWelcome(second);
+        if (!resumed) return Fail("no S_Welcome after C_Shard_Resume");
+        std::printf("Shard 1: player %llu at (%d, %d)\n",
+                    static_cast<unsigned long long>(resumed->player_id), resumed->x, resumed->y);
+
+        // 4. Same player, past the border
+        if (resumed->player_id != welcome->player_id) return Fail("resumed as a different player");
+        if (resumed->x < border_x) return Fail("resumed on the wrong side of the border");
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "FAIL: %s\n", e.what());
+        return 1;
+    }
+
+    std::printf("PASS\n");
+    return 0;
+}
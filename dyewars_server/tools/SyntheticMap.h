@@ -0,0 +1,66 @@
+/// =======================================
+/// DyeWars tools - SyntheticMap
+///
+/// A repeatable stand-in for an authored map, for DyeWarsMapConvert
+/// --generate and DyeWarsMapBench: grass, a Default-tile road every 64
+/// tiles both ways, walled buildings scattered from `seed`, and a wall
+/// border. Mostly long runs like a real map, so chunk palettes and
+/// compression look realistic.
+///
+/// Created by Anonymous on Dec 14, 2025
+/// =======================================
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "game/TileMap.h"
+
+namespace SyntheticMap {
+
+    /// Row-major tile bytes for a width x height map
+    inline std::vector<uint8_t> Generate(int16_t width, int16_t height, uint64_t seed) {
+        const size_t w = static_cast<size_t>(width);
+        const size_t h = static_cast<size_t>(height);
+        std::vector<uint8_t> tiles(w * h, TileTypes::Grass);
+        auto set = [&](size_t x, size_t y, uint8_t type) {
+            if (x < w && y < h) tiles[y * w + x] = type;
+        };
+
+        for (size_t y = 0; y < h; y++) {
+            for (size_t x = 0; x < w; x++) {
+                if (x % 64 == 32 || y % 64 == 32) set(x, y, TileTypes::Default);
+            }
+        }
+
+        // One building per ~2000 tiles: a wall outline with a door gap
+        std::mt19937_64 rng(seed);
+        const size_t buildings = w * h / 2000;
+        for (size_t i = 0; i < buildings; i++) {
+            const size_t bw = 6 + rng() % 15;
+            const size_t bh = 6 + rng() % 15;
+            const size_t bx = rng() % w;
+            const size_t by = rng() % h;
+            for (size_t x = bx; x < bx + bw; x++) {
+                set(x, by, TileTypes::Wall);
+                set(x, by + bh - 1, TileTypes::Wall);
+            }
+            for (size_t y = by; y < by + bh; y++) {
+                set(bx, y, TileTypes::Wall);
+                set(bx + bw - 1, y, TileTypes::Wall);
+            }
+            set(bx + bw / 2, by + bh - 1, TileTypes::Default);
+        }
+
+        for (size_t x = 0; x < w; x++) {
+            set(x, 0, TileTypes::Wall);
+            set(x, h - 1, TileTypes::Wall);
+        }
+        for (size_t y = 0; y < h; y++) {
+            set(0, y, TileTypes::Wall);
+            set(w - 1, y, TileTypes::Wall);
+        }
+        return tiles;
+    }
+
+}
@@ -0,0 +1,50 @@
+#!/usr/bin/env bash
+# =============================================================================
+# epoll vs io_uring loopback comparison
+#
+# Runs DyeWarsIoBench and DyeWarsIoBenchUring under the same load and counts
+# every syscall the process makes (server and client side share the process,
+# so both backends pay for both ends equally).
+#
+# Usage: tools/bench_io_backend.sh <build dir> [extra DyeWarsIoBench args]
+#   e.g. tools/bench_io_backend.sh build --threads 1,4 --seconds 10
+#
+# Needs a build with -DENABLE_IO_URING=ON, and perf (preferred) or strace.
+# perf needs kernel.perf_event_paranoid <= 1 or root for tracepoints.
+# =============================================================================
+set -euo pipefail
+
+BUILD_DIR=${1:?usage: $0 <build dir> [bench args]}
+shift
+BENCH_ARGS=("$@")
+[ ${#BENCH_ARGS[@]} -eq 0 ] && BENCH_ARGS=(--threads 1,4 --seconds 5)
+
+count_syscalls() {
+    local out=$1
+    shift
+    if command -v perf > /dev/null; then
+        perf stat -x, -e raw_syscalls:sys_enter -o "$out.perf" "$@" > "$out"
+        cut -d, -f1 "$out.perf" | grep -E '^[0-9]+$' | tail -1
+    else
+        strace -f -c -o "$out.strace" "$@" > "$out"
+        awk '$NF == "total" { print $(NF-2) }' "$out.strace"
+    fi
+}
+
+for bench in DyeWarsIoBench DyeWarsIoBenchUring; do
+    binary="$BUILD_DIR/$bench"
+    if [ ! -x "$binary" ]; then
+        echo "$binary not found (configure with -DENABLE_IO_URING=ON)" >&2
+        exit 1
+    fi
+
+    out=$(mktemp)
+    start=$(date +%s.%N)
+    syscalls=$(count_syscalls "$out" "$binary" "${BENCH_ARGS[@]}")
+    elapsed=$(echo "$(date +%s.%N) - $start" | bc)
+
+    echo "=== $bench ==="
+    grep -v '^\[' "$out"
+    printf "syscalls: %s total, %.0f/sec\n\n" "$syscalls" "$(echo "$syscalls / $elapsed" | bc -l)"
+    rm -f "$out" "$out".*
+done
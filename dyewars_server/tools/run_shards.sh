@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+# =============================================================================
+# Sharded map smoke test on one host
+#
+# Starts N DyeWarsServer processes as shards 0..N-1 of map 0 (ports 8081,
+# 8091, ...; IPC sockets in a temp dir), runs DyeWarsShardCheck to walk a
+# client across the 0/1 border, then stops the shards.
+#
+# Usage: tools/run_shards.sh <build dir> [shard count]   (default 2)
+#
+# Shard logs go to <temp dir>/shard<I>.log and are printed if the check fails.
+# =============================================================================
+set -euo pipefail
+
+BUILD_DIR=${1:?usage: $0 <build dir> [shard count]}
+COUNT=${2:-2}
+SERVER="$BUILD_DIR/DyeWarsServer"
+CHECK="$BUILD_DIR/DyeWarsShardCheck"
+MAP_WIDTH=256
+
+for binary in "$SERVER" "$CHECK"; do
+    if [ ! -x "$binary" ]; then
+        echo "$binary not found" >&2
+        exit 1
+    fi
+done
+
+SHARD_DIR=$(mktemp -d)
+PIDS=()
+cleanup() {
+    for pid in "${PIDS[@]}"; do kill "$pid" 2> /dev/null || true; done
+    wait 2> /dev/null || true
+    rm -rf "$SHARD_DIR"
+}
+trap cleanup EXIT
+
+# The console exits on stdin EOF, so feed the shards a FIFO this script
+# keeps open for writing
+mkfifo "$SHARD_DIR/console"
+exec 3<> "$SHARD_DIR/console"
+for ((i = 0; i < COUNT; i++)); do
+    "$SERVER" --shard "$i/$COUNT" --open-warps --shard-dir "$SHARD_DIR" < "$SHARD_DIR/console" > "$SHARD_DIR/shard$i.log" 2>&1 &
+    PIDS+=($!)
+done
+
+# Wait for every shard's game port
+for ((i = 0; i < COUNT; i++)); do
+    port=$((8081 + i * 10))
+    for _ in $(seq 50); do
+        (exec 3<> "/dev/tcp/127.0.0.1/$port") 2> /dev/null && break
+        sleep 0.1
+    done
+done
+
+if "$CHECK" --border-x $((MAP_WIDTH / COUNT)); then
+    exit 0
+fi
+
+for ((i = 0; i < COUNT; i++)); do
+    echo "=== shard $i ==="
+    tail -n 40 "$SHARD_DIR/shard$i.log"
+done
+exit 1